@@ -1,4 +1,7 @@
 #include "app.h"
+#include "async_log.h"
+#include "motion_model.h"
+#include "pixel_convert.h"
 #include "resource.h"
 
 #include <imgui.h>
@@ -17,9 +20,14 @@ extern LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam
 #include <mmsystem.h>
 #include <shlobj.h>
 #include <cstdio>
+#include <cstring>
 
 namespace {
 
+// Owner of the DXGI Crop location-change hook (WinEvent callbacks carry no
+// user data).
+App* g_cropEventApp = nullptr;
+
 std::string WideToUtf8(const std::wstring& wide) {
   if (wide.empty()) {
     return {};
@@ -121,14 +129,49 @@ static void HotkeyEditor(const char* label, int* currentHotkey) {
     }
 }
 
+// boost::hash_combine mixing (golden-ratio constant plus shifts) for small
+// identity keys (cache settings, output ids).
+uint64_t HashCombine(uint64_t seed, uint64_t value) {
+  seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+  return seed;
+}
+
+uint64_t FloatBits(float value) {
+  uint32_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Moves the samples of the oldest frame in `domain` out of `pending`, summed
+// per stage into `ms`. Returns that frame, 0 when none is pending; samples
+// outside any profiler frame (frame 0) are discarded.
+uint64_t TakeStageFrame(std::vector<StageSample>& pending, TimingDomain domain,
+                        std::array<float, kPipelineStageCount>& ms) {
+  uint64_t frame = 0;
+  for (const StageSample& sample : pending) {
+    if (sample.domain == domain && sample.frame != 0 && (frame == 0 || sample.frame < frame)) {
+      frame = sample.frame;
+    }
+  }
+  size_t kept = 0;
+  for (const StageSample& sample : pending) {
+    if (sample.domain == domain && (sample.frame == frame || sample.frame == 0)) {
+      if (sample.frame != 0) {
+        ms[static_cast<int>(sample.stage)] += static_cast<float>((sample.endSec - sample.beginSec) * 1000.0);
+      }
+      continue;
+    }
+    pending[kept++] = sample;
+  }
+  pending.resize(kept);
+  return frame;
+}
+
 }  // namespace
 
 App::App() {
   QueryPerformanceFrequency(&m_qpcFreq);
-  m_waitTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
-  if (!m_waitTimer) {
-     m_waitTimer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
-  }
+  std::snprintf(m_recordPath.data(), m_recordPath.size(), "session.tmfs");
 }
 
 bool App::ShouldUseWgcForWindowCapture() const {
@@ -168,6 +211,7 @@ bool App::Initialize(HINSTANCE hInstance) {
   }
 
   if (!m_device.Initialize(m_hwnd)) {
+    AsyncLog::Flush();   // the message box points at init_log.txt
     MessageBoxW(nullptr, L"Error: Failed to initialize D3D11 device.\n\nCheck GPU drivers and that D3D11 is supported.\nSee init_log.txt in the app folder for detailed failure info.", L"True Motion Fidelity Engine Error", MB_OK);
     return false;
   }
@@ -201,6 +245,7 @@ bool App::Initialize(HINSTANCE hInstance) {
     MessageBoxW(nullptr, L"Error: Failed to initialize interpolator. Check GPU supports Compute Shader 5.0\n\nCheck DebugView output or shader file paths.", L"True Motion Fidelity Engine Error", MB_OK);
     return false;
   }
+  ApplyStageTiming();
 
   if (!m_capture.Initialize(m_device.Device())) {
     m_captureStatus = "Error: Failed to initialize WGC capture (requires Windows 10/11)";
@@ -216,11 +261,7 @@ bool App::Initialize(HINSTANCE hInstance) {
 
   if (!m_gameCapture.Initialize(m_device.Device())) {
     // Game capture is optional, just log warning
-    std::ofstream log("init_log.txt", std::ios::app);
-    if (log.is_open()) {
-      log << "Warning: Game capture initialization failed\n";
-      log.close();
-    }
+    TFE_LOG(Warn, Init, "Game capture initialization failed");
   }
 
   RefreshWindowList();
@@ -240,11 +281,19 @@ int App::Run() {
     RenderUiWindow();
   }
 
+  if (m_cropEventHook) {
+    UnhookWinEvent(m_cropEventHook);
+    m_cropEventHook = nullptr;
+    g_cropEventApp = nullptr;
+  }
+  StopRecording();
+  StopTelemetry();
   m_gameCapture.Shutdown();
   m_dupCapture.Shutdown();
   m_capture.Shutdown();
   m_ui.Shutdown();
   m_device.Shutdown();
+  AsyncLog::Shutdown();
 
   // Restore default power state and timer
   SetThreadExecutionState(ES_CONTINUOUS);
@@ -499,8 +548,11 @@ void App::ResetCaptureState() {
   m_frameTime100ns.fill(0);
   m_prevFrameTime100ns = 0;
   m_currFrameTime100ns = 0;
-  m_timeOffsetValid = false;
-  m_timeOffset100ns = 0.0;
+  m_sourceClock.Reset();
+  m_displayClock.ResetCaptureMapping();
+  m_outputCache.Invalidate();
+  m_lastPresentedOutputId = 0;
+  m_vrrScheduler.Reset();
   m_lastSmoothedTime = 0;
   m_avgFrameInterval = 0.0;
   m_nextOutputTime100ns = 0.0;
@@ -513,6 +565,8 @@ void App::ResetCaptureState() {
   m_minFrameInterval = 9999.0f;
   m_maxFrameInterval = 0.0f;
   m_frameTimestamps.clear();
+  m_sourceFramesSkipped = 0;
+  m_producerLumaFrames = 0;
   m_lastOutputSrv.Reset();
   m_lastOutputWidth = 0;
   m_lastOutputHeight = 0;
@@ -1113,11 +1167,274 @@ void App::Update() {
   UpdateCapture();
 }
 
+ICaptureSource* App::ActiveCaptureSource() {
+  switch (m_captureMode) {
+    case 0:
+      return m_windowCaptureUsingWgc ? static_cast<ICaptureSource*>(&m_capture) : &m_dupCapture;
+    case 2:
+      return &m_gameCapture;
+    case 3:
+      return &m_dupCapture;  // DXGI Crop - capture monitor, crop to window
+    case 4:
+      return &m_replaySource;
+    default:
+      return &m_capture;
+  }
+}
+
+bool App::UploadCpuFrame(const CpuFrame& cpu, CapturedFrame& frame) {
+  if (!cpu.data || cpu.width <= 0 || cpu.height <= 0) {
+    return false;
+  }
+
+  D3D11_TEXTURE2D_DESC desc = {};
+  if (m_cpuUploadTexture) {
+    m_cpuUploadTexture->GetDesc(&desc);
+  }
+  if (!m_cpuUploadTexture || desc.Width != static_cast<UINT>(cpu.width) ||
+      desc.Height != static_cast<UINT>(cpu.height)) {
+    m_cpuUploadTexture.Reset();
+    desc = {};
+    desc.Width = cpu.width;
+    desc.Height = cpu.height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    if (FAILED(m_device.Device()->CreateTexture2D(&desc, nullptr, &m_cpuUploadTexture))) {
+      m_cpuUploadTexture.Reset();
+      return false;
+    }
+  }
+
+  const void* pixels = cpu.data;
+  size_t pitch = cpu.pitch;
+  if (cpu.format != PixelFormat::Bgra8) {
+    pitch = static_cast<size_t>(cpu.width) * 4;
+    m_cpuConvertBuffer.resize(pitch * cpu.height);
+    PixelConvertParams p;
+    p.srcFormat = cpu.format;
+    p.dstFormat = PixelFormat::Bgra8;
+    p.width = static_cast<uint32_t>(cpu.width);
+    p.height = static_cast<uint32_t>(cpu.height);
+    p.src = cpu.data;
+    p.srcPitch = cpu.pitch;
+    p.dst = m_cpuConvertBuffer.data();
+    p.dstPitch = pitch;
+    if (!ConvertPixels(p)) {
+      return false;
+    }
+    pixels = m_cpuConvertBuffer.data();
+  }
+  m_device.Context()->UpdateSubresource(m_cpuUploadTexture.Get(), 0, nullptr, pixels,
+                                        static_cast<UINT>(pitch), 0);
+
+  LARGE_INTEGER now = {};
+  QueryPerformanceCounter(&now);
+  frame.texture = m_cpuUploadTexture;
+  frame.width = cpu.width;
+  frame.height = cpu.height;
+  frame.qpcTime = now.QuadPart;
+  frame.systemTime100ns = cpu.systemTime100ns;
+  frame.sequence = cpu.sequence;
+  frame.presentTime100ns = cpu.presentTime100ns;
+  frame.framesSkipped = cpu.framesSkipped;
+  return true;
+}
+
+void App::ApplyWgcQueueConfig() {
+  CaptureQueueConfig config;
+  config.policy = static_cast<CaptureQueuePolicy>(m_wgcQueuePolicy);
+  config.fifoDepth = m_wgcFifoDepth;
+  config.windowSec = m_wgcWindowMs * 1e-3;
+  m_capture.SetQueueConfig(config);
+}
+
+bool App::StartReplayCapture() {
+  m_capture.StopCapture();
+  m_dupCapture.StopCapture();
+  m_gameCapture.StopCapture();
+  RestoreDxgiCropWindow();
+  m_windowCaptureUsingWgc = false;
+  m_captureWindow = nullptr;
+  m_captureWindowMonitor = nullptr;
+  m_outputDisplayMode = 0;
+
+  m_replaySource.SetSpeed(m_replaySpeed);
+  m_replaySource.SetLoop(m_replayLoop);
+  m_replaySource.SetClock(ReplayClock::Rebased);
+  return m_replaySource.Open(m_replayPath.data());
+}
+
+bool App::StartRecording() {
+  StopRecording();
+  SessionRecorderConfig config;
+  config.compress = m_recordCompress;
+  m_recordStagingDrops = 0;
+  return m_recorder.Start(m_recordPath.data(), config);
+}
+
+void App::StopRecording() {
+  if (!m_recorder.IsRecording()) {
+    return;
+  }
+  DrainRecordFrames(true);
+  m_recorder.Stop();
+  ReleaseRecordFrames();
+  for (auto& staging : m_recordStaging) {
+    staging.Reset();
+  }
+}
+
+void App::QueueRecordFrame(int slot, const CapturedFrame& frame) {
+  DrainRecordFrames(false);
+  if (static_cast<int>(m_recordPending.size() + m_recordLent.size()) >= kRecordStagingSlots) {
+    m_recordStagingDrops++;
+    return;
+  }
+  // Slots go pending -> lent -> free in order, so the next one is free.
+  const int index = m_recordNextStaging;
+  D3D11_TEXTURE2D_DESC desc = {};
+  if (m_recordStaging[index]) {
+    m_recordStaging[index]->GetDesc(&desc);
+  }
+  if (!m_recordStaging[index] || desc.Width != static_cast<UINT>(m_frameWidth) ||
+      desc.Height != static_cast<UINT>(m_frameHeight)) {
+    m_recordStaging[index].Reset();
+    desc = {};
+    desc.Width = static_cast<UINT>(m_frameWidth);
+    desc.Height = static_cast<UINT>(m_frameHeight);
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    if (FAILED(m_device.Device()->CreateTexture2D(&desc, nullptr, &m_recordStaging[index]))) {
+      m_recordStaging[index].Reset();
+      m_recordStagingDrops++;
+      return;
+    }
+  }
+  m_device.Context()->CopyResource(m_recordStaging[index].Get(), m_frameTextures[slot].Get());
+
+  CpuFrame& meta = m_recordStagingFrame[index];
+  meta = CpuFrame();
+  meta.width = m_frameWidth;
+  meta.height = m_frameHeight;
+  meta.format = PixelFormat::Bgra8;
+  meta.sequence = frame.sequence != 0 ? frame.sequence : m_captureSequence + 1;
+  meta.systemTime100ns = frame.systemTime100ns;
+  meta.presentTime100ns = frame.presentTime100ns;
+  meta.qpcTime = frame.qpcTime;
+  meta.framesSkipped = frame.framesSkipped;
+  m_recordPending.push_back(index);
+  m_recordNextStaging = (index + 1) % kRecordStagingSlots;
+}
+
+void App::DrainRecordFrames(bool wait) {
+  ReleaseRecordFrames();
+  while (!m_recordPending.empty()) {
+    const int index = m_recordPending.front();
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    HRESULT hr = m_device.Context()->Map(m_recordStaging[index].Get(), 0, D3D11_MAP_READ,
+                                         wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+      return;  // copies complete in order; later slots are not ready either
+    }
+    if (SUCCEEDED(hr)) {
+      // No copy here: the writer thread reads the mapping.
+      CpuFrame frame = m_recordStagingFrame[index];
+      frame.data = static_cast<const uint8_t*>(mapped.pData);
+      frame.pitch = mapped.RowPitch;
+      const uint64_t ticket = m_recorder.SubmitLent(frame);
+      if (ticket != 0) {
+        m_recordLent.emplace_back(index, ticket);
+      } else {
+        m_device.Context()->Unmap(m_recordStaging[index].Get(), 0);
+      }
+    }
+    m_recordPending.pop_front();
+  }
+}
+
+void App::ReleaseRecordFrames() {
+  const uint64_t released = m_recorder.Released();
+  while (!m_recordLent.empty() && m_recordLent.front().second <= released) {
+    m_device.Context()->Unmap(m_recordStaging[m_recordLent.front().first].Get(), 0);
+    m_recordLent.pop_front();
+  }
+}
+
+void App::UpdateCropEventHook() {
+  HWND target = (m_captureMode == 3 && m_captureWindow && IsWindow(m_captureWindow)) ? m_captureWindow : nullptr;
+  if (target == m_cropEventWindow) {
+    return;
+  }
+  if (m_cropEventHook) {
+    UnhookWinEvent(m_cropEventHook);
+    m_cropEventHook = nullptr;
+  }
+  m_cropEventWindow = target;
+  m_cropRegion.Invalidate();
+  g_cropEventApp = target ? this : nullptr;
+  if (!target) {
+    return;
+  }
+  // Out-of-context hook on the window's thread: callbacks arrive through
+  // this thread's message loop, so no locking is needed.
+  DWORD processId = 0;
+  DWORD threadId = GetWindowThreadProcessId(target, &processId);
+  m_cropEventHook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE, nullptr,
+                                    &App::CropLocationChanged, processId, threadId,
+                                    WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+}
+
+void CALLBACK App::CropLocationChanged(HWINEVENTHOOK, DWORD, HWND hwnd, LONG idObject,
+                                       LONG idChild, DWORD, DWORD) {
+  App* app = g_cropEventApp;
+  if (!app || idObject != OBJID_WINDOW || idChild != CHILDID_SELF || hwnd != app->m_cropEventWindow) {
+    return;
+  }
+  app->m_cropRegion.Invalidate();
+}
+
+bool App::RefreshCropRegion(int frameWidth, int frameHeight) {
+  RECT clientRect;
+  if (!GetClientRect(m_captureWindow, &clientRect)) {
+    return false;
+  }
+  POINT clientTopLeft = { 0, 0 };
+  ClientToScreen(m_captureWindow, &clientTopLeft);
+  MONITORINFO mi = { sizeof(mi) };
+  if (!GetMonitorInfo(m_captureWindowMonitor, &mi)) {
+    return false;
+  }
+  CaptureRegion region = ClampCaptureRegion(clientTopLeft.x, clientTopLeft.y,
+                                            clientRect.right - clientRect.left,
+                                            clientRect.bottom - clientRect.top,
+                                            mi.rcMonitor.left, mi.rcMonitor.top, frameWidth, frameHeight);
+  if (m_cropRegion.Update(region, frameWidth, frameHeight)) {
+    // Window drags move the crop every frame; a few lines per second is plenty.
+    TFE_LOG_LIMITED(Info, Capture, 5, "Crop region {}: CropX={} CropY={} CropW={} CropH={} FrameW={} FrameH={}",
+                    m_cropRegion.Changes(), region.x, region.y, region.width, region.height, frameWidth,
+                    frameHeight);
+  }
+  return true;
+}
+
 void App::UpdateCapture() {
   int processed = 0;
   constexpr int kMaxFramesPerUpdate = 180;
   int maxFramesPerUpdate = kMaxFramesPerUpdate;
 
+  UpdateCropEventHook();
+  if (m_recorder.IsRecording()) {
+    DrainRecordFrames(false);
+  }
+
   if (m_captureMode == 0 && m_captureWindow) {
     if (!IsWindow(m_captureWindow)) {
       if (m_windowCaptureUsingWgc) {
@@ -1153,130 +1470,43 @@ void App::UpdateCapture() {
     }
   }
 
-  while (processed < maxFramesPerUpdate) {
-    CapturedFrame frame;
-    bool gotFrame = false;
-    if (m_captureMode == 0) {
-      if (m_windowCaptureUsingWgc) {
-        gotFrame = m_capture.AcquireNextFrame(frame);
-      } else {
-        gotFrame = m_dupCapture.AcquireNextFrame(frame);
-      }
-    } else if (m_captureMode == 2) {
-      // Game capture mode (hook-based)
-      gotFrame = m_gameCapture.AcquireNextFrame(frame);
-    } else if (m_captureMode == 3) {
-      // DXGI Crop mode - capture monitor, crop to window
-      gotFrame = m_dupCapture.AcquireNextFrame(frame);
-      // Cropping will be done later after we verify we got a frame
-    } else {
-      gotFrame = m_capture.AcquireNextFrame(frame);
-    }
-    if (!gotFrame) {
+  ICaptureSource* source = ActiveCaptureSource();
+  while (source && processed < maxFramesPerUpdate) {
+    SourceFrame sourceFrame;
+    if (!source->AcquireFrame(sourceFrame)) {
       // In high-FPS mode with spin-wait, keep trying to get frames
       // Don't break immediately - spin until we get one or timeout
-      if (m_dupCapture.IsSpinWaitMode()) {
+      if (source->RetryOnMiss()) {
         continue;
       }
       break;
     }
     processed++;
 
-    // DXGI Crop mode: crop the captured monitor frame to window client area
-    if (m_captureMode == 3 && m_captureWindow && frame.texture) {
-      RECT clientRect;
-      if (GetClientRect(m_captureWindow, &clientRect)) {
-        POINT clientTopLeft = { 0, 0 };
-        ClientToScreen(m_captureWindow, &clientTopLeft);
-        
-        // Get monitor info to calculate offset
-        MONITORINFO mi = { sizeof(mi) };
-        if (GetMonitorInfo(m_captureWindowMonitor, &mi)) {
-          int cropX = clientTopLeft.x - mi.rcMonitor.left;
-          int cropY = clientTopLeft.y - mi.rcMonitor.top;
-          int cropW = clientRect.right - clientRect.left;
-          int cropH = clientRect.bottom - clientRect.top;
-          
-          // Clamp to monitor bounds
-          if (cropX < 0) { cropW += cropX; cropX = 0; }
-          if (cropY < 0) { cropH += cropY; cropY = 0; }
-          if (cropX > frame.width) cropX = frame.width;        // Safety
-          if (cropY > frame.height) cropY = frame.height;      // Safety
-          if (cropX + cropW > frame.width) cropW = frame.width - cropX;
-          if (cropY + cropH > frame.height) cropH = frame.height - cropY;
-          
-          // Debug logging (throttled)
-          static int s_logCounter = 0;
-          if (s_logCounter < 5) {
-             std::ofstream log("dxgi_crop_debug.txt", std::ios::app);
-             log << "Frame " << s_logCounter << ": CropX=" << cropX << " CropY=" << cropY 
-                 << " CropW=" << cropW << " CropH=" << cropH 
-                 << " FrameW=" << frame.width << " FrameH=" << frame.height << "\n";
-             
-             D3D11_TEXTURE2D_DESC srcDesc = {};
-             frame.texture->GetDesc(&srcDesc);
-             log << "SrcFormat=" << srcDesc.Format << "\n";
-             log.close();
-             s_logCounter++;
-          }
-
-          if (cropW > 0 && cropH > 0) {
-            D3D11_TEXTURE2D_DESC srcDesc = {};
-            frame.texture->GetDesc(&srcDesc);
-
-            // Check if current texture matches needed size and format
-            bool needRecreate = !m_cropTexture;
-            if (m_cropTexture) {
-                D3D11_TEXTURE2D_DESC currentDesc = {};
-                m_cropTexture->GetDesc(&currentDesc);
-                if (currentDesc.Width != static_cast<UINT>(cropW) || 
-                    currentDesc.Height != static_cast<UINT>(cropH) ||
-                    currentDesc.Format != srcDesc.Format) {
-                    needRecreate = true;
-                }
-            }
+    // CPU sources (replay) are uploaded once and then take the same path.
+    CapturedFrame frame;
+    if (sourceFrame.onGpu) {
+      frame = std::move(sourceFrame.gpu);
+    } else if (!UploadCpuFrame(sourceFrame.cpu, frame)) {
+      continue;
+    }
 
-            if (needRecreate) {
-              D3D11_TEXTURE2D_DESC desc = {};
-              desc.Width = cropW;
-              desc.Height = cropH;
-              desc.MipLevels = 1;
-              desc.ArraySize = 1;
-              desc.Format = srcDesc.Format; // Use Source Format!
-              desc.SampleDesc.Count = 1;
-              desc.Usage = D3D11_USAGE_DEFAULT;
-              desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-              
-              HRESULT hr = m_device.Device()->CreateTexture2D(&desc, nullptr, &m_cropTexture);
-              if (FAILED(hr)) {
-                   m_cropTexture.Reset();
-              }
-              m_cropWidth = cropW;
-              m_cropHeight = cropH;
-            }
-            
-            if (m_cropTexture) {
-                // Copy the cropped region
-                D3D11_BOX srcBox = {};
-                srcBox.left = cropX;
-                srcBox.top = cropY;
-                srcBox.right = cropX + cropW;
-                srcBox.bottom = cropY + cropH;
-                srcBox.front = 0;
-                srcBox.back = 1;
-                
-                m_device.Context()->CopySubresourceRegion(
-                  m_cropTexture.Get(), 0, 0, 0, 0,
-                  frame.texture.Get(), 0, &srcBox);
-                
-                // Replace frame texture with cropped version
-                frame.texture = m_cropTexture;
-                frame.width = cropW;
-                frame.height = cropH;
-            }
-          }
-        }
+    // DXGI Crop mode: the frame becomes the window's client area inside the
+    // monitor texture; the queue copy below reads just that region.
+    if (m_captureMode == 3 && m_captureWindow && frame.texture) {
+      if (m_cropRegion.NeedsRefresh(frame.width, frame.height) &&
+          !RefreshCropRegion(frame.width, frame.height)) {
+        continue;
       }
+      const CaptureRegion& region = m_cropRegion.Region();
+      if (region.Empty()) {
+        continue;
+      }
+      frame.sourceX = region.x;
+      frame.sourceY = region.y;
+      frame.width = region.width;
+      frame.height = region.height;
+      frame.lumaTexture.Reset();
     }
 
     if (frame.width != m_frameWidth || frame.height != m_frameHeight) {
@@ -1291,14 +1521,21 @@ void App::UpdateCapture() {
       continue;
     }
 
+    // Pace on the producer's present time when the source reports one, so
+    // capture-poll jitter stays out of the interval estimate and alpha. The
+    // domain is fixed per source (see SourceClock).
+    const int64_t sourceTime100ns = m_sourceClock.Time100ns(frame.presentTime100ns, frame.systemTime100ns);
+    m_sourceFramesSkipped += frame.framesSkipped;
+    CountDrop(TelemetryDrop::SourceSkipped, frame.framesSkipped);
+
     if (m_currFrameTime100ns != 0) {
       m_prevFrameTime100ns = m_currFrameTime100ns;
     }
-    m_currFrameTime100ns = frame.systemTime100ns;
+    m_currFrameTime100ns = sourceTime100ns;
 
     if (m_prevFrameTime100ns != 0 && m_currFrameTime100ns != m_prevFrameTime100ns) {
       // Moved Timestamps Logic UP for access in averaging
-      m_frameTimestamps.push_back(frame.systemTime100ns);
+      m_frameTimestamps.push_back(sourceTime100ns);
       if (m_frameTimestamps.size() > 60) {
         m_frameTimestamps.erase(m_frameTimestamps.begin());
       }
@@ -1350,41 +1587,66 @@ void App::UpdateCapture() {
          else m_avgFrameInterval = m_avgFrameInterval * 0.9 + interval * 0.1;
       }
     } else if (m_prevFrameTime100ns == 0) {
-      m_frameTimestamps.push_back(frame.systemTime100ns);
+      m_frameTimestamps.push_back(sourceTime100ns);
     }
 
     if (m_qpcFreq.QuadPart > 0 && frame.qpcTime != 0) {
-      double qpcTo100ns = 1e7 / static_cast<double>(m_qpcFreq.QuadPart);
-      // SYNC: Calculate offset between SystemTime (WGC) and QPC (Present)
-      double offset = static_cast<double>(frame.systemTime100ns) -
-                      static_cast<double>(frame.qpcTime) * qpcTo100ns;
-      
-      if (!m_timeOffsetValid) {
-        m_timeOffset100ns = offset;
-        m_timeOffsetValid = true;
-      } else {
-        // STABILITY: Extremely stiff filter (0.005) or virtually locked.
-        // Clock drift is tiny. Frame jitter is high. We MUST ignore frame jitter.
-        m_timeOffset100ns = m_timeOffset100ns * 0.995 + offset * 0.005;
-      }
+      // SYNC: Map source time (WGC SystemTime, producer present time) onto
+      // QPC (Present). The Kalman tracker estimates offset and drift jointly
+      // and gates out jitter outliers, so it stays locked without the lag of
+      // a stiff fixed IIR.
+      double qpcSec = static_cast<double>(frame.qpcTime) /
+                      static_cast<double>(m_qpcFreq.QuadPart);
+      m_displayClock.AddCaptureSample(qpcSec, static_cast<double>(sourceTime100ns) * 1e-7);
     }
 
     while (m_frameQueue.size() >= 4) {
       m_frameQueue.pop_front();
+      CountDrop(TelemetryDrop::QueueOverflow);
     }
 
     int slot = m_queueWrite;
     m_queueWrite = (m_queueWrite + 1) % kFrameQueueSize;
 
-    m_device.Context()->CopyResource(m_frameTextures[slot].Get(), frame.texture.Get());
+    D3D11_TEXTURE2D_DESC sourceDesc = {};
+    frame.texture->GetDesc(&sourceDesc);
+    if (frame.sourceX != 0 || frame.sourceY != 0 ||
+        sourceDesc.Width != static_cast<UINT>(frame.width) || sourceDesc.Height != static_cast<UINT>(frame.height)) {
+      D3D11_BOX srcBox = {};
+      srcBox.left = static_cast<UINT>(frame.sourceX);
+      srcBox.top = static_cast<UINT>(frame.sourceY);
+      srcBox.right = static_cast<UINT>(frame.sourceX + frame.width);
+      srcBox.bottom = static_cast<UINT>(frame.sourceY + frame.height);
+      srcBox.front = 0;
+      srcBox.back = 1;
+      m_device.Context()->CopySubresourceRegion(m_frameTextures[slot].Get(), 0, 0, 0, 0,
+                                                frame.texture.Get(), 0, &srcBox);
+    } else {
+      m_device.Context()->CopyResource(m_frameTextures[slot].Get(), frame.texture.Get());
+    }
+    m_frameHasLuma[slot] = false;
+    if (frame.lumaTexture && m_frameLumaTextures[slot]) {
+      D3D11_TEXTURE2D_DESC lumaDesc = {};
+      frame.lumaTexture->GetDesc(&lumaDesc);
+      if (lumaDesc.Width == static_cast<UINT>(m_frameWidth / 2) &&
+          lumaDesc.Height == static_cast<UINT>(m_frameHeight / 2)) {
+        m_device.Context()->CopyResource(m_frameLumaTextures[slot].Get(), frame.lumaTexture.Get());
+        m_frameHasLuma[slot] = true;
+        m_producerLumaFrames++;
+      }
+    }
+    if (m_recorder.IsRecording()) {
+      QueueRecordFrame(slot, frame);
+    }
     
     // PERFECT PACING: Virtualize timestamps to eliminate capture jitter.
     // We count exact frame intervals to handle game stutters perfectly,
     // and apply a 5% drift correction to stay synced with real time.
-    int64_t rawTime = frame.systemTime100ns;
+    int64_t rawTime = sourceTime100ns;
     int64_t smoothedTime = rawTime;
     
-    if (m_lastSmoothedTime > 0 && m_avgFrameInterval > 0.0 && m_prevFrameTime100ns > 0) {
+    // VRR output schedules on the actual arrivals, so it keeps the raw time.
+    if (m_outputMode != 2 && m_lastSmoothedTime > 0 && m_avgFrameInterval > 0.0 && m_prevFrameTime100ns > 0) {
         int64_t interval100ns = static_cast<int64_t>(m_avgFrameInterval * 1e7);
         int64_t rawDelta = rawTime - m_prevFrameTime100ns;
         
@@ -1407,13 +1669,14 @@ void App::UpdateCapture() {
     
     m_lastSmoothedTime = smoothedTime;
     m_frameTime100ns[slot] = smoothedTime;
+    m_frameSequence[slot] = ++m_captureSequence;
     m_frameQueue.push_back(slot);
 
     // Timestamps update moved up
 
     m_captureFrameCount++;
-    // systemTime100ns is in 100ns units.
-    double nowSec = frame.systemTime100ns * 1e-7;
+    // Source time is in 100ns units.
+    double nowSec = sourceTime100ns * 1e-7;
     if (m_captureFpsTime > 0.0) {
       double elapsed = nowSec - m_captureFpsTime;
       if (elapsed >= 1.0) {
@@ -1447,10 +1710,16 @@ void App::Render() {
   if (!context || !m_device.SwapChain()) {
     return;
   }
+  const double renderStartSec = DeadlineWaiter::Now();
   
+  // The waitable signals once per completed Present. A frame whose present
+  // is skipped as a duplicate keeps the slot it waited for, so the next
+  // frame must not wait again: with nothing presented in between it would
+  // sit out the full timeout.
   HANDLE waitHandle = m_device.GetSwapChainWaitHandle();
-  if (waitHandle) {
+  if (waitHandle && !m_frameLatencySlotHeld) {
       WaitForSingleObjectEx(waitHandle, 1000, true);
+      m_frameLatencySlotHeld = true;
   }
 
   // Only show overlay when: overlay mode ON, capturing a window, AND we have frames
@@ -1492,8 +1761,15 @@ void App::Render() {
   int multiplier = (m_outputMultiplier < 1) ? 1 : m_outputMultiplier;
   float monitorHz = m_device.RefreshHz(m_selectedMonitor);
   bool useMonitorSync = (m_outputMode == 1);
-
-  if (useMonitorSync && monitorHz > 0.0f) {
+  bool useVrr = (m_outputMode == 2);
+  double vrrMaxHz = (m_vrrMaxHz > 0.0f) ? m_vrrMaxHz : ((monitorHz > 0.0f) ? monitorHz : 144.0);
+
+  if (useVrr) {
+    const VrrSchedulerStats& vrrStats = m_vrrScheduler.Stats();
+    m_targetFps = (vrrStats.lastPairIntervalSec > 0.0)
+        ? static_cast<float>(vrrStats.lastCount / vrrStats.lastPairIntervalSec)
+        : 0.0f;
+  } else if (useMonitorSync && monitorHz > 0.0f) {
     m_targetFps = monitorHz;
   } else if (m_avgFrameInterval > 0.0) {
     m_targetFps = static_cast<float>(static_cast<double>(multiplier) / m_avgFrameInterval);
@@ -1504,69 +1780,117 @@ void App::Render() {
   LARGE_INTEGER now = {};
   QueryPerformanceCounter(&now);
   double freq = (m_qpcFreq.QuadPart > 0) ? static_cast<double>(m_qpcFreq.QuadPart) : 0.0;
+  if (monitorHz > 0.0f) {
+    m_displayClock.SetNominalPeriod(1.0 / static_cast<double>(monitorHz));
+  }
   double nowTime100ns = 0.0;
   if (freq > 0.0) {
-    double qpcTo100ns = 1e7 / freq;
-    if (m_timeOffsetValid) {
-      nowTime100ns = static_cast<double>(now.QuadPart) * qpcTo100ns + m_timeOffset100ns;
-    } else {
-      nowTime100ns = static_cast<double>(now.QuadPart) * qpcTo100ns;
-    }
+    nowTime100ns = m_displayClock.CaptureTimeFromQpc(static_cast<double>(now.QuadPart) / freq) * 1e7;
   }
   int64_t intervalQpc = 0;
+
+  double baseIntervalSec = (m_avgFrameInterval > 0.0) ? m_avgFrameInterval : 0.0166666;
+  double outputDelaySec = std::clamp(
+      baseIntervalSec * static_cast<double>(m_pacingDelayFactor), 0.001, 0.080);
+
+  // VRR: the schedule, not a fixed rate, decides when to present and which
+  // source time the present shows.
+  bool vrrHasTick = false;
+  bool vrrHold = false;
+  double vrrDisplayTime100ns = 0.0;
+  if (!useVrr) {
+    m_vrrScheduler.Reset();
+  }
   
-  bool limitOutput = m_limitOutputFps && !useMonitorSync;
-  if (limitOutput && m_targetFps > 0.0f && freq > 0.0) {
+  bool limitOutput = m_limitOutputFps && !useMonitorSync && !useVrr;
+  if (useVrr && freq > 0.0) {
+    VrrSchedulerConfig vrrConfig;
+    vrrConfig.maxOutputHz = vrrMaxHz;
+    vrrConfig.minOutputHz = m_vrrMinHz;
+    vrrConfig.maxPresentsPerPair = multiplier;
+    m_vrrScheduler.SetConfig(vrrConfig);
+
+    std::array<double, kFrameQueueSize> arrivals = {};
+    int arrivalCount = 0;
+    for (int slot : m_frameQueue) {
+      double t = static_cast<double>(m_frameTime100ns[slot]) * 1e-7;
+      if (arrivalCount > 0 && t <= arrivals[arrivalCount - 1]) continue;
+      arrivals[arrivalCount++] = t;
+    }
+
+    double minSpacingSec = 1.0 / vrrMaxHz;
+    VrrTick tick = m_vrrScheduler.Peek(arrivals.data(), arrivalCount,
+                                       nowTime100ns * 1e-7 - outputDelaySec - minSpacingSec);
+    double nowSec = static_cast<double>(now.QuadPart) / freq;
+    double deadlineSec = nowSec + 0.0005;
+    if (tick.valid) {
+      deadlineSec = m_displayClock.QpcFromCaptureTime(tick.timeSec + outputDelaySec);
+      // The output delay follows the average interval; never present faster
+      // than the ceiling when it shrinks.
+      if (m_lastPresentQpc != 0) {
+        deadlineSec = std::max(deadlineSec, static_cast<double>(m_lastPresentQpc) / freq + minSpacingSec);
+      }
+    }
+
+    // Nothing queued yet, or a hold that a new frame may still pre-empt:
+    // poll again after the next capture update.
+    constexpr double kVrrPollSec = 0.001;
+    if (!tick.valid || (tick.hold && deadlineSec > nowSec + kVrrPollSec)) {
+      m_outputWaiter.WaitUntil(std::min(deadlineSec, nowSec + kVrrPollSec));
+      return;
+    }
+
+    if (deadlineSec > nowSec) {
+      m_outputWaiter.WaitUntil(deadlineSec);
+      QueryPerformanceCounter(&now);
+      nowTime100ns = m_displayClock.CaptureTimeFromQpc(static_cast<double>(now.QuadPart) / freq) * 1e7;
+    }
+    m_vrrScheduler.Advance(tick);
+    vrrHasTick = true;
+    vrrHold = tick.hold;
+    vrrDisplayTime100ns = tick.timeSec * 1e7;
+    m_nextOutputQpc = 0;
+    m_nextOutputQpcD = 0.0;
+  } else if (limitOutput && m_targetFps > 0.0f && freq > 0.0) {
     double targetFps = static_cast<double>(m_targetFps);
-    intervalQpc = static_cast<int64_t>(freq / targetFps);
+    double intervalQpcD = freq / targetFps;
+    intervalQpc = static_cast<int64_t>(intervalQpcD);
     if (intervalQpc < 1) intervalQpc = 1;
     
-    if (m_nextOutputQpc == 0) {
-      m_nextOutputQpc = now.QuadPart;
+    // The ideal cadence accumulates in double so freq / targetFps does not
+    // truncate into a slow drift; the actual deadline is that ideal snapped
+    // onto the display PLL's vblank grid.
+    if (m_nextOutputQpcD <= 0.0) {
+      m_nextOutputQpcD = static_cast<double>(now.QuadPart);
     } else {
         // If we fall behind by more than 1.5 frames, re-anchor phase from 'now'
         // instead of hard-resetting. This maintains smooth cadence.
-        int64_t behind = now.QuadPart - m_nextOutputQpc;
-        if (behind > intervalQpc + intervalQpc / 2) {
+        double behind = static_cast<double>(now.QuadPart) - m_nextOutputQpcD;
+        if (behind > intervalQpcD * 1.5) {
              // Skip missed frames but keep phase-aligned
-             int64_t skipped = behind / intervalQpc;
-             m_nextOutputQpc += skipped * intervalQpc;
+             double skipped = std::floor(behind / intervalQpcD);
+             m_nextOutputQpcD += skipped * intervalQpcD;
         }
     }
     
-    m_nextOutputQpc += intervalQpc;
+    m_nextOutputQpcD += intervalQpcD;
+    double deadlineSec = m_displayClock.SnapDeadline(m_nextOutputQpcD / freq, intervalQpcD / freq);
+    m_nextOutputQpc = static_cast<int64_t>(deadlineSec * freq);
     
     int64_t remainingQpc = m_nextOutputQpc - now.QuadPart;
     if (remainingQpc > 0) {
-         double seconds = static_cast<double>(remainingQpc) / freq;
-         int64_t hundredsNs = static_cast<int64_t>(seconds * 10000000.0);
-         
-        if (hundredsNs > 20000) { // Sleep if > 2.0ms
-            LARGE_INTEGER performWait = {};
-            performWait.QuadPart = -hundredsNs;
-            SetWaitableTimer(m_waitTimer, &performWait, 0, nullptr, nullptr, 0);
-            WaitForSingleObject(m_waitTimer, INFINITE);
-        }
-         
-         // Spin for the last <1ms for precision
+         // Sleep on the high-resolution timer, spin only the calibrated tail.
+         m_outputWaiter.WaitUntil(static_cast<double>(m_nextOutputQpc) / freq);
          QueryPerformanceCounter(&now);
-         while(now.QuadPart < m_nextOutputQpc) {
-             YieldProcessor();
-             QueryPerformanceCounter(&now);
-         }
          
          // Recalculate time after wait
          if (freq > 0.0) {
-            double qpcTo100ns = 1e7 / freq;
-            if (m_timeOffsetValid) {
-                nowTime100ns = static_cast<double>(now.QuadPart) * qpcTo100ns + m_timeOffset100ns;
-            } else {
-                nowTime100ns = static_cast<double>(now.QuadPart) * qpcTo100ns;
-            }
+            nowTime100ns = m_displayClock.CaptureTimeFromQpc(static_cast<double>(now.QuadPart) / freq) * 1e7;
          }
     }
   } else {
     m_nextOutputQpc = 0;
+    m_nextOutputQpcD = 0.0;
   }
 
   // Keep a small pacing buffer: 3 frames gives 1 pair + 1 lookahead.
@@ -1574,10 +1898,15 @@ void App::Render() {
   constexpr size_t kPacingQueueSize = 3;
   while (m_frameQueue.size() > kPacingQueueSize) {
     m_frameQueue.pop_front();
-    m_pairMotionComputed = false;
+    CountDrop(TelemetryDrop::PacingTrim);
   }
 
+  TelemetryRecord telemetry;
+  telemetry.waitMs = static_cast<float>((DeadlineWaiter::Now() - renderStartSec) * 1000.0);
+
   ID3D11Texture2D* output = nullptr;
+  // Identity of the selected output; 0 means "always present" (debug views).
+  uint64_t outputId = 0;
   m_lastAlpha = 1.0f;
   m_lastInterpolated = false;
   m_outputDelayMs = 0.0f;
@@ -1595,11 +1924,8 @@ void App::Render() {
       m_nextOutputTime100ns = 0.0;
     }
 
-    double baseIntervalSec = (m_avgFrameInterval > 0.0) ? m_avgFrameInterval : 0.0166666;
-    double outputDelaySec = std::clamp(
-        baseIntervalSec * static_cast<double>(m_pacingDelayFactor), 0.001, 0.080);
     m_outputDelayMs = static_cast<float>(outputDelaySec * 1000.0);
-    double displayTime100ns = nowTime100ns - outputDelaySec * 1e7;
+    double displayTime100ns = vrrHasTick ? vrrDisplayTime100ns : nowTime100ns - outputDelaySec * 1e7;
     if (displayTime100ns < 0.0) {
       displayTime100ns = 0.0;
     }
@@ -1612,12 +1938,12 @@ void App::Render() {
       int64_t cTime100ns = m_frameTime100ns[c];
       if (cTime100ns <= pTime100ns) {
         m_frameQueue.pop_front();
-        m_pairMotionComputed = false;
+        CountDrop(TelemetryDrop::Duplicate);
         continue;
       }
       if (displayTime100ns >= static_cast<double>(cTime100ns) && m_frameQueue.size() > 2) {
         m_frameQueue.pop_front();
-        m_pairMotionComputed = false;
+        CountDrop(TelemetryDrop::Stale);
         continue;
       }
       break;
@@ -1628,6 +1954,9 @@ void App::Render() {
     bool hasPair = (m_frameQueue.size() >= 2);
     bool hasPrevSrv = (m_frameSrvs[prevSlot] != nullptr);
     bool hasCurrSrv = (m_frameSrvs[currSlot] != nullptr);
+    telemetry.queueDepth = static_cast<uint8_t>(m_frameQueue.size());
+    telemetry.currTime100ns = m_frameTime100ns[currSlot];
+    telemetry.displayTime100ns = m_frameTime100ns[currSlot];
 
     if (hasPair) {
       int64_t prevTime100ns = m_frameTime100ns[prevSlot];
@@ -1636,19 +1965,19 @@ void App::Render() {
                          (currSlot != m_pairCurrSlot) ||
                          (prevTime100ns != m_pairPrevTime100ns) ||
                          (currTime100ns != m_pairCurrTime100ns);
+      telemetry.flags |= kTelemetryHasPair;
       if (pairChanged) {
+        telemetry.flags |= kTelemetryNewPair;
         m_pairPrevSlot = prevSlot;
         m_pairCurrSlot = currSlot;
         m_pairPrevTime100ns = prevTime100ns;
         m_pairCurrTime100ns = currTime100ns;
-        m_pairMotionComputed = false;
       }
     } else {
       m_pairPrevSlot = -1;
       m_pairCurrSlot = -1;
       m_pairPrevTime100ns = 0;
       m_pairCurrTime100ns = 0;
-      m_pairMotionComputed = false;
       m_outputStepIndex = 0;
     }
 
@@ -1665,7 +1994,7 @@ void App::Render() {
     if (intervalSec <= 0.0 || intervalSec > 0.5) {
       intervalSec = baseIntervalSec;
     }
-    if (m_avgFrameInterval > 0.0) {
+    if (m_avgFrameInterval > 0.0 && !useVrr) {
       double minInterval = m_avgFrameInterval * 0.75;
       double maxInterval = m_avgFrameInterval * 1.35;
       intervalSec = std::clamp(intervalSec, minInterval, maxInterval);
@@ -1699,6 +2028,8 @@ void App::Render() {
     m_lastUnstable = unstable;
     m_lastAlpha = alpha;
     m_lastInterpolated = canInterpolate;
+    telemetry.alpha = alpha;
+    telemetry.pairIntervalMs = static_cast<float>(intervalSec * 1000.0);
 
     m_holdEndFrame = canInterpolate && alpha >= 1.0f;
 
@@ -1727,29 +2058,97 @@ void App::Render() {
       }
       m_interpolator.Debug(prevSrv, currSrv, debugMode, m_debugMotionScale, m_debugDiffScale);
       output = m_interpolator.OutputTexture();
+      telemetry.path = static_cast<uint8_t>(TelemetryPath::Debug);
 
     } else if (canInterpolate) {
       // Interpolation path
-      // First sub-frame of a new pair: full motion estimation + interpolation
-      // Subsequent sub-frames: re-warp only (reuse cached motion field)
-      if (!m_pairMotionComputed) {
-        m_interpolator.Execute(m_frameSrvs[prevSlot].Get(), m_frameSrvs[currSlot].Get(), alpha);
-        m_pairMotionComputed = true;
+      // Output cache: alpha is quantized to a bucket and each bucket is
+      // generated once per pair; later loops that land in the same bucket
+      // re-present the stored frame.
+      int cacheBucket = -1;
+      int cacheSlot = -1;
+      if (m_outputCacheEnabled) {
+        uint64_t settingsKey = HashCombine(0, static_cast<uint64_t>(m_motionModel));
+        settingsKey = HashCombine(settingsKey, static_cast<uint64_t>(m_interpolationQuality));
+        settingsKey = HashCombine(settingsKey, m_minimalMotionPipeline ? 1u : 0u);
+        settingsKey = HashCombine(settingsKey, FloatBits(m_motionEdgeScale));
+        settingsKey = HashCombine(settingsKey, FloatBits(m_confidencePower));
+        settingsKey = HashCombine(settingsKey, static_cast<uint64_t>(m_outputWidth));
+        settingsKey = HashCombine(settingsKey, static_cast<uint64_t>(m_outputHeight));
+        if (settingsKey != m_outputCacheSettingsKey) {
+          m_outputCacheSettingsKey = settingsKey;
+          m_outputCache.Invalidate();
+        }
+        m_outputCache.SetStep(m_outputCacheStep);
+        m_outputCache.BeginPair(m_frameTime100ns[prevSlot], m_frameTime100ns[currSlot]);
+        cacheBucket = m_outputCache.Bucket(alpha);
+        cacheSlot = m_outputCache.Lookup(cacheBucket);
+        if (cacheSlot >= 0 && !m_outputCacheTextures[cacheSlot]) {
+          cacheSlot = -1;
+        }
+        outputId = HashCombine(m_outputCache.PairGeneration(), static_cast<uint64_t>(cacheBucket) + 1);
+      }
+
+      if (cacheSlot >= 0) {
+        output = m_outputCacheTextures[cacheSlot].Get();
+        telemetry.path = static_cast<uint8_t>(TelemetryPath::CachedOutput);
       } else {
-        m_interpolator.InterpolateOnly(m_frameSrvs[prevSlot].Get(), m_frameSrvs[currSlot].Get(), alpha);
+        if (cacheBucket >= 0) {
+          alpha = m_outputCache.BucketAlpha(cacheBucket);
+          m_lastAlpha = alpha;
+        }
+        LARGE_INTEGER genStart = {};
+        QueryPerformanceCounter(&genStart);
+        // Motion is keyed by frame content, so only a pair never seen before
+        // runs motion estimation; queue trims, stale drops and multiplier
+        // switches that re-select a known pair re-warp from cached motion.
+        MotionSetKey motionKey;
+        motionKey.prevSequence = m_frameSequence[prevSlot];
+        motionKey.prevTime100ns = m_frameTime100ns[prevSlot];
+        motionKey.currSequence = m_frameSequence[currSlot];
+        motionKey.currTime100ns = m_frameTime100ns[currSlot];
+        // Planes only when both frames of the pair have one.
+        const bool pairHasLuma = m_frameHasLuma[prevSlot] && m_frameHasLuma[currSlot];
+        m_interpolator.SetSourceLuma(pairHasLuma ? m_frameLumaSrvs[prevSlot].Get() : nullptr,
+                                     pairHasLuma ? m_frameLumaSrvs[currSlot].Get() : nullptr);
+        m_interpolator.ExecuteCached(m_frameSrvs[prevSlot].Get(), m_frameSrvs[currSlot].Get(), alpha, motionKey);
+        LARGE_INTEGER genEnd = {};
+        QueryPerformanceCounter(&genEnd);
+        output = m_interpolator.OutputTexture();
+        telemetry.path = static_cast<uint8_t>(TelemetryPath::Interpolated);
+        telemetry.generateMs = static_cast<float>(static_cast<double>(genEnd.QuadPart - genStart.QuadPart) * 1000.0 /
+                                                  static_cast<double>(m_qpcFreq.QuadPart));
+
+        if (cacheBucket >= 0) {
+          m_outputCache.RecordMissCost(
+              static_cast<double>(genEnd.QuadPart - genStart.QuadPart) / static_cast<double>(m_qpcFreq.QuadPart),
+              0.0);
+          if (EnsureOutputCacheTextures()) {
+            int slot = m_outputCache.Insert(cacheBucket);
+            context->CopyResource(m_outputCacheTextures[slot].Get(), output);
+          }
+        }
       }
-      output = m_interpolator.OutputTexture();
+      // Content time the generated frame stands for (alpha may be the bucket's).
+      telemetry.alpha = m_lastAlpha;
+      telemetry.displayTime100ns = m_frameTime100ns[prevSlot] +
+                                   static_cast<int64_t>(static_cast<double>(m_lastAlpha) * intervalSec * 1e7);
 
     } else {
       // No interpolation - blit with scaling or pass-through
       if (needScale && hasCurrSrv) {
         m_interpolator.Blit(m_frameSrvs[currSlot].Get());
         output = m_interpolator.OutputTexture();
+        telemetry.path = static_cast<uint8_t>(TelemetryPath::Blit);
       } else {
         output = m_frameTextures[currSlot].Get();
+        telemetry.path = static_cast<uint8_t>(TelemetryPath::Passthrough);
       }
+      outputId = HashCombine(static_cast<uint64_t>(m_frameTime100ns[currSlot]),
+                             needScale ? 2u : 1u);
     }
   }
+  RecordGenerationGpuCost();
 
   ID3D11ShaderResourceView* outputSrv = nullptr;
   int outputWidth = 0;
@@ -1760,7 +2159,15 @@ void App::Render() {
       outputWidth = m_outputWidth;
       outputHeight = m_outputHeight;
     } else {
-      for (int i = 0; i < kFrameQueueSize; ++i) {
+      for (int i = 0; i < kOutputCacheSlots; ++i) {
+        if (output == m_outputCacheTextures[i].Get()) {
+          outputSrv = m_outputCacheSrvs[i].Get();
+          outputWidth = m_outputWidth;
+          outputHeight = m_outputHeight;
+          break;
+        }
+      }
+      for (int i = 0; i < kFrameQueueSize && !outputSrv; ++i) {
         if (output == m_frameTextures[i].Get()) {
           outputSrv = m_frameSrvs[i].Get();
           outputWidth = m_frameWidth;
@@ -1781,7 +2188,20 @@ void App::Render() {
     m_lastOutputHeight = 0;
   }
 
-  if (m_outputDisplayMode == 0 || m_outputDisplayMode == 2) {
+  // A present of exactly the frame already on screen changes nothing; skip
+  // it (and the back buffer copy) instead of burning a flip on it.
+  // VRR holds re-present on purpose to stay above the panel's floor.
+  bool skipPresent = m_outputCacheEnabled && output && outputId != 0 &&
+                     outputId == m_lastPresentedOutputId && !vrrHold;
+  if (skipPresent) {
+    m_outputCache.RecordPresentSkipped();
+    telemetry.flags |= kTelemetryPresentSkipped;
+  }
+  if (vrrHold) {
+    telemetry.flags |= kTelemetryVrrHold;
+  }
+
+  if ((m_outputDisplayMode == 0 || m_outputDisplayMode == 2) && !skipPresent) {
     Microsoft::WRL::ComPtr<ID3D11Texture2D> backBuffer;
     if (SUCCEEDED(m_device.SwapChain()->GetBuffer(0, IID_PPV_ARGS(&backBuffer)))) {
       if (output) {
@@ -1821,8 +2241,19 @@ void App::Render() {
     }
   }
 
-  if (m_outputDisplayMode == 0 || m_outputDisplayMode == 2) {
-    bool presentVsync = m_useVsync || useMonitorSync;
+  if ((m_outputDisplayMode == 0 || m_outputDisplayMode == 2) && skipPresent) {
+    // Nothing new to show: yield until the next refresh (or briefly, when the
+    // display PLL has no lock) rather than spinning the render loop. The
+    // latency slot stays held for the next frame's present.
+    double nowSec = DeadlineWaiter::Now();
+    double wakeSec = nowSec + 0.0005;
+    if (m_displayClock.IsDisplayLocked()) {
+      wakeSec = std::min(m_displayClock.NextVblank(nowSec), nowSec + 0.004);
+    }
+    m_outputWaiter.WaitUntil(wakeSec);
+  } else if (m_outputDisplayMode == 0 || m_outputDisplayMode == 2) {
+    // VRR scans out on present; a sync interval would re-quantize the schedule.
+    bool presentVsync = (m_useVsync || useMonitorSync) && !useVrr;
     
     // Force sync interval 0 if unlocked app fps is on
     if (m_unlockAppFps) {
@@ -1840,7 +2271,16 @@ void App::Render() {
         presentFlags |= DXGI_PRESENT_DO_NOT_WAIT;
     }
 
+    const double presentStartSec = DeadlineWaiter::Now();
     HRESULT hr = m_device.SwapChain()->Present(syncInterval, presentFlags);
+    telemetry.presentMs = static_cast<float>((DeadlineWaiter::Now() - presentStartSec) * 1000.0);
+    m_lastPresentedOutputId = (hr == DXGI_ERROR_WAS_STILL_DRAWING) ? 0 : outputId;
+    if (hr != DXGI_ERROR_WAS_STILL_DRAWING) {
+      m_frameLatencySlotHeld = false;
+      telemetry.flags |= kTelemetryPresented;
+    } else {
+      CountDrop(TelemetryDrop::PresentBusy);
+    }
     
     // If DO_NOT_WAIT dropped the frame, it's fine, we'll try next loop
     if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
@@ -1855,6 +2295,18 @@ void App::Render() {
     }
 
     if (m_qpcFreq.QuadPart > 0) {
+      // Feed the display PLL with present-completion (vblank) timestamps.
+      // Frame statistics only advance when a new refresh was actually used.
+      // Under VRR the refresh follows the presents, so there is no grid.
+      DXGI_FRAME_STATISTICS frameStats = {};
+      if (!useVrr && SUCCEEDED(m_device.SwapChain()->GetFrameStatistics(&frameStats)) &&
+          frameStats.SyncQPCTime.QuadPart != 0 &&
+          frameStats.SyncRefreshCount != m_lastSyncRefreshCount) {
+        m_lastSyncRefreshCount = frameStats.SyncRefreshCount;
+        m_displayClock.AddVblankSample(static_cast<double>(frameStats.SyncQPCTime.QuadPart) /
+                                       static_cast<double>(m_qpcFreq.QuadPart));
+      }
+
       LARGE_INTEGER now = {};
       QueryPerformanceCounter(&now);
       if (m_lastPresentQpc != 0) {
@@ -1880,6 +2332,10 @@ void App::Render() {
   if (intervalQpc > 0 && limitOutput) {
      // Intentionally empty, m_nextOutputQpc already updated
   }
+
+  if (m_telemetry.IsRecording()) {
+    SubmitTelemetry(telemetry);
+  }
 }
 
 void App::RenderUiWindow() {
@@ -1944,6 +2400,70 @@ void App::UpdateUiSwapChain(UINT width, UINT height) {
   }
 }
 
+bool App::EnsureOutputCacheTextures() {
+  ID3D11Texture2D* source = m_interpolator.OutputTexture();
+  if (!source) {
+    return false;
+  }
+  D3D11_TEXTURE2D_DESC sourceDesc = {};
+  source->GetDesc(&sourceDesc);
+
+  if (m_outputCacheTextures[0]) {
+    D3D11_TEXTURE2D_DESC cacheDesc = {};
+    m_outputCacheTextures[0]->GetDesc(&cacheDesc);
+    if (cacheDesc.Width == sourceDesc.Width && cacheDesc.Height == sourceDesc.Height &&
+        cacheDesc.Format == sourceDesc.Format) {
+      return true;
+    }
+  }
+
+  m_outputCache.Invalidate();
+  D3D11_TEXTURE2D_DESC desc = {};
+  desc.Width = sourceDesc.Width;
+  desc.Height = sourceDesc.Height;
+  desc.MipLevels = 1;
+  desc.ArraySize = 1;
+  desc.Format = sourceDesc.Format;
+  desc.SampleDesc.Count = 1;
+  desc.Usage = D3D11_USAGE_DEFAULT;
+  desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+  for (int i = 0; i < kOutputCacheSlots; ++i) {
+    m_outputCacheTextures[i].Reset();
+    m_outputCacheSrvs[i].Reset();
+    if (FAILED(m_device.Device()->CreateTexture2D(&desc, nullptr, &m_outputCacheTextures[i])) ||
+        FAILED(m_device.Device()->CreateShaderResourceView(m_outputCacheTextures[i].Get(), nullptr,
+                                                           &m_outputCacheSrvs[i]))) {
+      for (int j = 0; j <= i; ++j) {
+        m_outputCacheTextures[j].Reset();
+        m_outputCacheSrvs[j].Reset();
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+// Full stage timing stays on while the panel shows it and while telemetry
+// records stage times; the output cache only needs the generation brackets.
+void App::ApplyStageTiming() {
+  m_interpolator.SetStageTimingEnabled(m_stageTimingEnabled || m_telemetry.IsRecording());
+  m_interpolator.SetGenerationTimingEnabled(m_outputCacheEnabled);
+}
+
+// The profiler's D3D11 timestamps bracket every generation, full (Execute)
+// or re-warp (InterpolateOnly), also with full timing off; their GPU samples
+// resolve a few frames late.
+void App::RecordGenerationGpuCost() {
+  m_gpuCostStageSamples.clear();
+  m_gpuCostStageCursor = m_interpolator.StageTimes().SnapshotSince(m_gpuCostStageCursor, m_gpuCostStageSamples);
+  for (const StageSample& sample : m_gpuCostStageSamples) {
+    if (sample.domain == TimingDomain::Gpu &&
+        (sample.stage == PipelineStage::Execute || sample.stage == PipelineStage::InterpolateOnly)) {
+      m_outputCache.RecordGpuCost(sample.endSec - sample.beginSec);
+    }
+  }
+}
+
 void App::RenderUi() {
   ImGui::SetNextWindowPos(ImVec2(20.0f, 20.0f), ImGuiCond_Always);
   ImGui::SetNextWindowBgAlpha(0.90f);
@@ -2066,9 +2586,9 @@ void App::RenderUi() {
   }
   if (ImGui::IsItemHovered()) ImGui::SetTooltip("Rescan for available windows to capture.\\nUse after opening/closing applications.");
 
-  const char* captureModes[] = {"Window", "Monitor", "Game (Hook)", "DXGI Crop"};
+  const char* captureModes[] = {"Window", "Monitor", "Game (Hook)", "DXGI Crop", "Replay"};
   ImGui::Combo("Capture Mode", &m_captureMode, captureModes, IM_ARRAYSIZE(captureModes));
-  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Window: WGC capture (may be limited to 60fps by DWM)\\nMonitor: Capture entire monitor at full refresh rate\\nGame (Hook): DLL injection (blocked by anti-cheat)\\nDXGI Crop: Capture monitor at full refresh rate, crop to window (best for >60fps)");
+  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Window: WGC capture (may be limited to 60fps by DWM)\\nMonitor: Capture entire monitor at full refresh rate\\nGame (Hook): DLL injection (blocked by anti-cheat)\\nDXGI Crop: Capture monitor at full refresh rate, crop to window (best for >60fps)\nReplay: Play back a recorded frame stream (.tmfs) with its original timing");
 
   if (m_captureMode == 0 && !m_windows.empty()) {
     std::string windowPreview;
@@ -2157,6 +2677,57 @@ void App::RenderUi() {
     ImGui::TextWrapped("Note: Hook-based capture requires the game to use DirectX 11. Run as Administrator if injection fails.");
   }
 
+  if (m_captureMode == 4) {
+    ImGui::InputText("Recording", m_replayPath.data(), m_replayPath.size());
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Path of a recorded frame stream (.tmfs).");
+    if (ImGui::SliderFloat("Replay Speed", &m_replaySpeed, 0.25f, 4.0f, "%.2fx")) {
+      m_replaySource.SetSpeed(m_replaySpeed);
+    }
+    if (ImGui::Checkbox("Loop", &m_replayLoop)) {
+      m_replaySource.SetLoop(m_replayLoop);
+    }
+    if (m_replaySource.IsCapturing()) {
+      ImGui::Text("Replay: %llu frames, %llu loops", static_cast<unsigned long long>(m_replaySource.Stats().frames),
+                  static_cast<unsigned long long>(m_replaySource.Stats().loops));
+      if (ImGui::Button("Stop Replay")) {
+        m_replaySource.StopCapture();
+        m_captureStatus = "Replay stopped";
+      }
+    } else if (ImGui::Button("Start Replay")) {
+      if (StartReplayCapture()) {
+        m_captureStatus = "Replay started";
+        ResetCaptureState();
+      } else {
+        m_captureStatus = "Replay failed: " + m_replaySource.GetLastError();
+      }
+    }
+  }
+
+  ImGui::Separator();
+  bool recording = m_recorder.IsRecording();
+  if (recording) {
+    ImGui::BeginDisabled();
+  }
+  ImGui::InputText("Record To", m_recordPath.data(), m_recordPath.size());
+  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Frame stream file (.tmfs) for the captured session; play it back in Replay mode.");
+  ImGui::Checkbox("LZ4 Compress", &m_recordCompress);
+  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Compress each frame on the writer thread.\nSmaller files; uncompressed files replay without a copy.");
+  if (recording) {
+    ImGui::EndDisabled();
+  }
+  if (ImGui::Checkbox("Record Session", &recording)) {
+    if (recording) {
+      if (StartRecording()) {
+        m_captureStatus = std::string("Recording to ") + m_recordPath.data();
+      } else {
+        m_captureStatus = std::string("Cannot record to ") + m_recordPath.data();
+      }
+    } else {
+      StopRecording();
+      m_captureStatus = "Recording stopped";
+    }
+  }
+
   // DXGI Crop mode - capture monitor, crop to window
   if (m_captureMode == 3 && !m_windows.empty()) {
     std::string windowPreview;
@@ -2184,10 +2755,8 @@ void App::RenderUi() {
       HWND hwnd = m_windows[m_selectedWindow].hwnd;
       HMONITOR monitor = MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
       
-      std::ofstream log("dxgi_crop_debug.txt");
-      log << "Attempting DXGI Crop Capture\n";
-      log << "Target Window: " << (void*)hwnd << "\n";
-      log << "Target Monitor: " << (void*)monitor << "\n";
+      TFE_LOG(Info, Capture, "Attempting DXGI Crop Capture: window={} monitor={}", static_cast<void*>(hwnd),
+              static_cast<void*>(monitor));
       
       if (monitor) {
         m_captureWindow = hwnd;  // Store window for cropping
@@ -2200,7 +2769,7 @@ void App::RenderUi() {
           HMONITOR currentMonitor = MonitorFromWindow(m_hwnd, MONITOR_DEFAULTTONEAREST);
           if (currentMonitor == monitor) {
             // Output is on same monitor as capture target - need to move it
-            log << "Output window on same monitor as capture target - moving to different monitor\n";
+            TFE_LOG(Info, Capture, "Output window on same monitor as capture target - moving to different monitor");
             
             // Store original position for later restoration
             WINDOWPLACEMENT wp = { sizeof(WINDOWPLACEMENT) };
@@ -2235,36 +2804,34 @@ void App::RenderUi() {
                 int newY = mi.rcWork.top + (monitorH - winH) / 2;
                 
                 SetWindowPos(m_hwnd, HWND_TOPMOST, newX, newY, winW, winH, SWP_SHOWWINDOW);
-                log << "Moved output window to other monitor at (" << newX << "," << newY << ")\n";
+                TFE_LOG(Info, Capture, "Moved output window to other monitor at ({},{})", newX, newY);
                 m_dxgiCropModeActive = true;
               }
             } else {
               // No other monitor available - try to hide the overlay temporarily
-              log << "No other monitor available - overlay will cause feedback\n";
+              TFE_LOG(Warn, Capture, "No other monitor available - overlay will cause feedback");
               // We'll still try, but it may not work well
             }
           } else {
-            log << "Output window already on different monitor\n";
+            TFE_LOG(Info, Capture, "Output window already on different monitor");
             m_dxgiCropModeActive = true;
           }
         }
         
-        log << "Starting monitor capture...\n";
         if (StartMonitorCapture(monitor)) {
           m_captureStatus = "DXGI Crop capture started";
           ResetCaptureState();
-          log << "StartMonitorCapture returned TRUE\n";
+          TFE_LOG(Info, Capture, "StartMonitorCapture succeeded");
         } else {
           m_captureStatus = "DXGI capture failed";
           m_captureWindow = nullptr;
           m_dxgiCropModeActive = false;
-          log << "StartMonitorCapture returned FALSE\n";
+          TFE_LOG(Warn, Capture, "StartMonitorCapture failed");
         }
       } else {
-        log << "MonitorFromWindow failed\n";
+        TFE_LOG(Warn, Capture, "MonitorFromWindow failed");
         m_captureStatus = "Failed to get monitor for window";
       }
-      log.close();
     }
     ImGui::TextColored(ImVec4(0.3f, 1.0f, 0.3f, 1.0f), "Captures monitor at full refresh rate, crops to window");
     ImGui::TextWrapped("Best for >60fps capture when WGC is limited by DWM.");
@@ -2399,6 +2966,18 @@ void App::RenderUi() {
 
     ImGui::Checkbox("Force WGC Capture (No Fallback)", &m_forceWgcCapture);
     if (ImGui::IsItemHovered()) ImGui::SetTooltip("Never fallback to Desktop Duplication if WGC fails.\nUse when Desktop Duplication causes issues.");
+
+    const char* queuePolicies[] = {"Latest Only", "FIFO", "Time Window"};
+    bool queueChanged = ImGui::Combo("WGC Queue", &m_wgcQueuePolicy, queuePolicies, IM_ARRAYSIZE(queuePolicies));
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Latest Only: always the newest frame, skips frames when behind (lowest latency)\nFIFO: every frame in order, up to a depth\nTime Window: in order, but frames older than the window are skipped\nThe WGC frame pool is sized from the measured frame rate and lag.");
+    if (m_wgcQueuePolicy == 1) {
+      queueChanged |= ImGui::SliderInt("FIFO Depth", &m_wgcFifoDepth, 1, 6);
+    } else if (m_wgcQueuePolicy == 2) {
+      queueChanged |= ImGui::SliderFloat("Queue Window", &m_wgcWindowMs, 5.0f, 100.0f, "%.0f ms");
+    }
+    if (queueChanged) {
+      ApplyWgcQueueConfig();
+    }
     
     ImGui::Checkbox("Unlock App FPS (High CPU)", &m_unlockAppFps);
     if (ImGui::IsItemHovered()) ImGui::SetTooltip("Removes frame pacing limits.\nAllows the capture loop to run as fast as possible (1000+ FPS).\nEssential for capturing >60FPS on some systems.\nWARNING: Increases CPU usage.");
@@ -2414,9 +2993,15 @@ void App::RenderUi() {
   }
 
   ImGui::Separator();
-  const char* outputModes[] = {"Multiplier", "Monitor Sync"};
+  const char* outputModes[] = {"Multiplier", "Monitor Sync", "Variable Rate (VRR)"};
   ImGui::Combo("Output Mode", &m_outputMode, outputModes, IM_ARRAYSIZE(outputModes));
-  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Multiplier: Output at capture FPS x multiplier (e.g., 60->120)\nMonitor Sync: Match monitor refresh rate for smoothest output");
+  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Multiplier: Output at capture FPS x multiplier (e.g., 60->120)\nMonitor Sync: Match monitor refresh rate for smoothest output\nVariable Rate: Evenly spaced frames between actual source frames (G-Sync/FreeSync)");
+  if (m_outputMode == 2) {
+    ImGui::SliderFloat("VRR Max Hz", &m_vrrMaxHz, 0.0f, 500.0f, m_vrrMaxHz > 0.0f ? "%.0f" : "Refresh");
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Highest present rate (0 = monitor refresh).\nFrames per source pair = min(multiplier, pair interval x max Hz).");
+    ImGui::SliderFloat("VRR Min Hz", &m_vrrMinHz, 0.0f, 120.0f, "%.0f");
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Bottom of the monitor's VRR range.\nLong source gaps get extra frames, and stalls re-present at this rate.");
+  }
   
   const char* outputDisplays[] = {"Output Window", "Preview (UI)", "Overlay (click-through)"};
   bool forceOutputWindow = (m_captureMode == 0 &&
@@ -2446,6 +3031,15 @@ void App::RenderUi() {
   
   // Smooth Blend removed
 
+  if (ImGui::Checkbox("Alpha Output Cache", &m_outputCacheEnabled)) {
+    ApplyStageTiming();
+  }
+  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Generate each quantized alpha once per frame pair and reuse it.\nSkips presents that would show the same frame again.\nMostly helps with Unlock App FPS or monitor-sync output.");
+  if (m_outputCacheEnabled) {
+    ImGui::SliderFloat("Alpha Cache Step", &m_outputCacheStep, 0.005f, 0.1f, "%.3f");
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Alpha quantization step.\nSmaller = finer motion steps, fewer cache hits.");
+  }
+
   ImGui::Checkbox("Limit Output FPS", &m_limitOutputFps);
   const char* limitFpsHelp = "Limit frame rate using a high-resolution waitable timer.\nDisable Monitor Sync to use this pacing.";
   if (ImGui::IsItemHovered()) ImGui::SetTooltip("%s", limitFpsHelp);
@@ -2596,6 +3190,10 @@ void App::RenderUi() {
       m_debugView == static_cast<int>(Interpolator::DebugViewMode::MotionNeedles)) {
     ImGui::SliderFloat("Motion Scale", &m_debugMotionScale, 0.005f, 0.2f, "%.3f");
   }
+  if (ImGui::Button("Export Motion Fields (.flo)")) {
+    ExportMotionFields();
+  }
+  if (ImGui::IsItemHovered()) ImGui::SetTooltip("Writes the last motion pyramid as Middlebury .flo files\n(eighth-res forward/backward; quarter and half-res with the full pipeline)\nfor scoring with tools/flow_eval");
   if (m_debugView == static_cast<int>(Interpolator::DebugViewMode::ResidualError)) {
     ImGui::SliderFloat("Diff Scale", &m_debugDiffScale, 0.5f, 8.0f, "%.2f");
   }
@@ -2606,6 +3204,21 @@ void App::RenderUi() {
   float targetFps = m_targetFps;
   ImGui::Text("Capture FPS: %.1f", captureFps);
   ImGui::Text("Actual Capture: %.1f", m_captureFps);
+  ImGui::Text("Source Frames Skipped: %llu", static_cast<unsigned long long>(m_sourceFramesSkipped));
+  ImGui::Text("Producer Luma Frames: %llu", static_cast<unsigned long long>(m_producerLumaFrames));
+  if (m_recorder.IsRecording()) {
+    const SessionRecorderStats recordStats = m_recorder.Stats();
+    ImGui::Text("Recording: %llu frames, %.1f MB (%llu dropped, %llu readback misses)",
+                static_cast<unsigned long long>(recordStats.written),
+                static_cast<double>(recordStats.fileBytes) / (1024.0 * 1024.0),
+                static_cast<unsigned long long>(recordStats.dropped),
+                static_cast<unsigned long long>(m_recordStagingDrops));
+  }
+  if (m_captureMode == 3) {
+    const CaptureRegion& cropRegion = m_cropRegion.Region();
+    ImGui::Text("Crop Region: %dx%d at %d,%d (%llu reads)", cropRegion.width, cropRegion.height,
+                cropRegion.x, cropRegion.y, static_cast<unsigned long long>(m_cropRegion.Refreshes()));
+  }
   ImGui::Text("Target FPS: %.1f", targetFps);
   ImGui::Text("Output FPS: %.1f", m_presentFps);
   ImGui::Text("Monitor Hz: %.1f", monitorHz);
@@ -2647,6 +3260,96 @@ void App::RenderUi() {
   ImGui::Text("Interpolated: %s", m_lastInterpolated ? "yes" : "no");
   ImGui::Text("Interval: %.2f ms", m_lastIntervalMs);
   ImGui::Text("Avg Interval: %.2f ms", m_lastAvgIntervalMs);
+  {
+    DisplayClockStats clockStats = m_displayClock.Stats();
+    ImGui::Text("Display PLL: %s  %.3f ms  err %.3f ms", clockStats.displayLocked ? "locked" : "acquiring",
+                clockStats.displayPeriodSec * 1000.0, clockStats.meanAbsPhaseErrorSec * 1000.0);
+    ImGui::Text("Capture Clock Drift: %.1f ppm", clockStats.captureDriftPpm);
+    const OutputCacheStats& cacheStats = m_outputCache.Stats();
+    ImGui::Text("Output Cache: %.0f%% hit, %llu presents skipped", cacheStats.HitRate() * 100.0,
+                static_cast<unsigned long long>(cacheStats.presentsSkipped));
+    ImGui::Text("Cache Saved: CPU %.1f ms, GPU %.1f ms", cacheStats.savedCpuSec * 1000.0,
+                cacheStats.savedGpuSec * 1000.0);
+    const MotionCacheStats& motionStats = m_interpolator.GetMotionCacheStats();
+    ImGui::Text("Motion Cache: %.0f%% reuse, %llu ME runs, %llu restores", motionStats.HitRate() * 100.0,
+                static_cast<unsigned long long>(motionStats.computes),
+                static_cast<unsigned long long>(motionStats.restores));
+    const ResourceFootprint footprint = m_interpolator.Resources().Footprint();
+    ImGui::Text("GPU Memory: %.1f MiB in %d textures, %.1f MiB unused by this pipeline",
+                footprint.totalBytes / (1024.0 * 1024.0), footprint.resources, footprint.unusedBytes / (1024.0 * 1024.0));
+    if (ImGui::IsItemHovered()) {
+      ImGui::BeginTooltip();
+      for (int i = 0; i < kPipelineStageCount; ++i) {
+        if (footprint.stageBytes[i] != 0) {
+          ImGui::Text("%-16s %7.2f MiB", PipelineStageName(static_cast<PipelineStage>(i)),
+                      footprint.stageBytes[i] / (1024.0 * 1024.0));
+        }
+      }
+      for (const ResourceRecord& record : m_interpolator.Resources().Records()) {
+        if (!record.Use(m_interpolator.Resources().MinimalPipeline()).read) {
+          ImGui::Text("unused: %s (%.2f MiB)", record.name.c_str(), record.bytes / (1024.0 * 1024.0));
+        }
+      }
+      const FrameGraphMemory graph = m_interpolator.Graph().Memory();
+      ImGui::Text("frame graph: %.2f MiB per frame, %.2f MiB with transient aliasing, %d barriers",
+                  graph.dedicatedBytes / (1024.0 * 1024.0), graph.aliasedBytes / (1024.0 * 1024.0), graph.barriers);
+      const ResolutionBucketPool& workingSet = m_interpolator.WorkingSetPool();
+      ImGui::Text("working set: %dx%d for %dx%d, %llu builds in %llu resizes, %llu frames passed through",
+                  workingSet.AllocatedWidth(), workingSet.AllocatedHeight(), workingSet.InputWidth(),
+                  workingSet.InputHeight(), static_cast<unsigned long long>(workingSet.Stats().builds),
+                  static_cast<unsigned long long>(workingSet.Stats().resizes),
+                  static_cast<unsigned long long>(workingSet.Stats().passthroughFrames));
+      ImGui::EndTooltip();
+    }
+    if (ImGui::Checkbox("Stage Timing", &m_stageTimingEnabled)) {
+      ApplyStageTiming();
+    }
+    if (m_stageTimingEnabled) {
+      ImGui::SameLine();
+      if (ImGui::Button("Export Chrome Trace")) {
+        ExportStageTrace();
+      }
+      RefreshStageSummary();
+      ImGui::Text("Stage (last %d frames)   CPU p50/p95/p99 ms   GPU p50/p95/p99 ms", kStageSummaryFrames);
+      for (int i = 0; i < kPipelineStageCount; ++i) {
+        const StagePercentiles& cpu = m_stageSummary.cpu[i];
+        const StagePercentiles& gpu = m_stageSummary.gpu[i];
+        if (cpu.count == 0 && gpu.count == 0) {
+          continue;
+        }
+        ImGui::Text("  %-16s %5.2f %5.2f %5.2f   %5.2f %5.2f %5.2f", PipelineStageName(static_cast<PipelineStage>(i)),
+                    cpu.p50Sec * 1e3, cpu.p95Sec * 1e3, cpu.p99Sec * 1e3,
+                    gpu.p50Sec * 1e3, gpu.p95Sec * 1e3, gpu.p99Sec * 1e3);
+      }
+    }
+    bool telemetryOn = m_telemetry.IsRecording();
+    if (ImGui::Checkbox("Telemetry Log", &telemetryOn)) {
+      if (telemetryOn) {
+        m_captureStatus = StartTelemetry() ? "Telemetry logging to " + m_telemetry.Path()
+                                           : std::string("Cannot write telemetry log");
+      } else {
+        StopTelemetry();
+        m_captureStatus = "Telemetry log written to " + m_telemetry.Path();
+      }
+    }
+    if (ImGui::IsItemHovered()) ImGui::SetTooltip("Per-present binary log (.tmtl) of timing, path and drops.\nAnalyze with tools/telemetry_analyze.");
+    if (telemetryOn) {
+      const TelemetryWriterStats telemetryStats = m_telemetry.Stats();
+      ImGui::SameLine();
+      ImGui::Text("%llu records, %.1f MB%s", static_cast<unsigned long long>(telemetryStats.written),
+                  static_cast<double>(telemetryStats.bytes) / (1024.0 * 1024.0),
+                  telemetryStats.failed ? " (write error)" : "");
+    }
+    if (m_outputMode == 2) {
+      const VrrSchedulerStats& vrrStats = m_vrrScheduler.Stats();
+      ImGui::Text("VRR: %.2f frames/pair (last %d over %.1f ms), %llu holds", vrrStats.AvgPresentsPerPair(),
+                  vrrStats.lastCount, vrrStats.lastPairIntervalSec * 1000.0,
+                  static_cast<unsigned long long>(vrrStats.holds));
+    }
+    const DeadlineWaitStats& waitStats = m_outputWaiter.Stats();
+    ImGui::Text("Pacing Wait: spin %.0f us  overshoot p50 %.0f / p99 %.0f us", waitStats.spinThresholdSec * 1e6,
+                waitStats.overshoot.PercentileSec(0.5) * 1e6, waitStats.overshoot.PercentileSec(0.99) * 1e6);
+  }
   ImGui::Text("Unstable: %s", m_lastUnstable ? "yes" : "no");
   ImGui::Text("Frame: %dx%d", m_frameWidth, m_frameHeight);
   ImGui::Text("Output: %dx%d", m_outputWidth, m_outputHeight);
@@ -2681,6 +3384,11 @@ void App::RenderUi() {
         float dropRate = 100.0f * stats.droppedFrames / (stats.capturedFrames + stats.droppedFrames);
         ImGui::TextColored(ImVec4(1.0f, 0.7f, 0.0f, 1.0f), "WGC Dropped: %u (%.1f%%)", stats.droppedFrames, dropRate);
       }
+      const CaptureLatencyHistogram& lag = stats.arrivalToConsume;
+      ImGui::Text("WGC Pool: %d buffers (%llu resizes, max queued %d)", stats.poolSize,
+                  static_cast<unsigned long long>(stats.poolResizes), stats.maxQueued);
+      ImGui::Text("WGC Arrival->Consume: p50 %.1f / p95 %.1f / p99 %.1f ms", lag.PercentileSec(0.50) * 1e3,
+                  lag.PercentileSec(0.95) * 1e3, lag.PercentileSec(0.99) * 1e3);
     }
   }
 
@@ -2792,8 +3500,10 @@ void App::ResizeForCapture(int width, int height) {
   m_frameTime100ns.fill(0);
   m_prevFrameTime100ns = 0;
   m_currFrameTime100ns = 0;
-  m_timeOffsetValid = false;
-  m_timeOffset100ns = 0.0;
+  m_displayClock.ResetCaptureMapping();
+  m_outputCache.Invalidate();
+  m_lastPresentedOutputId = 0;
+  m_vrrScheduler.Reset();
   m_avgFrameInterval = 0.0;
 
   D3D11_TEXTURE2D_DESC desc = {};
@@ -2815,6 +3525,21 @@ void App::ResizeForCapture(int width, int height) {
     }
   }
 
+  D3D11_TEXTURE2D_DESC lumaDesc = desc;
+  lumaDesc.Width = static_cast<UINT>(width / 2);
+  lumaDesc.Height = static_cast<UINT>(height / 2);
+  lumaDesc.Format = DXGI_FORMAT_R16_UNORM;
+  m_frameHasLuma.fill(false);
+  for (int i = 0; i < kFrameQueueSize; ++i) {
+    m_frameLumaTextures[i].Reset();
+    m_frameLumaSrvs[i].Reset();
+    if (lumaDesc.Width == 0 || lumaDesc.Height == 0) continue;
+    m_device.Device()->CreateTexture2D(&lumaDesc, nullptr, &m_frameLumaTextures[i]);
+    if (m_frameLumaTextures[i]) {
+      m_device.Device()->CreateShaderResourceView(m_frameLumaTextures[i].Get(), nullptr, &m_frameLumaSrvs[i]);
+    }
+  }
+
   if (m_outputWidth > 0 && m_outputHeight > 0) {
     m_interpolator.Resize(m_frameWidth, m_frameHeight, m_outputWidth, m_outputHeight);
   }
@@ -2917,6 +3642,15 @@ void App::ExportDiagnostics() {
     auto stats = m_capture.GetStatistics();
     ss << "WGC Captured Frames: " << stats.capturedFrames << std::endl;
     ss << "WGC Dropped Frames: " << stats.droppedFrames << std::endl;
+    ss << "WGC Queue Policy: " << CaptureQueuePolicyName(m_capture.GetQueueConfig().policy) << std::endl;
+    ss << "WGC Pool: " << stats.poolSize << " buffers, " << stats.poolResizes << " resizes, max queued "
+       << stats.maxQueued << std::endl;
+    ss << "WGC Arrival->Consume: mean " << stats.arrivalToConsume.MeanSec() * 1e3 << " ms, max "
+       << stats.arrivalToConsume.maxSec * 1e3 << " ms;";
+    for (int bin = 0; bin < CaptureLatencyHistogram::kBins; ++bin) {
+      ss << " " << CaptureLatencyHistogram::BinLabel(bin) << "=" << stats.arrivalToConsume.counts[bin];
+    }
+    ss << std::endl;
   }
   ss << "Force WGC: " << (m_forceWgcCapture ? "Yes" : "No") << std::endl;
   ss << "Render GPU: " << (m_device.ActiveAdapterName().empty() ? "Unknown" : m_device.ActiveAdapterName()) << std::endl;
@@ -2926,7 +3660,86 @@ void App::ExportDiagnostics() {
   ss << "Monitor Max Hz: " << m_device.MaxRefreshHz(m_selectedMonitor) << " Hz" << std::endl;
   ss << "Capture FPS: " << ((m_avgFrameInterval > 0.0) ? (1.0 / m_avgFrameInterval) : 0.0) << std::endl;
   ss << "Actual Capture Rate: " << m_captureFps << " FPS" << std::endl;
+  ss << "Source Frames Skipped: " << m_sourceFramesSkipped << std::endl;
+  ss << "Producer Luma Frames: " << m_producerLumaFrames << std::endl;
+  if (m_recorder.IsRecording()) {
+    const SessionRecorderStats recordStats = m_recorder.Stats();
+    ss << "Recording: " << m_recorder.Path() << ", " << recordStats.written << " frames, " << recordStats.fileBytes
+       << " bytes (" << recordStats.rawBytes << " raw), " << recordStats.dropped << " dropped, "
+       << m_recordStagingDrops << " readback misses, max queued " << recordStats.maxQueued << std::endl;
+  }
+  if (m_captureMode == 3) {
+    const CaptureRegion& cropRegion = m_cropRegion.Region();
+    ss << "Crop Region: " << cropRegion.width << "x" << cropRegion.height << " at " << cropRegion.x << ","
+       << cropRegion.y << " (" << m_cropRegion.Refreshes() << " geometry reads)" << std::endl;
+  }
   ss << "Output FPS: " << m_presentFps << " FPS" << std::endl;
+  {
+    DisplayClockStats clockStats = m_displayClock.Stats();
+    ss << "Display PLL: " << (clockStats.displayLocked ? "Locked" : "Acquiring")
+       << ", period " << clockStats.displayPeriodSec * 1000.0 << " ms"
+       << ", mean phase error " << clockStats.meanAbsPhaseErrorSec * 1000.0 << " ms"
+       << ", samples " << clockStats.vblankSamples << ", outliers " << clockStats.vblankOutliers << std::endl;
+    ss << "Capture Clock: drift " << clockStats.captureDriftPpm << " ppm"
+       << ", sigma " << clockStats.captureOffsetSigmaSec * 1000.0 << " ms"
+       << ", samples " << clockStats.captureSamples << ", rejected " << clockStats.captureRejected << std::endl;
+    const OutputCacheStats& cacheStats = m_outputCache.Stats();
+    ss << "Output Cache: " << (m_outputCacheEnabled ? "Enabled" : "Disabled")
+       << ", step " << m_outputCacheStep << ", hit rate " << cacheStats.HitRate() * 100.0 << "%"
+       << ", lookups " << cacheStats.lookups << ", evictions " << cacheStats.evictions
+       << ", presents skipped " << cacheStats.presentsSkipped << std::endl;
+    ss << "Output Cache Saved: CPU " << cacheStats.savedCpuSec * 1000.0 << " ms, GPU "
+       << cacheStats.savedGpuSec * 1000.0 << " ms (avg generation CPU "
+       << cacheStats.avgMissCpuSec * 1000.0 << " ms, GPU " << cacheStats.avgMissGpuSec * 1000.0 << " ms)" << std::endl;
+    const MotionCacheStats& motionStats = m_interpolator.GetMotionCacheStats();
+    ss << "Motion Cache: requests " << motionStats.requests << ", active reuses " << motionStats.activeReuses
+       << ", restores " << motionStats.restores << ", motion estimations " << motionStats.computes
+       << ", evictions " << motionStats.evictions << std::endl;
+    const ResolutionBucketPool& workingSet = m_interpolator.WorkingSetPool();
+    const ResolutionBucketStats& resizeStats = workingSet.Stats();
+    ss << "Working Set: " << workingSet.AllocatedWidth() << "x" << workingSet.AllocatedHeight() << " for input "
+       << workingSet.InputWidth() << "x" << workingSet.InputHeight() << ", resizes " << resizeStats.resizes
+       << ", reuses " << resizeStats.reuses << ", builds " << resizeStats.builds << " (" << resizeStats.grows
+       << " grow, " << resizeStats.shrinks << " shrink, " << resizeStats.failures << " failed)"
+       << ", pass-through frames " << resizeStats.passthroughFrames << " (longest run "
+       << resizeStats.longestPassthroughRun << ", " << resizeStats.waitedBuilds << " builds waited for)" << std::endl;
+    ss << "GPU Resources: " << FormatResourceReport(m_interpolator.Resources());
+    ss << FormatFrameGraphReport(m_interpolator.Graph());
+    if (m_stageTimingEnabled) {
+      m_stageSummaryTime = 0.0;
+      RefreshStageSummary();
+      for (int i = 0; i < kPipelineStageCount; ++i) {
+        const StagePercentiles& cpu = m_stageSummary.cpu[i];
+        const StagePercentiles& gpu = m_stageSummary.gpu[i];
+        if (cpu.count == 0 && gpu.count == 0) {
+          continue;
+        }
+        ss << "Stage " << PipelineStageName(static_cast<PipelineStage>(i)) << ": CPU p50 " << cpu.p50Sec * 1e3
+           << " / p95 " << cpu.p95Sec * 1e3 << " / p99 " << cpu.p99Sec * 1e3 << " ms (" << cpu.count
+           << "), GPU p50 " << gpu.p50Sec * 1e3 << " / p95 " << gpu.p95Sec * 1e3 << " / p99 " << gpu.p99Sec * 1e3
+           << " ms (" << gpu.count << ")" << std::endl;
+      }
+    }
+    if (m_telemetry.IsRecording()) {
+      const TelemetryWriterStats telemetryStats = m_telemetry.Stats();
+      ss << "Telemetry Log: " << m_telemetry.Path() << ", " << telemetryStats.written << " records, "
+         << telemetryStats.dropped << " dropped" << (telemetryStats.failed ? ", write error" : "") << std::endl;
+    }
+    const VrrSchedulerStats& vrrStats = m_vrrScheduler.Stats();
+    ss << "VRR Schedule: " << (m_outputMode == 2 ? "Active" : "Inactive")
+       << ", max " << (m_vrrMaxHz > 0.0f ? m_vrrMaxHz : m_device.RefreshHz(m_selectedMonitor)) << " Hz"
+       << ", min " << m_vrrMinHz << " Hz, pairs " << vrrStats.pairs
+       << ", presents/pair " << vrrStats.AvgPresentsPerPair() << ", holds " << vrrStats.holds << std::endl;
+    const DeadlineWaitStats& waitStats = m_outputWaiter.Stats();
+    ss << "Pacing Wait: spin threshold " << waitStats.spinThresholdSec * 1e6 << " us"
+       << ", waits " << waitStats.waits << ", late sleeps " << waitStats.lateSleeps
+       << ", sleep " << waitStats.sleepSec << " s, spin " << waitStats.spinSec << " s" << std::endl;
+    ss << "Pacing Overshoot:";
+    for (int bin = 0; bin < WaitHistogram::kBins; ++bin) {
+      ss << " " << WaitHistogram::BinLabel(bin) << "=" << waitStats.overshoot.counts[bin];
+    }
+    ss << std::endl;
+  }
   ss << "Frame Interval Avg: " << ((m_frameIntervalCount > 0) ? (m_frameIntervalSum / m_frameIntervalCount) : 0.0) << " ms" << std::endl;
   ss << "Frame Interval Min: " << m_minFrameInterval << " ms" << std::endl;
   ss << "Frame Interval Max: " << m_maxFrameInterval << " ms" << std::endl;
@@ -2957,11 +3770,7 @@ void App::ExportDiagnostics() {
   ss << "Interpolation: " << (m_interpolationEnabled ? "Enabled" : "Disabled") << std::endl;
   ss << "Output Multiplier: " << m_outputMultiplier << "x" << std::endl;
   ss << "Pacing Delay Factor: " << m_pacingDelayFactor << std::endl;
-  static const char* kMotionModelNames[] = {"Adaptive", "Stable", "Balanced", "Coverage"};
-  int motionModel = m_motionModel;
-  if (motionModel < 0) motionModel = 0;
-  if (motionModel > 3) motionModel = 3;
-  ss << "Motion Model: " << kMotionModelNames[motionModel] << std::endl;
+  ss << "Motion Model: " << MotionModelName(m_motionModel) << std::endl;
   ss << "Minimal Motion Pipeline: " << (m_minimalMotionPipeline ? "Enabled" : "Disabled") << std::endl;
 
   std::string filename = "TrueMotion_Diagnostics_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + ".txt";
@@ -2973,6 +3782,93 @@ void App::ExportDiagnostics() {
   }
 }
 
+void App::RefreshStageSummary() {
+  const double now = DeadlineWaiter::Now();
+  if (m_stageSummaryTime > 0.0 && now - m_stageSummaryTime < 0.25) {
+    return;
+  }
+  m_stageSummaryTime = now;
+  std::vector<StageSample> samples;
+  m_interpolator.StageTimes().Snapshot(samples);
+  m_stageSummary = SummarizeStages(samples, kStageSummaryFrames);
+}
+
+void App::ExportStageTrace() {
+  std::vector<StageSample> samples;
+  m_interpolator.StageTimes().Snapshot(samples);
+  std::string filename = "TrueMotion_Trace_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + ".json";
+  if (WriteChromeTrace(filename, samples)) {
+    m_captureStatus = "Stage trace (" + std::to_string(samples.size()) + " events) exported to: " + filename;
+  } else {
+    m_captureStatus = "Failed to write " + filename;
+  }
+}
+
+void App::ExportMotionFields() {
+  std::string prefix = "TrueMotion_Flow_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+  const int written = m_interpolator.ExportMotionFields(prefix);
+  if (written > 0) {
+    m_captureStatus = "Motion fields (" + std::to_string(written) + " levels) exported to: " + prefix + "_*.flo";
+  } else {
+    m_captureStatus = "Failed to export motion fields";
+  }
+}
+
+bool App::StartTelemetry() {
+  StopTelemetry();
+  m_telemetryFrame = 0;
+  for (std::atomic<uint64_t>& drops : m_telemetryDrops) {
+    drops.store(0, std::memory_order_relaxed);
+  }
+  m_telemetryWgcDropped = m_windowCaptureUsingWgc ? m_capture.GetDroppedFrameTotal() : 0;
+  // Stage times go into every record, so profiling stays on while logging.
+  m_interpolator.SetStageTimingEnabled(true);
+  m_telemetryStageCursor = m_interpolator.StageTimes().Pushed();
+  m_telemetryStageSamples.clear();
+  std::string filename = "TrueMotion_Telemetry_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + ".tmtl";
+  return m_telemetry.Start(filename);
+}
+
+void App::StopTelemetry() {
+  m_telemetry.Stop();
+  ApplyStageTiming();
+  m_telemetryStageSamples.clear();
+}
+
+void App::CountDrop(TelemetryDrop reason, uint64_t count) {
+  m_telemetryDrops[static_cast<int>(reason)].fetch_add(count, std::memory_order_relaxed);
+}
+
+void App::SubmitTelemetry(TelemetryRecord& record) {
+  if (m_windowCaptureUsingWgc) {
+    const uint64_t dropped = m_capture.GetDroppedFrameTotal();
+    if (dropped > m_telemetryWgcDropped) {
+      CountDrop(TelemetryDrop::CaptureQueue, dropped - m_telemetryWgcDropped);
+    }
+    m_telemetryWgcDropped = dropped;
+  }
+  record.frame = ++m_telemetryFrame;
+  record.presentSec = DeadlineWaiter::Now();
+  record.presentTime100ns = static_cast<int64_t>(m_displayClock.CaptureTimeFromQpc(record.presentSec) * 1e7);
+  record.resourceKiB = static_cast<uint32_t>(std::min<uint64_t>(m_interpolator.Resources().TotalBytes() / 1024, UINT32_MAX));
+  for (int i = 0; i < kTelemetryDropCount; ++i) {
+    record.drops[i] = static_cast<uint32_t>(
+        std::min<uint64_t>(m_telemetryDrops[i].exchange(0, std::memory_order_relaxed), UINT32_MAX));
+  }
+  // One profiler frame per domain and record, oldest first: a present that
+  // generated carries its CPU times, and GPU times follow once resolved.
+  m_telemetryStageCursor =
+      m_interpolator.StageTimes().SnapshotSince(m_telemetryStageCursor, m_telemetryStageSamples);
+  record.stageCpuFrame = TakeStageFrame(m_telemetryStageSamples, TimingDomain::Cpu, record.stageCpuMs);
+  record.stageGpuFrame = TakeStageFrame(m_telemetryStageSamples, TimingDomain::Gpu, record.stageGpuMs);
+  if (m_telemetryStageSamples.size() > StageTimeline::kCapacity) {
+    // GPU frames resolving faster than presents drain them; keep the newest.
+    m_telemetryStageSamples.erase(m_telemetryStageSamples.begin(),
+                                  m_telemetryStageSamples.end() - StageTimeline::kCapacity);
+  }
+  m_telemetry.Submit(record);
+}
+
 LRESULT App::HandleUiMessage(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
   if (HandlePreviewMouse(message, wParam, lParam)) {
     return 0;
@@ -1,10 +1,18 @@
 #pragma once
 
+#include "capture_region.h"
 #include "d3d11_device.h"
+#include "deadline_wait.h"
+#include "display_clock.h"
 #include "dup_capture.h"
 #include "game_capture.h"
 #include "interpolator.h"
+#include "output_cache.h"
+#include "replay_source.h"
+#include "session_recorder.h"
+#include "telemetry.h"
 #include "ui.h"
+#include "vrr_scheduler.h"
 #include "wgc_capture.h"
 #include "window_list.h"
 
@@ -15,6 +23,7 @@
 #include <windows.h>
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <string>
@@ -36,12 +45,25 @@ private:
   void Update();
   void UpdateCapture();
   void RestoreDxgiCropWindow();  // Restore output window after DXGI Crop mode
+  void UpdateCropEventHook();    // Track the DXGI Crop window's move/resize events
+  bool RefreshCropRegion(int frameWidth, int frameHeight);
+  static void CALLBACK CropLocationChanged(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject,
+                                           LONG idChild, DWORD eventThread, DWORD eventTime);
   
   // Capture methods
   bool ShouldUseWgcForWindowCapture() const;
   bool StartWindowCapture(HWND hwnd);
   bool StartMonitorCapture(HMONITOR monitor);
   void ResetCaptureState();
+  ICaptureSource* ActiveCaptureSource();
+  bool UploadCpuFrame(const CpuFrame& cpu, CapturedFrame& frame);
+  bool StartReplayCapture();
+  void ApplyWgcQueueConfig();
+  bool StartRecording();
+  void StopRecording();
+  void QueueRecordFrame(int slot, const CapturedFrame& frame);
+  void DrainRecordFrames(bool wait);
+  void ReleaseRecordFrames();
   void SelectMonitor(int index);
   void RefreshWindowList();
   void Render();
@@ -66,6 +88,16 @@ private:
   LRESULT HandleMessage(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
   LRESULT HandleUiMessage(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
   void ExportDiagnostics();
+  void ExportStageTrace();
+  void ExportMotionFields();
+  void RefreshStageSummary();
+  bool StartTelemetry();
+  void StopTelemetry();
+  void CountDrop(TelemetryDrop reason, uint64_t count = 1);
+  void SubmitTelemetry(TelemetryRecord& record);
+  bool EnsureOutputCacheTextures();
+  void ApplyStageTiming();
+  void RecordGenerationGpuCost();
 
   HINSTANCE m_hInstance = nullptr;
   HWND m_hwnd = nullptr;
@@ -83,13 +115,37 @@ private:
   WgcCapture m_capture;
   DupCapture m_dupCapture;
   GameCapture m_gameCapture;
+  ReplaySource m_replaySource;
   Interpolator m_interpolator;
   UiOverlay m_ui;
 
   std::vector<WindowInfo> m_windows;
   int m_selectedWindow = -1;
   std::string m_captureStatus;
-  int m_captureMode = 0;
+  int m_captureMode = 0;          // 0 Window, 1 Monitor, 2 Game, 3 DXGI Crop, 4 Replay
+
+  // Replay mode: recorded frame stream, uploaded through m_cpuUploadTexture
+  std::array<char, 260> m_replayPath = {};
+  float m_replaySpeed = 1.0f;
+  bool m_replayLoop = true;
+  Microsoft::WRL::ComPtr<ID3D11Texture2D> m_cpuUploadTexture;
+  std::vector<uint8_t> m_cpuConvertBuffer;
+
+  // Session recording: queue slots are copied into a staging ring and
+  // mapped a few frames later (never waiting on the GPU). The mapping is
+  // lent to the recorder's writer thread, which reads the pixels itself;
+  // the slot is unmapped and reused once the writer releases it. A full
+  // ring drops the frame. Sized like the recorder's queue.
+  static constexpr int kRecordStagingSlots = 8;
+  SessionRecorder m_recorder;
+  std::array<char, 260> m_recordPath = {};
+  bool m_recordCompress = true;
+  std::array<Microsoft::WRL::ComPtr<ID3D11Texture2D>, kRecordStagingSlots> m_recordStaging;
+  std::array<CpuFrame, kRecordStagingSlots> m_recordStagingFrame;
+  std::deque<int> m_recordPending;                           // copied, not mapped yet
+  std::deque<std::pair<int, uint64_t>> m_recordLent;         // mapped: slot, recorder ticket
+  int m_recordNextStaging = 0;
+  uint64_t m_recordStagingDrops = 0;
 
   int m_selectedMonitor = 0;
   bool m_monitorDirty = false;
@@ -118,7 +174,9 @@ private:
   bool m_windowCapturePreferWgc = true;
   bool m_forceDxgiCapture = false; // User override to prefer DXGI even when WGC is typically required
   bool m_windowCaptureUsingWgc = false;
-  int m_outputMode = 0;
+  int m_outputMode = 0;              // 0 multiplier, 1 monitor sync, 2 variable rate (VRR)
+  float m_vrrMaxHz = 0.0f;           // 0 = monitor refresh
+  float m_vrrMinHz = 48.0f;
   int m_outputDisplayMode = 0;
   bool m_outputWindowVisible = true;
   int m_outputWindowMode = -1;
@@ -136,7 +194,7 @@ private:
   int m_interpolationQuality = 1; // 0=Standard, 1=High
   bool m_useCustomWeights = false; // Use custom ML weights
   
-  HANDLE m_waitTimer = nullptr;
+  DeadlineWaiter m_outputWaiter;
   float m_outputDelayMs = 0.0f;
   float m_pacingDelayFactor = 0.9f;
   float m_lastAlpha = 0.0f;
@@ -157,6 +215,9 @@ private:
   double m_captureFpsTime = 0.0;
   float m_captureFps = 0.0f;
   bool m_forceWgcCapture = false;
+  int m_wgcQueuePolicy = 0;          // CaptureQueuePolicy
+  int m_wgcFifoDepth = 3;
+  float m_wgcWindowMs = 50.0f;
   bool m_unlockAppFps = false;     // SKips waitable object sync
   
   // DXGI Crop mode state
@@ -182,6 +243,11 @@ private:
   float m_maxFrameInterval = 0.0f;
   // ACCURACY: Use int64_t to prevent precision loss (double loses bits for large timestamps)
   std::vector<int64_t> m_frameTimestamps;
+  // Frames the source produced but never delivered (hook ring laps,
+  // DXGI accumulated presents).
+  uint64_t m_sourceFramesSkipped = 0;
+  // Frames that arrived with a producer luma plane (hook shared memory).
+  uint64_t m_producerLumaFrames = 0;
   int64_t m_lastSmoothedTime = 0;
   bool m_showUi = true;
   int m_outputStepIndex = 0;
@@ -190,7 +256,6 @@ private:
   int m_pairCurrSlot = -1;
   int64_t m_pairPrevTime100ns = 0;
   int64_t m_pairCurrTime100ns = 0;
-  bool m_pairMotionComputed = false;
   bool m_holdEndFrame = false;
   int m_holdFrameCount = 0;
   int m_frameWidth = 0;
@@ -201,26 +266,78 @@ private:
   int m_lastOutputHeight = 0;
   Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_lastOutputSrv;
 
-  // DXGI Crop mode - texture to hold cropped region
-  Microsoft::WRL::ComPtr<ID3D11Texture2D> m_cropTexture;
-  int m_cropWidth = 0;
-  int m_cropHeight = 0;
+  // DXGI Crop mode - cached window region inside the monitor frame,
+  // re-read only when the location-change hook reports a move/resize
+  CaptureRegionTracker m_cropRegion;
+  HWINEVENTHOOK m_cropEventHook = nullptr;
+  HWND m_cropEventWindow = nullptr;
 
   static constexpr int kFrameQueueSize = 12;
   std::array<Microsoft::WRL::ComPtr<ID3D11Texture2D>, kFrameQueueSize> m_frameTextures;
   std::array<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>, kFrameQueueSize> m_frameSrvs;
+  // Producer half-res luma per slot (R16); the interpolator starts its
+  // feature pyramid from it when both frames of a pair have one.
+  std::array<Microsoft::WRL::ComPtr<ID3D11Texture2D>, kFrameQueueSize> m_frameLumaTextures;
+  std::array<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>, kFrameQueueSize> m_frameLumaSrvs;
+  std::array<bool, kFrameQueueSize> m_frameHasLuma = {};
   std::array<int64_t, kFrameQueueSize> m_frameTime100ns = {};
+  // Capture order of each slot; with the timestamp it identifies the content
+  // for the interpolator's motion cache.
+  std::array<uint64_t, kFrameQueueSize> m_frameSequence = {};
+  uint64_t m_captureSequence = 0;
   std::deque<int> m_frameQueue;
   int m_queueWrite = 0;
+
+  // Alpha-bucketed cache of generated frames for the current pair, so fast
+  // render loops re-present a bucket instead of re-running InterpolateOnly.
+  static constexpr int kOutputCacheSlots = 4;
+  OutputFrameCache m_outputCache{kOutputCacheSlots};
+  bool m_outputCacheEnabled = true;
+  float m_outputCacheStep = 1.0f / 64.0f;
+  std::array<Microsoft::WRL::ComPtr<ID3D11Texture2D>, kOutputCacheSlots> m_outputCacheTextures;
+  std::array<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>, kOutputCacheSlots> m_outputCacheSrvs;
+  uint64_t m_outputCacheSettingsKey = 0;
+  uint64_t m_lastPresentedOutputId = 0;
+  // The frame-latency waitable object was waited on and no Present has
+  // returned the slot yet (skipped duplicate presents must not wait again).
+  bool m_frameLatencySlotHeld = false;
+
+  // Content-driven present schedule for Output Mode "Variable Rate".
+  VrrScheduler m_vrrScheduler;
+
+  // GPU time of each generation for the output cache's cost estimate, read
+  // from the interpolator's stage timeline (see RecordGenerationGpuCost).
+  uint64_t m_gpuCostStageCursor = 0;
+  std::vector<StageSample> m_gpuCostStageSamples;
+
+  // Per-stage interpolator timing; the summary is rebuilt from the timeline
+  // a few times a second while the panel shows it.
+  static constexpr int kStageSummaryFrames = 120;
+  bool m_stageTimingEnabled = false;
+  StageTimingSummary m_stageSummary;
+  double m_stageSummaryTime = 0.0;
+
+  // Per-present telemetry log (see telemetry.h). Drops are counted where
+  // they happen and attached to the next record; stage samples are read
+  // from the interpolator's timeline and wait there until their frame's
+  // record goes out.
+  TelemetryWriter m_telemetry;
+  uint64_t m_telemetryFrame = 0;
+  std::array<std::atomic<uint64_t>, kTelemetryDropCount> m_telemetryDrops = {};
+  uint64_t m_telemetryWgcDropped = 0;
+  uint64_t m_telemetryStageCursor = 0;
+  std::vector<StageSample> m_telemetryStageSamples;
   int m_outputMouseIgnore = 0;
   bool m_cursorConfined = false;   // Track cursor confinement state
 
   LARGE_INTEGER m_qpcFreq = {};
   int64_t m_prevFrameTime100ns = 0;
   int64_t m_currFrameTime100ns = 0;
+  SourceClock m_sourceClock;   // pacing domain of the active source
   double m_avgFrameInterval = 0.0;
-  double m_timeOffset100ns = 0.0;
-  bool m_timeOffsetValid = false;
+  // Capture clock -> QPC mapping and display vblank PLL (see display_clock.h).
+  DisplayClock m_displayClock;
+  UINT m_lastSyncRefreshCount = 0;
   
   double m_nextOutputTime100ns = 0.0;
   float m_currentAlpha = 0.0f;
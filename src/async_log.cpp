@@ -0,0 +1,519 @@
+#include "async_log.h"
+
+#include "deadline_wait.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kQueueBytes = 64 * 1024;   // per thread, ~1000 typical messages
+constexpr auto kFlushInterval = std::chrono::milliseconds(20);
+
+const char* kDefaultChannelPaths[kLogChannelCount] = {
+    "init_log.txt",
+    "vulkan_debug.txt",
+    "dxgi_crop_debug.txt",
+};
+
+const char* LevelName(uint8_t level) {
+  switch (static_cast<LogLevel>(level)) {
+    case LogLevel::Trace:
+      return "TRACE";
+    case LogLevel::Debug:
+      return "DEBUG";
+    case LogLevel::Info:
+      return "INFO ";
+    case LogLevel::Warn:
+      return "WARN ";
+    case LogLevel::Error:
+      return "ERROR";
+  }
+  return "?    ";
+}
+
+struct RecordHeader {
+  uint32_t bytes = 0;           // header + arguments
+  uint8_t level = 0;
+  uint8_t channel = 0;
+  uint8_t args = 0;
+  uint8_t truncated = 0;
+  uint32_t suppressed = 0;
+  uint32_t reserved = 0;
+  const char* format = nullptr;
+  double timeSec = 0.0;
+};
+
+// Single-producer (the owning thread) / single-consumer (the flusher) byte
+// ring. Positions only grow; records wrap around the end of the buffer.
+struct ThreadQueue {
+  explicit ThreadQueue(uint32_t id) : id(id), buffer(new uint8_t[kQueueBytes]) {}
+
+  bool Push(const RecordHeader& header, const uint8_t* args, size_t argBytes) {
+    const uint64_t pos = head.load(std::memory_order_relaxed);
+    if (pos + header.bytes - tail.load(std::memory_order_acquire) > kQueueBytes) {
+      return false;
+    }
+    CopyIn(pos, &header, sizeof(header));
+    CopyIn(pos + sizeof(header), args, argBytes);
+    head.store(pos + header.bytes, std::memory_order_release);
+    return true;
+  }
+
+  size_t Used() const {
+    return static_cast<size_t>(head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire));
+  }
+
+  void CopyIn(uint64_t pos, const void* data, size_t bytes) {
+    const size_t offset = static_cast<size_t>(pos % kQueueBytes);
+    const size_t first = std::min(bytes, kQueueBytes - offset);
+    std::memcpy(buffer.get() + offset, data, first);
+    std::memcpy(buffer.get(), static_cast<const uint8_t*>(data) + first, bytes - first);
+  }
+
+  void CopyOut(uint64_t pos, void* data, size_t bytes) const {
+    const size_t offset = static_cast<size_t>(pos % kQueueBytes);
+    const size_t first = std::min(bytes, kQueueBytes - offset);
+    std::memcpy(data, buffer.get() + offset, first);
+    std::memcpy(static_cast<uint8_t*>(data) + first, buffer.get(), bytes - first);
+  }
+
+  const uint32_t id;
+  std::unique_ptr<uint8_t[]> buffer;
+  alignas(64) std::atomic<uint64_t> head{0};
+  alignas(64) std::atomic<uint64_t> tail{0};
+  std::array<std::atomic<uint32_t>, kLogChannelCount> dropped = {};
+  std::atomic<bool> wakeSent{false};  // past half full, flusher woken
+  std::atomic<bool> retired{false};   // owning thread exited
+};
+
+struct PendingLine {
+  double timeSec = 0.0;
+  uint8_t channel = 0;
+  std::string text;
+};
+
+// Decoded argument; strings point into the flusher's scratch copy.
+struct LogArg {
+  AsyncLog::ArgTag tag = AsyncLog::ArgTag::Int;
+  int64_t i = 0;
+  uint64_t u = 0;
+  double d = 0.0;
+  std::string_view s;
+};
+
+void AppendArg(std::string& out, const LogArg& arg, bool hex) {
+  char buffer[64];
+  switch (arg.tag) {
+    case AsyncLog::ArgTag::Int:
+      if (hex) {
+        std::snprintf(buffer, sizeof(buffer), "%llx", static_cast<unsigned long long>(arg.i));
+      } else {
+        std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(arg.i));
+      }
+      out += buffer;
+      return;
+    case AsyncLog::ArgTag::Uint:
+      std::snprintf(buffer, sizeof(buffer), hex ? "%llx" : "%llu", static_cast<unsigned long long>(arg.u));
+      out += buffer;
+      return;
+    case AsyncLog::ArgTag::Double:
+      std::snprintf(buffer, sizeof(buffer), "%g", arg.d);
+      out += buffer;
+      return;
+    case AsyncLog::ArgTag::String:
+      out.append(arg.s.data(), arg.s.size());
+      return;
+    case AsyncLog::ArgTag::Pointer:
+      std::snprintf(buffer, sizeof(buffer), "0x%016llx", static_cast<unsigned long long>(arg.u));
+      out += buffer;
+      return;
+    case AsyncLog::ArgTag::Bool:
+      out += arg.u ? "1" : "0";
+      return;
+  }
+}
+
+std::string FormatMessage(const char* format, const std::vector<LogArg>& args) {
+  std::string out;
+  size_t next = 0;
+  for (const char* p = format; *p; ++p) {
+    if (p[0] == '{' && p[1] == '{') {
+      out += '{';
+      ++p;
+    } else if (p[0] == '}' && p[1] == '}') {
+      out += '}';
+      ++p;
+    } else if (p[0] == '{' && p[1] == '}') {
+      if (next < args.size()) AppendArg(out, args[next++], false); else out += "{?}";
+      ++p;
+    } else if (p[0] == '{' && p[1] == ':' && p[2] == 'x' && p[3] == '}') {
+      if (next < args.size()) AppendArg(out, args[next++], true); else out += "{?}";
+      p += 3;
+    } else {
+      out += *p;
+    }
+  }
+  return out;
+}
+
+class LogCore {
+public:
+  static LogCore& Get() {
+    static LogCore core;
+    return core;
+  }
+
+  ~LogCore() { Shutdown(); }
+
+  ThreadQueue& CallerQueue();
+
+  void EnsureFlusher() {
+    if (m_running.load(std::memory_order_acquire)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running.load(std::memory_order_relaxed)) {
+      return;
+    }
+    m_stopping = false;
+    m_thread = std::thread(&LogCore::FlusherLoop, this);
+    m_running.store(true, std::memory_order_release);
+  }
+
+  void SetChannelPath(LogChannel channel, const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_paths[static_cast<int>(channel)] = path;
+  }
+
+  void Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_running.load(std::memory_order_relaxed)) {
+      return;
+    }
+    const uint64_t target = ++m_flushRequested;
+    m_cv.notify_one();
+    m_flushedCv.wait(lock, [&] { return m_flushCompleted >= target || !m_running.load(std::memory_order_relaxed); });
+  }
+
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_running.load(std::memory_order_relaxed)) {
+        return;
+      }
+      m_stopping = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::FILE*& file : m_files) {
+      if (file) {
+        std::fclose(file);
+        file = nullptr;
+      }
+    }
+    m_running.store(false, std::memory_order_release);
+    m_flushedCv.notify_all();
+  }
+
+  AsyncLogStats Stats() {
+    AsyncLogStats stats;
+    stats.written = m_written.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.suppressed = m_suppressed.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.threads = static_cast<uint32_t>(m_queues.size());
+    return stats;
+  }
+
+  // Producers: a queue past half full gets drained before the next interval.
+  // The flag keeps the lock off the producer; a missed notify only costs the
+  // rest of the interval.
+  void Wake() {
+    m_wake.store(true, std::memory_order_release);
+    m_cv.notify_one();
+  }
+
+  double StartSec() const { return m_startSec; }
+  void CountDropped() { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+  void CountSuppressed() { m_suppressed.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+  LogCore() : m_startSec(DeadlineWaiter::Now()) {
+    for (int i = 0; i < kLogChannelCount; ++i) {
+      m_paths[i] = kDefaultChannelPaths[i];
+    }
+  }
+
+  void FlusherLoop();
+  void Drain(ThreadQueue& queue, std::vector<PendingLine>& lines);
+  void WriteLines(std::vector<PendingLine>& lines);
+
+  std::mutex m_mutex;                       // registry, paths, flusher lifecycle
+  std::condition_variable m_cv;             // wakes the flusher early
+  std::condition_variable m_flushedCv;
+  std::vector<std::shared_ptr<ThreadQueue>> m_queues;
+  uint32_t m_nextThreadId = 1;
+  std::thread m_thread;
+  std::atomic<bool> m_running{false};
+  std::atomic<bool> m_wake{false};
+  bool m_stopping = false;
+  uint64_t m_flushRequested = 0;
+  uint64_t m_flushCompleted = 0;
+  std::array<std::string, kLogChannelCount> m_paths;
+  std::array<std::FILE*, kLogChannelCount> m_files = {};   // flusher thread
+  const double m_startSec;
+
+  std::atomic<uint64_t> m_written{0};
+  std::atomic<uint64_t> m_dropped{0};
+  std::atomic<uint64_t> m_suppressed{0};
+
+  std::vector<uint8_t> m_scratch;           // flusher thread
+  std::vector<LogArg> m_args;
+};
+
+// Retires the thread's queue when the thread exits; the flusher drains and
+// frees it.
+struct QueueHolder {
+  std::shared_ptr<ThreadQueue> queue;
+  ~QueueHolder() {
+    if (queue) {
+      queue->retired.store(true, std::memory_order_release);
+    }
+  }
+};
+
+thread_local QueueHolder t_queue;
+
+ThreadQueue& LogCore::CallerQueue() {
+  if (!t_queue.queue) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    t_queue.queue = std::make_shared<ThreadQueue>(m_nextThreadId++);
+    m_queues.push_back(t_queue.queue);
+  }
+  return *t_queue.queue;
+}
+
+void LogCore::Drain(ThreadQueue& queue, std::vector<PendingLine>& lines) {
+  for (int channel = 0; channel < kLogChannelCount; ++channel) {
+    const uint32_t dropped = queue.dropped[channel].exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+      PendingLine line;
+      line.timeSec = DeadlineWaiter::Now();
+      line.channel = static_cast<uint8_t>(channel);
+      char text[128];
+      std::snprintf(text, sizeof(text), "[%10.4f] [t%u] WARN  log queue full, %u messages dropped",
+                    line.timeSec - m_startSec, queue.id, dropped);
+      line.text = text;
+      lines.push_back(std::move(line));
+    }
+  }
+
+  const uint64_t head = queue.head.load(std::memory_order_acquire);
+  uint64_t tail = queue.tail.load(std::memory_order_relaxed);
+  char prefix[64];
+  while (tail < head) {
+    RecordHeader header;
+    queue.CopyOut(tail, &header, sizeof(header));
+    const size_t argBytes = header.bytes - sizeof(header);
+    m_scratch.resize(argBytes);
+    queue.CopyOut(tail + sizeof(header), m_scratch.data(), argBytes);
+    tail += header.bytes;
+
+    m_args.clear();
+    size_t pos = 0;
+    for (uint8_t i = 0; i < header.args && pos < argBytes; ++i) {
+      LogArg arg;
+      arg.tag = static_cast<AsyncLog::ArgTag>(m_scratch[pos++]);
+      switch (arg.tag) {
+        case AsyncLog::ArgTag::Int:
+          std::memcpy(&arg.i, &m_scratch[pos], sizeof(int64_t));
+          pos += sizeof(int64_t);
+          break;
+        case AsyncLog::ArgTag::Uint:
+        case AsyncLog::ArgTag::Pointer:
+          std::memcpy(&arg.u, &m_scratch[pos], sizeof(uint64_t));
+          pos += sizeof(uint64_t);
+          break;
+        case AsyncLog::ArgTag::Double:
+          std::memcpy(&arg.d, &m_scratch[pos], sizeof(double));
+          pos += sizeof(double);
+          break;
+        case AsyncLog::ArgTag::Bool:
+          arg.u = m_scratch[pos++];
+          break;
+        case AsyncLog::ArgTag::String: {
+          uint16_t length = 0;
+          std::memcpy(&length, &m_scratch[pos], sizeof(length));
+          pos += sizeof(length);
+          arg.s = std::string_view(reinterpret_cast<const char*>(&m_scratch[pos]), length);
+          pos += length;
+          break;
+        }
+      }
+      m_args.push_back(arg);
+    }
+
+    PendingLine line;
+    line.timeSec = header.timeSec;
+    line.channel = header.channel;
+    std::snprintf(prefix, sizeof(prefix), "[%10.4f] [t%u] %s ", header.timeSec - m_startSec, queue.id,
+                  LevelName(header.level));
+    line.text = prefix;
+    line.text += FormatMessage(header.format, m_args);
+    if (header.truncated) {
+      line.text += " [truncated]";
+    }
+    if (header.suppressed > 0) {
+      line.text += " [+" + std::to_string(header.suppressed) + " rate limited]";
+    }
+    lines.push_back(std::move(line));
+  }
+  queue.tail.store(tail, std::memory_order_release);
+  queue.wakeSent.store(false, std::memory_order_release);
+}
+
+void LogCore::WriteLines(std::vector<PendingLine>& lines) {
+  if (lines.empty()) {
+    return;
+  }
+  // Queues are drained one after another; restore the global order.
+  std::stable_sort(lines.begin(), lines.end(),
+                   [](const PendingLine& a, const PendingLine& b) { return a.timeSec < b.timeSec; });
+  std::array<bool, kLogChannelCount> touched = {};
+  for (const PendingLine& line : lines) {
+    const int channel = std::min<int>(line.channel, kLogChannelCount - 1);
+    if (!m_files[channel]) {
+      std::string path;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        path = m_paths[channel];
+      }
+      m_files[channel] = std::fopen(path.c_str(), "a");
+      if (!m_files[channel]) {
+        continue;
+      }
+    }
+    std::fputs(line.text.c_str(), m_files[channel]);
+    std::fputc('\n', m_files[channel]);
+    touched[channel] = true;
+  }
+  for (int channel = 0; channel < kLogChannelCount; ++channel) {
+    if (touched[channel]) {
+      std::fflush(m_files[channel]);
+    }
+  }
+  m_written.fetch_add(lines.size(), std::memory_order_relaxed);
+  lines.clear();
+}
+
+void LogCore::FlusherLoop() {
+  std::vector<std::shared_ptr<ThreadQueue>> queues;
+  std::vector<PendingLine> lines;
+  while (true) {
+    uint64_t target = 0;
+    bool stopping = false;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait_for(lock, kFlushInterval, [&] {
+        return m_stopping || m_flushRequested > m_flushCompleted || m_wake.load(std::memory_order_acquire);
+      });
+      m_wake.store(false, std::memory_order_relaxed);
+      target = m_flushRequested;
+      stopping = m_stopping;
+      queues = m_queues;
+    }
+    for (const auto& queue : queues) {
+      Drain(*queue, lines);
+    }
+    WriteLines(lines);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_flushCompleted = std::max(m_flushCompleted, target);
+      // A retired queue's last messages were drained above.
+      m_queues.erase(std::remove_if(m_queues.begin(), m_queues.end(),
+                                    [](const std::shared_ptr<ThreadQueue>& queue) {
+                                      return queue->retired.load(std::memory_order_acquire) &&
+                                             queue->tail.load(std::memory_order_relaxed) ==
+                                                 queue->head.load(std::memory_order_acquire);
+                                    }),
+                     m_queues.end());
+    }
+    m_flushedCv.notify_all();
+    queues.clear();
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+namespace AsyncLog {
+
+bool Admit(LogSite& site, uint32_t& suppressed) {
+  const int64_t second = static_cast<int64_t>(DeadlineWaiter::Now());
+  if (site.second.load(std::memory_order_relaxed) != second) {
+    // Racing threads may both reset; the budget is approximate by design.
+    site.second.store(second, std::memory_order_relaxed);
+    site.count.store(0, std::memory_order_relaxed);
+  }
+  if (site.count.fetch_add(1, std::memory_order_relaxed) >= site.maxPerSecond) {
+    site.suppressed.fetch_add(1, std::memory_order_relaxed);
+    LogCore::Get().CountSuppressed();
+    return false;
+  }
+  suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+bool Submit(const LogSite& site, const char* format, RecordBuilder& record, uint32_t suppressed) {
+  LogCore& core = LogCore::Get();
+  ThreadQueue& queue = core.CallerQueue();
+  core.EnsureFlusher();
+
+  RecordHeader header;
+  header.bytes = static_cast<uint32_t>(sizeof(RecordHeader) + record.size);
+  header.level = static_cast<uint8_t>(site.level);
+  header.channel = static_cast<uint8_t>(site.channel);
+  header.args = record.args;
+  header.truncated = record.truncated ? 1 : 0;
+  header.suppressed = suppressed;
+  header.format = format;
+  header.timeSec = DeadlineWaiter::Now();
+  if (!queue.Push(header, record.bytes, record.size)) {
+    queue.dropped[static_cast<int>(site.channel)].fetch_add(1, std::memory_order_relaxed);
+    core.CountDropped();
+    return false;
+  }
+  if (queue.Used() > kQueueBytes / 2 && !queue.wakeSent.exchange(true, std::memory_order_acq_rel)) {
+    core.Wake();
+  }
+  return true;
+}
+
+void SetChannelPath(LogChannel channel, const std::string& path) {
+  LogCore::Get().SetChannelPath(channel, path);
+}
+
+void Flush() {
+  LogCore::Get().Flush();
+}
+
+void Shutdown() {
+  LogCore::Get().Shutdown();
+}
+
+AsyncLogStats Stats() {
+  return LogCore::Get().Stats();
+}
+
+}  // namespace AsyncLog
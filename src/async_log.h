@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Asynchronous diagnostics log.
+//
+//   TFE_LOG(Info, Vulkan, "CreateResources: {}x{} zero-copy={}", w, h, zeroCopy);
+//   TFE_LOG_LIMITED(Warn, Capture, 5, "crop moved to {},{}", x, y);  // <= 5/s
+//
+// A call copies the format pointer and the raw arguments into a per-thread
+// lock-free queue and returns; a flusher thread turns them into text and
+// appends them to the channel's file. Logging from the capture or render
+// loop costs a timestamp and a small memcpy, never file I/O. A full queue
+// drops the message and the flusher reports how many were lost.
+//
+// Formats must be string literals (only the pointer is queued). "{}"
+// prints an argument, "{:x}" an integer in hex, "{{" and "}}" literal
+// braces. Strings are copied (up to kMaxLogString bytes), so temporaries
+// are fine.
+//
+// Levels below TFE_LOG_LEVEL are compiled out.
+
+enum class LogLevel : uint8_t {
+  Trace = 0,
+  Debug = 1,
+  Info = 2,
+  Warn = 3,
+  Error = 4,
+};
+
+#ifndef TFE_LOG_LEVEL
+#ifdef NDEBUG
+#define TFE_LOG_LEVEL 2   // Info
+#else
+#define TFE_LOG_LEVEL 1   // Debug
+#endif
+#endif
+
+// Each channel is one file, named as the synchronous logs it replaces.
+enum class LogChannel : uint8_t {
+  Init = 0,       // init_log.txt
+  Vulkan = 1,     // vulkan_debug.txt
+  Capture = 2,    // dxgi_crop_debug.txt
+  Count,
+};
+
+constexpr int kLogChannelCount = static_cast<int>(LogChannel::Count);
+constexpr size_t kMaxLogString = 256;
+
+// Per call site: level, channel and the rate limiter state.
+struct LogSite {
+  constexpr LogSite(LogLevel level, LogChannel channel, uint32_t maxPerSecond)
+      : level(level), channel(channel), maxPerSecond(maxPerSecond) {}
+
+  const LogLevel level;
+  const LogChannel channel;
+  const uint32_t maxPerSecond;            // 0 = unlimited
+  std::atomic<int64_t> second{-1};
+  std::atomic<uint32_t> count{0};
+  std::atomic<uint32_t> suppressed{0};
+};
+
+#define TFE_LOG_LIMITED(level, channel, perSecond, ...)                                       \
+  do {                                                                                        \
+    if constexpr (static_cast<int>(LogLevel::level) >= TFE_LOG_LEVEL) {                       \
+      static LogSite tfeLogSite_(LogLevel::level, LogChannel::channel, perSecond);            \
+      AsyncLog::Write(tfeLogSite_, __VA_ARGS__);                                              \
+    }                                                                                         \
+  } while (0)
+
+#define TFE_LOG(level, channel, ...) TFE_LOG_LIMITED(level, channel, 0, __VA_ARGS__)
+
+struct AsyncLogStats {
+  uint64_t written = 0;         // messages formatted by the flusher
+  uint64_t dropped = 0;         // queue full
+  uint64_t suppressed = 0;      // rate limited
+  uint32_t threads = 0;         // queues currently registered
+};
+
+namespace AsyncLog {
+
+// Argument encoding. Each argument is a tag byte plus its payload.
+enum class ArgTag : uint8_t {
+  Int = 0,
+  Uint = 1,
+  Double = 2,
+  String = 3,
+  Pointer = 4,
+  Bool = 5,
+};
+
+constexpr size_t kMaxRecordBytes = 1024;
+
+// Message being encoded on the caller's stack before it is queued.
+struct RecordBuilder {
+  uint8_t bytes[kMaxRecordBytes];
+  size_t size = 0;
+  uint8_t args = 0;
+  bool truncated = false;
+
+  void Put(ArgTag tag, const void* data, size_t dataBytes) {
+    if (size + 1 + dataBytes > kMaxRecordBytes) {
+      truncated = true;
+      return;
+    }
+    bytes[size++] = static_cast<uint8_t>(tag);
+    std::memcpy(bytes + size, data, dataBytes);
+    size += dataBytes;
+    args++;
+  }
+  void PutString(std::string_view text) {
+    const uint16_t length = static_cast<uint16_t>(std::min(text.size(), kMaxLogString));
+    if (size + 3 + length > kMaxRecordBytes) {
+      truncated = true;
+      return;
+    }
+    bytes[size++] = static_cast<uint8_t>(ArgTag::String);
+    std::memcpy(bytes + size, &length, sizeof(length));
+    std::memcpy(bytes + size + sizeof(length), text.data(), length);
+    size += sizeof(length) + length;
+    args++;
+  }
+};
+
+template <typename T>
+void Encode(RecordBuilder& record, const T& value) {
+  using U = std::decay_t<T>;
+  if constexpr (std::is_same_v<U, bool>) {
+    const uint8_t v = value ? 1 : 0;
+    record.Put(ArgTag::Bool, &v, sizeof(v));
+  } else if constexpr (std::is_enum_v<U>) {
+    const int64_t v = static_cast<int64_t>(value);
+    record.Put(ArgTag::Int, &v, sizeof(v));
+  } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+    const int64_t v = value;
+    record.Put(ArgTag::Int, &v, sizeof(v));
+  } else if constexpr (std::is_integral_v<U>) {
+    const uint64_t v = value;
+    record.Put(ArgTag::Uint, &v, sizeof(v));
+  } else if constexpr (std::is_floating_point_v<U>) {
+    const double v = value;
+    record.Put(ArgTag::Double, &v, sizeof(v));
+  } else if constexpr (std::is_array_v<T>) {
+    // String literals and char buffers: never null.
+    record.PutString(std::string_view(value));
+  } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+    record.PutString(value ? std::string_view(value) : std::string_view("(null)"));
+  } else if constexpr (std::is_convertible_v<const U&, std::string_view>) {
+    record.PutString(std::string_view(value));
+  } else if constexpr (std::is_pointer_v<U>) {
+    const uint64_t v = reinterpret_cast<uintptr_t>(value);
+    record.Put(ArgTag::Pointer, &v, sizeof(v));
+  } else {
+    static_assert(std::is_pointer_v<U>, "unsupported log argument type");
+  }
+}
+
+// Queues an encoded message. Never blocks; false when it was dropped.
+bool Submit(const LogSite& site, const char* format, RecordBuilder& record, uint32_t suppressed);
+
+// Rate limiter: false when the site is over its per-second budget.
+bool Admit(LogSite& site, uint32_t& suppressed);
+
+template <typename... Args>
+void Write(LogSite& site, const char* format, const Args&... args) {
+  uint32_t suppressed = 0;
+  if (site.maxPerSecond != 0 && !Admit(site, suppressed)) {
+    return;
+  }
+  RecordBuilder record;
+  (Encode(record, args), ...);
+  Submit(site, format, record, suppressed);
+}
+
+// Overrides a channel's file (before its first message reaches the flusher).
+void SetChannelPath(LogChannel channel, const std::string& path);
+// Blocks until everything queued before the call is written.
+void Flush();
+// Flushes and stops the flusher thread; later messages restart it.
+void Shutdown();
+AsyncLogStats Stats();
+
+}  // namespace AsyncLog
@@ -7,8 +7,28 @@
 
 struct CapturedFrame {
   Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+  // Optional producer-side 2x2 BT.709 luma, R16_UNORM at (width / 2) x
+  // (height / 2). Only valid together with this frame's texture.
+  Microsoft::WRL::ComPtr<ID3D11Texture2D> lumaTexture;
   int width = 0;
   int height = 0;
+  // Origin of the width x height frame inside texture. Non-zero (or a
+  // texture larger than the frame) when the frame is a region of a bigger
+  // surface, e.g. the window inside a duplicated monitor; consumers copy
+  // just that region.
+  int sourceX = 0;
+  int sourceY = 0;
   int64_t qpcTime = 0;
   int64_t systemTime100ns = 0;
+
+  // Producer-side identity and timing, when the source reports them.
+  // sequence is the source's monotonic frame number (0 = unknown).
+  // presentTime100ns is when the producer presented the frame, in the same
+  // QPC-derived 100 ns domain as systemTime100ns (0 = unknown; SourceClock
+  // picks the pacing domain per source). framesSkipped counts frames the
+  // source produced since the previous delivered one that were never
+  // delivered.
+  uint64_t sequence = 0;
+  int64_t presentTime100ns = 0;
+  uint32_t framesSkipped = 0;
 };
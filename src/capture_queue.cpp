@@ -0,0 +1,169 @@
+#include "capture_queue.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr double kRateSmoothing = 0.05;   // EWMA weight of one sample
+constexpr double kMaxIntervalSec = 0.5;   // longer gaps are pauses, not rate
+constexpr double kPeakDecay = 0.99;       // per consume; ~1 s half-life at 60 fps
+
+} // namespace
+
+const char* CaptureQueuePolicyName(CaptureQueuePolicy policy) {
+  switch (policy) {
+    case CaptureQueuePolicy::LatestOnly:
+      return "Latest only";
+    case CaptureQueuePolicy::Fifo:
+      return "FIFO";
+    case CaptureQueuePolicy::TimeWindow:
+      return "Time window";
+  }
+  return "";
+}
+
+// ----------------------------------------------------------------------------
+// CaptureLatencyHistogram
+// ----------------------------------------------------------------------------
+
+void CaptureLatencyHistogram::Add(double sec) {
+  double ms = sec * 1e3;
+  int bin = 0;
+  while (bin < kBins - 1 && ms > kEdgesMs[bin]) {
+    ++bin;
+  }
+  counts[bin]++;
+  total++;
+  sumSec += sec;
+  maxSec = std::max(maxSec, sec);
+}
+
+double CaptureLatencyHistogram::PercentileSec(double p) const {
+  if (total == 0) {
+    return 0.0;
+  }
+  uint64_t target = static_cast<uint64_t>(std::ceil(p * static_cast<double>(total)));
+  uint64_t seen = 0;
+  for (int bin = 0; bin < kBins - 1; ++bin) {
+    seen += counts[bin];
+    if (seen >= target) {
+      return kEdgesMs[bin] * 1e-3;
+    }
+  }
+  return maxSec;
+}
+
+const char* CaptureLatencyHistogram::BinLabel(int bin) {
+  static const char* kLabels[kBins] = {
+      "<1ms", "<2ms", "<4ms", "<8ms", "<12ms",
+      "<16.7ms", "<25ms", "<33ms", "<50ms", ">=50ms"};
+  return (bin >= 0 && bin < kBins) ? kLabels[bin] : "";
+}
+
+// ----------------------------------------------------------------------------
+// CaptureQueueTracker
+// ----------------------------------------------------------------------------
+
+void CaptureQueueTracker::Reset(const CaptureQueueConfig& config) {
+  m_config = config;
+  m_config.fifoDepth = std::max(m_config.fifoDepth, 1);
+  m_config.minPoolSize = std::max(m_config.minPoolSize, 2);
+  m_config.maxPoolSize = std::max(m_config.maxPoolSize, m_config.minPoolSize);
+  m_stats = CaptureQueueStats();
+  m_lastArrivalSec = 0.0;
+  m_pendingTarget = 0;
+  m_pendingCount = 0;
+  m_resizePending = false;
+  // Start with headroom against startup starvation (no rate or lag known
+  // yet); the measurements settle it from there.
+  m_stats.poolSize = std::clamp(std::max(TargetPoolSize(), m_config.initialPoolSize),
+                                m_config.minPoolSize, m_config.maxPoolSize);
+}
+
+void CaptureQueueTracker::OnArrival(double nowSec) {
+  m_stats.arrived++;
+  if (m_lastArrivalSec > 0.0) {
+    const double interval = nowSec - m_lastArrivalSec;
+    if (interval > 0.0 && interval < kMaxIntervalSec) {
+      m_stats.arrivalIntervalSec = m_stats.arrivalIntervalSec > 0.0
+          ? m_stats.arrivalIntervalSec + (interval - m_stats.arrivalIntervalSec) * kRateSmoothing
+          : interval;
+    }
+  }
+  m_lastArrivalSec = nowSec;
+}
+
+void CaptureQueueTracker::OnQueued(int queued) {
+  m_stats.queued = queued;
+  m_stats.maxQueued = std::max(m_stats.maxQueued, queued);
+}
+
+int CaptureQueueTracker::Capacity() const {
+  const int free = std::max(m_stats.poolSize - 1, 1);
+  switch (m_config.policy) {
+    case CaptureQueuePolicy::LatestOnly:
+      return 1;
+    case CaptureQueuePolicy::Fifo:
+      return std::min(m_config.fifoDepth, free);
+    case CaptureQueuePolicy::TimeWindow:
+      return free;
+  }
+  return 1;
+}
+
+int CaptureQueueTracker::TargetPoolSize() const {
+  // Most frames the policy would hold...
+  int held = 1;
+  if (m_config.policy == CaptureQueuePolicy::Fifo) {
+    held = m_config.fifoDepth;
+  } else if (m_config.policy == CaptureQueuePolicy::TimeWindow) {
+    held = m_stats.arrivalIntervalSec > 0.0
+        ? static_cast<int>(std::ceil(m_config.windowSec / m_stats.arrivalIntervalSec))
+        : 2;
+  }
+  // ...and how many it actually holds: arrival rate times time in the queue
+  // (Little's law). The peak rather than the mean, so consumer hitches are
+  // covered instead of starving the source.
+  int occupancy = 1;
+  if (m_stats.arrivalIntervalSec > 0.0) {
+    occupancy = static_cast<int>(std::ceil(m_stats.peakLagSec / m_stats.arrivalIntervalSec));
+  }
+  // Plus the frame the consumer is copying and the one the source renders
+  // into.
+  return std::clamp(occupancy, 1, std::max(held, 1)) + 2;
+}
+
+void CaptureQueueTracker::OnConsume(double latencySec) {
+  m_stats.consumed++;
+  m_stats.latency.Add(latencySec);
+  m_stats.consumeLagSec = m_stats.consumed > 1
+      ? m_stats.consumeLagSec + (latencySec - m_stats.consumeLagSec) * kRateSmoothing
+      : latencySec;
+  m_stats.peakLagSec = std::max(latencySec, m_stats.peakLagSec * kPeakDecay);
+
+  const int target = std::clamp(TargetPoolSize(), m_config.minPoolSize, m_config.maxPoolSize);
+  if (target == m_stats.poolSize) {
+    m_pendingCount = 0;
+    return;
+  }
+  if (target != m_pendingTarget) {
+    m_pendingTarget = target;
+    m_pendingCount = 0;
+  }
+  m_pendingCount++;
+  if (m_pendingCount >= (target > m_stats.poolSize ? kGrowAfter : kShrinkAfter)) {
+    m_stats.poolSize = target;
+    m_stats.poolResizes++;
+    m_pendingCount = 0;
+    m_resizePending = true;
+  }
+}
+
+bool CaptureQueueTracker::TakePoolResize(int& poolSize) {
+  if (!m_resizePending) {
+    return false;
+  }
+  m_resizePending = false;
+  poolSize = m_stats.poolSize;
+  return true;
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Hand-off queue between a capture callback thread and the consumer, with an
+// explicit drop policy:
+//
+//   LatestOnly  - hold one frame; a new arrival replaces it. Lowest latency,
+//                 skips frames whenever the consumer is slower than the source.
+//   Fifo        - hold up to fifoDepth frames and deliver them in order; the
+//                 oldest is dropped when full. Every frame reaches the consumer
+//                 as long as it keeps up on average.
+//   TimeWindow  - deliver in order, but frames that waited longer than
+//                 windowSec by the time they are consumed are dropped (the
+//                 newest frame is always delivered).
+//
+// The queue also measures arrival-to-consume latency and the arrival rate,
+// and from them recommends a capture pool size: enough buffers for what the
+// queue actually holds (rate x peak latency, capped by the policy) plus the frame
+// being consumed and the one being rendered, so the source never stalls on
+// an empty pool without holding surfaces it does not need.
+//
+// Times are seconds on one monotonic clock (DeadlineWaiter::Now()); passing
+// them in keeps the queue testable with simulated arrivals. Dropped items
+// are handed back to the caller so expensive releases happen outside the
+// lock.
+
+enum class CaptureQueuePolicy {
+  LatestOnly,
+  Fifo,
+  TimeWindow,
+};
+
+const char* CaptureQueuePolicyName(CaptureQueuePolicy policy);
+
+struct CaptureQueueConfig {
+  CaptureQueuePolicy policy = CaptureQueuePolicy::LatestOnly;
+  int fifoDepth = 3;
+  double windowSec = 0.050;
+  int initialPoolSize = 4;   // until the rate and lag are measured
+  int minPoolSize = 2;
+  int maxPoolSize = 8;
+};
+
+// Arrival-to-consume latency with fixed millisecond bins.
+struct CaptureLatencyHistogram {
+  static constexpr int kBins = 10;
+  // Upper bin edges in milliseconds; the last bin is open ended.
+  static constexpr std::array<double, kBins - 1> kEdgesMs = {
+      1.0, 2.0, 4.0, 8.0, 12.0, 16.7, 25.0, 33.3, 50.0};
+
+  std::array<uint64_t, kBins> counts = {};
+  uint64_t total = 0;
+  double sumSec = 0.0;
+  double maxSec = 0.0;
+
+  void Add(double sec);
+  double MeanSec() const { return total > 0 ? sumSec / static_cast<double>(total) : 0.0; }
+  // Upper edge of the bin holding the given percentile (0..1), in seconds.
+  double PercentileSec(double p) const;
+  static const char* BinLabel(int bin);
+};
+
+struct CaptureQueueStats {
+  uint64_t arrived = 0;
+  uint64_t consumed = 0;
+  uint64_t dropped = 0;             // discarded by the policy
+  uint64_t poolResizes = 0;
+  int queued = 0;
+  int maxQueued = 0;
+  int poolSize = 0;                 // current recommendation
+  double arrivalIntervalSec = 0.0;  // smoothed
+  double consumeLagSec = 0.0;       // smoothed arrival-to-consume latency
+  double peakLagSec = 0.0;          // slowly decaying maximum of the same
+  CaptureLatencyHistogram latency;
+};
+
+// Pool sizing and rate tracking; the non-template half of CaptureQueue.
+class CaptureQueueTracker {
+public:
+  void Reset(const CaptureQueueConfig& config);
+
+  void OnArrival(double nowSec);
+  // Records one consumed frame and updates the pool recommendation.
+  void OnConsume(double latencySec);
+  void OnDrop() {
+    m_stats.dropped++;
+    m_droppedTotal.fetch_add(1, std::memory_order_relaxed);
+  }
+  void OnQueued(int queued);
+
+  // Most frames the policy may hold at once at the current pool size; one
+  // buffer always stays free for the source.
+  int Capacity() const;
+  // Returns true (once) when the recommended pool size changed.
+  bool TakePoolResize(int& poolSize);
+
+  const CaptureQueueConfig& Config() const { return m_config; }
+  const CaptureQueueStats& Stats() const { return m_stats; }
+  // Every drop since construction (Reset does not clear it); read without
+  // the queue lock.
+  uint64_t DroppedTotal() const { return m_droppedTotal.load(std::memory_order_relaxed); }
+
+private:
+  int TargetPoolSize() const;
+
+  // Consumes the target must hold before the pool follows it: grow fast so
+  // the source does not starve, shrink slowly so a single stall does not
+  // cause a recreate each way.
+  static constexpr int kGrowAfter = 15;
+  static constexpr int kShrinkAfter = 240;
+
+  CaptureQueueConfig m_config;
+  CaptureQueueStats m_stats;
+  std::atomic<uint64_t> m_droppedTotal{0};
+  double m_lastArrivalSec = 0.0;
+  int m_pendingTarget = 0;
+  int m_pendingCount = 0;
+  bool m_resizePending = false;
+};
+
+template <typename T>
+class CaptureQueue {
+public:
+  explicit CaptureQueue(const CaptureQueueConfig& config = CaptureQueueConfig()) { m_tracker.Reset(config); }
+
+  // Drops everything queued into `released` and starts over with config.
+  void Reset(const CaptureQueueConfig& config, std::vector<T>& released) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Entry& entry : m_entries) {
+      released.push_back(std::move(entry.item));
+    }
+    m_entries.clear();
+    m_tracker.Reset(config);
+  }
+
+  // Producer. Frames pushed out by the policy are appended to `released`.
+  void Push(T item, double nowSec, std::vector<T>& released) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tracker.OnArrival(nowSec);
+    const int capacity = m_tracker.Capacity();
+    while (static_cast<int>(m_entries.size()) >= capacity) {
+      released.push_back(std::move(m_entries.front().item));
+      m_entries.pop_front();
+      m_tracker.OnDrop();
+    }
+    m_entries.push_back(Entry{std::move(item), nowSec});
+    m_tracker.OnQueued(static_cast<int>(m_entries.size()));
+  }
+
+  // Consumer. Returns the next frame under the policy; frames it skips are
+  // appended to `released`.
+  bool Pop(T& item, double nowSec, std::vector<T>& released) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_tracker.Config().policy == CaptureQueuePolicy::TimeWindow) {
+      while (m_entries.size() > 1 && nowSec - m_entries.front().arrivalSec > m_tracker.Config().windowSec) {
+        released.push_back(std::move(m_entries.front().item));
+        m_entries.pop_front();
+        m_tracker.OnDrop();
+      }
+    }
+    return PopFrontLocked(item, nowSec);
+  }
+
+  // Consumer. Newest frame regardless of policy; everything older is dropped.
+  bool PopLatest(T& item, double nowSec, std::vector<T>& released) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (m_entries.size() > 1) {
+      released.push_back(std::move(m_entries.front().item));
+      m_entries.pop_front();
+      m_tracker.OnDrop();
+    }
+    return PopFrontLocked(item, nowSec);
+  }
+
+  bool TakePoolResize(int& poolSize) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tracker.TakePoolResize(poolSize);
+  }
+
+  CaptureQueueStats Stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tracker.Stats();
+  }
+
+  CaptureQueueConfig Config() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tracker.Config();
+  }
+
+  // Lock-free; see CaptureQueueTracker::DroppedTotal.
+  uint64_t DroppedTotal() const { return m_tracker.DroppedTotal(); }
+
+private:
+  struct Entry {
+    T item;
+    double arrivalSec;
+  };
+
+  bool PopFrontLocked(T& item, double nowSec) {
+    if (m_entries.empty()) {
+      return false;
+    }
+    item = std::move(m_entries.front().item);
+    m_tracker.OnConsume(std::max(nowSec - m_entries.front().arrivalSec, 0.0));
+    m_entries.pop_front();
+    m_tracker.OnQueued(static_cast<int>(m_entries.size()));
+    return true;
+  }
+
+  mutable std::mutex m_mutex;
+  std::deque<Entry> m_entries;
+  CaptureQueueTracker m_tracker;
+};
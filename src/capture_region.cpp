@@ -0,0 +1,52 @@
+#include "capture_region.h"
+
+#include <algorithm>
+#include <cstring>
+
+CaptureRegion ClampCaptureRegion(int clientLeft, int clientTop, int clientWidth, int clientHeight,
+                                 int monitorLeft, int monitorTop, int frameWidth, int frameHeight) {
+  int x0 = clientLeft - monitorLeft;
+  int y0 = clientTop - monitorTop;
+  int x1 = x0 + std::max(clientWidth, 0);
+  int y1 = y0 + std::max(clientHeight, 0);
+  x0 = std::clamp(x0, 0, std::max(frameWidth, 0));
+  y0 = std::clamp(y0, 0, std::max(frameHeight, 0));
+  x1 = std::clamp(x1, x0, std::max(frameWidth, 0));
+  y1 = std::clamp(y1, y0, std::max(frameHeight, 0));
+
+  CaptureRegion region;
+  region.x = x0;
+  region.y = y0;
+  region.width = x1 - x0;
+  region.height = y1 - y0;
+  return region;
+}
+
+void CopyCaptureRegion(const CaptureRegion& region, const uint8_t* src, size_t srcPitch,
+                       uint8_t* dst, size_t dstPitch, uint32_t bytesPerPixel) {
+  if (region.Empty()) {
+    return;
+  }
+  const uint8_t* from = src + srcPitch * region.y + static_cast<size_t>(region.x) * bytesPerPixel;
+  const size_t rowBytes = static_cast<size_t>(region.width) * bytesPerPixel;
+  for (int y = 0; y < region.height; ++y) {
+    std::memcpy(dst + dstPitch * y, from + srcPitch * y, rowBytes);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// CaptureRegionTracker
+// ----------------------------------------------------------------------------
+
+bool CaptureRegionTracker::Update(const CaptureRegion& region, int frameWidth, int frameHeight) {
+  bool changed = region != m_region;
+  m_region = region;
+  m_frameWidth = frameWidth;
+  m_frameHeight = frameHeight;
+  m_dirty = false;
+  m_refreshes++;
+  if (changed) {
+    m_changes++;
+  }
+  return changed;
+}
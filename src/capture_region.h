@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Source region of a cropped capture (DXGI Crop mode).
+//
+// Desktop Duplication delivers the whole monitor; the captured window is a
+// sub-rectangle of it. Instead of cropping into an intermediate texture and
+// then copying that into the frame queue, the frame carries the region and
+// the queue copy reads only those pixels, so the crop costs one copy of the
+// window area rather than two.
+//
+// The window geometry is cached: it is re-read only after the owner reports
+// a move/resize (or the source frame size changes), not once per frame.
+
+struct CaptureRegion {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+
+  bool Empty() const { return width <= 0 || height <= 0; }
+  bool operator==(const CaptureRegion& o) const {
+    return x == o.x && y == o.y && width == o.width && height == o.height;
+  }
+  bool operator!=(const CaptureRegion& o) const { return !(*this == o); }
+};
+
+// Window client area (screen coordinates) mapped into a frameWidth x
+// frameHeight monitor frame whose top-left is at (monitorLeft, monitorTop),
+// clamped to the frame. Empty if the window is entirely off the frame.
+CaptureRegion ClampCaptureRegion(int clientLeft, int clientTop, int clientWidth, int clientHeight,
+                                 int monitorLeft, int monitorTop, int frameWidth, int frameHeight);
+
+// CPU equivalent of the region copy the GPU path does into a queue slot.
+void CopyCaptureRegion(const CaptureRegion& region, const uint8_t* src, size_t srcPitch,
+                       uint8_t* dst, size_t dstPitch, uint32_t bytesPerPixel);
+
+class CaptureRegionTracker {
+public:
+  // Marks the cached geometry stale (window moved, resized, changed monitor).
+  void Invalidate() { m_dirty = true; }
+
+  // True when the geometry must be re-read before cropping a frame of this
+  // size.
+  bool NeedsRefresh(int frameWidth, int frameHeight) const {
+    return m_dirty || frameWidth != m_frameWidth || frameHeight != m_frameHeight;
+  }
+
+  // Stores freshly read geometry; returns true if the region changed.
+  bool Update(const CaptureRegion& region, int frameWidth, int frameHeight);
+
+  const CaptureRegion& Region() const { return m_region; }
+  uint64_t Refreshes() const { return m_refreshes; }
+  uint64_t Changes() const { return m_changes; }
+
+private:
+  CaptureRegion m_region;
+  int m_frameWidth = 0;
+  int m_frameHeight = 0;
+  bool m_dirty = true;
+  uint64_t m_refreshes = 0;
+  uint64_t m_changes = 0;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "cpu_frame.h"
+
+#ifdef _WIN32
+#include "capture_frame.h"
+#endif
+
+#include <cstdint>
+
+// Common interface of the capture backends.
+//
+// GPU sources (WGC, Desktop Duplication, game hook) deliver a D3D11 texture
+// in gpu; CPU sources (X11, replay) deliver system-memory pixels in cpu. The
+// caller checks onGpu and either copies the texture or uploads the pixels.
+// Either way the frame is only valid until the source's next AcquireFrame.
+
+struct SourceFrame {
+#ifdef _WIN32
+  CapturedFrame gpu;
+#endif
+  CpuFrame cpu;
+  bool onGpu = false;
+
+  int Width() const {
+#ifdef _WIN32
+    if (onGpu) return gpu.width;
+#endif
+    return cpu.width;
+  }
+  int Height() const {
+#ifdef _WIN32
+    if (onGpu) return gpu.height;
+#endif
+    return cpu.height;
+  }
+  uint64_t Sequence() const {
+#ifdef _WIN32
+    if (onGpu) return gpu.sequence;
+#endif
+    return cpu.sequence;
+  }
+};
+
+// Pacing clock of one source. The first frame picks the domain and it stays
+// for the life of the source: present times when the source reports them,
+// capture times otherwise, so one interval estimate never mixes the two. A
+// present-time source that misses a stamp is placed on its present clock by
+// the last measured capture latency instead of switching domains.
+class SourceClock {
+public:
+  void Reset() { *this = SourceClock(); }
+
+  int64_t Time100ns(int64_t presentTime100ns, int64_t systemTime100ns) {
+    if (!m_decided) {
+      m_decided = true;
+      m_usePresent = presentTime100ns != 0;
+    }
+    if (!m_usePresent) {
+      return systemTime100ns;
+    }
+    if (presentTime100ns != 0) {
+      m_latency100ns = systemTime100ns - presentTime100ns;
+      return presentTime100ns;
+    }
+    return systemTime100ns - m_latency100ns;
+  }
+
+  bool UsesPresentTime() const { return m_usePresent; }
+
+private:
+  bool m_decided = false;
+  bool m_usePresent = false;
+  int64_t m_latency100ns = 0;   // capture time minus present time, last stamped frame
+};
+
+class ICaptureSource {
+public:
+  virtual ~ICaptureSource() = default;
+
+  virtual const char* SourceName() const = 0;
+  virtual bool IsCapturing() const = 0;
+  virtual void StopCapture() = 0;
+
+  // Returns false when no new frame is available.
+  virtual bool AcquireFrame(SourceFrame& frame) = 0;
+
+  // True while the source spins inside AcquireFrame (DXGI spin-wait), so a
+  // miss should be retried instead of ending the caller's batch.
+  virtual bool RetryOnMiss() const { return false; }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "capture_region.h"
+#include "pixel_convert.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A captured frame in system memory, for capture sources without a D3D11
+// device (Linux X11, replays). Same identity and timing fields as
+// CapturedFrame; the pixels stay owned by the source and are valid until
+// its next AcquireNextFrame or StopCapture.
+struct CpuFrame {
+  const uint8_t* data = nullptr;
+  size_t pitch = 0;
+  int width = 0;
+  int height = 0;
+  PixelFormat format = PixelFormat::Bgra8;
+
+  uint64_t sequence = 0;
+  int64_t systemTime100ns = 0;      // monotonic clock when the frame was read
+  int64_t presentTime100ns = 0;     // when the source produced it (0 = unknown)
+  int64_t qpcTime = 0;              // platform counter at capture (QPC ticks; 0 = unknown)
+  uint32_t framesSkipped = 0;
+
+  // Areas that changed since the previous delivered frame. Empty together
+  // with fullFrameDirty means the whole frame may have changed.
+  std::vector<CaptureRegion> dirtyRects;
+  bool fullFrameDirty = true;
+
+  uint64_t DirtyPixels() const {
+    if (fullFrameDirty) {
+      return static_cast<uint64_t>(width) * height;
+    }
+    uint64_t pixels = 0;
+    for (const CaptureRegion& r : dirtyRects) {
+      pixels += static_cast<uint64_t>(r.width) * r.height;
+    }
+    return pixels;
+  }
+};
@@ -1,11 +1,11 @@
 #include "d3d11_device.h"
+#include "async_log.h"
 
 #include <windows.h>
 #include <dxgi1_6.h>
 
 #include <algorithm>
 #include <cstdint>
-#include <fstream>
 #include <sstream>
 #include <vector>
 #include <iostream>
@@ -20,10 +20,8 @@ std::string HrToHex(HRESULT hr) {
   return ss.str();
 }
 
-void AppendInitLog(std::ofstream& log, const std::string& line) {
-  if (log.is_open()) {
-    log << line << "\n";
-  }
+void AppendInitLog(const std::string& line) {
+  TFE_LOG(Info, Init, "{}", line);
 }
 
 bool LuidEquals(const LUID& a, const LUID& b) {
@@ -107,8 +105,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
   flags |= D3D11_CREATE_DEVICE_DEBUG;
 #endif
 
-  std::ofstream initLog("init_log.txt", std::ios::app);
-  AppendInitLog(initLog, "\n[D3D11Device::Initialize] begin");
+  AppendInitLog("[D3D11Device::Initialize] begin");
   m_hasDxgiOutputs = false;
   m_usingSystemMonitorFallback = false;
   m_activeAdapterName.clear();
@@ -127,17 +124,17 @@ bool D3D11Device::Initialize(HWND hwnd) {
        gpuPref == L"high" || gpuPref == L"dgpu");
   const bool requireOutputAdapters = !preferHighPerformance;
   if (preferHighPerformance) {
-    AppendInitLog(initLog, "GPU preference: high_performance (TMFE_GPU_PREFERENCE)");
+    AppendInitLog("GPU preference: high_performance (TMFE_GPU_PREFERENCE)");
   } else {
-    AppendInitLog(initLog, "GPU preference: display_attached (default)");
+    AppendInitLog("GPU preference: display_attached (default)");
   }
 
   HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(&m_factory));
   if (FAILED(hr)) {
-    AppendInitLog(initLog, "CreateDXGIFactory1 failed: " + HrToHex(hr));
+    AppendInitLog("CreateDXGIFactory1 failed: " + HrToHex(hr));
     return false;
   }
-  AppendInitLog(initLog, "CreateDXGIFactory1 succeeded");
+  AppendInitLog("CreateDXGIFactory1 succeeded");
 
   Microsoft::WRL::ComPtr<IDXGIFactory2> adapterEnumFactory = m_factory;
   D3D_FEATURE_LEVEL featureLevels[] = {
@@ -162,7 +159,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
         &m_device,
         &selectedFeatureLevel,
         &m_context);
-    AppendInitLog(initLog, label + " D3D11CreateDevice: " + HrToHex(createHr));
+    AppendInitLog(label + " D3D11CreateDevice: " + HrToHex(createHr));
 
 #if defined(_DEBUG)
     if (createHr == DXGI_ERROR_SDK_COMPONENT_MISSING &&
@@ -179,7 +176,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
           &m_device,
           &selectedFeatureLevel,
           &m_context);
-      AppendInitLog(initLog, label + " retry without debug layer: " + HrToHex(createHr));
+      AppendInitLog(label + " retry without debug layer: " + HrToHex(createHr));
     }
 #endif
 
@@ -187,7 +184,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
       return false;
     }
 
-    AppendInitLog(initLog, label + " feature level: " + std::to_string(static_cast<int>(selectedFeatureLevel)));
+    AppendInitLog(label + " feature level: " + std::to_string(static_cast<int>(selectedFeatureLevel)));
     return true;
   };
 
@@ -195,20 +192,20 @@ bool D3D11Device::Initialize(HWND hwnd) {
     Microsoft::WRL::ComPtr<IDXGIDevice> dxgiDevice;
     HRESULT localHr = m_device.As(&dxgiDevice);
     if (FAILED(localHr)) {
-      AppendInitLog(initLog, "Query IDXGIDevice failed: " + HrToHex(localHr));
+      AppendInitLog("Query IDXGIDevice failed: " + HrToHex(localHr));
       return false;
     }
 
     Microsoft::WRL::ComPtr<IDXGIAdapter> adapter;
     localHr = dxgiDevice->GetAdapter(&adapter);
     if (FAILED(localHr)) {
-      AppendInitLog(initLog, "GetAdapter failed: " + HrToHex(localHr));
+      AppendInitLog("GetAdapter failed: " + HrToHex(localHr));
       return false;
     }
 
     localHr = adapter->GetParent(IID_PPV_ARGS(&m_factory));
     if (FAILED(localHr)) {
-      AppendInitLog(initLog, "GetParent(IDXGIFactory2) failed: " + HrToHex(localHr));
+      AppendInitLog("GetParent(IDXGIFactory2) failed: " + HrToHex(localHr));
       return false;
     }
 
@@ -226,7 +223,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
     EnumerateMonitors();
     m_hasDxgiOutputs = !m_monitors.empty();
     if (!m_hasDxgiOutputs) {
-      AppendInitLog(initLog, "No DXGI outputs on selected adapter, using system monitor fallback");
+      AppendInitLog("No DXGI outputs on selected adapter, using system monitor fallback");
       EnumerateSystemMonitors();
       m_usingSystemMonitorFallback = !m_monitors.empty();
     } else {
@@ -238,10 +235,10 @@ bool D3D11Device::Initialize(HWND hwnd) {
       m_activeAdapterName = deviceAdapterName;
     }
 
-    AppendInitLog(initLog, "EnumerateMonitors count: " + std::to_string(m_monitors.size()));
-    AppendInitLog(initLog, "DXGI outputs available: " + std::string(m_hasDxgiOutputs ? "true" : "false"));
+    AppendInitLog("EnumerateMonitors count: " + std::to_string(m_monitors.size()));
+    AppendInitLog("DXGI outputs available: " + std::string(m_hasDxgiOutputs ? "true" : "false"));
     if (!m_activeAdapterName.empty()) {
-      AppendInitLog(initLog, "Active adapter: " + m_activeAdapterName);
+      AppendInitLog("Active adapter: " + m_activeAdapterName);
     }
     return !m_monitors.empty();
   };
@@ -305,8 +302,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
 
     const bool hasOutputs = AdapterHasOutputs(adapter1.Get());
     const std::string adapterName = AdapterName(adapter1.Get());
-    AppendInitLog(initLog,
-                  "Trying adapter [" + adapterName + "] hasOutputs=" + (hasOutputs ? "true" : "false"));
+    AppendInitLog("Trying adapter [" + adapterName + "] hasOutputs=" + (hasOutputs ? "true" : "false"));
     if (requireOutputAdapters && !hasOutputs) {
       continue;
     }
@@ -319,7 +315,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
   }
 
   if (!created) {
-    AppendInitLog(initLog, "Trying default hardware device");
+    AppendInitLog("Trying default hardware device");
     if (tryCreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, "Default hardware") &&
         syncFactoryAndMonitors()) {
       created = true;
@@ -327,7 +323,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
   }
 
   if (!created) {
-    AppendInitLog(initLog, "Trying WARP fallback device");
+    AppendInitLog("Trying WARP fallback device");
     if (tryCreateDevice(nullptr, D3D_DRIVER_TYPE_WARP, "WARP fallback") &&
         syncFactoryAndMonitors()) {
       created = true;
@@ -335,7 +331,7 @@ bool D3D11Device::Initialize(HWND hwnd) {
   }
 
   if (!created) {
-    AppendInitLog(initLog, "All D3D11 device initialization paths failed");
+    AppendInitLog("All D3D11 device initialization paths failed");
     return false;
   }
 
@@ -349,11 +345,11 @@ bool D3D11Device::Initialize(HWND hwnd) {
   UINT width = static_cast<UINT>(rect.right - rect.left);
   UINT height = static_cast<UINT>(rect.bottom - rect.top);
   if (!CreateSwapChain(hwnd, width, height)) {
-    AppendInitLog(initLog, "CreateSwapChain failed");
+    AppendInitLog("CreateSwapChain failed");
     return false;
   }
 
-  AppendInitLog(initLog, "D3D11Device::Initialize succeeded");
+  AppendInitLog("D3D11Device::Initialize succeeded");
   return true;
 }
 
@@ -568,10 +564,7 @@ bool D3D11Device::CreateSwapChain(HWND hwnd, UINT width, UINT height) {
         &m_swapChain);
 
     if (FAILED(localHr)) {
-      std::ofstream log("init_log.txt", std::ios::app);
-      if (log.is_open()) {
-        log << "CreateSwapChainForHwnd(" << tag << ") failed: " << HrToHex(localHr) << "\n";
-      }
+      AppendInitLog("CreateSwapChainForHwnd(" + std::string(tag) + ") failed: " + HrToHex(localHr));
     }
     return localHr;
   };
@@ -0,0 +1,247 @@
+#include "deadline_wait.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <ctime>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#endif
+
+namespace {
+
+inline void CpuRelax() {
+#ifdef _WIN32
+  YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+#ifdef _WIN32
+double QpcPeriod() {
+  static const double period = [] {
+    LARGE_INTEGER freq = {};
+    QueryPerformanceFrequency(&freq);
+    return freq.QuadPart > 0 ? 1.0 / static_cast<double>(freq.QuadPart) : 0.0;
+  }();
+  return period;
+}
+#endif
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// WaitHistogram
+// ----------------------------------------------------------------------------
+
+void WaitHistogram::Add(double sec) {
+  double us = sec * 1e6;
+  int bin = 0;
+  while (bin < kBins - 1 && us > kEdgesUs[bin]) {
+    ++bin;
+  }
+  counts[bin]++;
+  total++;
+  sumSec += sec;
+  maxSec = std::max(maxSec, sec);
+}
+
+double WaitHistogram::PercentileSec(double p) const {
+  if (total == 0) {
+    return 0.0;
+  }
+  uint64_t target = static_cast<uint64_t>(std::ceil(p * static_cast<double>(total)));
+  uint64_t seen = 0;
+  for (int bin = 0; bin < kBins - 1; ++bin) {
+    seen += counts[bin];
+    if (seen >= target) {
+      return kEdgesUs[bin] * 1e-6;
+    }
+  }
+  return maxSec;
+}
+
+const char* WaitHistogram::BinLabel(int bin) {
+  static const char* kLabels[kBins] = {
+      "<10us", "<25us", "<50us", "<100us", "<250us",
+      "<500us", "<1ms", "<2ms", "<5ms", ">=5ms"};
+  return (bin >= 0 && bin < kBins) ? kLabels[bin] : "";
+}
+
+// ----------------------------------------------------------------------------
+// DeadlineWaiter
+// ----------------------------------------------------------------------------
+
+DeadlineWaiter::DeadlineWaiter() : DeadlineWaiter(DeadlineWaitConfig()) {}
+
+DeadlineWaiter::DeadlineWaiter(const DeadlineWaitConfig& config) : m_config(config) {
+  m_spinThreshold = std::clamp(m_config.initialSpinSec, m_config.minSpinSec, m_config.maxSpinSec);
+  m_stats.spinThresholdSec = m_spinThreshold;
+#ifdef _WIN32
+  HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+  if (!timer) {
+    // Pre-1803 Windows: regular timer, relies on timeBeginPeriod(1).
+    timer = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+  }
+  m_timer = timer;
+#endif
+}
+
+DeadlineWaiter::~DeadlineWaiter() {
+#ifdef _WIN32
+  if (m_timer) {
+    CloseHandle(static_cast<HANDLE>(m_timer));
+  }
+#endif
+}
+
+double DeadlineWaiter::Now() {
+#ifdef _WIN32
+  LARGE_INTEGER now = {};
+  QueryPerformanceCounter(&now);
+  return static_cast<double>(now.QuadPart) * QpcPeriod();
+#else
+  timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+void DeadlineWaiter::SleepUntil(double deadlineSec) {
+#ifdef _WIN32
+  double remaining = deadlineSec - Now();
+  if (remaining <= 0.0) {
+    return;
+  }
+  if (m_timer) {
+    LARGE_INTEGER due = {};
+    due.QuadPart = -static_cast<LONGLONG>(remaining * 1e7);
+    if (due.QuadPart < 0 &&
+        SetWaitableTimer(static_cast<HANDLE>(m_timer), &due, 0, nullptr, nullptr, FALSE)) {
+      WaitForSingleObject(static_cast<HANDLE>(m_timer), INFINITE);
+      return;
+    }
+  }
+  Sleep(static_cast<DWORD>(remaining * 1000.0));
+#else
+  timespec ts = {};
+  double whole = std::floor(deadlineSec);
+  ts.tv_sec = static_cast<time_t>(whole);
+  ts.tv_nsec = static_cast<long>((deadlineSec - whole) * 1e9);
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec += 1;
+    ts.tv_nsec -= 1000000000L;
+  }
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+  }
+#endif
+}
+
+void DeadlineWaiter::SpinUntil(double deadlineSec) {
+  while (Now() < deadlineSec) {
+    CpuRelax();
+  }
+}
+
+double DeadlineWaiter::WaitUntil(double deadlineSec) {
+  m_stats.waits++;
+  double now = Now();
+
+  const double span = deadlineSec - now;
+  if (span > 0.0) {
+    m_waitSpanSec = m_waitSpanSec > 0.0 ? m_waitSpanSec + (span - m_waitSpanSec) * 0.125 : span;
+    if (m_spinThreshold > SpinCap()) {
+      // The rate went up: a threshold above the wait would never sleep, and
+      // without sleeps nothing would calibrate it back down.
+      m_spinThreshold = std::max(SpinCap(), m_config.minSpinSec);
+      m_stats.spinThresholdSec = m_spinThreshold;
+    }
+  }
+
+  double sleepTarget = deadlineSec - m_spinThreshold;
+  if (sleepTarget > now) {
+    SleepUntil(sleepTarget);
+    double woke = Now();
+    double sleepOvershoot = std::max(woke - sleepTarget, 0.0);
+    m_stats.sleeps++;
+    m_stats.sleepSec += woke - now;
+    m_stats.sleepOvershoot.Add(sleepOvershoot);
+    if (woke > deadlineSec) {
+      m_stats.lateSleeps++;
+    }
+    if (m_config.adaptive) {
+      Calibrate(sleepOvershoot);
+    }
+    now = woke;
+  }
+
+  if (now < deadlineSec) {
+    SpinUntil(deadlineSec);
+    double spunUntil = Now();
+    m_stats.spinSec += spunUntil - now;
+    now = spunUntil;
+  }
+
+  double overshoot = std::max(now - deadlineSec, 0.0);
+  m_stats.overshoot.Add(overshoot);
+  return overshoot;
+}
+
+void DeadlineWaiter::Calibrate(double sleepOvershootSec) {
+  m_recent[m_recentWrite] = sleepOvershootSec;
+  m_recentWrite = (m_recentWrite + 1) % kCalibrationWindow;
+  m_recentCount = std::min(m_recentCount + 1, kCalibrationWindow);
+
+  // Late wakes re-evaluate right away (a missed deadline is the expensive
+  // case); otherwise the threshold is re-fitted every 16 sleeps. Using a
+  // windowed percentile rather than the raw sample keeps a single preemption
+  // spike from pinning the spin at its maximum.
+  bool late = sleepOvershootSec + m_config.marginSec > m_spinThreshold;
+  if (m_recentCount < 16 || (!late && (m_recentWrite % 16) != 0)) {
+    if (late && m_recentCount < 16) {
+      m_spinThreshold = std::clamp(sleepOvershootSec * 1.25 + m_config.marginSec,
+                                   m_config.minSpinSec, std::max(SpinCap(), m_config.minSpinSec));
+      m_stats.spinThresholdSec = m_spinThreshold;
+    }
+    return;
+  }
+
+  std::array<double, kCalibrationWindow> sorted = m_recent;
+  auto end = sorted.begin() + m_recentCount;
+  size_t index = static_cast<size_t>(m_config.overshootPercentile * static_cast<double>(m_recentCount - 1));
+  std::nth_element(sorted.begin(), sorted.begin() + index, end);
+  double target = sorted[index] + m_config.marginSec;
+  if (late) {
+    target = std::max(target, m_spinThreshold);
+  } else if (target < m_spinThreshold) {
+    // On time: step down toward the observed overshoot rather than jumping,
+    // so one quiet window does not undo a real need for spin.
+    target = std::max(target, m_spinThreshold * m_config.decay);
+  }
+
+  m_spinThreshold = std::clamp(target, m_config.minSpinSec, std::max(SpinCap(), m_config.minSpinSec));
+  m_stats.spinThresholdSec = m_spinThreshold;
+}
+
+double DeadlineWaiter::SpinCap() const {
+  if (m_waitSpanSec <= 0.0) {
+    return m_config.maxSpinSec;
+  }
+  return std::min(m_config.maxSpinSec, m_waitSpanSec * m_config.maxSpinFraction);
+}
+
+void DeadlineWaiter::ResetStats() {
+  m_stats = DeadlineWaitStats();
+  m_stats.spinThresholdSec = m_spinThreshold;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Hybrid sleep-then-spin wait for absolute deadlines.
+//
+// The OS sleep (high-resolution waitable timer on Windows,
+// clock_nanosleep(TIMER_ABSTIME) elsewhere) covers everything except the last
+// spinThreshold seconds, which are spun. The threshold is calibrated from the
+// measured wake-up overshoot of the sleeps themselves, so on a system whose
+// timer wakes within 60 us the spin shrinks to ~100 us instead of a fixed
+// 1-2 ms, which is what keeps high output rates from burning a core.
+// The threshold decays again once sleeps wake on time, and never exceeds a
+// fraction of the typical wait, so at high refresh rates the waiter keeps
+// sleeping (and keeps calibrating) instead of settling into a pure spin.
+//
+// Times are seconds on the platform monotonic clock (QPC on Windows,
+// CLOCK_MONOTONIC elsewhere), see DeadlineWaiter::Now().
+
+// Overshoot histogram with fixed microsecond bins.
+struct WaitHistogram {
+  static constexpr int kBins = 10;
+  // Upper bin edges in microseconds; the last bin is open ended.
+  static constexpr std::array<double, kBins - 1> kEdgesUs = {
+      10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2000.0, 5000.0};
+
+  std::array<uint64_t, kBins> counts = {};
+  uint64_t total = 0;
+  double sumSec = 0.0;
+  double maxSec = 0.0;
+
+  void Add(double sec);
+  void Clear() { *this = WaitHistogram(); }
+  double MeanSec() const { return total > 0 ? sumSec / static_cast<double>(total) : 0.0; }
+  // Upper edge of the bin holding the given percentile (0..1), in seconds.
+  double PercentileSec(double p) const;
+  static const char* BinLabel(int bin);
+};
+
+struct DeadlineWaitConfig {
+  bool adaptive = true;
+  double initialSpinSec = 1.0e-3;
+  double minSpinSec = 50.0e-6;
+  double maxSpinSec = 4.0e-3;
+  double maxSpinFraction = 0.5;        // of the typical wait (deadline - call time)
+  double decay = 0.75;                 // per on-time refit, toward the observed overshoot
+  double marginSec = 20.0e-6;          // added on top of the observed overshoot
+  double overshootPercentile = 0.98;   // of recent sleep overshoots
+};
+
+struct DeadlineWaitStats {
+  uint64_t waits = 0;
+  uint64_t sleeps = 0;
+  uint64_t lateSleeps = 0;             // sleeps that woke after the deadline
+  double sleepSec = 0.0;
+  double spinSec = 0.0;
+  double spinThresholdSec = 0.0;
+  WaitHistogram overshoot;             // wake time - deadline
+  WaitHistogram sleepOvershoot;        // sleep wake time - sleep target
+};
+
+class DeadlineWaiter {
+public:
+  DeadlineWaiter();
+  explicit DeadlineWaiter(const DeadlineWaitConfig& config);
+  ~DeadlineWaiter();
+
+  DeadlineWaiter(const DeadlineWaiter&) = delete;
+  DeadlineWaiter& operator=(const DeadlineWaiter&) = delete;
+
+  static double Now();
+
+  // Blocks until deadlineSec. Returns the overshoot (>= 0) in seconds.
+  double WaitUntil(double deadlineSec);
+
+  // Raw primitives, exposed for the wait benchmark.
+  void SleepUntil(double deadlineSec);
+  static void SpinUntil(double deadlineSec);
+
+  double SpinThreshold() const { return m_spinThreshold; }
+  const DeadlineWaitStats& Stats() const { return m_stats; }
+  void ResetStats();
+
+private:
+  void Calibrate(double sleepOvershootSec);
+  double SpinCap() const;
+
+  static constexpr int kCalibrationWindow = 64;
+
+  DeadlineWaitConfig m_config;
+  void* m_timer = nullptr;
+  double m_spinThreshold = 0.0;
+  double m_waitSpanSec = 0.0;          // running mean of deadline - call time
+  std::array<double, kCalibrationWindow> m_recent = {};
+  int m_recentCount = 0;
+  int m_recentWrite = 0;
+  DeadlineWaitStats m_stats;
+};
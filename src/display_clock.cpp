@@ -0,0 +1,279 @@
+#include "display_clock.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Initial drift uncertainty: +/-100 ppm covers any sane crystal pair.
+constexpr double kInitialDriftVariance = 1e-8;
+
+} // namespace
+
+void DisplayClock::Reset() {
+  ResetCaptureMapping();
+  ResetDisplay();
+  m_nominalPeriod = 0.0;
+  m_period = 0.0;
+}
+
+void DisplayClock::ResetCaptureMapping() {
+  m_kfValid = false;
+  m_offsetBase = 0.0;
+  m_kfTime = 0.0;
+  m_offset = 0.0;
+  m_drift = 0.0;
+  m_p00 = 0.0;
+  m_p01 = 0.0;
+  m_p11 = 0.0;
+  m_consecutiveRejects = 0;
+  m_captureSamples = 0;
+  m_captureRejected = 0;
+}
+
+void DisplayClock::ResetDisplay() {
+  m_period = m_nominalPeriod;
+  m_phase = 0.0;
+  m_phaseValid = false;
+  m_locked = false;
+  m_lastPhaseError = 0.0;
+  m_meanAbsError = 0.0;
+  m_consecutiveOutliers = 0;
+  m_vblankSamples = 0;
+  m_vblankOutliers = 0;
+  m_acqT0 = 0.0;
+  m_acqIndex = 0.0;
+  m_acqSumX = 0.0;
+  m_acqSumY = 0.0;
+  m_acqSumXX = 0.0;
+  m_acqSumXY = 0.0;
+}
+
+void DisplayClock::BeginAcquisition(double qpcSec) {
+  m_phase = qpcSec;
+  m_phaseValid = true;
+  m_vblankSamples = 1;
+  m_acqT0 = qpcSec;
+  m_acqIndex = 0.0;
+  m_acqSumX = 0.0;
+  m_acqSumY = 0.0;
+  m_acqSumXX = 0.0;
+  m_acqSumXY = 0.0;
+}
+
+// ----------------------------------------------------------------------------
+// Capture clock mapping
+// ----------------------------------------------------------------------------
+
+void DisplayClock::AddCaptureSample(double qpcSec, double captureSec) {
+  const double measVar = m_config.offsetMeasNoiseSec * m_config.offsetMeasNoiseSec;
+
+  if (!m_kfValid) {
+    // Keep the large absolute offset (system time epoch vs QPC boot time) out
+    // of the filter state so the residual keeps full double precision.
+    m_offsetBase = captureSec - qpcSec;
+    m_kfTime = qpcSec;
+    m_offset = 0.0;
+    m_drift = 0.0;
+    m_p00 = measVar;
+    m_p01 = 0.0;
+    m_p11 = kInitialDriftVariance;
+    m_kfValid = true;
+    m_consecutiveRejects = 0;
+    m_captureSamples = 1;
+    return;
+  }
+
+  double dt = qpcSec - m_kfTime;
+  if (dt < 0.0) {
+    // Out-of-order sample; the state is already newer.
+    return;
+  }
+
+  // Predict: offset advances by drift, drift is a random walk.
+  const double q = m_config.driftProcessNoise * m_config.driftProcessNoise;
+  double offset = m_offset + m_drift * dt;
+  double p00 = m_p00 + dt * (2.0 * m_p01 + dt * m_p11) + q * dt * dt * dt / 3.0;
+  double p01 = m_p01 + dt * m_p11 + q * dt * dt / 2.0;
+  double p11 = m_p11 + q * dt;
+
+  double z = (captureSec - qpcSec) - m_offsetBase;
+  double innovation = z - offset;
+  double s = p00 + measVar;
+
+  m_kfTime = qpcSec;
+  m_captureSamples++;
+
+  double gate = m_config.offsetGateSigma;
+  if (innovation * innovation > gate * gate * s) {
+    m_captureRejected++;
+    m_offset = offset;
+    m_p00 = p00;
+    m_p01 = p01;
+    m_p11 = p11;
+    if (++m_consecutiveRejects >= m_config.maxConsecutiveRejects) {
+      // The source clock jumped (capture restarted, system time changed).
+      uint64_t rejected = m_captureRejected;
+      ResetCaptureMapping();
+      m_captureRejected = rejected;
+      AddCaptureSample(qpcSec, captureSec);
+    }
+    return;
+  }
+  m_consecutiveRejects = 0;
+
+  double k0 = p00 / s;
+  double k1 = p01 / s;
+  m_offset = offset + k0 * innovation;
+  m_drift = m_drift + k1 * innovation;
+  m_p00 = (1.0 - k0) * p00;
+  m_p01 = (1.0 - k0) * p01;
+  m_p11 = p11 - k1 * p01;
+}
+
+double DisplayClock::CaptureTimeFromQpc(double qpcSec) const {
+  if (!m_kfValid) {
+    return qpcSec;
+  }
+  return qpcSec + m_offsetBase + m_offset + m_drift * (qpcSec - m_kfTime);
+}
+
+double DisplayClock::QpcFromCaptureTime(double captureSec) const {
+  if (!m_kfValid) {
+    return captureSec;
+  }
+  return (captureSec - m_offsetBase - m_offset + m_drift * m_kfTime) / (1.0 + m_drift);
+}
+
+// ----------------------------------------------------------------------------
+// Display PLL
+// ----------------------------------------------------------------------------
+
+void DisplayClock::SetNominalPeriod(double nominalPeriodSec) {
+  if (nominalPeriodSec <= 0.0) {
+    return;
+  }
+  if (m_nominalPeriod > 0.0 &&
+      std::abs(nominalPeriodSec - m_nominalPeriod) < m_nominalPeriod * 0.01) {
+    return;
+  }
+  m_nominalPeriod = nominalPeriodSec;
+  ResetDisplay();
+}
+
+void DisplayClock::AddVblankSample(double qpcSec) {
+  if (m_period <= 0.0) {
+    return;
+  }
+
+  if (!m_phaseValid) {
+    BeginAcquisition(qpcSec);
+    return;
+  }
+
+  double n = std::round((qpcSec - m_phase) / m_period);
+  if (n < 1.0) {
+    // Same vblank reported twice, or a stale sample.
+    return;
+  }
+
+  double predicted = m_phase + n * m_period;
+  double err = qpcSec - predicted;
+
+  if (std::abs(err) > m_config.outlierFraction * m_period) {
+    m_vblankOutliers++;
+    if (++m_consecutiveOutliers >= m_config.maxConsecutiveOutliers) {
+      // Lost lock (mode change, long stall): re-acquire from this sample.
+      uint64_t outliers = m_vblankOutliers;
+      ResetDisplay();
+      m_vblankOutliers = outliers;
+      BeginAcquisition(qpcSec);
+    }
+    return;
+  }
+  m_consecutiveOutliers = 0;
+
+  bool acquiring = m_vblankSamples < static_cast<uint64_t>(m_config.acquireSamples);
+  if (acquiring) {
+    // Straight-line fit of sample time against vblank index. A loop filter
+    // wide enough to pull in a 0.1% nominal error lets jitter straight into
+    // the period; the fit does not.
+    m_acqIndex += n;
+    double x = m_acqIndex;
+    double y = qpcSec - m_acqT0;
+    m_acqSumX += x;
+    m_acqSumY += y;
+    m_acqSumXX += x * x;
+    m_acqSumXY += x * y;
+    // The anchor sample (0, 0) contributes nothing to the sums but counts.
+    double cnt = static_cast<double>(m_vblankSamples) + 1.0;
+    double denom = cnt * m_acqSumXX - m_acqSumX * m_acqSumX;
+    if (cnt >= 4.0 && denom > 0.0) {
+      double slope = (cnt * m_acqSumXY - m_acqSumX * m_acqSumY) / denom;
+      double intercept = (m_acqSumY - slope * m_acqSumX) / cnt;
+      m_period = slope;
+      m_phase = m_acqT0 + intercept + slope * x;
+    } else {
+      m_phase = predicted + 0.5 * err;
+    }
+  } else {
+    m_phase = predicted + m_config.trackKp * err;
+    m_period += m_config.trackKi * err / n;
+  }
+  if (m_nominalPeriod > 0.0) {
+    double maxDev = m_nominalPeriod * m_config.maxPeriodDeviation;
+    m_period = std::clamp(m_period, m_nominalPeriod - maxDev, m_nominalPeriod + maxDev);
+  }
+
+  m_vblankSamples++;
+  m_lastPhaseError = err;
+  if (m_vblankSamples <= 2) {
+    m_meanAbsError = std::abs(err);
+  } else {
+    m_meanAbsError = m_meanAbsError * 0.95 + std::abs(err) * 0.05;
+  }
+
+  // Hysteresis: lock at 1x threshold, drop lock at 2x.
+  double threshold = m_config.lockThreshold * m_period;
+  if (m_locked) {
+    m_locked = m_meanAbsError < threshold * 2.0;
+  } else {
+    m_locked = !acquiring && m_meanAbsError < threshold;
+  }
+}
+
+double DisplayClock::NextVblank(double qpcSec) const {
+  if (!m_phaseValid || m_period <= 0.0) {
+    return qpcSec;
+  }
+  double k = std::ceil((qpcSec - m_phase) / m_period);
+  return m_phase + k * m_period;
+}
+
+double DisplayClock::SnapDeadline(double idealSec, double outputIntervalSec) const {
+  if (!m_locked || m_period <= 0.0 || outputIntervalSec < m_period * 0.98) {
+    return idealSec;
+  }
+  double k = std::round((idealSec - m_phase) / m_period);
+  double lead = std::min(m_config.presentLeadSec, m_period * 0.5);
+  return m_phase + k * m_period - lead;
+}
+
+DisplayClockStats DisplayClock::Stats() const {
+  DisplayClockStats stats;
+  stats.captureMappingValid = m_kfValid;
+  stats.captureOffsetSec = m_offsetBase + m_offset;
+  stats.captureDriftPpm = m_drift * 1e6;
+  stats.captureOffsetSigmaSec = std::sqrt(std::max(m_p00, 0.0));
+  stats.captureDriftSigmaPpm = std::sqrt(std::max(m_p11, 0.0)) * 1e6;
+  stats.captureSamples = m_captureSamples;
+  stats.captureRejected = m_captureRejected;
+  stats.displayLocked = m_locked;
+  stats.displayPeriodSec = m_period;
+  stats.displayPhaseSec = m_phase;
+  stats.lastPhaseErrorSec = m_lastPhaseError;
+  stats.meanAbsPhaseErrorSec = m_meanAbsError;
+  stats.vblankSamples = m_vblankSamples;
+  stats.vblankOutliers = m_vblankOutliers;
+  return stats;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+
+// Clock-domain tracker for output pacing.
+//
+// Two loops share one object:
+//  - A 2-state Kalman filter maps the capture clock (WGC SystemRelativeTime,
+//    hook present time, ...) onto QPC. It estimates offset and drift jointly so
+//    the mapping does not lag behind slow drift the way a fixed IIR does.
+//  - A type-2 PLL locks onto the display's vblank grid from present-completion
+//    timestamps. It estimates period and phase so output deadlines can be placed
+//    on real refresh boundaries instead of free-running at freq / targetFps.
+//
+// All times are seconds in the QPC domain (double). The class has no platform
+// dependencies so it can be driven by the pacing simulator in tools/.
+
+struct DisplayClockConfig {
+  // Capture mapping (Kalman).
+  double offsetMeasNoiseSec = 1.5e-3;   // 1-sigma jitter of a capture sample
+  double driftProcessNoise = 1e-9;      // drift random walk (s/s per sqrt(s))
+  double offsetGateSigma = 6.0;         // reject innovations beyond this
+  int maxConsecutiveRejects = 30;       // re-seed after this many rejects
+
+  // Display PLL.
+  // Acquisition fits phase and period by least squares over the first
+  // acquireSamples vblanks, then hands over to the narrow tracking loop.
+  double trackKp = 0.05;
+  double trackKi = 0.0005;
+  int acquireSamples = 120;
+  double lockThreshold = 0.2;           // mean |phase err| / period to lock
+  double outlierFraction = 0.35;        // |err| / period treated as outlier
+  int maxConsecutiveOutliers = 8;       // re-seed phase after this many
+  double maxPeriodDeviation = 0.05;     // clamp period to nominal +/- 5%
+  double presentLeadSec = 1.5e-3;       // issue snapped presents this early
+};
+
+struct DisplayClockStats {
+  bool captureMappingValid = false;
+  double captureOffsetSec = 0.0;        // capture - qpc at the last sample
+  double captureDriftPpm = 0.0;
+  double captureDriftSigmaPpm = 0.0;
+  double captureOffsetSigmaSec = 0.0;
+  uint64_t captureSamples = 0;
+  uint64_t captureRejected = 0;
+
+  bool displayLocked = false;
+  double displayPeriodSec = 0.0;
+  double displayPhaseSec = 0.0;         // qpc time of the last tracked vblank
+  double lastPhaseErrorSec = 0.0;
+  double meanAbsPhaseErrorSec = 0.0;
+  uint64_t vblankSamples = 0;
+  uint64_t vblankOutliers = 0;
+};
+
+class DisplayClock {
+public:
+  DisplayClock() = default;
+  explicit DisplayClock(const DisplayClockConfig& config) : m_config(config) {}
+
+  void SetConfig(const DisplayClockConfig& config) { m_config = config; }
+  const DisplayClockConfig& Config() const { return m_config; }
+
+  void Reset();
+  void ResetCaptureMapping();
+  void ResetDisplay();
+
+  // Capture clock mapping. captureSec is the capture clock converted to
+  // seconds; qpcSec is the QPC time at which that sample was observed.
+  void AddCaptureSample(double qpcSec, double captureSec);
+  bool HasCaptureMapping() const { return m_kfValid; }
+  double CaptureTimeFromQpc(double qpcSec) const;
+  // Inverse of CaptureTimeFromQpc.
+  double QpcFromCaptureTime(double captureSec) const;
+
+  // Display PLL. nominalPeriodSec seeds (and bounds) the period estimate; a
+  // change of more than 1% re-seeds the loop.
+  void SetNominalPeriod(double nominalPeriodSec);
+  void AddVblankSample(double qpcSec);
+  bool IsDisplayLocked() const { return m_locked; }
+  double DisplayPeriod() const { return m_period; }
+
+  // Predicted vblank time at or after qpcSec (qpcSec itself if unlocked).
+  double NextVblank(double qpcSec) const;
+
+  // Snaps an ideal output deadline to the vblank grid. Only applies when the
+  // PLL is locked and the output interval spans at least one refresh;
+  // otherwise the ideal deadline is returned unchanged.
+  double SnapDeadline(double idealSec, double outputIntervalSec) const;
+
+  DisplayClockStats Stats() const;
+
+private:
+  void BeginAcquisition(double qpcSec);
+
+  DisplayClockConfig m_config;
+
+  // Kalman state: offset relative to m_offsetBase, and drift (s/s), valid at
+  // m_kfTime (qpc seconds).
+  bool m_kfValid = false;
+  double m_offsetBase = 0.0;
+  double m_kfTime = 0.0;
+  double m_offset = 0.0;
+  double m_drift = 0.0;
+  double m_p00 = 0.0;
+  double m_p01 = 0.0;
+  double m_p11 = 0.0;
+  int m_consecutiveRejects = 0;
+  uint64_t m_captureSamples = 0;
+  uint64_t m_captureRejected = 0;
+
+  // PLL state.
+  double m_nominalPeriod = 0.0;
+  double m_period = 0.0;
+  double m_phase = 0.0;
+  bool m_phaseValid = false;
+  bool m_locked = false;
+  double m_lastPhaseError = 0.0;
+  double m_meanAbsError = 0.0;
+  int m_consecutiveOutliers = 0;
+
+  // Acquisition regression over (vblank index, time since first sample).
+  double m_acqT0 = 0.0;
+  double m_acqIndex = 0.0;
+  double m_acqSumX = 0.0;
+  double m_acqSumY = 0.0;
+  double m_acqSumXX = 0.0;
+  double m_acqSumXY = 0.0;
+  uint64_t m_vblankSamples = 0;
+  uint64_t m_vblankOutliers = 0;
+};
@@ -282,6 +282,16 @@ bool DupCapture::AcquireNextFrame(CapturedFrame& frame) {
             } else {
               frame.systemTime100ns = 0;
             }
+            // LastPresentTime is 0 for pointer-only updates; AccumulatedFrames
+            // counts presents folded into this one since the last acquire.
+            m_frameSequence += (std::max)(frameInfo.AccumulatedFrames, 1u);
+            frame.sequence = m_frameSequence;
+            frame.framesSkipped = frameInfo.AccumulatedFrames > 1 ? frameInfo.AccumulatedFrames - 1 : 0;
+            if (frameInfo.LastPresentTime.QuadPart > 0 && m_qpcFreq.QuadPart > 0) {
+              frame.presentTime100ns = static_cast<int64_t>(
+                  static_cast<double>(frameInfo.LastPresentTime.QuadPart) *
+                  (1e7 / static_cast<double>(m_qpcFreq.QuadPart)));
+            }
             success = true;
           }
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "capture_frame.h"
+#include "capture_source.h"
 
 #include <d3d11.h>
 #include <dxgi1_2.h>
@@ -9,16 +10,24 @@
 #include <windows.h>
 #include <wrl/client.h>
 
-class DupCapture {
+class DupCapture : public ICaptureSource {
 public:
   bool Initialize(ID3D11Device* device);
   void Shutdown();
 
   bool StartCapture(HWND hwnd, Microsoft::WRL::ComPtr<IDXGIOutput> output, const RECT& outputRect);
-  void StopCapture();
+  void StopCapture() override;
 
   bool AcquireNextFrame(CapturedFrame& frame);
-  bool IsCapturing() const { return m_isCapturing; }
+  bool IsCapturing() const override { return m_isCapturing; }
+
+  // ICaptureSource
+  const char* SourceName() const override { return "DXGI"; }
+  bool AcquireFrame(SourceFrame& frame) override {
+    frame.onGpu = true;
+    return AcquireNextFrame(frame.gpu);
+  }
+  bool RetryOnMiss() const override { return m_spinWaitMode; }
 
   // Configuration (Mirroring WGC features)
   void SetPollingMode(bool enabled) { m_pollingMode = enabled; }
@@ -51,6 +60,7 @@ private:
   int m_spinWaitMs = 10;            // 10ms wait for high-FPS capture (180fps = 5.5ms per frame)
 
   LARGE_INTEGER m_qpcFreq = {};
+  uint64_t m_frameSequence = 0;     // desktop presents seen (AccumulatedFrames)
   
   // DPI cache
   UINT m_dpiX = 96;
@@ -0,0 +1,211 @@
+#include "flow_io.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+constexpr int kMaxFloSize = 32768;
+
+bool IsUnknown(float u, float v) {
+  return !(std::fabs(u) <= kFlowUnknown) || !(std::fabs(v) <= kFlowUnknown);
+}
+
+struct FileCloser {
+  void operator()(FILE* f) const {
+    if (f) {
+      std::fclose(f);
+    }
+  }
+};
+
+void SetError(std::string* error, const char* message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Per-region accumulation
+// ----------------------------------------------------------------------------
+struct RegionSums {
+  uint64_t pixels = 0;
+  double epe = 0.0;
+  uint64_t outliers = 0;
+  uint64_t within1 = 0;
+
+  void Add(double epe, double truthMagnitude) {
+    ++pixels;
+    this->epe += epe;
+    if (epe > 3.0 && epe > 0.05 * truthMagnitude) {
+      ++outliers;
+    }
+    if (epe < 1.0) {
+      ++within1;
+    }
+  }
+
+  FlowRegionError Finish() const {
+    FlowRegionError r;
+    r.pixels = pixels;
+    if (pixels > 0) {
+      r.aee = epe / static_cast<double>(pixels);
+      r.outliers = 100.0 * static_cast<double>(outliers) / static_cast<double>(pixels);
+      r.within1 = 100.0 * static_cast<double>(within1) / static_cast<double>(pixels);
+    }
+    return r;
+  }
+};
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+// .flo read / write
+// ----------------------------------------------------------------------------
+bool WriteFlo(const std::string& path, const FlowField& flow) {
+  if (flow.Empty() || flow.uv.size() != static_cast<size_t>(flow.width) * flow.height * 2) {
+    return false;
+  }
+  std::unique_ptr<FILE, FileCloser> file(std::fopen(path.c_str(), "wb"));
+  if (!file) {
+    return false;
+  }
+  const float magic = kFloMagic;
+  const int32_t size[2] = {flow.width, flow.height};
+  bool ok = std::fwrite(&magic, sizeof(magic), 1, file.get()) == 1 &&
+            std::fwrite(size, sizeof(size), 1, file.get()) == 1 &&
+            std::fwrite(flow.uv.data(), sizeof(float), flow.uv.size(), file.get()) == flow.uv.size();
+  ok = (std::fflush(file.get()) == 0) && ok;
+  return ok;
+}
+
+bool ReadFlo(const std::string& path, FlowField& flow, std::string* error) {
+  std::unique_ptr<FILE, FileCloser> file(std::fopen(path.c_str(), "rb"));
+  if (!file) {
+    SetError(error, "cannot open file");
+    return false;
+  }
+  float magic = 0.0f;
+  int32_t size[2] = {0, 0};
+  if (std::fread(&magic, sizeof(magic), 1, file.get()) != 1 || std::fread(size, sizeof(size), 1, file.get()) != 1) {
+    SetError(error, "truncated header");
+    return false;
+  }
+  if (magic != kFloMagic) {
+    SetError(error, "not a .flo file (bad magic)");
+    return false;
+  }
+  if (size[0] <= 0 || size[1] <= 0 || size[0] > kMaxFloSize || size[1] > kMaxFloSize) {
+    SetError(error, "invalid size");
+    return false;
+  }
+  flow.Resize(size[0], size[1]);
+  if (std::fread(flow.uv.data(), sizeof(float), flow.uv.size(), file.get()) != flow.uv.size()) {
+    SetError(error, "truncated flow data");
+    flow = FlowField();
+    return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// Resampling
+// ----------------------------------------------------------------------------
+void ResampleFlow(const FlowField& in, int width, int height, FlowField& out) {
+  out.Resize(width, height);
+  if (in.Empty() || width <= 0 || height <= 0) {
+    return;
+  }
+  const float rx = static_cast<float>(in.width) / static_cast<float>(width);
+  const float ry = static_cast<float>(in.height) / static_cast<float>(height);
+  const float scaleU = 1.0f / rx;
+  const float scaleV = 1.0f / ry;
+  for (int y = 0; y < height; ++y) {
+    const float sy = std::clamp((y + 0.5f) * ry - 0.5f, 0.0f, static_cast<float>(in.height - 1));
+    const int y0 = static_cast<int>(sy);
+    const int y1 = std::min(y0 + 1, in.height - 1);
+    const float fy = sy - y0;
+    float* dst = &out.uv[static_cast<size_t>(y) * width * 2];
+    for (int x = 0; x < width; ++x) {
+      const float sx = std::clamp((x + 0.5f) * rx - 0.5f, 0.0f, static_cast<float>(in.width - 1));
+      const int x0 = static_cast<int>(sx);
+      const int x1 = std::min(x0 + 1, in.width - 1);
+      const float fx = sx - x0;
+      const float* t00 = &in.uv[(static_cast<size_t>(y0) * in.width + x0) * 2];
+      const float* t01 = &in.uv[(static_cast<size_t>(y0) * in.width + x1) * 2];
+      const float* t10 = &in.uv[(static_cast<size_t>(y1) * in.width + x0) * 2];
+      const float* t11 = &in.uv[(static_cast<size_t>(y1) * in.width + x1) * 2];
+      if (IsUnknown(t00[0], t00[1]) || IsUnknown(t01[0], t01[1]) || IsUnknown(t10[0], t10[1]) ||
+          IsUnknown(t11[0], t11[1])) {
+        dst[x * 2 + 0] = kFlowUnknown * 10.0f;
+        dst[x * 2 + 1] = kFlowUnknown * 10.0f;
+        continue;
+      }
+      for (int c = 0; c < 2; ++c) {
+        const float top = t00[c] + (t01[c] - t00[c]) * fx;
+        const float bottom = t10[c] + (t11[c] - t10[c]) * fx;
+        dst[x * 2 + c] = (top + (bottom - top) * fy) * (c == 0 ? scaleU : scaleV);
+      }
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Evaluation
+// ----------------------------------------------------------------------------
+bool EvaluateFlow(const FlowField& estimate, const FlowField& truth, const std::vector<uint8_t>* occlusion,
+                  FlowErrorStats& stats) {
+  stats = FlowErrorStats();
+  if (estimate.Empty() || truth.Empty()) {
+    return false;
+  }
+  const size_t pixels = static_cast<size_t>(truth.width) * truth.height;
+  if (occlusion && occlusion->size() != pixels) {
+    return false;
+  }
+  FlowField resampled;
+  const FlowField* est = &estimate;
+  if (estimate.width != truth.width || estimate.height != truth.height) {
+    ResampleFlow(estimate, truth.width, truth.height, resampled);
+    est = &resampled;
+  }
+
+  RegionSums all;
+  RegionSums occluded;
+  RegionSums nonOccluded;
+  double magnitudeSum = 0.0;
+  for (size_t i = 0; i < pixels; ++i) {
+    const float tu = truth.uv[i * 2 + 0];
+    const float tv = truth.uv[i * 2 + 1];
+    if (IsUnknown(tu, tv)) {
+      continue;
+    }
+    float eu = est->uv[i * 2 + 0];
+    float ev = est->uv[i * 2 + 1];
+    if (IsUnknown(eu, ev)) {
+      // No estimate counts as zero motion, as the Middlebury scorer does.
+      eu = 0.0f;
+      ev = 0.0f;
+    }
+    const double du = static_cast<double>(eu) - tu;
+    const double dv = static_cast<double>(ev) - tv;
+    const double epe = std::sqrt(du * du + dv * dv);
+    const double magnitude = std::sqrt(static_cast<double>(tu) * tu + static_cast<double>(tv) * tv);
+    all.Add(epe, magnitude);
+    if (occlusion) {
+      ((*occlusion)[i] ? occluded : nonOccluded).Add(epe, magnitude);
+    }
+    magnitudeSum += magnitude;
+    stats.maxEpe = std::max(stats.maxEpe, epe);
+  }
+
+  stats.all = all.Finish();
+  stats.occluded = occluded.Finish();
+  stats.nonOccluded = occlusion ? nonOccluded.Finish() : stats.all;
+  if (all.pixels > 0) {
+    stats.meanTruthMagnitude = magnitudeSum / static_cast<double>(all.pixels);
+  }
+  return all.pixels > 0;
+}
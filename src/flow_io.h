@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Optical flow fields in Middlebury .flo format, and endpoint-error scoring
+// against ground truth.
+//
+// .flo layout (little endian): float 202021.25 ("PIEH"), int32 width,
+// int32 height, then width * height (u, v) float pairs, row-major. u is
+// +x, v is +y, in pixels of the field's own resolution. Components above
+// kFlowUnknown mark pixels without ground truth.
+//
+// Interpolator's motion textures hold vectors in texels of their pyramid
+// level, so an eighth-res field is exported at eighth-res size with eighth-
+// res vectors; ResampleFlow brings it to the ground truth's resolution.
+
+constexpr float kFloMagic = 202021.25f;
+constexpr float kFlowUnknown = 1e9f;
+
+struct FlowField {
+  int width = 0;
+  int height = 0;
+  std::vector<float> uv;    // 2 * width * height
+
+  void Resize(int w, int h) {
+    width = w;
+    height = h;
+    uv.assign(static_cast<size_t>(w) * h * 2, 0.0f);
+  }
+  bool Empty() const { return width <= 0 || height <= 0; }
+};
+
+bool WriteFlo(const std::string& path, const FlowField& flow);
+// Rejects a wrong magic, sizes over 32768 and truncated files.
+bool ReadFlo(const std::string& path, FlowField& flow, std::string* error = nullptr);
+
+// Bilinear resample to width x height with the vectors scaled by the
+// resolution ratio per axis. Unknown texels stay unknown if any tap is.
+void ResampleFlow(const FlowField& in, int width, int height, FlowField& out);
+
+// Scores over one region (all, occluded or non-occluded pixels).
+struct FlowRegionError {
+  uint64_t pixels = 0;
+  double aee = 0.0;         // average endpoint error, px
+  double outliers = 0.0;    // % with EPE > 3 px and > 5% of |truth| (KITTI Fl)
+  double within1 = 0.0;     // % with EPE < 1 px
+};
+
+struct FlowErrorStats {
+  FlowRegionError all;
+  FlowRegionError occluded;       // empty without an occlusion mask
+  FlowRegionError nonOccluded;
+  double maxEpe = 0.0;
+  double meanTruthMagnitude = 0.0;
+};
+
+// Scores estimate against truth at the truth's resolution (estimate is
+// resampled first if sizes differ). occlusion is optional: width * height
+// bytes of the truth, non-zero where the pixel has no match in the next
+// frame. Pixels with unknown truth are skipped. Fails on empty input or a
+// mask of the wrong size.
+bool EvaluateFlow(const FlowField& estimate, const FlowField& truth, const std::vector<uint8_t>* occlusion,
+                  FlowErrorStats& stats);
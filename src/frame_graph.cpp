@@ -0,0 +1,431 @@
+#include "frame_graph.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+using S = PipelineStage;
+
+double MiB(uint64_t bytes) {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+bool Overlaps(const FrameResourceDesc& a, const FrameResourceDesc& b) {
+  return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+}
+
+bool Contains(const std::vector<int>& list, int value) {
+  return std::find(list.begin(), list.end(), value) != list.end();
+}
+
+// Dispatches of the Interpolator, from interpolator.cpp. Names are resource
+// table entries, separated by spaces. The pyramid's quarter and eighth
+// dispatches are separate passes: the second reads what the first wrote.
+struct PassEntry {
+  const char* name;
+  S stage;
+  const char* reads;
+  const char* writes;
+};
+
+constexpr PassEntry kMotionPasses[] = {
+    {"Downsample", S::Downsample, "",
+     "prevLuma prevFeature2 prevFeature3 currLuma currFeature2 currFeature3"},
+    {"Pyramid 1/4", S::Pyramid, "prevLuma prevFeature2 prevFeature3 currLuma currFeature2 currFeature3",
+     "prevLumaSmall prevFeature2Small prevFeature3Small currLumaSmall currFeature2Small currFeature3Small"},
+    {"Pyramid 1/8", S::Pyramid,
+     "prevLumaSmall prevFeature2Small prevFeature3Small currLumaSmall currFeature2Small currFeature3Small",
+     "prevLumaTiny prevFeature2Tiny prevFeature3Tiny currLumaTiny currFeature2Tiny currFeature3Tiny"},
+    {"Motion forward", S::MotionForward, "currLumaTiny prevLumaTiny", "motionTiny confidenceTiny"},
+    {"Motion backward", S::MotionBackward, "prevLumaTiny currLumaTiny", "motionTinyBackward confidenceTinyBackward"},
+};
+
+constexpr PassEntry kMinimalPasses[] = {
+    {"Interpolate", S::Interpolate,
+     "motionTiny confidenceTiny motionTinyBackward confidenceTinyBackward "
+     "prevLuma currLuma prevFeature2 currFeature2 prevFeature3 currFeature3",
+     "outputTexture"},
+};
+
+// The attention priors are updated in place: read and written.
+constexpr PassEntry kFullPasses[] = {
+    {"Refine 1/4", S::RefineQuarter,
+     "currLumaSmall prevLumaSmall currFeature2Small prevFeature2Small currFeature3Small prevFeature3Small "
+     "motionTiny confidenceTiny motionTinyBackward confidenceTinyBackward attnSmall1 attnSmall2 attnSmall3",
+     "motionCoarse confidenceCoarse attnSmall1 attnSmall2 attnSmall3"},
+    {"Refine 1/2", S::RefineHalf,
+     "currLuma prevLuma currFeature2 prevFeature2 currFeature3 prevFeature3 "
+     "motionCoarse confidenceCoarse motionTinyBackward confidenceTinyBackward attnFull1 attnFull2 attnFull3",
+     "motion confidence attnFull1 attnFull2 attnFull3"},
+    {"Smooth", S::Smooth, "motion confidence currLuma", "motionSmooth confidenceSmooth"},
+    {"Interpolate", S::Interpolate,
+     "motionSmooth confidenceSmooth prevLuma currLuma prevFeature2 currFeature2 prevFeature3 currFeature3",
+     "outputTexture"},
+};
+
+// VulkanFullDispatch: the D3D11 inputs are copied into the shared images,
+// the rest runs on the Vulkan queue.
+constexpr PassEntry kVulkanPasses[] = {
+    {"Copy in", S::VkCopyIn, "", "vk.sharedPrev vk.sharedCurr"},
+    {"Downsample", S::VkDownsample, "vk.sharedPrev vk.sharedCurr", "vk.featPrev vk.featCurr"},
+    {"Cost volume", S::VkCostVolume, "vk.featPrev vk.featCurr", "vk.costVol"},
+    {"Flow decoder", S::VkFlowDecoder, "vk.costVol vk.featPrev vk.featCurr", "vk.flowOut vk.confOut"},
+    {"Interpolate", S::VkInterpolate, "vk.sharedPrev vk.sharedCurr vk.flowOut vk.confOut vk.featPrev vk.featCurr",
+     "vk.sharedOutput"},
+};
+
+// Resolves a resource of the table, declaring it on first use.
+int DeclareResource(FrameGraph& graph, const ResourceRegistry& registry, const std::string& name) {
+  const int existing = graph.FindResource(name);
+  if (existing >= 0) {
+    return existing;
+  }
+  for (const ResourceRecord& record : registry.Records()) {
+    if (record.name == name) {
+      const bool transient = record.Use(registry.MinimalPipeline()).lifetime == ResourceLifetime::Transient;
+      return graph.AddResource(name, record.width, record.height, record.format, transient, record.bytes);
+    }
+  }
+  return -1;
+}
+
+bool AddPasses(FrameGraph& graph, const ResourceRegistry& registry, const PassEntry* passes, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const int pass = graph.AddPass(passes[i].name, passes[i].stage);
+    for (int access = 0; access < 2; ++access) {
+      std::istringstream names(access == 0 ? passes[i].reads : passes[i].writes);
+      std::string name;
+      while (names >> name) {
+        const int resource = DeclareResource(graph, registry, name);
+        if (resource < 0) {
+          return false;
+        }
+        if (access == 0) {
+          graph.Read(pass, resource);
+        } else {
+          graph.Write(pass, resource);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+const char* FrameResourceStateName(FrameResourceState state) {
+  switch (state) {
+    case FrameResourceState::Undefined:
+      return "undefined";
+    case FrameResourceState::ShaderRead:
+      return "read";
+    case FrameResourceState::ShaderWrite:
+      return "write";
+  }
+  return "?";
+}
+
+// ----------------------------------------------------------------------------
+// FrameGraph
+// ----------------------------------------------------------------------------
+void FrameGraph::Clear() {
+  m_resources.clear();
+  m_passes.clear();
+  m_slotBytes.clear();
+  m_compiled = false;
+  m_lastError.clear();
+}
+
+int FrameGraph::AddResource(const std::string& name, int width, int height, ResourceFormat format, bool transient,
+                            uint64_t bytes) {
+  const int existing = FindResource(name);
+  if (existing >= 0) {
+    return existing;
+  }
+  FrameResourceDesc desc;
+  desc.name = name;
+  desc.width = width;
+  desc.height = height;
+  desc.format = format;
+  desc.bytes = bytes != 0 ? bytes
+                          : static_cast<uint64_t>(std::max(width, 0)) * static_cast<uint64_t>(std::max(height, 0)) *
+                                ResourceFormatBytes(format);
+  desc.transient = transient;
+  m_resources.push_back(std::move(desc));
+  m_compiled = false;
+  return static_cast<int>(m_resources.size()) - 1;
+}
+
+int FrameGraph::FindResource(const std::string& name) const {
+  for (size_t i = 0; i < m_resources.size(); ++i) {
+    if (m_resources[i].name == name) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+int FrameGraph::AddPass(const std::string& name, PipelineStage stage) {
+  FramePass pass;
+  pass.name = name;
+  pass.stage = stage;
+  m_passes.push_back(std::move(pass));
+  m_compiled = false;
+  return static_cast<int>(m_passes.size()) - 1;
+}
+
+void FrameGraph::Read(int pass, int resource) {
+  if (pass >= 0 && pass < static_cast<int>(m_passes.size()) && !Contains(m_passes[pass].reads, resource)) {
+    m_passes[pass].reads.push_back(resource);
+    m_compiled = false;
+  }
+}
+
+void FrameGraph::Write(int pass, int resource) {
+  if (pass >= 0 && pass < static_cast<int>(m_passes.size()) && !Contains(m_passes[pass].writes, resource)) {
+    m_passes[pass].writes.push_back(resource);
+    m_compiled = false;
+  }
+}
+
+bool FrameGraph::Fail(const std::string& message) {
+  m_lastError = message;
+  m_compiled = false;
+  return false;
+}
+
+bool FrameGraph::Compile() {
+  m_compiled = false;
+  m_lastError.clear();
+  m_slotBytes.clear();
+  for (FrameResourceDesc& resource : m_resources) {
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    resource.slot = -1;
+  }
+
+  const int resourceCount = static_cast<int>(m_resources.size());
+  std::vector<bool> written(m_resources.size(), false);
+  for (int p = 0; p < static_cast<int>(m_passes.size()); ++p) {
+    FramePass& pass = m_passes[p];
+    pass.barriers.clear();
+    pass.acquire.clear();
+    pass.release.clear();
+    for (const std::vector<int>* list : {&pass.reads, &pass.writes}) {
+      for (int r : *list) {
+        if (r < 0 || r >= resourceCount) {
+          return Fail("pass " + pass.name + " uses an unknown resource");
+        }
+        FrameResourceDesc& resource = m_resources[r];
+        if (resource.firstPass < 0) {
+          resource.firstPass = p;
+        }
+        resource.lastPass = p;
+      }
+    }
+    for (int r : pass.reads) {
+      if (m_resources[r].transient && !written[r]) {
+        return Fail("pass " + pass.name + " reads transient " + m_resources[r].name + " before it is written");
+      }
+    }
+    for (int r : pass.writes) {
+      written[r] = true;
+    }
+  }
+
+  AssignSlots();
+  DeriveBarriers();
+  m_compiled = true;
+  return true;
+}
+
+void FrameGraph::AssignSlots() {
+  std::vector<int> order;
+  for (int r = 0; r < static_cast<int>(m_resources.size()); ++r) {
+    if (m_resources[r].transient && m_resources[r].firstPass >= 0) {
+      order.push_back(r);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return m_resources[a].bytes > m_resources[b].bytes; });
+
+  std::vector<std::vector<int>> residents;
+  for (int r : order) {
+    FrameResourceDesc& resource = m_resources[r];
+    int slot = 0;
+    for (; slot < static_cast<int>(residents.size()); ++slot) {
+      const bool free = std::none_of(residents[slot].begin(), residents[slot].end(),
+                                     [&](int other) { return Overlaps(resource, m_resources[other]); });
+      if (free) {
+        break;
+      }
+    }
+    if (slot == static_cast<int>(residents.size())) {
+      residents.emplace_back();
+      m_slotBytes.push_back(resource.bytes);    // largest first: the slot never grows
+    }
+    residents[slot].push_back(r);
+    resource.slot = slot;
+    m_passes[resource.firstPass].acquire.push_back(r);
+    m_passes[resource.lastPass].release.push_back(r);
+  }
+}
+
+void FrameGraph::DeriveBarriers() {
+  // Persistent resources enter the frame in the state the previous frame
+  // left them in; transients start without contents.
+  std::vector<FrameResourceState> state(m_resources.size(), FrameResourceState::Undefined);
+  for (const FramePass& pass : m_passes) {
+    for (int r : pass.reads) {
+      if (!m_resources[r].transient) {
+        state[r] = FrameResourceState::ShaderRead;
+      }
+    }
+    for (int r : pass.writes) {
+      if (!m_resources[r].transient) {
+        state[r] = FrameResourceState::ShaderWrite;
+      }
+    }
+  }
+
+  std::vector<int> slotOwner(m_slotBytes.size(), -1);
+  for (int p = 0; p < static_cast<int>(m_passes.size()); ++p) {
+    FramePass& pass = m_passes[p];
+    auto transition = [&](int r, FrameResourceState after) {
+      FrameBarrier barrier;
+      barrier.resource = r;
+      barrier.before = state[r];
+      barrier.after = after;
+      const FrameResourceDesc& resource = m_resources[r];
+      if (resource.slot >= 0 && resource.firstPass == p) {
+        barrier.before = FrameResourceState::Undefined;
+        barrier.aliased = slotOwner[resource.slot];
+        slotOwner[resource.slot] = r;
+      }
+      // Read -> read needs nothing; a write after a write still needs a
+      // UAV barrier so the second pass sees the first one's results.
+      if (barrier.before != after || after == FrameResourceState::ShaderWrite) {
+        pass.barriers.push_back(barrier);
+      }
+      state[r] = after;
+    };
+    for (int r : pass.writes) {
+      transition(r, FrameResourceState::ShaderWrite);
+    }
+    for (int r : pass.reads) {
+      if (!Contains(pass.writes, r)) {
+        transition(r, FrameResourceState::ShaderRead);
+      }
+    }
+  }
+}
+
+FrameGraphMemory FrameGraph::Memory() const {
+  FrameGraphMemory memory;
+  memory.slots = static_cast<int>(m_slotBytes.size());
+  for (const FrameResourceDesc& resource : m_resources) {
+    if (resource.firstPass < 0) {
+      continue;
+    }
+    ++memory.resources;
+    memory.dedicatedBytes += resource.bytes;
+    if (resource.transient) {
+      ++memory.transientResources;
+    } else {
+      memory.persistentBytes += resource.bytes;
+    }
+  }
+  memory.aliasedBytes = memory.persistentBytes;
+  for (uint64_t bytes : m_slotBytes) {
+    memory.aliasedBytes += bytes;
+  }
+  for (int p = 0; p < static_cast<int>(m_passes.size()); ++p) {
+    memory.barriers += static_cast<int>(m_passes[p].barriers.size());
+    uint64_t live = memory.persistentBytes;
+    for (const FrameResourceDesc& resource : m_resources) {
+      if (resource.transient && resource.firstPass <= p && p <= resource.lastPass && resource.firstPass >= 0) {
+        live += resource.bytes;
+      }
+    }
+    if (live > memory.peakLiveBytes) {
+      memory.peakLiveBytes = live;
+      memory.peakPass = p;
+    }
+  }
+  return memory;
+}
+
+// ----------------------------------------------------------------------------
+// Interpolator graph and reports
+// ----------------------------------------------------------------------------
+bool PlanInterpolatorFrameGraph(int inputWidth, int inputHeight, int outputWidth, int outputHeight,
+                                bool minimalPipeline, bool vulkan, FrameGraph& graph) {
+  graph.Clear();
+  const bool vulkanPath = vulkan && !minimalPipeline;
+  ResourceRegistry registry;
+  PlanInterpolatorResources(inputWidth, inputHeight, outputWidth, outputHeight, minimalPipeline, vulkanPath, 0,
+                            registry);
+  bool declared = true;
+  if (vulkanPath) {
+    declared = AddPasses(graph, registry, kVulkanPasses, std::size(kVulkanPasses));
+  } else {
+    declared = AddPasses(graph, registry, kMotionPasses, std::size(kMotionPasses)) &&
+               (minimalPipeline ? AddPasses(graph, registry, kMinimalPasses, std::size(kMinimalPasses))
+                                : AddPasses(graph, registry, kFullPasses, std::size(kFullPasses)));
+  }
+  return declared && graph.Compile();
+}
+
+std::string FormatFrameGraphReport(const FrameGraph& graph) {
+  const FrameGraphMemory memory = graph.Memory();
+  const auto& resources = graph.Resources();
+  const auto& passes = graph.Passes();
+  std::string out;
+  char line[256];
+  std::snprintf(line, sizeof(line), "Frame graph: %d passes, %d resources (%d transient), %d barriers\n",
+                static_cast<int>(passes.size()), memory.resources, memory.transientResources, memory.barriers);
+  out += line;
+  std::snprintf(line, sizeof(line), "  peak before aliasing %9.2f MiB\n", MiB(memory.dedicatedBytes));
+  out += line;
+  std::snprintf(line, sizeof(line), "  peak after aliasing  %9.2f MiB  (%d slots; live peak %.2f MiB in %s)\n",
+                MiB(memory.aliasedBytes), memory.slots, MiB(memory.peakLiveBytes),
+                memory.peakPass >= 0 ? passes[memory.peakPass].name.c_str() : "-");
+  out += line;
+  for (int slot = 0; slot < static_cast<int>(graph.SlotBytes().size()); ++slot) {
+    std::string residents;
+    for (const FrameResourceDesc& resource : resources) {
+      if (resource.slot == slot) {
+        residents += (residents.empty() ? "" : ", ") + resource.name + " [" + std::to_string(resource.firstPass) +
+                     "-" + std::to_string(resource.lastPass) + "]";
+      }
+    }
+    std::snprintf(line, sizeof(line), "  slot %-2d %9.2f MiB  ", slot, MiB(graph.SlotBytes()[slot]));
+    out += line + residents + "\n";
+  }
+  for (int p = 0; p < static_cast<int>(passes.size()); ++p) {
+    const FramePass& pass = passes[p];
+    std::snprintf(line, sizeof(line), "  [%d] %-16s %-15s %d barriers\n", p, pass.name.c_str(),
+                  PipelineStageName(pass.stage), static_cast<int>(pass.barriers.size()));
+    out += line;
+    for (const FrameBarrier& barrier : pass.barriers) {
+      std::snprintf(line, sizeof(line), "        %-34s %-9s -> %-5s", resources[barrier.resource].name.c_str(),
+                    FrameResourceStateName(barrier.before), FrameResourceStateName(barrier.after));
+      out += line;
+      if (barrier.aliased >= 0) {
+        out += "  (aliases " + resources[barrier.aliased].name + ")";
+      }
+      out += "\n";
+    }
+    if (!pass.release.empty()) {
+      std::string released;
+      for (int r : pass.release) {
+        released += (released.empty() ? "" : ", ") + resources[r].name;
+      }
+      out += "        released: " + released + "\n";
+    }
+  }
+  return out;
+}
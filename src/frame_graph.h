@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "resource_registry.h"
+#include "stage_timer.h"
+
+// Compute frame graph: the passes of one frame, in execution order, with the
+// textures each reads and writes.
+//
+// Compile() turns the declarations into what a backend needs to run them:
+//
+//  - lifetimes: the first and last pass touching each resource,
+//  - barriers: before each pass, the state transitions its accesses need
+//    (write -> read, read -> write, write -> write on the same resource, and
+//    the first use of memory another resource held before),
+//  - aliasing: transient resources, whose contents are dead after their last
+//    pass, are packed into shared memory slots so that resources with
+//    disjoint lifetimes use the same bytes.
+//
+// Persistent resources (pairs kept for re-warps, state carried across
+// frames) get dedicated memory; their state at the start of a frame is the
+// state they were left in at the end of the previous one.
+//
+// Slots are assigned greedily, largest resource first, to the first slot
+// none of whose residents overlaps it, so a slot is as large as its first
+// resident. The graph is backend neutral: ReferenceInterpolator swaps its
+// plane storage through the slots, and the D3D11 Interpolator, which has no
+// placed resources, uses the plan for accounting only.
+
+enum class FrameResourceState : uint8_t {
+  Undefined,          // no contents: first use in a frame or memory just aliased
+  ShaderRead,         // SRV / sampled image
+  ShaderWrite,        // UAV / storage image
+};
+
+const char* FrameResourceStateName(FrameResourceState state);
+
+struct FrameResourceDesc {
+  std::string name;
+  int width = 0;
+  int height = 0;
+  ResourceFormat format = ResourceFormat::Rgba16Float;
+  uint64_t bytes = 0;
+  bool transient = true;            // may share memory outside its lifetime
+
+  // Filled by Compile().
+  int firstPass = -1;               // -1: no pass touches it
+  int lastPass = -1;
+  int slot = -1;                    // alias slot, -1 for dedicated memory
+};
+
+struct FrameBarrier {
+  int resource = -1;
+  FrameResourceState before = FrameResourceState::Undefined;
+  FrameResourceState after = FrameResourceState::Undefined;
+  int aliased = -1;                 // resource that held the slot before, or -1
+};
+
+struct FramePass {
+  std::string name;
+  PipelineStage stage = PipelineStage::Execute;
+  std::vector<int> reads;
+  std::vector<int> writes;
+
+  // Filled by Compile().
+  std::vector<FrameBarrier> barriers;   // issue before the pass
+  std::vector<int> acquire;             // transients whose lifetime starts here
+  std::vector<int> release;             // transients dead after this pass
+};
+
+struct FrameGraphMemory {
+  int resources = 0;                // touched by some pass
+  int transientResources = 0;
+  int slots = 0;
+  int barriers = 0;
+  uint64_t dedicatedBytes = 0;      // every resource in its own memory
+  uint64_t aliasedBytes = 0;        // persistent resources + slots
+  uint64_t persistentBytes = 0;
+  uint64_t peakLiveBytes = 0;       // largest sum of live resources in one pass
+  int peakPass = -1;
+};
+
+class FrameGraph {
+public:
+  void Clear();
+
+  // bytes = 0 estimates from the size and format. Names are unique.
+  int AddResource(const std::string& name, int width, int height, ResourceFormat format, bool transient,
+                  uint64_t bytes = 0);
+  int FindResource(const std::string& name) const;
+
+  // Passes execute in the order they are added.
+  int AddPass(const std::string& name, PipelineStage stage);
+  // A pass that reads and writes a resource (in-place update) declares both.
+  void Read(int pass, int resource);
+  void Write(int pass, int resource);
+
+  // False when a pass reads a transient resource no earlier pass wrote, or
+  // uses an index out of range. Compiling again after adding passes or
+  // resources recomputes everything.
+  bool Compile();
+  bool Compiled() const { return m_compiled; }
+  const std::string& GetLastError() const { return m_lastError; }
+
+  const std::vector<FrameResourceDesc>& Resources() const { return m_resources; }
+  const std::vector<FramePass>& Passes() const { return m_passes; }
+  const std::vector<uint64_t>& SlotBytes() const { return m_slotBytes; }
+  FrameGraphMemory Memory() const;
+
+private:
+  bool Fail(const std::string& message);
+  void AssignSlots();
+  void DeriveBarriers();
+
+  std::vector<FrameResourceDesc> m_resources;
+  std::vector<FramePass> m_passes;
+  std::vector<uint64_t> m_slotBytes;
+  bool m_compiled = false;
+  std::string m_lastError;
+};
+
+// The graph of the Interpolator's D3D11 motion pipeline (minimal or full),
+// or with vulkan the full pipeline's Vulkan path, with the textures' sizes,
+// formats and lifetimes from the resource table. Motion cache snapshots are
+// outside the frame and not part of it.
+bool PlanInterpolatorFrameGraph(int inputWidth, int inputHeight, int outputWidth, int outputHeight,
+                                bool minimalPipeline, bool vulkan, FrameGraph& graph);
+
+// Peak memory before and after aliasing, the slots, then per pass its
+// barriers and the resources it acquires and releases.
+std::string FormatFrameGraphReport(const FrameGraph& graph);
@@ -0,0 +1,347 @@
+#include "frame_stream.h"
+
+#include "lz4_codec.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint32_t kMaxDimension = 16384;
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// A record sits immediately before the first page boundary that leaves room
+// for it after `position`, so its payload starts on that boundary.
+uint64_t RecordOffset(uint64_t position) {
+  return AlignUp(position + sizeof(FrameStreamRecord), kFrameStreamAlign) - sizeof(FrameStreamRecord);
+}
+
+void FillFrame(const FrameStreamRecord& record, const uint8_t* data, CpuFrame& frame) {
+  const PixelFormat format = static_cast<PixelFormat>(record.format);
+  frame.data = data;
+  frame.pitch = static_cast<size_t>(record.width) * PixelFormatBytes(format);
+  frame.width = static_cast<int>(record.width);
+  frame.height = static_cast<int>(record.height);
+  frame.format = format;
+  frame.sequence = record.sequence;
+  frame.presentTime100ns = record.presentTime100ns;
+  frame.systemTime100ns = record.systemTime100ns;
+  frame.qpcTime = record.qpcTime;
+  frame.framesSkipped = record.framesSkipped;
+  frame.dirtyRects.clear();
+  frame.fullFrameDirty = true;
+}
+
+} // namespace
+
+static_assert(sizeof(FrameStreamRecord) == 80, "FrameStreamRecord layout is part of the file format");
+static_assert(sizeof(FrameStreamFileHeader) <= kFrameStreamAlign, "header must fit the first page");
+
+// ----------------------------------------------------------------------------
+// FrameStreamWriter
+// ----------------------------------------------------------------------------
+
+bool FrameStreamWriter::Open(const std::string& path) {
+  Close();
+  m_file = std::fopen(path.c_str(), "wb");
+  if (!m_file) {
+    return false;
+  }
+  m_position = 0;
+  m_rawBytes = 0;
+  m_index.clear();
+
+  // The header page is written again by Close once the index exists.
+  FrameStreamFileHeader header;
+  std::vector<uint8_t> page(kFrameStreamAlign, 0);
+  std::memcpy(page.data(), &header, sizeof(header));
+  if (!WriteBytes(page.data(), page.size())) {
+    std::fclose(m_file);
+    m_file = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool FrameStreamWriter::WriteBytes(const void* data, size_t bytes) {
+  if (std::fwrite(data, 1, bytes, m_file) != bytes) {
+    return false;
+  }
+  m_position += bytes;
+  return true;
+}
+
+bool FrameStreamWriter::Write(const CpuFrame& frame) {
+  if (!m_file || !frame.data || frame.width <= 0 || frame.height <= 0) {
+    return false;
+  }
+  const size_t rowBytes = static_cast<size_t>(frame.width) * PixelFormatBytes(frame.format);
+  const size_t rawBytes = rowBytes * frame.height;
+
+  // Tightly packed source rows are written (or compressed) in place.
+  const uint8_t* packed = frame.data;
+  if (frame.pitch != rowBytes) {
+    m_packed.resize(rawBytes);
+    for (int y = 0; y < frame.height; ++y) {
+      std::memcpy(m_packed.data() + rowBytes * y, frame.data + frame.pitch * y, rowBytes);
+    }
+    packed = m_packed.data();
+  }
+
+  FrameStreamRecord record;
+  record.rawBytes = rawBytes;
+  record.sequence = frame.sequence;
+  record.presentTime100ns = frame.presentTime100ns;
+  record.systemTime100ns = frame.systemTime100ns;
+  record.qpcTime = frame.qpcTime;
+  record.width = static_cast<uint32_t>(frame.width);
+  record.height = static_cast<uint32_t>(frame.height);
+  record.format = static_cast<uint32_t>(frame.format);
+  record.framesSkipped = frame.framesSkipped;
+
+  const uint8_t* payload = packed;
+  record.storedBytes = rawBytes;
+  record.compression = static_cast<uint32_t>(FrameStreamCompression::None);
+  if (m_compression == FrameStreamCompression::Lz4) {
+    m_compressed.resize(Lz4CompressBound(rawBytes));
+    const size_t size = Lz4Compress(packed, rawBytes, m_compressed.data(), m_compressed.size());
+    if (size > 0 && size < rawBytes) {
+      payload = m_compressed.data();
+      record.storedBytes = size;
+      record.compression = static_cast<uint32_t>(FrameStreamCompression::Lz4);
+    }
+  }
+
+  const uint64_t recordOffset = RecordOffset(m_position);
+  record.payloadOffset = recordOffset + sizeof(record);
+  static const uint8_t kZeros[kFrameStreamAlign] = {};
+  if (!WriteBytes(kZeros, static_cast<size_t>(recordOffset - m_position)) ||
+      !WriteBytes(&record, sizeof(record)) ||
+      !WriteBytes(payload, static_cast<size_t>(record.storedBytes))) {
+    return false;
+  }
+  m_index.push_back(record);
+  m_rawBytes += rawBytes;
+  return true;
+}
+
+bool FrameStreamWriter::Close() {
+  if (!m_file) {
+    return false;
+  }
+  FrameStreamFileHeader header;
+  header.indexOffset = m_position;
+  header.frameCount = m_index.size();
+  bool ok = m_index.empty() || WriteBytes(m_index.data(), m_index.size() * sizeof(FrameStreamRecord));
+  ok = ok && std::fflush(m_file) == 0;
+  ok = ok && std::fseek(m_file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, m_file) == 1;
+  ok = (std::fclose(m_file) == 0) && ok;
+  m_file = nullptr;
+  return ok;
+}
+
+// ----------------------------------------------------------------------------
+// FrameStreamReader
+// ----------------------------------------------------------------------------
+
+bool FrameStreamReader::Open(const std::string& path) {
+  Close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    m_lastError = "Cannot open " + path;
+    return false;
+  }
+  LARGE_INTEGER size = {};
+  if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(FrameStreamFileHeader))) {
+    CloseHandle(file);
+    m_lastError = "Not a frame stream file";
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!view) {
+    if (mapping) {
+      CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    m_lastError = "Cannot map " + path;
+    return false;
+  }
+  m_fileHandle = file;
+  m_mapHandle = mapping;
+  m_base = static_cast<const uint8_t*>(view);
+  m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    m_lastError = "Cannot open " + path;
+    return false;
+  }
+  struct stat st = {};
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FrameStreamFileHeader))) {
+    close(fd);
+    m_lastError = "Not a frame stream file";
+    return false;
+  }
+  void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // the mapping keeps the file alive
+  if (view == MAP_FAILED) {
+    m_lastError = "Cannot map " + path;
+    return false;
+  }
+  madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+  m_base = static_cast<const uint8_t*>(view);
+  m_size = static_cast<uint64_t>(st.st_size);
+#endif
+
+  FrameStreamFileHeader header;
+  FrameStreamFileHeader expected;
+  std::memcpy(&header, m_base, sizeof(header));
+  if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) {
+    Unmap();
+    m_lastError = "Not a frame stream file";
+    return false;
+  }
+  if (header.version != expected.version || header.recordBytes != sizeof(FrameStreamRecord) ||
+      header.alignment != expected.alignment) {
+    Unmap();
+    m_lastError = "Unsupported frame stream version";
+    return false;
+  }
+
+  m_index.clear();
+  m_recovered = false;
+  const uint64_t maxFrames = m_size / sizeof(FrameStreamRecord);
+  if (header.indexOffset != 0 && header.indexOffset <= m_size && header.frameCount <= maxFrames &&
+      header.frameCount * sizeof(FrameStreamRecord) <= m_size - header.indexOffset) {
+    m_index.resize(static_cast<size_t>(header.frameCount));
+    if (!m_index.empty()) {
+      std::memcpy(m_index.data(), m_base + header.indexOffset, m_index.size() * sizeof(FrameStreamRecord));
+    }
+    for (const FrameStreamRecord& record : m_index) {
+      if (!ValidRecord(record)) {
+        Unmap();
+        m_lastError = "Corrupt frame stream index";
+        return false;
+      }
+    }
+  } else {
+    // No index: the writer did not finish. Walk the chunks up to the first
+    // record that does not check out (typically a half-written payload).
+    uint64_t position = kFrameStreamAlign;
+    while (true) {
+      const uint64_t recordOffset = RecordOffset(position);
+      if (recordOffset + sizeof(FrameStreamRecord) > m_size) {
+        break;
+      }
+      FrameStreamRecord record;
+      std::memcpy(&record, m_base + recordOffset, sizeof(record));
+      if (record.payloadOffset != recordOffset + sizeof(record) || !ValidRecord(record)) {
+        break;
+      }
+      m_index.push_back(record);
+      position = record.payloadOffset + record.storedBytes;
+    }
+    m_recovered = true;
+  }
+
+  m_next = 0;
+  m_firstTime100ns = 0;
+  if (!m_index.empty()) {
+    const FrameStreamRecord& first = m_index.front();
+    m_firstTime100ns = first.presentTime100ns != 0 ? first.presentTime100ns : first.systemTime100ns;
+  }
+  m_lastError.clear();
+  return true;
+}
+
+bool FrameStreamReader::ValidRecord(const FrameStreamRecord& record) const {
+  if (record.width == 0 || record.height == 0 || record.width > kMaxDimension || record.height > kMaxDimension ||
+      record.format > static_cast<uint32_t>(PixelFormat::Rgba16F)) {
+    return false;
+  }
+  const uint64_t rawBytes = static_cast<uint64_t>(record.width) * record.height *
+                            PixelFormatBytes(static_cast<PixelFormat>(record.format));
+  if (record.rawBytes != rawBytes || record.payloadOffset % kFrameStreamAlign != 0 ||
+      record.payloadOffset > m_size || record.storedBytes > m_size - record.payloadOffset) {
+    return false;
+  }
+  switch (static_cast<FrameStreamCompression>(record.compression)) {
+    case FrameStreamCompression::None:
+      return record.storedBytes == rawBytes;
+    case FrameStreamCompression::Lz4:
+      return record.storedBytes <= Lz4CompressBound(static_cast<size_t>(rawBytes));
+  }
+  return false;
+}
+
+void FrameStreamReader::Unmap() {
+#ifdef _WIN32
+  if (m_base) {
+    UnmapViewOfFile(m_base);
+  }
+  if (m_mapHandle) {
+    CloseHandle(static_cast<HANDLE>(m_mapHandle));
+  }
+  if (m_fileHandle) {
+    CloseHandle(static_cast<HANDLE>(m_fileHandle));
+  }
+  m_mapHandle = nullptr;
+  m_fileHandle = nullptr;
+#else
+  if (m_base) {
+    munmap(const_cast<uint8_t*>(m_base), static_cast<size_t>(m_size));
+  }
+#endif
+  m_base = nullptr;
+  m_size = 0;
+}
+
+void FrameStreamReader::Close() {
+  Unmap();
+  m_index.clear();
+  m_next = 0;
+}
+
+bool FrameStreamReader::ReadFrame(size_t index, CpuFrame& frame) {
+  if (!m_base || index >= m_index.size()) {
+    return false;
+  }
+  const FrameStreamRecord& record = m_index[index];
+  const uint8_t* payload = m_base + record.payloadOffset;
+  if (static_cast<FrameStreamCompression>(record.compression) == FrameStreamCompression::None) {
+    FillFrame(record, payload, frame);
+    return true;
+  }
+  m_decoded.resize(static_cast<size_t>(record.rawBytes));
+  if (!Lz4Decompress(payload, static_cast<size_t>(record.storedBytes), m_decoded.data(), m_decoded.size())) {
+    m_lastError = "Corrupt compressed frame";
+    return false;
+  }
+  FillFrame(record, m_decoded.data(), frame);
+  return true;
+}
+
+bool FrameStreamReader::Next(CpuFrame& frame) {
+  if (m_next >= m_index.size() || !ReadFrame(m_next, frame)) {
+    return false;
+  }
+  m_next++;
+  return true;
+}
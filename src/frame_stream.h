@@ -0,0 +1,138 @@
+#pragma once
+
+#include "cpu_frame.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Frame stream file (.tmfs): a captured session as a chunked container of
+// frames with their original identity and timestamps, written by
+// SessionRecorder and read back by ReplaySource.
+//
+// Layout (little endian, kFrameStreamAlign = 4096):
+//
+//   [FrameStreamFileHeader, padded to one page]
+//   per frame: [padding][FrameStreamRecord][payload, page aligned]
+//   [FrameStreamRecord array: the index]
+//
+// Payloads start on page boundaries so a reader can map the file and hand
+// uncompressed frames (rows tightly packed) straight to the CPU pipeline or
+// a GPU upload without copying. Each payload is raw or one LZ4 block.
+//
+// The header's indexOffset is written last. A file whose writer died has
+// indexOffset 0; its records are still found by walking the chunks, since
+// every record sits just before the next page boundary after the previous
+// payload.
+
+constexpr uint64_t kFrameStreamAlign = 4096;
+
+enum class FrameStreamCompression : uint32_t {
+  None = 0,
+  Lz4 = 1,
+};
+
+struct FrameStreamFileHeader {
+  char magic[4] = {'T', 'M', 'F', 'S'};
+  uint32_t version = 2;
+  uint32_t recordBytes = 80;        // sizeof(FrameStreamRecord)
+  uint32_t alignment = static_cast<uint32_t>(kFrameStreamAlign);
+  uint64_t indexOffset = 0;         // 0 = not finalized
+  uint64_t frameCount = 0;
+};
+
+struct FrameStreamRecord {
+  uint64_t payloadOffset = 0;       // from the start of the file
+  uint64_t storedBytes = 0;         // payload size in the file
+  uint64_t rawBytes = 0;            // height * width * bpp
+  uint64_t sequence = 0;
+  int64_t presentTime100ns = 0;
+  int64_t systemTime100ns = 0;
+  int64_t qpcTime = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t format = 0;              // PixelFormat
+  uint32_t compression = 0;         // FrameStreamCompression
+  uint32_t framesSkipped = 0;
+  uint32_t reserved = 0;
+};
+
+class FrameStreamWriter {
+public:
+  ~FrameStreamWriter() { Close(); }
+
+  bool Open(const std::string& path);
+  void SetCompression(FrameStreamCompression compression) { m_compression = compression; }
+
+  // Appends one frame (any source pitch; rows are stored tightly). With
+  // LZ4 the frame is stored raw if it does not compress.
+  bool Write(const CpuFrame& frame);
+  // Writes the index and finalizes the header.
+  bool Close();
+
+  bool IsOpen() const { return m_file != nullptr; }
+  uint64_t Frames() const { return m_index.size(); }
+  uint64_t RawBytes() const { return m_rawBytes; }
+  uint64_t Bytes() const { return m_position; }     // file size so far
+
+private:
+  bool WriteBytes(const void* data, size_t bytes);
+
+  std::FILE* m_file = nullptr;
+  uint64_t m_position = 0;
+  uint64_t m_rawBytes = 0;
+  FrameStreamCompression m_compression = FrameStreamCompression::None;
+  std::vector<FrameStreamRecord> m_index;
+  std::vector<uint8_t> m_packed;        // tightly packed rows
+  std::vector<uint8_t> m_compressed;
+};
+
+class FrameStreamReader {
+public:
+  FrameStreamReader() = default;
+  ~FrameStreamReader() { Close(); }
+
+  FrameStreamReader(const FrameStreamReader&) = delete;
+  FrameStreamReader& operator=(const FrameStreamReader&) = delete;
+
+  // Maps the file and loads (or, for an unfinished file, rebuilds) the index.
+  bool Open(const std::string& path);
+  void Close();
+  bool IsOpen() const { return m_base != nullptr; }
+
+  size_t FrameCount() const { return m_index.size(); }
+  const FrameStreamRecord& Record(size_t index) const { return m_index[index]; }
+  // True when the index was rebuilt by walking the chunks.
+  bool Recovered() const { return m_recovered; }
+
+  // Frame at index. Uncompressed frames point into the mapping (valid until
+  // Close); LZ4 frames are decoded into a buffer valid until the next call.
+  bool ReadFrame(size_t index, CpuFrame& frame);
+
+  // Sequential access over ReadFrame.
+  bool Next(CpuFrame& frame);
+  bool Rewind() {
+    m_next = 0;
+    return IsOpen();
+  }
+
+  // Time of the first frame, for rebasing.
+  int64_t FirstTime100ns() const { return m_firstTime100ns; }
+  const std::string& GetLastError() const { return m_lastError; }
+
+private:
+  bool ValidRecord(const FrameStreamRecord& record) const;
+  void Unmap();
+
+  const uint8_t* m_base = nullptr;
+  uint64_t m_size = 0;
+  void* m_fileHandle = nullptr;     // Windows file and mapping handles
+  void* m_mapHandle = nullptr;
+  std::vector<FrameStreamRecord> m_index;
+  size_t m_next = 0;
+  bool m_recovered = false;
+  int64_t m_firstTime100ns = 0;
+  std::vector<uint8_t> m_decoded;
+  std::string m_lastError;
+};
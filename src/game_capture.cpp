@@ -1,5 +1,6 @@
 #include "game_capture.h"
 #include <d3d11_1.h>
+#include <cstring>
 #include <fstream>
 #include <shlwapi.h>
 
@@ -32,6 +33,13 @@ HANDLE OpenNamedFileMapping(const wchar_t* baseName, DWORD processId) {
     return OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, name);
 }
 
+int64_t QpcTo100ns(int64_t ticks, int64_t frequency) {
+    if (ticks <= 0 || frequency <= 0) {
+        return 0;
+    }
+    return static_cast<int64_t>(static_cast<double>(ticks) * (1e7 / static_cast<double>(frequency)));
+}
+
 }  // namespace
 
 GameCapture::~GameCapture() {
@@ -196,6 +204,7 @@ void GameCapture::StopCapture() {
     CloseSharedMemory();
     
     m_captureTexture.Reset();
+    m_lumaTexture.Reset();
     m_sharedTexture.Reset();
     
     m_hwnd = nullptr;
@@ -272,6 +281,8 @@ bool GameCapture::WaitForHookReady(DWORD timeout) {
 }
 
 bool GameCapture::OpenSharedMemory() {
+    m_lastFrameCount = 0;
+    
     // Open hook info mapping
     m_hookInfoMap = OpenNamedFileMapping(SHMEM_HOOK_INFO, m_processId);
     if (!m_hookInfoMap) {
@@ -345,23 +356,22 @@ bool GameCapture::OpenSharedMemory() {
         return false;
     }
     
-    DWORD dataSize = m_pitch * m_height;
-    DWORD mapSize = sizeof(shmem_data) + (dataSize * NUM_BUFFERS);
-    
-    m_textureData = MapViewOfFile(m_textureMap, FILE_MAP_READ, 0, 0, mapSize);
+    // Map the whole section; the ring header describes its own layout.
+    m_textureData = MapViewOfFile(m_textureMap, FILE_MAP_READ, 0, 0, 0);
     if (!m_textureData) {
         m_lastError = "Failed to map texture data";
         return false;
     }
     
-    m_shmemData = (shmem_data*)m_textureData;
+    MEMORY_BASIC_INFORMATION info = {};
+    VirtualQuery(m_textureData, &info, sizeof(info));
+    m_textureDataSize = info.RegionSize;
     
-    // Open texture mutexes
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        wchar_t name[128];
-        swprintf(name, 128, L"%s%lu", (i == 0) ? MUTEX_TEXTURE1 : MUTEX_TEXTURE2, m_processId);
-        m_textureMutex[i] = OpenMutexW(MUTEX_ALL_ACCESS, FALSE, name);
+    if (!m_frameRing.Attach(m_textureData, m_textureDataSize)) {
+        m_lastError = "Shared frame ring version mismatch";
+        return false;
     }
+    m_tileDecoder.Reset(m_frameRing.Header()->width, m_frameRing.Header()->height);
     
     return true;
 }
@@ -376,10 +386,12 @@ void GameCapture::CloseSharedMemory() {
         m_hookInfoMap = nullptr;
     }
     
+    m_frameRing.Detach();
     if (m_textureData) {
         UnmapViewOfFile(m_textureData);
         m_textureData = nullptr;
     }
+    m_textureDataSize = 0;
     if (m_shtexData) {
         UnmapViewOfFile(m_shtexData);
         m_shtexData = nullptr;
@@ -389,13 +401,6 @@ void GameCapture::CloseSharedMemory() {
         m_textureMap = nullptr;
     }
     
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        if (m_textureMutex[i]) {
-            CloseHandle(m_textureMutex[i]);
-            m_textureMutex[i] = nullptr;
-        }
-    }
-    
     if (m_hookReadyEvent) {
         CloseHandle(m_hookReadyEvent);
         m_hookReadyEvent = nullptr;
@@ -408,8 +413,6 @@ void GameCapture::CloseSharedMemory() {
         CloseHandle(m_hookExitEvent);
         m_hookExitEvent = nullptr;
     }
-    
-    m_shmemData = nullptr;
 }
 
 bool GameCapture::AcquireNextFrame(CapturedFrame& frame) {
@@ -430,6 +433,15 @@ bool GameCapture::AcquireNextFrame(CapturedFrame& frame) {
         m_pitch = m_hookInfo->pitch;
         m_format = m_hookInfo->format;
         m_captureTexture.Reset();
+        m_lumaTexture.Reset();
+        
+        // The hook re-initializes the ring in place after a resize.
+        if (m_textureData) {
+            if (!m_frameRing.Attach(m_textureData, m_textureDataSize)) {
+                return false;
+            }
+            m_tileDecoder.Reset(m_frameRing.Header()->width, m_frameRing.Header()->height);
+        }
     }
     
     EnsureCaptureTexture(m_width, m_height);
@@ -438,48 +450,121 @@ bool GameCapture::AcquireNextFrame(CapturedFrame& frame) {
     }
     
     // Get frame data
+    uint64_t sequence = 0;
+    uint32_t skipped = 0;
+    int64_t presentTime100ns = 0;
+    bool hasLuma = false;
     if (m_sharedTexture) {
         // Shared texture path - direct GPU copy
-        static uint64_t lastFrameCount = 0;
-        if (m_hookInfo->frame_count == lastFrameCount) {
-            return false; // No new frame
+        uint64_t frameCount = 0;
+        int64_t presentQpc = 0;
+        if (!shared_frame_ring::ReadStamp(m_hookInfo->frame_stamp, &frameCount, &presentQpc) ||
+            frameCount == m_lastFrameCount) {
+            return false; // No new frame, or the hook is stamping one
         }
-        lastFrameCount = m_hookInfo->frame_count;
         
         m_context->CopyResource(m_captureTexture.Get(), m_sharedTexture.Get());
-    } else if (m_shmemData) {
-        // Shared memory path - CPU to GPU copy
-        int curTex = m_shmemData->last_tex;
-        if (curTex < 0 || curTex >= NUM_BUFFERS) {
-            return false;
-        }
         
-        static int lastTex = -1;
-        if (curTex == lastTex) {
-            return false; // No new frame
+        sequence = frameCount;
+        skipped = (m_lastFrameCount != 0 && frameCount > m_lastFrameCount + 1)
+                      ? static_cast<uint32_t>(frameCount - m_lastFrameCount - 1) : 0;
+        presentTime100ns = QpcTo100ns(presentQpc, m_qpcFreq.QuadPart);
+        m_lastFrameCount = frameCount;
+    } else if (m_frameRing.IsAttached()) {
+        // Shared memory path - CPU to GPU copy straight out of the ring slot
+        const shared_frame_ring_header* ring = m_frameRing.Header();
+        if (ring->width != (uint32_t)m_width || ring->height != (uint32_t)m_height) {
+            return false; // Hook is still re-initializing after a resize
         }
         
-        // Lock mutex
-        if (m_textureMutex[curTex]) {
-            if (WaitForSingleObject(m_textureMutex[curTex], 0) != WAIT_OBJECT_0) {
-                return false;
-            }
+        if (ring->luma_pitch) {
+            EnsureLumaTexture(m_width / 2, m_height / 2);
+        } else {
+            m_lumaTexture.Reset();
         }
         
-        // Get texture data pointer
-        uint8_t* srcData = (uint8_t*)m_shmemData;
-        srcData += (curTex == 0) ? m_shmemData->tex1_offset : m_shmemData->tex2_offset;
+        SharedFrameView view;
+        if (!m_frameRing.BeginRead(&view)) {
+            return false; // No new frame, or the slot is being written
+        }
+        const bool uploadLuma = view.luma && m_lumaTexture;
         
-        // Update texture
-        m_context->UpdateSubresource(m_captureTexture.Get(), 0, nullptr, 
-                                     srcData, m_pitch, 0);
+        // Copy the slot into staging memory inside the read window and touch
+        // the capture textures only once EndRead has vouched for the copy, so
+        // a torn frame never reaches them.
+        const size_t frameBytes = static_cast<size_t>(ring->pitch) * ring->height;
+        const size_t lumaBytes = static_cast<size_t>(ring->luma_pitch) * (ring->height / 2);
+        if (m_stagingPixels.size() < frameBytes) {
+            m_stagingPixels.resize(frameBytes);
+        }
+        if (uploadLuma && m_stagingLuma.size() < lumaBytes) {
+            m_stagingLuma.resize(lumaBytes);
+        }
+        const uint32_t bytesPerPixel = (ring->format == DXGI_FORMAT_R16G16B16A16_FLOAT ||
+                                       ring->format == DXGI_FORMAT_R16G16B16A16_UNORM) ? 8 : 4;
+        const std::vector<TileRect>* rects = nullptr;
+        if (ring->tile_size > 0) {
+            // Tile-delta ring: stage only the tiles that changed since the
+            // frame the capture texture already holds.
+            rects = &m_tileDecoder.Plan(reinterpret_cast<const uint64_t*>(view.meta));
+            TileDeltaDecoder::Apply(*rects, view.data, ring->pitch, m_stagingPixels.data(), ring->pitch,
+                                    bytesPerPixel);
+            // Tiles start on even pixels, so the plane rects are exact.
+            m_stagingLumaRects.clear();
+            for (const TileRect& rect : *rects) {
+                TileRect luma = {rect.x / 2, rect.y / 2, rect.width / 2, rect.height / 2};
+                if (luma.width > 0 && luma.height > 0) {
+                    m_stagingLumaRects.push_back(luma);
+                }
+            }
+            if (uploadLuma) {
+                TileDeltaDecoder::Apply(m_stagingLumaRects, view.luma, ring->luma_pitch, m_stagingLuma.data(),
+                                        ring->luma_pitch, sizeof(uint16_t));
+            }
+        } else {
+            memcpy(m_stagingPixels.data(), view.data, frameBytes);
+            if (uploadLuma) {
+                memcpy(m_stagingLuma.data(), view.luma, lumaBytes);
+            }
+        }
         
-        lastTex = curTex;
+        if (!m_frameRing.EndRead(view)) {
+            // Hook lapped the ring mid-copy; next frame replaces it. The
+            // textures still hold the last good frame, but the delta plan was
+            // consumed, so the next delta read is a full upload.
+            m_tileDecoder.Invalidate();
+            return false;
+        }
         
-        // Release mutex
-        if (m_textureMutex[curTex]) {
-            ReleaseMutex(m_textureMutex[curTex]);
+        if (rects) {
+            for (const TileRect& rect : *rects) {
+                D3D11_BOX box = {rect.x, rect.y, 0, rect.x + rect.width, rect.y + rect.height, 1};
+                const uint8_t* src = m_stagingPixels.data() + static_cast<size_t>(rect.y) * ring->pitch +
+                                     static_cast<size_t>(rect.x) * bytesPerPixel;
+                m_context->UpdateSubresource(m_captureTexture.Get(), 0, &box, src, ring->pitch, 0);
+            }
+            if (uploadLuma) {
+                for (const TileRect& rect : m_stagingLumaRects) {
+                    D3D11_BOX box = {rect.x, rect.y, 0, rect.x + rect.width, rect.y + rect.height, 1};
+                    const uint8_t* src = m_stagingLuma.data() + static_cast<size_t>(rect.y) * ring->luma_pitch +
+                                         static_cast<size_t>(rect.x) * sizeof(uint16_t);
+                    m_context->UpdateSubresource(m_lumaTexture.Get(), 0, &box, src, ring->luma_pitch, 0);
+                }
+            }
+        } else {
+            m_context->UpdateSubresource(m_captureTexture.Get(), 0, nullptr,
+                                         m_stagingPixels.data(), ring->pitch, 0);
+            if (uploadLuma) {
+                m_context->UpdateSubresource(m_lumaTexture.Get(), 0, nullptr,
+                                             m_stagingLuma.data(), ring->luma_pitch, 0);
+            }
         }
+        m_tileDecoder.Commit(view.frame);
+        hasLuma = uploadLuma;
+        
+        sequence = view.frame;
+        skipped = static_cast<uint32_t>(view.skipped);
+        presentTime100ns = QpcTo100ns(view.presentTime, ring->time_frequency);
     } else {
         return false;
     }
@@ -489,22 +574,21 @@ bool GameCapture::AcquireNextFrame(CapturedFrame& frame) {
     QueryPerformanceCounter(&qpc);
     
     frame.texture = m_captureTexture;
+    frame.lumaTexture = hasLuma ? m_lumaTexture : nullptr;
     frame.width = m_width;
     frame.height = m_height;
     frame.qpcTime = qpc.QuadPart;
     
-    if (m_qpcFreq.QuadPart > 0) {
-        double qpcTo100ns = 1e7 / static_cast<double>(m_qpcFreq.QuadPart);
-        frame.systemTime100ns = static_cast<int64_t>(qpc.QuadPart * qpcTo100ns);
-    } else {
-        frame.systemTime100ns = 0;
-    }
+    frame.systemTime100ns = QpcTo100ns(qpc.QuadPart, m_qpcFreq.QuadPart);
+    frame.sequence = sequence;
+    frame.presentTime100ns = presentTime100ns;
+    frame.framesSkipped = skipped;
     
     return true;
 }
 
 uint64_t GameCapture::GetFrameCount() const {
-    return m_hookInfo ? m_hookInfo->frame_count : 0;
+    return m_hookInfo ? m_hookInfo->frame_stamp.frame.load(std::memory_order_relaxed) : 0;
 }
 
 void GameCapture::SetFrameRateLimit(double fps) {
@@ -542,4 +626,34 @@ void GameCapture::EnsureCaptureTexture(int width, int height) {
     
     m_captureTexture.Reset();
     m_device->CreateTexture2D(&desc, nullptr, &m_captureTexture);
+    m_tileDecoder.Invalidate();
+}
+
+void GameCapture::EnsureLumaTexture(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        m_lumaTexture.Reset();
+        return;
+    }
+    if (m_lumaTexture) {
+        D3D11_TEXTURE2D_DESC desc;
+        m_lumaTexture->GetDesc(&desc);
+        if ((int)desc.Width == width && (int)desc.Height == height) {
+            return;
+        }
+    }
+    
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R16_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    
+    m_lumaTexture.Reset();
+    m_device->CreateTexture2D(&desc, nullptr, &m_lumaTexture);
+    // A new plane has nothing to patch; the next read uploads everything.
+    m_tileDecoder.Invalidate();
 }
@@ -1,16 +1,19 @@
 #pragma once
 
 #include "capture_frame.h"
+#include "capture_source.h"
 #include "graphics_hook_info.h"
 #include "dll_injector.h"
+#include "tile_delta.h"
 
 #include <d3d11.h>
 #include <windows.h>
 #include <wrl/client.h>
 #include <string>
 #include <atomic>
+#include <vector>
 
-class GameCapture {
+class GameCapture : public ICaptureSource {
 public:
     GameCapture() = default;
     ~GameCapture();
@@ -20,12 +23,12 @@ public:
     
     // Start capturing a window by injecting hook into its process
     bool StartCapture(HWND hwnd);
-    void StopCapture();
+    void StopCapture() override;
     
     // Acquire next captured frame
     bool AcquireNextFrame(CapturedFrame& frame);
     
-    bool IsCapturing() const { return m_isCapturing; }
+    bool IsCapturing() const override { return m_isCapturing; }
     bool IsHooked() const { return m_isHooked; }
     
     // Get capture statistics
@@ -40,16 +43,25 @@ public:
     // Get last error message
     const std::string& GetLastError() const { return m_lastError; }
 
+    // ICaptureSource
+    const char* SourceName() const override { return "Game Hook"; }
+    bool AcquireFrame(SourceFrame& frame) override {
+        frame.onGpu = true;
+        return AcquireNextFrame(frame.gpu);
+    }
+
 private:
     bool InjectHook(DWORD processId);
     bool OpenSharedMemory();
     void CloseSharedMemory();
     bool WaitForHookReady(DWORD timeout);
     void EnsureCaptureTexture(int width, int height);
+    void EnsureLumaTexture(int width, int height);
     
     Microsoft::WRL::ComPtr<ID3D11Device> m_device;
     Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_context;
     Microsoft::WRL::ComPtr<ID3D11Texture2D> m_captureTexture;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_lumaTexture;   // hook luma plane, R16_UNORM half-res
     Microsoft::WRL::ComPtr<ID3D11Texture2D> m_sharedTexture;
     
     // Target info
@@ -60,7 +72,6 @@ private:
     // Shared memory handles
     HANDLE m_hookInfoMap = nullptr;
     HANDLE m_textureMap = nullptr;
-    HANDLE m_textureMutex[NUM_BUFFERS] = {nullptr};
     HANDLE m_keepAliveMutex = nullptr;
     HANDLE m_hookReadyEvent = nullptr;
     HANDLE m_hookStopEvent = nullptr;
@@ -69,9 +80,16 @@ private:
     
     // Shared memory pointers
     hook_info* m_hookInfo = nullptr;
-    shmem_data* m_shmemData = nullptr;
     shtex_data* m_shtexData = nullptr;
     void* m_textureData = nullptr;
+    uint64_t m_textureDataSize = 0;
+    SharedFrameRingReader m_frameRing;
+    TileDeltaDecoder m_tileDecoder;  // capture texture contents vs. ring frames
+    // Ring slot copies validated by EndRead before they are uploaded.
+    std::vector<uint8_t> m_stagingPixels;
+    std::vector<uint8_t> m_stagingLuma;
+    std::vector<TileRect> m_stagingLumaRects;
+    uint64_t m_lastFrameCount = 0;   // last hook frame delivered (texture path)
     
     // State
     bool m_isCapturing = false;
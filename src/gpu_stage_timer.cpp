@@ -0,0 +1,296 @@
+#include "gpu_stage_timer.h"
+
+#include "deadline_wait.h"
+
+#include <algorithm>
+
+// ----------------------------------------------------------------------------
+// D3D11StageTimer
+// ----------------------------------------------------------------------------
+
+void D3D11StageTimer::Initialize(ID3D11Device* device, ID3D11DeviceContext* context) {
+  m_device = device;
+  m_context = context;
+  m_frames = {};
+  m_write = 0;
+  m_active = false;
+}
+
+bool D3D11StageTimer::CreateStageQueries(StageQueries& queries) {
+  if (queries.begin && queries.end) {
+    return true;
+  }
+  D3D11_QUERY_DESC desc = {};
+  desc.Query = D3D11_QUERY_TIMESTAMP;
+  if (FAILED(m_device->CreateQuery(&desc, &queries.begin)) ||
+      FAILED(m_device->CreateQuery(&desc, &queries.end))) {
+    queries.begin.Reset();
+    queries.end.Reset();
+    return false;
+  }
+  return true;
+}
+
+void D3D11StageTimer::BeginFrame(uint64_t frame, double cpuSec) {
+  m_active = false;
+  if (!m_device || !m_context) {
+    return;
+  }
+  FrameQueries& slot = m_frames[m_write];
+  if (slot.pending) {
+    // Still in flight from kFramesInFlight frames ago; skip this frame.
+    return;
+  }
+  if (!slot.disjoint) {
+    D3D11_QUERY_DESC desc = {};
+    desc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+    if (FAILED(m_device->CreateQuery(&desc, &slot.disjoint))) {
+      return;
+    }
+  }
+  for (StageQueries& stage : slot.stages) {
+    stage.used = false;
+  }
+  slot.frame = frame;
+  slot.cpuSec = cpuSec;
+  m_context->Begin(slot.disjoint.Get());
+  m_active = true;
+}
+
+void D3D11StageTimer::EndFrame() {
+  if (!m_active) {
+    return;
+  }
+  FrameQueries& slot = m_frames[m_write];
+  m_context->End(slot.disjoint.Get());
+  slot.pending = true;
+  m_active = false;
+  m_write = (m_write + 1) % kFramesInFlight;
+}
+
+void D3D11StageTimer::BeginStage(PipelineStage stage) {
+  if (!m_active) {
+    return;
+  }
+  StageQueries& queries = m_frames[m_write].stages[static_cast<int>(stage)];
+  if (!CreateStageQueries(queries)) {
+    return;
+  }
+  // A stage issued twice in one frame keeps its last occurrence.
+  queries.used = false;
+  m_context->End(queries.begin.Get());
+}
+
+void D3D11StageTimer::EndStage(PipelineStage stage) {
+  if (!m_active) {
+    return;
+  }
+  StageQueries& queries = m_frames[m_write].stages[static_cast<int>(stage)];
+  if (!queries.begin || !queries.end) {
+    return;
+  }
+  m_context->End(queries.end.Get());
+  queries.used = true;
+}
+
+void D3D11StageTimer::Collect(StageTimeline& timeline) {
+  if (!m_context) {
+    return;
+  }
+  // Oldest first so the timeline stays in frame order.
+  for (int i = 1; i <= kFramesInFlight; ++i) {
+    FrameQueries& slot = m_frames[(m_write + i) % kFramesInFlight];
+    if (!slot.pending) {
+      continue;
+    }
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+    if (m_context->GetData(slot.disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) {
+      continue;
+    }
+    std::array<UINT64, kPipelineStageCount> begins = {};
+    std::array<UINT64, kPipelineStageCount> ends = {};
+    bool ready = true;
+    for (int stage = 0; stage < kPipelineStageCount && ready; ++stage) {
+      const StageQueries& queries = slot.stages[stage];
+      if (!queries.used) {
+        continue;
+      }
+      ready = m_context->GetData(queries.begin.Get(), &begins[stage], sizeof(UINT64),
+                                 D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK &&
+              m_context->GetData(queries.end.Get(), &ends[stage], sizeof(UINT64),
+                                 D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+    }
+    if (!ready) {
+      continue;
+    }
+    slot.pending = false;
+    if (disjoint.Disjoint || disjoint.Frequency == 0) {
+      continue;
+    }
+
+    UINT64 origin = 0;
+    bool haveOrigin = false;
+    for (int stage = 0; stage < kPipelineStageCount; ++stage) {
+      if (slot.stages[stage].used && (!haveOrigin || begins[stage] < origin)) {
+        origin = begins[stage];
+        haveOrigin = true;
+      }
+    }
+    const double period = 1.0 / static_cast<double>(disjoint.Frequency);
+    for (int stage = 0; stage < kPipelineStageCount; ++stage) {
+      if (!slot.stages[stage].used || ends[stage] < begins[stage]) {
+        continue;
+      }
+      StageSample sample;
+      sample.frame = slot.frame;
+      sample.beginSec = slot.cpuSec + static_cast<double>(begins[stage] - origin) * period;
+      sample.endSec = slot.cpuSec + static_cast<double>(ends[stage] - origin) * period;
+      sample.stage = static_cast<PipelineStage>(stage);
+      sample.domain = TimingDomain::Gpu;
+      timeline.Push(sample);
+    }
+  }
+}
+
+#ifdef USE_VULKAN
+// ----------------------------------------------------------------------------
+// VkStageTimer
+// ----------------------------------------------------------------------------
+
+bool VkStageTimer::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily) {
+  Shutdown();
+  if (device == VK_NULL_HANDLE || physicalDevice == VK_NULL_HANDLE) {
+    return false;
+  }
+
+  VkPhysicalDeviceProperties props = {};
+  vkGetPhysicalDeviceProperties(physicalDevice, &props);
+  uint32_t familyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> families(familyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+  if (queueFamily >= familyCount || families[queueFamily].timestampValidBits == 0 ||
+      props.limits.timestampPeriod <= 0.0f) {
+    return false;   // no timestamps on this queue: CPU timing only
+  }
+  const uint32_t validBits = families[queueFamily].timestampValidBits;
+  m_validMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+  m_periodSec = static_cast<double>(props.limits.timestampPeriod) * 1e-9;
+
+  VkQueryPoolCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  info.queryCount = kQueryCount;
+  if (vkCreateQueryPool(device, &info, nullptr, &m_pool) != VK_SUCCESS) {
+    m_pool = VK_NULL_HANDLE;
+    return false;
+  }
+  m_device = device;
+  return true;
+}
+
+void VkStageTimer::Shutdown() {
+  if (m_pool != VK_NULL_HANDLE) {
+    vkDestroyQueryPool(m_device, m_pool, nullptr);
+  }
+  m_pool = VK_NULL_HANDLE;
+  m_device = VK_NULL_HANDLE;
+  m_cmd = VK_NULL_HANDLE;
+  m_submitted = false;
+  m_resolved.clear();
+}
+
+void VkStageTimer::BeginFrame(uint64_t frame, double /*cpuSec*/) {
+  m_frame = frame;
+}
+
+void VkStageTimer::BeginCommands(VkCommandBuffer cmd) {
+  m_cmd = VK_NULL_HANDLE;
+  m_submitted = false;
+  m_used = {};
+  if (m_pool == VK_NULL_HANDLE || cmd == VK_NULL_HANDLE) {
+    return;
+  }
+  vkCmdResetQueryPool(cmd, m_pool, 0, kQueryCount);
+  m_cmd = cmd;
+}
+
+void VkStageTimer::EndCommands() {
+  if (m_cmd == VK_NULL_HANDLE) {
+    return;
+  }
+  m_cmd = VK_NULL_HANDLE;
+  m_submitted = true;
+  m_anchorSec = DeadlineWaiter::Now();
+}
+
+void VkStageTimer::BeginStage(PipelineStage stage) {
+  if (m_cmd == VK_NULL_HANDLE) {
+    return;
+  }
+  const uint32_t index = 2 * static_cast<uint32_t>(stage);
+  vkCmdWriteTimestamp(m_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_pool, index);
+  m_used[static_cast<int>(stage)] = true;
+}
+
+void VkStageTimer::EndStage(PipelineStage stage) {
+  if (m_cmd == VK_NULL_HANDLE || !m_used[static_cast<int>(stage)]) {
+    return;
+  }
+  const uint32_t index = 2 * static_cast<uint32_t>(stage) + 1;
+  vkCmdWriteTimestamp(m_cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_pool, index);
+}
+
+void VkStageTimer::Resolve() {
+  if (!m_submitted) {
+    return;
+  }
+  m_submitted = false;
+  if (std::none_of(m_used.begin(), m_used.end(), [](bool used) { return used; })) {
+    return;   // timing off: nothing was written
+  }
+
+  std::array<uint64_t, kQueryCount> ticks = {};
+  // The fence has signalled, so every written query is available; no WAIT.
+  // Stages not recorded this submit stay unavailable and make the call
+  // return VK_NOT_READY, but the written ones are still returned.
+  VkResult result = vkGetQueryPoolResults(m_device, m_pool, 0, kQueryCount, sizeof(ticks), ticks.data(),
+                                          sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+  if (result != VK_SUCCESS && result != VK_NOT_READY) {
+    return;
+  }
+
+  uint64_t origin = 0;
+  bool haveOrigin = false;
+  for (int stage = 0; stage < kPipelineStageCount; ++stage) {
+    if (m_used[stage] && (!haveOrigin || (ticks[2 * stage] & m_validMask) < origin)) {
+      origin = ticks[2 * stage] & m_validMask;
+      haveOrigin = true;
+    }
+  }
+  for (int stage = 0; stage < kPipelineStageCount; ++stage) {
+    if (!m_used[stage]) {
+      continue;
+    }
+    const uint64_t begin = ticks[2 * stage] & m_validMask;
+    const uint64_t end = ticks[2 * stage + 1] & m_validMask;
+    if (end < begin) {
+      continue;
+    }
+    StageSample sample;
+    sample.frame = m_frame;
+    sample.beginSec = m_anchorSec + static_cast<double>(begin - origin) * m_periodSec;
+    sample.endSec = m_anchorSec + static_cast<double>(end - origin) * m_periodSec;
+    sample.stage = static_cast<PipelineStage>(stage);
+    sample.domain = TimingDomain::Gpu;
+    m_resolved.push_back(sample);
+  }
+}
+
+void VkStageTimer::Collect(StageTimeline& timeline) {
+  for (const StageSample& sample : m_resolved) {
+    timeline.Push(sample);
+  }
+  m_resolved.clear();
+}
+#endif
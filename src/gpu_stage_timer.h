@@ -0,0 +1,90 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+
+#include <array>
+#include <vector>
+
+#ifdef USE_VULKAN
+#include <vulkan/vulkan.h>
+#endif
+
+#include "stage_timer.h"
+
+// D3D11 timestamp queries per stage. A frame's queries are read back without
+// flushing once the GPU has passed them, usually 1-3 frames later; a frame
+// that would reuse a query set still in flight is skipped rather than
+// stalling on it.
+class D3D11StageTimer : public GpuStageTimer {
+public:
+  void Initialize(ID3D11Device* device, ID3D11DeviceContext* context);
+
+  void BeginFrame(uint64_t frame, double cpuSec) override;
+  void EndFrame() override;
+  void BeginStage(PipelineStage stage) override;
+  void EndStage(PipelineStage stage) override;
+  void Collect(StageTimeline& timeline) override;
+
+private:
+  struct StageQueries {
+    Microsoft::WRL::ComPtr<ID3D11Query> begin;
+    Microsoft::WRL::ComPtr<ID3D11Query> end;
+    bool used = false;
+  };
+  struct FrameQueries {
+    Microsoft::WRL::ComPtr<ID3D11Query> disjoint;
+    std::array<StageQueries, kPipelineStageCount> stages;
+    uint64_t frame = 0;
+    double cpuSec = 0.0;
+    bool pending = false;
+  };
+
+  static constexpr int kFramesInFlight = 4;
+
+  bool CreateStageQueries(StageQueries& queries);
+
+  Microsoft::WRL::ComPtr<ID3D11Device> m_device;
+  Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_context;
+  std::array<FrameQueries, kFramesInFlight> m_frames;
+  int m_write = 0;
+  bool m_active = false;   // the current frame has its disjoint query open
+};
+
+#ifdef USE_VULKAN
+// Vulkan timestamps written into the interpolator's command buffer. The
+// dispatch paths wait on their fence, so results are read straight after the
+// wait and handed to the timeline on the next Collect.
+class VkStageTimer : public GpuStageTimer {
+public:
+  bool Initialize(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily);
+  void Shutdown();
+
+  void BeginFrame(uint64_t frame, double cpuSec) override;
+  void EndFrame() override {}
+  void BeginStage(PipelineStage stage) override;
+  void EndStage(PipelineStage stage) override;
+  void Collect(StageTimeline& timeline) override;
+
+  // Bracket command recording: BeginCommands resets the queries in cmd,
+  // EndCommands (just before submit) anchors the GPU times on the CPU clock.
+  void BeginCommands(VkCommandBuffer cmd);
+  void EndCommands();
+  // Reads the timestamps of the last submit; call after its fence signalled.
+  void Resolve();
+
+private:
+  static constexpr uint32_t kQueryCount = 2 * kPipelineStageCount;
+
+  VkDevice m_device = VK_NULL_HANDLE;
+  VkQueryPool m_pool = VK_NULL_HANDLE;
+  VkCommandBuffer m_cmd = VK_NULL_HANDLE;
+  double m_periodSec = 0.0;       // seconds per timestamp tick
+  uint64_t m_validMask = 0;
+  uint64_t m_frame = 0;
+  double m_anchorSec = 0.0;
+  bool m_submitted = false;
+  std::array<bool, kPipelineStageCount> m_used = {};
+  std::vector<StageSample> m_resolved;
+};
+#endif
@@ -8,6 +8,8 @@
 #include <wrl/client.h>
 
 #include "../graphics_hook_info.h"
+#include "../pixel_convert.h"
+#include "../tile_delta.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -22,12 +24,12 @@ static HANDLE g_hHookReadyEvent = nullptr;
 static HANDLE g_hHookStopEvent = nullptr;
 static HANDLE g_hHookExitEvent = nullptr;
 static HANDLE g_hKeepAliveMutex = nullptr;
-static HANDLE g_hTextureMutex[NUM_BUFFERS] = {nullptr};
 static HANDLE g_hHookInfoMap = nullptr;
 static HANDLE g_hTextureMap = nullptr;
 
 static hook_info* g_hookInfo = nullptr;
-static shmem_data* g_shmemData = nullptr;
+static void* g_shmemView = nullptr;
+static SharedFrameRingWriter g_frameRing;
 static shtex_data* g_shtexData = nullptr;
 
 static ComPtr<ID3D11Device> g_device;
@@ -36,6 +38,11 @@ static ComPtr<IDXGISwapChain> g_swapChain; // Use ComPtr, but be careful about o
 
 static ComPtr<ID3D11Texture2D> g_captureTexture;
 static ComPtr<ID3D11Texture2D> g_stagingTextures[NUM_BUFFERS];
+static uint32_t g_stagingIndex = 0;
+#if SHMEM_TILE_DELTA
+static TileDeltaEncoder g_tileEncoder;
+#endif
+static PixelFormat g_lumaFormat = PixelFormat::Bgra8;
 static HANDLE g_sharedHandle = nullptr;
 
 static uint32_t g_cx = 0;
@@ -105,10 +112,23 @@ static HANDLE OpenNamedEvent(const wchar_t* baseName) {
     return OpenEventW(EVENT_ALL_ACCESS, FALSE, name);
 }
 
-static HANDLE CreateNamedMutex(const wchar_t* baseName) {
-    wchar_t name[128];
-    swprintf(name, 128, L"%s%lu", baseName, g_processId);
-    return CreateMutexW(nullptr, FALSE, name);
+static uint32_t FormatBytesPerPixel(DXGI_FORMAT format) {
+    switch (format) {
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+            return 8;
+        default:
+            return 4;
+    }
+}
+
+// Formats the CPU luma plane can be derived from.
+static bool LumaPixelFormat(DXGI_FORMAT format, PixelFormat* out) {
+    switch (format) {
+        case DXGI_FORMAT_B8G8R8A8_UNORM: *out = PixelFormat::Bgra8; return true;
+        case DXGI_FORMAT_R8G8B8A8_UNORM: *out = PixelFormat::Rgba8; return true;
+        default: return false;
+    }
 }
 
 static HANDLE CreateNamedFileMapping(const wchar_t* baseName, DWORD size) {
@@ -131,7 +151,7 @@ static bool InitSharedMemory() {
         return false;
     }
     
-    memset(g_hookInfo, 0, sizeof(hook_info));
+    memset(static_cast<void*>(g_hookInfo), 0, sizeof(hook_info));
     g_hookInfo->hook_ver_major = HOOK_VER_MAJOR;
     g_hookInfo->hook_ver_minor = HOOK_VER_MINOR;
     
@@ -219,30 +239,61 @@ static bool InitCaptureTextures() {
         g_hookInfo->pitch = g_cx * 4;
     }
     
-    // Create shared memory for pixel data
-    DWORD dataSize = g_hookInfo->pitch * g_cy;
-    DWORD mapSize = sizeof(shmem_data) + (dataSize * NUM_BUFFERS);
+    // Create the shared memory frame ring for pixel data. With tile deltas
+    // every slot also carries the per-tile stamp table.
+#if SHMEM_TILE_DELTA
+    uint32_t tileSize = TileDeltaEncoder::kTileSize;
+    uint64_t metaBytes = TileDeltaEncoder::StampTableBytes(g_cx, g_cy);
+#else
+    uint32_t tileSize = 0;
+    uint64_t metaBytes = 0;
+#endif
+    PixelFormat lumaFormat = PixelFormat::Bgra8;
+    uint32_t lumaPitch = 0;
+#if SHMEM_LUMA_PLANE
+    if (LumaPixelFormat(g_format, &lumaFormat)) {
+        lumaPitch = (uint32_t)shared_frame_ring::LumaPitch(g_cx);
+    }
+#endif
+    uint64_t mapSize = shared_frame_ring::MappingSize(SHMEM_RING_SLOTS, g_hookInfo->pitch, g_cy, metaBytes, lumaPitch);
+    if (mapSize > 0xFFFFFFFFull) {
+        Log("[Hook] Frame ring too large: %llu bytes\n", (unsigned long long)mapSize);
+        return false;
+    }
     
-    g_hTextureMap = CreateNamedFileMapping(SHMEM_TEXTURE, mapSize);
+    g_hTextureMap = CreateNamedFileMapping(SHMEM_TEXTURE, (DWORD)mapSize);
     if (!g_hTextureMap) {
         Log("[Hook] Failed to create texture mapping\n");
         return false;
     }
     
-    g_shmemData = (shmem_data*)MapViewOfFile(g_hTextureMap, FILE_MAP_ALL_ACCESS, 0, 0, mapSize);
-    if (!g_shmemData) {
+    g_shmemView = MapViewOfFile(g_hTextureMap, FILE_MAP_ALL_ACCESS, 0, 0, (SIZE_T)mapSize);
+    if (!g_shmemView) {
         Log("[Hook] Failed to map texture data\n");
         return false;
     }
     
-    g_shmemData->last_tex = -1;
-    g_shmemData->tex1_offset = sizeof(shmem_data);
-    g_shmemData->tex2_offset = sizeof(shmem_data) + dataSize;
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    if (!g_frameRing.Initialize(g_shmemView, mapSize, SHMEM_RING_SLOTS, g_cx, g_cy,
+                                g_hookInfo->pitch, (uint32_t)g_format, freq.QuadPart, tileSize, metaBytes,
+                                lumaPitch)) {
+        Log("[Hook] Failed to initialize frame ring\n");
+        return false;
+    }
+    g_stagingIndex = 0;
+#if SHMEM_TILE_DELTA
+    g_tileEncoder.Reset(g_cx, g_cy, FormatBytesPerPixel(g_format));
+    if (lumaPitch) {
+        g_tileEncoder.EnableLuma(lumaFormat);
+    }
+#endif
+    g_lumaFormat = lumaFormat;
     
     g_hookInfo->type = CAPTURE_TYPE_MEMORY;
     g_hookInfo->map_id = g_processId;
     
-    Log("[Hook] Using shared memory capture\n");
+    Log("[Hook] Using shared memory capture (%u slot ring)\n", SHMEM_RING_SLOTS);
     return true;
 }
 
@@ -309,9 +360,10 @@ static void FreeCapture() {
         g_stagingTextures[i].Reset();
     }
     
-    if (g_shmemData) {
-        UnmapViewOfFile(g_shmemData);
-        g_shmemData = nullptr;
+    g_frameRing.Reset();
+    if (g_shmemView) {
+        UnmapViewOfFile(g_shmemView);
+        g_shmemView = nullptr;
     }
     
     if (g_shtexData) {
@@ -363,36 +415,55 @@ static void CaptureFrame() {
     HRESULT hr = g_swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (void**)&backBuffer);
     if (FAILED(hr)) return;
     
+    // Present time of this frame; taken before the readback so the GPU
+    // copy and map stall do not skew the producer timestamps.
+    LARGE_INTEGER presentTime;
+    QueryPerformanceCounter(&presentTime);
+    
     if (g_useSharedTexture && g_captureTexture) {
         // Copy to shared texture
         g_context->CopyResource(g_captureTexture.Get(), backBuffer.Get());
-        g_hookInfo->frame_count++;
         
-        LARGE_INTEGER time;
-        QueryPerformanceCounter(&time);
-        g_hookInfo->frame_time = time.QuadPart;
-    } else if (g_shmemData) {
+        shared_frame_ring::PublishStamp(g_hookInfo->frame_stamp,
+                                        g_hookInfo->frame_stamp.frame.load(std::memory_order_relaxed) + 1,
+                                        presentTime.QuadPart);
+    } else if (g_frameRing.IsValid()) {
         // Copy to staging texture
-        int curTex = (g_shmemData->last_tex + 1) % NUM_BUFFERS;
-        
-        // Wait for mutex
-        if (g_hTextureMutex[curTex]) {
-            if (WaitForSingleObject(g_hTextureMutex[curTex], 0) != WAIT_OBJECT_0) {
-                // backBuffer auto-release
-                return;
-            }
-        }
+        uint32_t curTex = g_stagingIndex;
+        g_stagingIndex = (g_stagingIndex + 1) % NUM_BUFFERS;
         
         g_context->CopyResource(g_stagingTextures[curTex].Get(), backBuffer.Get());
         
-        // Map and copy to shared memory
+        // Map and copy into the next ring slot. The ring never blocks: if the
+        // reader is still copying this slot it detects the overwrite itself.
         D3D11_MAPPED_SUBRESOURCE mapped;
         hr = g_context->Map(g_stagingTextures[curTex].Get(), 0, D3D11_MAP_READ, 0, &mapped);
         if (SUCCEEDED(hr)) {
-            uint8_t* dest = (uint8_t*)g_shmemData;
-            dest += (curTex == 0) ? g_shmemData->tex1_offset : g_shmemData->tex2_offset;
+            uint8_t* dest = g_frameRing.BeginWrite();
             
-            if (mapped.RowPitch == g_hookInfo->pitch) {
+#if SHMEM_TILE_DELTA
+            // Only tiles that changed since the frame this slot last held
+            // are copied; the reader patches its texture from the stamps.
+            g_tileEncoder.Encode((const uint8_t*)mapped.pData, mapped.RowPitch, g_frameRing.NextFrame(),
+                                 dest, g_hookInfo->pitch, g_frameRing.PreviousSlotFrame(),
+                                 (uint64_t*)g_frameRing.SlotMeta(),
+                                 g_frameRing.SlotLuma(), g_frameRing.Header()->luma_pitch);
+#else
+            if (g_frameRing.SlotLuma()) {
+                // Copy with the fused half-res luma while rows are in cache
+                PixelConvertParams params;
+                params.srcFormat = g_lumaFormat;
+                params.dstFormat = g_lumaFormat;
+                params.width = g_cx;
+                params.height = g_cy;
+                params.src = mapped.pData;
+                params.srcPitch = mapped.RowPitch;
+                params.dst = dest;
+                params.dstPitch = g_hookInfo->pitch;
+                params.luma = g_frameRing.SlotLuma();
+                params.lumaPitch = g_frameRing.Header()->luma_pitch;
+                ConvertPixels(params);
+            } else if (mapped.RowPitch == g_hookInfo->pitch) {
                 memcpy(dest, mapped.pData, g_hookInfo->pitch * g_cy);
             } else {
                 // Row by row copy
@@ -404,18 +475,12 @@ static void CaptureFrame() {
                     src += mapped.RowPitch;
                 }
             }
+#endif
             
             g_context->Unmap(g_stagingTextures[curTex].Get(), 0);
-            g_shmemData->last_tex = curTex;
-            g_hookInfo->frame_count++;
             
-            LARGE_INTEGER time;
-            QueryPerformanceCounter(&time);
-            g_hookInfo->frame_time = time.QuadPart;
-        }
-        
-        if (g_hTextureMutex[curTex]) {
-            ReleaseMutex(g_hTextureMutex[curTex]);
+            const uint64_t frame = g_frameRing.EndWrite(presentTime.QuadPart);
+            shared_frame_ring::PublishStamp(g_hookInfo->frame_stamp, frame, presentTime.QuadPart);
         }
     }
 }
@@ -591,10 +656,6 @@ static DWORD WINAPI HookThread(LPVOID param) {
     g_hHookStopEvent = CreateNamedEvent(EVENT_CAPTURE_STOP);
     g_hHookExitEvent = CreateNamedEvent(EVENT_HOOK_EXIT);
     
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        g_hTextureMutex[i] = CreateNamedMutex((i == 0) ? MUTEX_TEXTURE1 : MUTEX_TEXTURE2);
-    }
-    
     // Wait for d3d11.dll to be loaded
     int waitCount = 0;
     while (!GetModuleHandleA("d3d11.dll") && waitCount < 100) {
@@ -668,13 +729,6 @@ static DWORD WINAPI HookThread(LPVOID param) {
         g_hHookInfoMap = nullptr;
     }
     
-    for (int i = 0; i < NUM_BUFFERS; i++) {
-        if (g_hTextureMutex[i]) {
-            CloseHandle(g_hTextureMutex[i]);
-            g_hTextureMutex[i] = nullptr;
-        }
-    }
-    
     if (g_hHookReadyEvent) CloseHandle(g_hHookReadyEvent);
     if (g_hHookStopEvent) CloseHandle(g_hHookStopEvent);
     if (g_hHookExitEvent) CloseHandle(g_hHookExitEvent);
@@ -4,6 +4,8 @@
 #include <windows.h>
 #include <dxgi.h>
 
+#include "shared_frame_ring.h"
+
 // Shared memory names
 #define SHMEM_HOOK_INFO      L"FrameGenHookInfo"
 #define SHMEM_TEXTURE        L"FrameGenTexture"
@@ -16,16 +18,25 @@
 #define EVENT_HOOK_INIT       L"FrameGenHookInit"
 
 // Mutex names
-#define MUTEX_TEXTURE1        L"FrameGenTexture1"
-#define MUTEX_TEXTURE2        L"FrameGenTexture2"
 #define WINDOW_HOOK_KEEPALIVE L"FrameGenKeepAlive"
 
 // Pipe name for logging
 #define PIPE_NAME             "FrameGenPipe"
 
-// Number of texture buffers for double/triple buffering
+// Number of staging textures used for the shared memory readback
 #define NUM_BUFFERS 2
 
+// Slots in the shared memory frame ring (see shared_frame_ring.h)
+#define SHMEM_RING_SLOTS 3
+
+// Shared memory frames are written as 64x64 tile deltas against what the
+// ring slot already holds (see tile_delta.h). 0 writes every frame in full.
+#define SHMEM_TILE_DELTA 1
+
+// 8-bit shared memory frames also carry a half-resolution luma plane that
+// the interpolator starts its feature pyramid from. 0 disables it.
+#define SHMEM_LUMA_PLANE 1
+
 // Capture type
 enum capture_type {
     CAPTURE_TYPE_MEMORY,   // Shared memory (slower but compatible)
@@ -62,11 +73,9 @@ struct hook_info {
     // Current texture index (for double buffering)
     volatile uint32_t cur_tex;
     
-    // Frame number
-    volatile uint64_t frame_count;
-    
-    // Timing
-    volatile int64_t frame_time;
+    // Latest published frame number and its present time (QPC ticks), under
+    // the same seqlock as a ring slot; see shared_frame_ring::PublishStamp.
+    shared_frame_slot frame_stamp;
     
     // Configuration
     uint32_t force_shmem : 1;
@@ -91,20 +100,13 @@ struct hook_info {
     struct graphics_offsets offsets;
 };
 
-// Shared memory texture data
-struct shmem_data {
-    volatile int last_tex;
-    uint32_t tex1_offset;
-    uint32_t tex2_offset;
-};
-
 // Shared texture data
 struct shtex_data {
     uint64_t tex_handle;
 };
 
 // Hook version
-#define HOOK_VER_MAJOR 1
+#define HOOK_VER_MAJOR 3
 #define HOOK_VER_MINOR 0
 
 // Mapping flags
@@ -14,12 +14,19 @@
 // ============================================================================
 
 #include "interpolator.h"
+#include "async_log.h"
+#include "flow_io.h"
+#include "motion_model.h"
+#include "pixel_convert.h"
 #include "shader_utils.h"
 
 #include <windows.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 
 #ifdef USE_VULKAN
@@ -67,7 +74,8 @@ struct InterpConstants {
   float _reserved2       = 0.0f;
   float _reserved3       = 0.0f;
   float motionSampleScale = 2.0f;
-  float pad[3]           = {};
+  float motionUvScale[2] = {1.0f, 1.0f};   // viewport / allocation of the working set
+  float pad              = 0.0f;
 };
 
 struct DebugConstants {
@@ -75,6 +83,8 @@ struct DebugConstants {
   float motionScale = 0.03f;
   float diffScale   = 2.0f;
   float pad         = 0.0f;
+  float motionUvScale[2] = {1.0f, 1.0f};
+  float pad2[2]     = {};
 };
 
 // IFNet-Lite + FusionNet-Lite weights - matches HLSL cbuffer AttentionWeightsCB
@@ -107,6 +117,48 @@ UINT DivUp(int size) {
   return static_cast<UINT>((size + 15) / 16);
 }
 
+ResourceFormat ToResourceFormat(DXGI_FORMAT format) {
+  switch (format) {
+    case DXGI_FORMAT_R16G16_FLOAT:
+      return ResourceFormat::Rg16Float;
+    case DXGI_FORMAT_R16_FLOAT:
+      return ResourceFormat::R16Float;
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+      return ResourceFormat::Bgra8Unorm;
+    default:
+      return ResourceFormat::Rgba16Float;
+  }
+}
+
+// Texture with a UAV and, with shaderResource, an SRV. Any failure releases
+// what was created.
+bool CreateComputeTexture(ID3D11Device* device, int w, int h, DXGI_FORMAT fmt, bool shaderResource,
+                          Microsoft::WRL::ComPtr<ID3D11Texture2D>& tex,
+                          Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv,
+                          Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView>& uav) {
+  if (!device || w <= 0 || h <= 0) return false;
+  D3D11_TEXTURE2D_DESC desc = {};
+  desc.Width      = static_cast<UINT>(w);
+  desc.Height     = static_cast<UINT>(h);
+  desc.MipLevels  = 1;
+  desc.ArraySize  = 1;
+  desc.Format     = fmt;
+  desc.SampleDesc.Count = 1;
+  desc.Usage      = D3D11_USAGE_DEFAULT;
+  desc.BindFlags  = D3D11_BIND_UNORDERED_ACCESS | (shaderResource ? D3D11_BIND_SHADER_RESOURCE : 0);
+  if (FAILED(device->CreateTexture2D(&desc, nullptr, &tex))) return false;
+  if (shaderResource && FAILED(device->CreateShaderResourceView(tex.Get(), nullptr, &srv))) {
+    tex.Reset();
+    return false;
+  }
+  if (FAILED(device->CreateUnorderedAccessView(tex.Get(), nullptr, &uav))) {
+    tex.Reset();
+    srv.Reset();
+    return false;
+  }
+  return true;
+}
+
 }  // namespace
 
 // -----------------------------------------------------------------------
@@ -130,22 +182,23 @@ void Interpolator::ClearCS(int srvCount, int uavCount) {
 // Initialization
 // -----------------------------------------------------------------------
 bool Interpolator::Initialize(ID3D11Device* device, ID3D11DeviceContext* context) {
-  std::ofstream log("init_log.txt", std::ios::app);
-  log << "Interpolator::Initialize started\n";
+  TFE_LOG(Info, Init, "Interpolator::Initialize started");
 
   if (!device || !context) {
-    log << "Error: device or context is null\n";
+    TFE_LOG(Error, Init, "Interpolator: device or context is null");
     return false;
   }
 
   m_device  = device;
   m_context = context;
+  m_d3dStageTimer.Initialize(device, context);
+  m_stageProfiler.AddGpuTimer(&m_d3dStageTimer);
 
   if (!LoadShaders()) {
-    log << "LoadShaders failed\n";
+    TFE_LOG(Error, Init, "LoadShaders failed");
     return false;
   }
-  log << "LoadShaders succeeded\n";
+  TFE_LOG(Info, Init, "LoadShaders succeeded");
 
   // Create constant buffers
   auto makeCB = [&](UINT size, Microsoft::WRL::ComPtr<ID3D11Buffer>& buf, const char* name) -> bool {
@@ -154,7 +207,7 @@ bool Interpolator::Initialize(ID3D11Device* device, ID3D11DeviceContext* context
     desc.ByteWidth = size;
     desc.Usage     = D3D11_USAGE_DEFAULT;
     if (FAILED(m_device->CreateBuffer(&desc, nullptr, &buf))) {
-      log << "Failed to create " << name << " buffer\n";
+      TFE_LOG(Error, Init, "Failed to create {} buffer", name);
       return false;
     }
     return true;
@@ -175,29 +228,29 @@ bool Interpolator::Initialize(ID3D11Device* device, ID3D11DeviceContext* context
   samplerDesc.MinLOD   = 0;
   samplerDesc.MaxLOD   = D3D11_FLOAT32_MAX;
   if (FAILED(m_device->CreateSamplerState(&samplerDesc, &m_linearSampler))) {
-    log << "Failed to create SamplerState\n";
+    TFE_LOG(Error, Init, "Failed to create SamplerState");
     return false;
   }
 
-  log << "Interpolator::Initialize succeeded\n";
+  TFE_LOG(Info, Init, "Interpolator::Initialize succeeded");
 
 #ifdef USE_VULKAN
   // Try loading Vulkan compute shaders (non-fatal if fails)
-  {
-    std::ofstream vklog("vulkan_debug.txt", std::ios::app);
-    vklog << "LoadVulkanShaders ENTER\n";
-    vklog.flush();
-  }
+  TFE_LOG(Info, Vulkan, "LoadVulkanShaders ENTER");
   if (LoadVulkanShaders()) {
     m_useVulkan = true;
-    std::ofstream vklog("vulkan_debug.txt", std::ios::app);
-    vklog << "After Vulkan check, m_useVulkan=1\n";
-    vklog.flush();
+    if (m_vkStageTimer.Initialize(m_renderDevice->GetVkDevice(), m_renderDevice->GetVkPhysicalDevice(),
+                                  m_renderDevice->GetVkComputeQueueFamily())) {
+      m_stageProfiler.AddGpuTimer(&m_vkStageTimer);
+    }
+    TFE_LOG(Info, Vulkan, "After Vulkan check, m_useVulkan=1");
   } else {
     m_useVulkan = false;
-    std::ofstream vklog("vulkan_debug.txt", std::ios::app);
-    vklog << "LoadVulkanShaders failed, falling back to D3D11 compute\n";
-    vklog.flush();
+    TFE_LOG(Warn, Vulkan, "LoadVulkanShaders failed, falling back to D3D11 compute");
+  }
+  // The Vulkan shaders and shared images are sized to the input exactly.
+  if (m_useVulkan) {
+    m_bucketPool.SetPolicy(ResolutionBucketPolicy::Exact());
   }
 #endif
 
@@ -213,22 +266,25 @@ bool Interpolator::Resize(int inputWidth, int inputHeight, int outputWidth, int
 
   m_inputWidth  = inputWidth;
   m_inputHeight = inputHeight;
-  m_outputWidth  = outputWidth;
-  m_outputHeight = outputHeight;
-
-  // Half resolution luma
-  m_lumaWidth  = (inputWidth  + 1) / 2;
-  m_lumaHeight = (inputHeight + 1) / 2;
-
-  // Quarter resolution
-  m_smallWidth  = std::max(1, (m_lumaWidth  + 1) / 2);
-  m_smallHeight = std::max(1, (m_lumaHeight + 1) / 2);
+  if (outputWidth != m_outputWidth || outputHeight != m_outputHeight || !m_outputTexture) {
+    m_outputWidth  = outputWidth;
+    m_outputHeight = outputHeight;
+    CreateOutputTexture();
+  }
 
-  // Eighth resolution
-  m_tinyWidth  = std::max(1, (m_smallWidth  + 1) / 2);
-  m_tinyHeight = std::max(1, (m_smallHeight + 1) / 2);
+  // The pyramid, motion and attention levels are sized from the working
+  // set's allocation (see AdoptWorkingSet). A size it still holds only
+  // moves the viewport, but the motion and priors of the old size are stale.
+  m_motionCache.Invalidate();
+  ResetAttentionPriors();
+  StartWorkingSet(m_bucketPool.Request(inputWidth, inputHeight));
+  PlanFrameGraph();
 
-  CreateResources();
+#ifdef USE_VULKAN
+  if (m_useVulkan) {
+    CreateVulkanResources();
+  }
+#endif
   return true;
 }
 
@@ -241,31 +297,93 @@ void Interpolator::Execute(
     float alpha,
     ID3D11ShaderResourceView* /*prevDepth*/,
     ID3D11ShaderResourceView* /*currDepth*/) {
-  if (!prev || !curr || !m_outputUav) return;
-  if (m_outputWidth <= 0 || m_outputHeight <= 0 || m_lumaWidth <= 0 || m_lumaHeight <= 0)
+  if (!PollWorkingSet(curr)) return;
+  StageFrameScope frame(m_stageProfiler);
+  // Uncached execution: the working motion no longer matches any key.
+  m_motionCache.ClearActive();
+  RunExecute(prev, curr, alpha);
+}
+
+// -----------------------------------------------------------------------
+// ExecuteCached: Execute keyed by frame content (see MotionSetCache)
+// -----------------------------------------------------------------------
+void Interpolator::ExecuteCached(
+    ID3D11ShaderResourceView* prev,
+    ID3D11ShaderResourceView* curr,
+    float alpha,
+    MotionSetKey key) {
+  if (!PollWorkingSet(curr)) return;
+  StageFrameScope frame(m_stageProfiler);
+  key.settings = MotionSettingsKey();
+  m_motionCache.RecordRequest();
+
+  if (m_motionCache.IsActive(key)) {
+    m_motionCache.RecordActiveReuse();
+    InterpolateOnly(prev, curr, alpha);
     return;
+  }
+
+  bool usable = MotionCacheUsable();
+  if (usable) {
+    int slot = m_motionCache.Find(key);
+    if (slot >= 0 && RestoreMotionSet(slot, prev, curr)) {
+      m_motionCache.RecordRestore();
+      m_motionCache.SetActive(key);
+      InterpolateOnly(prev, curr, alpha);
+      return;
+    }
+    if (slot >= 0) {
+      m_motionCache.Erase(slot);
+    }
+  }
+
+  m_motionCache.ClearActive();
+  if (!RunExecute(prev, curr, alpha)) return;
+  m_motionCache.RecordCompute();
+  m_motionCache.SetActive(key);
+
+  if (usable) {
+    int slot = m_motionCache.Insert(key);
+    if (!StoreMotionSet(slot)) {
+      m_motionCache.Erase(slot);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------
+// RunExecute: motion estimation + interpolation; false if nothing ran
+// -----------------------------------------------------------------------
+bool Interpolator::RunExecute(
+    ID3D11ShaderResourceView* prev,
+    ID3D11ShaderResourceView* curr,
+    float alpha) {
+  if (!prev || !curr || !m_outputUav) return false;
+  if (m_outputWidth <= 0 || m_outputHeight <= 0 || m_lumaWidth <= 0 || m_lumaHeight <= 0)
+    return false;
 
   if (!m_downsampleCs || !m_downsampleLumaCs || !m_motionCs ||
       !m_motionRefineCs || !m_motionSmoothCs || !m_interpolateCs)
-    return;
+    return false;
+
+  StageScope total(m_stageProfiler, PipelineStage::Execute, &m_d3dStageTimer);
 
 #ifdef USE_VULKAN
   // Full Vulkan PWC-Net pipeline: downsample → cost_volume → flow_decoder → interpolate
   if (m_useVulkan && !m_useMinimalMotionPipeline && m_vkResCreated && m_vkFullPipeline) {
     if (VulkanFullDispatch(prev, curr, std::clamp(alpha, 0.0f, 1.0f))) {
-      return;
+      return true;
     }
   }
 #endif
 
   // --- Compute motion field (D3D11 — battle-tested pipeline) ---
-  if (!ComputeMotion(prev, curr)) return;
+  if (!ComputeMotion(prev, curr)) return false;
 
 #ifdef USE_VULKAN
   // Hybrid fallback: D3D11 motion + Vulkan interpolation
   if (m_useVulkan && !m_useMinimalMotionPipeline && m_vkResCreated) {
     if (VulkanDispatchInterpolate(prev, curr, std::clamp(alpha, 0.0f, 1.0f))) {
-      return;
+      return true;
     }
   }
 #endif
@@ -283,11 +401,14 @@ void Interpolator::Execute(
   ic._reserved2 = 0.0f;
   ic._reserved3 = 0.0f;
 
+  // Motion is in texels of its level; the levels halve the allocation.
   if (m_useMinimalMotionPipeline && m_tinyWidth > 0) {
-    ic.motionSampleScale = static_cast<float>(m_inputWidth) / static_cast<float>(m_tinyWidth);
+    ic.motionSampleScale = static_cast<float>(m_poolWidth) / static_cast<float>(m_tinyWidth);
   } else {
-    ic.motionSampleScale = static_cast<float>(m_inputWidth) / static_cast<float>(m_lumaWidth);
+    ic.motionSampleScale = static_cast<float>(m_poolWidth) / static_cast<float>(m_lumaWidth);
   }
+  ic.motionUvScale[0] = static_cast<float>(m_inputWidth) / static_cast<float>(m_poolWidth);
+  ic.motionUvScale[1] = static_cast<float>(m_inputHeight) / static_cast<float>(m_poolHeight);
   m_context->UpdateSubresource(m_interpConstants.Get(), 0, nullptr, &ic, 0, 0);
 
   // Select motion/confidence SRVs based on pipeline mode
@@ -327,6 +448,7 @@ void Interpolator::Execute(
   ID3D11Buffer* cbs[] = {m_interpConstants.Get(), m_attentionWeights.Get()};
   ID3D11SamplerState* samplers[] = {m_linearSampler.Get()};
 
+  StageScope stage(m_stageProfiler, PipelineStage::Interpolate, &m_d3dStageTimer);
   m_context->CSSetShader(m_interpolateCs.Get(), nullptr, 0);
   m_context->CSSetShaderResources(0, 12, srvs);
   m_context->CSSetUnorderedAccessViews(0, 1, uavs, nullptr);
@@ -334,6 +456,7 @@ void Interpolator::Execute(
   m_context->CSSetSamplers(0, 1, samplers);
   Dispatch(m_outputWidth, m_outputHeight);
   ClearCS(12, 1);
+  return true;
 }
 
 // -----------------------------------------------------------------------
@@ -347,6 +470,10 @@ void Interpolator::InterpolateOnly(
     float alpha) {
   if (!prev || !curr || !m_outputUav || !m_interpolateCs) return;
   if (m_outputWidth <= 0 || m_outputHeight <= 0) return;
+  if (!PollWorkingSet(curr)) return;
+
+  StageFrameScope frame(m_stageProfiler);
+  StageScope total(m_stageProfiler, PipelineStage::InterpolateOnly, &m_d3dStageTimer);
 
 #ifdef USE_VULKAN
   // Fast Vulkan re-warp: shared textures already have correct data from
@@ -368,11 +495,14 @@ void Interpolator::InterpolateOnly(
   ic._reserved1 = 0.0f;
   ic._reserved2 = 0.0f;
   ic._reserved3 = 0.0f;
+  // Motion is in texels of its level; the levels halve the allocation.
   if (m_useMinimalMotionPipeline && m_tinyWidth > 0) {
-    ic.motionSampleScale = static_cast<float>(m_inputWidth) / static_cast<float>(m_tinyWidth);
+    ic.motionSampleScale = static_cast<float>(m_poolWidth) / static_cast<float>(m_tinyWidth);
   } else {
-    ic.motionSampleScale = static_cast<float>(m_inputWidth) / static_cast<float>(m_lumaWidth);
+    ic.motionSampleScale = static_cast<float>(m_poolWidth) / static_cast<float>(m_lumaWidth);
   }
+  ic.motionUvScale[0] = static_cast<float>(m_inputWidth) / static_cast<float>(m_poolWidth);
+  ic.motionUvScale[1] = static_cast<float>(m_inputHeight) / static_cast<float>(m_poolHeight);
   m_context->UpdateSubresource(m_interpConstants.Get(), 0, nullptr, &ic, 0, 0);
 
   // Select cached motion/confidence SRVs (same logic as Execute)
@@ -408,6 +538,7 @@ void Interpolator::InterpolateOnly(
   ID3D11Buffer* cbs[] = {m_interpConstants.Get(), m_attentionWeights.Get()};
   ID3D11SamplerState* samplers[] = {m_linearSampler.Get()};
 
+  StageScope stage(m_stageProfiler, PipelineStage::Interpolate, &m_d3dStageTimer);
   m_context->CSSetShader(m_interpolateCs.Get(), nullptr, 0);
   m_context->CSSetShaderResources(0, 12, srvs);
   m_context->CSSetUnorderedAccessViews(0, 1, uavs, nullptr);
@@ -447,13 +578,17 @@ void Interpolator::Debug(
     float diffScale) {
   if (!prev || !curr || !m_outputUav || !m_debugCs || !m_debugConstants) return;
   if (m_outputWidth <= 0 || m_outputHeight <= 0 || m_lumaWidth <= 0 || m_lumaHeight <= 0) return;
+  if (!PollWorkingSet(curr)) return;
 
+  m_motionCache.ClearActive();
   if (!ComputeMotion(prev, curr)) return;
 
   DebugConstants dc = {};
   dc.mode        = static_cast<int>(mode);
   dc.motionScale = motionScale;
   dc.diffScale   = diffScale;
+  dc.motionUvScale[0] = static_cast<float>(m_inputWidth) / static_cast<float>(m_poolWidth);
+  dc.motionUvScale[1] = static_cast<float>(m_inputHeight) / static_cast<float>(m_poolHeight);
   m_context->UpdateSubresource(m_debugConstants.Get(), 0, nullptr, &dc, 0, 0);
 
   // Pick best motion SRVs
@@ -506,6 +641,8 @@ bool Interpolator::LoadShaders() {
 
   if (!loadCS(L"DownsampleLuma.hlsl",  m_downsampleCs))     return false;
   if (!loadCS(L"DownsampleLumaR.hlsl", m_downsampleLumaCs)) return false;
+  // Only used for frames that carry a producer luma plane.
+  if (!loadCS(L"DownsampleLumaP.hlsl", m_downsamplePlaneCs)) m_downsamplePlaneCs.Reset();
   if (!loadCS(L"MotionEst.hlsl",       m_motionCs))         return false;
   if (!loadCS(L"MotionRefine.hlsl",    m_motionRefineCs))   return false;
   if (!loadCS(L"MotionSmooth.hlsl",    m_motionSmoothCs))   return false;
@@ -518,181 +655,332 @@ bool Interpolator::LoadShaders() {
 }
 
 // -----------------------------------------------------------------------
-// CreateResources
+// Working set
 // -----------------------------------------------------------------------
-void Interpolator::CreateResources() {
-  {
-    std::ofstream vklog("vulkan_debug.txt", std::ios::app);
-    vklog << "CreateResources: START, m_useVulkan=" << m_useVulkan
-          << " outputW=" << m_outputWidth << " outputH=" << m_outputHeight
-          << " lumaW=" << m_lumaWidth << " lumaH=" << m_lumaHeight << "\n";
-    vklog.flush();
-  }
-
-  // Reset all textures
-  m_prevLuma.Reset(); m_prevLumaSrv.Reset(); m_prevLumaUav.Reset();
-  m_currLuma.Reset(); m_currLumaSrv.Reset(); m_currLumaUav.Reset();
-  m_prevLumaSmall.Reset(); m_prevLumaSmallSrv.Reset(); m_prevLumaSmallUav.Reset();
-  m_currLumaSmall.Reset(); m_currLumaSmallSrv.Reset(); m_currLumaSmallUav.Reset();
-  m_prevLumaTiny.Reset(); m_prevLumaTinySrv.Reset(); m_prevLumaTinyUav.Reset();
-  m_currLumaTiny.Reset(); m_currLumaTinySrv.Reset(); m_currLumaTinyUav.Reset();
-
-  m_prevFeature2.Reset(); m_prevFeature2Srv.Reset(); m_prevFeature2Uav.Reset();
-  m_currFeature2.Reset(); m_currFeature2Srv.Reset(); m_currFeature2Uav.Reset();
-  m_prevFeature2Small.Reset(); m_prevFeature2SmallSrv.Reset(); m_prevFeature2SmallUav.Reset();
-  m_currFeature2Small.Reset(); m_currFeature2SmallSrv.Reset(); m_currFeature2SmallUav.Reset();
-  m_prevFeature2Tiny.Reset(); m_prevFeature2TinySrv.Reset(); m_prevFeature2TinyUav.Reset();
-  m_currFeature2Tiny.Reset(); m_currFeature2TinySrv.Reset(); m_currFeature2TinyUav.Reset();
-
-  m_prevFeature3.Reset(); m_prevFeature3Srv.Reset(); m_prevFeature3Uav.Reset();
-  m_currFeature3.Reset(); m_currFeature3Srv.Reset(); m_currFeature3Uav.Reset();
-  m_prevFeature3Small.Reset(); m_prevFeature3SmallSrv.Reset(); m_prevFeature3SmallUav.Reset();
-  m_currFeature3Small.Reset(); m_currFeature3SmallSrv.Reset(); m_currFeature3SmallUav.Reset();
-  m_prevFeature3Tiny.Reset(); m_prevFeature3TinySrv.Reset(); m_prevFeature3TinyUav.Reset();
-  m_currFeature3Tiny.Reset(); m_currFeature3TinySrv.Reset(); m_currFeature3TinyUav.Reset();
-
-  m_motion.Reset(); m_motionSrv.Reset(); m_motionUav.Reset();
-  m_confidence.Reset(); m_confidenceSrv.Reset(); m_confidenceUav.Reset();
-  m_motionCoarse.Reset(); m_motionCoarseSrv.Reset(); m_motionCoarseUav.Reset();
-  m_motionTiny.Reset(); m_motionTinySrv.Reset(); m_motionTinyUav.Reset();
-  m_motionTinyBackward.Reset(); m_motionTinyBackwardSrv.Reset(); m_motionTinyBackwardUav.Reset();
-  m_confidenceTiny.Reset(); m_confidenceTinySrv.Reset(); m_confidenceTinyUav.Reset();
-  m_confidenceTinyBackward.Reset(); m_confidenceTinyBackwardSrv.Reset(); m_confidenceTinyBackwardUav.Reset();
-  m_confidenceCoarse.Reset(); m_confidenceCoarseSrv.Reset(); m_confidenceCoarseUav.Reset();
-  m_motionSmooth.Reset(); m_motionSmoothSrv.Reset(); m_motionSmoothUav.Reset();
-  m_confidenceSmooth.Reset(); m_confidenceSmoothSrv.Reset(); m_confidenceSmoothUav.Reset();
-  m_attnSmall1.Reset(); m_attnSmall1Uav.Reset();
-  m_attnSmall2.Reset(); m_attnSmall2Uav.Reset();
-  m_attnSmall3.Reset(); m_attnSmall3Uav.Reset();
-  m_attnFull1.Reset(); m_attnFull1Uav.Reset();
-  m_attnFull2.Reset(); m_attnFull2Uav.Reset();
-  m_attnFull3.Reset(); m_attnFull3Uav.Reset();
+const Interpolator::WorkingTexture Interpolator::kWorkingTextures[] = {
+    // Luma pyramid (4-channel CNN features)
+    {"prevLuma", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevLuma, &Interpolator::m_prevLumaSrv, &Interpolator::m_prevLumaUav},
+    {"currLuma", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currLuma, &Interpolator::m_currLumaSrv, &Interpolator::m_currLumaUav},
+    {"prevLumaSmall", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevLumaSmall, &Interpolator::m_prevLumaSmallSrv, &Interpolator::m_prevLumaSmallUav},
+    {"currLumaSmall", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currLumaSmall, &Interpolator::m_currLumaSmallSrv, &Interpolator::m_currLumaSmallUav},
+    {"prevLumaTiny", ResourceLevel::Eighth, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevLumaTiny, &Interpolator::m_prevLumaTinySrv, &Interpolator::m_prevLumaTinyUav},
+    {"currLumaTiny", ResourceLevel::Eighth, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currLumaTiny, &Interpolator::m_currLumaTinySrv, &Interpolator::m_currLumaTinyUav},
+    // Feature2 pyramid (Channels 5-8)
+    {"prevFeature2", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevFeature2, &Interpolator::m_prevFeature2Srv, &Interpolator::m_prevFeature2Uav},
+    {"currFeature2", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currFeature2, &Interpolator::m_currFeature2Srv, &Interpolator::m_currFeature2Uav},
+    {"prevFeature2Small", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevFeature2Small, &Interpolator::m_prevFeature2SmallSrv, &Interpolator::m_prevFeature2SmallUav},
+    {"currFeature2Small", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currFeature2Small, &Interpolator::m_currFeature2SmallSrv, &Interpolator::m_currFeature2SmallUav},
+    {"prevFeature2Tiny", ResourceLevel::Eighth, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevFeature2Tiny, &Interpolator::m_prevFeature2TinySrv, &Interpolator::m_prevFeature2TinyUav},
+    {"currFeature2Tiny", ResourceLevel::Eighth, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currFeature2Tiny, &Interpolator::m_currFeature2TinySrv, &Interpolator::m_currFeature2TinyUav},
+    // Feature3 pyramid (Channels 9-12)
+    {"prevFeature3", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevFeature3, &Interpolator::m_prevFeature3Srv, &Interpolator::m_prevFeature3Uav},
+    {"currFeature3", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currFeature3, &Interpolator::m_currFeature3Srv, &Interpolator::m_currFeature3Uav},
+    {"prevFeature3Small", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevFeature3Small, &Interpolator::m_prevFeature3SmallSrv, &Interpolator::m_prevFeature3SmallUav},
+    {"currFeature3Small", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currFeature3Small, &Interpolator::m_currFeature3SmallSrv, &Interpolator::m_currFeature3SmallUav},
+    {"prevFeature3Tiny", ResourceLevel::Eighth, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_prevFeature3Tiny, &Interpolator::m_prevFeature3TinySrv, &Interpolator::m_prevFeature3TinyUav},
+    {"currFeature3Tiny", ResourceLevel::Eighth, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_currFeature3Tiny, &Interpolator::m_currFeature3TinySrv, &Interpolator::m_currFeature3TinyUav},
+    // Motion fields
+    {"motion", ResourceLevel::Half, DXGI_FORMAT_R16G16_FLOAT,
+     &Interpolator::m_motion, &Interpolator::m_motionSrv, &Interpolator::m_motionUav},
+    {"confidence", ResourceLevel::Half, DXGI_FORMAT_R16_FLOAT,
+     &Interpolator::m_confidence, &Interpolator::m_confidenceSrv, &Interpolator::m_confidenceUav},
+    {"motionCoarse", ResourceLevel::Quarter, DXGI_FORMAT_R16G16_FLOAT,
+     &Interpolator::m_motionCoarse, &Interpolator::m_motionCoarseSrv, &Interpolator::m_motionCoarseUav},
+    {"confidenceCoarse", ResourceLevel::Quarter, DXGI_FORMAT_R16_FLOAT,
+     &Interpolator::m_confidenceCoarse, &Interpolator::m_confidenceCoarseSrv, &Interpolator::m_confidenceCoarseUav},
+    {"motionTiny", ResourceLevel::Eighth, DXGI_FORMAT_R16G16_FLOAT,
+     &Interpolator::m_motionTiny, &Interpolator::m_motionTinySrv, &Interpolator::m_motionTinyUav},
+    {"motionTinyBackward", ResourceLevel::Eighth, DXGI_FORMAT_R16G16_FLOAT,
+     &Interpolator::m_motionTinyBackward, &Interpolator::m_motionTinyBackwardSrv, &Interpolator::m_motionTinyBackwardUav},
+    {"confidenceTiny", ResourceLevel::Eighth, DXGI_FORMAT_R16_FLOAT,
+     &Interpolator::m_confidenceTiny, &Interpolator::m_confidenceTinySrv, &Interpolator::m_confidenceTinyUav},
+    {"confidenceTinyBackward", ResourceLevel::Eighth, DXGI_FORMAT_R16_FLOAT,
+     &Interpolator::m_confidenceTinyBackward, &Interpolator::m_confidenceTinyBackwardSrv, &Interpolator::m_confidenceTinyBackwardUav},
+    {"motionSmooth", ResourceLevel::Half, DXGI_FORMAT_R16G16_FLOAT,
+     &Interpolator::m_motionSmooth, &Interpolator::m_motionSmoothSrv, &Interpolator::m_motionSmoothUav},
+    {"confidenceSmooth", ResourceLevel::Half, DXGI_FORMAT_R16_FLOAT,
+     &Interpolator::m_confidenceSmooth, &Interpolator::m_confidenceSmoothSrv, &Interpolator::m_confidenceSmoothUav},
+    // Attention priors: writable state buffers (UAV-only), one float4 per feature set
+    {"attnSmall1", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_attnSmall1, nullptr, &Interpolator::m_attnSmall1Uav},
+    {"attnSmall2", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_attnSmall2, nullptr, &Interpolator::m_attnSmall2Uav},
+    {"attnSmall3", ResourceLevel::Quarter, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_attnSmall3, nullptr, &Interpolator::m_attnSmall3Uav},
+    {"attnFull1", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_attnFull1, nullptr, &Interpolator::m_attnFull1Uav},
+    {"attnFull2", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_attnFull2, nullptr, &Interpolator::m_attnFull2Uav},
+    {"attnFull3", ResourceLevel::Half, DXGI_FORMAT_R16G16B16A16_FLOAT,
+     &Interpolator::m_attnFull3, nullptr, &Interpolator::m_attnFull3Uav},
+};
 
-  m_outputTexture.Reset(); m_outputSrv.Reset(); m_outputUav.Reset();
+Interpolator::WorkingSet Interpolator::BuildWorkingSet(
+    Microsoft::WRL::ComPtr<ID3D11Device> device, int width, int height) {
+  WorkingSet set;
+  set.width = width;
+  set.height = height;
+  if (!device || width <= 0 || height <= 0) return set;
+
+  set.textures.reserve(std::size(kWorkingTextures));
+  for (const WorkingTexture& entry : kWorkingTextures) {
+    int w = 0, h = 0;
+    InterpolatorLevelSize(entry.level, width, height, 0, 0, w, h);
+    PoolTexture texture;
+    if (!CreateComputeTexture(device.Get(), w, h, entry.format, entry.srv != nullptr,
+                              texture.texture, texture.srv, texture.uav)) {
+      return set;
+    }
+    set.textures.push_back(std::move(texture));
+  }
+  set.complete = true;
+  return set;
+}
 
-  // Helper lambda to create texture + SRV + UAV
-  auto createTex = [&](int w, int h, DXGI_FORMAT fmt,
-                       Microsoft::WRL::ComPtr<ID3D11Texture2D>& tex,
-                       Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv,
-                       Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView>& uav) {
-    if (w <= 0 || h <= 0) return;
-    D3D11_TEXTURE2D_DESC desc = {};
-    desc.Width      = static_cast<UINT>(w);
-    desc.Height     = static_cast<UINT>(h);
-    desc.MipLevels  = 1;
-    desc.ArraySize  = 1;
-    desc.Format     = fmt;
-    desc.SampleDesc.Count = 1;
-    desc.Usage      = D3D11_USAGE_DEFAULT;
-    desc.BindFlags  = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS;
-    if (FAILED(m_device->CreateTexture2D(&desc, nullptr, &tex))) return;
-    if (FAILED(m_device->CreateShaderResourceView(tex.Get(), nullptr, &srv)))  { tex.Reset(); return; }
-    if (FAILED(m_device->CreateUnorderedAccessView(tex.Get(), nullptr, &uav))) { tex.Reset(); srv.Reset(); return; }
-  };
+void Interpolator::StartWorkingSet(BucketPlan plan, bool wait) {
+  while (plan.action != BucketAction::Reuse) {
+    // With a set in use, later ones build in the background. The first has
+    // nothing to serve frames meanwhile, and the Vulkan images (exact sizes)
+    // are rebuilt together with the set.
+    if (m_poolWidth > 0 && !m_useVulkan && !wait) {
+      m_pendingSet = std::async(std::launch::async, &Interpolator::BuildWorkingSet, m_device,
+                                plan.width, plan.height);
+      return;
+    }
+    WorkingSet set = BuildWorkingSet(m_device, plan.width, plan.height);
+    plan = m_bucketPool.Completed(AdoptWorkingSet(std::move(set)));
+  }
+}
 
-  auto createUavTex = [&](int w, int h, DXGI_FORMAT fmt,
-                          Microsoft::WRL::ComPtr<ID3D11Texture2D>& tex,
-                          Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView>& uav) {
-    if (w <= 0 || h <= 0) return;
-    D3D11_TEXTURE2D_DESC desc = {};
-    desc.Width = static_cast<UINT>(w);
-    desc.Height = static_cast<UINT>(h);
-    desc.MipLevels = 1;
-    desc.ArraySize = 1;
-    desc.Format = fmt;
-    desc.SampleDesc.Count = 1;
-    desc.Usage = D3D11_USAGE_DEFAULT;
-    desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
-    if (FAILED(m_device->CreateTexture2D(&desc, nullptr, &tex))) return;
-    if (FAILED(m_device->CreateUnorderedAccessView(tex.Get(), nullptr, &uav))) { tex.Reset(); return; }
-  };
+bool Interpolator::AdoptWorkingSet(WorkingSet&& set) {
+  if (!set.complete || set.textures.size() != std::size(kWorkingTextures)) {
+    TFE_LOG(Error, Init, "AdoptWorkingSet: working set {}x{} FAILED - one or more textures are null",
+            set.width, set.height);
+    return false;
+  }
 
-  // Luma pyramid (now storing 4-channel CNN features)
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevLuma, m_prevLumaSrv, m_prevLumaUav);
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currLuma, m_currLumaSrv, m_currLumaUav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevLumaSmall, m_prevLumaSmallSrv, m_prevLumaSmallUav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currLumaSmall, m_currLumaSmallSrv, m_currLumaSmallUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevLumaTiny, m_prevLumaTinySrv, m_prevLumaTinyUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currLumaTiny, m_currLumaTinySrv, m_currLumaTinyUav);
-
-  // Feature2 pyramid (Channels 5-8)
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevFeature2, m_prevFeature2Srv, m_prevFeature2Uav);
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currFeature2, m_currFeature2Srv, m_currFeature2Uav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevFeature2Small, m_prevFeature2SmallSrv, m_prevFeature2SmallUav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currFeature2Small, m_currFeature2SmallSrv, m_currFeature2SmallUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevFeature2Tiny, m_prevFeature2TinySrv, m_prevFeature2TinyUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currFeature2Tiny, m_currFeature2TinySrv, m_currFeature2TinyUav);
-
-  // Feature3 pyramid (Channels 9-12)
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevFeature3, m_prevFeature3Srv, m_prevFeature3Uav);
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currFeature3, m_currFeature3Srv, m_currFeature3Uav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevFeature3Small, m_prevFeature3SmallSrv, m_prevFeature3SmallUav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currFeature3Small, m_currFeature3SmallSrv, m_currFeature3SmallUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_prevFeature3Tiny, m_prevFeature3TinySrv, m_prevFeature3TinyUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_currFeature3Tiny, m_currFeature3TinySrv, m_currFeature3TinyUav);
-
-  // Motion fields
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16_FLOAT, m_motion, m_motionSrv, m_motionUav);
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16_FLOAT, m_confidence, m_confidenceSrv, m_confidenceUav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16_FLOAT, m_motionCoarse, m_motionCoarseSrv, m_motionCoarseUav);
-  createTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16_FLOAT, m_confidenceCoarse, m_confidenceCoarseSrv, m_confidenceCoarseUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16_FLOAT, m_motionTiny, m_motionTinySrv, m_motionTinyUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16G16_FLOAT, m_motionTinyBackward, m_motionTinyBackwardSrv, m_motionTinyBackwardUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16_FLOAT, m_confidenceTiny, m_confidenceTinySrv, m_confidenceTinyUav);
-  createTex(m_tinyWidth, m_tinyHeight, DXGI_FORMAT_R16_FLOAT, m_confidenceTinyBackward, m_confidenceTinyBackwardSrv, m_confidenceTinyBackwardUav);
-
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16_FLOAT, m_motionSmooth, m_motionSmoothSrv, m_motionSmoothUav);
-  createTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16_FLOAT, m_confidenceSmooth, m_confidenceSmoothSrv, m_confidenceSmoothUav);
-
-  // Attention priors are writable state buffers (UAV-only), one float4 per feature set
-  createUavTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_attnSmall1, m_attnSmall1Uav);
-  createUavTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_attnSmall2, m_attnSmall2Uav);
-  createUavTex(m_smallWidth, m_smallHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_attnSmall3, m_attnSmall3Uav);
-  createUavTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_attnFull1, m_attnFull1Uav);
-  createUavTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_attnFull2, m_attnFull2Uav);
-  createUavTex(m_lumaWidth, m_lumaHeight, DXGI_FORMAT_R16G16B16A16_FLOAT, m_attnFull3, m_attnFull3Uav);
-
-  if (m_context) {
-    const float baseW1[4] = {0.15f, 0.10f, 0.10f, 0.20f};
-    const float baseW2[4] = {0.10f, 0.10f, 0.15f, 0.10f};
-    const float baseW3[4] = {0.10f, 0.10f, 0.10f, 0.10f};
-    if (m_attnSmall1Uav) m_context->ClearUnorderedAccessViewFloat(m_attnSmall1Uav.Get(), baseW1);
-    if (m_attnSmall2Uav) m_context->ClearUnorderedAccessViewFloat(m_attnSmall2Uav.Get(), baseW2);
-    if (m_attnSmall3Uav) m_context->ClearUnorderedAccessViewFloat(m_attnSmall3Uav.Get(), baseW3);
-    if (m_attnFull1Uav) m_context->ClearUnorderedAccessViewFloat(m_attnFull1Uav.Get(), baseW1);
-    if (m_attnFull2Uav) m_context->ClearUnorderedAccessViewFloat(m_attnFull2Uav.Get(), baseW2);
-    if (m_attnFull3Uav) m_context->ClearUnorderedAccessViewFloat(m_attnFull3Uav.Get(), baseW3);
-  }
-
-  createTex(m_outputWidth, m_outputHeight, DXGI_FORMAT_B8G8R8A8_UNORM, m_outputTexture, m_outputSrv, m_outputUav);
-
-  // Validate critical resources
-  if (!m_outputTexture || !m_outputSrv || !m_outputUav ||
-      !m_prevLumaUav || !m_currLumaUav ||
-      !m_motionUav || !m_confidenceUav ||
-      !m_motionCoarseUav || !m_confidenceCoarseUav ||
-      !m_motionTinyUav || !m_motionTinyBackwardUav ||
-      !m_confidenceTinyUav || !m_confidenceTinyBackwardUav ||
-      !m_motionSmoothUav || !m_confidenceSmoothUav ||
-      !m_attnSmall1Uav || !m_attnSmall2Uav || !m_attnSmall3Uav ||
-      !m_attnFull1Uav || !m_attnFull2Uav || !m_attnFull3Uav) {
-    std::ofstream vklog("vulkan_debug.txt", std::ios::app);
-    vklog << "CreateResources: FAILED validation - one or more UAVs are null\n";
-    vklog.flush();
+  // The textures in use are released with their last reference; D3D11
+  // defers the memory until the GPU is done with them.
+  for (size_t i = 0; i < set.textures.size(); ++i) {
+    const WorkingTexture& entry = kWorkingTextures[i];
+    PoolTexture& texture = set.textures[i];
+    int w = 0, h = 0;
+    InterpolatorLevelSize(entry.level, set.width, set.height, 0, 0, w, h);
+    this->*entry.texture = std::move(texture.texture);
+    if (entry.srv) this->*entry.srv = std::move(texture.srv);
+    this->*entry.uav = std::move(texture.uav);
+    m_resources.Track(entry.name, w, h, ToResourceFormat(entry.format));
+  }
+
+  m_poolWidth  = set.width;
+  m_poolHeight = set.height;
+  InterpolatorLevelSize(ResourceLevel::Half, m_poolWidth, m_poolHeight, 0, 0, m_lumaWidth, m_lumaHeight);
+  InterpolatorLevelSize(ResourceLevel::Quarter, m_poolWidth, m_poolHeight, 0, 0, m_smallWidth, m_smallHeight);
+  InterpolatorLevelSize(ResourceLevel::Eighth, m_poolWidth, m_poolHeight, 0, 0, m_tinyWidth, m_tinyHeight);
+
+  // Snapshots are the size of the set they were taken from.
+  ResetMotionSets();
+  ResetAttentionPriors();
+  TFE_LOG(Info, Init, "AdoptWorkingSet: working set {}x{} for input {}x{}, luma={}x{}",
+          m_poolWidth, m_poolHeight, m_inputWidth, m_inputHeight, m_lumaWidth, m_lumaHeight);
+  PlanFrameGraph();
+  return true;
+}
+
+bool Interpolator::PollWorkingSet(ID3D11ShaderResourceView* curr) {
+  if (m_pendingSet.valid() &&
+      m_pendingSet.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+    StartWorkingSet(m_bucketPool.Completed(AdoptWorkingSet(m_pendingSet.get())));
+  }
+  if (!m_bucketPool.Serves() && m_pendingSet.valid() && m_bucketPool.ShouldWaitForBuild()) {
+    // Finish this build and any the input has outgrown since on this
+    // thread, so the input is held again before the next frame.
+    m_bucketPool.CountWaitedBuild();
+    StartWorkingSet(m_bucketPool.Completed(AdoptWorkingSet(m_pendingSet.get())), true);
+  }
+  if (m_bucketPool.Serves()) {
+    m_bucketPool.CountServed();
+    return true;
+  }
+  m_bucketPool.CountPassthrough();
+  Blit(curr);
+  return false;
+}
+
+void Interpolator::CreateOutputTexture() {
+  m_outputTexture.Reset(); m_outputSrv.Reset(); m_outputUav.Reset();
+  m_resources.Release("outputTexture");
+  if (!CreateComputeTexture(m_device.Get(), m_outputWidth, m_outputHeight, DXGI_FORMAT_B8G8R8A8_UNORM, true,
+                            m_outputTexture, m_outputSrv, m_outputUav)) {
+    TFE_LOG(Error, Init, "CreateOutputTexture: {}x{} FAILED", m_outputWidth, m_outputHeight);
     return;
   }
+  m_resources.Track("outputTexture", m_outputWidth, m_outputHeight, ResourceFormat::Bgra8Unorm);
+}
 
-  {
-    std::ofstream vklog("vulkan_debug.txt", std::ios::app);
-    vklog << "CreateResources: SUCCESS\n";
-    vklog.flush();
+void Interpolator::ResetAttentionPriors() {
+  if (!m_context) return;
+  const float baseW1[4] = {0.15f, 0.10f, 0.10f, 0.20f};
+  const float baseW2[4] = {0.10f, 0.10f, 0.15f, 0.10f};
+  const float baseW3[4] = {0.10f, 0.10f, 0.10f, 0.10f};
+  if (m_attnSmall1Uav) m_context->ClearUnorderedAccessViewFloat(m_attnSmall1Uav.Get(), baseW1);
+  if (m_attnSmall2Uav) m_context->ClearUnorderedAccessViewFloat(m_attnSmall2Uav.Get(), baseW2);
+  if (m_attnSmall3Uav) m_context->ClearUnorderedAccessViewFloat(m_attnSmall3Uav.Get(), baseW3);
+  if (m_attnFull1Uav) m_context->ClearUnorderedAccessViewFloat(m_attnFull1Uav.Get(), baseW1);
+  if (m_attnFull2Uav) m_context->ClearUnorderedAccessViewFloat(m_attnFull2Uav.Get(), baseW2);
+  if (m_attnFull3Uav) m_context->ClearUnorderedAccessViewFloat(m_attnFull3Uav.Get(), baseW3);
+}
+
+void Interpolator::ResetMotionSets() {
+  for (MotionSetTextures& set : m_motionSets) {
+    set = MotionSetTextures();
   }
+  m_resources.ReleaseGroup("motionSet.");
+  m_motionCache.Invalidate();
+}
+
+void Interpolator::PlanFrameGraph() {
+  // Planned for the allocation: passes cover the whole working set.
+  if (m_poolWidth <= 0 || m_poolHeight <= 0) {
+    m_frameGraph.Clear();
+    return;
+  }
+  if (!PlanInterpolatorFrameGraph(m_poolWidth, m_poolHeight, m_outputWidth, m_outputHeight,
+                                  m_useMinimalMotionPipeline, m_useVulkan, m_frameGraph)) {
+    TFE_LOG(Warn, Vulkan, "PlanFrameGraph: {}", m_frameGraph.GetLastError());
+  }
+}
+
+// -----------------------------------------------------------------------
+// DownsampleInputs: full -> half-res luma/features for both frames.
+// Shared by ComputeMotion and motion-set restore, since the interpolate
+// pass samples the half-res features of the current pair.
+// -----------------------------------------------------------------------
+void Interpolator::DownsampleInputs(
+    ID3D11ShaderResourceView* prev,
+    ID3D11ShaderResourceView* curr) {
+  StageScope stage(m_stageProfiler, PipelineStage::Downsample, &m_d3dStageTimer);
+  // Producer luma planes already hold the 2x2 BT.709 luma, so the pass
+  // reads a quarter-size R16 plane instead of the full color frame. Both
+  // frames of the pair take the same path.
+  const bool usePlane = UsesSourceLuma();
+  auto downsample = [&](ID3D11ShaderResourceView* color, ID3D11ShaderResourceView* plane,
+                        ID3D11UnorderedAccessView* luma, ID3D11UnorderedAccessView* f2,
+                        ID3D11UnorderedAccessView* f3) {
+    ID3D11ShaderResourceView* s[] = {usePlane ? plane : color};
+    ID3D11UnorderedAccessView* u[] = {luma, f2, f3};
+    m_context->CSSetShader(usePlane ? m_downsamplePlaneCs.Get() : m_downsampleCs.Get(), nullptr, 0);
+    m_context->CSSetShaderResources(0, 1, s);
+    m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
+    Dispatch(m_lumaWidth, m_lumaHeight);
+    ClearCS(1, 3);
+  };
+  // Full -> Half luma (prev)
+  downsample(prev, m_sourceLumaPrev.Get(), m_prevLumaUav.Get(), m_prevFeature2Uav.Get(), m_prevFeature3Uav.Get());
+  // Full -> Half luma (curr)
+  downsample(curr, m_sourceLumaCurr.Get(), m_currLumaUav.Get(), m_currFeature2Uav.Get(), m_currFeature3Uav.Get());
+}
+
+// -----------------------------------------------------------------------
+// Motion LRU
+// -----------------------------------------------------------------------
+uint64_t Interpolator::MotionSettingsKey() const {
+  // Everything that changes the motion result (not the warp).
+  uint64_t key = m_useMinimalMotionPipeline ? 1u : 0u;
+  key = key * 31u + static_cast<uint64_t>(std::clamp(m_motionModel, 0, 3));
+  key = key * 31u + (m_useCustomWeights ? 1u : 0u);
+  // The plane path's periodicity channel differs slightly (see
+  // DownsampleLumaP.hlsl), so motion from one path is not reused for the other.
+  key = key * 31u + (UsesSourceLuma() ? 1u : 0u);
+  uint32_t bits = 0;
+  std::memcpy(&bits, &m_smoothEdgeScale, sizeof(bits));
+  key = key * 1000003u + bits;
+  std::memcpy(&bits, &m_smoothConfPower, sizeof(bits));
+  key = key * 1000003u + bits;
+  return key;
+}
 
+bool Interpolator::MotionCacheUsable() const {
 #ifdef USE_VULKAN
-  if (m_useVulkan) {
-    CreateVulkanResources();
+  // The Vulkan paths keep their motion in shared images the snapshots do
+  // not cover; only active-pair reuse applies there.
+  if (m_useVulkan && !m_useMinimalMotionPipeline && m_vkResCreated) {
+    return false;
   }
 #endif
+  return true;
+}
+
+bool Interpolator::StoreMotionSet(int slot) {
+  if (slot < 0 || slot >= kMotionCacheSlots) return false;
+  MotionSetTextures& set = m_motionSets[slot];
+
+  // Snapshots mirror the working textures' descriptions, created on first use.
+  auto copyInto = [&](Microsoft::WRL::ComPtr<ID3D11Texture2D>& dst, ID3D11Texture2D* src, const char* name) {
+    if (!src) return false;
+    if (!dst) {
+      D3D11_TEXTURE2D_DESC desc = {};
+      src->GetDesc(&desc);
+      desc.BindFlags = 0;
+      if (FAILED(m_device->CreateTexture2D(&desc, nullptr, &dst))) return false;
+      m_resources.Track(std::string("motionSet.") + name + "#" + std::to_string(slot), static_cast<int>(desc.Width),
+                        static_cast<int>(desc.Height), ToResourceFormat(desc.Format));
+    }
+    m_context->CopyResource(dst.Get(), src);
+    return true;
+  };
+
+  if (m_useMinimalMotionPipeline) {
+    return copyInto(set.motionTiny, m_motionTiny.Get(), "motionTiny") &&
+           copyInto(set.confidenceTiny, m_confidenceTiny.Get(), "confidenceTiny") &&
+           copyInto(set.motionTinyBackward, m_motionTinyBackward.Get(), "motionTinyBackward") &&
+           copyInto(set.confidenceTinyBackward, m_confidenceTinyBackward.Get(), "confidenceTinyBackward");
+  }
+  return copyInto(set.motionSmooth, m_motionSmooth.Get(), "motionSmooth") &&
+         copyInto(set.confidenceSmooth, m_confidenceSmooth.Get(), "confidenceSmooth");
+}
+
+bool Interpolator::RestoreMotionSet(
+    int slot,
+    ID3D11ShaderResourceView* prev,
+    ID3D11ShaderResourceView* curr) {
+  if (slot < 0 || slot >= kMotionCacheSlots || !prev || !curr || !m_downsampleCs) return false;
+  const MotionSetTextures& set = m_motionSets[slot];
+
+  if (m_useMinimalMotionPipeline) {
+    if (!set.motionTiny || !set.confidenceTiny || !set.motionTinyBackward || !set.confidenceTinyBackward)
+      return false;
+    DownsampleInputs(prev, curr);
+    m_context->CopyResource(m_motionTiny.Get(), set.motionTiny.Get());
+    m_context->CopyResource(m_confidenceTiny.Get(), set.confidenceTiny.Get());
+    m_context->CopyResource(m_motionTinyBackward.Get(), set.motionTinyBackward.Get());
+    m_context->CopyResource(m_confidenceTinyBackward.Get(), set.confidenceTinyBackward.Get());
+    return true;
+  }
+
+  if (!set.motionSmooth || !set.confidenceSmooth) return false;
+  DownsampleInputs(prev, curr);
+  m_context->CopyResource(m_motionSmooth.Get(), set.motionSmooth.Get());
+  m_context->CopyResource(m_confidenceSmooth.Get(), set.confidenceSmooth.Get());
+  return true;
 }
 
 // -----------------------------------------------------------------------
@@ -719,106 +1007,65 @@ bool Interpolator::ComputeMotion(
   ID3D11SamplerState* samplers[] = {m_linearSampler.Get()};
 
   // Model-driven search radii
-  int model = std::clamp(m_motionModel, 0, 3);
-  int tinyRadiusFwd = 12, tinyRadiusBwd = 12;
-  int refineSmallR = 8, refineFullR = 6;
-  float attnLearnRate = 0.08f;
-  float attnPriorMix = 0.45f;
-  float attnStability = 0.35f;
-
-  if (m_useMinimalMotionPipeline) {
-    tinyRadiusFwd = 4; tinyRadiusBwd = 4;
-    attnLearnRate = 0.03f;
-    attnPriorMix = 0.30f;
-    attnStability = 0.65f;
-  } else if (model == 0) { // Adaptive
-    tinyRadiusFwd = 16; tinyRadiusBwd = 16; refineSmallR = 12; refineFullR = 8;
-    attnLearnRate = 0.09f;
-    attnPriorMix = 0.55f;
-    attnStability = 0.28f;
-  } else if (model == 1) { // Stable
-    tinyRadiusFwd = 8; tinyRadiusBwd = 8; refineSmallR = 6; refineFullR = 4;
-    attnLearnRate = 0.04f;
-    attnPriorMix = 0.65f;
-    attnStability = 0.70f;
-  } else if (model == 3) { // Coverage
-    tinyRadiusFwd = 24; tinyRadiusBwd = 24; refineSmallR = 16; refineFullR = 12;
-    attnLearnRate = 0.11f;
-    attnPriorMix = 0.40f;
-    attnStability = 0.22f;
-  }
+  const MotionSearchParams search = MotionSearchParamsFor(m_motionModel, m_useMinimalMotionPipeline);
 
   // =======================================================================
   // STAGE 1: DOWNSAMPLE PYRAMID
   // =======================================================================
 
-  // Full -> Half luma (prev)
-  {
-    ID3D11ShaderResourceView* s[] = {prev};
-    ID3D11UnorderedAccessView* u[] = {m_prevLumaUav.Get(), m_prevFeature2Uav.Get(), m_prevFeature3Uav.Get()};
-    m_context->CSSetShader(m_downsampleCs.Get(), nullptr, 0);
-    m_context->CSSetShaderResources(0, 1, s);
-    m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
-    Dispatch(m_lumaWidth, m_lumaHeight);
-    ClearCS(1, 3);
-  }
-  // Full -> Half luma (curr)
-  {
-    ID3D11ShaderResourceView* s[] = {curr};
-    ID3D11UnorderedAccessView* u[] = {m_currLumaUav.Get(), m_currFeature2Uav.Get(), m_currFeature3Uav.Get()};
-    m_context->CSSetShader(m_downsampleCs.Get(), nullptr, 0);
-    m_context->CSSetShaderResources(0, 1, s);
-    m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
-    Dispatch(m_lumaWidth, m_lumaHeight);
-    ClearCS(1, 3);
-  }
-  // Half -> Quarter (prev)
-  {
-    ID3D11ShaderResourceView* s[] = {m_prevLumaSrv.Get(), m_prevFeature2Srv.Get(), m_prevFeature3Srv.Get()};
-    ID3D11UnorderedAccessView* u[] = {m_prevLumaSmallUav.Get(), m_prevFeature2SmallUav.Get(), m_prevFeature3SmallUav.Get()};
-    m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
-    m_context->CSSetShaderResources(0, 3, s);
-    m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
-    Dispatch(m_smallWidth, m_smallHeight);
-    ClearCS(3, 3);
-  }
-  // Half -> Quarter (curr)
-  {
-    ID3D11ShaderResourceView* s[] = {m_currLumaSrv.Get(), m_currFeature2Srv.Get(), m_currFeature3Srv.Get()};
-    ID3D11UnorderedAccessView* u[] = {m_currLumaSmallUav.Get(), m_currFeature2SmallUav.Get(), m_currFeature3SmallUav.Get()};
-    m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
-    m_context->CSSetShaderResources(0, 3, s);
-    m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
-    Dispatch(m_smallWidth, m_smallHeight);
-    ClearCS(3, 3);
-  }
-  // Quarter -> Eighth (prev)
-  {
-    ID3D11ShaderResourceView* s[] = {m_prevLumaSmallSrv.Get(), m_prevFeature2SmallSrv.Get(), m_prevFeature3SmallSrv.Get()};
-    ID3D11UnorderedAccessView* u[] = {m_prevLumaTinyUav.Get(), m_prevFeature2TinyUav.Get(), m_prevFeature3TinyUav.Get()};
-    m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
-    m_context->CSSetShaderResources(0, 3, s);
-    m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
-    Dispatch(m_tinyWidth, m_tinyHeight);
-    ClearCS(3, 3);
-  }
-  // Quarter -> Eighth (curr)
+  // Full -> Half luma (prev, curr)
+  DownsampleInputs(prev, curr);
   {
-    ID3D11ShaderResourceView* s[] = {m_currLumaSmallSrv.Get(), m_currFeature2SmallSrv.Get(), m_currFeature3SmallSrv.Get()};
-    ID3D11UnorderedAccessView* u[] = {m_currLumaTinyUav.Get(), m_currFeature2TinyUav.Get(), m_currFeature3TinyUav.Get()};
-    m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
-    m_context->CSSetShaderResources(0, 3, s);
-    m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
-    Dispatch(m_tinyWidth, m_tinyHeight);
-    ClearCS(3, 3);
+    StageScope stage(m_stageProfiler, PipelineStage::Pyramid, &m_d3dStageTimer);
+    // Half -> Quarter (prev)
+    {
+      ID3D11ShaderResourceView* s[] = {m_prevLumaSrv.Get(), m_prevFeature2Srv.Get(), m_prevFeature3Srv.Get()};
+      ID3D11UnorderedAccessView* u[] = {m_prevLumaSmallUav.Get(), m_prevFeature2SmallUav.Get(), m_prevFeature3SmallUav.Get()};
+      m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
+      m_context->CSSetShaderResources(0, 3, s);
+      m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
+      Dispatch(m_smallWidth, m_smallHeight);
+      ClearCS(3, 3);
+    }
+    // Half -> Quarter (curr)
+    {
+      ID3D11ShaderResourceView* s[] = {m_currLumaSrv.Get(), m_currFeature2Srv.Get(), m_currFeature3Srv.Get()};
+      ID3D11UnorderedAccessView* u[] = {m_currLumaSmallUav.Get(), m_currFeature2SmallUav.Get(), m_currFeature3SmallUav.Get()};
+      m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
+      m_context->CSSetShaderResources(0, 3, s);
+      m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
+      Dispatch(m_smallWidth, m_smallHeight);
+      ClearCS(3, 3);
+    }
+    // Quarter -> Eighth (prev)
+    {
+      ID3D11ShaderResourceView* s[] = {m_prevLumaSmallSrv.Get(), m_prevFeature2SmallSrv.Get(), m_prevFeature3SmallSrv.Get()};
+      ID3D11UnorderedAccessView* u[] = {m_prevLumaTinyUav.Get(), m_prevFeature2TinyUav.Get(), m_prevFeature3TinyUav.Get()};
+      m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
+      m_context->CSSetShaderResources(0, 3, s);
+      m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
+      Dispatch(m_tinyWidth, m_tinyHeight);
+      ClearCS(3, 3);
+    }
+    // Quarter -> Eighth (curr)
+    {
+      ID3D11ShaderResourceView* s[] = {m_currLumaSmallSrv.Get(), m_currFeature2SmallSrv.Get(), m_currFeature3SmallSrv.Get()};
+      ID3D11UnorderedAccessView* u[] = {m_currLumaTinyUav.Get(), m_currFeature2TinyUav.Get(), m_currFeature3TinyUav.Get()};
+      m_context->CSSetShader(m_downsampleLumaCs.Get(), nullptr, 0);
+      m_context->CSSetShaderResources(0, 3, s);
+      m_context->CSSetUnorderedAccessViews(0, 3, u, nullptr);
+      Dispatch(m_tinyWidth, m_tinyHeight);
+      ClearCS(3, 3);
+    }
   }
 
   // =======================================================================
   // STAGE 2: MOTION ESTIMATION (Tiny level - forward)
   // =======================================================================
   {
+    StageScope stage(m_stageProfiler, PipelineStage::MotionForward, &m_d3dStageTimer);
     MotionConstants mc = {};
-    mc.radius = tinyRadiusFwd;
+    mc.radius = search.tinyRadiusFwd;
     mc.usePrediction = 0;
     mc.predictionScale = 0.5f; // coarse -> tiny scale
     m_context->UpdateSubresource(m_motionConstants.Get(), 0, nullptr, &mc, 0, 0);
@@ -841,8 +1088,9 @@ bool Interpolator::ComputeMotion(
   // STAGE 2B: MOTION ESTIMATION (Tiny level - backward for consistency)
   // =======================================================================
   {
+    StageScope stage(m_stageProfiler, PipelineStage::MotionBackward, &m_d3dStageTimer);
     MotionConstants mc = {};
-    mc.radius = tinyRadiusBwd;
+    mc.radius = search.tinyRadiusBwd;
     mc.usePrediction = 0;
     mc.predictionScale = 1.0f;
     m_context->UpdateSubresource(m_motionConstants.Get(), 0, nullptr, &mc, 0, 0);
@@ -869,14 +1117,15 @@ bool Interpolator::ComputeMotion(
   // STAGE 3: REFINEMENT (Quarter level)
   // =======================================================================
   {
+    StageScope stage(m_stageProfiler, PipelineStage::RefineQuarter, &m_d3dStageTimer);
     RefineConstants rc = {};
-    rc.radius      = refineSmallR;
+    rc.radius      = search.refineSmallR;
     rc.motionScale = static_cast<float>(m_smallWidth) / static_cast<float>(m_tinyWidth);
     rc.useBackward = 1;
     rc.backwardScale = rc.motionScale;
-    rc.attnLearnRate = attnLearnRate;
-    rc.attnPriorMix = attnPriorMix;
-    rc.attnStability = attnStability;
+    rc.attnLearnRate = search.attnLearnRate;
+    rc.attnPriorMix = search.attnPriorMix;
+    rc.attnStability = search.attnStability;
     m_context->UpdateSubresource(m_refineConstants.Get(), 0, nullptr, &rc, 0, 0);
 
     ID3D11ShaderResourceView* s[] = {
@@ -908,14 +1157,15 @@ bool Interpolator::ComputeMotion(
   // STAGE 4: REFINEMENT (Half level)
   // =======================================================================
   {
+    StageScope stage(m_stageProfiler, PipelineStage::RefineHalf, &m_d3dStageTimer);
     RefineConstants rc = {};
-    rc.radius      = refineFullR;
+    rc.radius      = search.refineFullR;
     rc.motionScale = static_cast<float>(m_lumaWidth) / static_cast<float>(m_smallWidth);
     rc.useBackward = 0;
     rc.backwardScale = 1.0f;
-    rc.attnLearnRate = attnLearnRate;
-    rc.attnPriorMix = attnPriorMix;
-    rc.attnStability = attnStability;
+    rc.attnLearnRate = search.attnLearnRate;
+    rc.attnPriorMix = search.attnPriorMix;
+    rc.attnStability = search.attnStability;
     m_context->UpdateSubresource(m_refineConstants.Get(), 0, nullptr, &rc, 0, 0);
 
     ID3D11ShaderResourceView* s[] = {
@@ -947,6 +1197,7 @@ bool Interpolator::ComputeMotion(
   // STAGE 5: SPATIAL SMOOTHING (Joint Bilateral)
   // =======================================================================
   {
+    StageScope stage(m_stageProfiler, PipelineStage::Smooth, &m_d3dStageTimer);
     SmoothConstants sc = {};
     sc.edgeScale = std::clamp(m_smoothEdgeScale, 0.5f, 20.0f);
     sc.confPower = std::clamp(m_smoothConfPower, 0.25f, 4.0f);
@@ -1136,6 +1387,8 @@ bool Interpolator::LoadAttentionWeights(const wchar_t* path) {
   // Update the constant buffer
   m_context->UpdateSubresource(m_attentionWeights.Get(), 0, nullptr, &weights, 0, 0);
   m_useCustomWeights = true;
+  // New refine weights: previously estimated motion no longer applies.
+  m_motionCache.Invalidate();
   
   return true;
 }
@@ -1385,6 +1638,82 @@ bool Interpolator::ExportTrainedWeights(const wchar_t* path) {
   return true;
 }
 
+// -----------------------------------------------------------------------
+// ExportMotionFields - Read back the motion pyramid as Middlebury .flo
+// -----------------------------------------------------------------------
+bool Interpolator::ReadMotionField(ID3D11Texture2D* texture, FlowField& flow) {
+  if (!texture) {
+    return false;
+  }
+  D3D11_TEXTURE2D_DESC desc = {};
+  texture->GetDesc(&desc);
+  if (desc.Format != DXGI_FORMAT_R16G16_FLOAT || desc.Width == 0 || desc.Height == 0) {
+    return false;
+  }
+
+  D3D11_TEXTURE2D_DESC stagingDesc = desc;
+  stagingDesc.MipLevels = 1;
+  stagingDesc.ArraySize = 1;
+  stagingDesc.SampleDesc.Count = 1;
+  stagingDesc.SampleDesc.Quality = 0;
+  stagingDesc.Usage = D3D11_USAGE_STAGING;
+  stagingDesc.BindFlags = 0;
+  stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+  stagingDesc.MiscFlags = 0;
+
+  Microsoft::WRL::ComPtr<ID3D11Texture2D> staging;
+  if (FAILED(m_device->CreateTexture2D(&stagingDesc, nullptr, &staging))) {
+    return false;
+  }
+  m_context->CopyResource(staging.Get(), texture);
+
+  D3D11_MAPPED_SUBRESOURCE mapped = {};
+  if (FAILED(m_context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped))) {
+    return false;
+  }
+  // Only the viewport holds the frame; the rest is bucket padding.
+  const int width = BucketViewportExtent(static_cast<int>(desc.Width), m_inputWidth, m_poolWidth);
+  const int height = BucketViewportExtent(static_cast<int>(desc.Height), m_inputHeight, m_poolHeight);
+  flow.Resize(width, height);
+  for (int y = 0; y < height; ++y) {
+    const uint16_t* row = reinterpret_cast<const uint16_t*>(static_cast<const uint8_t*>(mapped.pData) +
+                                                            static_cast<size_t>(y) * mapped.RowPitch);
+    float* dst = &flow.uv[static_cast<size_t>(y) * width * 2];
+    for (int i = 0; i < width * 2; ++i) {
+      dst[i] = DecodeHalf(row[i]);
+    }
+  }
+  m_context->Unmap(staging.Get(), 0);
+  return true;
+}
+
+int Interpolator::ExportMotionFields(const std::string& prefix) {
+  if (m_useVulkan || !m_device || !m_context) {
+    return 0;
+  }
+  struct Level {
+    ID3D11Texture2D* texture;
+    const char* suffix;
+  };
+  // Quarter/half fields are only written by the full pipeline; in minimal
+  // mode they would hold a stale estimate.
+  const Level levels[] = {
+      {m_motionTiny.Get(), "_eighth_fwd.flo"},
+      {m_motionTinyBackward.Get(), "_eighth_bwd.flo"},
+      {m_useMinimalMotionPipeline ? nullptr : m_motionCoarse.Get(), "_quarter_fwd.flo"},
+      {m_useMinimalMotionPipeline ? nullptr : m_motion.Get(), "_half_fwd.flo"},
+      {m_useMinimalMotionPipeline ? nullptr : m_motionSmooth.Get(), "_half_smooth.flo"},
+  };
+  int written = 0;
+  FlowField flow;
+  for (const Level& level : levels) {
+    if (level.texture && ReadMotionField(level.texture, flow) && WriteFlo(prefix + level.suffix, flow)) {
+      ++written;
+    }
+  }
+  return written;
+}
+
 // -----------------------------------------------------------------------
 // LoadVulkanShaders: Load SPIR-V compute shaders and create Vulkan pipelines
 // -----------------------------------------------------------------------
@@ -1408,12 +1737,10 @@ static bool CreateVulkanPipeline(
     VkPipeline& outPipeline,
     VkPipelineLayout& outLayout,
     VkDescriptorSetLayout& outSetLayout,
-    const char* name,
-    std::ofstream& log) {
+    const char* name) {
 
   if (spirv.empty() || spirv.size() % 4 != 0) {
-    log << "Invalid SPIR-V data for " << name << " size=" << spirv.size() << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "Invalid SPIR-V data for {} size={}", name, spirv.size());
     return false;
   }
 
@@ -1423,17 +1750,14 @@ static bool CreateVulkanPipeline(
   moduleInfo.codeSize = spirv.size();
   moduleInfo.pCode = reinterpret_cast<const uint32_t*>(spirv.data());
 
-  log << "Creating shader module, size=" << spirv.size() << "\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "Creating shader module, size={}", spirv.size());
 
   VkShaderModule shaderModule = VK_NULL_HANDLE;
   if (vkCreateShaderModule(device, &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-    log << "vkCreateShaderModule failed for " << name << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "vkCreateShaderModule failed for {}", name);
     return false;
   }
-  log << "Shader module created successfully\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "Shader module created successfully");
 
   // Create descriptor set layout
   VkDescriptorSetLayoutCreateInfo layoutInfo = {};
@@ -1443,12 +1767,10 @@ static bool CreateVulkanPipeline(
 
   if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &outSetLayout) != VK_SUCCESS) {
     vkDestroyShaderModule(device, shaderModule, nullptr);
-    log << "Descriptor set layout creation failed for " << name << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "Descriptor set layout creation failed for {}", name);
     return false;
   }
-  log << "Descriptor set layout created\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "Descriptor set layout created");
 
   // Create pipeline layout with push constants
   VkPushConstantRange pushRange = {};
@@ -1468,12 +1790,10 @@ static bool CreateVulkanPipeline(
   if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &outLayout) != VK_SUCCESS) {
     vkDestroyDescriptorSetLayout(device, outSetLayout, nullptr);
     vkDestroyShaderModule(device, shaderModule, nullptr);
-    log << "Pipeline layout creation failed for " << name << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "Pipeline layout creation failed for {}", name);
     return false;
   }
-  log << "Pipeline layout created\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "Pipeline layout created");
 
   // Create compute pipeline
   VkComputePipelineCreateInfo pipelineInfo = {};
@@ -1484,8 +1804,7 @@ static bool CreateVulkanPipeline(
   pipelineInfo.stage.module = shaderModule;
   pipelineInfo.stage.pName = "main";
 
-  log << "About to create compute pipeline: " << name << "\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "About to create compute pipeline: {}", name);
 
   VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &outPipeline);
   
@@ -1497,34 +1816,27 @@ static bool CreateVulkanPipeline(
     vkDestroyDescriptorSetLayout(device, outSetLayout, nullptr);
     outLayout = VK_NULL_HANDLE;
     outSetLayout = VK_NULL_HANDLE;
-    log << "Compute pipeline creation failed for " << name << " result=" << result << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "Compute pipeline creation failed for {} result={}", name, result);
     return false;
   }
 
-  log << "Pipeline created: " << name << "\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "Pipeline created: {}", name);
   return true;
 }
 
 bool Interpolator::LoadVulkanShaders() {
-  std::ofstream log("vulkan_debug.txt", std::ios::app);
-
   if (!m_renderDevice) {
-    log << "LoadVulkanShaders: No render device\n";
-    log.flush();
+    TFE_LOG(Warn, Vulkan, "LoadVulkanShaders: No render device");
     return false;
   }
 
   VkDevice vkDevice = m_renderDevice->GetVkDevice();
   if (vkDevice == VK_NULL_HANDLE) {
-    log << "LoadVulkanShaders: VkDevice is null\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "LoadVulkanShaders: VkDevice is null");
     return false;
   }
 
-  log << "Passed Vulkan check\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "Passed Vulkan check");
 
   // Build shader directory path
   wchar_t exePath[MAX_PATH] = {};
@@ -1537,8 +1849,7 @@ bool Interpolator::LoadVulkanShaders() {
   // Convert to narrow for logging
   char narrowDir[512] = {};
   WideCharToMultiByte(CP_UTF8, 0, shaderDir.c_str(), -1, narrowDir, sizeof(narrowDir), nullptr, nullptr);
-  log << "Shader dir: " << narrowDir << "\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "Shader dir: {}", narrowDir);
 
   // Helper to build descriptor bindings
   auto makeSamplerBinding = [](uint32_t binding) -> VkDescriptorSetLayoutBinding {
@@ -1566,8 +1877,7 @@ bool Interpolator::LoadVulkanShaders() {
     auto spirv = ReadSPIRVFile(path);
     char narrowPath[512] = {};
     WideCharToMultiByte(CP_UTF8, 0, path.c_str(), -1, narrowPath, sizeof(narrowPath), nullptr, nullptr);
-    log << "Loading: " << narrowPath << "\n";
-    log.flush();
+    TFE_LOG(Info, Vulkan, "Loading: {}", narrowPath);
 
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
       makeSamplerBinding(0),
@@ -1578,7 +1888,7 @@ bool Interpolator::LoadVulkanShaders() {
 
     if (!CreateVulkanPipeline(vkDevice, spirv, bindings, 120,
         m_vkFeaturePyramidPipeline, m_vkFeaturePyramidLayout, m_vkFeaturePyramidSetLayout,
-        "FeaturePyramid", log)) {
+        "FeaturePyramid")) {
       return false;
     }
   }
@@ -1589,8 +1899,7 @@ bool Interpolator::LoadVulkanShaders() {
     auto spirv = ReadSPIRVFile(path);
     char narrowPath[512] = {};
     WideCharToMultiByte(CP_UTF8, 0, path.c_str(), -1, narrowPath, sizeof(narrowPath), nullptr, nullptr);
-    log << "Loading: " << narrowPath << "\n";
-    log.flush();
+    TFE_LOG(Info, Vulkan, "Loading: {}", narrowPath);
 
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
       makeSamplerBinding(0), makeSamplerBinding(1),
@@ -1605,7 +1914,7 @@ bool Interpolator::LoadVulkanShaders() {
 
     if (!CreateVulkanPipeline(vkDevice, spirv, bindings, 56,
         m_vkCostVolumePipeline, m_vkCostVolumeLayout, m_vkCostVolumeSetLayout,
-        "CostVolume", log)) {
+        "CostVolume")) {
       return false;
     }
   }
@@ -1616,8 +1925,7 @@ bool Interpolator::LoadVulkanShaders() {
     auto spirv = ReadSPIRVFile(path);
     char narrowPath[512] = {};
     WideCharToMultiByte(CP_UTF8, 0, path.c_str(), -1, narrowPath, sizeof(narrowPath), nullptr, nullptr);
-    log << "Loading: " << narrowPath << "\n";
-    log.flush();
+    TFE_LOG(Info, Vulkan, "Loading: {}", narrowPath);
 
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
       makeSamplerBinding(0), makeSamplerBinding(1),
@@ -1627,7 +1935,7 @@ bool Interpolator::LoadVulkanShaders() {
 
     if (!CreateVulkanPipeline(vkDevice, spirv, bindings, 56,
         m_vkFlowDecoderPipeline, m_vkFlowDecoderLayout, m_vkFlowDecoderSetLayout,
-        "FlowDecoder", log)) {
+        "FlowDecoder")) {
       return false;
     }
   }
@@ -1638,8 +1946,7 @@ bool Interpolator::LoadVulkanShaders() {
     auto spirv = ReadSPIRVFile(path);
     char narrowPath[512] = {};
     WideCharToMultiByte(CP_UTF8, 0, path.c_str(), -1, narrowPath, sizeof(narrowPath), nullptr, nullptr);
-    log << "Loading: " << narrowPath << "\n";
-    log.flush();
+    TFE_LOG(Info, Vulkan, "Loading: {}", narrowPath);
 
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
       makeSamplerBinding(0), makeSamplerBinding(1),
@@ -1652,7 +1959,7 @@ bool Interpolator::LoadVulkanShaders() {
 
     if (!CreateVulkanPipeline(vkDevice, spirv, bindings, 60,
         m_vkInterpolatePipeline, m_vkInterpolateLayout, m_vkInterpolateSetLayout,
-        "Interpolate", log)) {
+        "Interpolate")) {
       return false;
     }
   }
@@ -1663,8 +1970,7 @@ bool Interpolator::LoadVulkanShaders() {
     auto spirv = ReadSPIRVFile(path);
     char narrowPath[512] = {};
     WideCharToMultiByte(CP_UTF8, 0, path.c_str(), -1, narrowPath, sizeof(narrowPath), nullptr, nullptr);
-    log << "Loading: " << narrowPath << "\n";
-    log.flush();
+    TFE_LOG(Info, Vulkan, "Loading: {}", narrowPath);
 
     std::vector<VkDescriptorSetLayoutBinding> bindings = {
       makeSamplerBinding(0),
@@ -1675,13 +1981,12 @@ bool Interpolator::LoadVulkanShaders() {
 
     if (!CreateVulkanPipeline(vkDevice, spirv, bindings, 88,
         m_vkDownsamplePipeline, m_vkDownsampleLayout, m_vkDownsampleSetLayout,
-        "Downsample", log)) {
+        "Downsample")) {
       return false;
     }
   }
 
-  log << "All Vulkan shaders loaded successfully\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "All Vulkan shaders loaded successfully");
   return true;
 }
 
@@ -1778,10 +2083,8 @@ bool Interpolator::CreateSharedImg(SharedImg& s, uint32_t w, uint32_t h,
   desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED;
   HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &s.d3dTex);
   if (FAILED(hr)) {
-    std::ofstream log("vulkan_debug.txt", std::ios::app);
-    log << "CreateSharedImg: CreateTexture2D failed, hr=0x" << std::hex << hr
-        << " fmt=" << std::dec << d3dFmt << " " << w << "x" << h << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "CreateSharedImg: CreateTexture2D failed, hr=0x{:x} fmt={} {}x{}",
+            static_cast<uint32_t>(hr), d3dFmt, w, h);
     return false;
   }
 
@@ -1810,9 +2113,7 @@ bool Interpolator::CreateSharedImg(SharedImg& s, uint32_t w, uint32_t h,
   ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
   ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
   if (vkCreateImage(dev, &ci, nullptr, &s.vkImage) != VK_SUCCESS) {
-    std::ofstream log("vulkan_debug.txt", std::ios::app);
-    log << "CreateSharedImg: vkCreateImage failed " << w << "x" << h << " fmt=" << vkFmt << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "CreateSharedImg: vkCreateImage failed {}x{} fmt={}", w, h, vkFmt);
     s.d3dTex.Reset(); return false;
   }
 
@@ -1836,17 +2137,13 @@ bool Interpolator::CreateSharedImg(SharedImg& s, uint32_t w, uint32_t h,
   ai.allocationSize = req.size;
   ai.memoryTypeIndex = FindVkMemoryType(phys, req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
   if (ai.memoryTypeIndex == UINT32_MAX) {
-    std::ofstream log("vulkan_debug.txt", std::ios::app);
-    log << "CreateSharedImg: no suitable memory type, bits=0x" << std::hex << req.memoryTypeBits << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "CreateSharedImg: no suitable memory type, bits=0x{:x}", req.memoryTypeBits);
     vkDestroyImage(dev, s.vkImage, nullptr); s.vkImage = VK_NULL_HANDLE;
     s.d3dTex.Reset(); return false;
   }
   VkResult vr = vkAllocateMemory(dev, &ai, nullptr, &s.vkMemory);
   if (vr != VK_SUCCESS) {
-    std::ofstream log("vulkan_debug.txt", std::ios::app);
-    log << "CreateSharedImg: vkAllocateMemory failed, result=" << vr << "\n";
-    log.flush();
+    TFE_LOG(Error, Vulkan, "CreateSharedImg: vkAllocateMemory failed, result={}", vr);
     vkDestroyImage(dev, s.vkImage, nullptr); s.vkImage = VK_NULL_HANDLE;
     s.d3dTex.Reset(); return false;
   }
@@ -1883,8 +2180,7 @@ void Interpolator::DestroySharedImg(SharedImg& s) {
 }
 
 void Interpolator::CreateVulkanResources() {
-  std::ofstream log("vulkan_debug.txt", std::ios::app);
-  log << "CreateVulkanResources: START\n"; log.flush();
+  TFE_LOG(Info, Vulkan, "CreateVulkanResources: START");
   if (!m_renderDevice || !m_renderDevice->IsVulkan()) return;
 
   DestroyVulkanResources();
@@ -1895,9 +2191,7 @@ void Interpolator::CreateVulkanResources() {
   uint32_t hW = (uint32_t)m_lumaWidth, hH = (uint32_t)m_lumaHeight;
   if (!oW || !oH || !iW || !iH || !hW || !hH) return;
 
-  log << "  input=" << iW << "x" << iH << " output=" << oW << "x" << oH
-      << " luma=" << hW << "x" << hH << "\n";
-  log.flush();
+  TFE_LOG(Info, Vulkan, "  input={}x{} output={}x{} luma={}x{}", iW, iH, oW, oH, hW, hH);
 
   // Try zero-copy shared textures (D3D11<->Vulkan, same GPU memory)
   VkImageUsageFlags sampU = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
@@ -1924,9 +2218,17 @@ void Interpolator::CreateVulkanResources() {
 
   m_vkZeroCopy = zc;
   if (zc) {
-    log << "CreateVulkanResources: ZERO-COPY shared textures OK\n"; log.flush();
+    TFE_LOG(Info, Vulkan, "CreateVulkanResources: ZERO-COPY shared textures OK");
+    // Imported memory is the D3D11 texture's; counted once here.
+    m_resources.Track("vk.sharedPrev", iW, iH, ResourceFormat::Bgra8Unorm);
+    m_resources.Track("vk.sharedCurr", iW, iH, ResourceFormat::Bgra8Unorm);
+    m_resources.Track("vk.sharedMotion", hW, hH, ResourceFormat::Rg16Float);
+    m_resources.Track("vk.sharedConf", hW, hH, ResourceFormat::R16Float);
+    m_resources.Track("vk.sharedFeatPrev", hW, hH, ResourceFormat::Rgba16Float);
+    m_resources.Track("vk.sharedFeatCurr", hW, hH, ResourceFormat::Rgba16Float);
+    m_resources.Track("vk.sharedOutput", oW, oH, ResourceFormat::Bgra8Unorm);
   } else {
-    log << "CreateVulkanResources: Shared texture creation FAILED, cannot proceed\n"; log.flush();
+    TFE_LOG(Error, Vulkan, "CreateVulkanResources: Shared texture creation FAILED, cannot proceed");
     DestroyVulkanResources();
     return;
   }
@@ -1940,9 +2242,14 @@ void Interpolator::CreateVulkanResources() {
   fullOk &= CreateVkImg(m_vkConfOut,  hW, hH, VK_FORMAT_R16_SFLOAT, intU);
   fullOk &= CreateVkImg(m_vkDummy, 1, 1, VK_FORMAT_R16G16B16A16_SFLOAT, intU);
   if (fullOk) {
-    log << "CreateVulkanResources: Intermediate VkImages OK\n"; log.flush();
+    TFE_LOG(Info, Vulkan, "CreateVulkanResources: Intermediate VkImages OK");
+    m_resources.Track("vk.featPrev", hW, hH, ResourceFormat::Rgba16Float);
+    m_resources.Track("vk.featCurr", hW, hH, ResourceFormat::Rgba16Float);
+    m_resources.Track("vk.costVol", hW, hH, ResourceFormat::Rgba16Float);
+    m_resources.Track("vk.flowOut", hW, hH, ResourceFormat::Rg16Float);
+    m_resources.Track("vk.confOut", hW, hH, ResourceFormat::R16Float);
   } else {
-    log << "CreateVulkanResources: Intermediate image creation failed (non-fatal)\n"; log.flush();
+    TFE_LOG(Warn, Vulkan, "CreateVulkanResources: Intermediate image creation failed (non-fatal)");
   }
 
   // Samplers
@@ -1986,21 +2293,22 @@ void Interpolator::CreateVulkanResources() {
     da.descriptorSetCount = 1;
     da.pSetLayouts = &m_vkInterpolateSetLayout;
     if (vkAllocateDescriptorSets(dev, &da, &m_vkInterpolateSet) != VK_SUCCESS) {
-      log << "CreateVulkanResources: InterpolateSet alloc failed\n";
+      TFE_LOG(Error, Vulkan, "CreateVulkanResources: InterpolateSet alloc failed");
       m_vkInterpolateSet = VK_NULL_HANDLE;
     }
   }
 
   // ---- Allocate descriptor sets for full Vulkan pipeline ----
   auto allocSet = [&](VkDescriptorSetLayout layout, VkDescriptorSet& outSet, const char* name) {
-    if (!layout) { log << "  " << name << ": no layout\n"; return; }
+    if (!layout) { TFE_LOG(Warn, Vulkan, "  {}: no layout", name); return; }
     VkDescriptorSetAllocateInfo da = {};
     da.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     da.descriptorPool = pool;
     da.descriptorSetCount = 1;
     da.pSetLayouts = &layout;
     if (vkAllocateDescriptorSets(dev, &da, &outSet) != VK_SUCCESS) {
-      log << "  " << name << ": alloc FAILED\n"; outSet = VK_NULL_HANDLE;
+      TFE_LOG(Error, Vulkan, "  {}: alloc FAILED", name);
+      outSet = VK_NULL_HANDLE;
     }
   };
 
@@ -2178,15 +2486,14 @@ void Interpolator::CreateVulkanResources() {
     }
 
     m_vkFullPipeline = true;
-    log << "CreateVulkanResources: Full VK pipeline descriptor sets configured\n"; log.flush();
+    TFE_LOG(Info, Vulkan, "CreateVulkanResources: Full VK pipeline descriptor sets configured");
   } else {
-    log << "CreateVulkanResources: Full VK pipeline NOT available (intermediates or sets failed)\n";
-    log.flush();
+    TFE_LOG(Warn, Vulkan, "CreateVulkanResources: Full VK pipeline NOT available (intermediates or sets failed)");
   }
 
   m_vkResCreated = true;
-  log << "CreateVulkanResources: SUCCESS (zero-copy=" << m_vkZeroCopy
-      << " fullPipeline=" << m_vkFullPipeline << ")\n"; log.flush();
+  TFE_LOG(Info, Vulkan, "CreateVulkanResources: SUCCESS (zero-copy={} fullPipeline={})", m_vkZeroCopy,
+          m_vkFullPipeline);
 }
 
 void Interpolator::DestroyVulkanResources() {
@@ -2194,6 +2501,7 @@ void Interpolator::DestroyVulkanResources() {
   VkDevice dev = m_renderDevice->GetVkDevice();
   if (!dev) return;
   vkDeviceWaitIdle(dev);
+  m_resources.ReleaseGroup("vk.");
 
   DestroySharedImg(m_sharedPrev); DestroySharedImg(m_sharedCurr);
   DestroySharedImg(m_sharedMotion); DestroySharedImg(m_sharedConf);
@@ -2248,10 +2556,8 @@ bool Interpolator::VulkanDispatchInterpolate(
   // One-time dispatch log
   static bool loggedOnce = false;
   if (!loggedOnce) {
-    std::ofstream log("vulkan_debug.txt", std::ios::app);
-    log << "VulkanDispatchInterpolate: ENTER (zero-copy) input=" << iW << "x" << iH
-        << " output=" << oW << "x" << oH << " luma=" << hW << "x" << hH << "\n";
-    log.flush();
+    TFE_LOG(Info, Vulkan, "VulkanDispatchInterpolate: ENTER (zero-copy) input={}x{} output={}x{} luma={}x{}",
+            iW, iH, oW, oH, hW, hH);
     loggedOnce = true;
   }
 
@@ -2270,15 +2576,18 @@ bool Interpolator::VulkanDispatchInterpolate(
     m_context->CopyResource(dst, res.Get());
   };
 
-  d3dCopyFromSrv(prev,                m_sharedPrev.d3dTex.Get());
-  d3dCopyFromSrv(curr,                m_sharedCurr.d3dTex.Get());
-  d3dCopyFromSrv(motSrv,              m_sharedMotion.d3dTex.Get());
-  d3dCopyFromSrv(cfSrv,               m_sharedConf.d3dTex.Get());
-  d3dCopyFromSrv(m_prevLumaSrv.Get(), m_sharedFeatPrev.d3dTex.Get());
-  d3dCopyFromSrv(m_currLumaSrv.Get(), m_sharedFeatCurr.d3dTex.Get());
+  {
+    StageScope stage(m_stageProfiler, PipelineStage::VkCopyIn, &m_d3dStageTimer);
+    d3dCopyFromSrv(prev,                m_sharedPrev.d3dTex.Get());
+    d3dCopyFromSrv(curr,                m_sharedCurr.d3dTex.Get());
+    d3dCopyFromSrv(motSrv,              m_sharedMotion.d3dTex.Get());
+    d3dCopyFromSrv(cfSrv,               m_sharedConf.d3dTex.Get());
+    d3dCopyFromSrv(m_prevLumaSrv.Get(), m_sharedFeatPrev.d3dTex.Get());
+    d3dCopyFromSrv(m_currLumaSrv.Get(), m_sharedFeatCurr.d3dTex.Get());
 
-  // Flush D3D11 to ensure all copies are committed to GPU before Vulkan reads
-  m_context->Flush();
+    // Flush D3D11 to ensure all copies are committed to GPU before Vulkan reads
+    m_context->Flush();
+  }
 
   // ---- Vulkan side: single command buffer ----
   vkResetCommandBuffer(cmd, 0);
@@ -2286,6 +2595,7 @@ bool Interpolator::VulkanDispatchInterpolate(
   cbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   cbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
   vkBeginCommandBuffer(cmd, &cbi);
+  m_vkStageTimer.BeginCommands(cmd);
 
   // Barrier: transition shared input images UNDEFINED → SHADER_READ_ONLY
   //          and output UNDEFINED → GENERAL
@@ -2381,7 +2691,10 @@ bool Interpolator::VulkanDispatchInterpolate(
       VK_SHADER_STAGE_COMPUTE_BIT, 0, 60, &pc);
 
   // Dispatch
-  vkCmdDispatch(cmd, (oW + 15) / 16, (oH + 15) / 16, 1);
+  {
+    StageScope stage(m_stageProfiler, PipelineStage::VkInterpolate, &m_vkStageTimer);
+    vkCmdDispatch(cmd, (oW + 15) / 16, (oH + 15) / 16, 1);
+  }
 
   // Barrier: output GENERAL → shader complete (ensure writes visible)
   {
@@ -2399,14 +2712,19 @@ bool Interpolator::VulkanDispatchInterpolate(
   }
 
   // Submit and wait
+  m_vkStageTimer.EndCommands();
   vkEndCommandBuffer(cmd);
-  VkSubmitInfo si = {};
-  si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  si.commandBufferCount = 1;
-  si.pCommandBuffers = &cmd;
-  vkQueueSubmit(queue, 1, &si, m_vkComputeFence);
-  vkWaitForFences(dev, 1, &m_vkComputeFence, VK_TRUE, UINT64_MAX);
-  vkResetFences(dev, 1, &m_vkComputeFence);
+  {
+    StageScope stage(m_stageProfiler, PipelineStage::VkSubmitWait);
+    VkSubmitInfo si = {};
+    si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    si.commandBufferCount = 1;
+    si.pCommandBuffers = &cmd;
+    vkQueueSubmit(queue, 1, &si, m_vkComputeFence);
+    vkWaitForFences(dev, 1, &m_vkComputeFence, VK_TRUE, UINT64_MAX);
+    vkResetFences(dev, 1, &m_vkComputeFence);
+  }
+  m_vkStageTimer.Resolve();
 
   // ---- D3D11 readback: shared output → m_outputTexture (GPU copy, no CPU) ----
   m_context->CopyResource(m_outputTexture.Get(), m_sharedOutput.d3dTex.Get());
@@ -2443,6 +2761,7 @@ bool Interpolator::VulkanReWarp(float alpha) {
   cbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   cbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
   vkBeginCommandBuffer(cmd, &cbi);
+  m_vkStageTimer.BeginCommands(cmd);
 
   if (fullPath) {
     // Full-VK path: VK intermediates hold motion data from VulkanFullDispatch
@@ -2527,7 +2846,10 @@ bool Interpolator::VulkanReWarp(float alpha) {
       VK_SHADER_STAGE_COMPUTE_BIT, 0, 60, &pc);
 
   // Dispatch
-  vkCmdDispatch(cmd, (oW + 15) / 16, (oH + 15) / 16, 1);
+  {
+    StageScope stage(m_stageProfiler, PipelineStage::VkInterpolate, &m_vkStageTimer);
+    vkCmdDispatch(cmd, (oW + 15) / 16, (oH + 15) / 16, 1);
+  }
 
   // Barrier: output writes complete before D3D11 reads
   {
@@ -2545,14 +2867,19 @@ bool Interpolator::VulkanReWarp(float alpha) {
   }
 
   // Submit and wait
+  m_vkStageTimer.EndCommands();
   vkEndCommandBuffer(cmd);
-  VkSubmitInfo si = {};
-  si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  si.commandBufferCount = 1;
-  si.pCommandBuffers = &cmd;
-  vkQueueSubmit(queue, 1, &si, m_vkComputeFence);
-  vkWaitForFences(dev, 1, &m_vkComputeFence, VK_TRUE, UINT64_MAX);
-  vkResetFences(dev, 1, &m_vkComputeFence);
+  {
+    StageScope stage(m_stageProfiler, PipelineStage::VkSubmitWait);
+    VkSubmitInfo si = {};
+    si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    si.commandBufferCount = 1;
+    si.pCommandBuffers = &cmd;
+    vkQueueSubmit(queue, 1, &si, m_vkComputeFence);
+    vkWaitForFences(dev, 1, &m_vkComputeFence, VK_TRUE, UINT64_MAX);
+    vkResetFences(dev, 1, &m_vkComputeFence);
+  }
+  m_vkStageTimer.Resolve();
 
   // D3D11: shared output → presentation texture (GPU copy, no CPU)
   m_context->CopyResource(m_outputTexture.Get(), m_sharedOutput.d3dTex.Get());
@@ -2587,10 +2914,7 @@ bool Interpolator::VulkanFullDispatch(
 
   static bool loggedOnce = false;
   if (!loggedOnce) {
-    std::ofstream log("vulkan_debug.txt", std::ios::app);
-    log << "VulkanFullDispatch: ENTER input=" << iW << "x" << iH
-        << " output=" << oW << "x" << oH << " luma=" << hW << "x" << hH << "\n";
-    log.flush();
+    TFE_LOG(Info, Vulkan, "VulkanFullDispatch: ENTER input={}x{} output={}x{} luma={}x{}", iW, iH, oW, oH, hW, hH);
     loggedOnce = true;
   }
 
@@ -2601,9 +2925,12 @@ bool Interpolator::VulkanFullDispatch(
     srv->GetResource(&res);
     m_context->CopyResource(dst, res.Get());
   };
-  d3dCopyFromSrv(prev, m_sharedPrev.d3dTex.Get());
-  d3dCopyFromSrv(curr, m_sharedCurr.d3dTex.Get());
-  m_context->Flush();
+  {
+    StageScope stage(m_stageProfiler, PipelineStage::VkCopyIn, &m_d3dStageTimer);
+    d3dCopyFromSrv(prev, m_sharedPrev.d3dTex.Get());
+    d3dCopyFromSrv(curr, m_sharedCurr.d3dTex.Get());
+    m_context->Flush();
+  }
 
   // ---- Vulkan: single command buffer with all stages ----
   vkResetCommandBuffer(cmd, 0);
@@ -2611,6 +2938,7 @@ bool Interpolator::VulkanFullDispatch(
   cbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   cbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
   vkBeginCommandBuffer(cmd, &cbi);
+  m_vkStageTimer.BeginCommands(cmd);
 
   // === Stage 0: Initial barriers ===
   // Inputs: sharedPrev, sharedCurr → SHADER_READ_ONLY
@@ -2642,58 +2970,61 @@ bool Interpolator::VulkanFullDispatch(
         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, n, bars);
   }
 
-  // === Stage 1: Downsample prev → featPrev ===
   {
-    struct {
-      float inputSize[4];
-      float outputSize0[4];
-      float outputSize1[4];
-      float outputSize2[4];
-      float outputSize3[4];
-      int numLevels;
-      int padding;
-    } pc;
-    pc.inputSize[0] = (float)iW; pc.inputSize[1] = (float)iH;
-    pc.inputSize[2] = 1.0f / (float)iW; pc.inputSize[3] = 1.0f / (float)iH;
-    pc.outputSize0[0] = (float)hW; pc.outputSize0[1] = (float)hH;
-    pc.outputSize0[2] = 1.0f / (float)hW; pc.outputSize0[3] = 1.0f / (float)hH;
-    // levels 1-3 unused, set to 1×1
-    for (int i = 0; i < 4; i++) {
-      pc.outputSize1[i] = (i < 2) ? 1.0f : 1.0f;
-      pc.outputSize2[i] = (i < 2) ? 1.0f : 1.0f;
-      pc.outputSize3[i] = (i < 2) ? 1.0f : 1.0f;
+    StageScope stage(m_stageProfiler, PipelineStage::VkDownsample, &m_vkStageTimer);
+    // === Stage 1: Downsample prev → featPrev ===
+    {
+      struct {
+        float inputSize[4];
+        float outputSize0[4];
+        float outputSize1[4];
+        float outputSize2[4];
+        float outputSize3[4];
+        int numLevels;
+        int padding;
+      } pc;
+      pc.inputSize[0] = (float)iW; pc.inputSize[1] = (float)iH;
+      pc.inputSize[2] = 1.0f / (float)iW; pc.inputSize[3] = 1.0f / (float)iH;
+      pc.outputSize0[0] = (float)hW; pc.outputSize0[1] = (float)hH;
+      pc.outputSize0[2] = 1.0f / (float)hW; pc.outputSize0[3] = 1.0f / (float)hH;
+      // levels 1-3 unused, set to 1×1
+      for (int i = 0; i < 4; i++) {
+        pc.outputSize1[i] = (i < 2) ? 1.0f : 1.0f;
+        pc.outputSize2[i] = (i < 2) ? 1.0f : 1.0f;
+        pc.outputSize3[i] = (i < 2) ? 1.0f : 1.0f;
+      }
+      pc.numLevels = 1;
+      pc.padding = 0;
+
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_vkDownsamplePipeline);
+      vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+          m_vkDownsampleLayout, 0, 1, &m_vkDownsamplePrevSet, 0, nullptr);
+      vkCmdPushConstants(cmd, m_vkDownsampleLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 88, &pc);
+      vkCmdDispatch(cmd, (hW + 15) / 16, (hH + 15) / 16, 1); // z=1 → only level 0
     }
-    pc.numLevels = 1;
-    pc.padding = 0;
 
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_vkDownsamplePipeline);
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
-        m_vkDownsampleLayout, 0, 1, &m_vkDownsamplePrevSet, 0, nullptr);
-    vkCmdPushConstants(cmd, m_vkDownsampleLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 88, &pc);
-    vkCmdDispatch(cmd, (hW + 15) / 16, (hH + 15) / 16, 1); // z=1 → only level 0
-  }
+    // === Stage 2: Downsample curr → featCurr ===
+    {
+      struct {
+        float inputSize[4]; float outputSize0[4]; float outputSize1[4];
+        float outputSize2[4]; float outputSize3[4]; int numLevels; int padding;
+      } pc;
+      pc.inputSize[0] = (float)iW; pc.inputSize[1] = (float)iH;
+      pc.inputSize[2] = 1.0f / (float)iW; pc.inputSize[3] = 1.0f / (float)iH;
+      pc.outputSize0[0] = (float)hW; pc.outputSize0[1] = (float)hH;
+      pc.outputSize0[2] = 1.0f / (float)hW; pc.outputSize0[3] = 1.0f / (float)hH;
+      for (int i = 0; i < 4; i++) {
+        pc.outputSize1[i] = (i < 2) ? 1.0f : 1.0f;
+        pc.outputSize2[i] = (i < 2) ? 1.0f : 1.0f;
+        pc.outputSize3[i] = (i < 2) ? 1.0f : 1.0f;
+      }
+      pc.numLevels = 1; pc.padding = 0;
 
-  // === Stage 2: Downsample curr → featCurr ===
-  {
-    struct {
-      float inputSize[4]; float outputSize0[4]; float outputSize1[4];
-      float outputSize2[4]; float outputSize3[4]; int numLevels; int padding;
-    } pc;
-    pc.inputSize[0] = (float)iW; pc.inputSize[1] = (float)iH;
-    pc.inputSize[2] = 1.0f / (float)iW; pc.inputSize[3] = 1.0f / (float)iH;
-    pc.outputSize0[0] = (float)hW; pc.outputSize0[1] = (float)hH;
-    pc.outputSize0[2] = 1.0f / (float)hW; pc.outputSize0[3] = 1.0f / (float)hH;
-    for (int i = 0; i < 4; i++) {
-      pc.outputSize1[i] = (i < 2) ? 1.0f : 1.0f;
-      pc.outputSize2[i] = (i < 2) ? 1.0f : 1.0f;
-      pc.outputSize3[i] = (i < 2) ? 1.0f : 1.0f;
+      vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+          m_vkDownsampleLayout, 0, 1, &m_vkDownsampleCurrSet, 0, nullptr);
+      vkCmdPushConstants(cmd, m_vkDownsampleLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 88, &pc);
+      vkCmdDispatch(cmd, (hW + 15) / 16, (hH + 15) / 16, 1);
     }
-    pc.numLevels = 1; pc.padding = 0;
-
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
-        m_vkDownsampleLayout, 0, 1, &m_vkDownsampleCurrSet, 0, nullptr);
-    vkCmdPushConstants(cmd, m_vkDownsampleLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, 88, &pc);
-    vkCmdDispatch(cmd, (hW + 15) / 16, (hH + 15) / 16, 1);
   }
 
   // Barrier: featPrev + featCurr GENERAL → SHADER_READ_ONLY (downsample writes must complete)
@@ -2719,6 +3050,7 @@ bool Interpolator::VulkanFullDispatch(
 
   // === Stage 3: Cost Volume ===
   {
+    StageScope stage(m_stageProfiler, PipelineStage::VkCostVolume, &m_vkStageTimer);
     struct {
       float srcSize[4];
       float costVolumeSize[4];
@@ -2764,6 +3096,7 @@ bool Interpolator::VulkanFullDispatch(
 
   // === Stage 4: Flow Decoder → motion + confidence ===
   {
+    StageScope stage(m_stageProfiler, PipelineStage::VkFlowDecoder, &m_vkStageTimer);
     struct {
       float costVolumeSize[4];
       float srcSize[4];
@@ -2812,6 +3145,7 @@ bool Interpolator::VulkanFullDispatch(
 
   // === Stage 5: Interpolate ===
   {
+    StageScope stage(m_stageProfiler, PipelineStage::VkInterpolate, &m_vkStageTimer);
     struct {
       float frameSize[4];
       float motionSize[4];
@@ -2859,14 +3193,19 @@ bool Interpolator::VulkanFullDispatch(
   }
 
   // Submit and wait
+  m_vkStageTimer.EndCommands();
   vkEndCommandBuffer(cmd);
-  VkSubmitInfo si = {};
-  si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  si.commandBufferCount = 1;
-  si.pCommandBuffers = &cmd;
-  vkQueueSubmit(queue, 1, &si, m_vkComputeFence);
-  vkWaitForFences(dev, 1, &m_vkComputeFence, VK_TRUE, UINT64_MAX);
-  vkResetFences(dev, 1, &m_vkComputeFence);
+  {
+    StageScope stage(m_stageProfiler, PipelineStage::VkSubmitWait);
+    VkSubmitInfo si = {};
+    si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    si.commandBufferCount = 1;
+    si.pCommandBuffers = &cmd;
+    vkQueueSubmit(queue, 1, &si, m_vkComputeFence);
+    vkWaitForFences(dev, 1, &m_vkComputeFence, VK_TRUE, UINT64_MAX);
+    vkResetFences(dev, 1, &m_vkComputeFence);
+  }
+  m_vkStageTimer.Resolve();
 
   // D3D11: shared output → presentation texture
   m_context->CopyResource(m_outputTexture.Get(), m_sharedOutput.d3dTex.Get());
@@ -3,12 +3,24 @@
 #include <d3d11.h>
 #include <wrl/client.h>
 
+#include <array>
+#include <future>
 #include <string>
+#include <vector>
+
+#include "gpu_stage_timer.h"
+#include "motion_cache.h"
+#include "frame_graph.h"
+#include "resolution_bucket.h"
+#include "resource_registry.h"
+#include "stage_timer.h"
 
 #ifdef USE_VULKAN
 #include "render_device.h"
 #endif
 
+struct FlowField;
+
 // ============================================================================
 // Interpolator v2 - Rewritten motion estimation & interpolation pipeline
 // ============================================================================
@@ -27,6 +39,10 @@ public:
   };
 
   bool Initialize(ID3D11Device* device, ID3D11DeviceContext* context);
+  // The working set is allocated in resolution buckets (see
+  // ResolutionBucketPool): a size the current one holds only moves its
+  // viewport, a larger one is built in the background, and frames it cannot
+  // hold meanwhile are passed through. The output texture is rebuilt here.
   bool Resize(int inputWidth, int inputHeight, int outputWidth, int outputHeight);
 
 #ifdef USE_VULKAN
@@ -41,7 +57,22 @@ public:
     m_smoothConfPower = confPower;
   }
   void SetQualityMode(int qualityMode) { m_qualityMode = qualityMode; }
-  void SetMinimalMotionPipeline(bool enabled) { m_useMinimalMotionPipeline = enabled; }
+  void SetMinimalMotionPipeline(bool enabled) {
+    m_useMinimalMotionPipeline = enabled;
+    m_resources.SetMinimalPipeline(enabled);
+    PlanFrameGraph();
+  }
+  // Producer-side half-res luma planes (R16, width/2 x height/2) for the
+  // next prev/curr pair. The pair starts the feature pyramid from the planes
+  // instead of reading full-resolution color only when both frames have
+  // one, so a pair never mixes the two feature paths; otherwise both fall
+  // back. The path is part of the motion cache key.
+  void SetSourceLuma(ID3D11ShaderResourceView* prev, ID3D11ShaderResourceView* curr) {
+    const bool pair = prev && curr;
+    m_sourceLumaPrev = pair ? prev : nullptr;
+    m_sourceLumaCurr = pair ? curr : nullptr;
+  }
+  bool UsesSourceLuma() const { return m_sourceLumaPrev && m_sourceLumaCurr && m_downsamplePlaneCs; }
 
   // --- Execution ---
   void Execute(
@@ -50,6 +81,14 @@ public:
       float alpha,
       ID3D11ShaderResourceView* prevDepth = nullptr,
       ID3D11ShaderResourceView* currDepth = nullptr);
+  // Interpolates a pair identified by content. Motion estimation runs only
+  // when the pair is neither the active one nor held in the motion LRU; a
+  // restored pair only re-runs the half-res feature downsample.
+  void ExecuteCached(
+      ID3D11ShaderResourceView* prev,
+      ID3D11ShaderResourceView* curr,
+      float alpha,
+      MotionSetKey key);
   // Re-warp with new alpha using cached motion field (skips motion estimation)
   void InterpolateOnly(
       ID3D11ShaderResourceView* prev,
@@ -67,6 +106,30 @@ public:
   ID3D11Texture2D* OutputTexture() const { return m_outputTexture.Get(); }
   ID3D11ShaderResourceView* OutputSrv() const { return m_outputSrv.Get(); }
 
+  const MotionCacheStats& GetMotionCacheStats() const { return m_motionCache.Stats(); }
+  void ResetMotionCacheStats() { m_motionCache.ResetStats(); }
+
+  // Working-set allocation and build counts across resizes.
+  const ResolutionBucketPool& WorkingSetPool() const { return m_bucketPool; }
+
+  // Every live GPU allocation with its stage, lifetime and whether the
+  // active pipeline reads it.
+  const ResourceRegistry& Resources() const { return m_resources; }
+  // The active pipeline's passes with their barriers, lifetimes and the
+  // memory transient aliasing would save. D3D11 cannot place textures in
+  // shared memory, so this is a plan, not the allocation.
+  const FrameGraph& Graph() const { return m_frameGraph; }
+
+  // Per-stage CPU/GPU timing (off by default; see StageProfiler).
+  void SetStageTimingEnabled(bool enabled) { m_stageProfiler.SetEnabled(enabled); }
+  bool StageTimingEnabled() const { return m_stageProfiler.Enabled(); }
+  // Times only the Execute / InterpolateOnly brackets while full stage
+  // timing is off: one timestamp pair per generation.
+  void SetGenerationTimingEnabled(bool enabled) {
+    m_stageProfiler.SetAlwaysTimed(enabled ? StageBit(PipelineStage::Execute) | StageBit(PipelineStage::InterpolateOnly) : 0);
+  }
+  const StageTimeline& StageTimes() const { return m_stageProfiler.Timeline(); }
+
   // --- Backend info ---
   bool IsVulkan() const { return m_useVulkan; }
   const char* GetBackendName() const { return m_useVulkan ? "Vulkan" : "D3D11"; }
@@ -75,15 +138,67 @@ public:
   bool LoadAttentionWeights(const wchar_t* path);
   bool SaveAttentionWeights(const wchar_t* path) const;
   bool ExportTrainedWeights(const wchar_t* path);  // Export EMA-trained weights from GPU
+  // Writes the motion pyramid of the last estimation as Middlebury .flo,
+  // vectors in texels of each level: prefix_eighth_fwd/_bwd, and with the
+  // full pipeline prefix_quarter_fwd, _half_fwd and _half_smooth. D3D11
+  // only; stalls on the readback. Returns the number of files written.
+  int ExportMotionFields(const std::string& prefix);
   void SetUseCustomWeights(bool use) { m_useCustomWeights = use; }
   bool GetUseCustomWeights() const { return m_useCustomWeights; }
 
 private:
   bool LoadShaders();
-  void CreateResources();
+  bool ReadMotionField(ID3D11Texture2D* texture, FlowField& flow);
+
+  // Working set: every texture sized from the input, described once in
+  // kWorkingTextures. A set is built on any thread (the device is
+  // free-threaded) and adopted on the render thread.
+  struct WorkingTexture {
+    const char* name;                 // resource table name
+    ResourceLevel level;
+    DXGI_FORMAT format;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> Interpolator::*texture;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Interpolator::*srv;    // null: UAV only
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> Interpolator::*uav;
+  };
+  struct PoolTexture {
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> texture;
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+    Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav;
+  };
+  struct WorkingSet {
+    int width = 0;                    // allocation, a resolution bucket
+    int height = 0;
+    std::vector<PoolTexture> textures;    // in kWorkingTextures order
+    bool complete = false;
+  };
+  static const WorkingTexture kWorkingTextures[];
+  static WorkingSet BuildWorkingSet(Microsoft::WRL::ComPtr<ID3D11Device> device, int width, int height);
+  // wait: build on the calling thread even with a set in use.
+  void StartWorkingSet(BucketPlan plan, bool wait = false);
+  bool AdoptWorkingSet(WorkingSet&& set);
+  // Adopts a set whose build finished, or waits for it once the pool says
+  // too many frames have been passed through. False when the set in use
+  // cannot hold the input; curr has then been passed through to the output.
+  bool PollWorkingSet(ID3D11ShaderResourceView* curr);
+  void CreateOutputTexture();
+  void ResetAttentionPriors();
+  void ResetMotionSets();
+  void PlanFrameGraph();
   bool ComputeMotion(
       ID3D11ShaderResourceView* prev,
       ID3D11ShaderResourceView* curr);
+  void DownsampleInputs(
+      ID3D11ShaderResourceView* prev,
+      ID3D11ShaderResourceView* curr);
+  bool RunExecute(
+      ID3D11ShaderResourceView* prev,
+      ID3D11ShaderResourceView* curr,
+      float alpha);
+  uint64_t MotionSettingsKey() const;
+  bool MotionCacheUsable() const;
+  bool StoreMotionSet(int slot);
+  bool RestoreMotionSet(int slot, ID3D11ShaderResourceView* prev, ID3D11ShaderResourceView* curr);
   std::wstring ShaderPath(const wchar_t* filename) const;
 
   // Helpers to dispatch and clear CS state
@@ -176,6 +291,7 @@ private:
   VkSampler m_vkLinearSampler = VK_NULL_HANDLE;
   VkSampler m_vkPointSampler = VK_NULL_HANDLE;
   VkFence m_vkComputeFence = VK_NULL_HANDLE;
+  VkStageTimer m_vkStageTimer;
   bool m_vkResCreated = false;
   bool m_vkZeroCopy = false;  // True if external memory import succeeded
   bool m_vkFullPipeline = false;  // True if full VK pipeline intermediates ready
@@ -201,6 +317,7 @@ private:
   // Compute shaders
   Microsoft::WRL::ComPtr<ID3D11ComputeShader> m_downsampleCs;
   Microsoft::WRL::ComPtr<ID3D11ComputeShader> m_downsampleLumaCs;
+  Microsoft::WRL::ComPtr<ID3D11ComputeShader> m_downsamplePlaneCs;   // optional
   Microsoft::WRL::ComPtr<ID3D11ComputeShader> m_motionCs;
   Microsoft::WRL::ComPtr<ID3D11ComputeShader> m_motionRefineCs;
   Microsoft::WRL::ComPtr<ID3D11ComputeShader> m_motionSmoothCs;
@@ -330,6 +447,32 @@ private:
   Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> m_attnFull2Uav;
   Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> m_attnFull3Uav;
 
+  // Motion LRU: snapshots of the motion/confidence fields the interpolate
+  // pass reads. The minimal pipeline needs the eighth-res forward/backward
+  // fields, the full pipeline the smoothed half-res field.
+  struct MotionSetTextures {
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> motionTiny;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> confidenceTiny;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> motionTinyBackward;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> confidenceTinyBackward;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> motionSmooth;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> confidenceSmooth;
+  };
+  static constexpr int kMotionCacheSlots = 3;
+  MotionSetCache m_motionCache{kMotionCacheSlots};
+  std::array<MotionSetTextures, kMotionCacheSlots> m_motionSets;
+
+  ResourceRegistry m_resources;
+  FrameGraph m_frameGraph;
+
+  // Working-set allocation: the bucket in use and the build in flight.
+  ResolutionBucketPool m_bucketPool;
+  std::future<WorkingSet> m_pendingSet;
+
+  // Stage timing
+  StageProfiler m_stageProfiler;
+  D3D11StageTimer m_d3dStageTimer;
+
   // Constant buffers
   Microsoft::WRL::ComPtr<ID3D11Buffer> m_motionConstants;
   Microsoft::WRL::ComPtr<ID3D11Buffer> m_refineConstants;
@@ -345,6 +488,8 @@ private:
   int m_inputHeight = 0;
   int m_outputWidth = 0;
   int m_outputHeight = 0;
+  int m_poolWidth = 0;               // working-set allocation (>= input)
+  int m_poolHeight = 0;
   int m_lumaWidth = 0;
   int m_lumaHeight = 0;
   int m_smallWidth = 0;
@@ -357,4 +502,6 @@ private:
   float m_smoothEdgeScale = 6.0f;
   float m_smoothConfPower = 1.0f;
   bool m_useMinimalMotionPipeline = true;
+  Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_sourceLumaPrev;
+  Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_sourceLumaCurr;
 };
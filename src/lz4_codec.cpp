@@ -0,0 +1,216 @@
+#include "lz4_codec.h"
+
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;     // a block always ends in literals
+constexpr size_t kMatchFindLimit = 12;  // no match may start in the last 12 bytes
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashBits = 14;
+constexpr uint32_t kSkipTrigger = 6;    // misses before the probe step grows
+
+inline uint32_t Read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t Read64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t Hash4(uint32_t v) {
+  return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+inline size_t CountTrailingZeroBytes(uint64_t v) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, v);
+  return index >> 3;
+#else
+  return static_cast<size_t>(__builtin_ctzll(v)) >> 3;
+#endif
+}
+
+// Length of the common prefix of a and b, reading no further than limit.
+inline size_t MatchLength(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+  const uint8_t* start = a;
+  while (a + 8 <= limit) {
+    uint64_t diff = Read64(a) ^ Read64(b);
+    if (diff) {
+      return static_cast<size_t>(a - start) + CountTrailingZeroBytes(diff);
+    }
+    a += 8;
+    b += 8;
+  }
+  while (a < limit && *a == *b) {
+    a++;
+    b++;
+  }
+  return static_cast<size_t>(a - start);
+}
+
+inline uint8_t* WriteLength(uint8_t* op, size_t len) {
+  while (len >= 255) {
+    *op++ = 255;
+    len -= 255;
+  }
+  *op++ = static_cast<uint8_t>(len);
+  return op;
+}
+
+} // namespace
+
+size_t Lz4CompressBound(size_t n) {
+  return n + n / 255 + 16;
+}
+
+size_t Lz4Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity) {
+  if (dstCapacity < Lz4CompressBound(srcSize)) {
+    return 0;
+  }
+  uint8_t* op = dst;
+  const uint8_t* anchor = src;
+  const uint8_t* const end = src + srcSize;
+
+  if (srcSize >= kMatchFindLimit + 1) {
+    // Positions are stored relative to src; 0 doubles as "empty", which only
+    // costs a failed compare.
+    std::vector<uint32_t> table(size_t(1) << kHashBits, 0);
+    const uint8_t* const matchFindLimit = end - kMatchFindLimit;
+    const uint8_t* const matchLimit = end - kLastLiterals;
+    const uint8_t* ip = src + 1;
+    uint32_t misses = 0;
+
+    while (ip < matchFindLimit) {
+      uint32_t h = Hash4(Read32(ip));
+      const uint8_t* ref = src + table[h];
+      table[h] = static_cast<uint32_t>(ip - src);
+      if (ref >= ip || static_cast<size_t>(ip - ref) > kMaxOffset || Read32(ref) != Read32(ip)) {
+        ip += 1 + (misses++ >> kSkipTrigger);
+        continue;
+      }
+      misses = 0;
+
+      while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+        ip--;
+        ref--;
+      }
+      size_t matchLen = kMinMatch + MatchLength(ip + kMinMatch, ref + kMinMatch, matchLimit);
+      size_t literals = static_cast<size_t>(ip - anchor);
+
+      uint8_t* token = op++;
+      if (literals >= 15) {
+        *token = 15 << 4;
+        op = WriteLength(op, literals - 15);
+      } else {
+        *token = static_cast<uint8_t>(literals << 4);
+      }
+      std::memcpy(op, anchor, literals);
+      op += literals;
+
+      uint16_t offset = static_cast<uint16_t>(ip - ref);
+      *op++ = static_cast<uint8_t>(offset);
+      *op++ = static_cast<uint8_t>(offset >> 8);
+      size_t extra = matchLen - kMinMatch;
+      if (extra >= 15) {
+        *token |= 15;
+        op = WriteLength(op, extra - 15);
+      } else {
+        *token |= static_cast<uint8_t>(extra);
+      }
+
+      ip += matchLen;
+      anchor = ip;
+      if (ip < matchFindLimit) {
+        table[Hash4(Read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+      }
+    }
+  }
+
+  size_t literals = static_cast<size_t>(end - anchor);
+  if (literals >= 15) {
+    *op++ = 15 << 4;
+    op = WriteLength(op, literals - 15);
+  } else {
+    *op++ = static_cast<uint8_t>(literals << 4);
+  }
+  if (literals > 0) {
+    std::memcpy(op, anchor, literals);
+    op += literals;
+  }
+  return static_cast<size_t>(op - dst);
+}
+
+bool Lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+  const uint8_t* ip = src;
+  const uint8_t* const ipEnd = src + srcSize;
+  uint8_t* op = dst;
+  uint8_t* const opEnd = dst + dstSize;
+
+  auto readLength = [&](size_t& len) {
+    uint8_t b;
+    do {
+      if (ip >= ipEnd) {
+        return false;
+      }
+      b = *ip++;
+      len += b;
+    } while (b == 255);
+    return true;
+  };
+
+  while (ip < ipEnd) {
+    const uint8_t token = *ip++;
+    size_t literals = token >> 4;
+    if (literals == 15 && !readLength(literals)) {
+      return false;
+    }
+    if (literals > static_cast<size_t>(ipEnd - ip) || literals > static_cast<size_t>(opEnd - op)) {
+      return false;
+    }
+    if (literals > 0) {
+      std::memcpy(op, ip, literals);
+      ip += literals;
+      op += literals;
+    }
+    if (ip == ipEnd) {
+      break;  // last sequence: literals only
+    }
+
+    if (ipEnd - ip < 2) {
+      return false;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t matchLen = token & 15;
+    if (matchLen == 15 && !readLength(matchLen)) {
+      return false;
+    }
+    matchLen += kMinMatch;
+    if (offset == 0 || offset > static_cast<size_t>(op - dst) || matchLen > static_cast<size_t>(opEnd - op)) {
+      return false;
+    }
+    const uint8_t* ref = op - offset;
+    if (offset >= matchLen) {
+      std::memcpy(op, ref, matchLen);
+      op += matchLen;
+    } else {
+      // Overlapping copy repeats the last `offset` bytes.
+      for (size_t i = 0; i < matchLen; ++i) {
+        *op++ = *ref++;
+      }
+    }
+  }
+  return op == opEnd;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// LZ4 block format codec for the frame stream recorder.
+//
+// Produces and reads standard LZ4 blocks (what LZ4_compress_default /
+// LZ4_decompress_safe use), so recordings stay readable with the reference
+// library, without pulling it into the build. The compressor is the greedy
+// single-probe variant (level 1 equivalent): captured frames are large and
+// the point is to keep the writer thread ahead of the capture rate, not to
+// find every match.
+
+// Worst-case compressed size of n input bytes.
+size_t Lz4CompressBound(size_t n);
+
+// Compresses src into dst. Returns the compressed size, or 0 if dst is too
+// small (dstCapacity >= Lz4CompressBound(srcSize) always suffices).
+size_t Lz4Compress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity);
+
+// Decompresses a block that must expand to exactly dstSize bytes. Returns
+// false on malformed input; never reads or writes out of bounds.
+bool Lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
@@ -0,0 +1,53 @@
+#include "motion_cache.h"
+
+#include <algorithm>
+
+MotionSetCache::MotionSetCache(int slots) : m_entries(static_cast<size_t>(std::max(slots, 1))) {}
+
+void MotionSetCache::Invalidate() {
+  for (Entry& entry : m_entries) {
+    entry = Entry();
+  }
+  m_hasActive = false;
+}
+
+void MotionSetCache::SetActive(const MotionSetKey& key) {
+  m_active = key;
+  m_hasActive = true;
+}
+
+int MotionSetCache::Find(const MotionSetKey& key) {
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    if (m_entries[i].valid && m_entries[i].key == key) {
+      m_entries[i].lastUse = ++m_useCounter;
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+int MotionSetCache::Insert(const MotionSetKey& key) {
+  size_t victim = 0;
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    if (!m_entries[i].valid) {
+      victim = i;
+      break;
+    }
+    if (m_entries[i].lastUse < m_entries[victim].lastUse) {
+      victim = i;
+    }
+  }
+  if (m_entries[victim].valid) {
+    m_stats.evictions++;
+  }
+  m_entries[victim].key = key;
+  m_entries[victim].valid = true;
+  m_entries[victim].lastUse = ++m_useCounter;
+  return static_cast<int>(victim);
+}
+
+void MotionSetCache::Erase(int slot) {
+  if (slot >= 0 && slot < static_cast<int>(m_entries.size())) {
+    m_entries[static_cast<size_t>(slot)] = Entry();
+  }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// LRU bookkeeping for estimated motion fields keyed by frame content.
+//
+// A motion set belongs to a (prev, curr) pair of captured frames, not to the
+// queue slots they happen to sit in. Keying it by the capture sequence number
+// and timestamp of both frames lets the render loop re-select a pair after a
+// queue trim, a stale-frame drop or a multiplier change without running
+// motion estimation again. The settings hash covers everything that changes
+// the motion result (pipeline, motion model, smoothing), so a settings change
+// simply stops matching the old entries.
+//
+// This class only does the bookkeeping; the interpolator keeps the textures
+// and indexes them by slot.
+
+struct MotionSetKey {
+  uint64_t prevSequence = 0;
+  int64_t prevTime100ns = 0;
+  uint64_t currSequence = 0;
+  int64_t currTime100ns = 0;
+  uint64_t settings = 0;
+
+  bool operator==(const MotionSetKey& other) const {
+    return prevSequence == other.prevSequence && prevTime100ns == other.prevTime100ns &&
+           currSequence == other.currSequence && currTime100ns == other.currTime100ns &&
+           settings == other.settings;
+  }
+  bool operator!=(const MotionSetKey& other) const { return !(*this == other); }
+};
+
+struct MotionCacheStats {
+  uint64_t requests = 0;
+  uint64_t activeReuses = 0;     // pair already in the working motion textures
+  uint64_t restores = 0;         // pair restored from an LRU slot
+  uint64_t computes = 0;         // full motion estimation
+  uint64_t evictions = 0;
+
+  // Fraction of pair requests that skipped motion estimation.
+  double HitRate() const {
+    return requests > 0 ? static_cast<double>(activeReuses + restores) / static_cast<double>(requests) : 0.0;
+  }
+};
+
+class MotionSetCache {
+public:
+  explicit MotionSetCache(int slots = 3);
+
+  int SlotCount() const { return static_cast<int>(m_entries.size()); }
+
+  // Drops every entry and the active pair (textures recreated).
+  void Invalidate();
+
+  // The pair currently held in the interpolator's working motion textures.
+  bool IsActive(const MotionSetKey& key) const { return m_hasActive && m_active == key; }
+  void SetActive(const MotionSetKey& key);
+  void ClearActive() { m_hasActive = false; }
+
+  // Returns the slot holding this pair, or -1 on a miss.
+  int Find(const MotionSetKey& key);
+  // Reserves a slot for a freshly computed pair (evicts the LRU entry).
+  int Insert(const MotionSetKey& key);
+  // Releases a slot whose snapshot could not be stored.
+  void Erase(int slot);
+
+  void RecordRequest() { m_stats.requests++; }
+  void RecordActiveReuse() { m_stats.activeReuses++; }
+  void RecordRestore() { m_stats.restores++; }
+  void RecordCompute() { m_stats.computes++; }
+
+  const MotionCacheStats& Stats() const { return m_stats; }
+  void ResetStats() { m_stats = MotionCacheStats(); }
+
+private:
+  struct Entry {
+    MotionSetKey key;
+    bool valid = false;
+    uint64_t lastUse = 0;
+  };
+
+  std::vector<Entry> m_entries;
+  MotionSetKey m_active;
+  bool m_hasActive = false;
+  uint64_t m_useCounter = 0;
+  MotionCacheStats m_stats;
+};
@@ -0,0 +1,54 @@
+#include "motion_model.h"
+
+#include <algorithm>
+
+const char* MotionModelName(int model) {
+  switch (static_cast<MotionModel>(std::clamp(model, 0, kMotionModelCount - 1))) {
+    case MotionModel::Adaptive:
+      return "Adaptive";
+    case MotionModel::Stable:
+      return "Stable";
+    case MotionModel::Balanced:
+      return "Balanced";
+    case MotionModel::Coverage:
+      return "Coverage";
+    case MotionModel::Count:
+      break;
+  }
+  return "";
+}
+
+MotionSearchParams MotionSearchParamsFor(int model, bool minimalPipeline) {
+  MotionSearchParams p;   // Balanced
+  if (minimalPipeline) {
+    p.tinyRadiusFwd = 4; p.tinyRadiusBwd = 4;
+    p.attnLearnRate = 0.03f;
+    p.attnPriorMix = 0.30f;
+    p.attnStability = 0.65f;
+    return p;
+  }
+  switch (static_cast<MotionModel>(std::clamp(model, 0, kMotionModelCount - 1))) {
+    case MotionModel::Adaptive:
+      p.tinyRadiusFwd = 16; p.tinyRadiusBwd = 16; p.refineSmallR = 12; p.refineFullR = 8;
+      p.attnLearnRate = 0.09f;
+      p.attnPriorMix = 0.55f;
+      p.attnStability = 0.28f;
+      break;
+    case MotionModel::Stable:
+      p.tinyRadiusFwd = 8; p.tinyRadiusBwd = 8; p.refineSmallR = 6; p.refineFullR = 4;
+      p.attnLearnRate = 0.04f;
+      p.attnPriorMix = 0.65f;
+      p.attnStability = 0.70f;
+      break;
+    case MotionModel::Coverage:
+      p.tinyRadiusFwd = 24; p.tinyRadiusBwd = 24; p.refineSmallR = 16; p.refineFullR = 12;
+      p.attnLearnRate = 0.11f;
+      p.attnPriorMix = 0.40f;
+      p.attnStability = 0.22f;
+      break;
+    case MotionModel::Balanced:
+    case MotionModel::Count:
+      break;
+  }
+  return p;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+// Motion model presets (the UI's "Motion Model" combo, Interpolator's
+// m_motionModel). Each one fixes the search radii of the motion passes and
+// the attention update rates of the refine passes; the minimal pipeline
+// overrides them with its own short eighth-res search.
+
+enum class MotionModel : int {
+  Adaptive = 0,
+  Stable = 1,
+  Balanced = 2,
+  Coverage = 3,
+  Count,
+};
+
+constexpr int kMotionModelCount = static_cast<int>(MotionModel::Count);
+
+const char* MotionModelName(int model);
+
+struct MotionSearchParams {
+  int tinyRadiusFwd = 12;       // eighth-res search, texels
+  int tinyRadiusBwd = 12;
+  int refineSmallR = 8;         // quarter-res refine
+  int refineFullR = 6;          // half-res refine
+  float attnLearnRate = 0.08f;
+  float attnPriorMix = 0.45f;
+  float attnStability = 0.35f;
+};
+
+// Model outside [0, kMotionModelCount) is clamped.
+MotionSearchParams MotionSearchParamsFor(int model, bool minimalPipeline);
@@ -0,0 +1,108 @@
+#include "output_cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Weight of the newest sample in the per-generation cost averages.
+constexpr double kCostSmoothing = 0.1;
+
+} // namespace
+
+OutputFrameCache::OutputFrameCache(int slots) : m_entries(static_cast<size_t>(std::max(slots, 1))) {}
+
+void OutputFrameCache::SetStep(float step) {
+  step = std::clamp(step, 0.001f, 0.5f);
+  if (step != m_step) {
+    m_step = step;
+    Invalidate();
+  }
+}
+
+void OutputFrameCache::Invalidate() {
+  for (Entry& entry : m_entries) {
+    entry = Entry();
+  }
+  // Output ids are derived from the generation; frames generated after an
+  // invalidation must not match the one already on screen.
+  m_generation++;
+}
+
+bool OutputFrameCache::BeginPair(int64_t prevId, int64_t currId) {
+  if (m_hasPair && prevId == m_prevId && currId == m_currId) {
+    return false;
+  }
+  m_prevId = prevId;
+  m_currId = currId;
+  m_hasPair = true;
+  m_stats.pairs++;
+  Invalidate();
+  return true;
+}
+
+int OutputFrameCache::Bucket(float alpha) const {
+  alpha = std::clamp(alpha, 0.0f, 1.0f);
+  return static_cast<int>(std::lround(alpha / m_step));
+}
+
+float OutputFrameCache::BucketAlpha(int bucket) const {
+  return std::clamp(static_cast<float>(bucket) * m_step, 0.0f, 1.0f);
+}
+
+int OutputFrameCache::Lookup(int bucket) {
+  m_stats.lookups++;
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    if (m_entries[i].bucket == bucket) {
+      m_entries[i].lastUse = ++m_useCounter;
+      m_stats.hits++;
+      m_stats.savedCpuSec += m_stats.avgMissCpuSec;
+      m_stats.savedGpuSec += m_stats.avgMissGpuSec;
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+int OutputFrameCache::Insert(int bucket) {
+  size_t victim = 0;
+  for (size_t i = 0; i < m_entries.size(); ++i) {
+    if (m_entries[i].bucket < 0) {
+      victim = i;
+      break;
+    }
+    if (m_entries[i].lastUse < m_entries[victim].lastUse) {
+      victim = i;
+    }
+  }
+  if (m_entries[victim].bucket >= 0) {
+    m_stats.evictions++;
+  }
+  m_entries[victim].bucket = bucket;
+  m_entries[victim].lastUse = ++m_useCounter;
+  return static_cast<int>(victim);
+}
+
+void OutputFrameCache::RecordMissCost(double cpuSec, double gpuSec) {
+  if (cpuSec > 0.0) {
+    m_stats.avgMissCpuSec = (m_stats.avgMissCpuSec <= 0.0)
+        ? cpuSec
+        : m_stats.avgMissCpuSec * (1.0 - kCostSmoothing) + cpuSec * kCostSmoothing;
+  }
+  RecordGpuCost(gpuSec);
+}
+
+void OutputFrameCache::RecordGpuCost(double gpuSec) {
+  if (gpuSec > 0.0) {
+    m_stats.avgMissGpuSec = (m_stats.avgMissGpuSec <= 0.0)
+        ? gpuSec
+        : m_stats.avgMissGpuSec * (1.0 - kCostSmoothing) + gpuSec * kCostSmoothing;
+  }
+}
+
+void OutputFrameCache::ResetStats() {
+  OutputCacheStats fresh;
+  fresh.avgMissCpuSec = m_stats.avgMissCpuSec;
+  fresh.avgMissGpuSec = m_stats.avgMissGpuSec;
+  m_stats = fresh;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Per-pair cache of generated output frames keyed by quantized alpha.
+//
+// When the render loop runs faster than the alpha actually advances (unlocked
+// app FPS, monitor-sync output well above the source rate) consecutive frames
+// fall into the same alpha bucket. The cache maps a bucket to one of a few
+// storage slots so the frame is generated once per bucket and re-presented
+// from the slot afterwards. Frames are always generated at the bucket's centre
+// alpha, so a hit is bit-identical to a miss.
+//
+// This class only does the bookkeeping; the owner keeps the textures and
+// indexes them by slot.
+
+struct OutputCacheStats {
+  uint64_t lookups = 0;
+  uint64_t hits = 0;
+  uint64_t evictions = 0;
+  uint64_t pairs = 0;
+  uint64_t presentsSkipped = 0;
+  double avgMissCpuSec = 0.0;    // submit cost of one generation
+  double avgMissGpuSec = 0.0;    // GPU cost of one generation (0 if unknown)
+  double savedCpuSec = 0.0;
+  double savedGpuSec = 0.0;
+
+  double HitRate() const {
+    return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+  }
+};
+
+class OutputFrameCache {
+public:
+  explicit OutputFrameCache(int slots = 4);
+
+  void SetStep(float step);
+  float Step() const { return m_step; }
+  int SlotCount() const { return static_cast<int>(m_entries.size()); }
+
+  // Drops every entry (settings or output size changed) and starts a new
+  // generation.
+  void Invalidate();
+
+  // Starts a new (prev, curr) pair; entries from another pair are dropped.
+  // Returns true if the pair changed.
+  bool BeginPair(int64_t prevId, int64_t currId);
+  // Changes with every pair and every invalidation: outputs of different
+  // generations never share an id.
+  uint64_t PairGeneration() const { return m_generation; }
+
+  int Bucket(float alpha) const;
+  float BucketAlpha(int bucket) const;
+
+  // Returns the slot holding this bucket, or -1 on a miss.
+  int Lookup(int bucket);
+  // Reserves a slot for a freshly generated bucket (evicts the LRU entry).
+  int Insert(int bucket);
+
+  void RecordMissCost(double cpuSec, double gpuSec);
+  void RecordGpuCost(double gpuSec);
+  void RecordPresentSkipped() { m_stats.presentsSkipped++; }
+
+  const OutputCacheStats& Stats() const { return m_stats; }
+  void ResetStats();
+
+private:
+  struct Entry {
+    int bucket = -1;
+    uint64_t lastUse = 0;
+  };
+
+  std::vector<Entry> m_entries;
+  float m_step = 1.0f / 64.0f;
+  int64_t m_prevId = 0;
+  int64_t m_currId = 0;
+  bool m_hasPair = false;
+  uint64_t m_generation = 0;
+  uint64_t m_useCounter = 0;
+  OutputCacheStats m_stats;
+};
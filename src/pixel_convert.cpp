@@ -0,0 +1,594 @@
+#include "pixel_convert.h"
+#include "simd_target.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(TFE_SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+constexpr int kSrgbLutSize = 4096;
+constexpr float kSrgbLutScale = static_cast<float>(kSrgbLutSize - 1);
+constexpr uint32_t kHalfMagicBits = 0x77800000u;   // 2^112 as float
+
+struct ToneParams {
+  float exposure = 1.0f;
+  bool toneMap = true;
+};
+
+// Linear [0, 1] -> sRGB 8-bit. uint32 entries so AVX2 can gather them.
+struct SrgbLut {
+  uint32_t v[kSrgbLutSize];
+
+  SrgbLut() {
+    for (int i = 0; i < kSrgbLutSize; ++i) {
+      double l = static_cast<double>(i) / (kSrgbLutSize - 1);
+      double s = (l <= 0.0031308) ? 12.92 * l : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+      v[i] = static_cast<uint32_t>(std::lround(std::clamp(s, 0.0, 1.0) * 255.0));
+    }
+  }
+};
+
+const uint32_t* SrgbTable() {
+  static const SrgbLut lut;
+  return lut.v;
+}
+
+using RowFn = void (*)(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone);
+using LumaFn = void (*)(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t outWidth, bool rgba);
+
+struct Kernels {
+  RowFn swapRb;
+  RowFn rgb10a2;
+  RowFn rgba16f;
+  LumaFn luma;
+};
+
+// ----------------------------------------------------------------------------
+// Scalar reference
+// ----------------------------------------------------------------------------
+
+inline float HalfToFloat(uint16_t h) {
+  uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+  uint32_t em = static_cast<uint32_t>(h & 0x7FFFu) << 13;
+  uint32_t bits;
+  if ((h & 0x7C00u) == 0x7C00u) {
+    bits = em | 0x7F800000u;   // Inf / NaN
+  } else {
+    // Rebias the exponent with one multiply; also exact for denormals.
+    float f;
+    float magic;
+    std::memcpy(&f, &em, sizeof(f));
+    std::memcpy(&magic, &kHalfMagicBits, sizeof(magic));
+    f *= magic;
+    std::memcpy(&bits, &f, sizeof(bits));
+  }
+  bits |= sign;
+  float out;
+  std::memcpy(&out, &bits, sizeof(out));
+  return out;
+}
+
+// Written as compares so NaN lands on the same side as the SIMD max/min.
+inline uint32_t ToneMapIndex(float x, const ToneParams& tone) {
+  float t = x * tone.exposure;
+  t = (t > 0.0f) ? t : 0.0f;
+  if (tone.toneMap) {
+    t = t / (1.0f + t);
+  }
+  t = (t < 1.0f) ? t : 1.0f;
+  return static_cast<uint32_t>(std::lrintf(t * kSrgbLutScale));
+}
+
+inline uint32_t AlphaToByte(float a) {
+  a = (a > 0.0f) ? a : 0.0f;
+  a = (a < 1.0f) ? a : 1.0f;
+  return static_cast<uint32_t>(std::lrintf(a * 255.0f));
+}
+
+inline uint32_t Unorm10To8(uint32_t v) {
+  return (v * 255u + 512u) >> 10;
+}
+
+inline void StorePixel(uint8_t* dst, uint32_t bgra) {
+  std::memcpy(dst, &bgra, sizeof(bgra));
+}
+
+void SwapRbScalar(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams&) {
+  for (uint32_t x = 0; x < width; ++x) {
+    uint8_t r = src[0];
+    uint8_t g = src[1];
+    uint8_t b = src[2];
+    uint8_t a = src[3];
+    dst[0] = b;
+    dst[1] = g;
+    dst[2] = r;
+    dst[3] = a;
+    src += 4;
+    dst += 4;
+  }
+}
+
+void Rgb10a2Scalar(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams&) {
+  for (uint32_t x = 0; x < width; ++x) {
+    uint32_t p;
+    std::memcpy(&p, src + x * 4, sizeof(p));
+    uint32_t r = Unorm10To8(p & 0x3FFu);
+    uint32_t g = Unorm10To8((p >> 10) & 0x3FFu);
+    uint32_t b = Unorm10To8((p >> 20) & 0x3FFu);
+    uint32_t a = (p >> 30) * 85u;
+    StorePixel(dst + x * 4, b | (g << 8) | (r << 16) | (a << 24));
+  }
+}
+
+void Rgba16fScalar(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const uint32_t* lut = SrgbTable();
+  for (uint32_t x = 0; x < width; ++x) {
+    uint16_t h[4];
+    std::memcpy(h, src + x * 8, sizeof(h));
+    uint32_t r = lut[ToneMapIndex(HalfToFloat(h[0]), tone)];
+    uint32_t g = lut[ToneMapIndex(HalfToFloat(h[1]), tone)];
+    uint32_t b = lut[ToneMapIndex(HalfToFloat(h[2]), tone)];
+    uint32_t a = AlphaToByte(HalfToFloat(h[3]));
+    StorePixel(dst + x * 4, b | (g << 8) | (r << 16) | (a << 24));
+  }
+}
+
+// out receives outWidth 16-bit samples.
+void LumaScalar(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t outWidth, bool rgba) {
+  const int ri = rgba ? 0 : 2;
+  const int bi = rgba ? 2 : 0;
+  auto weighted = [ri, bi](const uint8_t* p) {
+    return kPlaneLumaWr * p[ri] + kPlaneLumaWg * p[1] + kPlaneLumaWb * p[bi];
+  };
+  for (uint32_t x = 0; x < outWidth; ++x) {
+    const uint8_t* p0 = row0 + x * 8;
+    const uint8_t* p1 = row1 + x * 8;
+    uint16_t v = PlaneLuma(weighted(p0) + weighted(p0 + 4) + weighted(p1) + weighted(p1 + 4));
+    std::memcpy(out + x * 2, &v, sizeof(v));
+  }
+}
+
+constexpr Kernels kScalarKernels = {SwapRbScalar, Rgb10a2Scalar, Rgba16fScalar, LumaScalar};
+
+#if defined(TFE_SIMD_X86)
+
+// ----------------------------------------------------------------------------
+// SSE4.1
+// ----------------------------------------------------------------------------
+
+TFE_TARGET_SSE41 inline __m128i SwapRbMask128() {
+  return _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+}
+
+TFE_TARGET_SSE41 inline __m128i Unorm10To8Sse(__m128i v) {
+  __m128i scaled = _mm_sub_epi32(_mm_slli_epi32(v, 8), v);
+  return _mm_srli_epi32(_mm_add_epi32(scaled, _mm_set1_epi32(512)), 10);
+}
+
+TFE_TARGET_SSE41 inline __m128 HalfToFloatSse(__m128i h) {
+  __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+  __m128i em = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7FFF)), 13);
+  __m128i special = _mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7C00)), _mm_set1_epi32(0x7C00));
+  __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(kHalfMagicBits)));
+  __m128i normal = _mm_castps_si128(_mm_mul_ps(_mm_castsi128_ps(em), magic));
+  __m128i infNan = _mm_or_si128(em, _mm_set1_epi32(0x7F800000));
+  return _mm_castsi128_ps(_mm_or_si128(_mm_blendv_epi8(normal, infNan, special), sign));
+}
+
+TFE_TARGET_SSE41 void SwapRbSse41(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const __m128i mask = SwapRbMask128();
+  uint32_t x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_shuffle_epi8(v, mask));
+  }
+  SwapRbScalar(src + x * 4, dst + x * 4, width - x, tone);
+}
+
+TFE_TARGET_SSE41 void Rgb10a2Sse41(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const __m128i m10 = _mm_set1_epi32(0x3FF);
+  uint32_t x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+    __m128i r = Unorm10To8Sse(_mm_and_si128(v, m10));
+    __m128i g = Unorm10To8Sse(_mm_and_si128(_mm_srli_epi32(v, 10), m10));
+    __m128i b = Unorm10To8Sse(_mm_and_si128(_mm_srli_epi32(v, 20), m10));
+    __m128i a = _mm_mullo_epi32(_mm_srli_epi32(v, 30), _mm_set1_epi32(85));
+    __m128i out = _mm_or_si128(_mm_or_si128(b, _mm_slli_epi32(g, 8)),
+                               _mm_or_si128(_mm_slli_epi32(r, 16), _mm_slli_epi32(a, 24)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), out);
+  }
+  Rgb10a2Scalar(src + x * 4, dst + x * 4, width - x, tone);
+}
+
+TFE_TARGET_SSE41 void Rgba16fSse41(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const uint32_t* lut = SrgbTable();
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 exposure = _mm_set1_ps(tone.exposure);
+  const __m128 lutScale = _mm_set1_ps(kSrgbLutScale);
+  const __m128 alphaScale = _mm_set1_ps(255.0f);
+  uint32_t x = 0;
+  for (; x + 2 <= width; x += 2) {
+    __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 8));
+    for (int i = 0; i < 2; ++i) {
+      __m128i h = _mm_cvtepu16_epi32(i == 0 ? halves : _mm_srli_si128(halves, 8));
+      __m128 f = HalfToFloatSse(h);
+      __m128 t = _mm_max_ps(_mm_mul_ps(f, exposure), zero);
+      if (tone.toneMap) {
+        t = _mm_div_ps(t, _mm_add_ps(one, t));
+      }
+      t = _mm_min_ps(t, one);
+      __m128i idx = _mm_cvtps_epi32(_mm_mul_ps(t, lutScale));
+      __m128i alpha = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(f, zero), one), alphaScale));
+      uint32_t r = lut[_mm_cvtsi128_si32(idx)];
+      uint32_t g = lut[_mm_extract_epi32(idx, 1)];
+      uint32_t b = lut[_mm_extract_epi32(idx, 2)];
+      uint32_t a = static_cast<uint32_t>(_mm_extract_epi32(alpha, 3));
+      StorePixel(dst + (x + i) * 4, b | (g << 8) | (r << 16) | (a << 24));
+    }
+  }
+  Rgba16fScalar(src + x * 8, dst + x * 4, width - x, tone);
+}
+
+// Weighted sums of four BGRA/RGBA pixels: madd gives (b*wb + g*wg) and
+// (r*wr + a*0) per pixel, hadd finishes the dot.
+TFE_TARGET_SSE41 inline __m128i WeightedLuma4(const uint8_t* p, __m128i weights) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  return _mm_hadd_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights),
+                        _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights));
+}
+
+TFE_TARGET_SSE41 void LumaSse41(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t outWidth, bool rgba) {
+  const short wr = static_cast<short>(kPlaneLumaWr);
+  const short wg = static_cast<short>(kPlaneLumaWg);
+  const short wb = static_cast<short>(kPlaneLumaWb);
+  const __m128i weights = rgba ? _mm_setr_epi16(wr, wg, wb, 0, wr, wg, wb, 0)
+                               : _mm_setr_epi16(wb, wg, wr, 0, wb, wg, wr, 0);
+  const __m128i scale = _mm_set1_epi32(257);
+  const __m128i round = _mm_set1_epi32(1 << 14);
+  uint32_t x = 0;
+  for (; x + 4 <= outWidth; x += 4) {
+    const uint8_t* p0 = row0 + x * 8;
+    const uint8_t* p1 = row1 + x * 8;
+    // Column sums of the row pair, then horizontal pairs -> four blocks.
+    __m128i lo = _mm_add_epi32(WeightedLuma4(p0, weights), WeightedLuma4(p1, weights));
+    __m128i hi = _mm_add_epi32(WeightedLuma4(p0 + 16, weights), WeightedLuma4(p1 + 16, weights));
+    __m128i sum = _mm_hadd_epi32(lo, hi);
+    sum = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(sum, scale), round), 15);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 2), _mm_packus_epi32(sum, sum));
+  }
+  LumaScalar(row0 + x * 8, row1 + x * 8, out + x * 2, outWidth - x, rgba);
+}
+
+constexpr Kernels kSse41Kernels = {SwapRbSse41, Rgb10a2Sse41, Rgba16fSse41, LumaSse41};
+
+// ----------------------------------------------------------------------------
+// AVX2 (+F16C)
+// ----------------------------------------------------------------------------
+
+TFE_TARGET_AVX2_F16C inline __m256i Unorm10To8Avx2(__m256i v) {
+  __m256i scaled = _mm256_sub_epi32(_mm256_slli_epi32(v, 8), v);
+  return _mm256_srli_epi32(_mm256_add_epi32(scaled, _mm256_set1_epi32(512)), 10);
+}
+
+TFE_TARGET_AVX2_F16C void SwapRbAvx2(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const __m256i mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  uint32_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_shuffle_epi8(v, mask));
+  }
+  SwapRbScalar(src + x * 4, dst + x * 4, width - x, tone);
+}
+
+TFE_TARGET_AVX2_F16C void Rgb10a2Avx2(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const __m256i m10 = _mm256_set1_epi32(0x3FF);
+  uint32_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+    __m256i r = Unorm10To8Avx2(_mm256_and_si256(v, m10));
+    __m256i g = Unorm10To8Avx2(_mm256_and_si256(_mm256_srli_epi32(v, 10), m10));
+    __m256i b = Unorm10To8Avx2(_mm256_and_si256(_mm256_srli_epi32(v, 20), m10));
+    __m256i a = _mm256_mullo_epi32(_mm256_srli_epi32(v, 30), _mm256_set1_epi32(85));
+    __m256i out = _mm256_or_si256(_mm256_or_si256(b, _mm256_slli_epi32(g, 8)),
+                                  _mm256_or_si256(_mm256_slli_epi32(r, 16), _mm256_slli_epi32(a, 24)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), out);
+  }
+  Rgb10a2Scalar(src + x * 4, dst + x * 4, width - x, tone);
+}
+
+TFE_TARGET_AVX2_F16C void Rgba16fAvx2(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const int* lut = reinterpret_cast<const int*>(SrgbTable());
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 exposure = _mm256_set1_ps(tone.exposure);
+  const __m256 lutScale = _mm256_set1_ps(kSrgbLutScale);
+  const __m256 alphaScale = _mm256_set1_ps(255.0f);
+  // packus interleaves the 128-bit lanes; this puts pixels back in order.
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  const __m256i rgbaToBgra = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                              2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  uint32_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256i px[4];
+    for (int k = 0; k < 4; ++k) {
+      // Two pixels: R0 G0 B0 A0 R1 G1 B1 A1.
+      __m256 f = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (x + k * 2) * 8)));
+      __m256 t = _mm256_max_ps(_mm256_mul_ps(f, exposure), zero);
+      if (tone.toneMap) {
+        t = _mm256_div_ps(t, _mm256_add_ps(one, t));
+      }
+      t = _mm256_min_ps(t, one);
+      __m256i color = _mm256_i32gather_epi32(lut, _mm256_cvtps_epi32(_mm256_mul_ps(t, lutScale)), 4);
+      __m256i alpha = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(f, zero), one), alphaScale));
+      px[k] = _mm256_blend_epi32(color, alpha, 0x88);
+    }
+    __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(px[0], px[1]), _mm256_packus_epi32(px[2], px[3]));
+    bytes = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(bytes, order), rgbaToBgra);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), bytes);
+  }
+  Rgba16fScalar(src + x * 8, dst + x * 4, width - x, tone);
+}
+
+// Luma is a small fraction of the row cost; AVX2 reuses the SSE kernel.
+constexpr Kernels kAvx2Kernels = {SwapRbAvx2, Rgb10a2Avx2, Rgba16fAvx2, LumaSse41};
+
+void Cpuid(int leaf, int subleaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+  int out[4];
+  __cpuidex(out, leaf, subleaf);
+  for (int i = 0; i < 4; ++i) regs[i] = static_cast<uint32_t>(out[i]);
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64_t ReadXcr0() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t lo = 0;
+  uint32_t hi = 0;
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+SimdLevel DetectX86() {
+  uint32_t regs[4] = {};
+  Cpuid(0, 0, regs);
+  uint32_t maxLeaf = regs[0];
+  Cpuid(1, 0, regs);
+  const uint32_t ecx = regs[2];
+  bool ssse3 = (ecx & (1u << 9)) != 0;
+  bool sse41 = (ecx & (1u << 19)) != 0;
+  if (!ssse3 || !sse41) {
+    return SimdLevel::Scalar;
+  }
+  bool osxsave = (ecx & (1u << 27)) != 0;
+  bool avx = (ecx & (1u << 28)) != 0;
+  bool f16c = (ecx & (1u << 29)) != 0;
+  bool avx2 = false;
+  if (maxLeaf >= 7) {
+    Cpuid(7, 0, regs);
+    avx2 = (regs[1] & (1u << 5)) != 0;
+  }
+  bool osAvx = osxsave && avx && (ReadXcr0() & 0x6) == 0x6;
+  return (osAvx && avx2 && f16c) ? SimdLevel::Avx2 : SimdLevel::Sse41;
+}
+
+#endif // TFE_SIMD_X86
+
+#if defined(TFE_SIMD_NEON)
+
+// ----------------------------------------------------------------------------
+// NEON (AArch64)
+// ----------------------------------------------------------------------------
+
+inline uint32x4_t Unorm10To8Neon(uint32x4_t v) {
+  return vshrq_n_u32(vmlaq_n_u32(vdupq_n_u32(512), v, 255), 10);
+}
+
+void SwapRbNeon(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  uint32_t x = 0;
+  for (; x + 16 <= width; x += 16) {
+    uint8x16x4_t p = vld4q_u8(src + x * 4);
+    uint8x16_t r = p.val[0];
+    p.val[0] = p.val[2];
+    p.val[2] = r;
+    vst4q_u8(dst + x * 4, p);
+  }
+  SwapRbScalar(src + x * 4, dst + x * 4, width - x, tone);
+}
+
+void Rgb10a2Neon(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const uint32x4_t m10 = vdupq_n_u32(0x3FF);
+  uint32_t x = 0;
+  for (; x + 4 <= width; x += 4) {
+    uint32x4_t v = vreinterpretq_u32_u8(vld1q_u8(src + x * 4));
+    uint32x4_t r = Unorm10To8Neon(vandq_u32(v, m10));
+    uint32x4_t g = Unorm10To8Neon(vandq_u32(vshrq_n_u32(v, 10), m10));
+    uint32x4_t b = Unorm10To8Neon(vandq_u32(vshrq_n_u32(v, 20), m10));
+    uint32x4_t a = vmulq_n_u32(vshrq_n_u32(v, 30), 85);
+    uint32x4_t out = vorrq_u32(vorrq_u32(b, vshlq_n_u32(g, 8)),
+                               vorrq_u32(vshlq_n_u32(r, 16), vshlq_n_u32(a, 24)));
+    vst1q_u8(dst + x * 4, vreinterpretq_u8_u32(out));
+  }
+  Rgb10a2Scalar(src + x * 4, dst + x * 4, width - x, tone);
+}
+
+void Rgba16fNeon(const uint8_t* src, uint8_t* dst, uint32_t width, const ToneParams& tone) {
+  const uint32_t* lut = SrgbTable();
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  uint32_t x = 0;
+  for (; x < width; ++x) {
+    float32x4_t f = vcvt_f32_f16(vreinterpret_f16_u8(vld1_u8(src + x * 8)));
+    // Select instead of vmaxq/vminq: those propagate NaN, the reference
+    // (and SSE) maps it to 0.
+    float32x4_t t = vmulq_n_f32(f, tone.exposure);
+    t = vbslq_f32(vcgtq_f32(t, zero), t, zero);
+    if (tone.toneMap) {
+      t = vdivq_f32(t, vaddq_f32(one, t));
+    }
+    t = vbslq_f32(vcltq_f32(t, one), t, one);
+    float32x4_t a = vbslq_f32(vcgtq_f32(f, zero), f, zero);
+    a = vbslq_f32(vcltq_f32(a, one), a, one);
+    int32x4_t idx = vcvtnq_s32_f32(vmulq_n_f32(t, kSrgbLutScale));
+    int32x4_t alpha = vcvtnq_s32_f32(vmulq_n_f32(a, 255.0f));
+    uint32_t r = lut[vgetq_lane_s32(idx, 0)];
+    uint32_t g = lut[vgetq_lane_s32(idx, 1)];
+    uint32_t b = lut[vgetq_lane_s32(idx, 2)];
+    uint32_t al = static_cast<uint32_t>(vgetq_lane_s32(alpha, 3));
+    StorePixel(dst + x * 4, b | (g << 8) | (r << 16) | (al << 24));
+  }
+}
+
+void LumaNeon(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t outWidth, bool rgba) {
+  const int ri = rgba ? 0 : 2;
+  const int bi = rgba ? 2 : 0;
+  uint32_t x = 0;
+  for (; x + 4 <= outWidth; x += 4) {
+    uint8x8x4_t p0 = vld4_u8(row0 + x * 8);
+    uint8x8x4_t p1 = vld4_u8(row1 + x * 8);
+    // Column sums of the row pair per channel, then the weighted dot.
+    uint16x8_t r = vaddl_u8(p0.val[ri], p1.val[ri]);
+    uint16x8_t g = vaddl_u8(p0.val[1], p1.val[1]);
+    uint16x8_t b = vaddl_u8(p0.val[bi], p1.val[bi]);
+    uint32x4_t lo = vmull_n_u16(vget_low_u16(r), static_cast<uint16_t>(kPlaneLumaWr));
+    lo = vmlal_n_u16(lo, vget_low_u16(g), static_cast<uint16_t>(kPlaneLumaWg));
+    lo = vmlal_n_u16(lo, vget_low_u16(b), static_cast<uint16_t>(kPlaneLumaWb));
+    uint32x4_t hi = vmull_n_u16(vget_high_u16(r), static_cast<uint16_t>(kPlaneLumaWr));
+    hi = vmlal_n_u16(hi, vget_high_u16(g), static_cast<uint16_t>(kPlaneLumaWg));
+    hi = vmlal_n_u16(hi, vget_high_u16(b), static_cast<uint16_t>(kPlaneLumaWb));
+    uint32x4_t sum = vpaddq_u32(lo, hi);
+    sum = vshrq_n_u32(vaddq_u32(vmulq_n_u32(sum, 257u), vdupq_n_u32(1u << 14)), 15);
+    vst1_u8(out + x * 2, vreinterpret_u8_u16(vmovn_u32(sum)));
+  }
+  LumaScalar(row0 + x * 8, row1 + x * 8, out + x * 2, outWidth - x, rgba);
+}
+
+constexpr Kernels kNeonKernels = {SwapRbNeon, Rgb10a2Neon, Rgba16fNeon, LumaNeon};
+
+#endif // TFE_SIMD_NEON
+
+const Kernels& KernelsFor(SimdLevel maxLevel) {
+  SimdLevel level = DetectSimdLevel();
+#if defined(TFE_SIMD_X86)
+  if (maxLevel == SimdLevel::Neon) {
+    maxLevel = SimdLevel::Avx2;
+  }
+  level = std::min(level, maxLevel);
+  if (level == SimdLevel::Avx2) return kAvx2Kernels;
+  if (level == SimdLevel::Sse41) return kSse41Kernels;
+#elif defined(TFE_SIMD_NEON)
+  if (level == SimdLevel::Neon && maxLevel == SimdLevel::Neon) return kNeonKernels;
+#else
+  (void)level;
+  (void)maxLevel;
+#endif
+  return kScalarKernels;
+}
+
+bool IsByteFormat(PixelFormat format) {
+  return format == PixelFormat::Bgra8 || format == PixelFormat::Rgba8;
+}
+
+} // namespace
+
+SimdLevel DetectSimdLevel() {
+#if defined(TFE_SIMD_X86)
+  static const SimdLevel level = DetectX86();
+  return level;
+#elif defined(TFE_SIMD_NEON)
+  return SimdLevel::Neon;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+const char* SimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::Sse41: return "sse4.1";
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Neon: return "neon";
+  }
+  return "";
+}
+
+size_t PixelFormatBytes(PixelFormat format) {
+  return format == PixelFormat::Rgba16F ? 8 : 4;
+}
+
+float DecodeHalf(uint16_t bits) {
+  return HalfToFloat(bits);
+}
+
+bool ConvertPixels(const PixelConvertParams& params, SimdLevel maxLevel) {
+  if (!params.src || !params.dst || params.width == 0 || params.height == 0) {
+    return false;
+  }
+  if (!IsByteFormat(params.dstFormat)) {
+    return false;
+  }
+  const size_t srcRowBytes = static_cast<size_t>(params.width) * PixelFormatBytes(params.srcFormat);
+  const size_t dstRowBytes = static_cast<size_t>(params.width) * 4;
+  if (params.srcPitch < srcRowBytes || params.dstPitch < dstRowBytes) {
+    return false;
+  }
+  const uint32_t lumaWidth = params.width / 2;
+  const uint32_t lumaHeight = params.height / 2;
+  if (params.luma && params.lumaPitch < static_cast<size_t>(lumaWidth) * 2) {
+    return false;
+  }
+
+  const Kernels& kernels = KernelsFor(maxLevel);
+  RowFn row = nullptr;
+  if (params.srcFormat == params.dstFormat) {
+    row = nullptr;   // plain copy
+  } else if (IsByteFormat(params.srcFormat)) {
+    row = kernels.swapRb;
+  } else if (params.srcFormat == PixelFormat::Rgb10A2 && params.dstFormat == PixelFormat::Bgra8) {
+    row = kernels.rgb10a2;
+  } else if (params.srcFormat == PixelFormat::Rgba16F && params.dstFormat == PixelFormat::Bgra8) {
+    row = kernels.rgba16f;
+  } else {
+    return false;
+  }
+
+  ToneParams tone;
+  tone.exposure = params.exposure;
+  tone.toneMap = params.toneMap;
+  const bool rgbaOut = params.dstFormat == PixelFormat::Rgba8;
+  const auto* src = static_cast<const uint8_t*>(params.src);
+  auto* dst = static_cast<uint8_t*>(params.dst);
+
+  for (uint32_t y = 0; y < params.height; ++y) {
+    const uint8_t* srcRow = src + params.srcPitch * y;
+    uint8_t* dstRow = dst + params.dstPitch * y;
+    if (row) {
+      row(srcRow, dstRow, params.width, tone);
+    } else {
+      std::memcpy(dstRow, srcRow, dstRowBytes);
+    }
+    // Fused downsample: the row pair was just written and is still in cache.
+    if (params.luma && (y & 1u) && (y >> 1) < lumaHeight && lumaWidth > 0) {
+      kernels.luma(dstRow - params.dstPitch, dstRow, params.luma + params.lumaPitch * (y >> 1), lumaWidth,
+                   rgbaOut);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CPU pixel conversion for the shared-memory capture paths.
+//
+// Converts whole images row by row from the capture formats the hook and
+// DXGI duplication can deliver into 8-bit BGRA (or RGBA), optionally
+// emitting a half-resolution 2x2-averaged BT.709 luma plane (16-bit unorm)
+// while each row pair is still in cache. Kernels exist for SSE4.1, AVX2(+F16C) and NEON and are
+// bit-identical to the scalar reference, so the level can be forced down for
+// testing without changing the output.
+
+enum class PixelFormat {
+  Bgra8,      // DXGI_FORMAT_B8G8R8A8_UNORM
+  Rgba8,      // DXGI_FORMAT_R8G8B8A8_UNORM
+  Rgb10A2,    // DXGI_FORMAT_R10G10B10A2_UNORM
+  Rgba16F,    // DXGI_FORMAT_R16G16B16A16_FLOAT (scRGB, linear)
+};
+
+enum class SimdLevel {
+  Scalar,
+  Sse41,
+  Avx2,
+  Neon,
+};
+
+struct PixelConvertParams {
+  PixelFormat srcFormat = PixelFormat::Bgra8;
+  PixelFormat dstFormat = PixelFormat::Bgra8;   // Bgra8 or Rgba8
+  uint32_t width = 0;
+  uint32_t height = 0;
+  const void* src = nullptr;
+  size_t srcPitch = 0;
+  void* dst = nullptr;
+  size_t dstPitch = 0;
+
+  // Optional (width / 2) x (height / 2) luma plane of 16-bit unorm samples
+  // (see PlaneLuma); lumaPitch is in bytes.
+  uint8_t* luma = nullptr;
+  size_t lumaPitch = 0;
+
+  // Rgba16F only: linear scale, then Reinhard x / (1 + x) if toneMap,
+  // then clamp and sRGB encode. 1.0 is SDR reference white.
+  float exposure = 1.0f;
+  bool toneMap = true;
+};
+
+// Best level supported by this CPU and build.
+SimdLevel DetectSimdLevel();
+const char* SimdLevelName(SimdLevel level);
+size_t PixelFormatBytes(PixelFormat format);
+// One IEEE binary16 value (Rgba16F channels, R16G16_FLOAT readbacks) to float.
+float DecodeHalf(uint16_t bits);
+
+// Converts src into dst (and luma when set). Uses the best available level
+// not above maxLevel. Returns false for unsupported format pairs or sizes.
+bool ConvertPixels(const PixelConvertParams& params, SimdLevel maxLevel = SimdLevel::Neon);
+
+// Luma of one 8-bit pixel in 8 bits: (9b + 92g + 27r) >> 7. Used by the CPU
+// reference interpolator and the quality metrics, not by the luma plane.
+inline uint8_t PixelLuma(uint8_t r, uint8_t g, uint8_t b) {
+  return static_cast<uint8_t>((9u * b + 92u * g + 27u * r) >> 7);
+}
+
+// BT.709 weights (0.2126, 0.7152, 0.0722) in 1/8192.
+constexpr uint32_t kPlaneLumaWr = 1742;
+constexpr uint32_t kPlaneLumaWg = 5859;
+constexpr uint32_t kPlaneLumaWb = 591;
+
+// One luma plane sample from the summed weighted pixels (r, g, b times the
+// weights above) of a 2x2 block: the block's mean BT.709 luma as a 16-bit
+// unorm, the value DownsampleLuma.hlsl computes in float from the color
+// frame to within 1/50 of an 8-bit step (luma_plane_bench checks it).
+// 65535 / (4 * 255 * 8192) = 257 / 32768; the product fits in 32 bits.
+inline uint16_t PlaneLuma(uint32_t blockSum) {
+  return static_cast<uint16_t>((blockSum * 257u + (1u << 14)) >> 15);
+}
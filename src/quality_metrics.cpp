@@ -0,0 +1,783 @@
+#include "quality_metrics.h"
+#include "simd_target.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+// No FMA (TFE_TARGET_AVX2 leaves it out): the vector kernels multiply and
+// add in the scalar order, so every level produces the same floats.
+
+namespace {
+
+constexpr int kWindowRadius = 5;
+constexpr int kWindowTaps = 2 * kWindowRadius + 1;
+constexpr double kWindowSigma = 1.5;
+constexpr float kC1 = (0.01f * 255.0f) * (0.01f * 255.0f);
+constexpr float kC2 = (0.03f * 255.0f) * (0.03f * 255.0f);
+constexpr float kGmsC = 170.0f;
+constexpr int kMaxScales = 5;
+constexpr double kMsSsimWeights[kMaxScales] = {0.0448, 0.2856, 0.3001, 0.2363, 0.1333};
+constexpr int kStripRows = 32;
+constexpr int kMoments = 5;          // a, b, a*a, b*b, a*b
+// Integer accumulators are flushed to 64 bits at least this often (pixels).
+constexpr uint32_t kFlushPixels = 16384;
+
+struct Plane {
+  int width = 0;
+  int height = 0;
+  std::vector<float> data;
+
+  void Resize(int w, int h) {
+    width = w;
+    height = h;
+    data.resize(static_cast<size_t>(w) * h);
+  }
+  float* Row(int y) { return data.data() + static_cast<size_t>(y) * width; }
+  const float* Row(int y) const { return data.data() + static_cast<size_t>(y) * width; }
+};
+
+struct WindowTaps {
+  float v[kWindowTaps];
+
+  WindowTaps() {
+    double sum = 0.0;
+    double w[kWindowTaps];
+    for (int i = 0; i < kWindowTaps; ++i) {
+      const double d = i - kWindowRadius;
+      w[i] = std::exp(-d * d / (2.0 * kWindowSigma * kWindowSigma));
+      sum += w[i];
+    }
+    for (int i = 0; i < kWindowTaps; ++i) {
+      v[i] = static_cast<float>(w[i] / sum);
+    }
+  }
+};
+
+const float* GaussianTaps() {
+  static const WindowTaps taps;
+  return taps.v;
+}
+
+// Sum of squared B, G, R differences over a row.
+using SquaredErrorFn = uint64_t (*)(const uint8_t* a, const uint8_t* b, uint32_t width);
+// 8-bit BGRA / RGBA row -> float luma.
+using LumaFn = void (*)(const uint8_t* src, float* out, uint32_t width, bool rgba);
+// Valid-mode horizontal window over rows a and b: the five moments at each
+// of outWidth positions (reads outWidth + 2 * kWindowRadius inputs).
+using WindowRowFn = void (*)(const float* a, const float* b, const float* taps, uint32_t outWidth,
+                             float* const out[kMoments]);
+// Vertical window: out[x] = sum over k of taps[k] * rows[k][x].
+using ColumnFn = void (*)(const float* const* rows, const float* taps, uint32_t width, float* out);
+
+struct Kernels {
+  SquaredErrorFn squaredError;
+  LumaFn luma;
+  WindowRowFn windowRow;
+  ColumnFn column;
+};
+
+// ----------------------------------------------------------------------------
+// Scalar reference
+// ----------------------------------------------------------------------------
+
+uint64_t SquaredErrorScalar(const uint8_t* a, const uint8_t* b, uint32_t width) {
+  uint64_t sum = 0;
+  for (uint32_t x = 0; x < width; ++x) {
+    for (int c = 0; c < 3; ++c) {
+      const int d = static_cast<int>(a[x * 4 + c]) - b[x * 4 + c];
+      sum += static_cast<uint64_t>(d * d);
+    }
+  }
+  return sum;
+}
+
+void LumaScalar(const uint8_t* src, float* out, uint32_t width, bool rgba) {
+  const int ri = rgba ? 0 : 2;
+  const int bi = rgba ? 2 : 0;
+  for (uint32_t x = 0; x < width; ++x) {
+    const uint8_t* p = src + x * 4;
+    out[x] = static_cast<float>(9u * p[bi] + 92u * p[1] + 27u * p[ri]) * (1.0f / 128.0f);
+  }
+}
+
+void WindowRowScalar(const float* a, const float* b, const float* taps, uint32_t outWidth,
+                     float* const out[kMoments]) {
+  for (uint32_t x = 0; x < outWidth; ++x) {
+    float sa = 0.0f, sb = 0.0f, saa = 0.0f, sbb = 0.0f, sab = 0.0f;
+    for (int k = 0; k < kWindowTaps; ++k) {
+      const float w = taps[k];
+      const float va = a[x + k];
+      const float vb = b[x + k];
+      sa = sa + w * va;
+      sb = sb + w * vb;
+      saa = saa + w * (va * va);
+      sbb = sbb + w * (vb * vb);
+      sab = sab + w * (va * vb);
+    }
+    out[0][x] = sa;
+    out[1][x] = sb;
+    out[2][x] = saa;
+    out[3][x] = sbb;
+    out[4][x] = sab;
+  }
+}
+
+void ColumnScalar(const float* const* rows, const float* taps, uint32_t width, float* out) {
+  for (uint32_t x = 0; x < width; ++x) {
+    float s = 0.0f;
+    for (int k = 0; k < kWindowTaps; ++k) {
+      s = s + taps[k] * rows[k][x];
+    }
+    out[x] = s;
+  }
+}
+
+constexpr Kernels kScalarKernels = {SquaredErrorScalar, LumaScalar, WindowRowScalar, ColumnScalar};
+
+// Remaining columns of a vector row kernel.
+void WindowRowTail(const float* a, const float* b, const float* taps, uint32_t x, uint32_t outWidth,
+                   float* const out[kMoments]) {
+  float* const shifted[kMoments] = {out[0] + x, out[1] + x, out[2] + x, out[3] + x, out[4] + x};
+  WindowRowScalar(a + x, b + x, taps, outWidth - x, shifted);
+}
+
+void ColumnTail(const float* const* rows, const float* taps, uint32_t x, uint32_t width, float* out) {
+  const float* shifted[kWindowTaps];
+  for (int k = 0; k < kWindowTaps; ++k) {
+    shifted[k] = rows[k] + x;
+  }
+  ColumnScalar(shifted, taps, width - x, out + x);
+}
+
+#if defined(TFE_SIMD_X86)
+
+// ----------------------------------------------------------------------------
+// SSE4.1
+// ----------------------------------------------------------------------------
+
+TFE_TARGET_SSE41 uint64_t HorizontalSum(__m128i v) {
+  return static_cast<uint64_t>(static_cast<uint32_t>(_mm_extract_epi32(v, 0))) +
+         static_cast<uint32_t>(_mm_extract_epi32(v, 1)) + static_cast<uint32_t>(_mm_extract_epi32(v, 2)) +
+         static_cast<uint32_t>(_mm_extract_epi32(v, 3));
+}
+
+TFE_TARGET_SSE41 uint64_t SquaredErrorSse41(const uint8_t* a, const uint8_t* b, uint32_t width) {
+  const __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+  const __m128i zero = _mm_setzero_si128();
+  uint64_t sum = 0;
+  uint32_t x = 0;
+  while (x + 4 <= width) {
+    // |a - b| per byte, widened and squared-summed in pairs by madd. Each
+    // 32-bit lane gains at most 4 * 255^2 per 4 pixels.
+    __m128i acc = zero;
+    const uint32_t end = std::min(width & ~3u, x + kFlushPixels);
+    for (; x < end; x += 4) {
+      const __m128i va = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x * 4)), mask);
+      const __m128i vb = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x * 4)), mask);
+      const __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+      const __m128i lo = _mm_unpacklo_epi8(d, zero);
+      const __m128i hi = _mm_unpackhi_epi8(d, zero);
+      acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+    }
+    sum += HorizontalSum(acc);
+  }
+  return sum + SquaredErrorScalar(a + x * 4, b + x * 4, width - x);
+}
+
+TFE_TARGET_SSE41 void LumaSse41(const uint8_t* src, float* out, uint32_t width, bool rgba) {
+  const __m128i weights = rgba ? _mm_setr_epi8(27, 92, 9, 0, 27, 92, 9, 0, 27, 92, 9, 0, 27, 92, 9, 0)
+                               : _mm_setr_epi8(9, 92, 27, 0, 9, 92, 27, 0, 9, 92, 27, 0, 9, 92, 27, 0);
+  const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+  uint32_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    // maddubs: (b*wb + g*wg), (r*wr) per pixel; hadd finishes eight dots.
+    const __m128i sums = _mm_hadd_epi16(
+        _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4)), weights),
+        _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4 + 16)), weights));
+    _mm_storeu_ps(out + x, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepi16_epi32(sums)), scale));
+    _mm_storeu_ps(out + x + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(sums, 8))), scale));
+  }
+  LumaScalar(src + x * 4, out + x, width - x, rgba);
+}
+
+TFE_TARGET_SSE41 void WindowRowSse41(const float* a, const float* b, const float* taps, uint32_t outWidth,
+                                     float* const out[kMoments]) {
+  uint32_t x = 0;
+  for (; x + 4 <= outWidth; x += 4) {
+    __m128 sa = _mm_setzero_ps(), sb = _mm_setzero_ps(), saa = _mm_setzero_ps(), sbb = _mm_setzero_ps(),
+           sab = _mm_setzero_ps();
+    for (int k = 0; k < kWindowTaps; ++k) {
+      const __m128 w = _mm_set1_ps(taps[k]);
+      const __m128 va = _mm_loadu_ps(a + x + k);
+      const __m128 vb = _mm_loadu_ps(b + x + k);
+      sa = _mm_add_ps(sa, _mm_mul_ps(w, va));
+      sb = _mm_add_ps(sb, _mm_mul_ps(w, vb));
+      saa = _mm_add_ps(saa, _mm_mul_ps(w, _mm_mul_ps(va, va)));
+      sbb = _mm_add_ps(sbb, _mm_mul_ps(w, _mm_mul_ps(vb, vb)));
+      sab = _mm_add_ps(sab, _mm_mul_ps(w, _mm_mul_ps(va, vb)));
+    }
+    _mm_storeu_ps(out[0] + x, sa);
+    _mm_storeu_ps(out[1] + x, sb);
+    _mm_storeu_ps(out[2] + x, saa);
+    _mm_storeu_ps(out[3] + x, sbb);
+    _mm_storeu_ps(out[4] + x, sab);
+  }
+  WindowRowTail(a, b, taps, x, outWidth, out);
+}
+
+TFE_TARGET_SSE41 void ColumnSse41(const float* const* rows, const float* taps, uint32_t width, float* out) {
+  uint32_t x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128 s = _mm_setzero_ps();
+    for (int k = 0; k < kWindowTaps; ++k) {
+      s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(taps[k]), _mm_loadu_ps(rows[k] + x)));
+    }
+    _mm_storeu_ps(out + x, s);
+  }
+  ColumnTail(rows, taps, x, width, out);
+}
+
+constexpr Kernels kSse41Kernels = {SquaredErrorSse41, LumaSse41, WindowRowSse41, ColumnSse41};
+
+// ----------------------------------------------------------------------------
+// AVX2
+// ----------------------------------------------------------------------------
+
+TFE_TARGET_AVX2 uint64_t SquaredErrorAvx2(const uint8_t* a, const uint8_t* b, uint32_t width) {
+  const __m256i mask = _mm256_set1_epi32(0x00FFFFFF);
+  const __m256i zero = _mm256_setzero_si256();
+  uint64_t sum = 0;
+  uint32_t x = 0;
+  while (x + 8 <= width) {
+    __m256i acc = zero;
+    const uint32_t end = std::min(width & ~7u, x + kFlushPixels);
+    for (; x < end; x += 8) {
+      const __m256i va = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + x * 4)), mask);
+      const __m256i vb = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x * 4)), mask);
+      const __m256i d = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+      const __m256i lo = _mm256_unpacklo_epi8(d, zero);
+      const __m256i hi = _mm256_unpackhi_epi8(d, zero);
+      acc = _mm256_add_epi32(acc, _mm256_add_epi32(_mm256_madd_epi16(lo, lo), _mm256_madd_epi16(hi, hi)));
+    }
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    for (uint32_t lane : lanes) {
+      sum += lane;
+    }
+  }
+  return sum + SquaredErrorScalar(a + x * 4, b + x * 4, width - x);
+}
+
+TFE_TARGET_AVX2 void WindowRowAvx2(const float* a, const float* b, const float* taps, uint32_t outWidth,
+                                   float* const out[kMoments]) {
+  uint32_t x = 0;
+  for (; x + 8 <= outWidth; x += 8) {
+    __m256 sa = _mm256_setzero_ps(), sb = _mm256_setzero_ps(), saa = _mm256_setzero_ps(),
+           sbb = _mm256_setzero_ps(), sab = _mm256_setzero_ps();
+    for (int k = 0; k < kWindowTaps; ++k) {
+      const __m256 w = _mm256_set1_ps(taps[k]);
+      const __m256 va = _mm256_loadu_ps(a + x + k);
+      const __m256 vb = _mm256_loadu_ps(b + x + k);
+      sa = _mm256_add_ps(sa, _mm256_mul_ps(w, va));
+      sb = _mm256_add_ps(sb, _mm256_mul_ps(w, vb));
+      saa = _mm256_add_ps(saa, _mm256_mul_ps(w, _mm256_mul_ps(va, va)));
+      sbb = _mm256_add_ps(sbb, _mm256_mul_ps(w, _mm256_mul_ps(vb, vb)));
+      sab = _mm256_add_ps(sab, _mm256_mul_ps(w, _mm256_mul_ps(va, vb)));
+    }
+    _mm256_storeu_ps(out[0] + x, sa);
+    _mm256_storeu_ps(out[1] + x, sb);
+    _mm256_storeu_ps(out[2] + x, saa);
+    _mm256_storeu_ps(out[3] + x, sbb);
+    _mm256_storeu_ps(out[4] + x, sab);
+  }
+  WindowRowTail(a, b, taps, x, outWidth, out);
+}
+
+TFE_TARGET_AVX2 void ColumnAvx2(const float* const* rows, const float* taps, uint32_t width, float* out) {
+  uint32_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256 s = _mm256_setzero_ps();
+    for (int k = 0; k < kWindowTaps; ++k) {
+      s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_set1_ps(taps[k]), _mm256_loadu_ps(rows[k] + x)));
+    }
+    _mm256_storeu_ps(out + x, s);
+  }
+  ColumnTail(rows, taps, x, width, out);
+}
+
+// Luma is a small fraction of the cost; AVX2 reuses the SSE kernel.
+constexpr Kernels kAvx2Kernels = {SquaredErrorAvx2, LumaSse41, WindowRowAvx2, ColumnAvx2};
+
+#endif // TFE_SIMD_X86
+
+#if defined(TFE_SIMD_NEON)
+
+// ----------------------------------------------------------------------------
+// NEON (AArch64)
+// ----------------------------------------------------------------------------
+
+uint64_t SquaredErrorNeon(const uint8_t* a, const uint8_t* b, uint32_t width) {
+  const uint8x16_t mask = vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFF));
+  uint64_t sum = 0;
+  uint32_t x = 0;
+  while (x + 4 <= width) {
+    uint32x4_t acc = vdupq_n_u32(0);
+    const uint32_t end = std::min(width & ~3u, x + kFlushPixels);
+    for (; x < end; x += 4) {
+      const uint8x16_t d = vabdq_u8(vandq_u8(vld1q_u8(a + x * 4), mask), vandq_u8(vld1q_u8(b + x * 4), mask));
+      acc = vpadalq_u16(acc, vmull_u8(vget_low_u8(d), vget_low_u8(d)));
+      acc = vpadalq_u16(acc, vmull_u8(vget_high_u8(d), vget_high_u8(d)));
+    }
+    sum += vaddlvq_u32(acc);
+  }
+  return sum + SquaredErrorScalar(a + x * 4, b + x * 4, width - x);
+}
+
+void LumaNeon(const uint8_t* src, float* out, uint32_t width, bool rgba) {
+  const int ri = rgba ? 0 : 2;
+  const int bi = rgba ? 2 : 0;
+  const float32x4_t scale = vdupq_n_f32(1.0f / 128.0f);
+  uint32_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    const uint8x8x4_t p = vld4_u8(src + x * 4);
+    const uint16x8_t y = vmlal_u8(vmlal_u8(vmull_u8(p.val[bi], vdup_n_u8(9)), p.val[1], vdup_n_u8(92)), p.val[ri],
+                                  vdup_n_u8(27));
+    vst1q_f32(out + x, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(y))), scale));
+    vst1q_f32(out + x + 4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(y))), scale));
+  }
+  LumaScalar(src + x * 4, out + x, width - x, rgba);
+}
+
+void WindowRowNeon(const float* a, const float* b, const float* taps, uint32_t outWidth,
+                   float* const out[kMoments]) {
+  uint32_t x = 0;
+  for (; x + 4 <= outWidth; x += 4) {
+    float32x4_t sa = vdupq_n_f32(0.0f), sb = sa, saa = sa, sbb = sa, sab = sa;
+    for (int k = 0; k < kWindowTaps; ++k) {
+      const float32x4_t w = vdupq_n_f32(taps[k]);
+      const float32x4_t va = vld1q_f32(a + x + k);
+      const float32x4_t vb = vld1q_f32(b + x + k);
+      // vmulq + vaddq, not vmlaq: AArch64 fuses vmlaq_f32.
+      sa = vaddq_f32(sa, vmulq_f32(w, va));
+      sb = vaddq_f32(sb, vmulq_f32(w, vb));
+      saa = vaddq_f32(saa, vmulq_f32(w, vmulq_f32(va, va)));
+      sbb = vaddq_f32(sbb, vmulq_f32(w, vmulq_f32(vb, vb)));
+      sab = vaddq_f32(sab, vmulq_f32(w, vmulq_f32(va, vb)));
+    }
+    vst1q_f32(out[0] + x, sa);
+    vst1q_f32(out[1] + x, sb);
+    vst1q_f32(out[2] + x, saa);
+    vst1q_f32(out[3] + x, sbb);
+    vst1q_f32(out[4] + x, sab);
+  }
+  WindowRowTail(a, b, taps, x, outWidth, out);
+}
+
+void ColumnNeon(const float* const* rows, const float* taps, uint32_t width, float* out) {
+  uint32_t x = 0;
+  for (; x + 4 <= width; x += 4) {
+    float32x4_t s = vdupq_n_f32(0.0f);
+    for (int k = 0; k < kWindowTaps; ++k) {
+      s = vaddq_f32(s, vmulq_f32(vdupq_n_f32(taps[k]), vld1q_f32(rows[k] + x)));
+    }
+    vst1q_f32(out + x, s);
+  }
+  ColumnTail(rows, taps, x, width, out);
+}
+
+constexpr Kernels kNeonKernels = {SquaredErrorNeon, LumaNeon, WindowRowNeon, ColumnNeon};
+
+#endif // TFE_SIMD_NEON
+
+const Kernels& KernelsFor(SimdLevel maxLevel) {
+  SimdLevel level = DetectSimdLevel();
+#if defined(TFE_SIMD_X86)
+  if (maxLevel == SimdLevel::Neon) {
+    maxLevel = SimdLevel::Avx2;
+  }
+  level = std::min(level, maxLevel);
+  if (level == SimdLevel::Avx2) return kAvx2Kernels;
+  if (level == SimdLevel::Sse41) return kSse41Kernels;
+#elif defined(TFE_SIMD_NEON)
+  if (level == SimdLevel::Neon && maxLevel == SimdLevel::Neon) return kNeonKernels;
+#else
+  (void)level;
+  (void)maxLevel;
+#endif
+  return kScalarKernels;
+}
+
+// ----------------------------------------------------------------------------
+// Strips
+// ----------------------------------------------------------------------------
+
+int ResolveThreads(const QualityOptions& options) {
+  if (options.threads > 0) {
+    return options.threads;
+  }
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+int StripCount(int rows) {
+  return (rows + kStripRows - 1) / kStripRows;
+}
+
+// Runs fn(strip) for every strip in [0, count) on up to `threads` workers,
+// the caller included. Callers keep per-strip results and reduce them in
+// strip order.
+template <typename Fn>
+void ForEachStrip(int count, int threads, Fn&& fn) {
+  const int workers = std::clamp(threads, 1, std::max(count, 1));
+  if (workers == 1) {
+    for (int i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  std::atomic<int> next{0};
+  auto run = [&] {
+    for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+      fn(i);
+    }
+  };
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (int i = 1; i < workers; ++i) {
+    pool.emplace_back(run);
+  }
+  run();
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+}
+
+bool IsByteFrame(const CpuFrame& frame) {
+  return frame.data && (frame.format == PixelFormat::Bgra8 || frame.format == PixelFormat::Rgba8) &&
+         frame.pitch >= static_cast<size_t>(frame.width) * 4;
+}
+
+bool ComparableFrames(const CpuFrame& a, const CpuFrame& b) {
+  return IsByteFrame(a) && IsByteFrame(b) && a.format == b.format && a.width == b.width && a.height == b.height &&
+         a.width >= 16 && a.height >= 16;
+}
+
+// Luma of both frames, and the colour squared error when requested.
+uint64_t LumaPass(const CpuFrame& a, const CpuFrame& b, Plane& lumaA, Plane& lumaB, bool squaredError,
+                  const Kernels& kernels, int threads) {
+  lumaA.Resize(a.width, a.height);
+  lumaB.Resize(b.width, b.height);
+  const bool rgba = a.format == PixelFormat::Rgba8;
+  const uint32_t width = static_cast<uint32_t>(a.width);
+  std::vector<uint64_t> partial(StripCount(a.height), 0);
+  ForEachStrip(static_cast<int>(partial.size()), threads, [&](int s) {
+    const int y1 = std::min(a.height, (s + 1) * kStripRows);
+    for (int y = s * kStripRows; y < y1; ++y) {
+      const uint8_t* rowA = a.data + a.pitch * y;
+      const uint8_t* rowB = b.data + b.pitch * y;
+      kernels.luma(rowA, lumaA.Row(y), width, rgba);
+      kernels.luma(rowB, lumaB.Row(y), width, rgba);
+      if (squaredError) {
+        partial[s] += kernels.squaredError(rowA, rowB, width);
+      }
+    }
+  });
+  uint64_t total = 0;
+  for (uint64_t p : partial) {
+    total += p;
+  }
+  return total;
+}
+
+// 2x2 average; odd last rows / columns are dropped.
+void Halve(const Plane& src, Plane& dst) {
+  dst.Resize(src.width / 2, src.height / 2);
+  for (int y = 0; y < dst.height; ++y) {
+    const float* r0 = src.Row(y * 2);
+    const float* r1 = src.Row(y * 2 + 1);
+    float* out = dst.Row(y);
+    for (int x = 0; x < dst.width; ++x) {
+      out[x] = 0.25f * ((r0[x * 2] + r0[x * 2 + 1]) + (r1[x * 2] + r1[x * 2 + 1]));
+    }
+  }
+}
+
+struct SsimMeans {
+  double ssim = 0.0;
+  double cs = 0.0;       // contrast-structure term alone, for MS-SSIM
+};
+
+// Mean SSIM and contrast-structure over the valid window positions. Each
+// strip runs its own ring of horizontally filtered moment rows.
+SsimMeans MeasureSsim(const Plane& a, const Plane& b, const Kernels& kernels, int threads) {
+  const int outW = a.width - 2 * kWindowRadius;
+  const int outH = a.height - 2 * kWindowRadius;
+  if (outW <= 0 || outH <= 0) {
+    return {};
+  }
+  const float* taps = GaussianTaps();
+  std::vector<SsimMeans> partial(StripCount(outH));
+  ForEachStrip(static_cast<int>(partial.size()), threads, [&](int s) {
+    const size_t rowFloats = static_cast<size_t>(outW);
+    std::vector<float> ring(rowFloats * kMoments * kWindowTaps);
+    std::vector<float> moments(rowFloats * kMoments);
+    auto ringRow = [&](int moment, int row) {
+      return ring.data() + ((row % kWindowTaps) * kMoments + moment) * rowFloats;
+    };
+    auto horizontal = [&](int row) {
+      float* const out[kMoments] = {ringRow(0, row), ringRow(1, row), ringRow(2, row), ringRow(3, row),
+                                    ringRow(4, row)};
+      kernels.windowRow(a.Row(row), b.Row(row), taps, static_cast<uint32_t>(outW), out);
+    };
+
+    const int y0 = s * kStripRows;
+    const int y1 = std::min(outH, y0 + kStripRows);
+    for (int row = y0; row < y0 + kWindowTaps - 1; ++row) {
+      horizontal(row);
+    }
+    SsimMeans sums;
+    for (int y = y0; y < y1; ++y) {
+      horizontal(y + kWindowTaps - 1);
+      for (int m = 0; m < kMoments; ++m) {
+        const float* rows[kWindowTaps];
+        for (int k = 0; k < kWindowTaps; ++k) {
+          rows[k] = ringRow(m, y + k);
+        }
+        kernels.column(rows, taps, static_cast<uint32_t>(outW), moments.data() + m * rowFloats);
+      }
+      const float* muA = moments.data();
+      const float* muB = muA + rowFloats;
+      const float* eAA = muB + rowFloats;
+      const float* eBB = eAA + rowFloats;
+      const float* eAB = eBB + rowFloats;
+      double rowSsim = 0.0;
+      double rowCs = 0.0;
+      for (int x = 0; x < outW; ++x) {
+        const float ma = muA[x];
+        const float mb = muB[x];
+        const float varA = eAA[x] - ma * ma;
+        const float varB = eBB[x] - mb * mb;
+        const float cov = eAB[x] - ma * mb;
+        const float cs = (2.0f * cov + kC2) / (varA + varB + kC2);
+        const float l = (2.0f * ma * mb + kC1) / (ma * ma + mb * mb + kC1);
+        rowSsim += l * cs;
+        rowCs += cs;
+      }
+      sums.ssim += rowSsim;
+      sums.cs += rowCs;
+    }
+    partial[s] = sums;
+  });
+
+  SsimMeans total;
+  for (const SsimMeans& p : partial) {
+    total.ssim += p.ssim;
+    total.cs += p.cs;
+  }
+  const double count = static_cast<double>(outW) * outH;
+  total.ssim /= count;
+  total.cs /= count;
+  return total;
+}
+
+// GMSD on (already halved) luma: standard deviation of the gradient
+// magnitude similarity over interior pixels.
+double MeasureGmsd(const Plane& a, const Plane& b, int threads) {
+  const int w = a.width;
+  const int h = a.height;
+  if (w < 3 || h < 3) {
+    return 0.0;
+  }
+  struct Sums {
+    double sum = 0.0;
+    double sumSq = 0.0;
+  };
+  std::vector<Sums> partial(StripCount(h - 2));
+  auto gradient = [](const Plane& p, int x, int y) {
+    const float* up = p.Row(y - 1);
+    const float* mid = p.Row(y);
+    const float* down = p.Row(y + 1);
+    const float gx = ((up[x + 1] + mid[x + 1] + down[x + 1]) - (up[x - 1] + mid[x - 1] + down[x - 1])) / 3.0f;
+    const float gy = ((down[x - 1] + down[x] + down[x + 1]) - (up[x - 1] + up[x] + up[x + 1])) / 3.0f;
+    return std::sqrt(gx * gx + gy * gy);
+  };
+  ForEachStrip(static_cast<int>(partial.size()), threads, [&](int s) {
+    const int y0 = 1 + s * kStripRows;
+    const int y1 = std::min(h - 1, y0 + kStripRows);
+    Sums sums;
+    for (int y = y0; y < y1; ++y) {
+      for (int x = 1; x < w - 1; ++x) {
+        const float ga = gradient(a, x, y);
+        const float gb = gradient(b, x, y);
+        const double gms = (2.0f * ga * gb + kGmsC) / (ga * ga + gb * gb + kGmsC);
+        sums.sum += gms;
+        sums.sumSq += gms * gms;
+      }
+    }
+    partial[s] = sums;
+  });
+  Sums total;
+  for (const Sums& p : partial) {
+    total.sum += p.sum;
+    total.sumSq += p.sumSq;
+  }
+  const double count = static_cast<double>(w - 2) * (h - 2);
+  const double mean = total.sum / count;
+  return std::sqrt(std::max(0.0, total.sumSq / count - mean * mean));
+}
+
+} // namespace
+
+bool MeasureQuality(const CpuFrame& test, const CpuFrame& reference, QualityScores& scores,
+                    const QualityOptions& options) {
+  scores = QualityScores();
+  if (!ComparableFrames(test, reference)) {
+    return false;
+  }
+  const Kernels& kernels = KernelsFor(options.maxLevel);
+  const int threads = ResolveThreads(options);
+
+  Plane lumaA;
+  Plane lumaB;
+  const uint64_t squaredError = LumaPass(test, reference, lumaA, lumaB, true, kernels, threads);
+  scores.mse = static_cast<double>(squaredError) / (static_cast<double>(test.width) * test.height * 3.0);
+  scores.psnr = scores.mse > 0.0 ? std::min(kMaxPsnr, 10.0 * std::log10(255.0 * 255.0 / scores.mse)) : kMaxPsnr;
+
+  Plane halfA;
+  Plane halfB;
+  const bool needHalf = options.gmsd || options.msSsim;
+  if (needHalf) {
+    Halve(lumaA, halfA);
+    Halve(lumaB, halfB);
+  }
+
+  if (options.ssim || options.msSsim) {
+    const SsimMeans full = MeasureSsim(lumaA, lumaB, kernels, threads);
+    scores.ssim = full.ssim;
+    if (options.msSsim) {
+      // Scales whose window still fits.
+      int scales = 1;
+      while (scales < kMaxScales && (std::min(test.width, test.height) >> scales) >= kWindowTaps) {
+        scales++;
+      }
+      double weightSum = 0.0;
+      for (int i = 0; i < scales; ++i) {
+        weightSum += kMsSsimWeights[i];
+      }
+      double product = 1.0;
+      SsimMeans level = full;
+      Plane nextA;
+      Plane nextB;
+      const Plane* curA = &halfA;
+      const Plane* curB = &halfB;
+      for (int i = 0; i < scales; ++i) {
+        if (i > 0) {
+          level = MeasureSsim(*curA, *curB, kernels, threads);
+        }
+        // Negative contrast-structure (anti-correlated content) counts as 0.
+        const double term = i + 1 == scales ? level.ssim : level.cs;
+        product *= std::pow(std::max(term, 0.0), kMsSsimWeights[i] / weightSum);
+        if (i > 0 && i + 1 < scales) {
+          Plane a;
+          Plane b;
+          Halve(*curA, a);
+          Halve(*curB, b);
+          nextA = std::move(a);
+          nextB = std::move(b);
+          curA = &nextA;
+          curB = &nextB;
+        }
+      }
+      scores.msSsim = product;
+      scores.msSsimScales = scales;
+    }
+  }
+
+  if (options.gmsd) {
+    scores.gmsd = MeasureGmsd(halfA, halfB, threads);
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+// FlickerMeter
+// ----------------------------------------------------------------------------
+
+void FlickerMeter::Reset() {
+  m_width = 0;
+  m_height = 0;
+  m_frames = 0;
+  m_prevOffset = 0.0;
+  m_temporalSum = 0.0;
+  m_maxTemporal = 0.0;
+  m_brightnessSum = 0.0;
+}
+
+bool FlickerMeter::Add(const CpuFrame& test, const CpuFrame& reference, const QualityOptions& options) {
+  if (!ComparableFrames(test, reference)) {
+    return false;
+  }
+  if (test.width != m_width || test.height != m_height) {
+    Reset();
+    m_width = test.width;
+    m_height = test.height;
+  }
+  const Kernels& kernels = KernelsFor(options.maxLevel);
+  const int threads = ResolveThreads(options);
+  Plane t;
+  Plane r;
+  t.data = std::move(m_test);
+  r.data = std::move(m_reference);
+  LumaPass(test, reference, t, r, false, kernels, threads);
+  m_test = std::move(t.data);
+  m_reference = std::move(r.data);
+
+  struct Sums {
+    double test = 0.0;
+    double reference = 0.0;
+    double temporal = 0.0;
+  };
+  const bool hasPrevious = m_frames > 0;
+  std::vector<Sums> partial(StripCount(m_height));
+  ForEachStrip(static_cast<int>(partial.size()), threads, [&](int s) {
+    const size_t begin = static_cast<size_t>(s) * kStripRows * m_width;
+    const size_t end = std::min(m_test.size(), begin + static_cast<size_t>(kStripRows) * m_width);
+    Sums sums;
+    for (size_t i = begin; i < end; ++i) {
+      sums.test += m_test[i];
+      sums.reference += m_reference[i];
+      if (hasPrevious) {
+        sums.temporal += std::fabs((m_test[i] - m_prevTest[i]) - (m_reference[i] - m_prevReference[i]));
+      }
+    }
+    partial[s] = sums;
+  });
+  Sums total;
+  for (const Sums& p : partial) {
+    total.test += p.test;
+    total.reference += p.reference;
+    total.temporal += p.temporal;
+  }
+  const double pixels = static_cast<double>(m_width) * m_height;
+  const double offset = (total.test - total.reference) / pixels;
+  if (hasPrevious) {
+    const double temporal = total.temporal / pixels;
+    m_temporalSum += temporal;
+    m_maxTemporal = std::max(m_maxTemporal, temporal);
+    m_brightnessSum += std::fabs(offset - m_prevOffset);
+  }
+  m_prevOffset = offset;
+  std::swap(m_test, m_prevTest);
+  std::swap(m_reference, m_prevReference);
+  m_frames++;
+  return true;
+}
+
+double FlickerMeter::TemporalError() const {
+  return m_frames > 1 ? m_temporalSum / (m_frames - 1) : 0.0;
+}
+
+double FlickerMeter::BrightnessFlicker() const {
+  return m_frames > 1 ? m_brightnessSum / (m_frames - 1) : 0.0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "cpu_frame.h"
+#include "pixel_convert.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Full-reference quality metrics for interpolated frames against held-out
+// ground truth, on 8-bit BGRA (or RGBA) frames.
+//
+//  - MSE / PSNR over B, G and R (alpha ignored).
+//  - SSIM on luma, 11x11 Gaussian window (sigma 1.5), K1 0.01, K2 0.03,
+//    valid region only, as Wang et al.
+//  - MS-SSIM: up to five dyadic scales with the standard exponents; small
+//    frames use the scales whose window still fits and renormalize.
+//  - GMSD: standard deviation of the gradient magnitude similarity map
+//    (Prewitt, on 2x2-averaged luma, c = 170). 0 is identical.
+//
+// Luma is (9b + 92g + 27r) / 128, PixelLuma's weights without truncation.
+// The colour-error, luma and window filter passes have SSE4.1 / AVX2 / NEON
+// kernels (same level selection as ConvertPixels). Work is split into
+// fixed row strips reduced in order, so scores do not depend on the thread
+// count.
+
+constexpr double kMaxPsnr = 100.0;     // reported for identical frames
+
+struct QualityOptions {
+  bool ssim = true;
+  bool msSsim = true;
+  bool gmsd = true;
+  int threads = 0;                      // 0: hardware concurrency
+  SimdLevel maxLevel = SimdLevel::Neon; // as ConvertPixels
+};
+
+struct QualityScores {
+  double mse = 0.0;
+  double psnr = 0.0;
+  double ssim = 0.0;
+  double msSsim = 0.0;
+  int msSsimScales = 0;
+  double gmsd = 0.0;
+};
+
+// Scores test against reference. Both must have the same size (16x16 or
+// more) and the same byte format (Bgra8 or Rgba8).
+bool MeasureQuality(const CpuFrame& test, const CpuFrame& reference, QualityScores& scores,
+                    const QualityOptions& options = QualityOptions());
+
+// Temporal flicker of a generated sequence against its reference sequence,
+// fed one frame pair at a time in display order.
+//
+//  - TemporalError: mean |(t[k] - t[k-1]) - (r[k] - r[k-1])| on luma, in
+//    8-bit units. Frame-to-frame change the reference does not have:
+//    shimmer, popping, temporally unstable warps. MaxTemporalError is the
+//    worst single transition.
+//  - BrightnessFlicker: mean |d[k] - d[k-1]| of the per-frame mean luma
+//    offset d = mean(t) - mean(r). Global pumping a per-frame score hides.
+class FlickerMeter {
+public:
+  void Reset();
+  bool Add(const CpuFrame& test, const CpuFrame& reference, const QualityOptions& options = QualityOptions());
+
+  int Frames() const { return m_frames; }
+  double TemporalError() const;
+  double MaxTemporalError() const { return m_maxTemporal; }
+  double BrightnessFlicker() const;
+
+private:
+  int m_width = 0;
+  int m_height = 0;
+  int m_frames = 0;
+  std::vector<float> m_prevTest;
+  std::vector<float> m_prevReference;
+  std::vector<float> m_test;
+  std::vector<float> m_reference;
+  double m_prevOffset = 0.0;
+  double m_temporalSum = 0.0;
+  double m_maxTemporal = 0.0;
+  double m_brightnessSum = 0.0;
+};
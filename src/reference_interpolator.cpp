@@ -0,0 +1,723 @@
+#include "reference_interpolator.h"
+
+#include "motion_model.h"
+#include "pixel_convert.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int kPatchRadius = 2;          // 5x5 matching window
+constexpr float kEdgeScale = 6.0f;       // luma step that halves a smoothing weight
+constexpr int kMaxSearchSteps = 64;
+// Consistency residual (motion texels) at which a source's weight falls to
+// exp(-0.5); the coarse fields are rarely consistent to better than a texel.
+constexpr float kOcclusionSigma = 3.0f;
+constexpr float kOcclusionFalloff = 0.5f / (kOcclusionSigma * kOcclusionSigma);
+constexpr float kPriorScale = 0.5f;      // SAD per texel of distance from the prior, at attnPriorMix 1
+
+template <typename T>
+size_t VectorBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+void ResizeFlow(FlowPlane& flow, int width, int height) {
+  flow.width = width;
+  flow.height = height;
+  flow.xy.assign(static_cast<size_t>(width) * height * 2, 0.0f);
+  flow.confidence.assign(static_cast<size_t>(width) * height, 0.0f);
+}
+
+inline float Texel(const std::vector<float>& data, int width, int height, int x, int y) {
+  x = std::clamp(x, 0, width - 1);
+  y = std::clamp(y, 0, height - 1);
+  return data[static_cast<size_t>(y) * width + x];
+}
+
+// Bilinear read of a two-channel motion field at texel-center coordinates.
+void SampleFlow(const FlowPlane& flow, float x, float y, float& dx, float& dy) {
+  x = std::clamp(x, 0.0f, static_cast<float>(flow.width - 1));
+  y = std::clamp(y, 0.0f, static_cast<float>(flow.height - 1));
+  const int x0 = static_cast<int>(x);
+  const int y0 = static_cast<int>(y);
+  const int x1 = std::min(x0 + 1, flow.width - 1);
+  const int y1 = std::min(y0 + 1, flow.height - 1);
+  const float fx = x - x0;
+  const float fy = y - y0;
+  auto at = [&](int xx, int yy, int c) { return flow.xy[(static_cast<size_t>(yy) * flow.width + xx) * 2 + c]; };
+  for (int c = 0; c < 2; ++c) {
+    const float top = at(x0, y0, c) + (at(x1, y0, c) - at(x0, y0, c)) * fx;
+    const float bottom = at(x0, y1, c) + (at(x1, y1, c) - at(x0, y1, c)) * fx;
+    (c == 0 ? dx : dy) = top + (bottom - top) * fy;
+  }
+}
+
+inline const uint8_t* PixelAt(const CpuFrame& frame, int x, int y) {
+  x = std::clamp(x, 0, frame.width - 1);
+  y = std::clamp(y, 0, frame.height - 1);
+  return frame.data + static_cast<size_t>(y) * frame.pitch + static_cast<size_t>(x) * 4;
+}
+
+void SampleBilinear(const CpuFrame& frame, float x, float y, float out[3]) {
+  const float fx0 = std::floor(x);
+  const float fy0 = std::floor(y);
+  const int x0 = static_cast<int>(fx0);
+  const int y0 = static_cast<int>(fy0);
+  const float fx = x - fx0;
+  const float fy = y - fy0;
+  const uint8_t* p00 = PixelAt(frame, x0, y0);
+  const uint8_t* p10 = PixelAt(frame, x0 + 1, y0);
+  const uint8_t* p01 = PixelAt(frame, x0, y0 + 1);
+  const uint8_t* p11 = PixelAt(frame, x0 + 1, y0 + 1);
+  for (int c = 0; c < 3; ++c) {
+    const float top = p00[c] + (p10[c] - p00[c]) * fx;
+    const float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+    out[c] = top + (bottom - top) * fy;
+  }
+}
+
+inline void CatmullRomWeights(float t, float w[4]) {
+  const float t2 = t * t;
+  const float t3 = t2 * t;
+  w[0] = 0.5f * (-t3 + 2.0f * t2 - t);
+  w[1] = 0.5f * (3.0f * t3 - 5.0f * t2 + 2.0f);
+  w[2] = 0.5f * (-3.0f * t3 + 4.0f * t2 + t);
+  w[3] = 0.5f * (t3 - t2);
+}
+
+// "High" quality sampling, as the shader's bicubic path.
+void SampleBicubic(const CpuFrame& frame, float x, float y, float out[3]) {
+  const float fx0 = std::floor(x);
+  const float fy0 = std::floor(y);
+  const int x0 = static_cast<int>(fx0);
+  const int y0 = static_cast<int>(fy0);
+  float wx[4];
+  float wy[4];
+  CatmullRomWeights(x - fx0, wx);
+  CatmullRomWeights(y - fy0, wy);
+  out[0] = out[1] = out[2] = 0.0f;
+  for (int j = 0; j < 4; ++j) {
+    float row[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 4; ++i) {
+      const uint8_t* p = PixelAt(frame, x0 - 1 + i, y0 - 1 + j);
+      row[0] += p[0] * wx[i];
+      row[1] += p[1] * wx[i];
+      row[2] += p[2] * wx[i];
+    }
+    out[0] += row[0] * wy[j];
+    out[1] += row[1] * wy[j];
+    out[2] += row[2] * wy[j];
+  }
+}
+
+// 2x2 box reduction (odd edges repeat the last texel).
+void Reduce(const std::vector<float>& src, int srcWidth, int srcHeight, std::vector<float>& dst, int width,
+            int height) {
+  dst.resize(static_cast<size_t>(width) * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const int sx = x * 2;
+      const int sy = y * 2;
+      dst[static_cast<size_t>(y) * width + x] =
+          0.25f * (Texel(src, srcWidth, srcHeight, sx, sy) + Texel(src, srcWidth, srcHeight, sx + 1, sy) +
+                   Texel(src, srcWidth, srcHeight, sx, sy + 1) + Texel(src, srcWidth, srcHeight, sx + 1, sy + 1));
+    }
+  }
+}
+
+}  // namespace
+
+ReferenceInterpolator::ReferenceInterpolator() {
+  m_forward = &m_tinyForward;
+  m_backward = &m_tinyBackward;
+  m_profiler.SetEnabled(true);
+}
+
+bool ReferenceInterpolator::Resize(int width, int height) {
+  if (width < 16 || height < 16) {
+    return false;
+  }
+  m_width = width;
+  m_height = height;
+  m_output.assign(static_cast<size_t>(width) * height * 4, 0);
+  BuildGraph();
+  return true;
+}
+
+size_t ReferenceInterpolator::MemoryBytes() const {
+  size_t bytes = VectorBytes(m_output);
+  for (int i = 0; i < 2; ++i) {
+    bytes += VectorBytes(m_half[i].data) + VectorBytes(m_quarter[i].data) + VectorBytes(m_eighth[i].data);
+  }
+  for (const FlowPlane* flow : {&m_tinyForward, &m_tinyBackward, &m_quarterForward, &m_quarterBackward,
+                                &m_halfForward, &m_halfBackward, &m_scratch}) {
+    bytes += VectorBytes(flow->xy) + VectorBytes(flow->confidence);
+  }
+  for (const std::vector<float>& slot : m_slots) {
+    bytes += VectorBytes(slot);
+  }
+  return bytes;
+}
+
+// ----------------------------------------------------------------------------
+// Frame graph
+// ----------------------------------------------------------------------------
+
+// Declares the stages of the active pipeline with what they read and write,
+// then gives every resource outside the alias slots its own storage. Storage
+// of a transient resource is empty between frames; Acquire swaps its slot's
+// memory in before the first pass that touches it and Release swaps it back
+// after the last, so the vectors never reallocate once the slots are sized.
+void ReferenceInterpolator::BuildGraph() {
+  using S = PipelineStage;
+  const bool minimal = m_settings.minimalPipeline;
+  const bool alias = m_settings.aliasTransients;
+  const int halfW = (m_width + 1) / 2;
+  const int halfH = (m_height + 1) / 2;
+  const int quarterW = (halfW + 1) / 2;
+  const int quarterH = (halfH + 1) / 2;
+  const int eighthW = (quarterW + 1) / 2;
+  const int eighthH = (quarterH + 1) / 2;
+
+  m_graph.Clear();
+  m_storage.clear();
+  auto plane = [&](const char* name, Plane& p, int w, int h) {
+    p.width = w;
+    p.height = h;
+    m_storage.push_back(&p.data);
+    return m_graph.AddResource(name, w, h, ResourceFormat::R32Float, alias);
+  };
+  // Returns the xy resource; confidence is the next one.
+  auto flow = [&](const std::string& name, FlowPlane& f, int w, int h, bool transient) {
+    f.width = w;
+    f.height = h;
+    m_storage.push_back(&f.xy);
+    const int xy = m_graph.AddResource(name + ".xy", w, h, ResourceFormat::Rg32Float, transient && alias);
+    m_storage.push_back(&f.confidence);
+    m_graph.AddResource(name + ".confidence", w, h, ResourceFormat::R32Float, transient && alias);
+    return xy;
+  };
+
+  int half[2];
+  int quarter[2];
+  int eighth[2];
+  for (int i = 0; i < 2; ++i) {
+    half[i] = plane(i == 0 ? "half.prev" : "half.curr", m_half[i], halfW, halfH);
+    quarter[i] = plane(i == 0 ? "quarter.prev" : "quarter.curr", m_quarter[i], quarterW, quarterH);
+    eighth[i] = plane(i == 0 ? "eighth.prev" : "eighth.curr", m_eighth[i], eighthW, eighthH);
+  }
+  // The eighth-res fields are what the minimal pipeline warps with; the full
+  // pipeline only predicts from them.
+  const int tinyForward = flow("tinyForward", m_tinyForward, eighthW, eighthH, !minimal);
+  const int tinyBackward = flow("tinyBackward", m_tinyBackward, eighthW, eighthH, !minimal);
+  int quarterForward = -1;
+  int quarterBackward = -1;
+  int halfForward = -1;
+  int halfBackward = -1;
+  if (minimal) {
+    m_quarterForward = FlowPlane();
+    m_quarterBackward = FlowPlane();
+    m_halfForward = FlowPlane();
+    m_halfBackward = FlowPlane();
+  } else {
+    quarterForward = flow("quarterForward", m_quarterForward, quarterW, quarterH, true);
+    quarterBackward = flow("quarterBackward", m_quarterBackward, quarterW, quarterH, true);
+    halfForward = flow("halfForward", m_halfForward, halfW, halfH, false);
+    halfBackward = flow("halfBackward", m_halfBackward, halfW, halfH, false);
+  }
+  // Smooth swaps the scratch field with the one it filters, so the scratch
+  // memory changes owner every frame and cannot live in a slot.
+  const int scratch = minimal ? flow("scratch", m_scratch, eighthW, eighthH, false)
+                              : flow("scratch", m_scratch, halfW, halfH, false);
+  m_storage.push_back(nullptr);
+  const int output = m_graph.AddResource("output", m_width, m_height, ResourceFormat::Bgra8Unorm, false);
+
+  int pass = m_graph.AddPass("Downsample", S::Downsample);
+  m_graph.Write(pass, half[0]);
+  m_graph.Write(pass, half[1]);
+  pass = m_graph.AddPass("Pyramid", S::Pyramid);
+  for (int i = 0; i < 2; ++i) {
+    m_graph.Read(pass, half[i]);
+    m_graph.Write(pass, quarter[i]);
+    m_graph.Write(pass, eighth[i]);
+  }
+  const int tiny[2] = {tinyForward, tinyBackward};
+  for (int i = 0; i < 2; ++i) {
+    pass = m_graph.AddPass(i == 0 ? "Motion forward" : "Motion backward",
+                           i == 0 ? S::MotionForward : S::MotionBackward);
+    m_graph.Read(pass, eighth[0]);
+    m_graph.Read(pass, eighth[1]);
+    m_graph.Write(pass, tiny[i]);
+    m_graph.Write(pass, tiny[i] + 1);
+  }
+  if (minimal) {
+    pass = m_graph.AddPass("Smooth", S::Smooth);
+    for (int i = 0; i < 2; ++i) {
+      m_graph.Read(pass, eighth[i]);
+      m_graph.Read(pass, tiny[i]);
+      m_graph.Read(pass, tiny[i] + 1);
+      m_graph.Write(pass, tiny[i]);
+      m_graph.Write(pass, tiny[i] + 1);
+    }
+    m_graph.Write(pass, scratch);
+    m_graph.Write(pass, scratch + 1);
+  } else {
+    // Searches read only the prediction's vectors, not its confidence.
+    const int coarse[2] = {quarterForward, quarterBackward};
+    const int fine[2] = {halfForward, halfBackward};
+    pass = m_graph.AddPass("Refine 1/4", S::RefineQuarter);
+    for (int i = 0; i < 2; ++i) {
+      m_graph.Read(pass, quarter[i]);
+      m_graph.Read(pass, tiny[i]);
+      m_graph.Write(pass, coarse[i]);
+      m_graph.Write(pass, coarse[i] + 1);
+    }
+    pass = m_graph.AddPass("Refine 1/2", S::RefineHalf);
+    for (int i = 0; i < 2; ++i) {
+      m_graph.Read(pass, half[i]);
+      m_graph.Read(pass, coarse[i]);
+      m_graph.Write(pass, fine[i]);
+      m_graph.Write(pass, fine[i] + 1);
+    }
+    pass = m_graph.AddPass("Smooth", S::Smooth);
+    for (int i = 0; i < 2; ++i) {
+      m_graph.Read(pass, half[i]);
+      m_graph.Read(pass, fine[i]);
+      m_graph.Read(pass, fine[i] + 1);
+      m_graph.Write(pass, fine[i]);
+      m_graph.Write(pass, fine[i] + 1);
+    }
+    m_graph.Write(pass, scratch);
+    m_graph.Write(pass, scratch + 1);
+  }
+  pass = m_graph.AddPass("Interpolate", S::Interpolate);
+  m_graph.Read(pass, minimal ? tinyForward : halfForward);
+  m_graph.Read(pass, minimal ? tinyBackward : halfBackward);
+  m_graph.Write(pass, output);
+  m_graph.Compile();
+
+  const std::vector<FrameResourceDesc>& resources = m_graph.Resources();
+  m_slots.assign(m_graph.SlotBytes().size(), {});
+  for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+    m_slots[slot].assign(m_graph.SlotBytes()[slot] / sizeof(float), 0.0f);
+  }
+  for (size_t r = 0; r < resources.size(); ++r) {
+    if (!m_storage[r]) {
+      continue;
+    }
+    if (resources[r].slot >= 0) {
+      std::vector<float>().swap(*m_storage[r]);
+    } else {
+      m_storage[r]->assign(resources[r].bytes / sizeof(float), 0.0f);
+    }
+  }
+  m_graphMinimal = minimal;
+  m_graphAliased = alias;
+  m_forward = minimal ? &m_tinyForward : &m_halfForward;
+  m_backward = minimal ? &m_tinyBackward : &m_halfBackward;
+  m_hasMotion = false;
+}
+
+void ReferenceInterpolator::Acquire(int resource) {
+  const FrameResourceDesc& desc = m_graph.Resources()[resource];
+  std::vector<float>& data = *m_storage[resource];
+  data.swap(m_slots[desc.slot]);
+  data.resize(desc.bytes / sizeof(float));
+}
+
+void ReferenceInterpolator::Release(int resource) {
+  m_storage[resource]->swap(m_slots[m_graph.Resources()[resource].slot]);
+}
+
+// Times one pass of the graph and lends its transients their slot memory for
+// the duration. Passes are entered in the order they were declared.
+class ReferenceInterpolator::PassScope {
+public:
+  PassScope(ReferenceInterpolator& owner, PipelineStage stage)
+      : m_owner(owner), m_pass(owner.m_nextPass++), m_stage(owner.m_profiler, stage) {
+    if (const FramePass* pass = Pass()) {
+      for (int resource : pass->acquire) {
+        m_owner.Acquire(resource);
+      }
+    }
+  }
+  ~PassScope() {
+    if (const FramePass* pass = Pass()) {
+      for (int resource : pass->release) {
+        m_owner.Release(resource);
+      }
+    }
+  }
+  PassScope(const PassScope&) = delete;
+  PassScope& operator=(const PassScope&) = delete;
+
+private:
+  const FramePass* Pass() const {
+    const std::vector<FramePass>& passes = m_owner.m_graph.Passes();
+    return m_pass < static_cast<int>(passes.size()) ? &passes[m_pass] : nullptr;
+  }
+
+  ReferenceInterpolator& m_owner;
+  int m_pass;
+  StageScope m_stage;
+};
+
+bool ReferenceInterpolator::CheckFrame(const CpuFrame& frame) const {
+  return frame.data && frame.format == PixelFormat::Bgra8 && frame.width == m_width && frame.height == m_height &&
+         frame.pitch >= static_cast<size_t>(frame.width) * 4;
+}
+
+// ----------------------------------------------------------------------------
+// Stages
+// ----------------------------------------------------------------------------
+
+void ReferenceInterpolator::Downsample(const CpuFrame& frame, Plane& half) {
+  for (int y = 0; y < half.height; ++y) {
+    for (int x = 0; x < half.width; ++x) {
+      int sum = 0;
+      for (int j = 0; j < 2; ++j) {
+        for (int i = 0; i < 2; ++i) {
+          const uint8_t* p = PixelAt(frame, x * 2 + i, y * 2 + j);
+          sum += PixelLuma(p[2], p[1], p[0]);
+        }
+      }
+      half.data[static_cast<size_t>(y) * half.width + x] = sum * 0.25f;
+    }
+  }
+}
+
+// Block search of from -> to: for each texel of from, the offset into to
+// with the lowest zero-mean SAD over a 5x5 window. Candidates are zero, the
+// upsampled coarser field and the already searched left / upper neighbours;
+// the best one is refined by a shrinking 8-neighbour step search within
+// radius of the prediction, then to sub-texel precision by a parabola fit.
+void ReferenceInterpolator::Search(const Plane& from, const Plane& to, const FlowPlane* prediction, int radius,
+                                   float priorWeight, float stability, FlowPlane& out) {
+  const int w = from.width;
+  const int h = from.height;
+  if (out.width != w || out.height != h) {
+    ResizeFlow(out, w, h);
+  }
+  const float predScale = prediction ? static_cast<float>(w) / static_cast<float>(prediction->width) : 0.0f;
+  constexpr int kTaps = (2 * kPatchRadius + 1) * (2 * kPatchRadius + 1);
+
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      // Reference patch, zero mean.
+      float ref[kTaps];
+      float refMean = 0.0f;
+      int t = 0;
+      for (int j = -kPatchRadius; j <= kPatchRadius; ++j) {
+        for (int i = -kPatchRadius; i <= kPatchRadius; ++i) {
+          ref[t] = Texel(from.data, w, h, x + i, y + j);
+          refMean += ref[t++];
+        }
+      }
+      refMean /= kTaps;
+      float texture = 0.0f;
+      for (float& v : ref) {
+        v -= refMean;
+        texture += std::fabs(v);
+      }
+      texture /= kTaps;
+
+      float predX = 0.0f;
+      float predY = 0.0f;
+      if (prediction) {
+        SampleFlow(*prediction, (x + 0.5f) / predScale - 0.5f, (y + 0.5f) / predScale - 0.5f, predX, predY);
+        predX *= predScale;
+        predY *= predScale;
+      }
+      const int baseX = static_cast<int>(std::lround(predX));
+      const int baseY = static_cast<int>(std::lround(predY));
+
+      auto cost = [&](int mx, int my) {
+        float patch[kTaps];
+        float mean = 0.0f;
+        int k = 0;
+        for (int j = -kPatchRadius; j <= kPatchRadius; ++j) {
+          for (int i = -kPatchRadius; i <= kPatchRadius; ++i) {
+            patch[k] = Texel(to.data, to.width, to.height, x + mx + i, y + my + j);
+            mean += patch[k++];
+          }
+        }
+        mean /= kTaps;
+        float sad = 0.0f;
+        for (k = 0; k < kTaps; ++k) {
+          sad += std::fabs(ref[k] - (patch[k] - mean));
+        }
+        return sad / kTaps + priorWeight * (std::abs(mx - baseX) + std::abs(my - baseY));
+      };
+      auto inRange = [&](int mx, int my) { return std::abs(mx - baseX) <= radius && std::abs(my - baseY) <= radius; };
+
+      int bestX = baseX;
+      int bestY = baseY;
+      float best = cost(bestX, bestY);
+      auto consider = [&](int mx, int my) {
+        if ((mx == bestX && my == bestY) || !inRange(mx, my)) {
+          return false;
+        }
+        const float c = cost(mx, my);
+        if (c < best) {
+          best = c;
+          bestX = mx;
+          bestY = my;
+          return true;
+        }
+        return false;
+      };
+      consider(0, 0);
+      const size_t index = static_cast<size_t>(y) * w + x;
+      if (x > 0) {
+        consider(static_cast<int>(std::lround(out.xy[(index - 1) * 2])),
+                 static_cast<int>(std::lround(out.xy[(index - 1) * 2 + 1])));
+      }
+      if (y > 0) {
+        consider(static_cast<int>(std::lround(out.xy[(index - w) * 2])),
+                 static_cast<int>(std::lround(out.xy[(index - w) * 2 + 1])));
+      }
+
+      int step = 1;
+      while (step * 2 <= radius / 2) {
+        step *= 2;
+      }
+      for (int iteration = 0; step >= 1 && iteration < kMaxSearchSteps; ++iteration) {
+        const int cx = bestX;
+        const int cy = bestY;
+        bool moved = false;
+        for (int j = -1; j <= 1; ++j) {
+          for (int i = -1; i <= 1; ++i) {
+            if (i != 0 || j != 0) {
+              moved |= consider(cx + i * step, cy + j * step);
+            }
+          }
+        }
+        if (!moved) {
+          step /= 2;
+        }
+      }
+
+      // Sub-texel offset from the costs either side of the minimum.
+      float subX = 0.0f;
+      float subY = 0.0f;
+      const float left = cost(bestX - 1, bestY);
+      const float right = cost(bestX + 1, bestY);
+      const float up = cost(bestX, bestY - 1);
+      const float down = cost(bestX, bestY + 1);
+      const float curveX = left - 2.0f * best + right;
+      const float curveY = up - 2.0f * best + down;
+      if (curveX > 1e-4f) subX = std::clamp(0.5f * (left - right) / curveX, -0.5f, 0.5f);
+      if (curveY > 1e-4f) subY = std::clamp(0.5f * (up - down) / curveY, -0.5f, 0.5f);
+
+      // Flat patches match anything; trust them less.
+      const float confidence = texture / (texture + 2.0f) / (1.0f + best * 0.25f);
+      float mx = bestX + subX;
+      float my = bestY + subY;
+      if (prediction) {
+        const float keep = stability * (1.0f - confidence);
+        mx += (predX - mx) * keep;
+        my += (predY - my) * keep;
+      }
+      out.xy[index * 2] = mx;
+      out.xy[index * 2 + 1] = my;
+      out.confidence[index] = confidence;
+    }
+  }
+}
+
+// Confidence- and edge-weighted 3x3 average, as MotionSmooth.
+void ReferenceInterpolator::Smooth(const Plane& luma, FlowPlane& flow) {
+  const int w = flow.width;
+  const int h = flow.height;
+  if (m_scratch.width != w || m_scratch.height != h) {
+    ResizeFlow(m_scratch, w, h);
+  }
+  const float lumaScale = static_cast<float>(luma.width) / static_cast<float>(w);
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      const float center = Texel(luma.data, luma.width, luma.height, static_cast<int>(x * lumaScale),
+                                 static_cast<int>(y * lumaScale));
+      float sumX = 0.0f;
+      float sumY = 0.0f;
+      float sumW = 0.0f;
+      float sumC = 0.0f;
+      for (int j = -1; j <= 1; ++j) {
+        for (int i = -1; i <= 1; ++i) {
+          const int nx = std::clamp(x + i, 0, w - 1);
+          const int ny = std::clamp(y + j, 0, h - 1);
+          const size_t n = static_cast<size_t>(ny) * w + nx;
+          const float edge = std::fabs(Texel(luma.data, luma.width, luma.height, static_cast<int>(nx * lumaScale),
+                                             static_cast<int>(ny * lumaScale)) - center);
+          const float weight = (flow.confidence[n] + 1e-3f) * std::exp2(-edge / kEdgeScale);
+          sumX += flow.xy[n * 2] * weight;
+          sumY += flow.xy[n * 2 + 1] * weight;
+          sumC += flow.confidence[n] * weight;
+          sumW += weight;
+        }
+      }
+      const size_t index = static_cast<size_t>(y) * w + x;
+      m_scratch.xy[index * 2] = sumX / sumW;
+      m_scratch.xy[index * 2 + 1] = sumY / sumW;
+      m_scratch.confidence[index] = sumC / sumW;
+    }
+  }
+  std::swap(flow.xy, m_scratch.xy);
+  std::swap(flow.confidence, m_scratch.confidence);
+}
+
+// Backward warp to time alpha: prev is read at x - alpha * F, curr at
+// x + (1 - alpha) * F. Quality 1 samples bicubically and down-weights a
+// source that fails the forward-backward consistency check (it shows a
+// surface occluded in the other frame).
+void ReferenceInterpolator::Warp(const CpuFrame& prev, const CpuFrame& curr, float alpha) {
+  const FlowPlane& fwd = *m_forward;
+  const FlowPlane& bwd = *m_backward;
+  const float s = static_cast<float>(m_motionScale);
+  const float inv = 1.0f / s;
+  const bool high = m_settings.qualityMode >= 1;
+  for (int y = 0; y < m_height; ++y) {
+    uint8_t* row = m_output.data() + static_cast<size_t>(y) * m_width * 4;
+    for (int x = 0; x < m_width; ++x) {
+      float fx = 0.0f;
+      float fy = 0.0f;
+      SampleFlow(fwd, (x + 0.5f) * inv - 0.5f, (y + 0.5f) * inv - 0.5f, fx, fy);
+      fx *= s;
+      fy *= s;
+      const float px = x - alpha * fx;
+      const float py = y - alpha * fy;
+      const float cx = x + (1.0f - alpha) * fx;
+      const float cy = y + (1.0f - alpha) * fy;
+      float a[3];
+      float b[3];
+      float wPrev = 1.0f - alpha;
+      float wCurr = alpha;
+      if (high) {
+        SampleBicubic(prev, px, py, a);
+        SampleBicubic(curr, cx, cy, b);
+        // Forward-backward consistency at each source: a surface visible in
+        // both frames maps there and back to where it started; one that is
+        // occluded in the other frame does not. Residual in motion texels.
+        auto residual = [&](const FlowPlane& there, const FlowPlane& back, float sx, float sy) {
+          const float tx = (sx + 0.5f) * inv - 0.5f;
+          const float ty = (sy + 0.5f) * inv - 0.5f;
+          float dx = 0.0f, dy = 0.0f, rx = 0.0f, ry = 0.0f;
+          SampleFlow(there, tx, ty, dx, dy);
+          SampleFlow(back, tx + dx, ty + dy, rx, ry);
+          return std::hypot(dx + rx, dy + ry);
+        };
+        const float prevResidual = residual(fwd, bwd, px, py);
+        const float currResidual = residual(bwd, fwd, cx, cy);
+        // Only the excess over the other side counts: where both fail, the
+        // field itself is unreliable and the plain blend is the safer answer.
+        const float prevExcess = std::max(0.0f, prevResidual - currResidual);
+        const float currExcess = std::max(0.0f, currResidual - prevResidual);
+        wPrev = wPrev * std::exp(-kOcclusionFalloff * prevExcess * prevExcess) + 1e-4f;
+        wCurr = wCurr * std::exp(-kOcclusionFalloff * currExcess * currExcess) + 1e-4f;
+      } else {
+        SampleBilinear(prev, px, py, a);
+        SampleBilinear(curr, cx, cy, b);
+      }
+      const float norm = 1.0f / (wPrev + wCurr);
+      for (int c = 0; c < 3; ++c) {
+        const float v = (a[c] * wPrev + b[c] * wCurr) * norm;
+        row[x * 4 + c] = static_cast<uint8_t>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+      }
+      row[x * 4 + 3] = 255;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Execution
+// ----------------------------------------------------------------------------
+
+bool ReferenceInterpolator::Execute(const CpuFrame& prev, const CpuFrame& curr, float alpha) {
+  if (!CheckFrame(prev) || !CheckFrame(curr)) {
+    return false;
+  }
+  if (m_graphMinimal != m_settings.minimalPipeline || m_graphAliased != m_settings.aliasTransients) {
+    BuildGraph();
+  }
+  m_nextPass = 0;
+  StageFrameScope frame(m_profiler);
+  StageScope execute(m_profiler, PipelineStage::Execute);
+  const MotionSearchParams search = MotionSearchParamsFor(m_settings.motionModel, m_settings.minimalPipeline);
+
+  {
+    PassScope pass(*this, PipelineStage::Downsample);
+    Downsample(prev, m_half[0]);
+    Downsample(curr, m_half[1]);
+  }
+  {
+    PassScope pass(*this, PipelineStage::Pyramid);
+    for (int i = 0; i < 2; ++i) {
+      Reduce(m_half[i].data, m_half[i].width, m_half[i].height, m_quarter[i].data, m_quarter[i].width,
+             m_quarter[i].height);
+      Reduce(m_quarter[i].data, m_quarter[i].width, m_quarter[i].height, m_eighth[i].data, m_eighth[i].width,
+             m_eighth[i].height);
+    }
+  }
+  // The prior pulls toward the coarser field (toward zero at eighth res) in
+  // proportion to the model's prior mix; stability keeps the prediction
+  // where the match is weak.
+  const float priorWeight = kPriorScale * search.attnPriorMix;
+  {
+    PassScope pass(*this, PipelineStage::MotionForward);
+    Search(m_eighth[0], m_eighth[1], nullptr, search.tinyRadiusFwd, priorWeight, 0.0f, m_tinyForward);
+  }
+  {
+    PassScope pass(*this, PipelineStage::MotionBackward);
+    Search(m_eighth[1], m_eighth[0], nullptr, search.tinyRadiusBwd, priorWeight, 0.0f, m_tinyBackward);
+  }
+
+  if (m_settings.minimalPipeline) {
+    {
+      PassScope pass(*this, PipelineStage::Smooth);
+      Smooth(m_eighth[0], m_tinyForward);
+      Smooth(m_eighth[1], m_tinyBackward);
+    }
+    m_forward = &m_tinyForward;
+    m_backward = &m_tinyBackward;
+    m_motionScale = 8;
+  } else {
+    {
+      PassScope pass(*this, PipelineStage::RefineQuarter);
+      Search(m_quarter[0], m_quarter[1], &m_tinyForward, search.refineSmallR, priorWeight, search.attnStability,
+             m_quarterForward);
+      Search(m_quarter[1], m_quarter[0], &m_tinyBackward, search.refineSmallR, priorWeight, search.attnStability,
+             m_quarterBackward);
+    }
+    {
+      PassScope pass(*this, PipelineStage::RefineHalf);
+      Search(m_half[0], m_half[1], &m_quarterForward, search.refineFullR, priorWeight, search.attnStability,
+             m_halfForward);
+      Search(m_half[1], m_half[0], &m_quarterBackward, search.refineFullR, priorWeight, search.attnStability,
+             m_halfBackward);
+    }
+    {
+      PassScope pass(*this, PipelineStage::Smooth);
+      Smooth(m_half[0], m_halfForward);
+      Smooth(m_half[1], m_halfBackward);
+    }
+    m_forward = &m_halfForward;
+    m_backward = &m_halfBackward;
+    m_motionScale = 2;
+  }
+  m_hasMotion = true;
+
+  PassScope pass(*this, PipelineStage::Interpolate);
+  Warp(prev, curr, alpha);
+  return true;
+}
+
+bool ReferenceInterpolator::InterpolateOnly(const CpuFrame& prev, const CpuFrame& curr, float alpha) {
+  if (!m_hasMotion || !CheckFrame(prev) || !CheckFrame(curr)) {
+    return false;
+  }
+  StageFrameScope frame(m_profiler);
+  StageScope execute(m_profiler, PipelineStage::InterpolateOnly);
+  StageScope stage(m_profiler, PipelineStage::Interpolate);
+  Warp(prev, curr, alpha);
+  return true;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "cpu_frame.h"
+#include "frame_graph.h"
+#include "stage_timer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Portable CPU model of Interpolator's pipeline, for headless benchmarks and
+// quality regressions on machines without D3D11 or Vulkan.
+//
+// The stage structure, levels and parameters follow the GPU path: half-res
+// luma, a quarter / eighth pyramid, forward and backward search at eighth
+// res with the motion model's radii, quarter and half-res refinement (full
+// pipeline only), confidence-weighted smoothing, then a bidirectional warp
+// at full res. The kernels are simpler than the shaders (zero-mean SAD
+// instead of ZNCC with attention, no temporal feedback), so absolute quality
+// differs; timings and quality move with the same settings and are meant to
+// be compared run against run, not against the GPU.
+//
+// Every stage is timed through a StageProfiler with the GPU path's stage
+// names, so the same summaries and Chrome trace export apply.
+//
+// Stages run as passes of a FrameGraph. With aliasTransients, planes and
+// fields that are dead after their last pass (the pyramid, and in the full
+// pipeline the eighth and quarter fields) borrow their storage from the
+// graph's alias slots for the length of their lifetime, so levels with
+// disjoint lifetimes share memory.
+
+struct ReferenceSettings {
+  int motionModel = 1;              // MotionModel
+  int qualityMode = 0;              // 0 bilinear blend, 1 bicubic + occlusion-aware weights
+  bool minimalPipeline = true;      // stop after the eighth-res search
+  bool aliasTransients = true;      // share transient storage through the frame graph
+};
+
+// Motion field: two floats (dx, dy) per texel, in texels of its own level.
+struct FlowPlane {
+  int width = 0;
+  int height = 0;
+  std::vector<float> xy;
+  std::vector<float> confidence;
+};
+
+class ReferenceInterpolator {
+public:
+  ReferenceInterpolator();
+
+  // Frames must be Bgra8 of this size.
+  bool Resize(int width, int height);
+  void SetSettings(const ReferenceSettings& settings) { m_settings = settings; }
+  const ReferenceSettings& Settings() const { return m_settings; }
+
+  // Estimates motion prev -> curr and writes the frame at alpha.
+  bool Execute(const CpuFrame& prev, const CpuFrame& curr, float alpha);
+  // Re-warp with the motion of the last Execute.
+  bool InterpolateOnly(const CpuFrame& prev, const CpuFrame& curr, float alpha);
+
+  int Width() const { return m_width; }
+  int Height() const { return m_height; }
+  // Bgra8, rows tightly packed.
+  const std::vector<uint8_t>& Output() const { return m_output; }
+
+  // Final forward (prev -> curr) and backward motion, and how many full-res
+  // pixels one of their texels covers (8 minimal, 2 full).
+  const FlowPlane& ForwardMotion() const { return *m_forward; }
+  const FlowPlane& BackwardMotion() const { return *m_backward; }
+  int MotionScale() const { return m_motionScale; }
+  // Per-level fields of the last Execute, for flow export. Quarter and half
+  // are only written by the full pipeline. A level that is transient in the
+  // active pipeline has given its storage back after its last reader, so
+  // export needs aliasTransients off.
+  const FlowPlane& EighthMotion(bool backward) const { return backward ? m_tinyBackward : m_tinyForward; }
+  const FlowPlane& QuarterMotion(bool backward) const { return backward ? m_quarterBackward : m_quarterForward; }
+  const FlowPlane& HalfMotion(bool backward) const { return backward ? m_halfBackward : m_halfForward; }
+
+  // Working memory currently allocated (planes, motion fields, alias slots,
+  // output).
+  size_t MemoryBytes() const;
+  // The pass graph of the active pipeline, rebuilt when it changes.
+  const FrameGraph& Graph() const { return m_graph; }
+
+  StageProfiler& Profiler() { return m_profiler; }
+
+private:
+  struct Plane {
+    int width = 0;
+    int height = 0;
+    std::vector<float> data;
+  };
+
+  class PassScope;
+
+  void BuildGraph();
+  void Acquire(int resource);
+  void Release(int resource);
+  bool CheckFrame(const CpuFrame& frame) const;
+  void Downsample(const CpuFrame& frame, Plane& half);
+  void Search(const Plane& from, const Plane& to, const FlowPlane* prediction, int radius, float priorWeight,
+              float stability, FlowPlane& out);
+  void Smooth(const Plane& luma, FlowPlane& flow);
+  void Warp(const CpuFrame& prev, const CpuFrame& curr, float alpha);
+
+  ReferenceSettings m_settings;
+  int m_width = 0;
+  int m_height = 0;
+
+  // [0] prev, [1] curr.
+  Plane m_half[2];
+  Plane m_quarter[2];
+  Plane m_eighth[2];
+
+  FlowPlane m_tinyForward;
+  FlowPlane m_tinyBackward;
+  FlowPlane m_quarterForward;
+  FlowPlane m_quarterBackward;
+  FlowPlane m_halfForward;
+  FlowPlane m_halfBackward;
+  FlowPlane m_scratch;
+  const FlowPlane* m_forward = nullptr;
+  const FlowPlane* m_backward = nullptr;
+  int m_motionScale = 8;
+  bool m_hasMotion = false;
+
+  std::vector<uint8_t> m_output;
+
+  FrameGraph m_graph;
+  std::vector<std::vector<float>*> m_storage;     // per graph resource; null for the output
+  std::vector<std::vector<float>> m_slots;        // alias slot memory while no resident holds it
+  bool m_graphMinimal = true;
+  bool m_graphAliased = true;
+  int m_nextPass = 0;
+
+  StageProfiler m_profiler;
+};
@@ -1,7 +1,7 @@
 #include "render_device.h"
+#include "async_log.h"
 
 #include <algorithm>
-#include <fstream>
 #include <cstring>
 
 #ifdef USE_VULKAN
@@ -27,11 +27,7 @@ RenderDevice::~RenderDevice() {
 }
 
 bool RenderDevice::Initialize(void* windowHandle, bool preferVulkan) {
-    {
-        std::ofstream debugFile("vulkan_debug.txt", std::ios::app);
-        debugFile << "RenderDevice::Initialize start, preferVulkan=" << preferVulkan << "\n";
-        debugFile.flush();
-    }
+    TFE_LOG(Info, Vulkan, "RenderDevice::Initialize start, preferVulkan={}", preferVulkan);
 
     // Always initialize D3D11 first (needed for swap chain, ImGui, textures)
     if (!InitializeD3D11(windowHandle)) {
@@ -44,11 +40,7 @@ bool RenderDevice::Initialize(void* windowHandle, bool preferVulkan) {
     if (preferVulkan && InitializeVulkan(windowHandle)) {
         m_useVulkan = true;
         m_backendName = "Vulkan+D3D11";
-        {
-            std::ofstream debugFile("vulkan_debug.txt", std::ios::app);
-            debugFile << "RenderDevice::Initialize Vulkan succeeded, m_useVulkan=true\n";
-            debugFile.flush();
-        }
+        TFE_LOG(Info, Vulkan, "RenderDevice::Initialize Vulkan succeeded, m_useVulkan=true");
         return true;
     }
 #endif
@@ -110,20 +102,12 @@ void RenderDevice::WaitIdle() {
 #ifdef USE_VULKAN
 
 bool RenderDevice::InitializeVulkan(void* windowHandle) {
-    {
-        std::ofstream debugFile("vulkan_debug.txt", std::ios::app);
-        debugFile << "InitializeVulkan ENTER\n";
-        debugFile.flush();
-    }
+    TFE_LOG(Info, Vulkan, "InitializeVulkan ENTER");
     // Check for Vulkan
     PFN_vkEnumerateInstanceExtensionProperties extFn = 
         (PFN_vkEnumerateInstanceExtensionProperties)vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceExtensionProperties");
     if (!extFn) {
-        {
-            std::ofstream debugFile("vulkan_debug.txt", std::ios::app);
-            debugFile << "InitializeVulkan FAIL: vkGetInstanceProcAddr failed\n";
-            debugFile.flush();
-        }
+        TFE_LOG(Error, Vulkan, "InitializeVulkan FAIL: vkGetInstanceProcAddr failed");
         OutputDebugStringA("[RenderDevice] Vulkan not available\n");
         return false;
     }
@@ -167,14 +151,10 @@ bool RenderDevice::InitializeVulkan(void* windowHandle) {
     createInfo.ppEnabledExtensionNames = enabledExts.data();
 
     if (vkCreateInstance(&createInfo, nullptr, &m_vkInstance) != VK_SUCCESS) {
-        {
-            std::ofstream debugFile("vulkan_debug.txt", std::ios::app);
-            debugFile << "InitializeVulkan FAIL: vkCreateInstance failed\n";
-            debugFile << "  numExts=" << enabledExts.size() << "\n";
-            for (size_t i = 0; i < enabledExts.size(); i++) {
-                debugFile << "  ext[" << i << "]=" << enabledExts[i] << "\n";
-            }
-            debugFile.flush();
+        TFE_LOG(Error, Vulkan, "InitializeVulkan FAIL: vkCreateInstance failed");
+        TFE_LOG(Info, Vulkan, "  numExts={}", enabledExts.size());
+        for (size_t i = 0; i < enabledExts.size(); i++) {
+            TFE_LOG(Info, Vulkan, "  ext[{}]={}", i, enabledExts[i]);
         }
         OutputDebugStringA("[RenderDevice] Failed to create Vulkan instance\n");
         return false;
@@ -183,11 +163,7 @@ bool RenderDevice::InitializeVulkan(void* windowHandle) {
     // Enumerate physical devices
     uint32_t deviceCount = 0;
     if (vkEnumeratePhysicalDevices(m_vkInstance, &deviceCount, nullptr) != VK_SUCCESS || deviceCount == 0) {
-        {
-            std::ofstream debugFile("vulkan_debug.txt", std::ios::app);
-            debugFile << "InitializeVulkan FAIL: No devices found\n";
-            debugFile.flush();
-        }
+        TFE_LOG(Error, Vulkan, "InitializeVulkan FAIL: No devices found");
         OutputDebugStringA("[RenderDevice] No Vulkan devices found\n");
         return false;
     }
@@ -268,12 +244,8 @@ bool RenderDevice::InitializeVulkan(void* windowHandle) {
       deviceExtVec.push_back(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME);
     }
 
-    {
-      std::ofstream debugFile("vulkan_debug.txt", std::ios::app);
-      debugFile << "VkDevice exts: hasExtMem=" << hasExtMem << "\n";
-      for (const auto* e : deviceExtVec) debugFile << "  " << e << "\n";
-      debugFile.flush();
-    }
+    TFE_LOG(Info, Vulkan, "VkDevice exts: hasExtMem={}", hasExtMem);
+    for (const auto* e : deviceExtVec) TFE_LOG(Info, Vulkan, "  {}", e);
 
     VkDeviceCreateInfo deviceCreateInfo = {};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -0,0 +1,129 @@
+#include "replay_source.h"
+
+#include "deadline_wait.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool ReplaySource::Open(const std::string& path) {
+  StopCapture();
+  m_stats = ReplayStats();
+  m_startSec = 0.0;
+  m_loopOffset100ns = 0;
+  m_sequenceOffset = 0;
+  m_lastSequence = 0;
+  m_recordedClock.Reset();
+  if (!m_reader.Open(path)) {
+    m_lastError = m_reader.GetLastError();
+    return false;
+  }
+  if (!ReadNext()) {
+    m_lastError = m_reader.GetLastError().empty() ? "Recording has no frames" : m_reader.GetLastError();
+    m_reader.Close();
+    return false;
+  }
+  m_hasNext = true;
+  m_firstTime100ns = m_nextTime100ns;
+  m_isCapturing = true;
+  m_lastError.clear();
+  return true;
+}
+
+void ReplaySource::SetSpeed(double speed) {
+  speed = std::max(speed, 0.0);
+  if (m_startSec != 0.0 && speed > 0.0) {
+    const double now = DeadlineWaiter::Now();
+    if (m_speed > 0.0) {
+      m_startSec = now - (now - m_startSec) * m_speed / speed;
+    } else if (m_hasNext) {
+      // Leaving unpaced playback: the pending frame becomes due now.
+      const int64_t offset = m_nextTime100ns + m_loopOffset100ns - m_firstTime100ns;
+      m_startSec = now - static_cast<double>(offset) * 1e-7 / speed;
+    }
+  }
+  m_speed = speed;
+}
+
+void ReplaySource::StopCapture() {
+  m_reader.Close();
+  m_hasNext = false;
+  m_isCapturing = false;
+}
+
+// The recording keeps the clock domain of the source it was made from.
+bool ReplaySource::ReadNext() {
+  if (!m_reader.Next(m_next)) {
+    return false;
+  }
+  m_nextTime100ns = m_recordedClock.Time100ns(m_next.presentTime100ns, m_next.systemTime100ns);
+  return true;
+}
+
+bool ReplaySource::ReadAhead() {
+  int64_t prevTime = m_nextTime100ns;
+  if (ReadNext()) {
+    return true;
+  }
+  if (!m_loop || !m_reader.GetLastError().empty() || !m_reader.Rewind() || !ReadNext()) {
+    return false;
+  }
+  // Continue the timeline: the first frame of the next loop follows the
+  // last one by the recording's mean frame interval.
+  const uint64_t frames = std::max<uint64_t>(m_stats.frames / (m_stats.loops + 1), 2);
+  const int64_t span = prevTime - m_firstTime100ns;
+  m_loopOffset100ns += span + span / static_cast<int64_t>(frames - 1);
+  m_sequenceOffset += m_lastSequence;
+  m_stats.loops++;
+  return true;
+}
+
+double ReplaySource::NextDueSec() const {
+  if (!m_hasNext || m_startSec == 0.0 || m_speed <= 0.0) {
+    return 0.0;
+  }
+  const int64_t offset = m_nextTime100ns + m_loopOffset100ns - m_firstTime100ns;
+  return m_startSec + static_cast<double>(offset) * 1e-7 / m_speed;
+}
+
+bool ReplaySource::AcquireFrame(SourceFrame& frame) {
+  if (!m_isCapturing) {
+    return false;
+  }
+  if (!m_hasNext) {
+    if (!ReadAhead()) {
+      m_lastError = m_reader.GetLastError();
+      StopCapture();
+      return false;
+    }
+    m_hasNext = true;
+  }
+
+  const double now = DeadlineWaiter::Now();
+  if (m_startSec == 0.0) {
+    m_startSec = now;
+  }
+  const double due = NextDueSec();
+  if (due > now) {
+    return false;
+  }
+
+  const int64_t recorded = m_nextTime100ns + m_loopOffset100ns;
+  frame.onGpu = false;
+  frame.cpu = m_next;
+  frame.cpu.sequence = m_next.sequence + m_sequenceOffset;
+  frame.cpu.systemTime100ns = static_cast<int64_t>(std::llround(now * 1e7));
+  if (m_clock == ReplayClock::Original) {
+    frame.cpu.presentTime100ns = recorded;
+  } else {
+    frame.cpu.presentTime100ns = due > 0.0 ? static_cast<int64_t>(std::llround(due * 1e7))
+                                           : frame.cpu.systemTime100ns;
+  }
+  m_lastSequence = m_next.sequence;
+  m_hasNext = false;
+
+  m_stats.frames++;
+  if (due > 0.0) {
+    m_stats.maxLateSec = std::max(m_stats.maxLateSec, now - due);
+  }
+  return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "capture_source.h"
+#include "frame_stream.h"
+
+#include <string>
+
+// Capture source that plays a recorded frame stream back.
+//
+// Frames are released on the recorded timeline: frame i becomes available
+// once (t_i - t_0) / speed has passed since playback started, so the
+// pacing code sees the same intervals, stutters and skipped frames as the
+// original session. Speed 0 releases a frame on every call, for offline
+// runs that only care about order and content.
+//
+// Timestamps: with ReplayClock::Original the frame keeps the recorded
+// presentTime100ns (deterministic across runs); with ReplayClock::Rebased it
+// is moved onto the live monotonic clock (DeadlineWaiter::Now), which is what
+// the app's display clock mapping expects. Rebased times are scaled by the
+// speed, so an accelerated replay still looks like a steady source.
+
+enum class ReplayClock {
+  Original,
+  Rebased,
+};
+
+struct ReplayStats {
+  uint64_t frames = 0;
+  uint64_t loops = 0;
+  double maxLateSec = 0.0;      // delivery after the frame became due
+};
+
+class ReplaySource : public ICaptureSource {
+public:
+  bool Open(const std::string& path);
+
+  // Takes effect from the current playback position (no jump or burst).
+  void SetSpeed(double speed);
+  double Speed() const { return m_speed; }
+  void SetLoop(bool loop) { m_loop = loop; }
+  void SetClock(ReplayClock clock) { m_clock = clock; }
+
+  // Monotonic time (DeadlineWaiter::Now seconds) the next frame is due,
+  // or 0 if it is due now / playback has not started.
+  double NextDueSec() const;
+
+  const ReplayStats& Stats() const { return m_stats; }
+  const std::string& GetLastError() const { return m_lastError; }
+
+  // ICaptureSource
+  const char* SourceName() const override { return "Replay"; }
+  bool IsCapturing() const override { return m_isCapturing; }
+  void StopCapture() override;
+  bool AcquireFrame(SourceFrame& frame) override;
+
+private:
+  bool ReadAhead();
+  bool ReadNext();
+
+  FrameStreamReader m_reader;
+  CpuFrame m_next;
+  int64_t m_nextTime100ns = 0;      // recorded time of m_next on m_recordedClock
+  SourceClock m_recordedClock;
+  bool m_hasNext = false;
+  bool m_isCapturing = false;
+  bool m_loop = false;
+  double m_speed = 1.0;
+  ReplayClock m_clock = ReplayClock::Rebased;
+  double m_startSec = 0.0;          // wall clock of the first frame
+  int64_t m_firstTime100ns = 0;     // recorded time of the first frame
+  int64_t m_loopOffset100ns = 0;    // recorded time added per completed loop
+  uint64_t m_sequenceOffset = 0;
+  uint64_t m_lastSequence = 0;
+  ReplayStats m_stats;
+  std::string m_lastError;
+};
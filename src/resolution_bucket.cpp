@@ -0,0 +1,148 @@
+#include "resolution_bucket.h"
+
+#include <algorithm>
+
+const char* BucketActionName(BucketAction action) {
+  switch (action) {
+    case BucketAction::Reuse:
+      return "reuse";
+    case BucketAction::Grow:
+      return "grow";
+    case BucketAction::Shrink:
+      return "shrink";
+  }
+  return "";
+}
+
+int BucketExtent(int extent, int granularity) {
+  if (extent <= 0) {
+    return 0;
+  }
+  if (granularity <= 1) {
+    return extent;
+  }
+  return (extent + granularity - 1) / granularity * granularity;
+}
+
+BucketPlan PlanResolutionBucket(int allocatedWidth, int allocatedHeight, int width, int height,
+                                const ResolutionBucketPolicy& policy) {
+  BucketPlan plan;
+  plan.width = allocatedWidth;
+  plan.height = allocatedHeight;
+  if (width <= 0 || height <= 0) {
+    return plan;
+  }
+
+  const int bucketWidth = BucketExtent(width, policy.granularity);
+  const int bucketHeight = BucketExtent(height, policy.granularity);
+  const int slack = std::max(0, policy.shrinkSlack);
+  // Headroom only when growing a set in use: the first allocation is not
+  // part of a drag.
+  const int headroom = allocatedWidth > 0 ? std::clamp(policy.growHeadroom, 0, slack) : 0;
+  if (allocatedWidth < width || allocatedHeight < height) {
+    plan.action = BucketAction::Grow;
+    plan.width = allocatedWidth < width ? BucketExtent(width + headroom, policy.granularity) : bucketWidth;
+    plan.height = allocatedHeight < height ? BucketExtent(height + headroom, policy.granularity) : bucketHeight;
+    return plan;
+  }
+  if (allocatedWidth - bucketWidth > slack || allocatedHeight - bucketHeight > slack) {
+    plan.action = BucketAction::Shrink;
+    plan.width = bucketWidth;
+    plan.height = bucketHeight;
+  }
+  return plan;
+}
+
+int BucketViewportExtent(int levelExtent, int viewport, int allocated) {
+  if (levelExtent <= 0 || viewport <= 0 || allocated <= 0 || viewport >= allocated) {
+    return levelExtent;
+  }
+  const int64_t scaled = (static_cast<int64_t>(levelExtent) * viewport + allocated - 1) / allocated;
+  return std::clamp(static_cast<int>(scaled), 1, levelExtent);
+}
+
+// ----------------------------------------------------------------------------
+// ResolutionBucketPool
+// ----------------------------------------------------------------------------
+
+ResolutionBucketPool::ResolutionBucketPool(const ResolutionBucketPolicy& policy) : m_policy(policy) {}
+
+void ResolutionBucketPool::Reset() {
+  m_inputWidth = 0;
+  m_inputHeight = 0;
+  m_allocatedWidth = 0;
+  m_allocatedHeight = 0;
+  m_pendingWidth = 0;
+  m_pendingHeight = 0;
+  m_passthroughRun = 0;
+}
+
+BucketPlan ResolutionBucketPool::Request(int width, int height) {
+  if (width <= 0 || height <= 0) {
+    return BucketPlan{BucketAction::Reuse, m_allocatedWidth, m_allocatedHeight};
+  }
+  const bool changed = width != m_inputWidth || height != m_inputHeight;
+  m_inputWidth = width;
+  m_inputHeight = height;
+  if (changed) {
+    ++m_stats.resizes;
+  }
+  if (Pending()) {
+    // Planned again when the build in flight completes.
+    return BucketPlan{BucketAction::Reuse, m_allocatedWidth, m_allocatedHeight};
+  }
+  BucketPlan plan = Plan();
+  if (changed && plan.action == BucketAction::Reuse) {
+    ++m_stats.reuses;
+  }
+  return plan;
+}
+
+BucketPlan ResolutionBucketPool::Completed(bool ok) {
+  if (!Pending()) {
+    return BucketPlan{BucketAction::Reuse, m_allocatedWidth, m_allocatedHeight};
+  }
+  if (!ok) {
+    ++m_stats.failures;
+    m_pendingWidth = 0;
+    m_pendingHeight = 0;
+    return BucketPlan{BucketAction::Reuse, m_allocatedWidth, m_allocatedHeight};
+  }
+  m_allocatedWidth = m_pendingWidth;
+  m_allocatedHeight = m_pendingHeight;
+  m_pendingWidth = 0;
+  m_pendingHeight = 0;
+  return Plan();
+}
+
+bool ResolutionBucketPool::Serves() const {
+  return m_allocatedWidth > 0 && m_allocatedWidth >= m_inputWidth && m_allocatedHeight >= m_inputHeight;
+}
+
+void ResolutionBucketPool::CountPassthrough() {
+  ++m_stats.passthroughFrames;
+  ++m_passthroughRun;
+  m_stats.longestPassthroughRun = std::max<uint64_t>(m_stats.longestPassthroughRun, m_passthroughRun);
+}
+
+bool ResolutionBucketPool::ShouldWaitForBuild() const {
+  return Pending() && m_policy.maxPassthroughRun > 0 && m_passthroughRun >= m_policy.maxPassthroughRun;
+}
+
+BucketPlan ResolutionBucketPool::Plan() {
+  BucketPlan plan = PlanResolutionBucket(m_allocatedWidth, m_allocatedHeight, m_inputWidth, m_inputHeight, m_policy);
+  switch (plan.action) {
+    case BucketAction::Reuse:
+      return plan;
+    case BucketAction::Grow:
+      ++m_stats.grows;
+      break;
+    case BucketAction::Shrink:
+      ++m_stats.shrinks;
+      break;
+  }
+  ++m_stats.builds;
+  m_pendingWidth = plan.width;
+  m_pendingHeight = plan.height;
+  return plan;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+
+// Size buckets for the interpolator's working set.
+//
+// Capture sizes change on every frame while a window edge is dragged, and
+// reallocating the whole working set (every pyramid level, motion field and
+// state buffer with its views) for each of them stalls the render thread.
+// Instead the set is allocated for the input size rounded up to a bucket and
+// holds the frame in its top-left corner, the viewport:
+//
+//  - a size that still fits, with no more padding than the policy allows,
+//    only moves the viewport;
+//  - a larger size needs a new set. The owner builds it off the render
+//    thread; until it lands, frames the current set cannot hold are passed
+//    through uninterpolated. An axis that grew gets some headroom, since a
+//    drag that grew it usually keeps going. Once too many frames in a row
+//    have been passed through, the owner waits for the build instead: one
+//    hitch is better than interpolation dropping out for good on a long
+//    drag or a slow device;
+//  - a size far enough below the allocation also gets a new set, to give
+//    the padding back, but the current set keeps serving while it builds.
+//
+// ResolutionBucketPool only decides; the owner allocates what it asks for
+// and reports back. One build is in flight at a time: sizes requested
+// meanwhile are planned again when it completes.
+
+struct ResolutionBucketPolicy {
+  int granularity = 64;       // allocated extents are multiples of this
+  int growHeadroom = 64;      // added to an axis that outgrew the allocation in use
+  int shrinkSlack = 128;      // padding per axis beyond the bucket kept before shrinking
+  int maxPassthroughRun = 6;  // frames passed through in a row before waiting for the build; 0 = never wait
+
+  // Exact sizes: every change reallocates (backends that cannot use a
+  // viewport).
+  static ResolutionBucketPolicy Exact() { return {1, 0, 0, 0}; }
+};
+
+enum class BucketAction : uint8_t {
+  Reuse,              // nothing to build
+  Grow,               // the allocation cannot hold the input
+  Shrink,             // it can, with more padding than the policy allows
+};
+
+const char* BucketActionName(BucketAction action);
+
+// Extent rounded up to the granularity; granularity <= 1 keeps it.
+int BucketExtent(int extent, int granularity);
+
+struct BucketPlan {
+  BucketAction action = BucketAction::Reuse;
+  int width = 0;              // allocation to build, or the current one for Reuse
+  int height = 0;
+};
+
+// allocatedWidth/Height 0: nothing allocated, always Grow.
+BucketPlan PlanResolutionBucket(int allocatedWidth, int allocatedHeight, int width, int height,
+                                const ResolutionBucketPolicy& policy);
+
+// Texels of an allocated level that hold the viewport: the level's extent
+// scaled by viewport / allocation, rounded up.
+int BucketViewportExtent(int levelExtent, int viewport, int allocated);
+
+struct ResolutionBucketStats {
+  uint64_t resizes = 0;             // input size changes
+  uint64_t reuses = 0;              // absorbed by the allocation in use
+  uint64_t builds = 0;              // sets requested (grow + shrink)
+  uint64_t grows = 0;
+  uint64_t shrinks = 0;
+  uint64_t failures = 0;            // builds that did not complete
+  uint64_t passthroughFrames = 0;   // frames the allocation could not hold
+  uint64_t longestPassthroughRun = 0;
+  uint64_t waitedBuilds = 0;        // background builds finished on the render thread
+};
+
+class ResolutionBucketPool {
+public:
+  explicit ResolutionBucketPool(const ResolutionBucketPolicy& policy = ResolutionBucketPolicy());
+
+  void SetPolicy(const ResolutionBucketPolicy& policy) { m_policy = policy; }
+  const ResolutionBucketPolicy& Policy() const { return m_policy; }
+  // Forgets the allocation and any build in flight (device loss, shutdown).
+  void Reset();
+
+  // New input size. A plan other than Reuse is a build the caller must
+  // start and later report with Completed().
+  BucketPlan Request(int width, int height);
+  // The build from the last plan finished. On success its allocation is
+  // the one in use; if the input moved on meanwhile, the returned plan is
+  // the next build. A failed build is not retried until the next Request.
+  BucketPlan Completed(bool ok);
+
+  // The allocation in use holds the input.
+  bool Serves() const;
+  bool Pending() const { return m_pendingWidth > 0; }
+  // Per frame: whether the allocation held it (interpolated) or not
+  // (passed through).
+  void CountServed() { m_passthroughRun = 0; }
+  void CountPassthrough();
+  // The pass-through run reached the policy limit: the owner should finish
+  // the build in flight now, and count it with CountWaitedBuild.
+  bool ShouldWaitForBuild() const;
+  void CountWaitedBuild() { ++m_stats.waitedBuilds; }
+
+  int InputWidth() const { return m_inputWidth; }
+  int InputHeight() const { return m_inputHeight; }
+  int AllocatedWidth() const { return m_allocatedWidth; }
+  int AllocatedHeight() const { return m_allocatedHeight; }
+  int PendingWidth() const { return m_pendingWidth; }
+  int PendingHeight() const { return m_pendingHeight; }
+
+  const ResolutionBucketStats& Stats() const { return m_stats; }
+  void ResetStats() { m_stats = ResolutionBucketStats(); }
+
+private:
+  BucketPlan Plan();
+
+  ResolutionBucketPolicy m_policy;
+  ResolutionBucketStats m_stats;
+  int m_inputWidth = 0;
+  int m_inputHeight = 0;
+  int m_allocatedWidth = 0;
+  int m_allocatedHeight = 0;
+  int m_pendingWidth = 0;
+  int m_pendingHeight = 0;
+  int m_passthroughRun = 0;
+};
@@ -0,0 +1,404 @@
+#include "resource_registry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+using S = PipelineStage;
+using L = ResourceLifetime;
+using F = ResourceFormat;
+using V = ResourceLevel;
+
+enum class Group : uint8_t {
+  Working,            // D3D11 textures CreateResources allocates
+  MotionCache,        // motion LRU snapshots, created on first store
+  Vulkan,             // shared and Vulkan-only images of the full pipeline
+};
+
+struct TableEntry {
+  const char* name;
+  Group group;
+  V level;
+  F format;
+  S stage;
+  ResourceUse minimal;
+  ResourceUse full;
+};
+
+constexpr ResourceUse kUnused = {};
+
+// Who writes and reads what, from the dispatches in interpolator.cpp. The
+// pyramid writes the quarter / eighth Feature2/3 levels in both pipelines;
+// only the full pipeline's quarter refinement reads them, and nothing reads
+// the eighth level.
+constexpr TableEntry kTable[] = {
+    // Luma (CNN feature channels 1-4)
+    {"prevLuma", Group::Working, V::Half, F::Rgba16Float, S::Downsample,
+     {true, S::Interpolate, L::Pair}, {true, S::Interpolate, L::Pair}},
+    {"currLuma", Group::Working, V::Half, F::Rgba16Float, S::Downsample,
+     {true, S::Interpolate, L::Pair}, {true, S::Interpolate, L::Pair}},
+    {"prevLumaSmall", Group::Working, V::Quarter, F::Rgba16Float, S::Pyramid,
+     {true, S::Pyramid, L::Transient}, {true, S::RefineQuarter, L::Transient}},
+    {"currLumaSmall", Group::Working, V::Quarter, F::Rgba16Float, S::Pyramid,
+     {true, S::Pyramid, L::Transient}, {true, S::RefineQuarter, L::Transient}},
+    {"prevLumaTiny", Group::Working, V::Eighth, F::Rgba16Float, S::Pyramid,
+     {true, S::MotionBackward, L::Transient}, {true, S::MotionBackward, L::Transient}},
+    {"currLumaTiny", Group::Working, V::Eighth, F::Rgba16Float, S::Pyramid,
+     {true, S::MotionBackward, L::Transient}, {true, S::MotionBackward, L::Transient}},
+
+    // Feature2 (channels 5-8)
+    {"prevFeature2", Group::Working, V::Half, F::Rgba16Float, S::Downsample,
+     {true, S::Interpolate, L::Pair}, {true, S::Interpolate, L::Pair}},
+    {"currFeature2", Group::Working, V::Half, F::Rgba16Float, S::Downsample,
+     {true, S::Interpolate, L::Pair}, {true, S::Interpolate, L::Pair}},
+    {"prevFeature2Small", Group::Working, V::Quarter, F::Rgba16Float, S::Pyramid,
+     kUnused, {true, S::RefineQuarter, L::Transient}},
+    {"currFeature2Small", Group::Working, V::Quarter, F::Rgba16Float, S::Pyramid,
+     kUnused, {true, S::RefineQuarter, L::Transient}},
+    {"prevFeature2Tiny", Group::Working, V::Eighth, F::Rgba16Float, S::Pyramid, kUnused, kUnused},
+    {"currFeature2Tiny", Group::Working, V::Eighth, F::Rgba16Float, S::Pyramid, kUnused, kUnused},
+
+    // Feature3 (channels 9-12; the interpolate pass reads periodicity from .w)
+    {"prevFeature3", Group::Working, V::Half, F::Rgba16Float, S::Downsample,
+     {true, S::Interpolate, L::Pair}, {true, S::Interpolate, L::Pair}},
+    {"currFeature3", Group::Working, V::Half, F::Rgba16Float, S::Downsample,
+     {true, S::Interpolate, L::Pair}, {true, S::Interpolate, L::Pair}},
+    {"prevFeature3Small", Group::Working, V::Quarter, F::Rgba16Float, S::Pyramid,
+     kUnused, {true, S::RefineQuarter, L::Transient}},
+    {"currFeature3Small", Group::Working, V::Quarter, F::Rgba16Float, S::Pyramid,
+     kUnused, {true, S::RefineQuarter, L::Transient}},
+    {"prevFeature3Tiny", Group::Working, V::Eighth, F::Rgba16Float, S::Pyramid, kUnused, kUnused},
+    {"currFeature3Tiny", Group::Working, V::Eighth, F::Rgba16Float, S::Pyramid, kUnused, kUnused},
+
+    // Motion fields. The minimal pipeline warps with the eighth-res pair.
+    {"motionTiny", Group::Working, V::Eighth, F::Rg16Float, S::MotionForward,
+     {true, S::Interpolate, L::Pair}, {true, S::RefineQuarter, L::Transient}},
+    {"confidenceTiny", Group::Working, V::Eighth, F::R16Float, S::MotionForward,
+     {true, S::Interpolate, L::Pair}, {true, S::RefineQuarter, L::Transient}},
+    {"motionTinyBackward", Group::Working, V::Eighth, F::Rg16Float, S::MotionBackward,
+     {true, S::Interpolate, L::Pair}, {true, S::RefineHalf, L::Transient}},
+    {"confidenceTinyBackward", Group::Working, V::Eighth, F::R16Float, S::MotionBackward,
+     {true, S::Interpolate, L::Pair}, {true, S::RefineHalf, L::Transient}},
+    {"motionCoarse", Group::Working, V::Quarter, F::Rg16Float, S::RefineQuarter,
+     kUnused, {true, S::RefineHalf, L::Transient}},
+    {"confidenceCoarse", Group::Working, V::Quarter, F::R16Float, S::RefineQuarter,
+     kUnused, {true, S::RefineHalf, L::Transient}},
+    {"motion", Group::Working, V::Half, F::Rg16Float, S::RefineHalf,
+     kUnused, {true, S::Smooth, L::Transient}},
+    {"confidence", Group::Working, V::Half, F::R16Float, S::RefineHalf,
+     kUnused, {true, S::Smooth, L::Transient}},
+    {"motionSmooth", Group::Working, V::Half, F::Rg16Float, S::Smooth,
+     kUnused, {true, S::Interpolate, L::Pair}},
+    {"confidenceSmooth", Group::Working, V::Half, F::R16Float, S::Smooth,
+     kUnused, {true, S::Interpolate, L::Pair}},
+
+    // Attention priors: refinement state updated in place every estimation
+    {"attnSmall1", Group::Working, V::Quarter, F::Rgba16Float, S::RefineQuarter,
+     kUnused, {true, S::RefineQuarter, L::Persistent}},
+    {"attnSmall2", Group::Working, V::Quarter, F::Rgba16Float, S::RefineQuarter,
+     kUnused, {true, S::RefineQuarter, L::Persistent}},
+    {"attnSmall3", Group::Working, V::Quarter, F::Rgba16Float, S::RefineQuarter,
+     kUnused, {true, S::RefineQuarter, L::Persistent}},
+    {"attnFull1", Group::Working, V::Half, F::Rgba16Float, S::RefineHalf,
+     kUnused, {true, S::RefineHalf, L::Persistent}},
+    {"attnFull2", Group::Working, V::Half, F::Rgba16Float, S::RefineHalf,
+     kUnused, {true, S::RefineHalf, L::Persistent}},
+    {"attnFull3", Group::Working, V::Half, F::Rgba16Float, S::RefineHalf,
+     kUnused, {true, S::RefineHalf, L::Persistent}},
+
+    {"outputTexture", Group::Working, V::Output, F::Bgra8Unorm, S::Interpolate,
+     {true, S::Interpolate, L::Persistent}, {true, S::Interpolate, L::Persistent}},
+
+    // Motion LRU snapshots hold the fields the active pipeline warps with
+    {"motionSet.motionTiny", Group::MotionCache, V::Eighth, F::Rg16Float, S::Execute,
+     {true, S::Interpolate, L::Persistent}, kUnused},
+    {"motionSet.confidenceTiny", Group::MotionCache, V::Eighth, F::R16Float, S::Execute,
+     {true, S::Interpolate, L::Persistent}, kUnused},
+    {"motionSet.motionTinyBackward", Group::MotionCache, V::Eighth, F::Rg16Float, S::Execute,
+     {true, S::Interpolate, L::Persistent}, kUnused},
+    {"motionSet.confidenceTinyBackward", Group::MotionCache, V::Eighth, F::R16Float, S::Execute,
+     {true, S::Interpolate, L::Persistent}, kUnused},
+    {"motionSet.motionSmooth", Group::MotionCache, V::Half, F::Rg16Float, S::Execute,
+     kUnused, {true, S::Interpolate, L::Persistent}},
+    {"motionSet.confidenceSmooth", Group::MotionCache, V::Half, F::R16Float, S::Execute,
+     kUnused, {true, S::Interpolate, L::Persistent}},
+
+    // Vulkan: D3D11 shared textures imported as VkImages, then Vulkan-only
+    // intermediates of the PWC-style path
+    {"vk.sharedPrev", Group::Vulkan, V::Input, F::Bgra8Unorm, S::VkCopyIn,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.sharedCurr", Group::Vulkan, V::Input, F::Bgra8Unorm, S::VkCopyIn,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.sharedMotion", Group::Vulkan, V::Half, F::Rg16Float, S::VkCopyIn,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.sharedConf", Group::Vulkan, V::Half, F::R16Float, S::VkCopyIn,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.sharedFeatPrev", Group::Vulkan, V::Half, F::Rgba16Float, S::VkCopyIn,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.sharedFeatCurr", Group::Vulkan, V::Half, F::Rgba16Float, S::VkCopyIn,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.sharedOutput", Group::Vulkan, V::Output, F::Bgra8Unorm, S::VkInterpolate,
+     kUnused, {true, S::VkInterpolate, L::Persistent}},
+    // features also feed the flow decoder and the re-warp's interpolate set
+    {"vk.featPrev", Group::Vulkan, V::Half, F::Rgba16Float, S::VkDownsample,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.featCurr", Group::Vulkan, V::Half, F::Rgba16Float, S::VkDownsample,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.costVol", Group::Vulkan, V::Half, F::Rgba16Float, S::VkCostVolume,
+     kUnused, {true, S::VkFlowDecoder, L::Transient}},
+    {"vk.flowOut", Group::Vulkan, V::Half, F::Rg16Float, S::VkFlowDecoder,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+    {"vk.confOut", Group::Vulkan, V::Half, F::R16Float, S::VkFlowDecoder,
+     kUnused, {true, S::VkInterpolate, L::Pair}},
+};
+
+const TableEntry* FindEntry(const std::string& name) {
+  const size_t length = std::min(name.find('#'), name.size());
+  for (const TableEntry& entry : kTable) {
+    if (name.compare(0, length, entry.name) == 0 && std::strlen(entry.name) == length) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+double MiB(uint64_t bytes) {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+}  // namespace
+
+const char* ResourceFormatName(ResourceFormat format) {
+  switch (format) {
+    case ResourceFormat::Rgba16Float:
+      return "RGBA16F";
+    case ResourceFormat::Rg16Float:
+      return "RG16F";
+    case ResourceFormat::R16Float:
+      return "R16F";
+    case ResourceFormat::Bgra8Unorm:
+      return "BGRA8";
+    case ResourceFormat::Rg32Float:
+      return "RG32F";
+    case ResourceFormat::R32Float:
+      return "R32F";
+    case ResourceFormat::Count:
+      break;
+  }
+  return "Unknown";
+}
+
+uint32_t ResourceFormatBytes(ResourceFormat format) {
+  switch (format) {
+    case ResourceFormat::Rgba16Float:
+    case ResourceFormat::Rg32Float:
+      return 8;
+    case ResourceFormat::Rg16Float:
+    case ResourceFormat::Bgra8Unorm:
+    case ResourceFormat::R32Float:
+      return 4;
+    case ResourceFormat::R16Float:
+      return 2;
+    case ResourceFormat::Count:
+      break;
+  }
+  return 0;
+}
+
+const char* ResourceLevelName(ResourceLevel level) {
+  switch (level) {
+    case ResourceLevel::Input:
+      return "input";
+    case ResourceLevel::Output:
+      return "output";
+    case ResourceLevel::Half:
+      return "1/2";
+    case ResourceLevel::Quarter:
+      return "1/4";
+    case ResourceLevel::Eighth:
+      return "1/8";
+  }
+  return "?";
+}
+
+const char* ResourceLifetimeName(ResourceLifetime lifetime) {
+  switch (lifetime) {
+    case ResourceLifetime::Transient:
+      return "transient";
+    case ResourceLifetime::Pair:
+      return "pair";
+    case ResourceLifetime::Persistent:
+      return "persistent";
+  }
+  return "?";
+}
+
+// ----------------------------------------------------------------------------
+// ResourceRegistry
+// ----------------------------------------------------------------------------
+void ResourceRegistry::Clear() {
+  m_records.clear();
+  m_totalBytes = 0;
+}
+
+void ResourceRegistry::Track(const std::string& name, int width, int height, ResourceFormat format,
+                             uint64_t bytes) {
+  Release(name);
+  ResourceRecord record;
+  record.name = name;
+  record.format = format;
+  record.width = width;
+  record.height = height;
+  record.bytes = bytes != 0 ? bytes
+                            : static_cast<uint64_t>(std::max(width, 0)) * static_cast<uint64_t>(std::max(height, 0)) *
+                                  ResourceFormatBytes(format);
+  if (const TableEntry* entry = FindEntry(name)) {
+    record.level = entry->level;
+    record.stage = entry->stage;
+    record.minimal = entry->minimal;
+    record.full = entry->full;
+  } else {
+    // Not in the table: counted under Execute, read by both pipelines, so
+    // an unknown allocation is never reported as waste.
+    record.minimal = {true, PipelineStage::Execute, ResourceLifetime::Persistent};
+    record.full = record.minimal;
+  }
+  m_totalBytes += record.bytes;
+  m_records.push_back(std::move(record));
+}
+
+void ResourceRegistry::Release(const std::string& name) {
+  for (auto it = m_records.begin(); it != m_records.end(); ++it) {
+    if (it->name == name) {
+      m_totalBytes -= it->bytes;
+      m_records.erase(it);
+      return;
+    }
+  }
+}
+
+void ResourceRegistry::ReleaseGroup(const std::string& prefix) {
+  auto it = std::remove_if(m_records.begin(), m_records.end(), [&](const ResourceRecord& record) {
+    return record.name.compare(0, prefix.size(), prefix) == 0;
+  });
+  for (auto released = it; released != m_records.end(); ++released) {
+    m_totalBytes -= released->bytes;
+  }
+  m_records.erase(it, m_records.end());
+}
+
+ResourceFootprint ResourceRegistry::Footprint() const {
+  ResourceFootprint footprint;
+  for (const ResourceRecord& record : m_records) {
+    const ResourceUse& use = record.Use(m_minimal);
+    ++footprint.resources;
+    footprint.totalBytes += record.bytes;
+    footprint.stageBytes[static_cast<int>(record.stage)] += record.bytes;
+    if (!use.read) {
+      ++footprint.unusedResources;
+      footprint.unusedBytes += record.bytes;
+    } else if (use.lifetime == ResourceLifetime::Transient) {
+      footprint.transientBytes += record.bytes;
+    }
+  }
+  return footprint;
+}
+
+// ----------------------------------------------------------------------------
+// Planning and reports
+// ----------------------------------------------------------------------------
+void InterpolatorLevelSize(ResourceLevel level, int inputWidth, int inputHeight, int outputWidth, int outputHeight,
+                           int& width, int& height) {
+  const int halfWidth = (inputWidth + 1) / 2;
+  const int halfHeight = (inputHeight + 1) / 2;
+  const int quarterWidth = std::max(1, (halfWidth + 1) / 2);
+  const int quarterHeight = std::max(1, (halfHeight + 1) / 2);
+  switch (level) {
+    case ResourceLevel::Input:
+      width = inputWidth;
+      height = inputHeight;
+      return;
+    case ResourceLevel::Output:
+      width = outputWidth;
+      height = outputHeight;
+      return;
+    case ResourceLevel::Half:
+      width = halfWidth;
+      height = halfHeight;
+      return;
+    case ResourceLevel::Quarter:
+      width = quarterWidth;
+      height = quarterHeight;
+      return;
+    case ResourceLevel::Eighth:
+      width = std::max(1, (quarterWidth + 1) / 2);
+      height = std::max(1, (quarterHeight + 1) / 2);
+      return;
+  }
+  width = 0;
+  height = 0;
+}
+
+void PlanInterpolatorResources(int inputWidth, int inputHeight, int outputWidth, int outputHeight,
+                               bool minimalPipeline, bool vulkan, int motionCacheSlots,
+                               ResourceRegistry& registry) {
+  registry.Clear();
+  registry.SetMinimalPipeline(minimalPipeline);
+  for (const TableEntry& entry : kTable) {
+    int width = 0;
+    int height = 0;
+    InterpolatorLevelSize(entry.level, inputWidth, inputHeight, outputWidth, outputHeight, width, height);
+    switch (entry.group) {
+      case Group::Working:
+        registry.Track(entry.name, width, height, entry.format);
+        break;
+      case Group::MotionCache:
+        if ((minimalPipeline ? entry.minimal : entry.full).read) {
+          for (int slot = 0; slot < motionCacheSlots; ++slot) {
+            registry.Track(std::string(entry.name) + "#" + std::to_string(slot), width, height, entry.format);
+          }
+        }
+        break;
+      case Group::Vulkan:
+        if (vulkan) {
+          registry.Track(entry.name, width, height, entry.format);
+        }
+        break;
+    }
+  }
+}
+
+std::string FormatResourceReport(const ResourceRegistry& registry) {
+  const ResourceFootprint footprint = registry.Footprint();
+  const bool minimal = registry.MinimalPipeline();
+  std::string out;
+  char line[256];
+  std::snprintf(line, sizeof(line),
+                "%s pipeline: %d textures, %.2f MiB (%d unused, %.2f MiB; transient %.2f MiB)\n",
+                minimal ? "Minimal" : "Full", footprint.resources, MiB(footprint.totalBytes),
+                footprint.unusedResources, MiB(footprint.unusedBytes), MiB(footprint.transientBytes));
+  out += line;
+  for (int i = 0; i < kPipelineStageCount; ++i) {
+    if (footprint.stageBytes[i] == 0) {
+      continue;
+    }
+    std::snprintf(line, sizeof(line), "  %-16s %9.2f MiB\n", PipelineStageName(static_cast<PipelineStage>(i)),
+                  MiB(footprint.stageBytes[i]));
+    out += line;
+  }
+  std::snprintf(line, sizeof(line), "  %-34s %-6s %-8s %11s %9s  %-15s %-15s %s\n", "texture", "level", "format",
+                "size", "MiB", "writer", "last read", "lifetime");
+  out += line;
+  for (const ResourceRecord& record : registry.Records()) {
+    const ResourceUse& use = record.Use(minimal);
+    const std::string size = std::to_string(record.width) + "x" + std::to_string(record.height);
+    std::snprintf(line, sizeof(line), "  %-34s %-6s %-8s %11s %9.2f  %-15s %-15s %s\n", record.name.c_str(),
+                  ResourceLevelName(record.level), ResourceFormatName(record.format), size.c_str(), MiB(record.bytes),
+                  PipelineStageName(record.stage), use.read ? PipelineStageName(use.lastUse) : "-",
+                  use.read ? ResourceLifetimeName(use.lifetime) : "UNUSED");
+    out += line;
+  }
+  return out;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "stage_timer.h"
+
+// GPU memory accounting for the interpolator.
+//
+// Every texture the Interpolator allocates is recorded by name together with
+// its format, size, the pipeline stage that writes it, the last stage that
+// reads it and how long its contents have to survive. What each texture is
+// for is described once, in the table in resource_registry.cpp; the live
+// registry the Interpolator fills while allocating and
+// PlanInterpolatorResources, which predicts the footprint of a resolution
+// without a device, both read it.
+//
+// Reads differ between the minimal and the full motion pipeline, so usage
+// and lifetime are kept per pipeline. Both pipelines allocate the same
+// textures; those the active one never reads are reported as unused.
+//
+// Byte counts are width * height * texel size. Drivers add alignment and
+// padding on top, so totals are a lower bound of what the GPU reports.
+
+enum class ResourceFormat : uint8_t {
+  Rgba16Float,
+  Rg16Float,
+  R16Float,
+  Bgra8Unorm,
+  Rg32Float,          // CPU reference planes
+  R32Float,
+  Count,
+};
+
+const char* ResourceFormatName(ResourceFormat format);
+uint32_t ResourceFormatBytes(ResourceFormat format);
+
+// Size class of a texture, relative to the interpolator's input.
+enum class ResourceLevel : uint8_t {
+  Input,
+  Output,
+  Half,               // luma / feature resolution
+  Quarter,
+  Eighth,
+};
+
+const char* ResourceLevelName(ResourceLevel level);
+
+enum class ResourceLifetime : uint8_t {
+  Transient,          // written and read within one motion estimation
+  Pair,               // kept until the next estimation; re-warps read it
+  Persistent,         // state carried across pairs
+};
+
+const char* ResourceLifetimeName(ResourceLifetime lifetime);
+
+// How one pipeline uses a texture.
+struct ResourceUse {
+  bool read = false;                                  // some stage reads it
+  PipelineStage lastUse = PipelineStage::Execute;     // last reader in a generation
+  ResourceLifetime lifetime = ResourceLifetime::Transient;
+};
+
+struct ResourceRecord {
+  std::string name;
+  ResourceFormat format = ResourceFormat::Rgba16Float;
+  ResourceLevel level = ResourceLevel::Half;
+  int width = 0;
+  int height = 0;
+  uint64_t bytes = 0;
+  PipelineStage stage = PipelineStage::Execute;       // writer
+  ResourceUse minimal;
+  ResourceUse full;
+
+  const ResourceUse& Use(bool minimalPipeline) const { return minimalPipeline ? minimal : full; }
+};
+
+struct ResourceFootprint {
+  int resources = 0;
+  int unusedResources = 0;
+  uint64_t totalBytes = 0;
+  uint64_t unusedBytes = 0;         // allocated, never read by the active pipeline
+  uint64_t transientBytes = 0;      // used, dead after one estimation
+  std::array<uint64_t, kPipelineStageCount> stageBytes = {};   // by writing stage
+};
+
+class ResourceRegistry {
+public:
+  void Clear();
+
+  // Records an allocation. Stage, usage and lifetime come from the
+  // interpolator table; a "#n" suffix (motion cache slots) is ignored for
+  // the lookup. bytes = 0 estimates from the size and format. A name
+  // tracked again replaces its earlier record.
+  void Track(const std::string& name, int width, int height, ResourceFormat format, uint64_t bytes = 0);
+  void Release(const std::string& name);
+  // Releases every record whose name starts with prefix.
+  void ReleaseGroup(const std::string& prefix);
+
+  void SetMinimalPipeline(bool minimal) { m_minimal = minimal; }
+  bool MinimalPipeline() const { return m_minimal; }
+
+  const std::vector<ResourceRecord>& Records() const { return m_records; }
+  uint64_t TotalBytes() const { return m_totalBytes; }
+  ResourceFootprint Footprint() const;
+
+private:
+  std::vector<ResourceRecord> m_records;
+  uint64_t m_totalBytes = 0;
+  bool m_minimal = true;
+};
+
+// Texture size of a level, rounded the way Interpolator::Resize rounds.
+void InterpolatorLevelSize(ResourceLevel level, int inputWidth, int inputHeight, int outputWidth, int outputHeight,
+                           int& width, int& height);
+
+// Everything the Interpolator allocates for these sizes: the D3D11 working
+// set, the motion cache snapshots of the active pipeline, and with vulkan the
+// shared and Vulkan-only images of the full pipeline.
+void PlanInterpolatorResources(int inputWidth, int inputHeight, int outputWidth, int outputHeight,
+                               bool minimalPipeline, bool vulkan, int motionCacheSlots,
+                               ResourceRegistry& registry);
+
+// Totals, bytes per writing stage, then one line per texture.
+std::string FormatResourceReport(const ResourceRegistry& registry);
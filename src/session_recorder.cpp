@@ -0,0 +1,161 @@
+#include "session_recorder.h"
+
+#include "deadline_wait.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool SessionRecorder::Start(const std::string& path, const SessionRecorderConfig& config) {
+  Stop();
+  if (!m_writer.Open(path)) {
+    return false;
+  }
+  m_writer.SetCompression(config.compress ? FrameStreamCompression::Lz4 : FrameStreamCompression::None);
+  m_path = path;
+  m_slots.assign(static_cast<size_t>(std::max(config.queueFrames, 1)), Slot());
+  m_free.clear();
+  for (int i = static_cast<int>(m_slots.size()) - 1; i >= 0; --i) {
+    m_free.push_back(i);
+  }
+  m_pending.clear();
+  m_stopping = false;
+  m_nextTicket = 0;
+  m_released.store(0, std::memory_order_release);
+  m_stats = SessionRecorderStats();
+  m_thread = std::thread(&SessionRecorder::WriterLoop, this);
+  return true;
+}
+
+void SessionRecorder::Stop() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_cv.notify_one();
+  m_thread.join();
+  m_writer.Close();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.fileBytes = m_writer.Bytes();
+  m_released.store(m_nextTicket, std::memory_order_release);
+}
+
+int SessionRecorder::AcquireSlot() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stats.submitted++;
+  if (m_free.empty()) {
+    m_stats.dropped++;
+    return -1;
+  }
+  const int slotIndex = m_free.back();
+  m_free.pop_back();
+  return slotIndex;
+}
+
+void SessionRecorder::QueueSlot(int slotIndex, double submitStart) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back(slotIndex);
+    m_stats.queued = static_cast<int>(m_pending.size());
+    m_stats.maxQueued = std::max(m_stats.maxQueued, m_stats.queued);
+    const double elapsed = DeadlineWaiter::Now() - submitStart;
+    m_stats.submitSec += elapsed;
+    m_stats.maxSubmitMs = std::max(m_stats.maxSubmitMs, elapsed * 1000.0);
+  }
+  m_cv.notify_one();
+}
+
+bool SessionRecorder::Submit(const CpuFrame& frame) {
+  if (!m_thread.joinable() || !frame.data || frame.width <= 0 || frame.height <= 0) {
+    return false;
+  }
+  const double start = DeadlineWaiter::Now();
+  const int slotIndex = AcquireSlot();
+  if (slotIndex < 0) {
+    return false;
+  }
+
+  // The slot belongs to this thread until it is queued. Buffers only grow,
+  // so after the first few frames this is a plain copy.
+  Slot& slot = m_slots[slotIndex];
+  const size_t rowBytes = static_cast<size_t>(frame.width) * PixelFormatBytes(frame.format);
+  slot.pixels.resize(rowBytes * frame.height);
+  if (frame.pitch == rowBytes) {
+    std::memcpy(slot.pixels.data(), frame.data, slot.pixels.size());
+  } else {
+    for (int y = 0; y < frame.height; ++y) {
+      std::memcpy(slot.pixels.data() + rowBytes * y, frame.data + frame.pitch * y, rowBytes);
+    }
+  }
+  slot.frame = frame;
+  slot.frame.data = slot.pixels.data();
+  slot.frame.pitch = rowBytes;
+  slot.frame.dirtyRects.clear();
+  slot.ticket = 0;
+  QueueSlot(slotIndex, start);
+  return true;
+}
+
+uint64_t SessionRecorder::SubmitLent(const CpuFrame& frame) {
+  if (!m_thread.joinable() || !frame.data || frame.width <= 0 || frame.height <= 0) {
+    return 0;
+  }
+  const double start = DeadlineWaiter::Now();
+  const int slotIndex = AcquireSlot();
+  if (slotIndex < 0) {
+    return 0;
+  }
+
+  // Only the description is stored; the writer packs and writes the
+  // caller's rows directly.
+  Slot& slot = m_slots[slotIndex];
+  slot.frame = frame;
+  slot.frame.dirtyRects.clear();
+  slot.ticket = ++m_nextTicket;
+  const uint64_t ticket = slot.ticket;
+  QueueSlot(slotIndex, start);
+  return ticket;
+}
+
+void SessionRecorder::WriterLoop() {
+  while (true) {
+    int slotIndex = -1;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+      if (m_pending.empty()) {
+        return;  // stopping and drained
+      }
+      slotIndex = m_pending.front();
+    }
+
+    const Slot& slot = m_slots[slotIndex];
+    const double start = DeadlineWaiter::Now();
+    const bool ok = m_writer.Write(slot.frame);
+    const double elapsed = DeadlineWaiter::Now() - start;
+    if (slot.ticket != 0) {
+      m_released.store(slot.ticket, std::memory_order_release);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.pop_front();
+    m_free.push_back(slotIndex);
+    m_stats.queued = static_cast<int>(m_pending.size());
+    m_stats.writeSec += elapsed;
+    if (ok) {
+      m_stats.written++;
+      m_stats.rawBytes += static_cast<uint64_t>(slot.frame.width) * PixelFormatBytes(slot.frame.format) *
+                          slot.frame.height;
+    } else {
+      m_stats.failed++;
+    }
+    m_stats.fileBytes = m_writer.Bytes();
+  }
+}
+
+SessionRecorderStats SessionRecorder::Stats() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "cpu_frame.h"
+#include "frame_stream.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records captured frames to a frame stream file without stalling capture.
+//
+// A frame takes one of a fixed number of slots; a writer thread compresses
+// (optionally) and writes slots in order. When every slot is waiting on the
+// disk the frame is dropped and counted rather than blocking the capture
+// thread, so a slow disk shows up as drops in the stats instead of as
+// capture hitches.
+//
+// Submit copies the pixels into the slot on the calling thread. SubmitLent
+// only queues the frame: its pixels (a mapped staging texture, say) stay
+// with the caller until Released() passes the returned ticket, and every
+// byte is read on the writer thread.
+
+struct SessionRecorderConfig {
+  int queueFrames = 8;          // slots between capture and the writer
+  bool compress = false;        // LZ4 per frame
+};
+
+struct SessionRecorderStats {
+  uint64_t submitted = 0;
+  uint64_t written = 0;
+  uint64_t dropped = 0;         // queue full at Submit / SubmitLent
+  uint64_t failed = 0;          // write errors
+  uint64_t rawBytes = 0;
+  uint64_t fileBytes = 0;
+  double writeSec = 0.0;        // writer thread time, compression included
+  double submitSec = 0.0;       // capture thread time in queued submits
+  double maxSubmitMs = 0.0;
+  int queued = 0;
+  int maxQueued = 0;
+};
+
+class SessionRecorder {
+public:
+  ~SessionRecorder() { Stop(); }
+
+  bool Start(const std::string& path, const SessionRecorderConfig& config = SessionRecorderConfig());
+  // Writes everything still queued, then the index.
+  void Stop();
+  bool IsRecording() const { return m_thread.joinable(); }
+
+  // Capture thread. Returns false when the frame was dropped.
+  bool Submit(const CpuFrame& frame);
+  // Capture thread, no copy. Returns the frame's ticket, or 0 when it was
+  // dropped (the pixels are not referenced then).
+  uint64_t SubmitLent(const CpuFrame& frame);
+  // Lent frames are handed back in submission order: the pixels of every
+  // ticket <= Released() are no longer read. Stop releases everything.
+  uint64_t Released() const { return m_released.load(std::memory_order_acquire); }
+
+  SessionRecorderStats Stats() const;
+  const std::string& Path() const { return m_path; }
+
+private:
+  struct Slot {
+    std::vector<uint8_t> pixels;
+    CpuFrame frame;
+    uint64_t ticket = 0;        // lent frame, 0 = pixels owned by the slot
+  };
+
+  // Takes a free slot, or counts a drop and returns -1.
+  int AcquireSlot();
+  void QueueSlot(int slotIndex, double submitStart);
+  void WriterLoop();
+
+  FrameStreamWriter m_writer;
+  std::string m_path;
+  std::vector<Slot> m_slots;
+  std::vector<int> m_free;
+  std::deque<int> m_pending;
+  bool m_stopping = false;
+  uint64_t m_nextTicket = 0;
+  std::atomic<uint64_t> m_released{0};
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::thread m_thread;
+  SessionRecorderStats m_stats;
+};
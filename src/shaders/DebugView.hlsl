@@ -15,6 +15,8 @@ cbuffer DebugCB : register(b0) {
     float motionScale;
     float diffScale;
     float pad;
+    float2 motionUvScale;      // viewport / allocation of the motion field
+    float2 pad2;
 };
 
 // ============================================================================
@@ -65,14 +67,15 @@ void CSMain(uint3 id : SV_DispatchThreadID)
 
     float2 outSize = float2(outW, outH);
     float2 inSize  = float2(inW, inH);
-    float2 mvSize  = float2(mvW, mvH);
+    // Texels of the motion field that hold the frame.
+    float2 mvSize  = float2(mvW, mvH) * motionUvScale;
 
     float2 uv = (float2(id.xy) + 0.5) / outSize;
 
     float4 curr = CurrColor.SampleLevel(LinearClamp, uv, 0);
     float4 prev = PrevColor.SampleLevel(LinearClamp, uv, 0);
-    float2 mv   = Motion.SampleLevel(LinearClamp, uv, 0) * (inSize / mvSize);
-    float  conf = Confidence.SampleLevel(LinearClamp, uv, 0);
+    float2 mv   = Motion.SampleLevel(LinearClamp, uv * motionUvScale, 0) * (inSize / mvSize);
+    float  conf = Confidence.SampleLevel(LinearClamp, uv * motionUvScale, 0);
 
     float3 finalColor = curr.rgb;
 
@@ -104,7 +107,7 @@ void CSMain(uint3 id : SV_DispatchThreadID)
         float spacing = 32.0;
         float2 gridCenter = (floor(float2(id.xy) / spacing) + 0.5) * spacing;
         float2 gridUV = gridCenter / outSize;
-        float2 gridMV = Motion.SampleLevel(LinearClamp, gridUV, 0) * (inSize / mvSize);
+        float2 gridMV = Motion.SampleLevel(LinearClamp, gridUV * motionUvScale, 0) * (inSize / mvSize);
         float mag = length(gridMV);
 
         if (mag > 0.5) {
@@ -119,7 +122,7 @@ void CSMain(uint3 id : SV_DispatchThreadID)
                            LineSDF(float2(id.xy), arrowEnd, headR));
             float alpha2 = 1.0 - smoothstep(0.5, 1.5, d2);
 
-            float gridConf = Confidence.SampleLevel(LinearClamp, gridUV, 0);
+            float gridConf = Confidence.SampleLevel(LinearClamp, gridUV * motionUvScale, 0);
             float3 arrowColor = float3(0, 1, 0);
             if (gridConf < 0.4 || mag > 100.0) arrowColor = float3(1, 0, 0);
             else if (gridConf < 0.7) arrowColor = float3(1, 1, 0);
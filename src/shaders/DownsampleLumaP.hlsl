@@ -0,0 +1,46 @@
+// ============================================================================
+// DOWNSAMPLE LUMA P - feature extraction from a producer luma plane
+// Same features as DownsampleLuma.hlsl, but the half-res 2x2 luma comes
+// ready-made from the capture producer (R16_UNORM, width/2 x height/2), so
+// the full-resolution color frame is never read. The plane holds the same
+// BT.709 block mean as GetAvgLuma in DownsampleLuma.hlsl (fixed-point
+// weights, well below 8-bit precision), so the even-offset samples match.
+// ComputePeriodicityWHT also samples odd offsets, which the plane can only
+// approximate (see GetAvgLuma below); the interpolator keeps both frames of
+// a pair on one path and keys cached motion by it.
+// ============================================================================
+
+Texture2D<float> LumaSrc : register(t0);
+
+// maxPos is twice the bucketed half-res allocation (LumaOut), not the color
+// frame's size; the plane is addressed by halving positions and clamped to
+// its own extent. Odd positions straddle two plane texels, so the
+// 2x2 block there is approximated by the mean of the (up to) four texels it
+// overlaps, a 4x4 box instead of the color path's 2x2.
+float GetAvgLuma(int2 base, int2 maxPos) {
+    uint planeW, planeH;
+    LumaSrc.GetDimensions(planeW, planeH);
+    int2 maxPlane = int2(planeW - 1, planeH - 1);
+    base = clamp(base, int2(0, 0), maxPos);
+    int2 p0 = min(base >> 1, maxPlane);
+    int2 p1 = min((base + 1) >> 1, maxPlane);
+    if (all(p0 == p1)) {
+        return LumaSrc.Load(int3(p0, 0));
+    }
+    return (LumaSrc.Load(int3(p0.x, p0.y, 0)) + LumaSrc.Load(int3(p1.x, p0.y, 0)) +
+            LumaSrc.Load(int3(p0.x, p1.y, 0)) + LumaSrc.Load(int3(p1.x, p1.y, 0))) * 0.25;
+}
+
+#include "LumaFeatures.hlsli"
+
+[numthreads(16, 16, 1)]
+void CSMain(uint3 id : SV_DispatchThreadID)
+{
+    uint outW, outH;
+    LumaOut.GetDimensions(outW, outH);
+    if (id.x >= outW || id.y >= outH) return;
+
+    // The features are defined on the color frame's grid, which is twice
+    // the output (half-res) size.
+    ExtractFeatures(id.xy, int2(id.xy * 2), int2(outW * 2 - 1, outH * 2 - 1));
+}
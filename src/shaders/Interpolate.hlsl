@@ -34,7 +34,8 @@ cbuffer InterpCB : register(b0) {
     float _reserved2;
     float _reserved3;
     float motionSampleScale;
-    float3 pad;
+    float2 motionUvScale;      // viewport / allocation of the working set
+    float pad;
 };
 
 // ============================================================================
@@ -110,6 +111,10 @@ static const float3 kLumaWeights = float3(0.2126, 0.7152, 0.0722);
 
 float Luma(float3 c) { return dot(c, kLumaWeights); }
 
+// Motion and feature textures are allocated in size buckets and hold the
+// frame in their top-left corner: input UV -> working-set UV.
+float2 WorkUv(float2 uv) { return saturate(uv) * motionUvScale; }
+
 // -----------------------------------------------------------------------
 // Catmull-Rom bicubic sampling (4-tap separable via bilinear trick)
 // -----------------------------------------------------------------------
@@ -169,8 +174,8 @@ void CSMain(uint3 id : SV_DispatchThreadID)
     // 1. READ & SMOOTH MOTION VECTORS
     // =====================================================================
     float3 currDirect = CurrColor.SampleLevel(LinearClamp, inputUv, 0).rgb;
-    float2 rawMV   = Motion.SampleLevel(LinearClamp, inputUv, 0).xy * motionSampleScale;
-    float  rawConf = saturate(pow(max(Confidence.SampleLevel(LinearClamp, inputUv, 0), 0.0), confPower));
+    float2 rawMV   = Motion.SampleLevel(LinearClamp, WorkUv(inputUv), 0).xy * motionSampleScale;
+    float  rawConf = saturate(pow(max(Confidence.SampleLevel(LinearClamp, WorkUv(inputUv), 0), 0.0), confPower));
 
     // Detect coarse MV field - detect both tiny (8x) and small (4x) resolution
     // For minimal pipeline: small (1/4) = scale 4, tiny (1/8) = scale 8
@@ -184,7 +189,8 @@ void CSMain(uint3 id : SV_DispatchThreadID)
     if (coarseFlag > 0.01) {
         uint mvW, mvH;
         Motion.GetDimensions(mvW, mvH);
-        float2 mvTexel = 1.0 / float2(max(mvW, 1u), max(mvH, 1u));
+        // One motion texel in input UV.
+        float2 mvTexel = 1.0 / (float2(max(mvW, 1u), max(mvH, 1u)) * motionUvScale);
 
         float centerLuma = Luma(currDirect);
 
@@ -200,8 +206,8 @@ void CSMain(uint3 id : SV_DispatchThreadID)
 
         [unroll] for (int i = 0; i < 8; ++i) {
             float2 sampleUv = clamp(inputUv + kOff9[i] * mvTexel, 0.0, 0.999);
-            float2 nMV   = Motion.SampleLevel(LinearClamp, sampleUv, 0).xy * motionSampleScale;
-            float  nConf = saturate(Confidence.SampleLevel(LinearClamp, sampleUv, 0));
+            float2 nMV   = Motion.SampleLevel(LinearClamp, WorkUv(sampleUv), 0).xy * motionSampleScale;
+            float  nConf = saturate(Confidence.SampleLevel(LinearClamp, WorkUv(sampleUv), 0));
 
             // Spatial weight (diagonals weaker)
             float spatialW = (abs(kOff9[i].x) + abs(kOff9[i].y) > 1.5) ? 0.5 : 1.0;
@@ -238,12 +244,12 @@ void CSMain(uint3 id : SV_DispatchThreadID)
     // First, evaluate how well the current center vector (fwdMV) aligns the features.
     float2 pPrevCenter = inputPos + fwdMV * alpha;
     float2 pCurrCenter = inputPos - fwdMV * (1.0 - alpha);
-    float4 fPrevCenter = PrevFeature.SampleLevel(LinearClamp, pPrevCenter / inSize, 0);
-    float4 fCurrCenter = CurrFeature.SampleLevel(LinearClamp, pCurrCenter / inSize, 0);
-    float4 fPrevCenter2 = PrevFeature2.SampleLevel(LinearClamp, pPrevCenter / inSize, 0);
-    float4 fCurrCenter2 = CurrFeature2.SampleLevel(LinearClamp, pCurrCenter / inSize, 0);
-    float4 fPrevCenter3 = PrevFeature3.SampleLevel(LinearClamp, pPrevCenter / inSize, 0);
-    float4 fCurrCenter3 = CurrFeature3.SampleLevel(LinearClamp, pCurrCenter / inSize, 0);
+    float4 fPrevCenter = PrevFeature.SampleLevel(LinearClamp, WorkUv(pPrevCenter / inSize), 0);
+    float4 fCurrCenter = CurrFeature.SampleLevel(LinearClamp, WorkUv(pCurrCenter / inSize), 0);
+    float4 fPrevCenter2 = PrevFeature2.SampleLevel(LinearClamp, WorkUv(pPrevCenter / inSize), 0);
+    float4 fCurrCenter2 = CurrFeature2.SampleLevel(LinearClamp, WorkUv(pCurrCenter / inSize), 0);
+    float4 fPrevCenter3 = PrevFeature3.SampleLevel(LinearClamp, WorkUv(pPrevCenter / inSize), 0);
+    float4 fCurrCenter3 = CurrFeature3.SampleLevel(LinearClamp, WorkUv(pCurrCenter / inSize), 0);
     
     float4 diffCenter = abs(fPrevCenter - fCurrCenter);
     float4 diffCenter2 = abs(fPrevCenter2 - fCurrCenter2);
@@ -278,7 +284,7 @@ void CSMain(uint3 id : SV_DispatchThreadID)
         float2(0.02, 0), float2(-0.02, 0), float2(0, 0.02), float2(0, -0.02)
     };
     [unroll] for (int c = 0; c < 4; ++c) {
-        float2 nMV = Motion.SampleLevel(LinearClamp, clamp(inputUv + kCardinal[c], 0.0, 0.999), 0).xy * motionSampleScale;
+        float2 nMV = Motion.SampleLevel(LinearClamp, WorkUv(clamp(inputUv + kCardinal[c], 0.0, 0.999)), 0).xy * motionSampleScale;
         float nLen = length(nMV);
         maxLen = max(maxLen, nLen);
         // Accumulate for zero-MV inheritance (weighted by magnitude)
@@ -293,12 +299,12 @@ void CSMain(uint3 id : SV_DispatchThreadID)
         // Evaluate inherited MV quality
         float2 iPrev = inputPos + inheritedMV * alpha;
         float2 iCurr = inputPos - inheritedMV * (1.0 - alpha);
-        float4 fIP = PrevFeature.SampleLevel(LinearClamp, iPrev / inSize, 0);
-        float4 fIC = CurrFeature.SampleLevel(LinearClamp, iCurr / inSize, 0);
-        float4 fIP2 = PrevFeature2.SampleLevel(LinearClamp, iPrev / inSize, 0);
-        float4 fIC2 = CurrFeature2.SampleLevel(LinearClamp, iCurr / inSize, 0);
-        float4 fIP3 = PrevFeature3.SampleLevel(LinearClamp, iPrev / inSize, 0);
-        float4 fIC3 = CurrFeature3.SampleLevel(LinearClamp, iCurr / inSize, 0);
+        float4 fIP = PrevFeature.SampleLevel(LinearClamp, WorkUv(iPrev / inSize), 0);
+        float4 fIC = CurrFeature.SampleLevel(LinearClamp, WorkUv(iCurr / inSize), 0);
+        float4 fIP2 = PrevFeature2.SampleLevel(LinearClamp, WorkUv(iPrev / inSize), 0);
+        float4 fIC2 = CurrFeature2.SampleLevel(LinearClamp, WorkUv(iCurr / inSize), 0);
+        float4 fIP3 = PrevFeature3.SampleLevel(LinearClamp, WorkUv(iPrev / inSize), 0);
+        float4 fIC3 = CurrFeature3.SampleLevel(LinearClamp, WorkUv(iCurr / inSize), 0);
         float iError = dot(abs(fIP - fIC), w1) + dot(abs(fIP2 - fIC2), w2) + dot(abs(fIP3 - fIC3), w3);
         iError += length(inheritedMV) * 0.002;
         if (iError < minError) {
@@ -316,11 +322,11 @@ void CSMain(uint3 id : SV_DispatchThreadID)
     };
     
     // Periodicity detection (read once outside loop)
-    float periodicity = CurrFeature3.SampleLevel(LinearClamp, inputUv, 0).w;
+    float periodicity = CurrFeature3.SampleLevel(LinearClamp, WorkUv(inputUv), 0).w;
     
     [unroll] for (int j = 0; j < 8; ++j) {
         float2 sampleUv = clamp(inputUv + kSearch[j] * searchRadius, 0.0, 0.999);
-        float2 testMV = Motion.SampleLevel(LinearClamp, sampleUv, 0).xy * motionSampleScale;
+        float2 testMV = Motion.SampleLevel(LinearClamp, WorkUv(sampleUv), 0).xy * motionSampleScale;
         
         float2 pPrev = inputPos + testMV * alpha;
         float2 pCurr = inputPos - testMV * (1.0 - alpha);
@@ -332,12 +338,12 @@ void CSMain(uint3 id : SV_DispatchThreadID)
                         any(pCurrUv < 0.005) || any(pCurrUv > 0.995)) ? 0.1 : 0.0;
         
         // Use CNN features to evaluate how well this motion vector aligns the textures
-        float4 fPrev = PrevFeature.SampleLevel(LinearClamp, pPrevUv, 0);
-        float4 fCurr = CurrFeature.SampleLevel(LinearClamp, pCurrUv, 0);
-        float4 fPrev2 = PrevFeature2.SampleLevel(LinearClamp, pPrevUv, 0);
-        float4 fCurr2 = CurrFeature2.SampleLevel(LinearClamp, pCurrUv, 0);
-        float4 fPrev3 = PrevFeature3.SampleLevel(LinearClamp, pPrevUv, 0);
-        float4 fCurr3 = CurrFeature3.SampleLevel(LinearClamp, pCurrUv, 0);
+        float4 fPrev = PrevFeature.SampleLevel(LinearClamp, WorkUv(pPrevUv), 0);
+        float4 fCurr = CurrFeature.SampleLevel(LinearClamp, WorkUv(pCurrUv), 0);
+        float4 fPrev2 = PrevFeature2.SampleLevel(LinearClamp, WorkUv(pPrevUv), 0);
+        float4 fCurr2 = CurrFeature2.SampleLevel(LinearClamp, WorkUv(pCurrUv), 0);
+        float4 fPrev3 = PrevFeature3.SampleLevel(LinearClamp, WorkUv(pPrevUv), 0);
+        float4 fCurr3 = CurrFeature3.SampleLevel(LinearClamp, WorkUv(pCurrUv), 0);
         
         float4 diff = abs(fPrev - fCurr);
         float4 diff2 = abs(fPrev2 - fCurr2);
@@ -349,10 +355,10 @@ void CSMain(uint3 id : SV_DispatchThreadID)
         
         // Periodicity-aware tie-breaker:
         if (periodicity > 0.3) {
-            float2 neighborMV1 = Motion.SampleLevel(LinearClamp, clamp(inputUv + float2(0.01, 0), 0.0, 0.999), 0).xy;
-            float2 neighborMV2 = Motion.SampleLevel(LinearClamp, clamp(inputUv - float2(0.01, 0), 0.0, 0.999), 0).xy;
-            float2 neighborMV3 = Motion.SampleLevel(LinearClamp, clamp(inputUv + float2(0, 0.01), 0.0, 0.999), 0).xy;
-            float2 neighborMV4 = Motion.SampleLevel(LinearClamp, clamp(inputUv - float2(0, 0.01), 0.0, 0.999), 0).xy;
+            float2 neighborMV1 = Motion.SampleLevel(LinearClamp, WorkUv(clamp(inputUv + float2(0.01, 0), 0.0, 0.999)), 0).xy;
+            float2 neighborMV2 = Motion.SampleLevel(LinearClamp, WorkUv(clamp(inputUv - float2(0.01, 0), 0.0, 0.999)), 0).xy;
+            float2 neighborMV3 = Motion.SampleLevel(LinearClamp, WorkUv(clamp(inputUv + float2(0, 0.01), 0.0, 0.999)), 0).xy;
+            float2 neighborMV4 = Motion.SampleLevel(LinearClamp, WorkUv(clamp(inputUv - float2(0, 0.01), 0.0, 0.999)), 0).xy;
             
             float consistency1 = 1.0 - length(testMV - neighborMV1) * 0.5;
             float consistency2 = 1.0 - length(testMV - neighborMV2) * 0.5;
@@ -404,12 +410,12 @@ void CSMain(uint3 id : SV_DispatchThreadID)
     // Instead of lerp-blending (which ghosts when MVs are imperfect),
     // we SELECT the better source per-pixel using AI occlusion prediction.
 
-    float4 fP1 = PrevFeature.SampleLevel(LinearClamp, warpPrevUv, 0);
-    float4 fC1 = CurrFeature.SampleLevel(LinearClamp, warpCurrUv, 0);
-    float4 fP2 = PrevFeature2.SampleLevel(LinearClamp, warpPrevUv, 0);
-    float4 fC2 = CurrFeature2.SampleLevel(LinearClamp, warpCurrUv, 0);
-    float4 fP3 = PrevFeature3.SampleLevel(LinearClamp, warpPrevUv, 0);
-    float4 fC3 = CurrFeature3.SampleLevel(LinearClamp, warpCurrUv, 0);
+    float4 fP1 = PrevFeature.SampleLevel(LinearClamp, WorkUv(warpPrevUv), 0);
+    float4 fC1 = CurrFeature.SampleLevel(LinearClamp, WorkUv(warpCurrUv), 0);
+    float4 fP2 = PrevFeature2.SampleLevel(LinearClamp, WorkUv(warpPrevUv), 0);
+    float4 fC2 = CurrFeature2.SampleLevel(LinearClamp, WorkUv(warpCurrUv), 0);
+    float4 fP3 = PrevFeature3.SampleLevel(LinearClamp, WorkUv(warpPrevUv), 0);
+    float4 fC3 = CurrFeature3.SampleLevel(LinearClamp, WorkUv(warpCurrUv), 0);
 
     float4 featureDiff1 = fP1 - fC1;
     float4 featureDiff2 = fP2 - fC2;
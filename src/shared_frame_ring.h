@@ -0,0 +1,370 @@
+#pragma once
+
+// Shared-memory frame ring between the graphics hook (producer) and
+// GameCapture (consumer). Platform neutral: it only lays out a block of
+// memory, the caller maps it (CreateFileMapping on Windows, shm_open on
+// POSIX).
+//
+// Layout: shared_frame_ring_header, then slot_count payloads of slot_size
+// bytes each, data_offset bytes from the start of the mapping. Each payload
+// starts with slot_meta_size bytes of per-slot metadata (the tile stamp
+// table when tile_size != 0, see tile_delta.h, then the optional half-res
+// luma plane at luma_offset when luma_pitch != 0) followed by the pixels.
+//
+// Every slot is guarded by a seqlock. The writer bumps the slot sequence to
+// odd, writes the payload, bumps it to even and then publishes the frame
+// number; it never waits for the reader. The reader samples the sequence
+// before and after copying and discards the copy if it changed (torn frame,
+// the writer lapped the ring). Frame numbers are consecutive, so the reader
+// also sees how many frames it skipped.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#define SHARED_FRAME_RING_MAGIC     0x524D4654u   // "TFMR"
+#define SHARED_FRAME_RING_VERSION   4u
+#define SHARED_FRAME_RING_MAX_SLOTS 8u
+#define SHARED_FRAME_RING_ALIGN     4096u
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared frame ring needs lock-free 64-bit atomics");
+
+struct alignas(64) shared_frame_slot {
+    std::atomic<uint64_t> seq;             // odd while the writer owns the slot
+    std::atomic<uint64_t> frame;           // frame number held by the slot
+    std::atomic<int64_t> present_time;     // producer timestamp (QPC ticks)
+};
+
+struct shared_frame_ring_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_count;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t format;                       // DXGI_FORMAT on Windows
+
+    uint64_t slot_size;
+    uint64_t data_offset;
+    int64_t time_frequency;                // ticks per second of present_time
+
+    uint32_t tile_size;                    // 0 = full frames, else delta tile edge
+    uint32_t luma_pitch;                   // bytes per luma row, 0 = no luma plane
+    uint64_t slot_meta_size;               // metadata bytes before the pixels
+    uint64_t luma_offset;                  // luma plane (width/2 x height/2 R16) within the metadata
+
+    std::atomic<uint64_t> latest_frame;    // 0 = nothing published yet
+
+    shared_frame_slot slots[SHARED_FRAME_RING_MAX_SLOTS];
+};
+
+namespace shared_frame_ring {
+
+inline uint64_t AlignUp(uint64_t value, uint64_t align) {
+    return (value + align - 1) / align * align;
+}
+
+inline uint64_t DataOffset() {
+    return AlignUp(sizeof(shared_frame_ring_header), SHARED_FRAME_RING_ALIGN);
+}
+
+inline uint64_t MetaSize(uint64_t metaBytes) {
+    return AlignUp(metaBytes, 64);
+}
+
+inline uint64_t LumaPitch(uint32_t width) {
+    return AlignUp(static_cast<uint64_t>(width / 2) * 2, 64);
+}
+
+// Per-slot metadata: metaBytes of caller data, then the luma plane if any.
+inline uint64_t SlotMetaSize(uint32_t height, uint64_t metaBytes, uint32_t lumaPitch) {
+    return MetaSize(metaBytes) + MetaSize(static_cast<uint64_t>(lumaPitch) * (height / 2));
+}
+
+inline uint64_t SlotSize(uint32_t pitch, uint32_t height, uint64_t metaBytes = 0, uint32_t lumaPitch = 0) {
+    return AlignUp(SlotMetaSize(height, metaBytes, lumaPitch) + static_cast<uint64_t>(pitch) * height,
+                   SHARED_FRAME_RING_ALIGN);
+}
+
+// Bytes to map for the given geometry.
+inline uint64_t MappingSize(uint32_t slotCount, uint32_t pitch, uint32_t height, uint64_t metaBytes = 0,
+                            uint32_t lumaPitch = 0) {
+    return DataOffset() + SlotSize(pitch, height, metaBytes, lumaPitch) * slotCount;
+}
+
+// Checks a mapping written by another process before trusting its offsets.
+inline bool Validate(const void* base, uint64_t mappedSize) {
+    if (!base || mappedSize < sizeof(shared_frame_ring_header)) return false;
+    auto* header = static_cast<const shared_frame_ring_header*>(base);
+    if (header->magic != SHARED_FRAME_RING_MAGIC || header->version != SHARED_FRAME_RING_VERSION ||
+        header->header_size != sizeof(shared_frame_ring_header)) {
+        return false;
+    }
+    if (header->slot_count < 2 || header->slot_count > SHARED_FRAME_RING_MAX_SLOTS) return false;
+    if (header->slot_meta_size % 64 != 0 ||
+        header->slot_size < header->slot_meta_size + static_cast<uint64_t>(header->pitch) * header->height) {
+        return false;
+    }
+    if (header->luma_pitch != 0 &&
+        (header->luma_pitch < (header->width / 2) * 2 ||
+         header->luma_offset + static_cast<uint64_t>(header->luma_pitch) * (header->height / 2) >
+             header->slot_meta_size)) {
+        return false;
+    }
+    return header->data_offset >= sizeof(shared_frame_ring_header) &&
+           header->data_offset + header->slot_size * header->slot_count <= mappedSize;
+}
+
+// A slot used on its own, without payload: producers that publish frames
+// outside the ring (the shared texture path) stamp the frame number and
+// present time under the slot's seqlock so readers never pair one frame's
+// number with another frame's time.
+inline void PublishStamp(shared_frame_slot& stamp, uint64_t frame, int64_t presentTime) {
+    const uint64_t seq = stamp.seq.load(std::memory_order_relaxed);
+    stamp.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    stamp.frame.store(frame, std::memory_order_relaxed);
+    stamp.present_time.store(presentTime, std::memory_order_relaxed);
+    stamp.seq.store(seq + 2, std::memory_order_release);
+}
+
+// False while the producer is mid-update; the caller polls again later.
+inline bool ReadStamp(const shared_frame_slot& stamp, uint64_t* frame, int64_t* presentTime) {
+    const uint64_t before = stamp.seq.load(std::memory_order_acquire);
+    if (before & 1) return false;
+    const uint64_t stampFrame = stamp.frame.load(std::memory_order_relaxed);
+    const int64_t stampTime = stamp.present_time.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (stamp.seq.load(std::memory_order_relaxed) != before) return false;
+    *frame = stampFrame;
+    *presentTime = stampTime;
+    return true;
+}
+
+} // namespace shared_frame_ring
+
+// Producer side. Owns the header initialisation.
+class SharedFrameRingWriter {
+public:
+    // Lays out the ring in a zeroed or reused mapping of at least
+    // shared_frame_ring::MappingSize(...) bytes. metaBytes reserves per-slot
+    // metadata ahead of the pixels; tileSize is advertised to the reader.
+    // A non-zero lumaPitch (>= width bytes) adds a half-res 16-bit luma plane.
+    bool Initialize(void* base, uint64_t mappedSize, uint32_t slotCount,
+                    uint32_t width, uint32_t height, uint32_t pitch, uint32_t format,
+                    int64_t timeFrequency, uint32_t tileSize = 0, uint64_t metaBytes = 0,
+                    uint32_t lumaPitch = 0) {
+        if (!base || slotCount < 2 || slotCount > SHARED_FRAME_RING_MAX_SLOTS) return false;
+        if (lumaPitch != 0 && lumaPitch < (width / 2) * 2) return false;
+        if (mappedSize < shared_frame_ring::MappingSize(slotCount, pitch, height, metaBytes, lumaPitch)) return false;
+
+        m_header = static_cast<shared_frame_ring_header*>(base);
+        m_header->magic = 0;   // readers reject the ring while it is rebuilt
+        m_header->version = SHARED_FRAME_RING_VERSION;
+        m_header->header_size = sizeof(shared_frame_ring_header);
+        m_header->slot_count = slotCount;
+        m_header->width = width;
+        m_header->height = height;
+        m_header->pitch = pitch;
+        m_header->format = format;
+        m_header->slot_size = shared_frame_ring::SlotSize(pitch, height, metaBytes, lumaPitch);
+        m_header->data_offset = shared_frame_ring::DataOffset();
+        m_header->time_frequency = timeFrequency;
+        m_header->tile_size = tileSize;
+        m_header->luma_pitch = lumaPitch;
+        m_header->slot_meta_size = shared_frame_ring::SlotMetaSize(height, metaBytes, lumaPitch);
+        m_header->luma_offset = lumaPitch ? shared_frame_ring::MetaSize(metaBytes) : 0;
+        for (uint32_t i = 0; i < SHARED_FRAME_RING_MAX_SLOTS; i++) {
+            m_header->slots[i].seq.store(0, std::memory_order_relaxed);
+            m_header->slots[i].frame.store(0, std::memory_order_relaxed);
+            m_header->slots[i].present_time.store(0, std::memory_order_relaxed);
+        }
+        m_header->latest_frame.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_header->magic = SHARED_FRAME_RING_MAGIC;
+
+        m_nextFrame = 1;
+        m_writing = false;
+        return true;
+    }
+
+    void Reset() { m_header = nullptr; m_writing = false; }
+    bool IsValid() const { return m_header != nullptr; }
+
+    // Claims the slot for the next frame and returns its pixels. Never
+    // waits: a reader still copying that slot will see the frame as torn.
+    // The previous slot content stays in place, so a delta encoder can
+    // update only what changed since PreviousSlotFrame().
+    uint8_t* BeginWrite() {
+        if (!m_header || m_writing) return nullptr;
+        m_slot = static_cast<uint32_t>(m_nextFrame % m_header->slot_count);
+        shared_frame_slot& slot = m_header->slots[m_slot];
+        m_previousSlotFrame = slot.frame.load(std::memory_order_relaxed);
+        uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_writing = true;
+        return SlotMeta() + m_header->slot_meta_size;
+    }
+
+    // Valid between BeginWrite and EndWrite.
+    uint8_t* SlotMeta() const {
+        return reinterpret_cast<uint8_t*>(m_header) + m_header->data_offset + m_header->slot_size * m_slot;
+    }
+    uint8_t* SlotLuma() const {
+        return m_header->luma_pitch ? SlotMeta() + m_header->luma_offset : nullptr;
+    }
+    uint64_t PreviousSlotFrame() const { return m_previousSlotFrame; }
+    uint64_t NextFrame() const { return m_nextFrame; }
+
+    // Publishes the frame written since BeginWrite. Returns its frame number.
+    uint64_t EndWrite(int64_t presentTime) {
+        if (!m_header || !m_writing) return 0;
+        shared_frame_slot& slot = m_header->slots[m_slot];
+        uint64_t frame = m_nextFrame++;
+        slot.frame.store(frame, std::memory_order_relaxed);
+        slot.present_time.store(presentTime, std::memory_order_relaxed);
+        slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        m_header->latest_frame.store(frame, std::memory_order_release);
+        m_writing = false;
+        return frame;
+    }
+
+    // Abandons a BeginWrite (e.g. the GPU readback failed). The slot is
+    // left with an even sequence but its old frame number no longer matches
+    // its content, so it is marked empty.
+    void CancelWrite() {
+        if (!m_header || !m_writing) return;
+        shared_frame_slot& slot = m_header->slots[m_slot];
+        slot.frame.store(0, std::memory_order_relaxed);
+        slot.seq.store(slot.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        m_writing = false;
+    }
+
+    shared_frame_ring_header* Header() const { return m_header; }
+
+private:
+    shared_frame_ring_header* m_header = nullptr;
+    uint64_t m_nextFrame = 1;
+    uint64_t m_previousSlotFrame = 0;
+    uint32_t m_slot = 0;
+    bool m_writing = false;
+};
+
+struct SharedFrameView {
+    const uint8_t* data = nullptr;
+    const uint8_t* meta = nullptr;     // slot_meta_size bytes, or null
+    const uint8_t* luma = nullptr;     // half-res luma plane (luma_pitch rows), or null
+    uint64_t frame = 0;
+    int64_t presentTime = 0;
+    uint64_t skipped = 0;          // frames published since the last good read and never read
+    uint32_t slot = 0;
+    uint64_t seq = 0;
+};
+
+struct SharedFrameRingStats {
+    uint64_t reads = 0;            // frames delivered
+    uint64_t torn = 0;             // copies discarded because the writer lapped
+    uint64_t busy = 0;             // latest slot was mid-write (retry later)
+    uint64_t skipped = 0;          // frames never read (gaps)
+};
+
+// Consumer side.
+class SharedFrameRingReader {
+public:
+    bool Attach(const void* base, uint64_t mappedSize) {
+        m_header = nullptr;
+        if (!shared_frame_ring::Validate(base, mappedSize)) return false;
+        m_header = static_cast<const shared_frame_ring_header*>(base);
+        m_lastFrame = 0;
+        return true;
+    }
+
+    void Detach() { m_header = nullptr; }
+    bool IsAttached() const { return m_header != nullptr; }
+    const shared_frame_ring_header* Header() const { return m_header; }
+
+    uint64_t LatestFrame() const {
+        return m_header ? m_header->latest_frame.load(std::memory_order_acquire) : 0;
+    }
+
+    // Starts reading the newest frame if it is newer than the last one
+    // delivered. The payload is only valid if EndRead returns true.
+    bool BeginRead(SharedFrameView* view) {
+        if (!m_header || !view) return false;
+        uint64_t latest = m_header->latest_frame.load(std::memory_order_acquire);
+        if (latest == 0 || latest == m_lastFrame) return false;
+
+        uint32_t slotIndex = static_cast<uint32_t>(latest % m_header->slot_count);
+        const shared_frame_slot& slot = m_header->slots[slotIndex];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            m_stats.busy++;
+            return false;
+        }
+        if (slot.frame.load(std::memory_order_relaxed) != latest) {
+            // Already recycled for a newer frame; the next poll sees it.
+            m_stats.busy++;
+            return false;
+        }
+
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(m_header) + m_header->data_offset +
+                                 m_header->slot_size * slotIndex;
+        view->meta = m_header->slot_meta_size ? payload : nullptr;
+        view->luma = m_header->luma_pitch ? payload + m_header->luma_offset : nullptr;
+        view->data = payload + m_header->slot_meta_size;
+        view->frame = latest;
+        view->presentTime = slot.present_time.load(std::memory_order_relaxed);
+        view->skipped = (m_lastFrame != 0 && latest > m_lastFrame + 1) ? latest - m_lastFrame - 1 : 0;
+        view->slot = slotIndex;
+        view->seq = seq;
+        return true;
+    }
+
+    // Finishes a read started by BeginRead. False means the copy taken in
+    // between is torn and must be dropped.
+    bool EndRead(const SharedFrameView& view) {
+        if (!m_header) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t seq = m_header->slots[view.slot].seq.load(std::memory_order_relaxed);
+        if (seq != view.seq) {
+            m_stats.torn++;
+            return false;
+        }
+        m_stats.reads++;
+        m_stats.skipped += view.skipped;
+        m_lastFrame = view.frame;
+        return true;
+    }
+
+    // Convenience: copies the newest frame into dst (rows of dstPitch).
+    bool ReadLatest(void* dst, uint32_t dstPitch, SharedFrameView* view) {
+        SharedFrameView local;
+        SharedFrameView* v = view ? view : &local;
+        if (!BeginRead(v)) return false;
+        const uint32_t srcPitch = m_header->pitch;
+        const uint32_t rowBytes = srcPitch < dstPitch ? srcPitch : dstPitch;
+        auto* out = static_cast<uint8_t*>(dst);
+        if (srcPitch == dstPitch) {
+            std::memcpy(out, v->data, static_cast<size_t>(srcPitch) * m_header->height);
+        } else {
+            for (uint32_t y = 0; y < m_header->height; y++) {
+                std::memcpy(out + static_cast<size_t>(y) * dstPitch,
+                            v->data + static_cast<size_t>(y) * srcPitch, rowBytes);
+            }
+        }
+        return EndRead(*v);
+    }
+
+    const SharedFrameRingStats& Stats() const { return m_stats; }
+    void ResetStats() { m_stats = SharedFrameRingStats(); }
+
+private:
+    const shared_frame_ring_header* m_header = nullptr;
+    uint64_t m_lastFrame = 0;
+    SharedFrameRingStats m_stats;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+// Instruction set selection shared by the SIMD kernels (pixel_convert.cpp,
+// quality_metrics.cpp). The files build with baseline flags: wider kernels
+// carry a per-function target and are only entered after DetectSimdLevel()
+// has allowed them.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TFE_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TFE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// MSVC compiles intrinsics for any ISA without attributes.
+#if defined(TFE_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TFE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TFE_TARGET_AVX2 __attribute__((target("avx2")))
+#define TFE_TARGET_AVX2_F16C __attribute__((target("avx2,f16c")))
+#else
+#define TFE_TARGET_SSE41
+#define TFE_TARGET_AVX2
+#define TFE_TARGET_AVX2_F16C
+#endif
@@ -0,0 +1,324 @@
+#include "stage_timer.h"
+
+#include "deadline_wait.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+double PercentileOfSorted(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  // Nearest rank, as the histogram percentiles elsewhere.
+  size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+  rank = std::clamp<size_t>(rank, 1, sorted.size());
+  return sorted[rank - 1];
+}
+
+StagePercentiles Percentiles(std::vector<double>& durations) {
+  StagePercentiles result;
+  if (durations.empty()) {
+    return result;
+  }
+  std::sort(durations.begin(), durations.end());
+  double sum = 0.0;
+  for (double d : durations) {
+    sum += d;
+  }
+  result.count = durations.size();
+  result.meanSec = sum / static_cast<double>(durations.size());
+  result.p50Sec = PercentileOfSorted(durations, 0.50);
+  result.p95Sec = PercentileOfSorted(durations, 0.95);
+  result.p99Sec = PercentileOfSorted(durations, 0.99);
+  result.maxSec = durations.back();
+  return result;
+}
+
+} // namespace
+
+const char* PipelineStageName(PipelineStage stage) {
+  switch (stage) {
+    case PipelineStage::Execute:
+      return "Execute";
+    case PipelineStage::InterpolateOnly:
+      return "InterpolateOnly";
+    case PipelineStage::Downsample:
+      return "Downsample";
+    case PipelineStage::Pyramid:
+      return "Pyramid";
+    case PipelineStage::MotionForward:
+      return "MotionForward";
+    case PipelineStage::MotionBackward:
+      return "MotionBackward";
+    case PipelineStage::RefineQuarter:
+      return "RefineQuarter";
+    case PipelineStage::RefineHalf:
+      return "RefineHalf";
+    case PipelineStage::Smooth:
+      return "Smooth";
+    case PipelineStage::Interpolate:
+      return "Interpolate";
+    case PipelineStage::VkCopyIn:
+      return "VkCopyIn";
+    case PipelineStage::VkDownsample:
+      return "VkDownsample";
+    case PipelineStage::VkCostVolume:
+      return "VkCostVolume";
+    case PipelineStage::VkFlowDecoder:
+      return "VkFlowDecoder";
+    case PipelineStage::VkInterpolate:
+      return "VkInterpolate";
+    case PipelineStage::VkSubmitWait:
+      return "VkSubmitWait";
+    case PipelineStage::Count:
+      break;
+  }
+  return "";
+}
+
+// ----------------------------------------------------------------------------
+// StageTimeline
+// ----------------------------------------------------------------------------
+
+StageTimeline::StageTimeline() : m_slots(new Slot[kCapacity]) {}
+
+void StageTimeline::Push(const StageSample& sample) {
+  const uint64_t index = m_head.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = m_slots[index % kCapacity];
+  // Odd while writing; readers that see it (or a change) skip the slot.
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.frame.store(sample.frame, std::memory_order_relaxed);
+  slot.beginSec.store(sample.beginSec, std::memory_order_relaxed);
+  slot.endSec.store(sample.endSec, std::memory_order_relaxed);
+  slot.tag.store(static_cast<uint32_t>(sample.stage) | (static_cast<uint32_t>(sample.domain) << 8),
+                 std::memory_order_relaxed);
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void StageTimeline::Snapshot(std::vector<StageSample>& out) const {
+  const uint64_t head = m_head.load(std::memory_order_acquire);
+  const uint64_t first = head > kCapacity ? head - kCapacity : 0;
+  out.reserve(out.size() + static_cast<size_t>(head - first));
+  for (uint64_t index = first; index < head; ++index) {
+    StageSample sample;
+    if (Read(index, sample) == ReadResult::Ok) {
+      out.push_back(sample);
+    }
+  }
+}
+
+uint64_t StageTimeline::SnapshotSince(uint64_t first, std::vector<StageSample>& out) const {
+  const uint64_t head = m_head.load(std::memory_order_acquire);
+  first = std::max(first, head > kCapacity ? head - kCapacity : 0);
+  for (uint64_t index = first; index < head; ++index) {
+    StageSample sample;
+    const ReadResult result = Read(index, sample);
+    if (result == ReadResult::Busy) {
+      return index;
+    }
+    if (result == ReadResult::Ok) {
+      out.push_back(sample);
+    }
+  }
+  return head;
+}
+
+StageTimeline::ReadResult StageTimeline::Read(uint64_t index, StageSample& sample) const {
+  const Slot& slot = m_slots[index % kCapacity];
+  const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+  if (before != 2 * index + 2) {
+    // Below: not written yet, or being written. Above: already overwritten.
+    return before > 2 * index + 2 ? ReadResult::Gone : ReadResult::Busy;
+  }
+  sample.frame = slot.frame.load(std::memory_order_relaxed);
+  sample.beginSec = slot.beginSec.load(std::memory_order_relaxed);
+  sample.endSec = slot.endSec.load(std::memory_order_relaxed);
+  const uint32_t tag = slot.tag.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.sequence.load(std::memory_order_relaxed) != before) {
+    return ReadResult::Gone;
+  }
+  const uint32_t stage = tag & 0xFFu;
+  if (stage >= static_cast<uint32_t>(kPipelineStageCount)) {
+    return ReadResult::Gone;
+  }
+  sample.stage = static_cast<PipelineStage>(stage);
+  sample.domain = static_cast<TimingDomain>((tag >> 8) & 0xFFu);
+  return ReadResult::Ok;
+}
+
+// ----------------------------------------------------------------------------
+// Summary and export
+// ----------------------------------------------------------------------------
+
+StageTimingSummary SummarizeStages(const std::vector<StageSample>& samples, int windowFrames) {
+  StageTimingSummary summary;
+  if (samples.empty()) {
+    return summary;
+  }
+  uint64_t lastFrame = 0;
+  for (const StageSample& sample : samples) {
+    lastFrame = std::max(lastFrame, sample.frame);
+  }
+  const uint64_t window = static_cast<uint64_t>(std::max(windowFrames, 1));
+  const uint64_t firstFrame = lastFrame >= window ? lastFrame - window + 1 : 0;
+
+  std::array<std::vector<double>, kPipelineStageCount> cpu;
+  std::array<std::vector<double>, kPipelineStageCount> gpu;
+  uint64_t seenFirst = lastFrame;
+  for (const StageSample& sample : samples) {
+    if (sample.frame < firstFrame) {
+      continue;
+    }
+    seenFirst = std::min(seenFirst, sample.frame);
+    auto& bucket = sample.domain == TimingDomain::Gpu ? gpu : cpu;
+    bucket[static_cast<int>(sample.stage)].push_back(std::max(sample.endSec - sample.beginSec, 0.0));
+  }
+  for (int stage = 0; stage < kPipelineStageCount; ++stage) {
+    summary.cpu[stage] = Percentiles(cpu[stage]);
+    summary.gpu[stage] = Percentiles(gpu[stage]);
+  }
+  summary.firstFrame = seenFirst;
+  summary.lastFrame = lastFrame;
+  return summary;
+}
+
+std::string ChromeTraceJson(const std::vector<StageSample>& samples) {
+  double origin = 0.0;
+  bool haveOrigin = false;
+  for (const StageSample& sample : samples) {
+    if (!haveOrigin || sample.beginSec < origin) {
+      origin = sample.beginSec;
+      haveOrigin = true;
+    }
+  }
+
+  std::ostringstream ss;
+  ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  ss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"TrueMotion\"}},\n";
+  ss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+  ss << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+  char buffer[256];
+  for (const StageSample& sample : samples) {
+    const double ts = (sample.beginSec - origin) * 1e6;
+    const double dur = std::max(sample.endSec - sample.beginSec, 0.0) * 1e6;
+    const bool gpu = sample.domain == TimingDomain::Gpu;
+    std::snprintf(buffer, sizeof(buffer),
+                  ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                  "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+                  PipelineStageName(sample.stage), gpu ? "gpu" : "cpu", gpu ? 2 : 1, ts, dur,
+                  static_cast<unsigned long long>(sample.frame));
+    ss << buffer;
+  }
+  ss << "\n]}\n";
+  return ss.str();
+}
+
+bool WriteChromeTrace(const std::string& path, const std::vector<StageSample>& samples) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  const std::string json = ChromeTraceJson(samples);
+  file.write(json.data(), static_cast<std::streamsize>(json.size()));
+  return static_cast<bool>(file);
+}
+
+// ----------------------------------------------------------------------------
+// StageProfiler
+// ----------------------------------------------------------------------------
+
+void StageProfiler::AddGpuTimer(GpuStageTimer* timer) {
+  for (GpuStageTimer*& slot : m_gpuTimers) {
+    if (slot == timer) {
+      return;
+    }
+    if (!slot) {
+      slot = timer;
+      return;
+    }
+  }
+}
+
+void StageProfiler::BeginFrame() {
+  if (m_frameDepth++ > 0) {
+    return;
+  }
+  m_frame++;
+  const double now = DeadlineWaiter::Now();
+  for (GpuStageTimer* timer : m_gpuTimers) {
+    if (timer) {
+      // Older frames' queries have had a few frames to land.
+      timer->Collect(m_timeline);
+      timer->BeginFrame(m_frame, now);
+    }
+  }
+}
+
+void StageProfiler::EndFrame() {
+  if (m_frameDepth == 0 || --m_frameDepth > 0) {
+    return;
+  }
+  for (GpuStageTimer* timer : m_gpuTimers) {
+    if (timer) {
+      timer->EndFrame();
+    }
+  }
+}
+
+void StageProfiler::Record(PipelineStage stage, TimingDomain domain, double beginSec, double endSec) {
+  StageSample sample;
+  sample.frame = m_frame;
+  sample.beginSec = beginSec;
+  sample.endSec = endSec;
+  sample.stage = stage;
+  sample.domain = domain;
+  m_timeline.Push(sample);
+}
+
+// ----------------------------------------------------------------------------
+// Scopes
+// ----------------------------------------------------------------------------
+
+StageScope::StageScope(StageProfiler& profiler, PipelineStage stage, GpuStageTimer* gpu)
+    : m_stage(stage) {
+  if (!profiler.Timed(stage)) {
+    return;
+  }
+  m_profiler = &profiler;
+  m_gpu = gpu;
+  if (m_gpu) {
+    m_gpu->BeginStage(stage);
+  }
+  m_beginSec = DeadlineWaiter::Now();
+}
+
+StageScope::~StageScope() {
+  if (!m_profiler) {
+    return;
+  }
+  const double endSec = DeadlineWaiter::Now();
+  if (m_gpu) {
+    m_gpu->EndStage(m_stage);
+  }
+  m_profiler->Record(m_stage, TimingDomain::Cpu, m_beginSec, endSec);
+}
+
+StageFrameScope::StageFrameScope(StageProfiler& profiler) {
+  if (profiler.AnyTimed()) {
+    m_profiler = &profiler;
+    m_profiler->BeginFrame();
+  }
+}
+
+StageFrameScope::~StageFrameScope() {
+  if (m_profiler) {
+    m_profiler->EndFrame();
+  }
+}
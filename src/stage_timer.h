@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Per-stage timing of the interpolation pipeline.
+//
+// Every stage is bracketed by a StageScope. The scope always records the CPU
+// time spent issuing the stage; when a GpuStageTimer is passed in, the backend
+// also brackets the stage with GPU timestamps (D3D11 timestamp queries,
+// vkCmdWriteTimestamp) and resolves them a few frames later. Both end up as
+// StageSamples in a StageTimeline, a fixed-size lock-free ring the render
+// thread writes and the UI / export read without stopping it.
+//
+// Times are seconds on the platform monotonic clock (DeadlineWaiter::Now()).
+// GPU samples are placed on that clock relative to the CPU start of the frame
+// that issued them: durations are exact, offsets are approximate.
+
+enum class PipelineStage : uint8_t {
+  Execute,            // one full generation (motion + warp)
+  InterpolateOnly,    // re-warp with cached motion
+  Downsample,         // full -> half luma / features
+  Pyramid,            // half -> quarter -> eighth
+  MotionForward,      // eighth-res ZNCC search
+  MotionBackward,
+  RefineQuarter,
+  RefineHalf,
+  Smooth,
+  Interpolate,        // D3D11 warp
+  VkCopyIn,           // D3D11 -> shared image copies and flush
+  VkDownsample,
+  VkCostVolume,
+  VkFlowDecoder,
+  VkInterpolate,
+  VkSubmitWait,       // queue submit to fence signal
+  Count,
+};
+
+constexpr int kPipelineStageCount = static_cast<int>(PipelineStage::Count);
+
+constexpr uint32_t StageBit(PipelineStage stage) { return 1u << static_cast<int>(stage); }
+
+const char* PipelineStageName(PipelineStage stage);
+
+enum class TimingDomain : uint8_t {
+  Cpu,
+  Gpu,
+};
+
+struct StageSample {
+  uint64_t frame = 0;
+  double beginSec = 0.0;
+  double endSec = 0.0;
+  PipelineStage stage = PipelineStage::Execute;
+  TimingDomain domain = TimingDomain::Cpu;
+};
+
+struct StagePercentiles {
+  uint64_t count = 0;
+  double meanSec = 0.0;
+  double p50Sec = 0.0;
+  double p95Sec = 0.0;
+  double p99Sec = 0.0;
+  double maxSec = 0.0;
+};
+
+// Rolling per-stage statistics over the last few frames of a timeline.
+struct StageTimingSummary {
+  uint64_t firstFrame = 0;
+  uint64_t lastFrame = 0;
+  std::array<StagePercentiles, kPipelineStageCount> cpu = {};
+  std::array<StagePercentiles, kPipelineStageCount> gpu = {};
+
+  const StagePercentiles& Get(PipelineStage stage, TimingDomain domain) const {
+    return domain == TimingDomain::Gpu ? gpu[static_cast<int>(stage)] : cpu[static_cast<int>(stage)];
+  }
+};
+
+// Fixed-size multi-producer ring of stage samples. Writers never block or
+// allocate; readers copy out whatever has not been overwritten yet. Each slot
+// is a small seqlock, so a reader racing a writer skips the slot instead of
+// reading a torn sample.
+class StageTimeline {
+public:
+  static constexpr uint32_t kCapacity = 4096;  // ~250 frames of full pipeline
+
+  StageTimeline();
+
+  void Push(const StageSample& sample);
+
+  // Appends the retained samples, oldest first.
+  void Snapshot(std::vector<StageSample>& out) const;
+  // Appends the samples pushed at index `first` or later and returns the
+  // index to pass next time. Stops at a slot still being written, so an
+  // incremental reader picks it up on the next call instead of losing it.
+  uint64_t SnapshotSince(uint64_t first, std::vector<StageSample>& out) const;
+  uint64_t Pushed() const { return m_head.load(std::memory_order_acquire); }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};   // 2 * (index + 1) when complete
+    std::atomic<uint64_t> frame{0};
+    std::atomic<double> beginSec{0.0};
+    std::atomic<double> endSec{0.0};
+    std::atomic<uint32_t> tag{0};        // stage | domain << 8
+  };
+
+  enum class ReadResult { Ok, Busy, Gone };
+  ReadResult Read(uint64_t index, StageSample& sample) const;
+
+  std::atomic<uint64_t> m_head{0};
+  std::unique_ptr<Slot[]> m_slots;      // heap: the owner may live on the stack
+};
+
+// Percentiles of every stage over the samples of the last windowFrames
+// frames (exact, from sorted durations).
+StageTimingSummary SummarizeStages(const std::vector<StageSample>& samples, int windowFrames);
+
+// Chrome trace event format (chrome://tracing, Perfetto): one complete event
+// per sample, CPU and GPU on separate tracks, microseconds from the first
+// sample.
+std::string ChromeTraceJson(const std::vector<StageSample>& samples);
+bool WriteChromeTrace(const std::string& path, const std::vector<StageSample>& samples);
+
+// Backend GPU timestamps. Implementations issue queries between BeginStage
+// and EndStage, and hand finished results to Collect without blocking.
+class GpuStageTimer {
+public:
+  virtual ~GpuStageTimer() = default;
+
+  virtual void BeginFrame(uint64_t frame, double cpuSec) = 0;
+  virtual void EndFrame() = 0;
+  virtual void BeginStage(PipelineStage stage) = 0;
+  virtual void EndStage(PipelineStage stage) = 0;
+  virtual void Collect(StageTimeline& timeline) = 0;
+};
+
+class StageProfiler {
+public:
+  void SetEnabled(bool enabled) { m_enabled = enabled; }
+  bool Enabled() const { return m_enabled; }
+  // Stages (StageBit mask) timed even while the profiler is disabled, for
+  // consumers that need a few top-level brackets every frame.
+  void SetAlwaysTimed(uint32_t stageMask) { m_alwaysTimed = stageMask; }
+  bool Timed(PipelineStage stage) const { return m_enabled || (m_alwaysTimed & StageBit(stage)) != 0; }
+  bool AnyTimed() const { return m_enabled || m_alwaysTimed != 0; }
+
+  // Registers a backend timer; its frames follow the profiler's.
+  void AddGpuTimer(GpuStageTimer* timer);
+
+  // Frames nest: only the outermost Begin/End pair starts a new frame, so a
+  // public entry point calling another one stays one frame.
+  void BeginFrame();
+  void EndFrame();
+  uint64_t Frame() const { return m_frame; }
+
+  void Record(PipelineStage stage, TimingDomain domain, double beginSec, double endSec);
+
+  StageTimeline& Timeline() { return m_timeline; }
+  const StageTimeline& Timeline() const { return m_timeline; }
+
+private:
+  static constexpr int kMaxGpuTimers = 2;
+
+  bool m_enabled = false;
+  uint32_t m_alwaysTimed = 0;
+  int m_frameDepth = 0;
+  uint64_t m_frame = 0;
+  std::array<GpuStageTimer*, kMaxGpuTimers> m_gpuTimers = {};
+  StageTimeline m_timeline;
+};
+
+// Times one stage on the CPU and, with a timer, on the GPU.
+class StageScope {
+public:
+  StageScope(StageProfiler& profiler, PipelineStage stage, GpuStageTimer* gpu = nullptr);
+  ~StageScope();
+
+  StageScope(const StageScope&) = delete;
+  StageScope& operator=(const StageScope&) = delete;
+
+private:
+  StageProfiler* m_profiler = nullptr;   // null while disabled
+  GpuStageTimer* m_gpu = nullptr;
+  PipelineStage m_stage;
+  double m_beginSec = 0.0;
+};
+
+// Brackets one generation; see StageProfiler::BeginFrame.
+class StageFrameScope {
+public:
+  explicit StageFrameScope(StageProfiler& profiler);
+  ~StageFrameScope();
+
+  StageFrameScope(const StageFrameScope&) = delete;
+  StageFrameScope& operator=(const StageFrameScope&) = delete;
+
+private:
+  StageProfiler* m_profiler = nullptr;
+};
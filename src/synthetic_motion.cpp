@@ -0,0 +1,579 @@
+#include "synthetic_motion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+constexpr int kStripRows = 32;
+constexpr double kPi = 3.14159265358979323846;
+constexpr uint8_t kLayerBackground = 0;
+constexpr uint8_t kLayerHud = 255;
+
+// ----------------------------------------------------------------------------
+// Noise and textures
+// ----------------------------------------------------------------------------
+
+inline uint32_t Hash(int32_t x, int32_t y, uint32_t seed) {
+  uint32_t h = seed * 0x9E3779B9u ^ static_cast<uint32_t>(x) * 0x85EBCA6Bu ^ static_cast<uint32_t>(y) * 0xC2B2AE35u;
+  h ^= h >> 16;
+  h *= 0x7FEB352Du;
+  h ^= h >> 15;
+  h *= 0x846CA68Bu;
+  h ^= h >> 16;
+  return h;
+}
+
+// Smoothstep-interpolated lattice noise in [-0.5, 0.5], defined everywhere.
+inline float ValueNoise(float x, float y, float cell, uint32_t seed) {
+  x /= cell;
+  y /= cell;
+  const float fx0 = std::floor(x);
+  const float fy0 = std::floor(y);
+  const int32_t x0 = static_cast<int32_t>(fx0);
+  const int32_t y0 = static_cast<int32_t>(fy0);
+  const float fx = x - fx0;
+  const float fy = y - fy0;
+  const float sx = fx * fx * (3.0f - 2.0f * fx);
+  const float sy = fy * fy * (3.0f - 2.0f * fy);
+  constexpr float kScale = 1.0f / 4294967296.0f;
+  const float a = Hash(x0, y0, seed) * kScale;
+  const float b = Hash(x0 + 1, y0, seed) * kScale;
+  const float c = Hash(x0, y0 + 1, seed) * kScale;
+  const float d = Hash(x0 + 1, y0 + 1, seed) * kScale;
+  const float top = a + (b - a) * sx;
+  const float bottom = c + (d - c) * sx;
+  return top + (bottom - top) * sy - 0.5f;
+}
+
+struct Rgb {
+  float r;
+  float g;
+  float b;
+};
+
+// Three luma octaves (64 / 16 / 4 px at 1080p) and a coarse chroma octave.
+Rgb NoiseTexture(float u, float v, uint32_t seed, float unit) {
+  const float luma = 128.0f + 150.0f * (0.55f * ValueNoise(u, v, 64.0f * unit, seed) +
+                                        0.30f * ValueNoise(u, v, 16.0f * unit, seed + 1) +
+                                        0.15f * ValueNoise(u, v, 4.0f * unit, seed + 2));
+  const float cb = 70.0f * ValueNoise(u, v, 96.0f * unit, seed + 3);
+  const float cr = 70.0f * ValueNoise(u, v, 96.0f * unit, seed + 4);
+  return {luma + cr, luma - 0.5f * (cb + cr), luma + cb};
+}
+
+// Soft-edged checker grating with a faint coarse variation, so most
+// windows match several shifts one period apart.
+Rgb PeriodicTexture(float u, float v, float period, uint32_t seed, float unit) {
+  const float w = static_cast<float>(2.0 * kPi) / period;
+  const float g = std::tanh(2.0f * std::sin(u * w)) * std::tanh(2.0f * std::sin(v * w));
+  const float luma = 128.0f + 90.0f * g + 20.0f * ValueNoise(u, v, 256.0f * unit, seed);
+  return {luma + 12.0f, luma, luma - 12.0f};
+}
+
+// ----------------------------------------------------------------------------
+// Parameters
+// ----------------------------------------------------------------------------
+
+class Rng {
+public:
+  explicit Rng(uint64_t seed) : m_state(seed) {}
+  uint64_t NextU64() {
+    uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+  float Uniform(float lo, float hi) {
+    return lo + (hi - lo) * static_cast<float>(NextU64() >> 40) / 16777216.0f;
+  }
+
+private:
+  uint64_t m_state;
+};
+
+inline float Wrap(float value, float lo, float hi) {
+  const float span = hi - lo;
+  float v = std::fmod(value - lo, span);
+  if (v < 0.0f) {
+    v += span;
+  }
+  return lo + v;
+}
+
+template <typename Fn>
+void ForEachStrip(int count, int threads, Fn&& fn) {
+  const int workers = std::clamp(threads, 1, std::max(count, 1));
+  if (workers == 1) {
+    for (int i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  std::atomic<int> next{0};
+  auto run = [&] {
+    for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+      fn(i);
+    }
+  };
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (int i = 1; i < workers; ++i) {
+    pool.emplace_back(run);
+  }
+  run();
+  for (std::thread& thread : pool) {
+    thread.join();
+  }
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+// Scene description
+// ----------------------------------------------------------------------------
+
+struct SyntheticMotionGenerator::Scene {
+  struct Object {
+    float x = 0.0f;           // centre at the scene start, px
+    float y = 0.0f;
+    float vx = 0.0f;          // px / frame
+    float vy = 0.0f;
+    float halfW = 0.0f;
+    float halfH = 0.0f;
+    bool disc = false;
+    uint32_t seed = 0;
+  };
+  struct Hud {
+    float x = 0.0f;
+    float y = 0.0f;
+    float w = 0.0f;
+    float h = 0.0f;
+    int kind = 0;             // 0 status bars, 1 minimap grid, 2 crosshair
+  };
+
+  double start = 0.0;
+  uint32_t seed = 0;
+  bool periodic = false;
+  float period = 0.0f;
+  float panX = 0.0f;          // px / frame
+  float panY = 0.0f;
+  float rotation = 0.0f;      // rad / frame
+  float zoom = 0.0f;          // log scale / frame
+  float margin = 0.0f;        // objects wrap around the frame plus this
+  std::vector<Object> objects;
+  std::vector<Hud> huds;
+};
+
+struct SyntheticMotionGenerator::Hit {
+  uint8_t layer = kLayerBackground;   // 0 background, 1 + object index, kLayerHud
+  int hud = -1;
+  float u = 0.0f;                     // texture coordinates of the layer
+  float v = 0.0f;
+};
+
+SyntheticMotionGenerator::SyntheticMotionGenerator() = default;
+SyntheticMotionGenerator::~SyntheticMotionGenerator() = default;
+
+const char* SyntheticScenarioName(SyntheticScenario scenario) {
+  switch (scenario) {
+    case SyntheticScenario::Pan:
+      return "Pan";
+    case SyntheticScenario::RotateZoom:
+      return "RotateZoom";
+    case SyntheticScenario::FastObjects:
+      return "FastObjects";
+    case SyntheticScenario::Periodic:
+      return "Periodic";
+    case SyntheticScenario::HudOverlay:
+      return "HudOverlay";
+    case SyntheticScenario::Fade:
+      return "Fade";
+    case SyntheticScenario::SceneCut:
+      return "SceneCut";
+    case SyntheticScenario::Count:
+      break;
+  }
+  return "";
+}
+
+bool ParseSyntheticScenario(const std::string& name, SyntheticScenario& scenario) {
+  std::string lower = name;
+  std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+  for (int i = 0; i < kSyntheticScenarioCount; ++i) {
+    std::string candidate = SyntheticScenarioName(static_cast<SyntheticScenario>(i));
+    std::transform(candidate.begin(), candidate.end(), candidate.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (lower == candidate) {
+      scenario = static_cast<SyntheticScenario>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+CpuFrame SyntheticSample::Frame(const std::vector<uint8_t>& pixels) const {
+  CpuFrame frame;
+  frame.data = pixels.data();
+  frame.pitch = static_cast<size_t>(width) * 4;
+  frame.width = width;
+  frame.height = height;
+  frame.format = PixelFormat::Bgra8;
+  frame.sequence = static_cast<uint64_t>(index);
+  return frame;
+}
+
+bool SyntheticMotionGenerator::Configure(const SyntheticSettings& settings) {
+  if (settings.width < 16 || settings.height < 16 || settings.width > kSyntheticMaxWidth ||
+      settings.height > kSyntheticMaxHeight) {
+    m_lastError = "size must be between 16x16 and 7680x4320";
+    return false;
+  }
+  if (settings.frames < 2) {
+    m_lastError = "need at least 2 frames";
+    return false;
+  }
+  if (static_cast<int>(settings.scenario) < 0 || settings.scenario >= SyntheticScenario::Count) {
+    m_lastError = "unknown scenario";
+    return false;
+  }
+  m_settings = settings;
+  m_settings.cutInterval = std::max(1, settings.cutInterval);
+  if (m_settings.threads <= 0) {
+    m_settings.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  }
+  m_unit = static_cast<float>(settings.height) / 1080.0f;
+  m_nextIndex = 0;
+
+  const float w = static_cast<float>(settings.width);
+  const float h = static_cast<float>(settings.height);
+  const float speed = m_unit * settings.motionScale;
+  const SyntheticScenario scenario = settings.scenario;
+  const int sceneCount = scenario == SyntheticScenario::SceneCut
+                             ? (settings.frames + m_settings.cutInterval - 1) / m_settings.cutInterval + 1
+                             : 1;
+  m_scenes.assign(sceneCount, Scene());
+  for (int s = 0; s < sceneCount; ++s) {
+    Scene& scene = m_scenes[s];
+    Rng rng((static_cast<uint64_t>(settings.seed) << 32) ^ (static_cast<uint64_t>(s) * 0x9E37u) ^
+            static_cast<uint64_t>(scenario) * 0x51ED27u);
+    scene.start = scenario == SyntheticScenario::SceneCut ? static_cast<double>(s) * m_settings.cutInterval : 0.0;
+    scene.seed = static_cast<uint32_t>(rng.NextU64());
+    scene.margin = 64.0f * m_unit;
+
+    auto pan = [&](float magnitude) {
+      const float angle = rng.Uniform(0.0f, static_cast<float>(2.0 * kPi));
+      scene.panX = magnitude * speed * std::cos(angle);
+      scene.panY = magnitude * speed * std::sin(angle);
+    };
+    auto addObjects = [&](int count, float minHalf, float maxHalf, float minSpeed, float maxSpeed) {
+      for (int i = 0; i < count; ++i) {
+        Scene::Object o;
+        o.x = rng.Uniform(0.0f, w);
+        o.y = rng.Uniform(0.0f, h);
+        const float angle = rng.Uniform(0.0f, static_cast<float>(2.0 * kPi));
+        const float v = rng.Uniform(minSpeed, maxSpeed) * speed;
+        o.vx = v * std::cos(angle);
+        o.vy = v * std::sin(angle);
+        o.halfW = rng.Uniform(minHalf, maxHalf) * m_unit;
+        o.halfH = o.halfW * rng.Uniform(0.6f, 1.4f);
+        o.disc = (rng.NextU64() & 1) != 0;
+        o.seed = static_cast<uint32_t>(rng.NextU64());
+        scene.margin = std::max(scene.margin, std::max(o.halfW, o.halfH) + 2.0f);
+        scene.objects.push_back(o);
+      }
+    };
+
+    switch (scenario) {
+      case SyntheticScenario::Pan:
+        pan(12.0f);
+        break;
+      case SyntheticScenario::RotateZoom:
+        scene.rotation = static_cast<float>(0.5 * kPi / 180.0) * settings.motionScale;
+        scene.zoom = std::log(1.012f) * settings.motionScale;
+        break;
+      case SyntheticScenario::FastObjects:
+        pan(3.0f);
+        addObjects(12, 12.0f, 40.0f, 25.0f, 60.0f);
+        break;
+      case SyntheticScenario::Periodic:
+        scene.periodic = true;
+        scene.period = 32.0f * m_unit;
+        // Above half a period per frame: the nearest match is the wrong one.
+        scene.panX = 20.0f * speed;
+        scene.panY = 2.0f * speed;
+        addObjects(2, 60.0f, 90.0f, 4.0f, 8.0f);
+        break;
+      case SyntheticScenario::HudOverlay:
+        pan(10.0f);
+        addObjects(2, 50.0f, 80.0f, 6.0f, 12.0f);
+        scene.huds.push_back({24.0f * m_unit, 24.0f * m_unit, 360.0f * m_unit, 72.0f * m_unit, 0});
+        scene.huds.push_back({w - 280.0f * m_unit, h - 280.0f * m_unit, 256.0f * m_unit, 256.0f * m_unit, 1});
+        scene.huds.push_back({w * 0.5f - 24.0f * m_unit, h * 0.5f - 24.0f * m_unit, 48.0f * m_unit, 48.0f * m_unit, 2});
+        break;
+      case SyntheticScenario::Fade:
+        pan(8.0f);
+        addObjects(2, 50.0f, 80.0f, 6.0f, 12.0f);
+        break;
+      case SyntheticScenario::SceneCut:
+        pan(10.0f);
+        addObjects(3, 30.0f, 70.0f, 6.0f, 20.0f);
+        break;
+      case SyntheticScenario::Count:
+        break;
+    }
+  }
+  return true;
+}
+
+int SyntheticMotionGenerator::SceneIndex(double time) const {
+  if (m_settings.scenario != SyntheticScenario::SceneCut) {
+    return 0;
+  }
+  const int index = static_cast<int>(std::floor(time / m_settings.cutInterval));
+  return std::clamp(index, 0, static_cast<int>(m_scenes.size()) - 1);
+}
+
+const SyntheticMotionGenerator::Scene& SyntheticMotionGenerator::SceneAt(double time) const {
+  return m_scenes[SceneIndex(time)];
+}
+
+bool SyntheticMotionGenerator::IsCut(int index) const {
+  return SceneIndex(index + 1) != SceneIndex(index);
+}
+
+float SyntheticMotionGenerator::Gain(double time) const {
+  if (m_settings.scenario != SyntheticScenario::Fade) {
+    return 1.0f;
+  }
+  // Down to 0.2 and back over 8 frames.
+  return static_cast<float>(0.2 + 0.8 * (0.5 + 0.5 * std::cos(2.0 * kPi * time / 8.0)));
+}
+
+// ----------------------------------------------------------------------------
+// Tracing
+// ----------------------------------------------------------------------------
+
+// Everything about the scene at one instant that does not depend on the pixel.
+struct SyntheticMotionGenerator::Pose {
+  const Scene* scene = nullptr;
+  float gain = 1.0f;
+  std::vector<float> objectX;     // wrapped object centres
+  std::vector<float> objectY;
+  // Background: screen = c + s R(theta) (world - c) + pan.
+  float cosTheta = 1.0f;
+  float sinTheta = 0.0f;
+  float scale = 1.0f;
+  float panX = 0.0f;
+  float panY = 0.0f;
+};
+
+SyntheticMotionGenerator::Pose SyntheticMotionGenerator::PoseAt(double time) const {
+  Pose pose;
+  pose.scene = &SceneAt(time);
+  pose.gain = Gain(time);
+  const Scene& scene = *pose.scene;
+  const float t = static_cast<float>(time - scene.start);
+  const float w = static_cast<float>(m_settings.width);
+  const float h = static_cast<float>(m_settings.height);
+  for (const Scene::Object& o : scene.objects) {
+    pose.objectX.push_back(Wrap(o.x + o.vx * t, -scene.margin, w + scene.margin));
+    pose.objectY.push_back(Wrap(o.y + o.vy * t, -scene.margin, h + scene.margin));
+  }
+  pose.cosTheta = std::cos(scene.rotation * t);
+  pose.sinTheta = std::sin(scene.rotation * t);
+  pose.scale = std::exp(scene.zoom * t);
+  pose.panX = scene.panX * t;
+  pose.panY = scene.panY * t;
+  return pose;
+}
+
+SyntheticMotionGenerator::Hit SyntheticMotionGenerator::Trace(const Pose& pose, float x, float y) const {
+  const Scene& scene = *pose.scene;
+  Hit hit;
+  for (size_t i = 0; i < scene.huds.size(); ++i) {
+    const Scene::Hud& hud = scene.huds[i];
+    if (x >= hud.x && x < hud.x + hud.w && y >= hud.y && y < hud.y + hud.h) {
+      hit.layer = kLayerHud;
+      hit.hud = static_cast<int>(i);
+      hit.u = x - hud.x;
+      hit.v = y - hud.y;
+      return hit;
+    }
+  }
+  for (int i = static_cast<int>(scene.objects.size()) - 1; i >= 0; --i) {
+    const Scene::Object& o = scene.objects[i];
+    const float lx = x - pose.objectX[i];
+    const float ly = y - pose.objectY[i];
+    const bool inside = o.disc ? (lx * lx) / (o.halfW * o.halfW) + (ly * ly) / (o.halfH * o.halfH) < 1.0f
+                               : std::fabs(lx) < o.halfW && std::fabs(ly) < o.halfH;
+    if (inside) {
+      hit.layer = static_cast<uint8_t>(1 + i);
+      hit.u = lx;
+      hit.v = ly;
+      return hit;
+    }
+  }
+  const float cx = 0.5f * m_settings.width;
+  const float cy = 0.5f * m_settings.height;
+  const float dx = x - cx - pose.panX;
+  const float dy = y - cy - pose.panY;
+  hit.u = cx + (pose.cosTheta * dx + pose.sinTheta * dy) / pose.scale;
+  hit.v = cy + (-pose.sinTheta * dx + pose.cosTheta * dy) / pose.scale;
+  return hit;
+}
+
+void SyntheticMotionGenerator::ShadeRows(const Pose& pose, int y0, int y1, uint8_t* bgra) const {
+  const Scene& scene = *pose.scene;
+  const int width = m_settings.width;
+  for (int y = y0; y < y1; ++y) {
+    uint8_t* row = bgra + static_cast<size_t>(y) * width * 4;
+    for (int x = 0; x < width; ++x) {
+      const Hit hit = Trace(pose, static_cast<float>(x), static_cast<float>(y));
+      Rgb color;
+      if (hit.layer == kLayerHud) {
+        const Scene::Hud& hud = scene.huds[hit.hud];
+        const float cell = 8.0f * m_unit;
+        const int cu = static_cast<int>(hit.u / cell);
+        const int cv = static_cast<int>(hit.v / cell);
+        float luma = 40.0f;
+        if (hud.kind == 0) {
+          // Status bars: three filled bars with a text-like glyph column.
+          const int bar = static_cast<int>(hit.v / (hud.h / 3.0f));
+          const float fill = 0.35f + 0.2f * bar;
+          luma = hit.u < hud.w * fill ? 200.0f : ((Hash(cu, cv, 77) & 3) == 0 ? 230.0f : 40.0f);
+        } else if (hud.kind == 1) {
+          luma = (cu % 4 == 0 || cv % 4 == 0) ? 180.0f : 30.0f + 30.0f * ((Hash(cu / 4, cv / 4, 91) & 1) != 0);
+        } else {
+          const float mid = 0.5f * hud.w;
+          luma = (std::fabs(hit.u - mid) < 1.5f * m_unit || std::fabs(hit.v - mid) < 1.5f * m_unit) ? 250.0f : 20.0f;
+        }
+        color = {luma, luma, luma * 0.8f};
+      } else if (hit.layer != kLayerBackground) {
+        const Scene::Object& o = scene.objects[hit.layer - 1];
+        color = NoiseTexture(hit.u + 1000.0f * m_unit, hit.v + 1000.0f * m_unit, o.seed, m_unit * 0.5f);
+        color = {255.0f - color.r, 255.0f - color.g, 255.0f - color.b};
+      } else if (scene.periodic) {
+        color = PeriodicTexture(hit.u, hit.v, scene.period, scene.seed, m_unit);
+      } else {
+        color = NoiseTexture(hit.u, hit.v, scene.seed, m_unit);
+      }
+      // HUD elements are composited after the fade, like a game's UI.
+      const float g = hit.layer == kLayerHud ? 1.0f : pose.gain;
+      uint8_t* p = row + static_cast<size_t>(x) * 4;
+      p[0] = static_cast<uint8_t>(std::clamp(color.b * g + 0.5f, 0.0f, 255.0f));
+      p[1] = static_cast<uint8_t>(std::clamp(color.g * g + 0.5f, 0.0f, 255.0f));
+      p[2] = static_cast<uint8_t>(std::clamp(color.r * g + 0.5f, 0.0f, 255.0f));
+      p[3] = 255;
+    }
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Rendering
+// ----------------------------------------------------------------------------
+
+void SyntheticMotionGenerator::RenderFrame(double time, std::vector<uint8_t>& bgra) const {
+  bgra.resize(static_cast<size_t>(m_settings.width) * m_settings.height * 4);
+  const Pose pose = PoseAt(time);
+  const int strips = (m_settings.height + kStripRows - 1) / kStripRows;
+  ForEachStrip(strips, m_settings.threads, [&](int s) {
+    ShadeRows(pose, s * kStripRows, std::min(m_settings.height, (s + 1) * kStripRows), bgra.data());
+  });
+}
+
+bool SyntheticMotionGenerator::RenderTruth(int index, FlowField& flow, std::vector<uint8_t>& occlusion) const {
+  const int width = m_settings.width;
+  const int height = m_settings.height;
+  flow.Resize(width, height);
+  occlusion.assign(static_cast<size_t>(width) * height, 255);
+  if (IsCut(index)) {
+    std::fill(flow.uv.begin(), flow.uv.end(), kFlowUnknown * 10.0f);
+    return false;
+  }
+  const Pose from = PoseAt(index);
+  const Pose to = PoseAt(index + 1.0);
+  const Scene& scene = *from.scene;
+  const float w = static_cast<float>(width);
+  const float h = static_cast<float>(height);
+  const float cx = 0.5f * w;
+  const float cy = 0.5f * h;
+  // Wrapping to the other edge is a disappearance, not motion.
+  std::vector<uint8_t> wrapped(scene.objects.size());
+  for (size_t i = 0; i < scene.objects.size(); ++i) {
+    const Scene::Object& o = scene.objects[i];
+    wrapped[i] = std::fabs(to.objectX[i] - from.objectX[i] - o.vx) > 0.5f ||
+                 std::fabs(to.objectY[i] - from.objectY[i] - o.vy) > 0.5f;
+  }
+
+  const int strips = (height + kStripRows - 1) / kStripRows;
+  ForEachStrip(strips, m_settings.threads, [&](int s) {
+    const int y1 = std::min(height, (s + 1) * kStripRows);
+    for (int y = s * kStripRows; y < y1; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const float fx = static_cast<float>(x);
+        const float fy = static_cast<float>(y);
+        const Hit hit = Trace(from, fx, fy);
+        float tx = fx;
+        float ty = fy;
+        bool lost = false;
+        if (hit.layer == kLayerHud) {
+          // Static: zero motion, never covered.
+        } else if (hit.layer != kLayerBackground) {
+          const Scene::Object& o = scene.objects[hit.layer - 1];
+          tx = fx + o.vx;
+          ty = fy + o.vy;
+          lost = wrapped[hit.layer - 1] != 0;
+        } else {
+          const float dx = hit.u - cx;
+          const float dy = hit.v - cy;
+          tx = cx + (to.cosTheta * dx - to.sinTheta * dy) * to.scale + to.panX;
+          ty = cy + (to.sinTheta * dx + to.cosTheta * dy) * to.scale + to.panY;
+        }
+        const size_t i = static_cast<size_t>(y) * width + x;
+        flow.uv[i * 2 + 0] = tx - fx;
+        flow.uv[i * 2 + 1] = ty - fy;
+        const bool outside = tx < 0.0f || ty < 0.0f || tx > w - 1.0f || ty > h - 1.0f;
+        const bool covered = !outside && Trace(to, tx, ty).layer != hit.layer;
+        occlusion[i] = (lost || outside || covered) ? 255 : 0;
+      }
+    }
+  });
+  return true;
+}
+
+bool SyntheticMotionGenerator::Next(SyntheticSample& sample, bool withTruth, bool withMiddle) {
+  if (m_nextIndex >= PairCount()) {
+    return false;
+  }
+  const int index = m_nextIndex++;
+  const bool continues = index > 0 && sample.index == index - 1 && sample.width == m_settings.width &&
+                         sample.height == m_settings.height && !sample.next.empty();
+  sample.width = m_settings.width;
+  sample.height = m_settings.height;
+  if (continues) {
+    std::swap(sample.prev, sample.next);
+  } else {
+    RenderFrame(index, sample.prev);
+  }
+  sample.index = index;
+  RenderFrame(index + 1, sample.next);
+  if (withMiddle) {
+    RenderFrame(index + 0.5, sample.middle);
+  } else {
+    sample.middle.clear();
+  }
+  sample.sceneCut = IsCut(index);
+  sample.prevGain = Gain(index);
+  sample.nextGain = Gain(index + 1);
+  if (withTruth) {
+    RenderTruth(index, sample.flow, sample.occlusion);
+  } else {
+    sample.flow = FlowField();
+    sample.occlusion.clear();
+  }
+  return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "cpu_frame.h"
+#include "flow_io.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Procedural motion clips with exact ground truth, rendered in memory for
+// benchmarks and flow evaluation.
+//
+// A clip is a layered scene evaluated in continuous time: a textured
+// background under an affine camera (pan, rotation, zoom), moving textured
+// objects, and static HUD overlays on top. Every pixel is point sampled
+// from the scene, so
+//
+//  - the true middle frame of a pair is the scene rendered at t + 0.5,
+//  - forward flow is the exact screen motion of the surface under each
+//    pixel from t to t + 1,
+//  - a pixel is occluded when that surface point leaves the frame or is
+//    covered by another layer at t + 1.
+//
+// Speeds and texture scales are given for 1080p and scale with the height,
+// so a scenario looks the same at every resolution up to 8K. A pair across
+// a scene cut has unknown flow (kFlowUnknown) and every pixel occluded; its
+// middle frame still belongs to the first scene. Fades change brightness
+// only, so their flow is the geometric motion.
+//
+// Rendering is split into row strips over worker threads; results do not
+// depend on the thread count.
+
+enum class SyntheticScenario : int {
+  Pan = 0,             // global camera pan
+  RotateZoom = 1,      // rotation and zoom about the centre
+  FastObjects = 2,     // small objects moving far faster than the background
+  Periodic = 3,        // repeating grating, motion above half its period
+  HudOverlay = 4,      // panning scene under static UI elements
+  Fade = 5,            // pan with a fade to dark and back
+  SceneCut = 6,        // pan with a hard cut every few frames
+  Count,
+};
+
+constexpr int kSyntheticScenarioCount = static_cast<int>(SyntheticScenario::Count);
+constexpr int kSyntheticMaxWidth = 7680;
+constexpr int kSyntheticMaxHeight = 4320;
+
+const char* SyntheticScenarioName(SyntheticScenario scenario);
+// Accepts the names above in lower case ("pan", "rotatezoom", ...).
+bool ParseSyntheticScenario(const std::string& name, SyntheticScenario& scenario);
+
+struct SyntheticSettings {
+  SyntheticScenario scenario = SyntheticScenario::Pan;
+  int width = 1280;
+  int height = 720;
+  int frames = 8;
+  uint32_t seed = 1;
+  float motionScale = 1.0f;     // multiplies every speed
+  int cutInterval = 4;          // SceneCut: frames per scene
+  int threads = 0;              // 0: hardware concurrency
+};
+
+// One step of the stream: frames index and index + 1 with their ground truth.
+struct SyntheticSample {
+  int index = 0;
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> prev;        // Bgra8, rows tightly packed
+  std::vector<uint8_t> next;
+  std::vector<uint8_t> middle;      // true frame at index + 0.5
+  FlowField flow;                   // prev -> next, full resolution
+  std::vector<uint8_t> occlusion;   // 255 where a prev pixel has no match in next
+  bool sceneCut = false;            // next starts a new scene; flow unknown
+  float prevGain = 1.0f;            // fade brightness of prev / next
+  float nextGain = 1.0f;
+
+  CpuFrame Prev() const { return Frame(prev); }
+  CpuFrame Next() const { return Frame(next); }
+  CpuFrame Middle() const { return Frame(middle); }
+
+private:
+  CpuFrame Frame(const std::vector<uint8_t>& pixels) const;
+};
+
+class SyntheticMotionGenerator {
+public:
+  SyntheticMotionGenerator();
+  ~SyntheticMotionGenerator();
+  SyntheticMotionGenerator(const SyntheticMotionGenerator&) = delete;
+  SyntheticMotionGenerator& operator=(const SyntheticMotionGenerator&) = delete;
+
+  // Sizes 16x16 up to kSyntheticMaxWidth x kSyntheticMaxHeight, 2+ frames.
+  bool Configure(const SyntheticSettings& settings);
+  const SyntheticSettings& Settings() const { return m_settings; }
+  const std::string& GetLastError() const { return m_lastError; }
+
+  // Random access. Buffers are resized as needed.
+  void RenderFrame(double time, std::vector<uint8_t>& bgra) const;
+  // Flow and occlusion from frame index to index + 1. False across a cut.
+  bool RenderTruth(int index, FlowField& flow, std::vector<uint8_t>& occlusion) const;
+  float Gain(double time) const;
+  bool IsCut(int index) const;      // index + 1 starts a new scene
+
+  // Streaming: pairs (0,1), (1,2), ..., PairCount() samples, reusing the
+  // sample's buffers (next becomes prev without re-rendering).
+  void Rewind() { m_nextIndex = 0; }
+  bool Next(SyntheticSample& sample, bool withTruth = true, bool withMiddle = true);
+  int PairCount() const { return m_settings.frames - 1; }
+
+private:
+  struct Scene;
+  struct Pose;
+  struct Hit;
+
+  const Scene& SceneAt(double time) const;
+  int SceneIndex(double time) const;
+  Pose PoseAt(double time) const;
+  Hit Trace(const Pose& pose, float x, float y) const;
+  void ShadeRows(const Pose& pose, int y0, int y1, uint8_t* bgra) const;
+
+  SyntheticSettings m_settings;
+  std::vector<Scene> m_scenes;
+  float m_unit = 1.0f;                  // pixels per 1080p pixel
+  int m_nextIndex = 0;
+  std::string m_lastError;
+};
@@ -0,0 +1,251 @@
+#include "telemetry.h"
+
+#include "deadline_wait.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+const char* TelemetryPathName(TelemetryPath path) {
+  switch (path) {
+    case TelemetryPath::Idle:
+      return "Idle";
+    case TelemetryPath::Interpolated:
+      return "Interpolated";
+    case TelemetryPath::CachedOutput:
+      return "CachedOutput";
+    case TelemetryPath::Blit:
+      return "Blit";
+    case TelemetryPath::Passthrough:
+      return "Passthrough";
+    case TelemetryPath::Debug:
+      return "Debug";
+    case TelemetryPath::Count:
+      break;
+  }
+  return "";
+}
+
+const char* TelemetryDropName(TelemetryDrop drop) {
+  switch (drop) {
+    case TelemetryDrop::SourceSkipped:
+      return "SourceSkipped";
+    case TelemetryDrop::CaptureQueue:
+      return "CaptureQueue";
+    case TelemetryDrop::QueueOverflow:
+      return "QueueOverflow";
+    case TelemetryDrop::Duplicate:
+      return "Duplicate";
+    case TelemetryDrop::Stale:
+      return "Stale";
+    case TelemetryDrop::PacingTrim:
+      return "PacingTrim";
+    case TelemetryDrop::PresentBusy:
+      return "PresentBusy";
+    case TelemetryDrop::Count:
+      break;
+  }
+  return "";
+}
+
+// ----------------------------------------------------------------------------
+// TelemetryRing
+// ----------------------------------------------------------------------------
+
+TelemetryRing::TelemetryRing() : m_records(new TelemetryRecord[kCapacity]) {}
+
+bool TelemetryRing::Push(const TelemetryRecord& record) {
+  const uint64_t head = m_head.load(std::memory_order_relaxed);
+  if (head - m_tail.load(std::memory_order_acquire) >= kCapacity) {
+    return false;
+  }
+  m_records[head % kCapacity] = record;
+  m_head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+size_t TelemetryRing::Pop(std::vector<TelemetryRecord>& out, size_t maxRecords) {
+  const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+  const uint64_t head = m_head.load(std::memory_order_acquire);
+  const size_t count = static_cast<size_t>(std::min<uint64_t>(head - tail, maxRecords));
+  for (size_t i = 0; i < count; ++i) {
+    out.push_back(m_records[(tail + i) % kCapacity]);
+  }
+  m_tail.store(tail + count, std::memory_order_release);
+  return count;
+}
+
+size_t TelemetryRing::Size() const {
+  return static_cast<size_t>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+}
+
+// ----------------------------------------------------------------------------
+// TelemetryWriter
+// ----------------------------------------------------------------------------
+
+bool TelemetryWriter::Start(const std::string& path) {
+  Stop();
+  m_file = std::fopen(path.c_str(), "wb");
+  if (!m_file) {
+    return false;
+  }
+  TelemetryFileHeader header;
+  header.startUnixMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+  header.startSec = DeadlineWaiter::Now();
+  if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+    std::fclose(m_file);
+    m_file = nullptr;
+    return false;
+  }
+  // Anything left from an earlier session belongs to its file.
+  std::vector<TelemetryRecord> discard;
+  while (m_ring.Pop(discard, kBatchRecords) > 0) {
+    discard.clear();
+  }
+  m_path = path;
+  m_batch.reserve(kBatchRecords);
+  m_submitted.store(0, std::memory_order_relaxed);
+  m_dropped.store(0, std::memory_order_relaxed);
+  m_written.store(0, std::memory_order_relaxed);
+  m_bytes.store(sizeof(header), std::memory_order_relaxed);
+  m_failed.store(false, std::memory_order_relaxed);
+  m_stopping = false;
+  m_thread = std::thread(&TelemetryWriter::WriterLoop, this);
+  return true;
+}
+
+void TelemetryWriter::Stop() {
+  if (!m_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_cv.notify_one();
+  m_thread.join();
+  if (m_file) {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+}
+
+bool TelemetryWriter::Submit(const TelemetryRecord& record) {
+  if (!m_thread.joinable()) {
+    return false;
+  }
+  m_submitted.fetch_add(1, std::memory_order_relaxed);
+  if (!m_ring.Push(record)) {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void TelemetryWriter::Drain() {
+  while (true) {
+    m_batch.clear();
+    if (m_ring.Pop(m_batch, kBatchRecords) == 0) {
+      return;
+    }
+    if (m_failed.load(std::memory_order_relaxed)) {
+      continue;   // keep the ring moving; the records are lost either way
+    }
+    const size_t bytes = m_batch.size() * sizeof(TelemetryRecord);
+    if (std::fwrite(m_batch.data(), 1, bytes, m_file) != bytes) {
+      m_failed.store(true, std::memory_order_relaxed);
+      continue;
+    }
+    m_written.fetch_add(m_batch.size(), std::memory_order_relaxed);
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+}
+
+void TelemetryWriter::WriterLoop() {
+  // The producer does not signal (that would need the lock); the writer
+  // polls. At 240 Hz, 50 ms is ~12 records, well inside the ring.
+  constexpr auto kPollInterval = std::chrono::milliseconds(50);
+  while (true) {
+    bool stopping = false;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait_for(lock, kPollInterval, [this] { return m_stopping; });
+      stopping = m_stopping;
+    }
+    Drain();
+    if (stopping) {
+      std::fflush(m_file);
+      return;
+    }
+  }
+}
+
+TelemetryWriterStats TelemetryWriter::Stats() const {
+  TelemetryWriterStats stats;
+  stats.submitted = m_submitted.load(std::memory_order_relaxed);
+  stats.written = m_written.load(std::memory_order_relaxed);
+  stats.dropped = m_dropped.load(std::memory_order_relaxed);
+  stats.bytes = m_bytes.load(std::memory_order_relaxed);
+  stats.failed = m_failed.load(std::memory_order_relaxed);
+  return stats;
+}
+
+// ----------------------------------------------------------------------------
+// TelemetryReader
+// ----------------------------------------------------------------------------
+
+bool TelemetryReader::Open(const std::string& path) {
+  Close();
+  m_file = std::fopen(path.c_str(), "rb");
+  if (!m_file) {
+    m_lastError = "cannot open " + path;
+    return false;
+  }
+  TelemetryFileHeader header;
+  if (std::fread(&header, sizeof(header), 1, m_file) != 1 || std::memcmp(header.magic, "TMTL", 4) != 0) {
+    m_lastError = path + " is not a telemetry log";
+    Close();
+    return false;
+  }
+  const TelemetryFileHeader expected;
+  if (header.version != expected.version || header.recordBytes != expected.recordBytes ||
+      header.dropReasons != expected.dropReasons) {
+    m_lastError = path + ": unsupported telemetry version " + std::to_string(header.version);
+    Close();
+    return false;
+  }
+  m_header = header;
+  m_buffer.resize(sizeof(TelemetryRecord) * 4096);
+  m_bufferPos = 0;
+  m_bufferEnd = 0;
+  return true;
+}
+
+void TelemetryReader::Close() {
+  if (m_file) {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+  m_bufferPos = 0;
+  m_bufferEnd = 0;
+}
+
+bool TelemetryReader::Next(TelemetryRecord& record) {
+  if (!m_file) {
+    return false;
+  }
+  if (m_bufferEnd - m_bufferPos < sizeof(TelemetryRecord)) {
+    // Keep a partial record from the previous read in front of the next one.
+    const size_t left = m_bufferEnd - m_bufferPos;
+    std::memmove(m_buffer.data(), m_buffer.data() + m_bufferPos, left);
+    m_bufferPos = 0;
+    m_bufferEnd = left + std::fread(m_buffer.data() + left, 1, m_buffer.size() - left, m_file);
+    if (m_bufferEnd < sizeof(TelemetryRecord)) {
+      return false;
+    }
+  }
+  std::memcpy(&record, m_buffer.data() + m_bufferPos, sizeof(TelemetryRecord));
+  m_bufferPos += sizeof(TelemetryRecord);
+  return true;
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stage_timer.h"
+
+// Per-present telemetry log (.tmtl).
+//
+// The render loop fills one TelemetryRecord per output frame and pushes it
+// into a single-producer ring; a writer thread drains the ring to disk in
+// batches. The producer never locks, allocates or touches the file: a full
+// ring drops the record and counts it.
+//
+// Layout (little endian): TelemetryFileHeader, then TelemetryRecords back to
+// back. There is no index or trailer, so a log whose writer died is valid up
+// to its last whole record.
+
+enum class TelemetryPath : uint8_t {
+  Idle = 0,           // nothing queued, back buffer cleared
+  Interpolated = 1,   // generated this present
+  CachedOutput = 2,   // output cache hit
+  Blit = 3,           // scaled source frame
+  Passthrough = 4,    // source frame as is
+  Debug = 5,
+  Count,
+};
+
+const char* TelemetryPathName(TelemetryPath path);
+
+// Why source frames never reached the screen, counted between presents.
+enum class TelemetryDrop : uint8_t {
+  SourceSkipped = 0,  // producer overwrote frames before capture read them
+  CaptureQueue = 1,   // WGC frame queue dropped
+  QueueOverflow = 2,  // capture queue full before the render loop took it
+  Duplicate = 3,      // timestamp not newer than the previous frame
+  Stale = 4,          // display time already past the frame
+  PacingTrim = 5,     // trimmed to the pacing buffer depth
+  PresentBusy = 6,    // DO_NOT_WAIT present refused
+  Count,
+};
+
+constexpr int kTelemetryDropCount = static_cast<int>(TelemetryDrop::Count);
+
+const char* TelemetryDropName(TelemetryDrop drop);
+
+enum TelemetryFlags : uint8_t {
+  kTelemetryPresented = 1 << 0,       // Present was called
+  kTelemetryPresentSkipped = 1 << 1,  // same output as on screen, not presented
+  kTelemetryVrrHold = 1 << 2,         // VRR re-present to stay above the floor
+  kTelemetryNewPair = 1 << 3,         // first present of a source pair
+  kTelemetryHasPair = 1 << 4,         // prev/curr frames were both available
+};
+
+// Capture-clock times are the DisplayClock capture domain in 100 ns units
+// (the source timestamps); presentSec is QPC seconds.
+//
+// Stage times are StageProfiler frames, tagged with the frame number: CPU
+// times arrive on the present that generated the frame, GPU times a few
+// presents later once their queries resolve, so a reader joins the two on
+// the tag rather than on the record.
+struct TelemetryRecord {
+  uint64_t frame = 0;               // present counter since logging started
+  double presentSec = 0.0;          // after Present returned
+  int64_t presentTime100ns = 0;     // the same instant on the capture clock
+  int64_t displayTime100ns = 0;     // content time the output represents
+  int64_t currTime100ns = 0;        // newest source frame of the pair
+  float alpha = 0.0f;
+  float pairIntervalMs = 0.0f;      // interval used for alpha
+  float waitMs = 0.0f;              // pacing wait before dispatch
+  float generateMs = 0.0f;          // CPU time of frame generation (0 if none)
+  float presentMs = 0.0f;           // Present call
+  uint8_t queueDepth = 0;           // frames queued at dispatch
+  uint8_t path = 0;                 // TelemetryPath
+  uint8_t flags = 0;                // TelemetryFlags
+  uint8_t reserved = 0;
+  uint32_t resourceKiB = 0;         // interpolator GPU allocations (ResourceRegistry)
+  std::array<uint32_t, kTelemetryDropCount> drops = {};
+  uint64_t stageCpuFrame = 0;       // profiler frame of stageCpuMs, 0 = none
+  uint64_t stageGpuFrame = 0;       // profiler frame of stageGpuMs, 0 = none
+  std::array<float, kPipelineStageCount> stageCpuMs = {};
+  std::array<float, kPipelineStageCount> stageGpuMs = {};
+};
+
+static_assert(kPipelineStageCount == 16, "stage times are part of the telemetry file format");
+static_assert(sizeof(TelemetryRecord) == 240, "telemetry record layout is part of the file format");
+
+struct TelemetryFileHeader {
+  char magic[4] = {'T', 'M', 'T', 'L'};
+  uint32_t version = 1;
+  uint32_t recordBytes = sizeof(TelemetryRecord);
+  uint32_t dropReasons = kTelemetryDropCount;
+  int64_t startUnixMs = 0;          // wall clock when logging started
+  double startSec = 0.0;            // QPC seconds at the same instant
+};
+
+static_assert(sizeof(TelemetryFileHeader) == 32, "telemetry header layout is part of the file format");
+
+// Fixed-capacity single-producer / single-consumer ring.
+class TelemetryRing {
+public:
+  static constexpr uint32_t kCapacity = 8192;   // ~30 s at 240 Hz
+
+  TelemetryRing();
+
+  // Producer. False when full.
+  bool Push(const TelemetryRecord& record);
+  // Consumer. Appends up to maxRecords, returns how many.
+  size_t Pop(std::vector<TelemetryRecord>& out, size_t maxRecords);
+  size_t Size() const;
+
+private:
+  alignas(64) std::atomic<uint64_t> m_head{0};   // next write
+  alignas(64) std::atomic<uint64_t> m_tail{0};   // next read
+  std::unique_ptr<TelemetryRecord[]> m_records;
+};
+
+struct TelemetryWriterStats {
+  uint64_t submitted = 0;
+  uint64_t written = 0;
+  uint64_t dropped = 0;             // ring full at Submit
+  uint64_t bytes = 0;
+  bool failed = false;              // write error; the writer stopped writing
+};
+
+class TelemetryWriter {
+public:
+  ~TelemetryWriter() { Stop(); }
+
+  bool Start(const std::string& path);
+  // Drains the ring, then closes the file.
+  void Stop();
+  bool IsRecording() const { return m_thread.joinable(); }
+
+  // Render thread. Lock-free; false when the record was dropped.
+  bool Submit(const TelemetryRecord& record);
+
+  TelemetryWriterStats Stats() const;
+  const std::string& Path() const { return m_path; }
+
+private:
+  static constexpr size_t kBatchRecords = 1024;
+
+  void WriterLoop();
+  void Drain();
+
+  TelemetryRing m_ring;
+  std::FILE* m_file = nullptr;
+  std::string m_path;
+  std::vector<TelemetryRecord> m_batch;
+
+  std::atomic<uint64_t> m_submitted{0};
+  std::atomic<uint64_t> m_dropped{0};
+  std::atomic<uint64_t> m_written{0};
+  std::atomic<uint64_t> m_bytes{0};
+  std::atomic<bool> m_failed{false};
+
+  std::mutex m_mutex;               // only between Stop and the writer
+  std::condition_variable m_cv;
+  bool m_stopping = false;
+  std::thread m_thread;
+};
+
+// Streams a log in batches; hours-long sessions never load in full.
+class TelemetryReader {
+public:
+  ~TelemetryReader() { Close(); }
+
+  bool Open(const std::string& path);
+  void Close();
+
+  const TelemetryFileHeader& Header() const { return m_header; }
+  // False at the end of the file (a trailing partial record is ignored).
+  bool Next(TelemetryRecord& record);
+  const std::string& GetLastError() const { return m_lastError; }
+
+private:
+  std::FILE* m_file = nullptr;
+  TelemetryFileHeader m_header;
+  std::vector<uint8_t> m_buffer;
+  size_t m_bufferPos = 0;
+  size_t m_bufferEnd = 0;
+  std::string m_lastError;
+};
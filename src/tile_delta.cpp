@@ -0,0 +1,273 @@
+#include "tile_delta.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// xxHash64 constants. Four independent lanes with one multiply per word keep
+// the hash at memory speed; each round is a bijection of the lane, so a
+// change confined to one word always changes the tile hash.
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+
+inline uint64_t Rotl(uint64_t v, int r) {
+  return (v << r) | (v >> (64 - r));
+}
+
+inline uint64_t Round(uint64_t acc, uint64_t input) {
+  return Rotl(acc ^ input, 31) * kPrime1;
+}
+
+inline uint64_t Load64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Per-tile hash state: four lanes, updated one tile row at a time.
+inline void HashInit(uint64_t* v) {
+  v[0] = kPrime1 + kPrime2;
+  v[1] = kPrime2;
+  v[2] = 0;
+  v[3] = 0 - kPrime1;
+}
+
+inline void HashRow(uint64_t* v, const uint8_t* p, size_t bytes) {
+  uint64_t v1 = v[0], v2 = v[1], v3 = v[2], v4 = v[3];
+  size_t i = 0;
+  for (; i + 32 <= bytes; i += 32) {
+    v1 = Round(v1, Load64(p + i));
+    v2 = Round(v2, Load64(p + i + 8));
+    v3 = Round(v3, Load64(p + i + 16));
+    v4 = Round(v4, Load64(p + i + 24));
+  }
+  for (; i + 8 <= bytes; i += 8) {
+    v1 = Round(v1, Load64(p + i));
+  }
+  if (i < bytes) {
+    uint64_t tail = 0;
+    std::memcpy(&tail, p + i, bytes - i);
+    v2 = Round(v2, tail);
+  }
+  v[0] = v1;
+  v[1] = v2;
+  v[2] = v3;
+  v[3] = v4;
+}
+
+inline uint64_t HashFinish(const uint64_t* v) {
+  uint64_t h = Rotl(v[0], 1) + Rotl(v[1], 7) + Rotl(v[2], 12) + Rotl(v[3], 18);
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+
+void CopyTile(const uint8_t* src, size_t srcPitch, uint8_t* dst, size_t dstPitch, size_t rowBytes, uint32_t rows) {
+  for (uint32_t y = 0; y < rows; ++y) {
+    std::memcpy(dst + dstPitch * y, src + srcPitch * y, rowBytes);
+  }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// TileDeltaEncoder
+// ----------------------------------------------------------------------------
+
+void TileDeltaEncoder::Reset(uint32_t width, uint32_t height, uint32_t bytesPerPixel) {
+  m_width = width;
+  m_height = height;
+  m_bytesPerPixel = std::max(bytesPerPixel, 1u);
+  m_tilesX = TilesFor(width);
+  m_tilesY = TilesFor(height);
+  size_t count = static_cast<size_t>(m_tilesX) * m_tilesY;
+  m_hashes.assign(count, 0);
+  m_stamps.assign(count, 0);
+  m_lanes.assign(static_cast<size_t>(m_tilesX) * 4, 0);
+  m_primed = false;
+  m_unhashedFrames = 0;
+  m_lumaEnabled = false;
+}
+
+bool TileDeltaEncoder::EnableLuma(PixelFormat format) {
+  m_lumaEnabled = (format == PixelFormat::Bgra8 || format == PixelFormat::Rgba8) && m_bytesPerPixel == 4;
+  m_lumaFormat = format;
+  return m_lumaEnabled;
+}
+
+uint64_t TileDeltaEncoder::HashBand(const uint8_t* src, size_t srcPitch, uint32_t rows, uint64_t frame,
+                                    uint64_t* hashes, uint64_t* stamps) {
+  // Hash the band row by row so the reads stay sequential; each tile keeps
+  // its own lanes. The band is then still in cache for the copy.
+  uint64_t* lanes = m_lanes.data();
+  for (uint32_t tx = 0; tx < m_tilesX; ++tx) {
+    HashInit(lanes + tx * 4);
+  }
+  const size_t tileBytes = static_cast<size_t>(kTileSize) * m_bytesPerPixel;
+  const size_t lastBytes = static_cast<size_t>(m_width - (m_tilesX - 1) * kTileSize) * m_bytesPerPixel;
+  for (uint32_t y = 0; y < rows; ++y) {
+    const uint8_t* row = src + srcPitch * y;
+    for (uint32_t tx = 0; tx + 1 < m_tilesX; ++tx) {
+      HashRow(lanes + tx * 4, row + tileBytes * tx, tileBytes);
+    }
+    HashRow(lanes + (m_tilesX - 1) * 4, row + tileBytes * (m_tilesX - 1), lastBytes);
+  }
+
+  uint64_t changed = 0;
+  for (uint32_t tx = 0; tx < m_tilesX; ++tx) {
+    uint64_t hash = HashFinish(lanes + tx * 4);
+    if (!m_primed || hash != hashes[tx]) {
+      hashes[tx] = hash;
+      stamps[tx] = frame;
+      changed++;
+    }
+  }
+  return changed;
+}
+
+void TileDeltaEncoder::Encode(const uint8_t* src, size_t srcPitch, uint64_t frame,
+                              uint8_t* slot, size_t slotPitch, uint64_t slotFrame, uint64_t* slotStamps,
+                              uint8_t* slotLuma, size_t lumaPitch) {
+  auto start = std::chrono::steady_clock::now();
+  uint64_t changed = 0;
+  uint64_t written = 0;
+  uint64_t bytes = 0;
+  const bool luma = m_lumaEnabled && slotLuma;
+
+  // While nearly every tile changes (camera motion) hashing cannot save a
+  // copy, so it is skipped and everything is treated as changed. The stale
+  // hashes are then useless: the next hashed frame re-primes them and the
+  // one after decides again.
+  const bool hashFrame = m_unhashedFrames == 0;
+  const bool compared = hashFrame && m_primed;
+  if (!hashFrame) {
+    m_unhashedFrames--;
+    std::fill(m_stamps.begin(), m_stamps.end(), frame);
+    m_primed = false;
+    changed = m_stamps.size();
+  }
+
+  for (uint32_t ty = 0; ty < m_tilesY; ++ty) {
+    uint32_t y0 = ty * kTileSize;
+    uint32_t rows = std::min(kTileSize, m_height - y0);
+    uint64_t* stamps = m_stamps.data() + static_cast<size_t>(ty) * m_tilesX;
+    if (hashFrame) {
+      changed += HashBand(src + srcPitch * y0, srcPitch, rows, frame,
+                          m_hashes.data() + static_cast<size_t>(ty) * m_tilesX, stamps);
+    }
+
+    // Copy runs of stale tiles a whole row at a time: per-tile copies
+    // stride across 64 pages and run at a fraction of memcpy speed.
+    uint32_t tx = 0;
+    while (tx < m_tilesX) {
+      if (slotFrame != 0 && stamps[tx] <= slotFrame) {
+        tx++;
+        continue;
+      }
+      uint32_t runStart = tx;
+      while (tx < m_tilesX && (slotFrame == 0 || stamps[tx] > slotFrame)) {
+        tx++;
+      }
+      size_t offset = static_cast<size_t>(runStart) * kTileSize * m_bytesPerPixel;
+      size_t runBytes = static_cast<size_t>(std::min(tx * kTileSize, m_width) - runStart * kTileSize) * m_bytesPerPixel;
+      if (luma) {
+        // Copy with the fused 2x2 luma; runs start on even pixels, so the
+        // plane texels of different runs never overlap.
+        PixelConvertParams p;
+        p.srcFormat = m_lumaFormat;
+        p.dstFormat = m_lumaFormat;
+        p.width = static_cast<uint32_t>(runBytes / m_bytesPerPixel);
+        p.height = rows;
+        p.src = src + srcPitch * y0 + offset;
+        p.srcPitch = srcPitch;
+        p.dst = slot + slotPitch * y0 + offset;
+        p.dstPitch = slotPitch;
+        p.luma = slotLuma + lumaPitch * (y0 / 2) + static_cast<size_t>(runStart) * (kTileSize / 2) * sizeof(uint16_t);
+        p.lumaPitch = lumaPitch;
+        ConvertPixels(p);
+      } else {
+        CopyTile(src + srcPitch * y0 + offset, srcPitch, slot + slotPitch * y0 + offset, slotPitch, runBytes, rows);
+      }
+      written += tx - runStart;
+      bytes += runBytes * rows;
+    }
+  }
+  std::memcpy(slotStamps, m_stamps.data(), m_stamps.size() * sizeof(uint64_t));
+  if (hashFrame) {
+    m_primed = true;
+  }
+  if (compared && changed * 10 >= m_stamps.size() * 9) {
+    m_unhashedFrames = kHashProbeInterval;
+  }
+
+  m_stats.frames++;
+  m_stats.tilesTotal += m_stamps.size();
+  m_stats.tilesChanged += changed;
+  m_stats.tilesWritten += written;
+  m_stats.bytesWritten += bytes + m_stamps.size() * sizeof(uint64_t);
+  m_stats.bytesFull += static_cast<uint64_t>(m_width) * m_bytesPerPixel * m_height;
+  m_stats.encodeSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ----------------------------------------------------------------------------
+// TileDeltaDecoder
+// ----------------------------------------------------------------------------
+
+void TileDeltaDecoder::Reset(uint32_t width, uint32_t height) {
+  m_width = width;
+  m_height = height;
+  m_tilesX = TileDeltaEncoder::TilesFor(width);
+  m_tilesY = TileDeltaEncoder::TilesFor(height);
+  m_baseFrame = 0;
+  m_rects.clear();
+}
+
+const std::vector<TileRect>& TileDeltaDecoder::Plan(const uint64_t* stamps) {
+  constexpr uint32_t kTile = TileDeltaEncoder::kTileSize;
+  m_rects.clear();
+  m_plannedPixels = 0;
+  if (m_width == 0 || m_height == 0) {
+    return m_rects;
+  }
+  if (m_baseFrame == 0 || !stamps) {
+    m_rects.push_back({0, 0, m_width, m_height});
+    m_plannedPixels = static_cast<uint64_t>(m_width) * m_height;
+    return m_rects;
+  }
+
+  for (uint32_t ty = 0; ty < m_tilesY; ++ty) {
+    uint32_t y0 = ty * kTile;
+    uint32_t rows = std::min(kTile, m_height - y0);
+    uint32_t tx = 0;
+    while (tx < m_tilesX) {
+      if (stamps[static_cast<size_t>(ty) * m_tilesX + tx] <= m_baseFrame) {
+        tx++;
+        continue;
+      }
+      uint32_t runStart = tx;
+      while (tx < m_tilesX && stamps[static_cast<size_t>(ty) * m_tilesX + tx] > m_baseFrame) {
+        tx++;
+      }
+      uint32_t x0 = runStart * kTile;
+      uint32_t x1 = std::min(tx * kTile, m_width);
+      m_rects.push_back({x0, y0, x1 - x0, rows});
+      m_plannedPixels += static_cast<uint64_t>(x1 - x0) * rows;
+    }
+  }
+  return m_rects;
+}
+
+void TileDeltaDecoder::Apply(const std::vector<TileRect>& rects, const uint8_t* src, size_t srcPitch,
+                             uint8_t* dst, size_t dstPitch, uint32_t bytesPerPixel) {
+  for (const TileRect& r : rects) {
+    size_t offset = static_cast<size_t>(r.x) * bytesPerPixel;
+    CopyTile(src + srcPitch * r.y + offset, srcPitch, dst + dstPitch * r.y + offset, dstPitch,
+             static_cast<size_t>(r.width) * bytesPerPixel, r.height);
+  }
+}
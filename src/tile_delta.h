@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pixel_convert.h"
+
+// Tile-delta transfer for the shared-memory capture path.
+//
+// The frame is split into 64x64 tiles. The encoder (hook side) hashes each
+// tile of the new frame against the previous frame and keeps, per tile, the
+// number of the last frame that changed it. A ring slot always holds a
+// complete frame, so when the slot previously held frame F the encoder only
+// copies tiles stamped after F, and writes the stamp table into the slot's
+// metadata.
+//
+// The decoder (consumer side) keeps a persistent copy at some base frame B.
+// Tiles stamped after B are exactly the ones that differ, so it patches
+// only those. Because the stamps are absolute frame numbers rather than a
+// per-frame dirty bitmap, skipped frames need no special handling.
+//
+// The encoder can also maintain a half-resolution luma plane per slot: it
+// is derived from exactly the tiles being copied, so it stays in step with
+// the slot pixels at no extra read of the frame.
+
+struct TileRect {
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+struct TileDeltaStats {
+  uint64_t frames = 0;
+  uint64_t tilesTotal = 0;
+  uint64_t tilesChanged = 0;    // differed from the previous frame
+  uint64_t tilesWritten = 0;    // copied into the destination slot
+  uint64_t bytesWritten = 0;
+  uint64_t bytesFull = 0;       // what full-frame copies would have written
+  double encodeSec = 0.0;
+
+  double WriteRatio() const {
+    return bytesFull > 0 ? static_cast<double>(bytesWritten) / static_cast<double>(bytesFull) : 1.0;
+  }
+};
+
+class TileDeltaEncoder {
+public:
+  static constexpr uint32_t kTileSize = 64;
+  // Frames copied in full without hashing after a frame where >= 90% of
+  // the tiles changed.
+  static constexpr uint32_t kHashProbeInterval = 8;
+
+  static uint32_t TilesFor(uint32_t pixels) { return (pixels + kTileSize - 1) / kTileSize; }
+  static uint64_t StampTableBytes(uint32_t width, uint32_t height) {
+    return static_cast<uint64_t>(TilesFor(width)) * TilesFor(height) * sizeof(uint64_t);
+  }
+
+  // Sets the geometry; the next frame is treated as fully changed.
+  // Disables the luma plane.
+  void Reset(uint32_t width, uint32_t height, uint32_t bytesPerPixel);
+
+  // Emits the (width / 2) x (height / 2) 16-bit luma (see PlaneLuma) of
+  // copied tiles when Encode gets a luma plane. Only 8-bit Bgra8/Rgba8
+  // frames; returns false (and stays disabled) otherwise.
+  bool EnableLuma(PixelFormat format);
+  bool LumaEnabled() const { return m_lumaEnabled; }
+
+  uint32_t TilesX() const { return m_tilesX; }
+  uint32_t TilesY() const { return m_tilesY; }
+
+  // Encodes frame number `frame` (monotonic, > 0) from src into a slot that
+  // currently holds frame slotFrame (0 = nothing valid, copy everything).
+  // slotStamps receives StampTableBytes() of per-tile last-change frames.
+  // slotLuma, if set and luma is enabled, is the slot's luma plane.
+  void Encode(const uint8_t* src, size_t srcPitch, uint64_t frame,
+              uint8_t* slot, size_t slotPitch, uint64_t slotFrame, uint64_t* slotStamps,
+              uint8_t* slotLuma = nullptr, size_t lumaPitch = 0);
+
+  const TileDeltaStats& Stats() const { return m_stats; }
+  void ResetStats() { m_stats = TileDeltaStats(); }
+
+private:
+  // Hashes one row of tiles and stamps the ones that changed; returns how many.
+  uint64_t HashBand(const uint8_t* src, size_t srcPitch, uint32_t rows, uint64_t frame,
+                    uint64_t* hashes, uint64_t* stamps);
+
+  uint32_t m_width = 0;
+  uint32_t m_height = 0;
+  uint32_t m_bytesPerPixel = 4;
+  uint32_t m_tilesX = 0;
+  uint32_t m_tilesY = 0;
+  bool m_primed = false;
+  bool m_lumaEnabled = false;
+  PixelFormat m_lumaFormat = PixelFormat::Bgra8;
+  uint32_t m_unhashedFrames = 0;
+  std::vector<uint64_t> m_hashes;
+  std::vector<uint64_t> m_stamps;
+  std::vector<uint64_t> m_lanes;    // 4 hash lanes per tile of one band
+  TileDeltaStats m_stats;
+};
+
+class TileDeltaDecoder {
+public:
+  // Sets the geometry and drops the base; the next plan is a full frame.
+  void Reset(uint32_t width, uint32_t height);
+  void Invalidate() { m_baseFrame = 0; }
+  uint64_t BaseFrame() const { return m_baseFrame; }
+
+  // Rectangles of the slot that differ from the persistent copy. Dirty
+  // tiles adjacent in a tile row are merged into one rectangle.
+  const std::vector<TileRect>& Plan(const uint64_t* stamps);
+
+  // Call once the planned rectangles were applied from a consistent read.
+  void Commit(uint64_t frame) { m_baseFrame = frame; }
+
+  // CPU helper: copies rects from a slot into the persistent image.
+  static void Apply(const std::vector<TileRect>& rects, const uint8_t* src, size_t srcPitch,
+                    uint8_t* dst, size_t dstPitch, uint32_t bytesPerPixel);
+
+  uint64_t PlannedPixels() const { return m_plannedPixels; }
+
+private:
+  uint32_t m_width = 0;
+  uint32_t m_height = 0;
+  uint32_t m_tilesX = 0;
+  uint32_t m_tilesY = 0;
+  uint64_t m_baseFrame = 0;
+  uint64_t m_plannedPixels = 0;
+  std::vector<TileRect> m_rects;
+};
@@ -0,0 +1,110 @@
+#include "vrr_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Tolerance for comparing tick times that were derived from the same arrivals.
+constexpr double kTimeEpsilon = 1e-6;
+
+} // namespace
+
+void VrrScheduler::Reset() {
+  m_cursor = 0.0;
+  m_hasCursor = false;
+  m_lastPairStart = -1.0;
+}
+
+int VrrScheduler::PresentsForInterval(double intervalSec) const {
+  if (intervalSec <= 0.0 || m_config.maxOutputHz <= 0.0) {
+    return 1;
+  }
+  // Most presents the ceiling allows, so spacing never drops below 1/max.
+  int ceiling = static_cast<int>(std::floor(intervalSec * m_config.maxOutputHz + kTimeEpsilon));
+  int count = std::min(std::max(m_config.maxPresentsPerPair, 1), ceiling);
+  if (m_config.minOutputHz > 0.0) {
+    // Long pairs need enough presents to stay above the VRR floor.
+    int floorCount = static_cast<int>(std::ceil(intervalSec * m_config.minOutputHz - kTimeEpsilon));
+    count = std::max(count, std::min(floorCount, ceiling));
+  }
+  return std::max(count, 1);
+}
+
+VrrTick VrrScheduler::Peek(const double* arrivals, int count, double notBeforeSec) const {
+  VrrTick tick;
+  if (!arrivals || count <= 0) {
+    if (m_hasCursor && m_config.minOutputHz > 0.0) {
+      tick.timeSec = m_cursor + 1.0 / m_config.minOutputHz;
+      tick.hold = true;
+      tick.valid = true;
+    }
+    return tick;
+  }
+
+  if (!m_hasCursor) {
+    // Start on the oldest queued frame itself.
+    tick.timeSec = arrivals[0];
+    tick.alpha = 0.0f;
+    tick.pairStartSec = arrivals[0];
+    tick.valid = true;
+    return tick;
+  }
+
+  double minSpacing = m_config.maxOutputHz > 0.0 ? 1.0 / m_config.maxOutputHz : 0.0;
+  // Ticks inside a pair are at least minSpacing apart by construction; the
+  // same spacing is kept across pair boundaries and after holds.
+  double after = m_cursor + minSpacing - kTimeEpsilon;
+  for (int i = 0; i + 1 < count; ++i) {
+    double start = arrivals[i];
+    double interval = arrivals[i + 1] - start;
+    if (interval <= 0.0 || arrivals[i + 1] <= after) {
+      continue;
+    }
+    int presents = PresentsForInterval(interval);
+    for (int k = 1; k <= presents; ++k) {
+      double t = (k == presents) ? arrivals[i + 1] : start + interval * k / presents;
+      if (t <= after || t < notBeforeSec) {
+        continue;
+      }
+      tick.timeSec = t;
+      tick.alpha = static_cast<float>(k) / static_cast<float>(presents);
+      tick.step = k;
+      tick.count = presents;
+      tick.pairStartSec = start;
+      tick.valid = true;
+      return tick;
+    }
+  }
+
+  // Caught up with the newest frame: hold it until the VRR floor forces a
+  // refresh (or a new frame extends the schedule).
+  if (m_config.minOutputHz > 0.0) {
+    tick.timeSec = std::max(m_cursor + 1.0 / m_config.minOutputHz, notBeforeSec);
+    tick.alpha = 1.0f;
+    tick.pairStartSec = count >= 2 ? arrivals[count - 2] : arrivals[0];
+    tick.hold = true;
+    tick.valid = true;
+  }
+  return tick;
+}
+
+void VrrScheduler::Advance(const VrrTick& tick) {
+  if (!tick.valid) {
+    return;
+  }
+  m_cursor = m_hasCursor ? std::max(m_cursor, tick.timeSec) : tick.timeSec;
+  m_hasCursor = true;
+  m_stats.ticks++;
+  if (tick.hold) {
+    m_stats.holds++;
+    return;
+  }
+  if (tick.count > 0 && std::abs(tick.pairStartSec - m_lastPairStart) > kTimeEpsilon) {
+    m_lastPairStart = tick.pairStartSec;
+    m_stats.pairs++;
+    m_stats.pairPresents += static_cast<uint64_t>(tick.count);
+    m_stats.lastCount = tick.count;
+    m_stats.lastPairIntervalSec = tick.alpha > 0.0f ? (tick.timeSec - tick.pairStartSec) / tick.alpha : 0.0;
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+// Content-driven present schedule for variable refresh displays.
+//
+// Instead of presenting at a fixed output rate, every source pair (a, b) gets
+// N presents at a + k * (b - a) / N for k = 1..N, so generated frames are
+// evenly spaced between the actual arrivals and the last one is the source
+// frame itself. N follows the measured pair interval: as many presents as
+// the maximum output rate allows, capped per pair, and never fewer than the
+// panel's VRR floor needs. When the source stalls past the newest frame the
+// schedule emits hold ticks at the floor rate so the panel is refreshed
+// before it falls out of its VRR range.
+//
+// All times are seconds on the source (capture) clock; the caller maps a tick
+// to its own clock and adds the output delay.
+
+struct VrrSchedulerConfig {
+  double maxOutputHz = 144.0;    // present rate ceiling (panel maximum)
+  double minOutputHz = 48.0;     // VRR floor; 0 disables hold ticks
+  int maxPresentsPerPair = 4;
+};
+
+struct VrrTick {
+  double timeSec = 0.0;          // source time the present should show
+  float alpha = 0.0f;            // position inside the pair
+  int step = 0;                  // 1..count (0 for the very first frame)
+  int count = 0;                 // presents scheduled for this pair
+  double pairStartSec = 0.0;
+  bool hold = false;             // no newer source frame; re-present the last
+  bool valid = false;            // false until the first frame is queued
+};
+
+struct VrrSchedulerStats {
+  uint64_t ticks = 0;
+  uint64_t holds = 0;
+  uint64_t pairs = 0;
+  uint64_t pairPresents = 0;     // sum of per-pair counts
+  int lastCount = 0;
+  double lastPairIntervalSec = 0.0;
+
+  double AvgPresentsPerPair() const {
+    return pairs > 0 ? static_cast<double>(pairPresents) / static_cast<double>(pairs) : 0.0;
+  }
+};
+
+class VrrScheduler {
+public:
+  void SetConfig(const VrrSchedulerConfig& config) { m_config = config; }
+  const VrrSchedulerConfig& Config() const { return m_config; }
+
+  // Forgets the schedule position (capture restart, mode switch).
+  void Reset();
+
+  // Presents for one pair of the given interval.
+  int PresentsForInterval(double intervalSec) const;
+
+  // Next tick after the last consumed one. arrivals are the source times of
+  // the queued frames in capture order; ticks earlier than notBeforeSec
+  // (the caller is running late) are skipped.
+  VrrTick Peek(const double* arrivals, int count, double notBeforeSec) const;
+  // Consumes a tick returned by Peek.
+  void Advance(const VrrTick& tick);
+
+  bool HasPosition() const { return m_hasCursor; }
+  double Position() const { return m_cursor; }
+
+  const VrrSchedulerStats& Stats() const { return m_stats; }
+  void ResetStats() { m_stats = VrrSchedulerStats(); }
+
+private:
+  VrrSchedulerConfig m_config;
+  double m_cursor = 0.0;
+  bool m_hasCursor = false;
+  double m_lastPairStart = -1.0;
+  VrrSchedulerStats m_stats;
+};
@@ -44,11 +44,6 @@ static bool SupportsMinUpdateInterval() {
 
 namespace {
 
-// Frame pool sizes: slightly larger pool helps avoid startup starvation where
-// no frame is available on the first few polls.
-constexpr int kFramePoolSizeNormal = 4;      // Balanced
-constexpr int kFramePoolSizeLowLatency = 4;  // Robust startup/steady polling
-
 // QPC frequency for timing calculations
 int64_t GetQpcFrequency() {
   static int64_t freq = 0;
@@ -66,6 +61,11 @@ int64_t GetQpcNow() {
   return qpc.QuadPart;
 }
 
+// Queue timestamps: seconds on QPC, same clock as DeadlineWaiter::Now().
+double QpcSeconds() {
+  return static_cast<double>(GetQpcNow()) / static_cast<double>(GetQpcFrequency());
+}
+
 IDirect3DDevice CreateDirect3DDevice(ID3D11Device* device) {
   winrt::com_ptr<IDXGIDevice> dxgiDevice;
   winrt::check_hresult(device->QueryInterface(IID_PPV_ARGS(dxgiDevice.put())));
@@ -133,13 +133,14 @@ bool WgcCapture::StartCapture(HWND hwnd) {
     m_width = size.Width;
     m_height = size.Height;
 
-    // Use appropriate frame pool size based on latency mode
-    int poolSize = kFramePoolSizeLowLatency;
-    
+    // Pool depth starts from the queue policy and is retuned from the
+    // measured arrival rate and consumer lag.
+    ResetQueue();
+
     m_framePool = Direct3D11CaptureFramePool::CreateFreeThreaded(
         m_winrtDevice,
         DirectXPixelFormat::B8G8R8A8UIntNormalized,
-        poolSize,
+        m_poolSize,
         size);
 
     m_frameArrivedToken = m_framePool.FrameArrived(
@@ -175,15 +176,8 @@ bool WgcCapture::StartCapture(HWND hwnd) {
     }
     
     m_session.StartCapture();
-    m_hasNewFrame.store(false);
-    m_pendingFrameCount.store(0);
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_latestFrame = nullptr;
-    }
     m_isCapturing = true;
     m_hasError = false;
-    m_droppedFrames = 0;
     m_capturedFrames = 0;
     m_captureHwnd = hwnd;
     m_captureMonitor = nullptr;
@@ -246,13 +240,12 @@ bool WgcCapture::StartCaptureMonitor(HMONITOR monitor) {
     m_width = size.Width;
     m_height = size.Height;
 
-    // Use appropriate frame pool size based on latency mode
-    int poolSize = kFramePoolSizeLowLatency;
+    ResetQueue();
 
     m_framePool = Direct3D11CaptureFramePool::CreateFreeThreaded(
         m_winrtDevice,
         DirectXPixelFormat::B8G8R8A8UIntNormalized,
-        poolSize,
+        m_poolSize,
         size);
 
     m_frameArrivedToken = m_framePool.FrameArrived(
@@ -275,15 +268,8 @@ bool WgcCapture::StartCaptureMonitor(HMONITOR monitor) {
     }
     
     m_session.StartCapture();
-    m_hasNewFrame.store(false);
-    m_pendingFrameCount.store(0);
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_latestFrame = nullptr;
-    }
     m_isCapturing = true;
     m_hasError = false;
-    m_droppedFrames = 0;
     m_capturedFrames = 0;
     m_captureHwnd = nullptr;
     m_captureMonitor = monitor;
@@ -304,6 +290,7 @@ void WgcCapture::StopCapture() {
   if (m_framePool) {
     m_framePool.FrameArrived(m_frameArrivedToken);
   }
+  ResetQueue();
 
   if (m_session) {
     m_session.Close();
@@ -317,12 +304,6 @@ void WgcCapture::StopCapture() {
   m_session = nullptr;
   m_framePool = nullptr;
   m_isCapturing = false;
-  m_hasNewFrame.store(false);
-  m_pendingFrameCount.store(0);
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_latestFrame = nullptr;
-  }
   m_lastFrameTime = 0;
   m_lastFrameAgeMs = 0.0;
 }
@@ -336,8 +317,57 @@ bool WgcCapture::RestartCapture() {
   return false;
 }
 
+void WgcCapture::SetQueueConfig(const CaptureQueueConfig& config) {
+  m_queueConfig = config;
+  const int previousPool = m_poolSize;
+  ResetQueue();
+  if (m_framePool && m_poolSize != previousPool) {
+    try {
+      m_framePool.Recreate(m_winrtDevice, DirectXPixelFormat::B8G8R8A8UIntNormalized, m_poolSize,
+                           {m_width, m_height});
+    } catch (...) {
+    }
+  }
+}
+
+void WgcCapture::ResetQueue() {
+  std::vector<winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame> released;
+  m_queue.Reset(m_queueConfig, released);
+  CloseFrames(released);
+  m_poolSize = m_queue.Stats().poolSize;
+}
+
+void WgcCapture::ApplyPoolResize() {
+  int poolSize = 0;
+  if (!m_queue.TakePoolResize(poolSize) || poolSize == m_poolSize) {
+    return;
+  }
+  m_poolSize = poolSize;
+  if (m_framePool) {
+    try {
+      m_framePool.Recreate(m_winrtDevice, DirectXPixelFormat::B8G8R8A8UIntNormalized, m_poolSize,
+                           {m_width, m_height});
+    } catch (...) {
+      // Keep the old pool; the next recommendation retries.
+    }
+  }
+}
+
+void WgcCapture::CloseFrames(std::vector<winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame>& frames) {
+  // Closing hands the surface back to the pool now instead of whenever the
+  // last reference goes away.
+  for (auto& frame : frames) {
+    if (frame) {
+      try {
+        frame.Close();
+      } catch (...) {
+      }
+    }
+  }
+  frames.clear();
+}
+
 void WgcCapture::ResetStatistics() {
-  m_droppedFrames = 0;
   m_capturedFrames = 0;
   m_frameIntervalSum = 0.0;
   m_frameIntervalCount = 0;
@@ -345,9 +375,14 @@ void WgcCapture::ResetStatistics() {
 }
 
 WgcCaptureStatistics WgcCapture::GetStatistics() const {
+  const CaptureQueueStats queueStats = m_queue.Stats();
   WgcCaptureStatistics stats;
   stats.capturedFrames = static_cast<uint32_t>(m_capturedFrames);
-  stats.droppedFrames = static_cast<uint32_t>(m_droppedFrames);
+  stats.droppedFrames = static_cast<uint32_t>(queueStats.dropped);
+  stats.poolSize = m_poolSize;
+  stats.poolResizes = queueStats.poolResizes;
+  stats.maxQueued = queueStats.maxQueued;
+  stats.arrivalToConsume = queueStats.latency;
   stats.lastFrameTime = m_lastFrameTime;
   stats.lastFrameAgeMs = m_lastFrameAgeMs;
   stats.avgFrameIntervalMs = (m_frameIntervalCount > 0) 
@@ -374,33 +409,27 @@ void WgcCapture::UpdateFrameTiming(int64_t frameQpc) {
 bool WgcCapture::AcquireNextFrame(CapturedFrame& frame) {
   if (!m_framePool) return false;
 
-  winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame latestFrame{nullptr};
-
-  // Prefer callback-buffered frame first.
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (m_latestFrame) {
-      latestFrame = m_latestFrame;
-      m_latestFrame = nullptr;
-    }
-  }
+  winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame next{nullptr};
+  double now = QpcSeconds();
+  bool got = m_queue.Pop(next, now, m_consumerReleased);
 
-  // Fallback: if callback hasn't delivered yet, drain pool non-blocking and
-  // keep only the newest frame to avoid backlog latency.
-  if (!latestFrame) {
+  // Fallback: the callback has not delivered yet; pull from the pool
+  // directly, through the queue so the policy still applies.
+  if (!got) {
     while (auto f = m_framePool.TryGetNextFrame()) {
-      latestFrame = f;
+      m_queue.Push(f, now, m_consumerReleased);
     }
+    got = m_queue.Pop(next, now, m_consumerReleased);
   }
-
-  if (!latestFrame) {
+  CloseFrames(m_consumerReleased);
+  if (!got) {
     return false;
   }
 
-  m_pendingFrameCount.store(0, std::memory_order_release);
-  m_hasNewFrame.store(false, std::memory_order_release);
-
-  return ProcessFrame(latestFrame, frame);
+  bool ok = ProcessFrame(next, frame);
+  next.Close();
+  ApplyPoolResize();
+  return ok;
 }
 
 bool WgcCapture::ProcessFrame(winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame const& captureFrame, CapturedFrame& frame) {
@@ -410,7 +439,6 @@ bool WgcCapture::ProcessFrame(winrt::Windows::Graphics::Capture::Direct3D11Captu
   if (size.Width != m_width || size.Height != m_height) {
     m_width = size.Width;
     m_height = size.Height;
-    int poolSize = kFramePoolSizeLowLatency;
     // Note: Recreating pool might race with the capture thread if not careful.
     // Ideally we should signal the thread to pause, but WGC handles pool recreation fairly robustly.
     // However, since we are on the Main Thread here, and Capture Thread uses m_framePool...
@@ -418,7 +446,7 @@ bool WgcCapture::ProcessFrame(winrt::Windows::Graphics::Capture::Direct3D11Captu
     // Given the complexity, we'll recreate it here. The Capture Thread checks m_framePool != nullptr.
     if (m_framePool) {
         m_framePool.Recreate(m_winrtDevice, DirectXPixelFormat::B8G8R8A8UIntNormalized,
-                             poolSize, size);
+                             m_poolSize, size);
     }
     EnsureCaptureTexture(m_width, m_height);
   }
@@ -456,6 +484,7 @@ bool WgcCapture::ProcessFrame(winrt::Windows::Graphics::Capture::Direct3D11Captu
   
   m_lastFrameTime = frameTime;
   m_capturedFrames++;
+  frame.sequence = static_cast<uint64_t>(m_capturedFrames);
   
   // Update frame interval statistics
   UpdateFrameTiming(nowQpc);
@@ -464,29 +493,31 @@ bool WgcCapture::ProcessFrame(winrt::Windows::Graphics::Capture::Direct3D11Captu
 }
 
 bool WgcCapture::AcquireLatestFrame(CapturedFrame& frame) {
-    return AcquireNextFrame(frame); // Thread already ensures latest
+  if (!m_framePool) return false;
+
+  winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame latest{nullptr};
+  const bool got = m_queue.PopLatest(latest, QpcSeconds(), m_consumerReleased);
+  CloseFrames(m_consumerReleased);
+  if (!got) {
+    return AcquireNextFrame(frame);
+  }
+  bool ok = ProcessFrame(latest, frame);
+  latest.Close();
+  ApplyPoolResize();
+  return ok;
 }
 
 void WgcCapture::OnFrameArrived(
     Direct3D11CaptureFramePool const& sender,
     winrt::Windows::Foundation::IInspectable const&) {
   try {
-    winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame newest{nullptr};
+    // Every frame goes through the queue; the policy decides what is kept.
+    // Dropped frames are closed here, outside the queue lock.
+    std::vector<winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame> released;
     while (auto frame = sender.TryGetNextFrame()) {
-      newest = frame;
-    }
-
-    if (!newest) {
-      return;
-    }
-
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      // Keep only the latest frame to avoid backlog latency.
-      m_latestFrame = newest;
+      m_queue.Push(frame, QpcSeconds(), released);
     }
-    m_hasNewFrame.store(true, std::memory_order_release);
-    m_pendingFrameCount.store(1, std::memory_order_release);
+    CloseFrames(released);
   } catch (...) {
     // Ignore callback errors; polling path remains as fallback.
   }
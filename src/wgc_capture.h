@@ -5,6 +5,8 @@
 #endif
 
 #include "capture_frame.h"
+#include "capture_queue.h"
+#include "capture_source.h"
 
 #include <d3d11.h>
 #include <windows.h>
@@ -15,39 +17,55 @@
 #include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
 #include <winrt/base.h>
 
-#include <atomic>
-#include <mutex>
-#include <thread>
-#include <condition_variable>
+#include <vector>
 
 struct WgcCaptureStatistics {
   uint32_t capturedFrames = 0;
-  uint32_t droppedFrames = 0;
+  uint32_t droppedFrames = 0;   // discarded by the queue policy
   int64_t lastFrameTime = 0;
   double avgFrameIntervalMs = 0.0;
   double lastFrameAgeMs = 0.0;  // Time since frame was captured
+  int poolSize = 0;             // current frame pool depth
+  uint64_t poolResizes = 0;
+  int maxQueued = 0;
+  CaptureLatencyHistogram arrivalToConsume;  // FrameArrived -> AcquireNextFrame
 };
 
-class WgcCapture {
+class WgcCapture : public ICaptureSource {
 public:
   bool Initialize(ID3D11Device* device);
   void Shutdown();
 
   bool StartCapture(HWND hwnd);
   bool StartCaptureMonitor(HMONITOR monitor);
-  void StopCapture();
+  void StopCapture() override;
   bool RestartCapture();  // Restart current capture session
 
+  // Next frame under the queue policy.
   bool AcquireNextFrame(CapturedFrame& frame);
-  bool AcquireNextFramePolling(CapturedFrame& frame, bool poll);
+  // Newest frame regardless of policy; older queued frames are dropped.
   bool AcquireLatestFrame(CapturedFrame& frame);
+
+  // Queue policy and pool sizing limits. Takes effect immediately; frames
+  // queued under the old policy are dropped.
+  void SetQueueConfig(const CaptureQueueConfig& config);
+  CaptureQueueConfig GetQueueConfig() const { return m_queueConfig; }
   
   // Spin-wait polling - lower latency but higher CPU
-  bool IsCapturing() const { return m_isCapturing; }
+  bool IsCapturing() const override { return m_isCapturing; }
   bool HasError() const { return m_hasError; }
 
+  // ICaptureSource
+  const char* SourceName() const override { return "WGC"; }
+  bool AcquireFrame(SourceFrame& frame) override {
+    frame.onGpu = true;
+    return AcquireNextFrame(frame.gpu);
+  }
+
   // Frame statistics
-  int GetDroppedFrameCount() const { return m_droppedFrames; }
+  int GetDroppedFrameCount() const { return static_cast<int>(m_queue.Stats().dropped); }
+  // Running drop count for per-present use: no lock, no statistics copy.
+  uint64_t GetDroppedFrameTotal() const { return m_queue.DroppedTotal(); }
   int GetCapturedFrameCount() const { return m_capturedFrames; }
   void ResetStatistics();
   WgcCaptureStatistics GetStatistics() const;
@@ -63,6 +81,9 @@ private:
       winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool const&,
       winrt::Windows::Foundation::IInspectable const&);
   void EnsureCaptureTexture(int width, int height);
+  void ResetQueue();
+  void ApplyPoolResize();
+  static void CloseFrames(std::vector<winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame>& frames);
   bool ProcessFrame(winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame const& captureFrame, CapturedFrame& frame);
   void UpdateFrameTiming(int64_t frameTime);
 
@@ -74,12 +95,14 @@ private:
   winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool m_framePool{nullptr};
   winrt::Windows::Graphics::Capture::GraphicsCaptureSession m_session{nullptr};
   winrt::Windows::Graphics::Capture::GraphicsCaptureItem m_item{nullptr};
-  winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame m_latestFrame{nullptr};
 
   winrt::event_token m_frameArrivedToken{};
-  std::atomic<bool> m_hasNewFrame{false};
-  std::atomic<int> m_pendingFrameCount{0};  // Track how many frames are waiting
-  std::mutex m_mutex;
+  // Frames handed from the FrameArrived callback to the consumer; the
+  // policy decides which ones are dropped and how deep the pool is.
+  CaptureQueue<winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame> m_queue;
+  CaptureQueueConfig m_queueConfig;
+  std::vector<winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame> m_consumerReleased;
+  int m_poolSize = 0;
 
   bool m_isCapturing = false;
   bool m_hasError = false;
@@ -92,7 +115,6 @@ private:
   bool m_isWindowCapture = false;
   
   // Statistics and timing
-  int m_droppedFrames = 0;
   int m_capturedFrames = 0;
   int64_t m_lastFrameTime = 0;
   double m_lastFrameAgeMs = 0.0;
@@ -0,0 +1,339 @@
+#include "x11_capture.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#ifdef TFE_HAVE_XDAMAGE
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#endif
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include <chrono>
+#include <ctime>
+
+namespace {
+
+// A fragmented damage region costs more to walk than it saves; past this
+// many rectangles the frame is reported fully dirty.
+constexpr int kMaxDirtyRects = 256;
+
+int64_t MonotonicNow100ns() {
+  timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 10000000 + ts.tv_nsec / 100;
+}
+
+// XShmAttach fails asynchronously (e.g. a remote display), and the default
+// Xlib error handler exits the process.
+bool g_shmAttachFailed = false;
+
+int ShmAttachErrorHandler(Display*, XErrorEvent*) {
+  g_shmAttachFailed = true;
+  return 0;
+}
+
+} // namespace
+
+struct X11Capture::State {
+  Display* display = nullptr;
+  Window window = 0;
+  Visual* visual = nullptr;
+  int depth = 0;
+  XImage* image = nullptr;
+  XShmSegmentInfo shm = {};
+  bool shmAttached = false;
+  PixelFormat format = PixelFormat::Bgra8;
+  bool firstFrame = true;
+  int pendingWidth = 0;
+  int pendingHeight = 0;
+  // Server time of the first damage since the last read (0 = none).
+  unsigned long damageTimeMs = 0;
+#ifdef TFE_HAVE_XDAMAGE
+  int damageEventBase = 0;
+  Damage damage = 0;
+  XserverRegion region = 0;
+#endif
+};
+
+X11Capture::X11Capture() : m_state(new State()) {}
+
+X11Capture::~X11Capture() {
+  StopCapture();
+}
+
+bool X11Capture::StartCapture(const char* displayName, unsigned long window) {
+  StopCapture();
+  State& s = *m_state;
+  s = State();
+  m_stats = X11CaptureStats();
+  m_sequence = 0;
+  m_resized = false;
+
+  s.display = XOpenDisplay(displayName);
+  if (!s.display) {
+    m_lastError = "Cannot open X display";
+    return false;
+  }
+  if (!XShmQueryExtension(s.display)) {
+    m_lastError = "X server has no MIT-SHM";
+    StopCapture();
+    return false;
+  }
+
+  s.window = window ? static_cast<Window>(window) : DefaultRootWindow(s.display);
+  XWindowAttributes attr = {};
+  if (!XGetWindowAttributes(s.display, s.window, &attr)) {
+    m_lastError = "XGetWindowAttributes failed";
+    StopCapture();
+    return false;
+  }
+  s.visual = attr.visual;
+  s.depth = attr.depth;
+  XSelectInput(s.display, s.window, StructureNotifyMask);
+
+  if (!CreateImage(attr.width, attr.height)) {
+    StopCapture();
+    return false;
+  }
+
+#ifdef TFE_HAVE_XDAMAGE
+  int damageError = 0;
+  int fixesEvent = 0;
+  int fixesError = 0;
+  if (XDamageQueryExtension(s.display, &s.damageEventBase, &damageError) &&
+      XFixesQueryExtension(s.display, &fixesEvent, &fixesError)) {
+    // Both protocols require a version handshake before other requests.
+    int major = 1, minor = 1;
+    XDamageQueryVersion(s.display, &major, &minor);
+    major = 2;
+    minor = 0;
+    XFixesQueryVersion(s.display, &major, &minor);
+    s.damage = XDamageCreate(s.display, s.window, XDamageReportNonEmpty);
+    s.region = XFixesCreateRegion(s.display, nullptr, 0);
+    m_hasDamage = s.damage != 0 && s.region != 0;
+  }
+#endif
+
+  m_isCapturing = true;
+  m_lastError.clear();
+  return true;
+}
+
+void X11Capture::StopCapture() {
+  State& s = *m_state;
+  if (s.display) {
+#ifdef TFE_HAVE_XDAMAGE
+    if (s.damage) {
+      XDamageDestroy(s.display, s.damage);
+      s.damage = 0;
+    }
+    if (s.region) {
+      XFixesDestroyRegion(s.display, s.region);
+      s.region = 0;
+    }
+#endif
+    DestroyImage();
+    XCloseDisplay(s.display);
+    s.display = nullptr;
+  }
+  m_isCapturing = false;
+  m_hasDamage = false;
+  m_width = 0;
+  m_height = 0;
+}
+
+bool X11Capture::CreateImage(int width, int height) {
+  State& s = *m_state;
+  s.image = XShmCreateImage(s.display, s.visual, static_cast<unsigned int>(s.depth), ZPixmap, nullptr, &s.shm,
+                            static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+  if (!s.image) {
+    m_lastError = "XShmCreateImage failed";
+    return false;
+  }
+  if (s.image->bits_per_pixel != 32 || s.image->byte_order != LSBFirst ||
+      (s.image->red_mask != 0xFF0000 && s.image->red_mask != 0xFF)) {
+    m_lastError = "Unsupported visual (need 32 bpp BGRX/RGBX)";
+    DestroyImage();
+    return false;
+  }
+  s.format = s.image->red_mask == 0xFF0000 ? PixelFormat::Bgra8 : PixelFormat::Rgba8;
+
+  size_t bytes = static_cast<size_t>(s.image->bytes_per_line) * s.image->height;
+  s.shm.shmid = shmget(IPC_PRIVATE, bytes, IPC_CREAT | 0600);
+  if (s.shm.shmid < 0) {
+    m_lastError = "shmget failed";
+    DestroyImage();
+    return false;
+  }
+  void* addr = shmat(s.shm.shmid, nullptr, 0);
+  if (addr == reinterpret_cast<void*>(-1)) {
+    m_lastError = "shmat failed";
+    shmctl(s.shm.shmid, IPC_RMID, nullptr);
+    s.shm.shmid = -1;
+    DestroyImage();
+    return false;
+  }
+  s.shm.shmaddr = s.image->data = static_cast<char*>(addr);
+  s.shm.readOnly = False;
+
+  g_shmAttachFailed = false;
+  XErrorHandler previous = XSetErrorHandler(ShmAttachErrorHandler);
+  XShmAttach(s.display, &s.shm);
+  XSync(s.display, False);
+  XSetErrorHandler(previous);
+  // Marked for removal now; the kernel frees it once both sides detach.
+  shmctl(s.shm.shmid, IPC_RMID, nullptr);
+  if (g_shmAttachFailed) {
+    m_lastError = "XShmAttach failed (remote display?)";
+    DestroyImage();
+    return false;
+  }
+  s.shmAttached = true;
+  m_width = width;
+  m_height = height;
+  s.firstFrame = true;
+  return true;
+}
+
+void X11Capture::DestroyImage() {
+  State& s = *m_state;
+  if (s.shmAttached) {
+    XShmDetach(s.display, &s.shm);
+    XSync(s.display, False);
+    s.shmAttached = false;
+  }
+  if (s.image) {
+    // The pixels are the shm segment, not malloc'ed memory.
+    s.image->data = nullptr;
+    XDestroyImage(s.image);
+    s.image = nullptr;
+  }
+  if (s.shm.shmaddr) {
+    shmdt(s.shm.shmaddr);
+    s.shm.shmaddr = nullptr;
+  }
+  s.shm.shmid = -1;
+}
+
+bool X11Capture::PumpEvents() {
+  State& s = *m_state;
+  bool damaged = false;
+  while (XPending(s.display) > 0) {
+    XEvent event;
+    XNextEvent(s.display, &event);
+    if (event.type == ConfigureNotify && event.xconfigure.window == s.window) {
+      if (event.xconfigure.width != m_width || event.xconfigure.height != m_height) {
+        s.pendingWidth = event.xconfigure.width;
+        s.pendingHeight = event.xconfigure.height;
+        m_resized = true;
+      }
+      continue;
+    }
+#ifdef TFE_HAVE_XDAMAGE
+    if (m_hasDamage && event.type == s.damageEventBase + XDamageNotify) {
+      const XDamageNotifyEvent& notify = reinterpret_cast<const XDamageNotifyEvent&>(event);
+      if (s.damageTimeMs == 0) {
+        s.damageTimeMs = notify.timestamp;
+      }
+      damaged = true;
+    }
+#endif
+  }
+  return damaged;
+}
+
+bool X11Capture::AcquireNextFrame(CpuFrame& frame) {
+  if (!m_isCapturing) {
+    return false;
+  }
+  State& s = *m_state;
+  m_stats.polls++;
+
+  bool damaged = PumpEvents();
+  if (m_resized) {
+    m_resized = false;
+    DestroyImage();
+    if (!CreateImage(s.pendingWidth, s.pendingHeight)) {
+      StopCapture();
+      return false;
+    }
+  }
+
+  const bool trackDamage = m_hasDamage && !m_ignoreDamage;
+  if (trackDamage && !damaged && !s.firstFrame) {
+    return false;
+  }
+
+  frame.dirtyRects.clear();
+  frame.fullFrameDirty = s.firstFrame || !trackDamage;
+#ifdef TFE_HAVE_XDAMAGE
+  if (m_hasDamage) {
+    // Take the damage before reading, so drawing that lands during the read
+    // is reported again next frame instead of lost.
+    XDamageSubtract(s.display, s.damage, None, s.region);
+    if (!frame.fullFrameDirty) {
+      int count = 0;
+      XRectangle* rects = XFixesFetchRegion(s.display, s.region, &count);
+      if (!rects || count > kMaxDirtyRects) {
+        frame.fullFrameDirty = true;
+      } else {
+        for (int i = 0; i < count; ++i) {
+          CaptureRegion r = ClampCaptureRegion(rects[i].x, rects[i].y, rects[i].width, rects[i].height,
+                                               0, 0, m_width, m_height);
+          if (!r.Empty()) {
+            frame.dirtyRects.push_back(r);
+          }
+        }
+      }
+      if (rects) {
+        XFree(rects);
+      }
+      // A notify queued before the previous subtract can leave nothing new.
+      if (!frame.fullFrameDirty && frame.dirtyRects.empty()) {
+        s.damageTimeMs = 0;
+        return false;
+      }
+    }
+  }
+#endif
+
+  auto readStart = std::chrono::steady_clock::now();
+  if (!XShmGetImage(s.display, s.window, s.image, 0, 0, AllPlanes)) {
+    m_lastError = "XShmGetImage failed";
+    // The damage was already taken; deliver the next frame in full.
+    s.firstFrame = true;
+    return false;
+  }
+  m_stats.readSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - readStart).count();
+
+  frame.data = reinterpret_cast<const uint8_t*>(s.image->data);
+  frame.pitch = static_cast<size_t>(s.image->bytes_per_line);
+  frame.width = m_width;
+  frame.height = m_height;
+  frame.format = s.format;
+  frame.sequence = ++m_sequence;
+  frame.systemTime100ns = MonotonicNow100ns();
+  frame.framesSkipped = 0;
+
+  // X server time is CLOCK_MONOTONIC in milliseconds, truncated to 32 bits.
+  // Rebuild the full value from our own clock and keep it only if it is
+  // plausible (not ahead of now, less than a second old).
+  frame.presentTime100ns = 0;
+  if (s.damageTimeMs != 0) {
+    int64_t nowMs = frame.systemTime100ns / 10000;
+    uint32_t age = static_cast<uint32_t>(nowMs) - static_cast<uint32_t>(s.damageTimeMs);
+    if (age < 1000) {
+      frame.presentTime100ns = (nowMs - age) * 10000;
+    }
+    s.damageTimeMs = 0;
+  }
+
+  s.firstFrame = false;
+  m_stats.frames++;
+  m_stats.dirtyPixels += frame.DirtyPixels();
+  m_stats.totalPixels += static_cast<uint64_t>(m_width) * m_height;
+  return true;
+}
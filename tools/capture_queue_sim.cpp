@@ -0,0 +1,225 @@
+// Capture queue simulator: drives CaptureQueue with simulated capture
+// arrivals and a simulated consumer, the way WgcCapture uses it, for each
+// queue policy across a few source/consumer rate combinations.
+//
+// The source renders into a pool of buffers: a frame is only produced if a
+// buffer is free (otherwise the source stalls and the frame is lost, as a
+// WGC frame pool does). Buffers are held by queued frames and by the frame
+// the consumer is copying. The consumer polls once per period at its own
+// rate, with jitter and occasional stalls, takes at most one frame per poll
+// and applies pool-size recommendations as WgcCapture does.
+//
+// Reports delivered / dropped / expired / starved frames, arrival-to-consume latency
+// percentiles and where the adaptive pool size settled, and checks:
+//  - frames are delivered in order, and never twice;
+//  - latest-only always delivers the newest arrived frame;
+//  - the time window never delivers a frame older than the window unless it
+//    was the newest one;
+//  - FIFO drops nothing when the consumer is faster than the source;
+//  - under sustained overload FIFO backs up to its depth, while the time
+//    window expires stale frames and grows the pool to cover the window;
+//  - every arrival is accounted for (consumed + dropped + still queued);
+//  - the pool size stays within its bounds.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <cstdlib>
+
+#include "capture_queue.h"
+
+struct Config {
+    double seconds = 20.0;
+    int fifoDepth = 3;
+    double windowMs = 50.0;
+    unsigned seed = 1;
+};
+
+struct Scenario {
+    const char* name;
+    double sourceFps;
+    double sourceJitterMs;
+    double consumerHz;
+    double consumerJitterMs;
+    double copyMs;              // consumer holds the frame this long
+    double stallEverySec;       // 0 = no stalls
+    double stallMs;
+    bool consumerFaster;        // FIFO must not drop
+    bool overload;              // source sustainably faster than the consumer
+};
+
+struct Frame {
+    uint64_t sequence = 0;
+    double arrivalSec = 0.0;
+};
+
+struct SimResult {
+    CaptureQueueStats stats;
+    uint64_t delivered = 0;
+    uint64_t starved = 0;
+    uint64_t expired = 0;       // dropped at consume time (time window)
+    uint64_t polls = 0;
+    uint64_t queuedAtPoll = 0;  // summed over polls
+    int minPool = 1 << 30;
+    int maxPool = 0;
+    std::vector<std::string> failures;
+};
+
+SimResult simulate(const Config& cfg, const Scenario& sc, CaptureQueuePolicy policy) {
+    SimResult r;
+    std::mt19937 rng(cfg.seed);
+    std::normal_distribution<double> sourceJitter(0.0, sc.sourceJitterMs * 1e-3);
+    std::normal_distribution<double> consumerJitter(0.0, sc.consumerJitterMs * 1e-3);
+
+    CaptureQueueConfig qc;
+    qc.policy = policy;
+    qc.fifoDepth = cfg.fifoDepth;
+    qc.windowSec = cfg.windowMs * 1e-3;
+    CaptureQueue<Frame> queue(qc);
+    std::vector<Frame> released;
+    int poolSize = queue.Stats().poolSize;
+
+    const double sourceInterval = 1.0 / sc.sourceFps;
+    const double consumerInterval = 1.0 / sc.consumerHz;
+    double nextArrival = sourceInterval;
+    double nextPoll = consumerInterval * 0.5;
+    double nextStall = sc.stallEverySec > 0.0 ? sc.stallEverySec : 1e30;
+    double busyUntil = 0.0;                 // consumer holds a buffer until then
+    uint64_t sequence = 0;
+    uint64_t lastDelivered = 0;
+    uint64_t lastArrived = 0;
+
+    auto fail = [&](const std::string& what) {
+        if (r.failures.size() < 4) r.failures.push_back(what);
+    };
+
+    while (std::min(nextArrival, nextPoll) < cfg.seconds) {
+        if (nextArrival <= nextPoll) {
+            const double now = nextArrival;
+            const int held = queue.Stats().queued + (busyUntil > now ? 1 : 0);
+            sequence++;
+            if (held >= poolSize - 1) {
+                r.starved++;            // no free buffer: the source stalls
+            } else {
+                queue.Push(Frame{sequence, now}, now, released);
+                lastArrived = sequence;
+            }
+            released.clear();
+            nextArrival += std::max(sourceInterval + sourceJitter(rng), sourceInterval * 0.25);
+            continue;
+        }
+
+        double now = nextPoll;
+        if (now >= nextStall) {
+            // Consumer hitch (shader compile, GC, ...): arrivals keep coming.
+            nextStall += sc.stallEverySec;
+            nextPoll = now + sc.stallMs * 1e-3;
+            continue;
+        }
+        // One frame per poll. A copy still running when the next period
+        // comes holds the poll back; the cadence does not catch up.
+        nextPoll = std::max(now + consumerInterval + consumerJitter(rng), now + consumerInterval * 0.25);
+        r.polls++;
+        r.queuedAtPoll += static_cast<uint64_t>(queue.Stats().queued);
+        Frame frame;
+        const bool hit = queue.Pop(frame, now, released);
+        r.expired += released.size();
+        if (hit) {
+            const double latency = now - frame.arrivalSec;
+            if (frame.sequence <= lastDelivered) fail("out of order or repeated delivery");
+            if (policy == CaptureQueuePolicy::LatestOnly && frame.sequence != lastArrived) {
+                fail("latest-only delivered a stale frame");
+            }
+            if (policy == CaptureQueuePolicy::TimeWindow && latency > qc.windowSec + 1e-9 &&
+                frame.sequence != lastArrived) {
+                fail("time window delivered an expired frame");
+            }
+            lastDelivered = frame.sequence;
+            r.delivered++;
+            busyUntil = now + sc.copyMs * 1e-3;
+            nextPoll = std::max(nextPoll, busyUntil);
+        }
+        released.clear();
+        int resized = 0;
+        if (queue.TakePoolResize(resized)) poolSize = resized;
+        r.minPool = std::min(r.minPool, poolSize);
+        r.maxPool = std::max(r.maxPool, poolSize);
+    }
+
+    r.stats = queue.Stats();
+    if (r.stats.arrived != r.stats.consumed + r.stats.dropped + static_cast<uint64_t>(r.stats.queued)) {
+        fail("arrivals not accounted for");
+    }
+    if (policy == CaptureQueuePolicy::Fifo && sc.consumerFaster && r.stats.dropped > 0) {
+        fail("FIFO dropped frames with a faster consumer");
+    }
+    if (sc.overload && policy == CaptureQueuePolicy::Fifo) {
+        const int depth = std::min(cfg.fifoDepth, r.maxPool - 1);
+        const double meanQueued = r.polls > 0 ? static_cast<double>(r.queuedAtPoll) / r.polls : 0.0;
+        if (r.stats.maxQueued < depth || meanQueued < depth - 0.5) fail("FIFO did not back up under overload");
+    }
+    if (sc.overload && policy == CaptureQueuePolicy::TimeWindow) {
+        if (r.expired == 0) fail("time window expired no stale frames under overload");
+        if (r.maxPool <= qc.initialPoolSize) fail("time window did not grow the pool under overload");
+    }
+    if (r.minPool < qc.minPoolSize || r.maxPool > qc.maxPoolSize) fail("pool size out of bounds");
+    return r;
+}
+
+void printUsage() {
+    std::cout << "Usage: capture_queue_sim [options]" << std::endl;
+    std::cout << "  --seconds <s>       Simulated time per run (default 20)" << std::endl;
+    std::cout << "  --fifo-depth <n>    FIFO policy depth (default 3)" << std::endl;
+    std::cout << "  --window-ms <ms>    Time-window policy window (default 50)" << std::endl;
+    std::cout << "  --seed <n>          Random seed (default 1)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i+1 < argc) cfg.seconds = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--fifo-depth" && i+1 < argc) cfg.fifoDepth = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--window-ms" && i+1 < argc) cfg.windowMs = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--seed" && i+1 < argc) cfg.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    const Scenario scenarios[] = {
+        {"60 fps -> 144 Hz consumer",        60.0, 0.5, 144.0, 0.3, 0.3, 0.0,  0.0, true,  false},
+        {"144 fps -> 60 Hz consumer",       144.0, 0.3,  60.0, 0.3, 0.3, 0.0,  0.0, false, true},
+        {"60 fps -> 60 Hz, 40 ms stalls",    60.0, 1.0,  60.0, 1.0, 0.5, 2.0, 40.0, false, false},
+        {"240 fps -> 240 Hz",               240.0, 0.2, 240.0, 0.2, 0.2, 0.0,  0.0, false, false},
+        {"120 fps -> 165 Hz, slow copy",    120.0, 0.5, 165.0, 0.3, 4.0, 0.0,  0.0, true,  false},
+        {"240 fps -> 60 Hz consumer",       240.0, 0.2,  60.0, 0.3, 0.3, 0.0,  0.0, false, true},
+    };
+    const CaptureQueuePolicy policies[] = {
+        CaptureQueuePolicy::LatestOnly, CaptureQueuePolicy::Fifo, CaptureQueuePolicy::TimeWindow};
+
+    bool ok = true;
+    std::cout << std::fixed;
+    for (const Scenario& sc : scenarios) {
+        std::cout << sc.name << std::endl;
+        std::cout << "  policy        delivered  dropped  expired  starved  p50 ms  p95 ms  p99 ms  pool (min-max, resizes)" << std::endl;
+        for (CaptureQueuePolicy policy : policies) {
+            SimResult r = simulate(cfg, sc, policy);
+            const CaptureLatencyHistogram& lat = r.stats.latency;
+            std::cout << "  " << std::left << std::setw(12) << CaptureQueuePolicyName(policy) << std::right
+                      << std::setw(11) << r.delivered << std::setw(9) << r.stats.dropped << std::setw(9) << r.expired << std::setw(9) << r.starved
+                      << std::setprecision(1) << std::setw(8) << lat.PercentileSec(0.50) * 1e3
+                      << std::setw(8) << lat.PercentileSec(0.95) * 1e3 << std::setw(8) << lat.PercentileSec(0.99) * 1e3
+                      << std::setw(6) << r.stats.poolSize << " (" << r.minPool << "-" << r.maxPool << ", "
+                      << r.stats.poolResizes << ")" << std::endl;
+            for (const std::string& f : r.failures) {
+                std::cout << "    FAIL: " << f << std::endl;
+                ok = false;
+            }
+        }
+        std::cout << std::endl;
+    }
+    return ok ? 0 : 1;
+}
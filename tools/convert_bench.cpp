@@ -0,0 +1,205 @@
+// Pixel conversion benchmark: throughput of the capture-path row kernels
+// (BGRA8<->RGBA8, R10G10B10A2->BGRA8, FP16->BGRA8 tone-map, optional fused
+// 2x2 luma) at every SIMD level this CPU supports, checked bit-for-bit
+// against the scalar reference.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "pixel_convert.h"
+
+struct Config {
+    std::vector<std::pair<uint32_t, uint32_t>> sizes = {{1920, 1080}, {3840, 2160}};
+    int iterations = 20;
+};
+
+struct Case {
+    const char* name;
+    PixelFormat src;
+    PixelFormat dst;
+};
+
+const Case kCases[] = {
+    {"bgra8 copy", PixelFormat::Bgra8, PixelFormat::Bgra8},
+    {"bgra8->rgba8", PixelFormat::Bgra8, PixelFormat::Rgba8},
+    {"rgb10a2->bgra8", PixelFormat::Rgb10A2, PixelFormat::Bgra8},
+    {"fp16->bgra8", PixelFormat::Rgba16F, PixelFormat::Bgra8},
+};
+
+uint32_t xorshift(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+uint16_t floatToHalf(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = (bits >> 13) & 0x3FFu;
+    if (exponent <= 0) return static_cast<uint16_t>(sign);
+    if (exponent >= 31) return static_cast<uint16_t>(sign | 0x7C00u);
+    return static_cast<uint16_t>(sign | (static_cast<uint32_t>(exponent) << 10) | mantissa);
+}
+
+size_t alignPitch(size_t bytes) {
+    return (bytes + 255) / 256 * 256;
+}
+
+// Smooth gradients with noise, roughly like game frames; FP16 also gets
+// HDR highlights, negatives and the odd NaN/Inf/denormal.
+void fillSource(std::vector<uint8_t>& buf, PixelFormat format, uint32_t w, uint32_t h, size_t pitch) {
+    uint32_t state = 0x12345678u;
+    for (uint32_t y = 0; y < h; y++) {
+        uint8_t* row = buf.data() + pitch * y;
+        for (uint32_t x = 0; x < w; x++) {
+            uint32_t noise = xorshift(state);
+            float base = static_cast<float>((x + y) % 512) / 511.0f;
+            switch (format) {
+                case PixelFormat::Bgra8:
+                case PixelFormat::Rgba8:
+                    for (int c = 0; c < 4; c++) row[x * 4 + c] = static_cast<uint8_t>(base * 200.0f + ((noise >> (c * 8)) & 55));
+                    break;
+                case PixelFormat::Rgb10A2: {
+                    uint32_t v = (noise & 0x3FFu) | (((noise >> 10) & 0x3FFu) << 10) | (((noise >> 20) & 0x3FFu) << 20) | (3u << 30);
+                    std::memcpy(row + x * 4, &v, sizeof(v));
+                    break;
+                }
+                case PixelFormat::Rgba16F: {
+                    uint16_t px[4];
+                    for (int c = 0; c < 3; c++) {
+                        float v = base * 4.0f + static_cast<float>((noise >> (c * 8)) & 0xFF) / 255.0f - 0.1f;
+                        px[c] = floatToHalf(v);
+                    }
+                    px[3] = floatToHalf(1.0f);
+                    if ((noise & 0xFFFu) == 0) px[noise % 3] = static_cast<uint16_t>(xorshift(state));
+                    std::memcpy(row + x * 8, px, sizeof(px));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+struct Result {
+    double ms = 0.0;
+    double gbs = 0.0;
+    bool exact = true;
+};
+
+Result run(const Case& c, uint32_t w, uint32_t h, bool luma, SimdLevel level, const Config& cfg,
+           const std::vector<uint8_t>& src, size_t srcPitch,
+           std::vector<uint8_t>& dst, std::vector<uint8_t>& lumaBuf,
+           const std::vector<uint8_t>* refDst, const std::vector<uint8_t>* refLuma) {
+    PixelConvertParams p;
+    p.srcFormat = c.src;
+    p.dstFormat = c.dst;
+    p.width = w;
+    p.height = h;
+    p.src = src.data();
+    p.srcPitch = srcPitch;
+    p.dst = dst.data();
+    p.dstPitch = static_cast<size_t>(w) * 4;
+    if (luma) {
+        p.luma = lumaBuf.data();
+        p.lumaPitch = static_cast<size_t>(w / 2) * 2;
+    }
+
+    Result r;
+    ConvertPixels(p, level);   // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < cfg.iterations; i++) {
+        ConvertPixels(p, level);
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.ms = sec / cfg.iterations * 1000.0;
+    double bytes = static_cast<double>(w) * h * (PixelFormatBytes(c.src) + 4) + (luma ? (w / 2) * 2.0 * (h / 2) : 0.0);
+    r.gbs = sec > 0.0 ? bytes * cfg.iterations / sec / 1e9 : 0.0;
+    if (refDst) r.exact = dst == *refDst;
+    if (refLuma && luma) r.exact = r.exact && lumaBuf == *refLuma;
+    return r;
+}
+
+void printUsage() {
+    std::cout << "Usage: convert_bench [options]" << std::endl;
+    std::cout << "  --size <W>x<H>     Add a frame size (default 1920x1080, 3840x2160)" << std::endl;
+    std::cout << "  --iterations <n>   Conversions per measurement (default 20)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    bool customSizes = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i+1 < argc) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) { printUsage(); return 1; }
+            if (!customSizes) { cfg.sizes.clear(); customSizes = true; }
+            cfg.sizes.push_back({static_cast<uint32_t>(std::atoi(v.substr(0, x).c_str())),
+                                 static_cast<uint32_t>(std::atoi(v.substr(x + 1).c_str()))});
+        }
+        else if (arg == "--iterations" && i+1 < argc) cfg.iterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    SimdLevel best = DetectSimdLevel();
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    if (best == SimdLevel::Neon) {
+        levels.push_back(SimdLevel::Neon);
+    } else {
+        if (best >= SimdLevel::Sse41) levels.push_back(SimdLevel::Sse41);
+        if (best >= SimdLevel::Avx2) levels.push_back(SimdLevel::Avx2);
+    }
+    std::cout << "Best SIMD level: " << SimdLevelName(best) << std::endl;
+    std::cout << "GB/s counts source + destination (+ luma) bytes." << std::endl;
+
+    bool allExact = true;
+    std::cout << std::fixed;
+    for (const auto& size : cfg.sizes) {
+        uint32_t w = size.first;
+        uint32_t h = size.second;
+        if (w == 0 || h == 0) continue;
+        std::cout << std::endl << w << "x" << h << std::endl;
+        std::cout << "case             luma  level        ms/frame     GB/s  speedup  exact" << std::endl;
+        for (const Case& c : kCases) {
+            size_t srcPitch = alignPitch(static_cast<size_t>(w) * PixelFormatBytes(c.src));
+            std::vector<uint8_t> src(srcPitch * h);
+            fillSource(src, c.src, w, h, srcPitch);
+            for (bool luma : {false, true}) {
+                std::vector<uint8_t> refDst(static_cast<size_t>(w) * h * 4);
+                std::vector<uint8_t> refLuma(static_cast<size_t>(w / 2) * 2 * (h / 2) + 1);
+                double scalarMs = 0.0;
+                for (SimdLevel level : levels) {
+                    bool isRef = level == SimdLevel::Scalar;
+                    std::vector<uint8_t> dst(refDst.size());
+                    std::vector<uint8_t> lumaBuf(refLuma.size());
+                    Result r = run(c, w, h, luma, level, cfg, src, srcPitch,
+                                   isRef ? refDst : dst, isRef ? refLuma : lumaBuf,
+                                   isRef ? nullptr : &refDst, isRef ? nullptr : &refLuma);
+                    if (isRef) scalarMs = r.ms;
+                    allExact = allExact && r.exact;
+                    std::cout << std::left << std::setw(17) << c.name << std::setw(6) << (luma ? "yes" : "no")
+                              << std::setw(9) << SimdLevelName(level) << std::right
+                              << std::setprecision(3) << std::setw(12) << r.ms
+                              << std::setprecision(2) << std::setw(9) << r.gbs
+                              << std::setw(8) << (r.ms > 0.0 ? scalarMs / r.ms : 0.0) << "x"
+                              << std::setw(7) << (isRef ? "ref" : (r.exact ? "yes" : "NO")) << std::endl;
+                }
+            }
+        }
+    }
+    if (!allExact) {
+        std::cout << "FAIL: SIMD output differs from the scalar reference" << std::endl;
+        return 1;
+    }
+    return 0;
+}
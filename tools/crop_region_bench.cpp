@@ -0,0 +1,146 @@
+// DXGI Crop benchmark: the window region of a duplicated monitor frame is
+// either cropped into an intermediate texture and then copied into the frame
+// queue (old path), or copied straight into the queue slot from the monitor
+// frame (region path). Runs the CPU equivalent of both copies, checks that the
+// queue slot matches, and counts window geometry reads with the cached
+// tracker against one per frame while the window is dragged now and then.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "capture_region.h"
+
+struct Config {
+    int monitorWidth = 3840;
+    int monitorHeight = 2160;
+    int windowWidth = 1920;
+    int windowHeight = 1080;
+    int frames = 240;
+    int moveEvery = 60;     // frames between window drags
+    int moveFrames = 10;    // frames each drag lasts
+};
+
+bool parseSize(const std::string& v, int& w, int& h) {
+    size_t x = v.find('x');
+    if (x == std::string::npos) return false;
+    w = std::atoi(v.substr(0, x).c_str());
+    h = std::atoi(v.substr(x + 1).c_str());
+    return w > 0 && h > 0;
+}
+
+void fillFrame(std::vector<uint8_t>& buf, int w, int h, size_t pitch, uint32_t seed) {
+    for (int y = 0; y < h; y++) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(buf.data() + pitch * y);
+        for (int x = 0; x < w; x++) {
+            uint32_t v = (static_cast<uint32_t>(x) * 0x9E3779B1u) ^ (static_cast<uint32_t>(y) * 0x85EBCA77u) ^ seed;
+            row[x] = 0xFF000000u | (v & 0xFFFFFF);
+        }
+    }
+}
+
+void printUsage() {
+    std::cout << "Usage: crop_region_bench [options]" << std::endl;
+    std::cout << "  --monitor <W>x<H>   Duplicated monitor size (default 3840x2160)" << std::endl;
+    std::cout << "  --window <W>x<H>    Window client size (default 1920x1080)" << std::endl;
+    std::cout << "  --frames <n>        Frames to run (default 240)" << std::endl;
+    std::cout << "  --move-every <n>    Frames between window drags, 0 = never (default 60)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--monitor" && i+1 < argc) {
+            if (!parseSize(argv[++i], cfg.monitorWidth, cfg.monitorHeight)) { printUsage(); return 1; }
+        }
+        else if (arg == "--window" && i+1 < argc) {
+            if (!parseSize(argv[++i], cfg.windowWidth, cfg.windowHeight)) { printUsage(); return 1; }
+        }
+        else if (arg == "--frames" && i+1 < argc) cfg.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--move-every" && i+1 < argc) cfg.moveEvery = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    const uint32_t bpp = 4;
+    const size_t monitorPitch = static_cast<size_t>(cfg.monitorWidth) * bpp;
+    std::vector<uint8_t> monitor(monitorPitch * cfg.monitorHeight);
+    fillFrame(monitor, cfg.monitorWidth, cfg.monitorHeight, monitorPitch, 0x5EEDu);
+
+    // Slots and the intermediate are sized for the largest possible region.
+    const size_t slotPitch = monitorPitch;
+    std::vector<uint8_t> crop(monitor.size());
+    std::vector<uint8_t> slotOld(monitor.size());
+    std::vector<uint8_t> slotNew(monitor.size());
+
+    CaptureRegionTracker tracker;
+    int windowX = 200;
+    int windowY = 150;
+    double oldSec = 0.0;
+    double newSec = 0.0;
+    uint64_t bytesOld = 0;
+    uint64_t bytesNew = 0;
+    bool exact = true;
+    for (int t = 0; t < cfg.frames; t++) {
+        // A drag moves the window (and sends location-change events) for a
+        // few frames; a drag ending partly off the monitor exercises clamping.
+        bool moving = cfg.moveEvery > 0 && t > 0 && t % cfg.moveEvery < cfg.moveFrames;
+        if (moving) {
+            windowX += 37;
+            windowY += 11;
+            if (windowX > cfg.monitorWidth - cfg.windowWidth / 2) windowX = -cfg.windowWidth / 4;
+            if (windowY > cfg.monitorHeight - cfg.windowHeight / 2) windowY = 0;
+            tracker.Invalidate();
+        }
+        CaptureRegion region = ClampCaptureRegion(windowX, windowY, cfg.windowWidth, cfg.windowHeight,
+                                                  0, 0, cfg.monitorWidth, cfg.monitorHeight);
+        if (tracker.NeedsRefresh(cfg.monitorWidth, cfg.monitorHeight)) {
+            tracker.Update(region, cfg.monitorWidth, cfg.monitorHeight);
+        }
+        const CaptureRegion& cached = tracker.Region();
+        if (cached != region) exact = false;
+        if (region.Empty()) continue;
+
+        const size_t cropPitch = static_cast<size_t>(region.width) * bpp;
+        auto oldStart = std::chrono::steady_clock::now();
+        CopyCaptureRegion(region, monitor.data(), monitorPitch, crop.data(), cropPitch, bpp);
+        CaptureRegion whole;
+        whole.width = region.width;
+        whole.height = region.height;
+        CopyCaptureRegion(whole, crop.data(), cropPitch, slotOld.data(), slotPitch, bpp);
+        auto newStart = std::chrono::steady_clock::now();
+        CopyCaptureRegion(cached, monitor.data(), monitorPitch, slotNew.data(), slotPitch, bpp);
+        auto newEnd = std::chrono::steady_clock::now();
+        oldSec += std::chrono::duration<double>(newStart - oldStart).count();
+        newSec += std::chrono::duration<double>(newEnd - newStart).count();
+
+        const uint64_t regionBytes = static_cast<uint64_t>(region.width) * region.height * bpp;
+        bytesOld += regionBytes * 4;    // read + write, twice
+        bytesNew += regionBytes * 2;
+        for (int y = 0; y < region.height && exact; y++) {
+            exact = std::memcmp(slotOld.data() + slotPitch * y, slotNew.data() + slotPitch * y, cropPitch) == 0;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "monitor " << cfg.monitorWidth << "x" << cfg.monitorHeight << ", window " << cfg.windowWidth << "x"
+              << cfg.windowHeight << ", " << cfg.frames << " frames" << std::endl;
+    std::cout << "  crop + queue copy   " << oldSec / cfg.frames * 1000.0 << " ms/frame  "
+              << bytesOld / static_cast<double>(cfg.frames) / 1e6 << " MB/frame" << std::endl;
+    std::cout << "  region queue copy   " << newSec / cfg.frames * 1000.0 << " ms/frame  "
+              << bytesNew / static_cast<double>(cfg.frames) / 1e6 << " MB/frame" << std::endl;
+    std::cout << "  geometry reads      " << tracker.Refreshes() << " cached vs " << cfg.frames << " per-frame ("
+              << tracker.Changes() << " region changes)" << std::endl;
+    std::cout << "  queue slot exact:   " << (exact ? "yes" : "NO") << std::endl;
+    if (!exact) {
+        std::cout << "FAIL: region copy differs from the crop + copy path" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,583 @@
+// Optical flow accuracy: scores motion fields in Middlebury .flo format
+// against ground truth (average endpoint error, KITTI-style outlier
+// percentage, error inside and outside an occlusion mask).
+//
+// With --estimate / --truth it scores one exported field, e.g. a level
+// written by the app's "Export Motion Fields" button against a rendered
+// ground truth. Lower-resolution estimates are resampled to the truth's
+// size with their vectors scaled.
+//
+// Without them it runs ReferenceInterpolator on a synthetic clip with known
+// flow (a panning background and a block moving against it, which occludes
+// part of the background), for every motion model and pipeline, and reports
+// ms per frame next to the error of every pyramid level, so the speed and
+// accuracy of a model can be compared with numbers. --scenario runs the
+// sweep on a SyntheticMotionGenerator clip instead; pairs across a scene cut
+// are executed but not scored. --out DIR keeps the per-level .flo files. Both modes end with the format / metric self-checks.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "deadline_wait.h"
+#include "flow_io.h"
+#include "motion_model.h"
+#include "reference_interpolator.h"
+#include "synthetic_motion.h"
+
+struct Config {
+    std::string estimatePath;
+    std::string truthPath;
+    std::string occlusionPath;
+    std::string outDir;
+    std::string scenario;             // SyntheticMotionGenerator clip instead of the built-in one
+    int width = 640;
+    int height = 360;
+    int frames = 6;
+    float bgDx = 5.5f;                // synthetic background motion, px/frame
+    float bgDy = 2.0f;
+    int blockDx = -9;                 // synthetic block motion, px/frame
+    int blockDy = 5;
+};
+
+void printUsage() {
+    std::cout << "Usage: flow_eval [options]\n"
+              << "Score a file:\n"
+              << "  --estimate F.flo     estimated flow (any resolution)\n"
+              << "  --truth F.flo        ground-truth flow\n"
+              << "  --occlusion F.png    occlusion mask at truth size, non-zero = occluded\n"
+              << "Synthetic sweep (default):\n"
+              << "  --size WxH           clip size (default 640x360)\n"
+              << "  --frames N           frames, N-1 pairs (default 6)\n"
+              << "  --scenario NAME      generated clip: pan, rotatezoom, fastobjects, periodic,\n"
+              << "                       hudoverlay, fade, scenecut\n"
+              << "  --out DIR            write per-level .flo files and the ground truth to DIR\n";
+}
+
+// ----------------------------------------------------------------------------
+// Synthetic clip with ground truth
+// ----------------------------------------------------------------------------
+
+struct Clip {
+    int width = 0;
+    int height = 0;
+    std::vector<std::vector<uint8_t>> frames;   // Bgra8, tightly packed
+    std::vector<FlowField> truth;               // frame i -> i+1
+    std::vector<std::vector<uint8_t>> occlusion;
+    std::vector<uint8_t> cut;                   // pair crosses a scene cut: not scored
+
+    CpuFrame Frame(size_t i) const {
+        CpuFrame frame;
+        frame.data = frames[i].data();
+        frame.pitch = static_cast<size_t>(width) * 4;
+        frame.width = width;
+        frame.height = height;
+        frame.format = PixelFormat::Bgra8;
+        frame.sequence = i;
+        return frame;
+    }
+};
+
+// Same four-octave value noise as tmfe_bench. The background pans by
+// (bgDx, bgDy) per frame; the block carries its own texture and moves by
+// (blockDx, blockDy). A background pixel is occluded when its destination
+// is under the block in the next frame or outside the frame.
+void makeSynthetic(const Config& cfg, Clip& clip) {
+    clip.width = cfg.width;
+    clip.height = cfg.height;
+    constexpr int kCell = 8;
+    const int cellsX = cfg.width / kCell + 160;
+    const int cellsY = cfg.height / kCell + 160;
+    std::vector<float> lattice(static_cast<size_t>(cellsX) * cellsY * 3);
+    uint32_t state = 12345u;
+    for (float& v : lattice) {
+        state = state * 1664525u + 1013904223u;
+        v = static_cast<float>(state >> 24) - 128.0f;
+    }
+    auto octave = [&](float x, float y, int c, int cell) {
+        x = std::max(0.0f, x) / cell;
+        y = std::max(0.0f, y) / cell;
+        const int x0 = std::min(static_cast<int>(x), cellsX - 2);
+        const int y0 = std::min(static_cast<int>(y), cellsY - 2);
+        const float fx = x - x0, fy = y - y0;
+        const float sx = fx * fx * (3 - 2 * fx), sy = fy * fy * (3 - 2 * fy);
+        auto at = [&](int xx, int yy) { return lattice[(static_cast<size_t>(yy) * cellsX + xx) * 3 + c]; };
+        const float top = at(x0, y0) + (at(x0 + 1, y0) - at(x0, y0)) * sx;
+        const float bottom = at(x0, y0 + 1) + (at(x0 + 1, y0 + 1) - at(x0, y0 + 1)) * sx;
+        return top + (bottom - top) * sy;
+    };
+    auto noise = [&](float x, float y, int c) {
+        return 128.0f + 0.9f * octave(x, y, c, kCell * 8) + 0.45f * octave(x, y, c, kCell * 4) +
+               0.25f * octave(x, y, c, kCell * 2) + 0.15f * octave(x, y, c, kCell);
+    };
+    const int blockW = cfg.width / 5, blockH = cfg.height / 4;
+    auto blockX = [&](int f) { return cfg.width / 2 + cfg.blockDx * f; };
+    auto blockY = [&](int f) { return cfg.height / 4 + cfg.blockDy * f; };
+    auto inBlock = [&](float x, float y, int f) {
+        return x >= blockX(f) && x < blockX(f) + blockW && y >= blockY(f) && y < blockY(f) + blockH;
+    };
+
+    for (int f = 0; f < cfg.frames; ++f) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(cfg.width) * cfg.height * 4);
+        const float bgX = cfg.bgDx * f, bgY = cfg.bgDy * f;
+        for (int y = 0; y < cfg.height; ++y) {
+            for (int x = 0; x < cfg.width; ++x) {
+                const bool block = inBlock(static_cast<float>(x), static_cast<float>(y), f);
+                uint8_t* p = &pixels[(static_cast<size_t>(y) * cfg.width + x) * 4];
+                for (int c = 0; c < 3; ++c) {
+                    const float v = block ? 255.0f - noise(x - blockX(f) + 200.0f, y - blockY(f) + 200.0f, c)
+                                          : noise(x - bgX + 400.0f, y - bgY + 400.0f, c);
+                    p[c] = static_cast<uint8_t>(std::clamp(v, 0.0f, 255.0f));
+                }
+                p[3] = 255;
+            }
+        }
+        clip.frames.push_back(std::move(pixels));
+    }
+
+    for (int f = 0; f + 1 < cfg.frames; ++f) {
+        FlowField flow;
+        flow.Resize(cfg.width, cfg.height);
+        std::vector<uint8_t> mask(static_cast<size_t>(cfg.width) * cfg.height, 0);
+        for (int y = 0; y < cfg.height; ++y) {
+            for (int x = 0; x < cfg.width; ++x) {
+                const size_t i = static_cast<size_t>(y) * cfg.width + x;
+                const bool block = inBlock(static_cast<float>(x), static_cast<float>(y), f);
+                const float u = block ? static_cast<float>(cfg.blockDx) : cfg.bgDx;
+                const float v = block ? static_cast<float>(cfg.blockDy) : cfg.bgDy;
+                flow.uv[i * 2 + 0] = u;
+                flow.uv[i * 2 + 1] = v;
+                const float tx = x + u, ty = y + v;
+                const bool outside = tx < 0.0f || ty < 0.0f || tx > cfg.width - 1 || ty > cfg.height - 1;
+                mask[i] = (outside || (!block && inBlock(tx, ty, f + 1))) ? 255 : 0;
+            }
+        }
+        clip.truth.push_back(std::move(flow));
+        clip.occlusion.push_back(std::move(mask));
+    }
+}
+
+// Same clip layout from a SyntheticMotionGenerator scenario.
+bool makeScenario(const Config& cfg, Clip& clip, std::string& error) {
+    SyntheticSettings settings;
+    if (!ParseSyntheticScenario(cfg.scenario, settings.scenario)) {
+        error = "unknown scenario " + cfg.scenario;
+        return false;
+    }
+    settings.width = cfg.width;
+    settings.height = cfg.height;
+    settings.frames = cfg.frames;
+    SyntheticMotionGenerator generator;
+    if (!generator.Configure(settings)) {
+        error = generator.GetLastError();
+        return false;
+    }
+    clip.width = cfg.width;
+    clip.height = cfg.height;
+    clip.frames.resize(cfg.frames);
+    for (int f = 0; f < cfg.frames; ++f) {
+        generator.RenderFrame(f, clip.frames[f]);
+    }
+    clip.truth.resize(cfg.frames - 1);
+    clip.occlusion.resize(cfg.frames - 1);
+    for (int pair = 0; pair + 1 < cfg.frames; ++pair) {
+        clip.cut.push_back(generator.RenderTruth(pair, clip.truth[pair], clip.occlusion[pair]) ? 0 : 1);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Sweep
+// ----------------------------------------------------------------------------
+
+FlowField toField(const FlowPlane& plane) {
+    FlowField field;
+    field.width = plane.width;
+    field.height = plane.height;
+    field.uv = plane.xy;
+    return field;
+}
+
+struct LevelResult {
+    const char* name = "";
+    int scale = 1;
+    double aee = 0.0;
+    double aeeNoc = 0.0;
+    double aeeOcc = 0.0;
+    double outliers = 0.0;
+    int pairs = 0;
+};
+
+struct SweepResult {
+    std::string name;
+    bool minimal = true;
+    double msPerFrame = 0.0;
+    std::vector<LevelResult> levels;
+    LevelResult final;
+};
+
+void accumulate(LevelResult& level, const FlowErrorStats& stats) {
+    level.aee += stats.all.aee;
+    level.aeeNoc += stats.nonOccluded.aee;
+    level.aeeOcc += stats.occluded.aee;
+    level.outliers += stats.all.outliers;
+    ++level.pairs;
+}
+
+void finish(LevelResult& level) {
+    if (level.pairs > 0) {
+        level.aee /= level.pairs;
+        level.aeeNoc /= level.pairs;
+        level.aeeOcc /= level.pairs;
+        level.outliers /= level.pairs;
+    }
+}
+
+void printLevel(const std::string& label, const LevelResult& level) {
+    std::cout << "    " << std::left << std::setw(16) << label << std::right << std::fixed << std::setprecision(2)
+              << " AEE " << std::setw(6) << level.aee << "  noc " << std::setw(6) << level.aeeNoc << "  occ "
+              << std::setw(6) << level.aeeOcc << "  Fl " << std::setw(6) << level.outliers << "%" << std::endl;
+}
+
+bool runSweep(const Config& cfg, const Clip& clip, std::vector<SweepResult>& results, std::string& error) {
+    ReferenceInterpolator interpolator;
+    if (!interpolator.Resize(clip.width, clip.height)) {
+        error = "ReferenceInterpolator rejected the clip size";
+        return false;
+    }
+    for (int minimal : {1, 0}) {
+        for (int model = 0; model < kMotionModelCount; ++model) {
+            ReferenceSettings settings;
+            settings.motionModel = model;
+            settings.minimalPipeline = minimal != 0;
+            settings.aliasTransients = false;   // every level is scored after Execute
+            interpolator.SetSettings(settings);
+
+            SweepResult result;
+            result.name = std::string(MotionModelName(model)) + (minimal ? " minimal" : " full");
+            result.minimal = minimal != 0;
+            struct LevelSource {
+                const char* name;
+                int scale;
+                const FlowPlane& (ReferenceInterpolator::*get)(bool) const;
+            };
+            std::vector<LevelSource> sources = {{"eighth", 8, &ReferenceInterpolator::EighthMotion}};
+            if (!minimal) {
+                sources.push_back({"quarter", 4, &ReferenceInterpolator::QuarterMotion});
+                sources.push_back({"half", 2, &ReferenceInterpolator::HalfMotion});
+            }
+            result.levels.resize(sources.size());
+            double seconds = 0.0;
+            for (size_t pair = 0; pair < clip.truth.size(); ++pair) {
+                const double start = DeadlineWaiter::Now();
+                interpolator.Execute(clip.Frame(pair), clip.Frame(pair + 1), 0.5f);
+                seconds += DeadlineWaiter::Now() - start;
+                if (!clip.cut.empty() && clip.cut[pair]) {
+                    continue;
+                }
+
+                for (size_t l = 0; l < sources.size(); ++l) {
+                    FlowField field = toField((interpolator.*sources[l].get)(false));
+                    if (!cfg.outDir.empty()) {
+                        const std::string path = cfg.outDir + "/" + MotionModelName(model) + (minimal ? "_minimal_" : "_full_") +
+                                                 sources[l].name + "_" + std::to_string(pair) + ".flo";
+                        if (!WriteFlo(path, field) || !ReadFlo(path, field)) {
+                            error = "cannot write " + path;
+                            return false;
+                        }
+                    }
+                    FlowErrorStats stats;
+                    if (!EvaluateFlow(field, clip.truth[pair], &clip.occlusion[pair], stats)) {
+                        error = std::string("evaluation failed at ") + sources[l].name;
+                        return false;
+                    }
+                    result.levels[l].name = sources[l].name;
+                    result.levels[l].scale = sources[l].scale;
+                    accumulate(result.levels[l], stats);
+                }
+                FlowErrorStats stats;
+                EvaluateFlow(toField(interpolator.ForwardMotion()), clip.truth[pair], &clip.occlusion[pair], stats);
+                accumulate(result.final, stats);
+            }
+            for (LevelResult& level : result.levels) {
+                finish(level);
+            }
+            finish(result.final);
+            result.final.name = "final";
+            result.final.scale = interpolator.MotionScale();
+            result.msPerFrame = seconds * 1e3 / std::max<size_t>(1, clip.truth.size());
+            results.push_back(std::move(result));
+        }
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Single file
+// ----------------------------------------------------------------------------
+
+bool loadMask(const std::string& path, int width, int height, std::vector<uint8_t>& mask, std::string& error) {
+    int w = 0, h = 0, channels = 0;
+    unsigned char* pixels = stbi_load(path.c_str(), &w, &h, &channels, 1);
+    if (!pixels) {
+        error = "cannot read " + path;
+        return false;
+    }
+    if (w != width || h != height) {
+        stbi_image_free(pixels);
+        error = path + " does not match the truth size";
+        return false;
+    }
+    mask.assign(pixels, pixels + static_cast<size_t>(w) * h);
+    stbi_image_free(pixels);
+    return true;
+}
+
+int scoreFiles(const Config& cfg) {
+    FlowField estimate;
+    FlowField truth;
+    std::string error;
+    if (!ReadFlo(cfg.estimatePath, estimate, &error)) {
+        std::cout << "Error: " << cfg.estimatePath << ": " << error << std::endl;
+        return 1;
+    }
+    if (!ReadFlo(cfg.truthPath, truth, &error)) {
+        std::cout << "Error: " << cfg.truthPath << ": " << error << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> mask;
+    if (!cfg.occlusionPath.empty() && !loadMask(cfg.occlusionPath, truth.width, truth.height, mask, error)) {
+        std::cout << "Error: " << error << std::endl;
+        return 1;
+    }
+    FlowErrorStats stats;
+    if (!EvaluateFlow(estimate, truth, cfg.occlusionPath.empty() ? nullptr : &mask, stats)) {
+        std::cout << "Error: no pixels with known ground truth" << std::endl;
+        return 1;
+    }
+    std::cout << "Estimate " << estimate.width << "x" << estimate.height << ", truth " << truth.width << "x"
+              << truth.height << ", mean |truth| " << std::fixed << std::setprecision(2) << stats.meanTruthMagnitude
+              << " px, max EPE " << stats.maxEpe << " px" << std::endl;
+    auto print = [](const char* label, const FlowRegionError& r) {
+        std::cout << "  " << std::left << std::setw(14) << label << std::right << std::setw(10) << r.pixels
+                  << " px  AEE " << std::setw(7) << r.aee << "  Fl " << std::setw(6) << r.outliers << "%  <1px "
+                  << std::setw(6) << r.within1 << "%" << std::endl;
+    };
+    print("all", stats.all);
+    if (!cfg.occlusionPath.empty()) {
+        print("non-occluded", stats.nonOccluded);
+        print("occluded", stats.occluded);
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Self-checks
+// ----------------------------------------------------------------------------
+
+bool selfCheck(const std::string& dir) {
+    bool ok = true;
+    auto fail = [&](const std::string& what) {
+        std::cout << "FAIL: " << what << std::endl;
+        ok = false;
+    };
+
+    // Round trip keeps every bit, including the unknown marker.
+    FlowField a;
+    a.Resize(37, 21);
+    for (size_t i = 0; i < a.uv.size(); ++i) {
+        a.uv[i] = std::sin(static_cast<float>(i) * 0.37f) * 40.0f;
+    }
+    a.uv[10] = kFlowUnknown * 2.0f;
+    const std::string path = dir + "/flow_eval_check.flo";
+    FlowField b;
+    if (!WriteFlo(path, a) || !ReadFlo(path, b) || b.width != a.width || b.height != a.height ||
+        std::memcmp(a.uv.data(), b.uv.data(), a.uv.size() * sizeof(float)) != 0) {
+        fail(".flo round trip");
+    }
+    {
+        FILE* f = std::fopen(path.c_str(), "r+b");
+        if (f) {
+            const float bad = 1.0f;
+            std::fwrite(&bad, sizeof(bad), 1, f);
+            std::fclose(f);
+        }
+        std::string error;
+        if (ReadFlo(path, b, &error)) fail("bad magic accepted");
+        a.uv.resize(a.uv.size() - 2);
+        if (WriteFlo(path, a)) fail("short field written");
+        a.uv.resize(a.uv.size() + 2);
+        WriteFlo(path, a);
+        // Header and two vectors only.
+        std::vector<char> bytes(12 + 16);
+        FILE* r = std::fopen(path.c_str(), "rb");
+        const size_t got = r ? std::fread(bytes.data(), 1, bytes.size(), r) : 0;
+        if (r) std::fclose(r);
+        FILE* w = std::fopen(path.c_str(), "wb");
+        if (w) {
+            std::fwrite(bytes.data(), 1, got, w);
+            std::fclose(w);
+        }
+        if (ReadFlo(path, b, &error)) fail("truncated file accepted");
+        std::remove(path.c_str());
+    }
+
+    // A constant eighth-res field resamples to 8x the vectors at full res.
+    {
+        FlowField coarse;
+        coarse.Resize(10, 6);
+        for (size_t i = 0; i < coarse.uv.size(); i += 2) {
+            coarse.uv[i] = 1.25f;
+            coarse.uv[i + 1] = -0.5f;
+        }
+        FlowField full;
+        ResampleFlow(coarse, 80, 48, full);
+        bool exact = true;
+        for (size_t i = 0; i < full.uv.size(); i += 2) {
+            exact = exact && full.uv[i] == 10.0f && full.uv[i + 1] == -4.0f;
+        }
+        if (!exact) fail("constant field resampled to " + std::to_string(full.uv[0]) + "," + std::to_string(full.uv[1]));
+    }
+
+    // Exact, offset and unknown-truth scoring.
+    {
+        FlowField truth;
+        truth.Resize(64, 32);
+        for (size_t i = 0; i < truth.uv.size(); i += 2) {
+            truth.uv[i] = 10.0f;
+            truth.uv[i + 1] = 0.0f;
+        }
+        std::vector<uint8_t> mask(64 * 32, 0);
+        std::fill(mask.begin(), mask.begin() + 64 * 8, 255);
+        FlowErrorStats s;
+        if (!EvaluateFlow(truth, truth, &mask, s) || s.all.aee != 0.0 || s.all.outliers != 0.0 || s.all.within1 != 100.0) {
+            fail("exact estimate scored AEE " + std::to_string(s.all.aee));
+        }
+        FlowField est = truth;
+        for (size_t i = 0; i < est.uv.size(); i += 2) {
+            est.uv[i + 1] = (i / 2 < 64 * 8) ? 4.0f : 0.5f;    // occluded rows 4 px off, others 0.5 px
+        }
+        EvaluateFlow(est, truth, &mask, s);
+        if (s.occluded.pixels != 64 * 8 || std::fabs(s.occluded.aee - 4.0) > 1e-9 ||
+            std::fabs(s.nonOccluded.aee - 0.5) > 1e-9 || std::fabs(s.occluded.outliers - 100.0) > 1e-9 ||
+            s.nonOccluded.outliers != 0.0 || std::fabs(s.all.aee - (0.25 * 4.0 + 0.75 * 0.5)) > 1e-9) {
+            fail("region split: occ " + std::to_string(s.occluded.aee) + ", noc " + std::to_string(s.nonOccluded.aee));
+        }
+        for (size_t i = 0; i < truth.uv.size() / 2; ++i) {
+            truth.uv[i] = kFlowUnknown * 2.0f;     // top half unknown
+        }
+        EvaluateFlow(est, truth, nullptr, s);
+        if (s.all.pixels != 64 * 16 || std::fabs(s.all.aee - 0.5) > 1e-9) {
+            fail("unknown truth not skipped: " + std::to_string(s.all.pixels) + " px");
+        }
+        std::vector<uint8_t> wrong(10, 0);
+        if (EvaluateFlow(est, truth, &wrong, s)) fail("mask of the wrong size accepted");
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--estimate" && i+1 < argc) cfg.estimatePath = argv[++i];
+        else if (arg == "--truth" && i+1 < argc) cfg.truthPath = argv[++i];
+        else if (arg == "--occlusion" && i+1 < argc) cfg.occlusionPath = argv[++i];
+        else if (arg == "--out" && i+1 < argc) cfg.outDir = argv[++i];
+        else if (arg == "--size" && i+1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &cfg.width, &cfg.height) != 2 || cfg.width < 128 || cfg.height < 128) {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--frames" && i+1 < argc) cfg.frames = std::max(2, std::atoi(argv[++i]));
+        else if (arg == "--scenario" && i+1 < argc) cfg.scenario = argv[++i];
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    if (!cfg.estimatePath.empty() || !cfg.truthPath.empty()) {
+        if (cfg.estimatePath.empty() || cfg.truthPath.empty()) {
+            printUsage();
+            return 1;
+        }
+        return scoreFiles(cfg);
+    }
+
+    Clip clip;
+    if (cfg.scenario.empty()) {
+        makeSynthetic(cfg, clip);
+    } else {
+        std::string error;
+        if (!makeScenario(cfg, clip, error)) {
+            std::cout << "Error: " << error << std::endl;
+            return 1;
+        }
+    }
+    double occludedPct = 0.0;
+    for (const std::vector<uint8_t>& mask : clip.occlusion) {
+        occludedPct += 100.0 * std::count(mask.begin(), mask.end(), 255) / mask.size() / clip.occlusion.size();
+    }
+    if (cfg.scenario.empty()) {
+        std::cout << "Synthetic " << clip.width << "x" << clip.height << ", " << clip.truth.size() << " pairs, background ("
+                  << cfg.bgDx << ", " << cfg.bgDy << ") px, block (" << cfg.blockDx << ", " << cfg.blockDy << ") px, ";
+    } else {
+        std::cout << "Scenario " << cfg.scenario << " " << clip.width << "x" << clip.height << ", " << clip.truth.size()
+                  << " pairs, " << std::count(clip.cut.begin(), clip.cut.end(), 1) << " across cuts, ";
+    }
+    std::cout << std::fixed << std::setprecision(1) << occludedPct << "% occluded" << std::endl;
+    if (!cfg.outDir.empty()) {
+        for (size_t pair = 0; pair < clip.truth.size(); ++pair) {
+            WriteFlo(cfg.outDir + "/truth_" + std::to_string(pair) + ".flo", clip.truth[pair]);
+        }
+    }
+
+    std::vector<SweepResult> results;
+    std::string error;
+    if (!runSweep(cfg, clip, results, error)) {
+        std::cout << "Error: " << error << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    auto fail = [&](const std::string& what) {
+        std::cout << "FAIL: " << what << std::endl;
+        ok = false;
+    };
+    double zeroAee = 0.0;
+    {
+        FlowField zero;
+        zero.Resize(clip.width, clip.height);
+        FlowErrorStats stats;
+        EvaluateFlow(zero, clip.truth[0], &clip.occlusion[0], stats);
+        zeroAee = stats.all.aee;
+    }
+    std::cout << "Zero-motion AEE " << std::setprecision(2) << zeroAee << " px" << std::endl;
+    for (const SweepResult& r : results) {
+        std::cout << "  " << r.name << ": " << std::setprecision(2) << r.msPerFrame << " ms/frame" << std::endl;
+        for (const LevelResult& level : r.levels) {
+            printLevel(std::string(level.name) + " (1/" + std::to_string(level.scale) + ")", level);
+        }
+        printLevel("final", r.final);
+        // Any estimate worth its cost beats assuming no motion. Generated
+        // scenarios include cases built to defeat the estimator (aliased
+        // gratings), so they are reported only.
+        if (cfg.scenario.empty() && !(r.final.aee < zeroAee)) {
+            fail(r.name + " final AEE " + std::to_string(r.final.aee) + " not below zero motion");
+        }
+    }
+
+    if (!selfCheck(cfg.outDir.empty() ? "." : cfg.outDir)) {
+        ok = false;
+    }
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,262 @@
+// Shared frame ring stress benchmark. Runs the hook side (producer) and the
+// GameCapture side (consumer) of shared_frame_ring.h in two processes over a
+// POSIX shm_open mapping, the same way the hook and the app share a named
+// file mapping on Windows. Every payload word encodes its frame number, so
+// the consumer can verify each accepted copy: torn frames must always be
+// caught by the seqlock (undetected = 0).
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "deadline_wait.h"
+#include "shared_frame_ring.h"
+
+struct Config {
+    std::vector<uint32_t> slots = {2, 3, 4};
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    double seconds = 2.0;
+    double producerFps = 0.0;     // 0 = as fast as possible
+    double consumerFps = 0.0;     // 0 = poll continuously
+    double consumerWorkUs = 0.0;  // extra time spent inside each read
+};
+
+struct ProducerResult {
+    uint64_t frames = 0;
+    double writeMaxUs = 0.0;
+    double writeSumUs = 0.0;
+};
+
+struct ConsumerResult {
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    uint64_t busy = 0;
+    uint64_t skipped = 0;
+    uint64_t undetected = 0;
+    double readSumUs = 0.0;
+};
+
+uint64_t patternWord(uint64_t frame, uint64_t index) {
+    return frame * 0x9E3779B97F4A7C15ull + index;
+}
+
+void fillFrame(uint8_t* dst, uint64_t bytes, uint64_t frame) {
+    auto* words = reinterpret_cast<uint64_t*>(dst);
+    uint64_t count = bytes / sizeof(uint64_t);
+    for (uint64_t i = 0; i < count; i++) {
+        words[i] = patternWord(frame, i);
+    }
+}
+
+bool verifyFrame(const uint8_t* src, uint64_t bytes, uint64_t frame) {
+    auto* words = reinterpret_cast<const uint64_t*>(src);
+    uint64_t count = bytes / sizeof(uint64_t);
+    for (uint64_t i = 0; i < count; i++) {
+        if (words[i] != patternWord(frame, i)) return false;
+    }
+    return true;
+}
+
+ProducerResult runProducer(void* base, uint64_t size, uint32_t slots, const Config& cfg, double endSec) {
+    ProducerResult r;
+    SharedFrameRingWriter writer;
+    uint32_t pitch = cfg.width * 4;
+    if (!writer.Initialize(base, size, slots, cfg.width, cfg.height, pitch, 87, 1000000000)) {
+        return r;
+    }
+    uint64_t bytes = static_cast<uint64_t>(pitch) * cfg.height;
+    double interval = cfg.producerFps > 0.0 ? 1.0 / cfg.producerFps : 0.0;
+    DeadlineWaiter waiter;
+    double next = DeadlineWaiter::Now();
+    while (DeadlineWaiter::Now() < endSec) {
+        if (interval > 0.0) {
+            waiter.WaitUntil(next);
+            next += interval;
+        }
+        double start = DeadlineWaiter::Now();
+        uint8_t* dst = writer.BeginWrite();
+        // The frame number EndWrite will assign is frames + 1.
+        fillFrame(dst, bytes, r.frames + 1);
+        writer.EndWrite(static_cast<int64_t>(start * 1e9));
+        double us = (DeadlineWaiter::Now() - start) * 1e6;
+        r.frames++;
+        r.writeSumUs += us;
+        r.writeMaxUs = std::max(r.writeMaxUs, us);
+    }
+    return r;
+}
+
+ConsumerResult runConsumer(const void* base, uint64_t size, const Config& cfg, double endSec) {
+    ConsumerResult r;
+    SharedFrameRingReader reader;
+    while (!reader.Attach(base, size)) {
+        if (DeadlineWaiter::Now() > endSec) return r;
+        usleep(100);
+    }
+    uint64_t bytes = static_cast<uint64_t>(reader.Header()->pitch) * reader.Header()->height;
+    std::vector<uint8_t> copy(bytes);
+    double interval = cfg.consumerFps > 0.0 ? 1.0 / cfg.consumerFps : 0.0;
+    DeadlineWaiter waiter;
+    double next = DeadlineWaiter::Now();
+    while (DeadlineWaiter::Now() < endSec) {
+        if (interval > 0.0) {
+            waiter.WaitUntil(next);
+            next += interval;
+        }
+        SharedFrameView view;
+        double start = DeadlineWaiter::Now();
+        if (!reader.BeginRead(&view)) continue;
+        std::memcpy(copy.data(), view.data, bytes);
+        if (cfg.consumerWorkUs > 0.0) {
+            DeadlineWaiter::SpinUntil(DeadlineWaiter::Now() + cfg.consumerWorkUs * 1e-6);
+        }
+        if (!reader.EndRead(view)) continue;
+        r.readSumUs += (DeadlineWaiter::Now() - start) * 1e6;
+        if (!verifyFrame(copy.data(), bytes, view.frame)) {
+            r.undetected++;
+        }
+    }
+    const SharedFrameRingStats& stats = reader.Stats();
+    r.reads = stats.reads;
+    r.torn = stats.torn;
+    r.busy = stats.busy;
+    r.skipped = stats.skipped;
+    return r;
+}
+
+bool runCase(uint32_t slots, const Config& cfg) {
+    uint32_t pitch = cfg.width * 4;
+    uint64_t size = shared_frame_ring::MappingSize(slots, pitch, cfg.height);
+    std::string name = "/tfe_frame_ring_" + std::to_string(getpid());
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0) {
+        std::cerr << "shm_open failed" << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "ftruncate failed" << std::endl;
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "mmap failed" << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    int pipeFd[2];
+    if (pipe(pipeFd) != 0) {
+        munmap(base, size);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    double endSec = DeadlineWaiter::Now() + cfg.seconds;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(pipeFd[0]);
+        ProducerResult p = runProducer(base, size, slots, cfg, endSec);
+        ssize_t written = write(pipeFd[1], &p, sizeof(p));
+        close(pipeFd[1]);
+        _exit(written == static_cast<ssize_t>(sizeof(p)) ? 0 : 1);
+    }
+    close(pipeFd[1]);
+
+    ConsumerResult c = runConsumer(base, size, cfg, endSec);
+    ProducerResult p;
+    bool gotProducer = read(pipeFd[0], &p, sizeof(p)) == static_cast<ssize_t>(sizeof(p));
+    close(pipeFd[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    munmap(base, size);
+    shm_unlink(name.c_str());
+    if (!gotProducer) {
+        std::cerr << "producer failed" << std::endl;
+        return false;
+    }
+
+    double frameMb = static_cast<double>(pitch) * cfg.height / (1024.0 * 1024.0);
+    double produceGbs = p.writeSumUs > 0.0 ? frameMb * p.frames / 1024.0 / (p.writeSumUs * 1e-6) : 0.0;
+    std::cout << std::setw(5) << slots
+              << std::setw(9) << p.frames
+              << std::setw(10) << p.frames / cfg.seconds
+              << std::setw(10) << (p.frames ? p.writeSumUs / p.frames : 0.0)
+              << std::setw(10) << p.writeMaxUs
+              << std::setw(8) << produceGbs
+              << std::setw(9) << c.reads
+              << std::setw(9) << c.skipped
+              << std::setw(8) << c.torn
+              << std::setw(9) << c.busy
+              << std::setw(11) << c.undetected << std::endl;
+    return c.undetected == 0;
+}
+
+void printUsage() {
+    std::cout << "Usage: frame_ring_bench [options]" << std::endl;
+    std::cout << "  --slots <n>            Add a ring size (default 2, 3, 4)" << std::endl;
+    std::cout << "  --size <W>x<H>         Frame size (default 1920x1080)" << std::endl;
+    std::cout << "  --seconds <f>          Duration per case (default 2)" << std::endl;
+    std::cout << "  --producer-fps <f>     Producer rate, 0 = unlimited (default 0)" << std::endl;
+    std::cout << "  --consumer-fps <f>     Consumer poll rate, 0 = continuous (default 0)" << std::endl;
+    std::cout << "  --consumer-work-us <f> Time held inside each read (default 0)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    bool customSlots = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--slots" && i+1 < argc) {
+            if (!customSlots) { cfg.slots.clear(); customSlots = true; }
+            cfg.slots.push_back(static_cast<uint32_t>(std::atoi(argv[++i])));
+        }
+        else if (arg == "--size" && i+1 < argc) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) { printUsage(); return 1; }
+            cfg.width = static_cast<uint32_t>(std::atoi(v.substr(0, x).c_str()));
+            cfg.height = static_cast<uint32_t>(std::atoi(v.substr(x + 1).c_str()));
+        }
+        else if (arg == "--seconds" && i+1 < argc) cfg.seconds = std::atof(argv[++i]);
+        else if (arg == "--producer-fps" && i+1 < argc) cfg.producerFps = std::atof(argv[++i]);
+        else if (arg == "--consumer-fps" && i+1 < argc) cfg.consumerFps = std::atof(argv[++i]);
+        else if (arg == "--consumer-work-us" && i+1 < argc) cfg.consumerWorkUs = std::atof(argv[++i]);
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+    if (cfg.width == 0 || cfg.height == 0) { printUsage(); return 1; }
+
+    std::cout << "Frame " << cfg.width << "x" << cfg.height << ", " << cfg.seconds << " s per case, producer "
+              << (cfg.producerFps > 0.0 ? std::to_string(cfg.producerFps) : std::string("unlimited"))
+              << ", consumer " << (cfg.consumerFps > 0.0 ? std::to_string(cfg.consumerFps) : std::string("continuous"))
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "slots  written     fps/s  write_us    max_us    GB/s    reads  skipped    torn     busy  undetected" << std::endl;
+
+    bool ok = true;
+    for (uint32_t slots : cfg.slots) {
+        if (slots < 2 || slots > SHARED_FRAME_RING_MAX_SLOTS) continue;
+        ok = runCase(slots, cfg) && ok;
+    }
+    if (!ok) {
+        std::cout << "FAIL: torn frames reached the consumer" << std::endl;
+        return 1;
+    }
+    return 0;
+}
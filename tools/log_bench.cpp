@@ -0,0 +1,253 @@
+// Async log benchmark: compares TFE_LOG against the open-append-close
+// ofstream pattern it replaced, then checks the flusher's output.
+//
+// Checks:
+//  - every message from several threads is written once, with its
+//    arguments, in per-thread order;
+//  - "{}", "{:x}" and brace escapes format as documented, long strings are
+//    cut at kMaxLogString;
+//  - a rate-limited site writes at most its budget and counts the rest;
+//  - levels below TFE_LOG_LEVEL are compiled out (arguments not evaluated);
+//  - a burst that overflows a thread's queue is dropped and reported.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "async_log.h"
+#include "deadline_wait.h"
+
+struct Config {
+    int messages = 20000;       // per thread
+    int threads = 4;
+    int syncMessages = 2000;
+    std::string prefix = "log_bench";
+};
+
+void printUsage() {
+    std::cout << "Usage: log_bench [options]\n"
+              << "  --messages N    messages per thread (default 20000)\n"
+              << "  --threads N     producer threads (default 4)\n"
+              << "  --sync N        messages for the ofstream baseline (default 2000)\n"
+              << "  --prefix P      output file prefix (default log_bench)\n";
+}
+
+std::vector<std::string> readLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Message text after the "[time] [tN] LEVEL " prefix.
+std::string messageText(const std::string& line) {
+    const size_t thread = line.find("] [t");
+    if (thread == std::string::npos) return line;
+    const size_t end = line.find("] ", thread + 4);
+    if (end == std::string::npos || end + 8 > line.size()) return line;
+    return line.substr(end + 8);
+}
+
+// Logs in bursts that fit a thread's queue, as a render loop would at a few
+// messages per frame. Returns the time spent inside TFE_LOG.
+double produce(int thread, int messages) {
+    constexpr int kBurst = 100;
+    double spent = 0.0;
+    for (int i = 0; i < messages; i += kBurst) {
+        const int end = std::min(messages, i + kBurst);
+        const double start = DeadlineWaiter::Now();
+        for (int seq = i; seq < end; ++seq) {
+            TFE_LOG(Info, Vulkan, "thread {} seq {} alpha {} path {}", thread, seq, 0.5, "interp");
+        }
+        spent += DeadlineWaiter::Now() - start;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return spent;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--messages" && i+1 < argc) cfg.messages = std::max(1000, std::atoi(argv[++i]));
+        else if (arg == "--threads" && i+1 < argc) cfg.threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--sync" && i+1 < argc) cfg.syncMessages = std::max(100, std::atoi(argv[++i]));
+        else if (arg == "--prefix" && i+1 < argc) cfg.prefix = argv[++i];
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    bool ok = true;
+    auto fail = [&](const std::string& what) {
+        std::cout << "FAIL: " << what << std::endl;
+        ok = false;
+    };
+    std::cout << std::fixed;
+
+    const std::string vulkanPath = cfg.prefix + "_vulkan.txt";
+    const std::string capturePath = cfg.prefix + "_capture.txt";
+    const std::string initPath = cfg.prefix + "_init.txt";
+    const std::string syncPath = cfg.prefix + "_sync.txt";
+    for (const std::string& path : {vulkanPath, capturePath, initPath, syncPath}) {
+        std::remove(path.c_str());
+    }
+    AsyncLog::SetChannelPath(LogChannel::Vulkan, vulkanPath);
+    AsyncLog::SetChannelPath(LogChannel::Capture, capturePath);
+    AsyncLog::SetChannelPath(LogChannel::Init, initPath);
+
+    // Baseline: what the crop and Vulkan logs did per message.
+    {
+        const double start = DeadlineWaiter::Now();
+        for (int i = 0; i < cfg.syncMessages; ++i) {
+            std::ofstream log(syncPath, std::ios::app);
+            log << "thread " << 0 << " seq " << i << " alpha " << 0.5 << " path " << "interp" << std::endl;
+        }
+        const double ns = (DeadlineWaiter::Now() - start) * 1e9 / cfg.syncMessages;
+        std::cout << "ofstream per message: " << std::setprecision(0) << ns << " ns/call" << std::endl;
+        std::remove(syncPath.c_str());
+    }
+
+    // Single producer, then several.
+    {
+        const double spent = produce(0, cfg.messages);
+        std::cout << "TFE_LOG, 1 thread:    " << std::setprecision(1) << spent * 1e9 / cfg.messages << " ns/call"
+                  << std::endl;
+    }
+    {
+        std::vector<std::thread> threads;
+        std::vector<double> spent(cfg.threads, 0.0);
+        for (int t = 1; t <= cfg.threads; ++t) {
+            threads.emplace_back([&, t] { spent[t - 1] = produce(t, cfg.messages); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double total = 0.0;
+        for (double s : spent) total += s;
+        std::cout << "TFE_LOG, " << cfg.threads << " threads:   " << std::setprecision(1)
+                  << total * 1e9 / (static_cast<double>(cfg.messages) * cfg.threads) << " ns/call" << std::endl;
+    }
+    AsyncLog::Flush();
+
+    {
+        const AsyncLogStats stats = AsyncLog::Stats();
+        if (stats.dropped != 0) fail("paced producers dropped " + std::to_string(stats.dropped) + " messages");
+        const std::vector<std::string> lines = readLines(vulkanPath);
+        const size_t expected = static_cast<size_t>(cfg.messages) * (cfg.threads + 1);
+        if (lines.size() != expected) {
+            fail("wrote " + std::to_string(lines.size()) + " lines, expected " + std::to_string(expected));
+        }
+        std::vector<int> next(cfg.threads + 1, 0);
+        size_t bad = 0;
+        for (const std::string& line : lines) {
+            int thread = -1;
+            int seq = -1;
+            char path[16] = {};
+            double alpha = 0.0;
+            if (std::sscanf(messageText(line).c_str(), "thread %d seq %d alpha %lf path %15s", &thread, &seq, &alpha,
+                            path) != 4 ||
+                thread < 0 || thread > cfg.threads || seq != next[thread] || alpha != 0.5 ||
+                std::string(path) != "interp") {
+                if (bad++ == 0) fail("unexpected line: " + line);
+                continue;
+            }
+            next[thread]++;
+        }
+        if (bad > 1) fail(std::to_string(bad) + " lines missing, repeated or out of order");
+        std::cout << "Written: " << stats.written << " messages, " << stats.threads << " queues registered"
+                  << std::endl;
+    }
+
+    // Formatting.
+    {
+        const std::string longText(kMaxLogString + 100, 'x');
+        TFE_LOG(Info, Init, "{{literal}} hex={:x} neg={} flag={} {} end", 255u, -7, true, std::string("temp"));
+        TFE_LOG(Warn, Init, "long {}", longText);
+        TFE_LOG(Error, Init, "missing {} {}", 1);
+        AsyncLog::Flush();
+        const std::vector<std::string> lines = readLines(initPath);
+        const std::string expected[] = {
+            "{literal} hex=ff neg=-7 flag=1 temp end",
+            "long " + std::string(kMaxLogString, 'x'),
+            "missing 1 {?}",
+        };
+        if (lines.size() != 3) {
+            fail("format lines: " + std::to_string(lines.size()));
+        } else {
+            for (int i = 0; i < 3; ++i) {
+                if (messageText(lines[i]) != expected[i]) fail("format: '" + messageText(lines[i]) + "'");
+            }
+            if (lines[1].find("] WARN  ") == std::string::npos) fail("level name: " + lines[1]);
+        }
+    }
+
+    // Rate limiting and compile-time filtering.
+    {
+        constexpr int kCalls = 1000;
+        constexpr int kBudget = 5;
+        const uint64_t suppressedBefore = AsyncLog::Stats().suppressed;
+        const double start = DeadlineWaiter::Now();
+        for (int i = 0; i < kCalls; ++i) {
+            TFE_LOG_LIMITED(Warn, Capture, kBudget, "crop moved {}", i);
+        }
+        const bool oneSecond = static_cast<int64_t>(start) == static_cast<int64_t>(DeadlineWaiter::Now());
+        int evaluated = 0;
+        for (int i = 0; i < kCalls; ++i) {
+            TFE_LOG(Trace, Capture, "trace {}", ++evaluated);
+        }
+        AsyncLog::Flush();
+        const uint64_t suppressed = AsyncLog::Stats().suppressed - suppressedBefore;
+        const size_t lines = readLines(capturePath).size();
+        const size_t budget = oneSecond ? kBudget : kBudget * 2;
+        if (lines > budget) fail("rate limited site wrote " + std::to_string(lines) + " lines");
+        if (lines + suppressed != static_cast<size_t>(kCalls)) {
+            fail("rate limit lost messages: " + std::to_string(lines) + " written + " + std::to_string(suppressed) +
+                 " suppressed");
+        }
+        if (evaluated != 0) fail("Trace arguments were evaluated");
+        std::cout << "Rate limit: " << lines << " of " << kCalls << " written, " << suppressed << " suppressed"
+                  << std::endl;
+    }
+
+    // Overflow: an unpaced burst from a fresh thread.
+    {
+        const uint64_t droppedBefore = AsyncLog::Stats().dropped;
+        std::thread burst([] {
+            for (int i = 0; i < 20000; ++i) {
+                TFE_LOG(Info, Capture, "burst {}", i);
+            }
+        });
+        burst.join();
+        AsyncLog::Flush();
+        const uint64_t dropped = AsyncLog::Stats().dropped - droppedBefore;
+        bool reported = false;
+        for (const std::string& line : readLines(capturePath)) {
+            if (line.find("messages dropped") != std::string::npos) reported = true;
+        }
+        if (dropped == 0) fail("burst did not overflow the queue");
+        else if (!reported) fail("dropped messages were not reported");
+        std::cout << "Burst: " << dropped << " of 20000 dropped" << std::endl;
+    }
+
+    AsyncLog::Shutdown();
+    // Only the main thread's queue outlives its producers.
+    if (AsyncLog::Stats().threads != 1) {
+        fail(std::to_string(AsyncLog::Stats().threads) + " queues registered after the producers exited");
+    }
+    for (const std::string& path : {vulkanPath, capturePath, initPath}) {
+        std::remove(path.c_str());
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
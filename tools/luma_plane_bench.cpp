@@ -0,0 +1,202 @@
+// Producer luma plane benchmark: what it costs the hook to emit the half-res
+// luma plane next to the color frame (plain row copy vs. fused copy + luma,
+// full frames and tile deltas) and what it saves the interpolator's first
+// feature pass, which then reads a half-size R16 plane instead of the
+// full BGRA frame. The tile-delta plane is checked against a full-frame
+// reference, and the plane against the GPU color path's float BT.709 luma.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "pixel_convert.h"
+#include "shared_frame_ring.h"
+#include "tile_delta.h"
+
+// Tolerance for the plane against float BT.709, in 8-bit steps.
+constexpr double kMaxPlaneError = 0.05;
+
+struct Config {
+    std::vector<std::pair<uint32_t, uint32_t>> sizes = {{2560, 1440}, {3840, 2160}};
+    int iterations = 30;
+    double fps = 60.0;
+};
+
+uint32_t xorshift(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void fillFrame(std::vector<uint8_t>& buf, uint32_t w, uint32_t h, size_t pitch, uint32_t seed) {
+    uint32_t state = seed | 1u;
+    for (uint32_t y = 0; y < h; y++) {
+        uint8_t* row = buf.data() + pitch * y;
+        for (uint32_t x = 0; x < w; x++) {
+            uint32_t noise = xorshift(state);
+            for (int c = 0; c < 4; c++) row[x * 4 + c] = static_cast<uint8_t>(((x + y) >> 2) + ((noise >> (c * 8)) & 31));
+        }
+    }
+}
+
+// Largest difference between the plane and the float 2x2 BT.709 mean that
+// DownsampleLuma.hlsl computes from the color frame, in 8-bit steps.
+double maxPlaneError(const std::vector<uint8_t>& frame, size_t pitch, uint32_t w, uint32_t h,
+                     const std::vector<uint8_t>& luma, size_t lumaPitch) {
+    double worst = 0.0;
+    for (uint32_t y = 0; y < h / 2; y++) {
+        for (uint32_t x = 0; x < w / 2; x++) {
+            float sum = 0.0f;
+            for (int j = 0; j < 2; j++) {
+                for (int i = 0; i < 2; i++) {
+                    const uint8_t* p = frame.data() + pitch * (y * 2 + j) + (x * 2 + i) * 4;
+                    sum += p[2] / 255.0f * 0.2126f + p[1] / 255.0f * 0.7152f + p[0] / 255.0f * 0.0722f;
+                }
+            }
+            uint16_t sample = 0;
+            std::memcpy(&sample, luma.data() + lumaPitch * y + x * 2, sizeof(sample));
+            worst = std::max(worst, std::abs(sample / 65535.0 - sum * 0.25) * 255.0);
+        }
+    }
+    return worst;
+}
+
+template <typename Fn>
+double timeMs(int iterations, Fn&& fn) {
+    fn();   // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations * 1000.0;
+}
+
+void printUsage() {
+    std::cout << "Usage: luma_plane_bench [options]" << std::endl;
+    std::cout << "  --size <W>x<H>     Add a frame size (default 2560x1440, 3840x2160)" << std::endl;
+    std::cout << "  --iterations <n>   Runs per measurement (default 30)" << std::endl;
+    std::cout << "  --fps <n>          Frame rate for the bandwidth figures (default 60)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    bool customSizes = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i+1 < argc) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) { printUsage(); return 1; }
+            if (!customSizes) { cfg.sizes.clear(); customSizes = true; }
+            cfg.sizes.push_back({static_cast<uint32_t>(std::atoi(v.substr(0, x).c_str())),
+                                 static_cast<uint32_t>(std::atoi(v.substr(x + 1).c_str()))});
+        }
+        else if (arg == "--iterations" && i+1 < argc) cfg.iterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--fps" && i+1 < argc) cfg.fps = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    std::cout << "SIMD level: " << SimdLevelName(DetectSimdLevel()) << std::endl;
+    bool allExact = true;
+    bool allMatch = true;
+    std::cout << std::fixed;
+    for (const auto& size : cfg.sizes) {
+        const uint32_t w = size.first;
+        const uint32_t h = size.second;
+        if (w < 2 || h < 2) continue;
+        const size_t srcPitch = static_cast<size_t>(w) * 4;
+        const uint32_t pitch = static_cast<uint32_t>((srcPitch + 255) / 256 * 256);
+        const uint32_t lumaPitch = static_cast<uint32_t>(shared_frame_ring::LumaPitch(w));
+        std::vector<uint8_t> src(srcPitch * h);
+        std::vector<uint8_t> slot(static_cast<size_t>(pitch) * h);
+        std::vector<uint8_t> luma(static_cast<size_t>(lumaPitch) * (h / 2));
+        fillFrame(src, w, h, srcPitch, 0x1234u + w);
+
+        PixelConvertParams p;
+        p.width = w;
+        p.height = h;
+        p.src = src.data();
+        p.srcPitch = srcPitch;
+        p.dst = slot.data();
+        p.dstPitch = pitch;
+
+        // Hook cost, full frames.
+        double copyMs = timeMs(cfg.iterations, [&] { ConvertPixels(p); });
+        p.luma = luma.data();
+        p.lumaPitch = lumaPitch;
+        double fusedMs = timeMs(cfg.iterations, [&] { ConvertPixels(p); });
+        std::vector<uint8_t> refLuma = luma;
+        const double planeError = maxPlaneError(slot, pitch, w, h, luma, lumaPitch);
+        allMatch = allMatch && planeError <= kMaxPlaneError;
+
+        // Hook cost, tile deltas: a fresh slot (everything copied) and a
+        // HUD-sized change, plus the plane check after partial updates.
+        TileDeltaEncoder encoder;
+        std::vector<uint64_t> stamps(TileDeltaEncoder::StampTableBytes(w, h) / sizeof(uint64_t));
+        encoder.Reset(w, h, 4);
+        encoder.EnableLuma(PixelFormat::Bgra8);
+        std::vector<uint8_t> deltaLuma(luma.size());
+        uint64_t frame = 1;
+        double deltaFullMs = timeMs(cfg.iterations, [&] {
+            encoder.Encode(src.data(), srcPitch, frame, slot.data(), pitch, 0, stamps.data(), deltaLuma.data(), lumaPitch);
+            frame++;
+        });
+        bool exact = deltaLuma == refLuma;
+
+        const uint32_t hudW = std::min(w, 300u);
+        const uint32_t hudH = std::min(h, 64u);
+        uint32_t hudState = 99;
+        double deltaHudMs = timeMs(cfg.iterations, [&] {
+            for (uint32_t y = 0; y < hudH; y++) {
+                uint8_t* row = src.data() + srcPitch * (h - hudH + y) + (w - hudW) * 4;
+                for (uint32_t x = 0; x < hudW * 4; x++) row[x] = static_cast<uint8_t>(xorshift(hudState));
+            }
+            encoder.Encode(src.data(), srcPitch, frame, slot.data(), pitch, frame - 1, stamps.data(), deltaLuma.data(), lumaPitch);
+            frame++;
+        });
+        std::vector<uint8_t> checkSlot(slot.size());
+        PixelConvertParams check = p;
+        check.dst = checkSlot.data();
+        check.luma = refLuma.data();
+        ConvertPixels(check);
+        exact = exact && deltaLuma == refLuma;
+        allExact = allExact && exact;
+
+        // Bytes the first feature pass reads per frame pair, and what the
+        // plane adds to the upload.
+        const double frameBytes = static_cast<double>(w) * h * 4;
+        const double planeBytes = static_cast<double>(w / 2) * 2 * (h / 2);
+        const double pairsPerSec = cfg.fps;
+        std::cout << std::endl << w << "x" << h << std::endl;
+        std::cout << std::setprecision(3);
+        std::cout << "  hook full frame   copy " << copyMs << " ms   copy+luma " << fusedMs << " ms   (+"
+                  << (fusedMs - copyMs) << " ms)" << std::endl;
+        std::cout << "  hook tile delta   all tiles " << deltaFullMs << " ms   hud only " << deltaHudMs
+                  << " ms   plane exact: " << (exact ? "yes" : "NO") << std::endl;
+        std::cout << std::setprecision(4);
+        std::cout << "  plane vs float    max error " << planeError << " of an 8-bit step" << std::endl;
+        std::cout << std::setprecision(2);
+        std::cout << "  feature pass src  color " << frameBytes * 2 / 1e6 << " MB   plane " << planeBytes * 2 / 1e6
+                  << " MB per pair  (" << frameBytes / planeBytes << "x less, "
+                  << (frameBytes - planeBytes) * 2 * pairsPerSec / 1e9 << " GB/s saved at " << cfg.fps << " fps)"
+                  << std::endl;
+        std::cout << "  upload            +" << planeBytes / 1e6 << " MB per frame (+"
+                  << planeBytes / frameBytes * 100.0 << "%, " << planeBytes * cfg.fps / 1e9 << " GB/s)" << std::endl;
+    }
+    if (!allExact) {
+        std::cout << "FAIL: tile-delta luma plane differs from the full-frame reference" << std::endl;
+        return 1;
+    }
+    if (!allMatch) {
+        std::cout << "FAIL: luma plane is more than " << kMaxPlaneError
+                  << " of an 8-bit step off the float BT.709 luma" << std::endl;
+        return 1;
+    }
+    return 0;
+}
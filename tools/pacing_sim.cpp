@@ -0,0 +1,465 @@
+// Pacing simulator: drives DisplayClock with synthetic, jittery clocks and
+// reports how fast (and how well) the display PLL and capture mapping converge.
+// A second part replays a jittery, variable-rate source trace through the
+// fixed-cadence multiplier pacing and the VRR content-driven schedule.
+// Exits 1 unless long capture-only runs recover the configured drift.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <cstdlib>
+
+#include "display_clock.h"
+#include "vrr_scheduler.h"
+
+struct Config {
+    double refreshHz = 143.856;     // true display rate (slightly off nominal)
+    double nominalHz = 144.0;       // what the OS reports
+    double vblankJitterMs = 0.25;   // present-completion timestamp jitter
+    double dropRate = 0.05;         // fraction of vblanks with no sample
+    double glitchRate = 0.005;      // fraction of samples that are garbage
+    double captureFps = 59.94;
+    double captureLatencyMs = 1.5;  // mean poll latency (exponential)
+    double driftPpm = 35.0;         // capture clock vs QPC
+    double targetFps = 72.0;        // output rate for the cadence test
+    double presentJitterMs = 0.3;   // wait + submit jitter of each present
+    double seconds = 20.0;
+    unsigned seed = 1;
+
+    // VRR schedule test
+    double sourceFps = 50.0;        // mean source rate
+    double sourceJitterMs = 3.0;    // per-frame arrival jitter (1 sigma)
+    double fpsSwing = 0.25;         // +/- fraction, 6 s period (variable-rate content)
+    double stallRate = 0.01;        // fraction of frames followed by a 20-60 ms stall
+    int multiplier = 3;             // legacy output multiplier / VRR per-pair cap
+    double vrrMinHz = 48.0;
+    double delayFactor = 0.9;       // output delay in source intervals (App default)
+};
+
+struct WindowStats {
+    double sumSq = 0.0;
+    double maxAbs = 0.0;
+    int count = 0;
+
+    void Add(double v) {
+        sumSq += v * v;
+        maxAbs = std::max(maxAbs, std::abs(v));
+        count++;
+    }
+    double Rms() const { return count > 0 ? std::sqrt(sumSq / count) : 0.0; }
+};
+
+// Counts how often the vblank gap between consecutive outputs changes. A
+// steady N:M cadence repeats a short pattern; beat judder shows up as extra
+// changes on top of the unavoidable ones.
+struct CadenceStats {
+    long long lastVblank = -1;
+    long long lastGap = -1;
+    int changes = 0;
+    int doubles = 0;    // two outputs on the same vblank (one is never seen)
+    int outputs = 0;
+
+    void Add(long long vblank) {
+        outputs++;
+        if (lastVblank >= 0) {
+            long long gap = vblank - lastVblank;
+            if (gap == 0) doubles++;
+            if (lastGap >= 0 && gap != lastGap) changes++;
+            lastGap = gap;
+        }
+        lastVblank = vblank;
+    }
+};
+
+// Quality of one output schedule. Every present shows some source time; the
+// ideal is the present time minus the fixed output delay, advancing exactly
+// as fast as the presents do.
+struct ScheduleStats {
+    WindowStats contentErr;     // shown - (present - delay)
+    WindowStats velocityErr;    // d(shown)/d(present) - 1 between presents
+    int presents = 0;
+    int exactSource = 0;        // presents that show a captured frame unchanged
+    int holds = 0;
+    double minGap = 1e9;
+    double firstPresent = -1.0;
+    double lastPresent = 0.0;
+    double lastShown = 0.0;
+
+    void Add(double present, double shown, double delay, bool exact) {
+        contentErr.Add(shown - (present - delay));
+        if (presents > 0) {
+            double gap = present - lastPresent;
+            minGap = std::min(minGap, gap);
+            if (gap > 0.0) velocityErr.Add((shown - lastShown) / gap - 1.0);
+        } else {
+            firstPresent = present;
+        }
+        presents++;
+        if (exact) exactSource++;
+        lastPresent = present;
+        lastShown = shown;
+    }
+    double Fps() const {
+        return presents > 1 ? (presents - 1) / (lastPresent - firstPresent) : 0.0;
+    }
+};
+
+// Source arrivals: jitter, a slow rate swing and occasional stalls.
+std::vector<double> makeSourceTrace(const Config& cfg, std::mt19937_64& rng) {
+    std::normal_distribution<double> jitter(0.0, cfg.sourceJitterMs * 1e-3);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double pi = 3.14159265358979323846;
+    std::vector<double> arrivals;
+    double t = 0.05;
+    while (t < cfg.seconds) {
+        arrivals.push_back(t);
+        double fps = cfg.sourceFps * (1.0 + cfg.fpsSwing * std::sin(2.0 * pi * t / 6.0));
+        double interval = 1.0 / std::max(fps, 1.0) + jitter(rng);
+        if (uniform(rng) < cfg.stallRate) interval += 0.020 + 0.040 * uniform(rng);
+        t += std::max(interval, 1e-3);
+    }
+    return arrivals;
+}
+
+// App multiplier pacing: fixed cadence at multiplier / avg interval, alpha
+// from the virtualized (cadence-snapped) timestamps with the interval clamped
+// to 0.75..1.35 of the average, as in App::UpdateCapture / App::Render.
+ScheduleStats runLegacySchedule(const Config& cfg, const std::vector<double>& arrivals,
+                                std::mt19937_64& rng) {
+    std::normal_distribution<double> presentNoise(0.0, cfg.presentJitterMs * 1e-3);
+    ScheduleStats stats;
+    std::vector<double> virt(arrivals.size(), 0.0);
+    double avg = 0.0;
+    size_t known = 0;
+    double t = arrivals.empty() ? 0.0 : arrivals[0];
+    while (t < cfg.seconds) {
+        while (known < arrivals.size() && arrivals[known] <= t) {
+            double raw = arrivals[known];
+            double smoothed = raw;
+            if (known > 0) {
+                double rawInterval = raw - arrivals[known - 1];
+                if (avg > 0.0) {
+                    double expectedBase = virt[known - 1];
+                    double n = std::clamp(std::floor((raw - arrivals[known - 1]) / avg + 0.5), 1.0, 10.0);
+                    double expected = expectedBase + n * avg;
+                    double drift = raw - expected;
+                    smoothed = (std::abs(drift) > avg * 3.0) ? raw : expected + drift / 20.0;
+                }
+                avg = (avg <= 0.0) ? rawInterval : avg * 0.9 + rawInterval * 0.1;
+            }
+            virt[known] = smoothed;
+            known++;
+        }
+        if (known == 0 || avg <= 0.0) { t += 1e-3; continue; }
+
+        double delay = std::clamp(avg * cfg.delayFactor, 0.001, 0.080);
+        double display = t - delay;
+        size_t front = known > 3 ? known - 3 : 0;
+        while (known - front >= 3 && display >= virt[front + 1]) front++;
+        double shown = arrivals[front];
+        bool exact = true;
+        if (known - front >= 2) {
+            double interval = std::clamp(virt[front + 1] - virt[front], avg * 0.75, avg * 1.35);
+            double alpha = std::clamp((display - virt[front]) / interval, 0.0, 1.0);
+            if (alpha < 0.001) alpha = 0.0;
+            if (alpha > 0.999) alpha = 1.0;
+            shown = arrivals[front] + alpha * (arrivals[front + 1] - arrivals[front]);
+            exact = (alpha == 0.0 || alpha == 1.0);
+        }
+        double present = t + presentNoise(rng);
+        stats.Add(present, shown, delay, exact);
+        t += avg / cfg.multiplier;
+    }
+    return stats;
+}
+
+// VRR schedule: VrrScheduler ticks on the same trace, presented at the tick
+// time plus the output delay on a panel that scans out on present.
+ScheduleStats runVrrSchedule(const Config& cfg, const std::vector<double>& arrivals,
+                             std::mt19937_64& rng, VrrSchedulerStats* schedulerStats) {
+    std::normal_distribution<double> presentNoise(0.0, cfg.presentJitterMs * 1e-3);
+    VrrSchedulerConfig vrrConfig;
+    vrrConfig.maxOutputHz = cfg.refreshHz;
+    vrrConfig.minOutputHz = cfg.vrrMinHz;
+    vrrConfig.maxPresentsPerPair = cfg.multiplier;
+    VrrScheduler scheduler;
+    scheduler.SetConfig(vrrConfig);
+
+    ScheduleStats stats;
+    double avg = 0.0;
+    size_t known = 0;
+    double t = arrivals.empty() ? 0.0 : arrivals[0];
+    while (t < cfg.seconds) {
+        while (known < arrivals.size() && arrivals[known] <= t) {
+            if (known > 0) {
+                double rawInterval = arrivals[known] - arrivals[known - 1];
+                avg = (avg <= 0.0) ? rawInterval : avg * 0.9 + rawInterval * 0.1;
+            }
+            known++;
+        }
+        double nextArrival = known < arrivals.size() ? arrivals[known] : cfg.seconds;
+        if (known == 0 || avg <= 0.0) { t = nextArrival; continue; }
+
+        double delay = std::clamp(avg * cfg.delayFactor, 0.001, 0.080);
+        size_t front = known > 3 ? known - 3 : 0;
+        VrrTick tick = scheduler.Peek(&arrivals[front], static_cast<int>(known - front),
+                                      t - delay - 1.0 / cfg.refreshHz);
+        if (!tick.valid) { t = nextArrival; continue; }
+        double deadline = tick.timeSec + delay;
+        if (tick.hold && nextArrival < deadline) {
+            // A new frame may extend the schedule before the hold is due.
+            t = nextArrival;
+            continue;
+        }
+        // The output delay follows the average interval; never present
+        // faster than the panel ceiling when it shrinks.
+        if (stats.presents > 0) deadline = std::max(deadline, stats.lastPresent + 1.0 / cfg.refreshHz);
+        double present = std::max(t, deadline) + presentNoise(rng);
+        double shown = std::min(tick.timeSec, arrivals[known - 1]);
+        bool exact = tick.hold || tick.step == 0 || tick.step == tick.count;
+        scheduler.Advance(tick);
+        stats.Add(present, shown, delay, exact);
+        if (tick.hold) stats.holds++;
+        t = std::max(t, deadline);
+    }
+    *schedulerStats = scheduler.Stats();
+    return stats;
+}
+
+void printSchedule(const char* name, const ScheduleStats& s) {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(8) << std::setprecision(1) << s.Fps()
+              << std::setw(14) << std::setprecision(3) << s.contentErr.Rms() * 1e3
+              << std::setw(14) << s.contentErr.maxAbs * 1e3
+              << std::setw(14) << std::setprecision(3) << s.velocityErr.Rms()
+              << std::setw(10) << std::setprecision(1)
+              << (s.presents > 0 ? 100.0 * s.exactSource / s.presents : 0.0)
+              << std::setw(12) << std::setprecision(2) << s.minGap * 1e3
+              << std::setw(8) << s.holds << std::endl;
+}
+
+// Capture mapping alone over a long run. Drift is the slope of a line through
+// samples with --latency-ms of one-sided jitter, so its error shrinks as
+// T^-1.5: a 20 s run leaves several ppm, two minutes well under one.
+constexpr double kDriftCheckSeconds = 120.0;
+constexpr int kDriftCheckSeeds = 5;
+
+DisplayClockStats runDriftCheck(const Config& cfg, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::exponential_distribution<double> latency(1.0 / std::max(cfg.captureLatencyMs * 1e-3, 1e-6));
+    const double drift = cfg.driftPpm * 1e-6;
+    DisplayClock clock;
+    for (double t = 0.0; t < kDriftCheckSeconds; t += 1.0 / cfg.captureFps) {
+        clock.AddCaptureSample(t + latency(rng), 1.3e10 + t * (1.0 + drift));
+    }
+    return clock.Stats();
+}
+
+void printUsage() {
+    std::cout << "Usage: pacing_sim [options]" << std::endl;
+    std::cout << "  --hz <f>          True display refresh (default 143.856)" << std::endl;
+    std::cout << "  --nominal-hz <f>  Reported display refresh (default 144)" << std::endl;
+    std::cout << "  --jitter-ms <f>   Present-completion jitter (default 0.25)" << std::endl;
+    std::cout << "  --drop <f>        Missing vblank sample rate (default 0.05)" << std::endl;
+    std::cout << "  --glitch <f>      Garbage sample rate (default 0.005)" << std::endl;
+    std::cout << "  --capture-fps <f> Capture rate (default 59.94)" << std::endl;
+    std::cout << "  --latency-ms <f>  Mean capture poll latency (default 1.5)" << std::endl;
+    std::cout << "  --drift-ppm <f>   Capture clock drift (default 35)" << std::endl;
+    std::cout << "  --target-fps <f>  Output rate for cadence test (default 72)" << std::endl;
+    std::cout << "  --present-jitter-ms <f> Present issue jitter (default 0.3)" << std::endl;
+    std::cout << "  --seconds <f>     Simulated duration (default 20)" << std::endl;
+    std::cout << "  --seed <n>        RNG seed" << std::endl;
+    std::cout << "VRR schedule test:" << std::endl;
+    std::cout << "  --source-fps <f>  Mean source rate (default 50)" << std::endl;
+    std::cout << "  --source-jitter-ms <f> Source arrival jitter (default 3)" << std::endl;
+    std::cout << "  --fps-swing <f>   Source rate swing, fraction (default 0.25)" << std::endl;
+    std::cout << "  --stall <f>       Source stall rate (default 0.01)" << std::endl;
+    std::cout << "  --multiplier <n>  Output multiplier / VRR per-pair cap (default 3)" << std::endl;
+    std::cout << "  --vrr-min-hz <f>  VRR floor (default 48); ceiling is --hz" << std::endl;
+    std::cout << "  --delay-factor <f> Output delay in source intervals (default 0.9)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--hz" && i+1 < argc) cfg.refreshHz = std::atof(argv[++i]);
+        else if (arg == "--nominal-hz" && i+1 < argc) cfg.nominalHz = std::atof(argv[++i]);
+        else if (arg == "--jitter-ms" && i+1 < argc) cfg.vblankJitterMs = std::atof(argv[++i]);
+        else if (arg == "--drop" && i+1 < argc) cfg.dropRate = std::atof(argv[++i]);
+        else if (arg == "--glitch" && i+1 < argc) cfg.glitchRate = std::atof(argv[++i]);
+        else if (arg == "--capture-fps" && i+1 < argc) cfg.captureFps = std::atof(argv[++i]);
+        else if (arg == "--latency-ms" && i+1 < argc) cfg.captureLatencyMs = std::atof(argv[++i]);
+        else if (arg == "--drift-ppm" && i+1 < argc) cfg.driftPpm = std::atof(argv[++i]);
+        else if (arg == "--target-fps" && i+1 < argc) cfg.targetFps = std::atof(argv[++i]);
+        else if (arg == "--present-jitter-ms" && i+1 < argc) cfg.presentJitterMs = std::atof(argv[++i]);
+        else if (arg == "--seconds" && i+1 < argc) cfg.seconds = std::atof(argv[++i]);
+        else if (arg == "--seed" && i+1 < argc) cfg.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--source-fps" && i+1 < argc) cfg.sourceFps = std::atof(argv[++i]);
+        else if (arg == "--source-jitter-ms" && i+1 < argc) cfg.sourceJitterMs = std::atof(argv[++i]);
+        else if (arg == "--fps-swing" && i+1 < argc) cfg.fpsSwing = std::atof(argv[++i]);
+        else if (arg == "--stall" && i+1 < argc) cfg.stallRate = std::atof(argv[++i]);
+        else if (arg == "--multiplier" && i+1 < argc) cfg.multiplier = std::atoi(argv[++i]);
+        else if (arg == "--vrr-min-hz" && i+1 < argc) cfg.vrrMinHz = std::atof(argv[++i]);
+        else if (arg == "--delay-factor" && i+1 < argc) cfg.delayFactor = std::atof(argv[++i]);
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+    if (cfg.refreshHz <= 0.0 || cfg.nominalHz <= 0.0 || cfg.captureFps <= 0.0 ||
+        cfg.targetFps <= 0.0 || cfg.seconds <= 0.0 || cfg.sourceFps <= 0.0 || cfg.multiplier < 1) {
+        std::cout << "Rates and duration must be positive" << std::endl;
+        return 1;
+    }
+
+    std::mt19937_64 rng(cfg.seed);
+    std::normal_distribution<double> vblankNoise(0.0, cfg.vblankJitterMs * 1e-3);
+    std::normal_distribution<double> presentNoise(0.0, cfg.presentJitterMs * 1e-3);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::exponential_distribution<double> latency(1.0 / std::max(cfg.captureLatencyMs * 1e-3, 1e-6));
+
+    const double truePeriod = 1.0 / cfg.refreshHz;
+    const double truePhase = 0.0037;              // first vblank, arbitrary
+    const double captureBase = 1.3e10;            // system-time epoch, seconds
+    const double drift = cfg.driftPpm * 1e-6;
+    auto trueCapture = [&](double qpc) { return captureBase + qpc * (1.0 + drift); };
+
+    DisplayClock clock;
+    clock.SetNominalPeriod(1.0 / cfg.nominalHz);
+
+    // Legacy filter from App::UpdateCapture for comparison.
+    bool legacyValid = false;
+    double legacyOffset = 0.0;
+
+    const int windows = static_cast<int>(std::ceil(cfg.seconds));
+    std::vector<WindowStats> phaseErr(windows), kfErr(windows), iirErr(windows);
+    std::vector<double> periodErrPpm(windows, 0.0);
+    double lockTime = -1.0;
+
+    double nextCapture = 0.0;
+    long long vblankIndex = 0;
+    for (;;) {
+        double vblank = truePhase + vblankIndex * truePeriod;
+        if (vblank > cfg.seconds) break;
+        int w = std::min(static_cast<int>(vblank), windows - 1);
+
+        // Capture samples that arrived before this vblank.
+        while (nextCapture <= vblank) {
+            double observed = nextCapture + latency(rng);
+            double captured = trueCapture(nextCapture);
+            clock.AddCaptureSample(observed, captured);
+            double offset = captured - observed;
+            if (!legacyValid) { legacyOffset = offset; legacyValid = true; }
+            else legacyOffset = legacyOffset * 0.995 + offset * 0.005;
+
+            // Mapping error evaluated at the observation time. The mean poll
+            // latency is a constant delay no estimator can separate from the
+            // offset (and it is harmless for pacing), so it is excluded.
+            double truth = trueCapture(observed) - cfg.captureLatencyMs * 1e-3;
+            kfErr[w].Add(clock.CaptureTimeFromQpc(observed) - truth);
+            iirErr[w].Add((observed + legacyOffset) - truth);
+            nextCapture += 1.0 / cfg.captureFps;
+        }
+
+        if (uniform(rng) >= cfg.dropRate) {
+            double sample = vblank + vblankNoise(rng);
+            if (uniform(rng) < cfg.glitchRate) {
+                sample += truePeriod * (0.4 + 0.2 * uniform(rng));
+            }
+            clock.AddVblankSample(sample);
+            if (clock.IsDisplayLocked()) {
+                // Error of the predicted grid against the true vblank.
+                double predicted = clock.NextVblank(vblank - truePeriod * 0.5);
+                phaseErr[w].Add(predicted - vblank);
+                periodErrPpm[w] = (clock.DisplayPeriod() - truePeriod) / truePeriod * 1e6;
+                if (lockTime < 0.0) lockTime = vblank;
+            }
+        }
+        vblankIndex++;
+    }
+
+    // Cadence test on the converged clock: free-running freq/targetFps
+    // deadlines (legacy) vs deadlines snapped to the PLL grid. Legacy deadlines
+    // slowly slide across vblank boundaries and flip between neighbouring
+    // vblanks while present jitter straddles the boundary.
+    CadenceStats legacyCadence, snappedCadence;
+    {
+        double interval = 1.0 / cfg.targetFps;
+        double start = cfg.seconds;
+        for (double ideal = start; ideal < start + cfg.seconds; ideal += interval) {
+            // A present issued at time t is scanned out on the first vblank
+            // after it.
+            double legacyT = ideal + presentNoise(rng);
+            double snappedT = clock.SnapDeadline(ideal, interval) + presentNoise(rng);
+            long long legacyV = static_cast<long long>(std::ceil((legacyT - truePhase) / truePeriod));
+            long long snappedV = static_cast<long long>(std::ceil((snappedT - truePhase) / truePeriod));
+            legacyCadence.Add(legacyV);
+            snappedCadence.Add(snappedV);
+        }
+    }
+
+    DisplayClockStats stats = clock.Stats();
+
+    std::cout << std::fixed;
+    std::cout << "Display " << std::setprecision(3) << cfg.refreshHz << " Hz (nominal "
+              << cfg.nominalHz << "), jitter " << cfg.vblankJitterMs << " ms, drop "
+              << cfg.dropRate * 100.0 << "%, glitch " << cfg.glitchRate * 100.0 << "%" << std::endl;
+    std::cout << "Capture " << cfg.captureFps << " fps, latency " << cfg.captureLatencyMs
+              << " ms, drift " << cfg.driftPpm << " ppm" << std::endl;
+    std::cout << "PLL lock at " << std::setprecision(3) << lockTime << " s" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  sec  phase_rms_us  phase_max_us  period_err_ppm  map_kf_rms_us  map_iir_rms_us" << std::endl;
+    for (int w = 0; w < windows; w++) {
+        std::cout << std::setw(5) << w
+                  << std::setw(14) << std::setprecision(1) << phaseErr[w].Rms() * 1e6
+                  << std::setw(14) << phaseErr[w].maxAbs * 1e6
+                  << std::setw(16) << std::setprecision(2) << periodErrPpm[w]
+                  << std::setw(15) << std::setprecision(1) << kfErr[w].Rms() * 1e6
+                  << std::setw(16) << iirErr[w].Rms() * 1e6 << std::endl;
+    }
+    std::cout << std::endl;
+    std::cout << "Estimated period " << std::setprecision(6) << stats.displayPeriodSec * 1e3
+              << " ms (true " << truePeriod * 1e3 << " ms), drift "
+              << std::setprecision(2) << stats.captureDriftPpm << " +/- " << stats.captureDriftSigmaPpm << " ppm (true "
+              << cfg.driftPpm << ")" << std::endl;
+    std::cout << "Vblank samples " << stats.vblankSamples << ", outliers " << stats.vblankOutliers
+              << "; capture samples " << stats.captureSamples << ", rejected " << stats.captureRejected << std::endl;
+    std::cout << "Cadence @ " << cfg.targetFps << " fps: legacy " << legacyCadence.changes
+              << " gap changes / " << legacyCadence.doubles << " doubled, PLL-snapped "
+              << snappedCadence.changes << " / " << snappedCadence.doubles
+              << " (" << legacyCadence.outputs << " outputs)" << std::endl;
+
+    std::vector<double> trace = makeSourceTrace(cfg, rng);
+    ScheduleStats legacySchedule = runLegacySchedule(cfg, trace, rng);
+    VrrSchedulerStats vrrStats;
+    ScheduleStats vrrSchedule = runVrrSchedule(cfg, trace, rng, &vrrStats);
+
+    std::cout << std::endl;
+    std::cout << "Source " << std::setprecision(1) << cfg.sourceFps << " fps +/-" << cfg.fpsSwing * 100.0
+              << "%, jitter " << cfg.sourceJitterMs << " ms, stalls " << cfg.stallRate * 100.0
+              << "% (" << trace.size() << " frames); multiplier " << cfg.multiplier
+              << ", VRR " << cfg.vrrMinHz << "-" << cfg.refreshHz << " Hz" << std::endl;
+    std::cout << "  schedule       fps  content_rms_ms  content_max_ms  velocity_rms  exact_%  min_gap_ms   holds"
+              << std::endl;
+    printSchedule("multiplier", legacySchedule);
+    printSchedule("vrr", vrrSchedule);
+    std::cout << "VRR presents per pair " << std::setprecision(2) << vrrStats.AvgPresentsPerPair()
+              << " over " << vrrStats.pairs << " pairs" << std::endl;
+
+    // The estimate must converge on the true drift, within 5 sigma of the
+    // filter's own uncertainty and never looser than 1 ppm.
+    bool ok = true;
+    std::cout << std::endl << "Drift check (" << std::setprecision(0) << kDriftCheckSeconds << " s capture-only):";
+    for (int i = 0; i < kDriftCheckSeeds; i++) {
+        DisplayClockStats check = runDriftCheck(cfg, cfg.seed + static_cast<unsigned>(i));
+        const double errPpm = check.captureDriftPpm - cfg.driftPpm;
+        const double tolPpm = std::max(1.0, 5.0 * check.captureDriftSigmaPpm);
+        std::cout << " " << std::showpos << std::setprecision(2) << errPpm << std::noshowpos;
+        if (std::abs(errPpm) > tolPpm) ok = false;
+    }
+    std::cout << " ppm error" << std::endl;
+    std::cout << (ok ? "PASS" : "FAIL: drift estimate did not converge") << std::endl;
+    return ok ? 0 : 1;
+}
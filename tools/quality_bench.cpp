@@ -0,0 +1,344 @@
+// Quality metrics benchmark: throughput of MeasureQuality at each SIMD level
+// and thread count, then correctness checks.
+//
+// Checks:
+//  - identical frames score PSNR kMaxPsnr, SSIM / MS-SSIM 1, GMSD 0;
+//  - MSE matches an exact integer reference;
+//  - mean SSIM matches a direct double-precision evaluation of every window;
+//  - every SIMD level and thread count gives identical scores (odd sizes,
+//    so the vector tails are exercised);
+//  - scores order correctly for increasing noise;
+//  - FlickerMeter: a copy of the reference has no flicker, an alternating
+//    brightness offset shows up in both temporal measures.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+#include "deadline_wait.h"
+#include "quality_metrics.h"
+
+struct Config {
+    int width = 1920;
+    int height = 1080;
+    int iterations = 5;
+};
+
+void printUsage() {
+    std::cout << "Usage: quality_bench [options]\n"
+              << "  --size WxH       benchmark frame size (default 1920x1080)\n"
+              << "  --iterations N   timed calls per configuration (default 5)\n";
+}
+
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;   // Bgra8
+
+    CpuFrame Frame() const {
+        CpuFrame frame;
+        frame.data = pixels.data();
+        frame.pitch = static_cast<size_t>(width) * 4;
+        frame.width = width;
+        frame.height = height;
+        frame.format = PixelFormat::Bgra8;
+        return frame;
+    }
+};
+
+uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// Smooth gradients plus a few hard edges, like desktop / game content.
+Image makeImage(int width, int height, uint32_t seed) {
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+    uint32_t state = seed;
+    const int boxes = 12;
+    std::vector<int> box(boxes * 5);
+    for (int& v : box) v = static_cast<int>(nextRandom(state) % 1024);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint8_t* p = &image.pixels[(static_cast<size_t>(y) * width + x) * 4];
+            int b = (x * 255) / width;
+            int g = (y * 255) / height;
+            int r = static_cast<int>(128 + 100 * std::sin(x * 0.05) * std::cos(y * 0.03));
+            for (int i = 0; i < boxes; ++i) {
+                const int bx = box[i * 5] * width / 1024, by = box[i * 5 + 1] * height / 1024;
+                if (x >= bx && x < bx + width / 8 && y >= by && y < by + height / 8) {
+                    b = box[i * 5 + 2] / 4;
+                    g = box[i * 5 + 3] / 4;
+                    r = box[i * 5 + 4] / 4;
+                }
+            }
+            p[0] = static_cast<uint8_t>(b);
+            p[1] = static_cast<uint8_t>(g);
+            p[2] = static_cast<uint8_t>(std::clamp(r, 0, 255));
+            p[3] = 255;
+        }
+    }
+    return image;
+}
+
+Image addNoise(const Image& src, int amplitude, uint32_t seed) {
+    Image out = src;
+    uint32_t state = seed;
+    for (size_t i = 0; i < out.pixels.size(); ++i) {
+        if ((i & 3) == 3) {
+            out.pixels[i] = static_cast<uint8_t>(nextRandom(state));   // alpha must not matter
+            continue;
+        }
+        const int n = static_cast<int>(nextRandom(state) % (2 * amplitude + 1)) - amplitude;
+        out.pixels[i] = static_cast<uint8_t>(std::clamp(out.pixels[i] + n, 0, 255));
+    }
+    return out;
+}
+
+Image addOffset(const Image& src, int offset) {
+    Image out = src;
+    for (size_t i = 0; i < out.pixels.size(); ++i) {
+        if ((i & 3) != 3) out.pixels[i] = static_cast<uint8_t>(std::clamp(out.pixels[i] + offset, 0, 255));
+    }
+    return out;
+}
+
+// Direct SSIM: every 11x11 window, double precision.
+double referenceSsim(const Image& a, const Image& b) {
+    auto luma = [](const Image& image, int x, int y) {
+        const uint8_t* p = &image.pixels[(static_cast<size_t>(y) * image.width + x) * 4];
+        return (9.0 * p[0] + 92.0 * p[1] + 27.0 * p[2]) / 128.0;
+    };
+    double w[11];
+    double wsum = 0.0;
+    for (int i = 0; i < 11; ++i) {
+        w[i] = std::exp(-(i - 5.0) * (i - 5.0) / (2.0 * 1.5 * 1.5));
+        wsum += w[i];
+    }
+    for (double& v : w) v /= wsum;
+    const double c1 = 6.5025, c2 = 58.5225;
+    double total = 0.0;
+    for (int y = 0; y + 11 <= a.height; ++y) {
+        for (int x = 0; x + 11 <= a.width; ++x) {
+            double ma = 0, mb = 0, aa = 0, bb = 0, ab = 0;
+            for (int j = 0; j < 11; ++j) {
+                for (int i = 0; i < 11; ++i) {
+                    const double k = w[i] * w[j];
+                    const double va = luma(a, x + i, y + j), vb = luma(b, x + i, y + j);
+                    ma += k * va;
+                    mb += k * vb;
+                    aa += k * va * va;
+                    bb += k * vb * vb;
+                    ab += k * va * vb;
+                }
+            }
+            const double varA = aa - ma * ma, varB = bb - mb * mb, cov = ab - ma * mb;
+            total += (2 * ma * mb + c1) * (2 * cov + c2) / ((ma * ma + mb * mb + c1) * (varA + varB + c2));
+        }
+    }
+    return total / ((a.width - 10.0) * (a.height - 10.0));
+}
+
+bool sameScores(const QualityScores& a, const QualityScores& b) {
+    return a.mse == b.mse && a.psnr == b.psnr && a.ssim == b.ssim && a.msSsim == b.msSsim && a.gmsd == b.gmsd &&
+           a.msSsimScales == b.msSsimScales;
+}
+
+std::string describe(const QualityScores& s) {
+    std::ostringstream ss;
+    ss << std::setprecision(9) << "psnr " << s.psnr << " ssim " << s.ssim << " ms-ssim " << s.msSsim << " gmsd "
+       << s.gmsd;
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i+1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &cfg.width, &cfg.height) != 2 || cfg.width < 16 || cfg.height < 16) {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--iterations" && i+1 < argc) cfg.iterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    bool ok = true;
+    auto fail = [&](const std::string& what) {
+        std::cout << "FAIL: " << what << std::endl;
+        ok = false;
+    };
+    std::cout << std::fixed;
+
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    const SimdLevel best = DetectSimdLevel();
+    if (best == SimdLevel::Sse41 || best == SimdLevel::Avx2) levels.push_back(SimdLevel::Sse41);
+    if (best != SimdLevel::Scalar && best != SimdLevel::Sse41) levels.push_back(best);
+
+    // Throughput.
+    {
+        const Image reference = makeImage(cfg.width, cfg.height, 1);
+        const Image test = addNoise(reference, 6, 2);
+        std::cout << "MeasureQuality, " << cfg.width << "x" << cfg.height << " (PSNR + SSIM + MS-SSIM + GMSD):"
+                  << std::endl;
+        std::vector<int> threadCounts = {1};
+        const int hardware = static_cast<int>(std::thread::hardware_concurrency());
+        if (hardware > 1) threadCounts.push_back(hardware);
+        for (SimdLevel level : levels) {
+            for (int threads : threadCounts) {
+                QualityOptions options;
+                options.maxLevel = level;
+                options.threads = threads;
+                QualityScores scores;
+                MeasureQuality(test.Frame(), reference.Frame(), scores, options);   // warm-up
+                const double start = DeadlineWaiter::Now();
+                for (int i = 0; i < cfg.iterations; ++i) {
+                    MeasureQuality(test.Frame(), reference.Frame(), scores, options);
+                }
+                const double ms = (DeadlineWaiter::Now() - start) * 1e3 / cfg.iterations;
+                std::cout << "  " << std::left << std::setw(8) << SimdLevelName(level) << std::right << std::setw(3)
+                          << threads << " thread(s): " << std::setprecision(2) << std::setw(8) << ms << " ms, "
+                          << std::setw(7) << cfg.width * static_cast<double>(cfg.height) / (ms * 1e3) << " MP/s"
+                          << std::endl;
+            }
+        }
+        QualityOptions psnrOnly;
+        psnrOnly.ssim = psnrOnly.msSsim = psnrOnly.gmsd = false;
+        QualityScores scores;
+        const double start = DeadlineWaiter::Now();
+        for (int i = 0; i < cfg.iterations; ++i) {
+            MeasureQuality(test.Frame(), reference.Frame(), scores, psnrOnly);
+        }
+        std::cout << "  PSNR only:              " << std::setprecision(2) << std::setw(8)
+                  << (DeadlineWaiter::Now() - start) * 1e3 / cfg.iterations << " ms" << std::endl;
+    }
+
+    // Identical frames.
+    {
+        const Image a = makeImage(320, 160, 3);
+        QualityScores s;
+        if (!MeasureQuality(a.Frame(), a.Frame(), s)) {
+            fail("identical frames rejected");
+        } else {
+            if (s.mse != 0.0 || s.psnr != kMaxPsnr) fail("identical PSNR " + describe(s));
+            if (std::fabs(s.ssim - 1.0) > 1e-6 || std::fabs(s.msSsim - 1.0) > 1e-6) fail("identical SSIM " + describe(s));
+            if (s.gmsd > 1e-6) fail("identical GMSD " + describe(s));
+            if (s.msSsimScales != 4) fail("320x160 used " + std::to_string(s.msSsimScales) + " MS-SSIM scales");
+        }
+    }
+
+    // MSE and SSIM against direct references.
+    {
+        const Image a = makeImage(97, 61, 4);
+        const Image b = addNoise(a, 20, 5);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < a.pixels.size(); ++i) {
+            if ((i & 3) == 3) continue;
+            const int d = a.pixels[i] - b.pixels[i];
+            sum += static_cast<uint64_t>(d * d);
+        }
+        const double mse = static_cast<double>(sum) / (97.0 * 61.0 * 3.0);
+        QualityScores s;
+        MeasureQuality(b.Frame(), a.Frame(), s);
+        if (s.mse != mse) fail("MSE " + std::to_string(s.mse) + ", expected " + std::to_string(mse));
+        const double ssim = referenceSsim(b, a);
+        if (std::fabs(s.ssim - ssim) > 1e-4) {
+            fail("SSIM " + std::to_string(s.ssim) + ", direct evaluation " + std::to_string(ssim));
+        }
+        std::cout << "SSIM vs direct evaluation: " << std::setprecision(6) << s.ssim << " / " << ssim << std::endl;
+    }
+
+    // Levels and thread counts agree exactly.
+    {
+        const Image a = makeImage(1917, 1077, 6);
+        const Image b = addNoise(a, 9, 7);
+        QualityOptions options;
+        options.maxLevel = SimdLevel::Scalar;
+        options.threads = 1;
+        QualityScores expected;
+        MeasureQuality(b.Frame(), a.Frame(), expected, options);
+        for (SimdLevel level : levels) {
+            for (int threads : {1, 3, 8}) {
+                options.maxLevel = level;
+                options.threads = threads;
+                QualityScores s;
+                MeasureQuality(b.Frame(), a.Frame(), s, options);
+                if (!sameScores(s, expected)) {
+                    fail(std::string(SimdLevelName(level)) + " x" + std::to_string(threads) + ": " + describe(s) +
+                         " vs scalar " + describe(expected));
+                }
+            }
+        }
+        std::cout << "1917x1077 noise 9: " << describe(expected) << std::endl;
+    }
+
+    // Ordering.
+    {
+        const Image a = makeImage(256, 256, 8);
+        QualityScores prev;
+        prev.psnr = kMaxPsnr + 1.0;
+        prev.ssim = prev.msSsim = 2.0;
+        prev.gmsd = -1.0;
+        for (int amplitude : {2, 8, 24, 64}) {
+            QualityScores s;
+            MeasureQuality(addNoise(a, amplitude, 9).Frame(), a.Frame(), s);
+            if (!(s.psnr < prev.psnr && s.ssim < prev.ssim && s.msSsim < prev.msSsim && s.gmsd > prev.gmsd)) {
+                fail("noise " + std::to_string(amplitude) + " does not score worse: " + describe(s));
+            }
+            prev = s;
+        }
+    }
+
+    // Flicker.
+    {
+        const Image base = makeImage(200, 120, 10);
+        std::vector<Image> reference;
+        for (int i = 0; i < 6; ++i) reference.push_back(addNoise(base, 3, 20 + i));
+        FlickerMeter clean;
+        FlickerMeter pumping;
+        for (int i = 0; i < 6; ++i) {
+            clean.Add(reference[i].Frame(), reference[i].Frame());
+            pumping.Add(addOffset(reference[i], i % 2 ? 2 : -2).Frame(), reference[i].Frame());
+        }
+        if (clean.Frames() != 6 || clean.TemporalError() != 0.0 || clean.BrightnessFlicker() != 0.0) {
+            fail("copy of the reference flickers");
+        }
+        // Luma weights sum to 1, so a +-2 offset on every channel is +-2 in
+        // luma, except where the offset clipped.
+        if (std::fabs(pumping.BrightnessFlicker() - 4.0) > 0.1 || std::fabs(pumping.TemporalError() - 4.0) > 0.1 ||
+            pumping.MaxTemporalError() < pumping.TemporalError()) {
+            fail("alternating offset: temporal " + std::to_string(pumping.TemporalError()) + ", brightness " +
+                 std::to_string(pumping.BrightnessFlicker()));
+        }
+        std::cout << "Flicker, +-2 alternating: temporal " << std::setprecision(3) << pumping.TemporalError()
+                  << ", brightness " << pumping.BrightnessFlicker() << std::endl;
+    }
+
+    // Rejected inputs.
+    {
+        const Image a = makeImage(64, 64, 11);
+        const Image b = makeImage(64, 48, 11);
+        QualityScores s;
+        if (MeasureQuality(a.Frame(), b.Frame(), s)) fail("size mismatch accepted");
+        CpuFrame rgba = a.Frame();
+        rgba.format = PixelFormat::Rgba8;
+        if (MeasureQuality(rgba, a.Frame(), s)) fail("format mismatch accepted");
+        const Image tiny = makeImage(12, 12, 11);
+        if (MeasureQuality(tiny.Frame(), tiny.Frame(), s)) fail("12x12 accepted");
+    }
+
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
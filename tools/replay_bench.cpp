@@ -0,0 +1,213 @@
+// Replay source benchmark: records a synthetic session (jittery 60 fps
+// source with stutters and dropped frames) to a frame stream, or takes an
+// existing recording, and plays it back through ReplaySource.
+//
+//  - unpaced with the original clock, twice: frames, sequence numbers,
+//    timestamps and pixels must match the recording and both runs exactly;
+//  - paced at 1x and 4x with the rebased clock: delivery lateness and how
+//    far the delivered intervals drift from the recorded ones.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "deadline_wait.h"
+#include "frame_stream.h"
+#include "replay_source.h"
+
+struct Config {
+    std::string file = "replay_bench.tmfs";
+    bool generate = true;
+    bool keep = false;
+    int frames = 180;
+    int width = 1280;
+    int height = 720;
+    std::vector<double> speeds = {1.0, 4.0};
+};
+
+struct Fingerprint {
+    uint64_t frames = 0;
+    uint64_t hash = 1469598103934665603ull;
+
+    void Add(uint64_t v) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (v >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    }
+    void AddFrame(const CpuFrame& f) {
+        frames++;
+        Add(f.sequence);
+        Add(static_cast<uint64_t>(f.presentTime100ns));
+        Add(static_cast<uint64_t>(f.width) << 32 | static_cast<uint32_t>(f.height));
+        // Sample the pixels on a sparse grid; enough to tell frames apart.
+        for (int y = 0; y < f.height; y += 37) {
+            const uint32_t* row = reinterpret_cast<const uint32_t*>(f.data + f.pitch * y);
+            for (int x = 0; x < f.width; x += 41) Add(row[x]);
+        }
+    }
+    bool operator==(const Fingerprint& o) const { return frames == o.frames && hash == o.hash; }
+};
+
+bool generate(const Config& cfg, Fingerprint& fp) {
+    FrameStreamWriter writer;
+    if (!writer.Open(cfg.file)) return false;
+    std::vector<uint8_t> pixels(static_cast<size_t>(cfg.width) * cfg.height * 4);
+    uint32_t rng = 12345;
+    auto next = [&] { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; };
+    int64_t time = 10000000;    // 1 s, arbitrary recording epoch
+    uint64_t sequence = 1;
+    for (int i = 0; i < cfg.frames; i++) {
+        for (int y = 0; y < cfg.height; y++) {
+            uint32_t* row = reinterpret_cast<uint32_t*>(pixels.data() + static_cast<size_t>(cfg.width) * 4 * y);
+            for (int x = 0; x < cfg.width; x++) {
+                row[x] = 0xFF000000u | ((x + i * 7) & 0xFF) | (((y + i * 3) & 0xFF) << 8) | ((i & 0xFF) << 16);
+            }
+        }
+        CpuFrame f;
+        f.data = pixels.data();
+        f.pitch = static_cast<size_t>(cfg.width) * 4;
+        f.width = cfg.width;
+        f.height = cfg.height;
+        f.sequence = sequence;
+        f.presentTime100ns = time;
+        f.systemTime100ns = time + 20000;
+        if (!writer.Write(f)) return false;
+        fp.AddFrame(f);
+
+        // 16.67 ms +- 1 ms jitter, a 50 ms stutter every 60 frames, and a
+        // dropped frame (sequence gap) every 45.
+        int64_t interval = 166667 + static_cast<int64_t>(next() % 20001) - 10000;
+        if (i % 60 == 59) interval += 333333;
+        uint64_t step = (i % 45 == 44) ? 2 : 1;
+        if (step == 2) interval += 166667;
+        time += interval;
+        sequence += step;
+    }
+    return true;
+}
+
+bool playUnpaced(const Config& cfg, Fingerprint& fp, const Fingerprint* expected) {
+    ReplaySource replay;
+    if (!replay.Open(cfg.file)) {
+        std::cout << "Open failed: " << replay.GetLastError() << std::endl;
+        return false;
+    }
+    replay.SetSpeed(0.0);
+    replay.SetClock(ReplayClock::Original);
+    SourceFrame frame;
+    while (replay.AcquireFrame(frame)) fp.AddFrame(frame.cpu);
+    return !expected || fp == *expected;
+}
+
+struct PacedResult {
+    uint64_t frames = 0;
+    double meanLateMs = 0.0;
+    double maxLateMs = 0.0;
+    double maxIntervalErrMs = 0.0;
+};
+
+PacedResult playPaced(const Config& cfg, double speed) {
+    PacedResult r;
+    ReplaySource replay;
+    FrameStreamReader recorded;
+    if (!replay.Open(cfg.file) || !recorded.Open(cfg.file)) return r;
+    replay.SetSpeed(speed);
+    replay.SetClock(ReplayClock::Rebased);
+    DeadlineWaiter waiter;
+    SourceFrame frame;
+    CpuFrame original;
+    int64_t prevOriginal = 0;
+    double prevDelivered = 0.0;
+    double lateSum = 0.0;
+    while (replay.IsCapturing()) {
+        double due = replay.NextDueSec();
+        if (due > 0.0) waiter.WaitUntil(due);
+        if (!replay.AcquireFrame(frame)) continue;
+        double delivered = DeadlineWaiter::Now();
+        double late = due > 0.0 ? delivered - due : 0.0;
+        if (!recorded.Next(original)) break;
+        r.frames++;
+        lateSum += late;
+        r.maxLateMs = std::max(r.maxLateMs, late * 1000.0);
+        if (prevOriginal != 0) {
+            double want = static_cast<double>(original.presentTime100ns - prevOriginal) * 1e-7 / speed;
+            double got = delivered - prevDelivered;
+            r.maxIntervalErrMs = std::max(r.maxIntervalErrMs, std::abs(got - want) * 1000.0);
+        }
+        prevOriginal = original.presentTime100ns;
+        prevDelivered = delivered;
+    }
+    r.meanLateMs = r.frames ? lateSum / r.frames * 1000.0 : 0.0;
+    return r;
+}
+
+void printUsage() {
+    std::cout << "Usage: replay_bench [options]" << std::endl;
+    std::cout << "  --input <file>      Replay an existing recording instead of a synthetic one" << std::endl;
+    std::cout << "  --file <file>       Where to write the synthetic recording (default replay_bench.tmfs)" << std::endl;
+    std::cout << "  --keep              Keep the synthetic recording" << std::endl;
+    std::cout << "  --frames <n>        Synthetic frames (default 180)" << std::endl;
+    std::cout << "  --size <W>x<H>      Synthetic frame size (default 1280x720)" << std::endl;
+    std::cout << "  --speed <x>         Add a paced playback speed (default 1 and 4)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    bool customSpeed = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--input" && i+1 < argc) { cfg.file = argv[++i]; cfg.generate = false; }
+        else if (arg == "--file" && i+1 < argc) cfg.file = argv[++i];
+        else if (arg == "--keep") cfg.keep = true;
+        else if (arg == "--frames" && i+1 < argc) cfg.frames = std::max(2, std::atoi(argv[++i]));
+        else if (arg == "--size" && i+1 < argc) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) { printUsage(); return 1; }
+            cfg.width = std::max(1, std::atoi(v.substr(0, x).c_str()));
+            cfg.height = std::max(1, std::atoi(v.substr(x + 1).c_str()));
+        }
+        else if (arg == "--speed" && i+1 < argc) {
+            if (!customSpeed) { cfg.speeds.clear(); customSpeed = true; }
+            cfg.speeds.push_back(std::max(0.01, std::atof(argv[++i])));
+        }
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    Fingerprint recorded;
+    if (cfg.generate && !generate(cfg, recorded)) {
+        std::cout << "Cannot write " << cfg.file << std::endl;
+        return 1;
+    }
+
+    Fingerprint first;
+    Fingerprint second;
+    bool ok = playUnpaced(cfg, first, cfg.generate ? &recorded : nullptr);
+    ok = playUnpaced(cfg, second, &first) && ok;
+    std::cout << cfg.file << ": " << first.frames << " frames" << std::endl;
+    std::cout << "unpaced, original clock: " << (ok ? "matches recording, deterministic" : "MISMATCH") << std::endl;
+
+    std::cout << std::endl << "speed  frames  mean late ms  max late ms  max interval err ms" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (double speed : cfg.speeds) {
+        PacedResult r = playPaced(cfg, speed);
+        ok = ok && r.frames == first.frames;
+        std::cout << std::setw(5) << std::setprecision(2) << speed << std::setw(8) << r.frames
+                  << std::setprecision(3) << std::setw(14) << r.meanLateMs << std::setw(13) << r.maxLateMs
+                  << std::setw(21) << r.maxIntervalErrMs << std::endl;
+    }
+
+    if (cfg.generate && !cfg.keep) std::remove(cfg.file.c_str());
+    if (!ok) {
+        std::cout << "FAIL: replay did not reproduce the recording" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,311 @@
+// Resize simulator: drives ResolutionBucketPool with capture-size traces the
+// way the Interpolator does (window edge drags, border jitter, maximize /
+// restore) and compares exact allocation, where every size change rebuilds
+// the working set on the render thread, with bucketed allocation, where
+// builds after the first run in the background for a few frames while the
+// current set keeps serving what it can hold, unless too many frames in a
+// row have been passed through, when the render thread waits for them.
+//
+// Working-set bytes come from PlanInterpolatorResources (D3D11 full
+// pipeline, output texture excluded), so padding overhead is what the
+// Interpolator would actually hold.
+//
+// Reports per trace and mode: size changes, sets built, builds on the render
+// thread (hitches), frames passed through uninterpolated while a larger set
+// was building and the longest run of them, peak memory (old and new set
+// both alive during a build) and the mean padding overhead. Checks:
+//  - an interpolated frame is never served by a set smaller than the input;
+//  - bucketing never builds more sets than exact allocation, and only the
+//    first bucketed build and builds waited for run on the render thread;
+//  - pass-through frames are bounded by the build latency per grow, and no
+//    run of them is longer than the policy allows;
+//  - once a trace settles, the allocation is the input's bucket, within the
+//    shrink slack;
+//  - bucket arithmetic: extents, plans (with grow headroom) and viewport
+//    extents.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <cstdlib>
+
+#include "resolution_bucket.h"
+#include "resource_registry.h"
+
+struct Config {
+    int buildFrames = 3;        // frames an async build takes
+    int granularity = 64;
+    int growHeadroom = 64;
+    int shrinkSlack = 128;
+    int maxPassthroughRun = 6;
+    unsigned seed = 1;
+};
+
+struct Size {
+    int w = 0;
+    int h = 0;
+};
+
+struct Trace {
+    std::string name;
+    std::vector<Size> frames;
+};
+
+struct SimResult {
+    ResolutionBucketStats stats;
+    uint64_t renderThreadBuilds = 0;
+    uint64_t waitBuilds = 0;        // render-thread builds after a long pass-through run
+    double peakMiB = 0.0;
+    double paddingPct = 0.0;        // mean over interpolated frames
+    std::vector<std::string> failures;
+};
+
+const double kMiB = 1024.0 * 1024.0;
+
+// Working-set bytes for an allocation, without the output texture.
+uint64_t workingBytes(int w, int h) {
+    static std::map<std::pair<int, int>, uint64_t> cache;
+    auto it = cache.find({w, h});
+    if (it != cache.end()) return it->second;
+    ResourceRegistry registry;
+    PlanInterpolatorResources(w, h, w, h, false, false, 0, registry);
+    uint64_t bytes = 0;
+    for (const ResourceRecord& r : registry.Records()) {
+        if (r.level != ResourceLevel::Output) bytes += r.bytes;
+    }
+    cache[{w, h}] = bytes;
+    return bytes;
+}
+
+void appendDrag(Trace& t, Size from, Size to, int frames, int jitter, std::mt19937& rng) {
+    std::uniform_int_distribution<int> j(-jitter, jitter);
+    for (int i = 0; i <= frames; i++) {
+        const double a = static_cast<double>(i) / frames;
+        Size s;
+        s.w = static_cast<int>(std::lround(from.w + (to.w - from.w) * a)) + (jitter ? j(rng) : 0);
+        s.h = static_cast<int>(std::lround(from.h + (to.h - from.h) * a)) + (jitter ? j(rng) : 0);
+        t.frames.push_back(s);
+    }
+}
+
+void appendHold(Trace& t, Size s, int frames) {
+    t.frames.insert(t.frames.end(), frames, s);
+}
+
+std::vector<Trace> makeTraces(const Config& cfg) {
+    std::mt19937 rng(cfg.seed);
+    std::vector<Trace> traces;
+
+    Trace grow{"edge drag 1280x720 -> 1920x1080", {}};
+    appendHold(grow, {1280, 720}, 30);
+    appendDrag(grow, {1280, 720}, {1920, 1080}, 60, 0, rng);
+    appendHold(grow, {1920, 1080}, 60);
+    traces.push_back(grow);
+
+    Trace shrink{"edge drag 1920x1080 -> 960x540", {}};
+    appendHold(shrink, {1920, 1080}, 30);
+    appendDrag(shrink, {1920, 1080}, {960, 540}, 90, 0, rng);
+    appendHold(shrink, {960, 540}, 60);
+    traces.push_back(shrink);
+
+    Trace both{"drag back and forth x3", {}};
+    appendHold(both, {1600, 900}, 30);
+    for (int i = 0; i < 3; i++) {
+        appendDrag(both, {1600, 900}, {1900, 1000}, 40, 1, rng);
+        appendDrag(both, {1900, 1000}, {1600, 900}, 40, 1, rng);
+    }
+    appendHold(both, {1600, 900}, 60);
+    traces.push_back(both);
+
+    Trace jitter{"border jitter 1600x900 +-3 px", {}};
+    appendHold(jitter, {1600, 900}, 30);
+    std::uniform_int_distribution<int> j(-3, 3);
+    for (int i = 0; i < 300; i++) jitter.frames.push_back({1600 + j(rng), 900 + j(rng)});
+    appendHold(jitter, {1600, 900}, 60);
+    traces.push_back(jitter);
+
+    Trace maximize{"maximize / restore 1280x720 <-> 2560x1440", {}};
+    for (int i = 0; i < 4; i++) {
+        appendHold(maximize, {1280, 720}, 120);
+        appendHold(maximize, {2560, 1440}, 120);
+    }
+    appendHold(maximize, {1280, 720}, 60);
+    traces.push_back(maximize);
+
+    Trace steady{"steady 1920x1080", {}};
+    appendHold(steady, {1920, 1080}, 300);
+    traces.push_back(steady);
+    return traces;
+}
+
+SimResult simulate(const Config& cfg, const Trace& trace, bool bucketed) {
+    SimResult r;
+    ResolutionBucketPolicy policy = ResolutionBucketPolicy::Exact();
+    if (bucketed) {
+        policy.granularity = cfg.granularity;
+        policy.growHeadroom = cfg.growHeadroom;
+        policy.shrinkSlack = cfg.shrinkSlack;
+        policy.maxPassthroughRun = cfg.maxPassthroughRun;
+    }
+    ResolutionBucketPool pool(policy);
+    int readyFrame = -1;            // frame the build in flight lands on
+    uint64_t interpolated = 0;
+    double paddingSum = 0.0;
+
+    auto fail = [&](const std::string& what) {
+        if (r.failures.size() < 4) r.failures.push_back(what);
+    };
+
+    // Exact allocation and the first bucketed set build on the render thread,
+    // as the Interpolator does; later bucketed builds land buildFrames later
+    // unless waited for.
+    auto start = [&](BucketPlan plan, int frame, bool wait) {
+        while (plan.action != BucketAction::Reuse) {
+            if (bucketed && pool.AllocatedWidth() > 0 && !wait) {
+                readyFrame = frame + cfg.buildFrames;
+                return;
+            }
+            r.renderThreadBuilds++;
+            if (wait) r.waitBuilds++;
+            plan = pool.Completed(true);
+        }
+    };
+
+    for (int f = 0; f < static_cast<int>(trace.frames.size()); f++) {
+        const Size s = trace.frames[f];
+        if (pool.Pending() && f >= readyFrame) {
+            start(pool.Completed(true), f, false);
+        }
+        start(pool.Request(s.w, s.h), f, false);
+
+        uint64_t bytes = workingBytes(pool.AllocatedWidth(), pool.AllocatedHeight());
+        if (pool.Pending()) bytes += workingBytes(pool.PendingWidth(), pool.PendingHeight());
+        r.peakMiB = std::max(r.peakMiB, bytes / kMiB);
+
+        if (!pool.Serves() && pool.ShouldWaitForBuild()) {
+            // The build in flight finishes on the render thread (peak as above).
+            pool.CountWaitedBuild();
+            r.renderThreadBuilds++;
+            r.waitBuilds++;
+            start(pool.Completed(true), f, true);
+        }
+        if (pool.Serves()) {
+            pool.CountServed();
+            if (pool.AllocatedWidth() < s.w || pool.AllocatedHeight() < s.h) fail("served by a set smaller than the input");
+            interpolated++;
+            paddingSum += static_cast<double>(workingBytes(pool.AllocatedWidth(), pool.AllocatedHeight())) /
+                          static_cast<double>(workingBytes(s.w, s.h)) - 1.0;
+        } else {
+            pool.CountPassthrough();
+        }
+    }
+
+    r.stats = pool.Stats();
+    r.paddingPct = interpolated ? paddingSum / interpolated * 100.0 : 0.0;
+    const Size last = trace.frames.back();
+    const BucketPlan settled = PlanResolutionBucket(pool.AllocatedWidth(), pool.AllocatedHeight(), last.w, last.h, policy);
+    if (pool.Pending() || settled.action != BucketAction::Reuse) fail("allocation did not settle on the final size");
+    if (bucketed) {
+        if (r.renderThreadBuilds - r.waitBuilds > 1) fail("bucketed builds ran on the render thread");
+        if (cfg.maxPassthroughRun > 0 && r.stats.longestPassthroughRun > static_cast<uint64_t>(cfg.maxPassthroughRun)) {
+            fail("a pass-through run outlasted the policy");
+        }
+        if (r.stats.passthroughFrames > r.stats.grows * static_cast<uint64_t>(cfg.buildFrames + 1)) {
+            fail("more pass-through frames than the build latency explains");
+        }
+    }
+    return r;
+}
+
+bool checkArithmetic() {
+    bool ok = true;
+    auto expect = [&](bool cond, const char* what) {
+        if (!cond) {
+            std::cout << "  FAIL: " << what << std::endl;
+            ok = false;
+        }
+    };
+    ResolutionBucketPolicy policy;
+    expect(BucketExtent(1080, 64) == 1088 && BucketExtent(1088, 64) == 1088 && BucketExtent(1, 64) == 64,
+           "BucketExtent rounds up to the granularity");
+    expect(BucketExtent(1081, 1) == 1081 && BucketExtent(0, 64) == 0, "BucketExtent keeps exact and empty extents");
+    expect(PlanResolutionBucket(0, 0, 1920, 1080, policy).action == BucketAction::Grow, "first allocation grows");
+    expect(PlanResolutionBucket(1920, 1088, 1900, 1070, policy).action == BucketAction::Reuse, "a smaller size fits");
+    const BucketPlan grow = PlanResolutionBucket(1920, 1088, 1921, 1080, policy);
+    expect(grow.action == BucketAction::Grow && grow.width == 2048 && grow.height == 1088,
+           "a wider size grows, with headroom on the axis that grew");
+    const BucketPlan shrink = PlanResolutionBucket(1920, 1088, 1280, 720, policy);
+    expect(shrink.action == BucketAction::Shrink && shrink.width == 1280 && shrink.height == 768,
+           "a much smaller size shrinks to its bucket");
+    expect(PlanResolutionBucket(1920, 1088, 1920 - 64 * 2 - 1, 1080, policy).action == BucketAction::Reuse,
+           "padding within the slack is kept");
+    expect(BucketViewportExtent(544, 1080, 1088) == 540 && BucketViewportExtent(136, 1080, 1088) == 135,
+           "viewport extents scale each level");
+    expect(BucketViewportExtent(540, 1080, 1080) == 540, "an exact allocation is all viewport");
+    return ok;
+}
+
+void printUsage() {
+    std::cout << "Usage: resize_sim [options]" << std::endl;
+    std::cout << "  --build-frames <n>  Frames an async set build takes (default 3)" << std::endl;
+    std::cout << "  --granularity <px>  Bucket granularity (default 64)" << std::endl;
+    std::cout << "  --headroom <px>     Headroom added to an axis that grew (default 64)" << std::endl;
+    std::cout << "  --slack <px>        Padding per axis kept before shrinking (default 128)" << std::endl;
+    std::cout << "  --max-passthrough <n> Pass-through run before waiting for the build, 0 = never (default 6)" << std::endl;
+    std::cout << "  --seed <n>          Random seed (default 1)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--build-frames" && i+1 < argc) cfg.buildFrames = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--granularity" && i+1 < argc) cfg.granularity = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--headroom" && i+1 < argc) cfg.growHeadroom = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--slack" && i+1 < argc) cfg.shrinkSlack = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--max-passthrough" && i+1 < argc) cfg.maxPassthroughRun = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--seed" && i+1 < argc) cfg.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    bool ok = true;
+    std::cout << std::fixed;
+    std::cout << "Bucket arithmetic" << std::endl;
+    ok = checkArithmetic() && ok;
+    std::cout << std::endl;
+
+    std::cout << "Granularity " << cfg.granularity << " px, grow headroom " << cfg.growHeadroom << " px, shrink slack " << cfg.shrinkSlack
+              << " px, async build " << cfg.buildFrames << " frames, wait after " << cfg.maxPassthroughRun
+              << " pass-through frames" << std::endl << std::endl;
+    for (const Trace& trace : makeTraces(cfg)) {
+        std::cout << trace.name << " (" << trace.frames.size() << " frames)" << std::endl;
+        std::cout << "  mode      resizes  builds  render-thread  pass-through  longest  waited  peak MiB  padding" << std::endl;
+        const SimResult exact = simulate(cfg, trace, false);
+        const SimResult bucket = simulate(cfg, trace, true);
+        for (int m = 0; m < 2; m++) {
+            const SimResult& r = m == 0 ? exact : bucket;
+            std::cout << "  " << std::left << std::setw(8) << (m == 0 ? "exact" : "bucketed") << std::right
+                      << std::setw(9) << r.stats.resizes << std::setw(8) << r.stats.builds
+                      << std::setw(15) << r.renderThreadBuilds << std::setw(14) << r.stats.passthroughFrames
+                      << std::setw(9) << r.stats.longestPassthroughRun << std::setw(8) << r.stats.waitedBuilds
+                      << std::setprecision(1) << std::setw(10) << r.peakMiB
+                      << std::setw(8) << r.paddingPct << "%" << std::endl;
+            for (const std::string& f : r.failures) {
+                std::cout << "    FAIL: " << f << std::endl;
+                ok = false;
+            }
+        }
+        if (bucket.stats.builds > exact.stats.builds) {
+            std::cout << "    FAIL: bucketing built more sets than exact allocation" << std::endl;
+            ok = false;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+// Session recorder benchmark: feeds synthetic captured frames through
+// SessionRecorder at a capture rate, raw and with LZ4, and reads the
+// recording back through the mapped FrameStreamReader.
+//
+//  - capture side: submit cost (mean/max) and frames dropped because the
+//    writer fell behind, for Submit (copy on the capture thread) and for
+//    SubmitLent from a ring of staging buffers like the app's, which only
+//    reuses a buffer after the writer released it;
+//  - writer side: throughput and compression ratio;
+//  - read side: every written frame matches what was submitted, and how
+//    fast uncompressed frames come out of the mapping (no copy) vs LZ4;
+//  - recovery: a copy with the index cut off and the last payload torn
+//    still opens and yields every complete frame.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "deadline_wait.h"
+#include "frame_stream.h"
+#include "session_recorder.h"
+
+struct Config {
+    std::string file = "session_record_bench.tmfs";
+    bool keep = false;
+    int frames = 240;
+    int width = 1920;
+    int height = 1080;
+    double fps = 60.0;          // 0 = submit as fast as possible
+    int queue = 8;
+};
+
+// Game-like content: a scrolling gradient, a moving box and a noisy band
+// (film grain / particles) that does not compress.
+void drawFrame(const Config& cfg, int index, std::vector<uint8_t>& pixels) {
+    pixels.resize(static_cast<size_t>(cfg.width) * cfg.height * 4);
+    uint32_t rng = 0x9E3779B9u ^ static_cast<uint32_t>(index * 7919);
+    const int boxX = (index * 13) % std::max(1, cfg.width - 200);
+    const int boxY = (index * 7) % std::max(1, cfg.height - 200);
+    const int noiseTop = cfg.height / 2;
+    const int noiseBottom = noiseTop + cfg.height / 8;
+    for (int y = 0; y < cfg.height; y++) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(pixels.data() + static_cast<size_t>(cfg.width) * 4 * y);
+        for (int x = 0; x < cfg.width; x++) {
+            uint32_t v;
+            if (y >= noiseTop && y < noiseBottom) {
+                rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+                v = 0xFF000000u | (rng & 0x00FFFFFFu);
+            } else if (x >= boxX && x < boxX + 200 && y >= boxY && y < boxY + 200) {
+                v = 0xFFE0C020u;
+            } else {
+                v = 0xFF000000u | (((x + index * 4) >> 3) & 0xFF) | ((((y >> 2) + index) & 0xFF) << 8) | (0x40u << 16);
+            }
+            row[x] = v;
+        }
+    }
+}
+
+volatile uint64_t g_sink = 0;
+
+struct RunResult {
+    SessionRecorderStats stats;
+    uint64_t stagingDrops = 0;  // lent mode: every staging buffer still lent
+    double meanSubmitMs = 0.0;
+    uint64_t verified = 0;
+    uint64_t mismatched = 0;
+    double readMsPerFrame = 0.0;
+    bool ok = false;
+};
+
+RunResult run(const Config& cfg, bool compress, bool lent, const std::vector<std::vector<uint8_t>>& source) {
+    RunResult r;
+    SessionRecorder recorder;
+    SessionRecorderConfig rc;
+    rc.queueFrames = cfg.queue;
+    rc.compress = compress;
+    if (!recorder.Start(cfg.file, rc)) {
+        std::cout << "Cannot write " << cfg.file << std::endl;
+        return r;
+    }
+
+    // Lent mode: staging buffers with a mapped-texture style row pitch,
+    // filled outside the timed call (the app's GPU copy).
+    const size_t rowBytes = static_cast<size_t>(cfg.width) * 4;
+    const size_t stagingPitch = (rowBytes + 255) / 256 * 256;
+    std::vector<std::vector<uint8_t>> staging(lent ? static_cast<size_t>(cfg.queue) : 0);
+    std::vector<uint64_t> stagingTicket(staging.size(), 0);
+    for (auto& buffer : staging) buffer.resize(stagingPitch * cfg.height);
+
+    DeadlineWaiter waiter;
+    const double start = DeadlineWaiter::Now();
+
+    for (int i = 0; i < cfg.frames; i++) {
+        if (cfg.fps > 0.0) waiter.WaitUntil(start + i / cfg.fps);
+        CpuFrame f;
+        f.data = source[i % source.size()].data();
+        f.pitch = rowBytes;
+        f.width = cfg.width;
+        f.height = cfg.height;
+        f.sequence = static_cast<uint64_t>(i) + 1;
+        f.systemTime100ns = static_cast<int64_t>(DeadlineWaiter::Now() * 1e7);
+        f.presentTime100ns = f.systemTime100ns - 20000;
+        if (lent) {
+            const size_t k = static_cast<size_t>(i) % staging.size();
+            if (stagingTicket[k] > recorder.Released()) {
+                r.stagingDrops++;
+                continue;
+            }
+            for (int y = 0; y < cfg.height; y++) {
+                std::memcpy(staging[k].data() + stagingPitch * y, f.data + rowBytes * y, rowBytes);
+            }
+            f.data = staging[k].data();
+            f.pitch = stagingPitch;
+            stagingTicket[k] = recorder.SubmitLent(f);
+        } else {
+            recorder.Submit(f);
+        }
+    }
+    recorder.Stop();
+    r.stats = recorder.Stats();
+    // The recorder times each submit up to the point the frame is queued.
+    // Timing the call from here would also count the writer's time slices
+    // on machines with few cores, since the wakeup can preempt this thread.
+    const uint64_t queued = r.stats.submitted - r.stats.dropped;
+    r.meanSubmitMs = queued ? r.stats.submitSec / queued * 1000.0 : 0.0;
+
+    FrameStreamReader reader;
+    if (!reader.Open(cfg.file)) {
+        std::cout << "Reopen failed: " << reader.GetLastError() << std::endl;
+        return r;
+    }
+    CpuFrame f;
+    uint64_t checksum = 0;
+    const double readStart = DeadlineWaiter::Now();
+    while (reader.Next(f)) {
+        // Touch every cache line so mapped pages are actually faulted in.
+        const size_t bytes = f.pitch * f.height;
+        for (size_t i = 0; i < bytes; i += 64) checksum += f.data[i];
+    }
+    const double readSec = DeadlineWaiter::Now() - readStart;
+    r.readMsPerFrame = reader.FrameCount() ? readSec / reader.FrameCount() * 1000.0 : 0.0;
+    g_sink = checksum;
+
+    reader.Rewind();
+    uint64_t prevSequence = 0;
+    while (reader.Next(f)) {
+        const std::vector<uint8_t>& expected = source[(f.sequence - 1) % source.size()];
+        bool same = f.sequence > prevSequence && f.width == cfg.width && f.height == cfg.height &&
+                    std::memcmp(f.data, expected.data(), expected.size()) == 0;
+        prevSequence = f.sequence;
+        if (same) r.verified++; else r.mismatched++;
+    }
+    r.ok = r.mismatched == 0 && r.verified == r.stats.written &&
+           r.stats.written + r.stats.dropped + r.stagingDrops == static_cast<uint64_t>(cfg.frames) &&
+           r.stats.failed == 0;
+    return r;
+}
+
+// Copies the recording with the header's index offset cleared and the file
+// cut halfway through the last payload: what a crashed writer leaves.
+bool recoveryCheck(const Config& cfg, uint64_t& recovered, uint64_t& expected) {
+    FrameStreamReader full;
+    if (!full.Open(cfg.file) || full.FrameCount() < 2) return false;
+    const FrameStreamRecord& last = full.Record(full.FrameCount() - 1);
+    const uint64_t cut = last.payloadOffset + last.storedBytes / 2;
+    expected = full.FrameCount() - 1;
+    full.Close();
+
+    std::FILE* in = std::fopen(cfg.file.c_str(), "rb");
+    const std::string torn = cfg.file + ".torn";
+    std::FILE* out = std::fopen(torn.c_str(), "wb");
+    if (!in || !out) {
+        if (in) std::fclose(in);
+        if (out) std::fclose(out);
+        return false;
+    }
+    std::vector<uint8_t> buffer(1 << 20);
+    uint64_t copied = 0;
+    while (copied < cut) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), cut - copied));
+        size_t got = std::fread(buffer.data(), 1, want, in);
+        if (got == 0) break;
+        if (copied == 0) {
+            FrameStreamFileHeader header;
+            std::memcpy(&header, buffer.data(), sizeof(header));
+            header.indexOffset = 0;
+            header.frameCount = 0;
+            std::memcpy(buffer.data(), &header, sizeof(header));
+        }
+        std::fwrite(buffer.data(), 1, got, out);
+        copied += got;
+    }
+    std::fclose(in);
+    std::fclose(out);
+
+    FrameStreamReader reader;
+    bool ok = reader.Open(torn) && reader.Recovered();
+    recovered = reader.FrameCount();
+    CpuFrame f;
+    for (size_t i = 0; ok && i < reader.FrameCount(); i++) ok = reader.ReadFrame(i, f);
+    reader.Close();
+    std::remove(torn.c_str());
+    return ok && recovered == expected;
+}
+
+void printUsage() {
+    std::cout << "Usage: session_record_bench [options]" << std::endl;
+    std::cout << "  --file <file>       Recording path (default session_record_bench.tmfs)" << std::endl;
+    std::cout << "  --keep              Keep the last recording" << std::endl;
+    std::cout << "  --frames <n>        Frames to submit (default 240)" << std::endl;
+    std::cout << "  --size <W>x<H>      Frame size (default 1920x1080)" << std::endl;
+    std::cout << "  --fps <n>           Submission rate, 0 = unpaced (default 60)" << std::endl;
+    std::cout << "  --queue <n>         Recorder slots (default 8)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--file" && i+1 < argc) cfg.file = argv[++i];
+        else if (arg == "--keep") cfg.keep = true;
+        else if (arg == "--frames" && i+1 < argc) cfg.frames = std::max(2, std::atoi(argv[++i]));
+        else if (arg == "--size" && i+1 < argc) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) { printUsage(); return 1; }
+            cfg.width = std::max(1, std::atoi(v.substr(0, x).c_str()));
+            cfg.height = std::max(1, std::atoi(v.substr(x + 1).c_str()));
+        }
+        else if (arg == "--fps" && i+1 < argc) cfg.fps = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--queue" && i+1 < argc) cfg.queue = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    // A short loop of distinct frames; drawing every frame would dominate
+    // the capture side of the measurement.
+    std::vector<std::vector<uint8_t>> source(static_cast<size_t>(std::min(cfg.frames, 30)));
+    for (size_t i = 0; i < source.size(); i++) drawFrame(cfg, static_cast<int>(i), source[i]);
+
+    const double frameMB = static_cast<double>(cfg.width) * cfg.height * 4 / (1024.0 * 1024.0);
+    std::cout << cfg.width << "x" << cfg.height << ", " << cfg.frames << " frames at "
+              << (cfg.fps > 0.0 ? std::to_string(static_cast<int>(cfg.fps)) + " fps" : std::string("max rate"))
+              << ", " << cfg.queue << " slots" << std::endl << std::endl;
+    std::cout << "mode      written  dropped  submit ms (mean/max)  write MB/s  ratio  max queued  read ms/frame  verified" << std::endl;
+    std::cout << std::fixed;
+
+    bool ok = true;
+    for (int mode = 0; mode < 4; mode++) {
+        const bool compress = (mode & 1) != 0;
+        const bool lent = mode >= 2;
+        RunResult r = run(cfg, compress, lent, source);
+        const double rawMB = static_cast<double>(r.stats.rawBytes) / (1024.0 * 1024.0);
+        const double fileMB = static_cast<double>(r.stats.fileBytes) / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(8) << (std::string(compress ? "lz4" : "raw") + (lent ? " lent" : ""))
+                  << std::right << std::setw(9) << r.stats.written
+                  << std::setw(9) << r.stats.dropped + r.stagingDrops << std::setprecision(3) << std::setw(12) << r.meanSubmitMs
+                  << " / " << std::setw(7) << r.stats.maxSubmitMs << std::setprecision(0) << std::setw(12)
+                  << (r.stats.writeSec > 0.0 ? rawMB / r.stats.writeSec : 0.0) << std::setprecision(2)
+                  << std::setw(7) << (fileMB > 0.0 ? rawMB / fileMB : 0.0) << std::setw(12) << r.stats.maxQueued
+                  << std::setprecision(3) << std::setw(15) << r.readMsPerFrame << std::setw(10)
+                  << (r.ok ? "yes" : "NO") << std::endl;
+        ok = ok && r.ok;
+
+        if (!compress && !lent) {
+            uint64_t recovered = 0;
+            uint64_t expected = 0;
+            bool recoveredOk = recoveryCheck(cfg, recovered, expected);
+            std::cout << "      recovery without index: " << recovered << "/" << expected << " frames"
+                      << (recoveredOk ? "" : " FAILED") << std::endl;
+            ok = ok && recoveredOk;
+        }
+    }
+    std::cout << std::endl << "frame " << std::setprecision(1) << frameMB << " MB" << std::endl;
+
+    if (!cfg.keep) std::remove(cfg.file.c_str());
+    if (!ok) {
+        std::cout << "FAIL: recording did not match the submitted frames" << std::endl;
+        return 1;
+    }
+    return 0;
+}
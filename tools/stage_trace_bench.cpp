@@ -0,0 +1,257 @@
+// Stage timing benchmark: drives StageProfiler the way the interpolator does
+// (nested frames, CPU scopes, a GPU timer resolving a few frames late) while a
+// reader thread snapshots the timeline concurrently, then summarizes and
+// exports a Chrome trace.
+//
+// Reports the cost of a scope with timing on and off, and checks:
+//  - concurrent snapshots never return torn or out-of-range samples;
+//  - nested frames count once;
+//  - with the profiler disabled, only the always-timed stages are recorded;
+//  - GPU percentiles match the durations the fake timer produced;
+//  - the trace holds one complete event per retained sample.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "deadline_wait.h"
+#include "stage_timer.h"
+
+struct Config {
+    int frames = 2000;
+    int scopeIterations = 1000000;
+    double stageUs = 2.0;
+    std::string tracePath = "stage_trace_bench.json";
+};
+
+// GPU timer with known durations: stage s takes (s + 1) * 100 us, every 50th
+// frame 4x as long. Results land kLatency frames after issue, as queries do.
+class FakeGpuTimer : public GpuStageTimer {
+public:
+    static constexpr int kLatency = 2;
+
+    void BeginFrame(uint64_t frame, double cpuSec) override {
+        m_frame = frame;
+        m_cpuSec = cpuSec;
+        m_cursor = 0.0;
+    }
+    void EndFrame() override {}
+    void BeginStage(PipelineStage) override {}
+    void EndStage(PipelineStage stage) override {
+        const double duration = Duration(stage, m_frame);
+        StageSample sample;
+        sample.frame = m_frame;
+        sample.beginSec = m_cpuSec + m_cursor;
+        sample.endSec = sample.beginSec + duration;
+        sample.stage = stage;
+        sample.domain = TimingDomain::Gpu;
+        m_cursor += duration;
+        m_inFlight.push_back(sample);
+    }
+    void Collect(StageTimeline& timeline) override {
+        auto ready = std::stable_partition(m_inFlight.begin(), m_inFlight.end(), [&](const StageSample& s) {
+            return s.frame + kLatency <= m_frame + 1;
+        });
+        for (auto it = m_inFlight.begin(); it != ready; ++it) {
+            timeline.Push(*it);
+        }
+        m_inFlight.erase(m_inFlight.begin(), ready);
+    }
+
+    static double Duration(PipelineStage stage, uint64_t frame) {
+        const double base = (static_cast<int>(stage) + 1) * 100e-6;
+        return frame % 50 == 0 ? base * 4.0 : base;
+    }
+
+private:
+    uint64_t m_frame = 0;
+    double m_cpuSec = 0.0;
+    double m_cursor = 0.0;
+    std::vector<StageSample> m_inFlight;
+};
+
+const PipelineStage kStages[] = {
+    PipelineStage::Downsample, PipelineStage::Pyramid, PipelineStage::MotionForward,
+    PipelineStage::MotionBackward, PipelineStage::RefineQuarter, PipelineStage::RefineHalf,
+    PipelineStage::Smooth, PipelineStage::Interpolate};
+
+void runFrame(StageProfiler& profiler, GpuStageTimer* gpu, double stageSec) {
+    StageFrameScope frame(profiler);
+    StageScope total(profiler, PipelineStage::Execute);
+    for (PipelineStage stage : kStages) {
+        StageScope scope(profiler, stage, gpu);
+        DeadlineWaiter::SpinUntil(DeadlineWaiter::Now() + stageSec);   // issue cost
+    }
+    // ExecuteCached -> InterpolateOnly: a nested frame stays the same frame.
+    StageFrameScope nested(profiler);
+}
+
+double scopeCostNs(StageProfiler& profiler, int iterations) {
+    const double start = DeadlineWaiter::Now();
+    for (int i = 0; i < iterations; ++i) {
+        StageScope scope(profiler, PipelineStage::Smooth);
+    }
+    return (DeadlineWaiter::Now() - start) * 1e9 / iterations;
+}
+
+void printUsage() {
+    std::cout << "Usage: stage_trace_bench [options]" << std::endl;
+    std::cout << "  --frames <n>        Frames to run through the profiler (default 2000)" << std::endl;
+    std::cout << "  --iterations <n>    Scopes timed for the overhead figure (default 1000000)" << std::endl;
+    std::cout << "  --stage-us <us>     Simulated CPU issue cost per stage (default 2)" << std::endl;
+    std::cout << "  --trace <path>      Chrome trace output (default stage_trace_bench.json)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i+1 < argc) cfg.frames = std::max(100, std::atoi(argv[++i]));
+        else if (arg == "--iterations" && i+1 < argc) cfg.scopeIterations = std::max(1000, std::atoi(argv[++i]));
+        else if (arg == "--stage-us" && i+1 < argc) cfg.stageUs = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--trace" && i+1 < argc) cfg.tracePath = argv[++i];
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    bool ok = true;
+    auto fail = [&](const std::string& what) {
+        std::cout << "FAIL: " << what << std::endl;
+        ok = false;
+    };
+    std::cout << std::fixed;
+
+    // Scope overhead.
+    {
+        StageProfiler profiler;
+        const double off = scopeCostNs(profiler, cfg.scopeIterations);
+        profiler.SetEnabled(true);
+        profiler.BeginFrame();
+        const double on = scopeCostNs(profiler, cfg.scopeIterations);
+        profiler.EndFrame();
+        std::cout << "Scope cost: " << std::setprecision(1) << off << " ns disabled, " << on << " ns enabled"
+                  << std::endl;
+    }
+
+    // Profiler off, generation bracket only (the output cache's GPU cost).
+    {
+        StageProfiler profiler;
+        FakeGpuTimer gpu;
+        profiler.AddGpuTimer(&gpu);
+        profiler.SetAlwaysTimed(StageBit(PipelineStage::Execute));
+        const int frames = 20;
+        for (int f = 0; f < frames; ++f) {
+            runFrame(profiler, &gpu, 0.0);
+        }
+        std::vector<StageSample> samples;
+        profiler.Timeline().Snapshot(samples);
+        const size_t other = std::count_if(samples.begin(), samples.end(), [](const StageSample& s) {
+            return s.stage != PipelineStage::Execute;
+        });
+        std::cout << "Always-timed Execute: " << samples.size() << " samples over " << frames << " frames, "
+                  << other << " from other stages" << std::endl;
+        if (samples.size() != static_cast<size_t>(frames)) fail("always-timed stage missed frames");
+        if (other > 0) fail("disabled profiler recorded stages outside the always-timed mask");
+        if (profiler.Frame() != static_cast<uint64_t>(frames)) fail("always-timed frames were not counted");
+    }
+
+    // Producer with a concurrent reader.
+    StageProfiler profiler;
+    FakeGpuTimer gpu;
+    profiler.AddGpuTimer(&gpu);
+    profiler.SetEnabled(true);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> snapshots{0};
+    std::atomic<uint64_t> badSamples{0};
+    std::atomic<bool> started{false};
+    std::thread reader([&] {
+        started.store(true, std::memory_order_release);
+        std::vector<StageSample> samples;
+        while (!done.load(std::memory_order_acquire)) {
+            samples.clear();
+            profiler.Timeline().Snapshot(samples);
+            for (const StageSample& s : samples) {
+                if (s.endSec < s.beginSec || static_cast<int>(s.stage) >= kPipelineStageCount ||
+                    s.frame == 0 || s.frame > static_cast<uint64_t>(cfg.frames)) {
+                    badSamples.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            snapshots.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    while (!started.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    const double start = DeadlineWaiter::Now();
+    for (int f = 0; f < cfg.frames; ++f) {
+        runFrame(profiler, &gpu, cfg.stageUs * 1e-6);
+    }
+    const double producerSec = DeadlineWaiter::Now() - start;
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    std::cout << "Frames: " << cfg.frames << " in " << std::setprecision(2) << producerSec * 1e3 << " ms, "
+              << profiler.Timeline().Pushed() << " samples pushed, " << snapshots.load()
+              << " concurrent snapshots" << std::endl;
+    if (badSamples.load() > 0) fail(std::to_string(badSamples.load()) + " torn or invalid samples in snapshots");
+    if (profiler.Frame() != static_cast<uint64_t>(cfg.frames)) fail("nested frames were counted separately");
+
+    // Percentiles.
+    std::vector<StageSample> samples;
+    profiler.Timeline().Snapshot(samples);
+    if (samples.size() != std::min<uint64_t>(profiler.Timeline().Pushed(), StageTimeline::kCapacity)) {
+        fail("quiescent snapshot lost samples");
+    }
+    const int window = 100;
+    StageTimingSummary summary = SummarizeStages(samples, window);
+    std::cout << std::endl << "Stage (last " << window << " frames)   CPU p50/p99 us   GPU p50/p95/p99 us" << std::endl;
+    for (PipelineStage stage : kStages) {
+        const StagePercentiles& cpu = summary.Get(stage, TimingDomain::Cpu);
+        const StagePercentiles& g = summary.Get(stage, TimingDomain::Gpu);
+        std::cout << "  " << std::left << std::setw(16) << PipelineStageName(stage) << std::right
+                  << std::setprecision(2) << std::setw(8) << cpu.p50Sec * 1e6 << std::setw(8) << cpu.p99Sec * 1e6
+                  << std::setprecision(1) << std::setw(9) << g.p50Sec * 1e6 << std::setw(8) << g.p95Sec * 1e6
+                  << std::setw(8) << g.p99Sec * 1e6 << std::endl;
+        const double base = FakeGpuTimer::Duration(stage, 1);
+        if (std::fabs(g.p50Sec - base) > 1e-9) fail(std::string(PipelineStageName(stage)) + " GPU p50 mismatch");
+        if (std::fabs(g.p95Sec - base) > 1e-9) fail(std::string(PipelineStageName(stage)) + " GPU p95 mismatch");
+        if (std::fabs(g.p99Sec - base * 4.0) > 1e-9) fail(std::string(PipelineStageName(stage)) + " GPU p99 missed the spikes");
+        if (cpu.count == 0) fail(std::string(PipelineStageName(stage)) + " has no CPU samples");
+    }
+
+    // Chrome trace.
+    if (!WriteChromeTrace(cfg.tracePath, samples)) {
+        fail("could not write " + cfg.tracePath);
+    } else {
+        std::ifstream in(cfg.tracePath, std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+        const std::string json = text.str();
+        size_t events = 0;
+        for (size_t pos = json.find("\"ph\":\"X\""); pos != std::string::npos; pos = json.find("\"ph\":\"X\"", pos + 1)) {
+            events++;
+        }
+        long depth = 0;
+        bool balanced = true;
+        for (char c : json) {
+            if (c == '{' || c == '[') depth++;
+            if (c == '}' || c == ']') depth--;
+            if (depth < 0) balanced = false;
+        }
+        std::cout << std::endl << "Trace: " << cfg.tracePath << ", " << events << " events, "
+                  << json.size() / 1024 << " KB" << std::endl;
+        if (events != samples.size()) fail("trace event count differs from the samples");
+        if (!balanced || depth != 0 || json.front() != '{') fail("trace is not well formed");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,535 @@
+// Telemetry log analyzer: streams a .tmtl log (see telemetry.h) and reports
+// judder, latency, drops and render-loop stage times over the whole session
+// and per time window, in constant memory whatever the session length.
+//
+//  - judder: how far the content time step between two presents differs
+//    from the wall-clock step (0 = content moves exactly with time);
+//  - latency: present time minus the newest source frame's capture time,
+//    and minus the content time actually shown;
+//  - drops: per reason, plus records lost to a full ring (frame gaps);
+//  - stages: per-stage CPU and GPU times of every profiled frame. GPU times
+//    arrive a few records after the frame's CPU times and are joined back
+//    to it by the frame tag.
+//
+// --self-test writes a synthetic log through TelemetryWriter with known
+// judder, latency, drops and stage times, analyzes it and checks the
+// figures.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <map>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <thread>
+#include <chrono>
+
+#include "deadline_wait.h"
+#include "telemetry.h"
+
+struct Config {
+    std::string file;
+    double windowMinutes = 10.0;
+    double judderMs = 2.0;          // a step error above this counts as visible judder
+    double stallMs = 250.0;         // present gaps above this are stalls, not judder
+    bool selfTest = false;
+    int selfTestFrames = 200000;
+    bool keep = false;
+};
+
+// Fixed 10 us bins up to 1 s: percentiles over hours of presents in ~800 KB.
+class Histogram {
+public:
+    static constexpr double kBinMs = 0.01;
+    static constexpr int kBins = 100000;
+
+    Histogram() : m_counts(kBins, 0) {}
+
+    void Add(double ms) {
+        ms = std::max(ms, 0.0);
+        const int bin = std::min(static_cast<int>(ms / kBinMs), kBins - 1);
+        m_counts[bin]++;
+        m_count++;
+        m_sum += ms;
+        m_max = std::max(m_max, ms);
+    }
+    void Reset() {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_count = 0;
+        m_sum = 0.0;
+        m_max = 0.0;
+    }
+    uint64_t Count() const { return m_count; }
+    double Mean() const { return m_count ? m_sum / static_cast<double>(m_count) : 0.0; }
+    double Max() const { return m_max; }
+    // Nearest rank; the bin's upper edge, capped at the exact maximum.
+    double Percentile(double p) const {
+        if (m_count == 0) return 0.0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(m_count))));
+        uint64_t seen = 0;
+        for (int bin = 0; bin < kBins; bin++) {
+            seen += m_counts[bin];
+            if (seen >= rank) return std::min((bin + 1) * kBinMs, m_max);
+        }
+        return m_max;
+    }
+
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count = 0;
+    double m_sum = 0.0;
+    double m_max = 0.0;
+};
+
+struct Analysis {
+    uint64_t records = 0;
+    uint64_t presents = 0;
+    uint64_t presentsSkipped = 0;
+    uint64_t vrrHolds = 0;
+    uint64_t lost = 0;              // frame counter gaps: ring full at Submit
+    uint64_t stalls = 0;
+    uint64_t judderEvents = 0;
+    uint64_t repeats = 0;           // content did not advance
+    uint64_t reversals = 0;         // content went backwards
+    uint32_t resourceKiB = 0;       // last interpolator footprint
+    uint32_t peakResourceKiB = 0;
+    uint64_t resourceChanges = 0;   // reallocations (resize, pipeline switch)
+    double firstSec = 0.0;
+    double lastSec = 0.0;
+    std::array<uint64_t, kTelemetryDropCount> drops = {};
+    std::array<uint64_t, static_cast<int>(TelemetryPath::Count)> paths = {};
+    Histogram presentInterval;
+    Histogram judder;
+    Histogram sourceLatency;
+    Histogram displayLatency;
+    Histogram waitMs;
+    Histogram generateMs;
+    Histogram presentMs;
+    // Stage times by PipelineStage, created for the stages that occur.
+    std::map<int, Histogram> stageCpu;
+    std::map<int, Histogram> stageGpu;
+    uint64_t stageFrames = 0;       // records carrying a frame's CPU stage times
+    uint64_t gpuFrames = 0;         // records carrying a frame's GPU stage times
+    uint64_t gpuUnmatched = 0;      // GPU times whose CPU frame was not seen (recently)
+    uint64_t gpuLagSum = 0;         // records between a frame's CPU and GPU times
+    uint64_t gpuLagMax = 0;
+};
+
+// Rolling window: only what fits a one-line row.
+struct Window {
+    double startSec = 0.0;
+    uint64_t presents = 0;
+    uint64_t judderEvents = 0;
+    uint64_t drops = 0;
+    uint64_t lost = 0;
+    uint64_t stalls = 0;
+    Histogram judder;
+    Histogram sourceLatency;
+};
+
+class Analyzer {
+public:
+    explicit Analyzer(const Config& cfg) : m_cfg(cfg) {}
+
+    // Prints a window row whenever one closes.
+    void Add(const TelemetryRecord& r) {
+        Analysis& a = m_total;
+        const uint64_t lost = (a.records > 0 && r.frame > m_lastFrame + 1) ? r.frame - m_lastFrame - 1 : 0;
+        m_lastFrame = r.frame;
+        a.records++;
+        if (a.records == 1) {
+            a.firstSec = r.presentSec;
+            m_window.startSec = r.presentSec;
+        }
+        a.lastSec = std::max(a.lastSec, r.presentSec);
+        const double windowSec = m_cfg.windowMinutes * 60.0;
+        while (windowSec > 0.0 && r.presentSec - m_window.startSec >= windowSec) {
+            if (m_window.presents > 0 || m_window.drops > 0 || m_window.lost > 0) PrintWindow();
+            m_window.presents = m_window.judderEvents = m_window.drops = m_window.lost = m_window.stalls = 0;
+            m_window.judder.Reset();
+            m_window.sourceLatency.Reset();
+            m_window.startSec += windowSec;
+        }
+
+        a.lost += lost;
+        m_window.lost += lost;
+        for (int i = 0; i < kTelemetryDropCount; i++) {
+            a.drops[i] += r.drops[i];
+            m_window.drops += r.drops[i];
+        }
+        if (r.path < a.paths.size()) a.paths[r.path]++;
+        if (r.resourceKiB != 0) {
+            if (a.resourceKiB != 0 && r.resourceKiB != a.resourceKiB) a.resourceChanges++;
+            a.resourceKiB = r.resourceKiB;
+            a.peakResourceKiB = std::max(a.peakResourceKiB, r.resourceKiB);
+        }
+        if (r.flags & kTelemetryPresentSkipped) a.presentsSkipped++;
+        if (r.flags & kTelemetryVrrHold) a.vrrHolds++;
+        a.waitMs.Add(r.waitMs);
+        if (r.generateMs > 0.0f) a.generateMs.Add(r.generateMs);
+        AddStages(r);
+        if (!(r.flags & kTelemetryPresented)) return;
+
+        a.presents++;
+        m_window.presents++;
+        a.presentMs.Add(r.presentMs);
+        const bool showsContent = r.path != static_cast<uint8_t>(TelemetryPath::Idle) && r.displayTime100ns != 0;
+        if (showsContent && r.currTime100ns != 0) {
+            const double ms = static_cast<double>(r.presentTime100ns - r.currTime100ns) * 1e-4;
+            a.sourceLatency.Add(ms);
+            m_window.sourceLatency.Add(ms);
+            a.displayLatency.Add(static_cast<double>(r.presentTime100ns - r.displayTime100ns) * 1e-4);
+        }
+
+        if (m_havePrev) {
+            const double intervalMs = (r.presentSec - m_prev.presentSec) * 1e3;
+            if (intervalMs > m_cfg.stallMs) {
+                a.stalls++;
+                m_window.stalls++;
+            } else {
+                a.presentInterval.Add(intervalMs);
+                const bool prevShows = m_prev.path != static_cast<uint8_t>(TelemetryPath::Idle) &&
+                                       m_prev.displayTime100ns != 0;
+                if (showsContent && prevShows) {
+                    const double contentMs = static_cast<double>(r.displayTime100ns - m_prev.displayTime100ns) * 1e-4;
+                    if (contentMs < 0.0) {
+                        a.reversals++;
+                    } else if (contentMs == 0.0) {
+                        a.repeats++;
+                    }
+                    const double error = std::fabs(contentMs - intervalMs);
+                    a.judder.Add(error);
+                    m_window.judder.Add(error);
+                    if (error > m_cfg.judderMs) {
+                        a.judderEvents++;
+                        m_window.judderEvents++;
+                    }
+                }
+            }
+        }
+        m_prev = r;
+        m_havePrev = true;
+    }
+
+    void Finish() {
+        if (m_window.presents > 0 || m_window.drops > 0 || m_window.lost > 0) PrintWindow();
+    }
+
+    const Analysis& Result() const { return m_total; }
+
+private:
+    // Frames whose GPU times can still be joined; GPU queries resolve within
+    // a handful of presents.
+    static constexpr size_t kJoinFrames = 256;
+
+    void AddStages(const TelemetryRecord& r) {
+        Analysis& a = m_total;
+        for (int s = 0; s < kPipelineStageCount; s++) {
+            if (r.stageCpuFrame != 0 && r.stageCpuMs[s] > 0.0f) a.stageCpu[s].Add(r.stageCpuMs[s]);
+            if (r.stageGpuFrame != 0 && r.stageGpuMs[s] > 0.0f) a.stageGpu[s].Add(r.stageGpuMs[s]);
+        }
+        if (r.stageCpuFrame != 0) {
+            a.stageFrames++;
+            m_profiled.emplace_back(r.stageCpuFrame, a.records);
+            if (m_profiled.size() > kJoinFrames) m_profiled.pop_front();
+        }
+        if (r.stageGpuFrame != 0) {
+            a.gpuFrames++;
+            auto it = std::find_if(m_profiled.begin(), m_profiled.end(),
+                                   [&](const std::pair<uint64_t, uint64_t>& p) { return p.first == r.stageGpuFrame; });
+            if (it == m_profiled.end()) {
+                a.gpuUnmatched++;
+            } else {
+                const uint64_t lag = a.records - it->second;
+                a.gpuLagSum += lag;
+                a.gpuLagMax = std::max(a.gpuLagMax, lag);
+            }
+        }
+    }
+
+    void PrintWindow() {
+        if (m_cfg.windowMinutes <= 0.0) return;
+        if (!m_headerPrinted) {
+            std::cout << "  window     presents    fps   judder p99 ms  >" << m_cfg.judderMs
+                      << " ms   latency p50 ms   drops   lost  stalls" << std::endl;
+            m_headerPrinted = true;
+        }
+        const double minutes = (m_window.startSec - m_total.firstSec) / 60.0;
+        const double span = std::max(1e-9, std::min(m_cfg.windowMinutes * 60.0, m_total.lastSec - m_window.startSec));
+        std::cout << "  " << std::setw(6) << std::setprecision(1) << minutes << " min"
+                  << std::setw(10) << m_window.presents
+                  << std::setw(8) << std::setprecision(1) << m_window.presents / span
+                  << std::setw(14) << std::setprecision(2) << m_window.judder.Percentile(0.99)
+                  << std::setw(9) << m_window.judderEvents
+                  << std::setw(16) << std::setprecision(2) << m_window.sourceLatency.Percentile(0.5)
+                  << std::setw(9) << m_window.drops << std::setw(7) << m_window.lost
+                  << std::setw(8) << m_window.stalls << std::endl;
+    }
+
+    const Config& m_cfg;
+    Analysis m_total;
+    Window m_window;
+    TelemetryRecord m_prev;
+    std::deque<std::pair<uint64_t, uint64_t>> m_profiled;   // frame, record number of its CPU times
+    bool m_havePrev = false;
+    uint64_t m_lastFrame = 0;
+    bool m_headerPrinted = false;
+};
+
+void printHistogram(const char* name, const Histogram& h) {
+    std::cout << "  " << std::left << std::setw(22) << name << std::right << std::setprecision(2)
+              << std::setw(10) << h.Count() << std::setw(9) << h.Mean() << std::setw(9) << h.Percentile(0.5)
+              << std::setw(9) << h.Percentile(0.95) << std::setw(9) << h.Percentile(0.99)
+              << std::setw(10) << h.Max() << std::endl;
+}
+
+void printReport(const Config& cfg, const TelemetryFileHeader& header, const Analysis& a) {
+    const double duration = a.lastSec - a.firstSec;
+    std::cout << std::endl << "Session: " << a.records << " records, " << a.presents << " presents over "
+              << std::setprecision(1) << duration / 60.0 << " min ("
+              << (duration > 0.0 ? a.presents / duration : 0.0) << " presents/s), started at unix ms "
+              << header.startUnixMs << std::endl;
+    std::cout << "Paths:";
+    for (int i = 0; i < static_cast<int>(TelemetryPath::Count); i++) {
+        if (a.paths[i]) std::cout << " " << TelemetryPathName(static_cast<TelemetryPath>(i)) << "=" << a.paths[i];
+    }
+    std::cout << std::endl << "Presents skipped (unchanged output): " << a.presentsSkipped
+              << ", VRR holds: " << a.vrrHolds << ", stalls > " << cfg.stallMs << " ms: " << a.stalls << std::endl;
+
+    std::cout << std::endl << "Judder: " << a.judderEvents << " steps > " << cfg.judderMs << " ms ("
+              << std::setprecision(3) << (a.judder.Count() ? 100.0 * a.judderEvents / a.judder.Count() : 0.0)
+              << "%), " << a.repeats << " repeated content, " << a.reversals << " backwards" << std::endl;
+    std::cout << std::endl << "  metric (ms)               count     mean      p50      p95      p99       max"
+              << std::endl;
+    printHistogram("present interval", a.presentInterval);
+    printHistogram("judder (step error)", a.judder);
+    printHistogram("latency (newest src)", a.sourceLatency);
+    printHistogram("latency (shown)", a.displayLatency);
+    printHistogram("pacing wait", a.waitMs);
+    printHistogram("generate CPU", a.generateMs);
+    printHistogram("present call", a.presentMs);
+
+    if (!a.stageCpu.empty() || !a.stageGpu.empty()) {
+        const uint64_t joined = a.gpuFrames - a.gpuUnmatched;
+        std::cout << std::endl << "Stages: " << a.stageFrames << " profiled frames, GPU times for " << a.gpuFrames
+                  << ", resolved " << std::setprecision(1) << (joined ? static_cast<double>(a.gpuLagSum) / joined : 0.0)
+                  << " records later on average (max " << a.gpuLagMax << "), " << a.gpuUnmatched
+                  << " without their frame" << std::endl;
+        std::cout << "  stage (ms)                count     mean      p50      p95      p99       max" << std::endl;
+        for (int s = 0; s < kPipelineStageCount; s++) {
+            const std::string name = PipelineStageName(static_cast<PipelineStage>(s));
+            auto cpu = a.stageCpu.find(s);
+            if (cpu != a.stageCpu.end()) printHistogram((name + " CPU").c_str(), cpu->second);
+            auto gpu = a.stageGpu.find(s);
+            if (gpu != a.stageGpu.end()) printHistogram((name + " GPU").c_str(), gpu->second);
+        }
+    }
+
+    uint64_t totalDrops = 0;
+    for (uint64_t d : a.drops) totalDrops += d;
+    std::cout << std::endl << "Drops: " << totalDrops << " frames";
+    for (int i = 0; i < kTelemetryDropCount; i++) {
+        std::cout << ", " << TelemetryDropName(static_cast<TelemetryDrop>(i)) << " " << a.drops[i];
+    }
+    std::cout << std::endl << "Records lost (telemetry ring full): " << a.lost << std::endl;
+    if (a.peakResourceKiB != 0) {
+        std::cout << "Interpolator GPU memory: " << std::setprecision(1) << a.resourceKiB / 1024.0 << " MiB at the end, peak "
+                  << a.peakResourceKiB / 1024.0 << " MiB, " << a.resourceChanges << " reallocations" << std::endl;
+    }
+}
+
+bool analyzeFile(const Config& cfg, Analysis* out) {
+    TelemetryReader reader;
+    if (!reader.Open(cfg.file)) {
+        std::cout << reader.GetLastError() << std::endl;
+        return false;
+    }
+    std::cout << std::fixed << "Analyzing " << cfg.file << std::endl;
+    Analyzer analyzer(cfg);
+    TelemetryRecord record;
+    while (reader.Next(record)) {
+        analyzer.Add(record);
+    }
+    analyzer.Finish();
+    printReport(cfg, reader.Header(), analyzer.Result());
+    if (out) *out = analyzer.Result();
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Self-test
+// ---------------------------------------------------------------------------
+
+// 60 fps source presented at 144 Hz, content 20 ms behind the present. Every
+// 1000th present shows content 4 ms off (two visible judder steps), every
+// 100th counts a stale drop and every 250th two skipped source frames;
+// present 777 counts 1000 skipped frames at once. Every third present
+// generates profiler frame n / 3, whose GPU times arrive two presents later.
+TelemetryRecord syntheticRecord(uint64_t frame) {
+    const double presentSec = 1000.0 + static_cast<double>(frame) / 144.0;
+    const double displaySec = presentSec - 0.020 + (frame % 1000 == 500 ? 0.004 : 0.0);
+    const double currSec = std::floor((presentSec - 0.005) * 60.0) / 60.0;
+    TelemetryRecord r;
+    r.frame = frame;
+    r.presentSec = presentSec;
+    r.presentTime100ns = static_cast<int64_t>(std::llround(presentSec * 1e7));
+    r.displayTime100ns = static_cast<int64_t>(std::llround(displaySec * 1e7));
+    r.currTime100ns = static_cast<int64_t>(std::llround(currSec * 1e7));
+    r.alpha = 0.5f;
+    r.pairIntervalMs = 1000.0f / 60.0f;
+    r.waitMs = 5.0f;
+    r.generateMs = frame % 3 == 0 ? 1.5f : 0.0f;
+    r.path = static_cast<uint8_t>(frame % 3 == 0 ? TelemetryPath::Interpolated : TelemetryPath::CachedOutput);
+    r.flags = kTelemetryPresented | kTelemetryHasPair;
+    if (frame % 100 == 0) r.drops[static_cast<int>(TelemetryDrop::Stale)] = 1;
+    if (frame % 250 == 0) r.drops[static_cast<int>(TelemetryDrop::SourceSkipped)] = 2;
+    if (frame == 777) r.drops[static_cast<int>(TelemetryDrop::SourceSkipped)] = 1000;
+    if (frame % 3 == 0) {
+        r.stageCpuFrame = frame / 3;
+        r.stageCpuMs[static_cast<int>(PipelineStage::Execute)] = 1.4f;
+        r.stageCpuMs[static_cast<int>(PipelineStage::Downsample)] = 0.1f;
+    }
+    if (frame % 3 == 2 && frame >= 5) {
+        r.stageGpuFrame = (frame - 2) / 3;
+        r.stageGpuMs[static_cast<int>(PipelineStage::Execute)] = 0.8f;
+        r.stageGpuMs[static_cast<int>(PipelineStage::Interpolate)] = 0.3f;
+    }
+    r.resourceKiB = frame < 2000 ? 63540 : 71505;   // 1080p minimal, then full
+    return r;
+}
+
+int selfTest(Config cfg) {
+    bool ok = true;
+    auto fail = [&](const std::string& what) {
+        std::cout << "FAIL: " << what << std::endl;
+        ok = false;
+    };
+    if (cfg.file.empty()) cfg.file = "telemetry_self_test.tmtl";
+    std::cout << std::fixed;
+
+    TelemetryWriter writer;
+    if (!writer.Start(cfg.file)) {
+        std::cout << "Cannot write " << cfg.file << std::endl;
+        return 1;
+    }
+    // ~700x real time at 144 Hz: bursts of 500 every 5 ms, which the writer's
+    // 50 ms poll drains well inside the ring.
+    double maxSubmitSec = 0.0;
+    const double start = DeadlineWaiter::Now();
+    for (int i = 1; i <= cfg.selfTestFrames; i++) {
+        const TelemetryRecord record = syntheticRecord(static_cast<uint64_t>(i));
+        const double t0 = DeadlineWaiter::Now();
+        writer.Submit(record);
+        maxSubmitSec = std::max(maxSubmitSec, DeadlineWaiter::Now() - t0);
+        if (i % 500 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const double submitSec = DeadlineWaiter::Now() - start;
+    writer.Stop();
+    const TelemetryWriterStats stats = writer.Stats();
+    std::cout << "Self-test: " << stats.submitted << " records in " << std::setprecision(1) << submitSec * 1e3
+              << " ms (" << std::setprecision(0) << stats.submitted / submitSec << "/s, max Submit "
+              << std::setprecision(2) << maxSubmitSec * 1e6 << " us), " << stats.written << " written, "
+              << stats.dropped << " dropped, " << stats.bytes / 1024 << " KB ("
+              << std::setprecision(1) << stats.bytes / (stats.written / 144.0 / 3600.0) / (1024.0 * 1024.0)
+              << " MB per hour at 144 Hz)" << std::endl;
+    if (stats.failed) fail("write error");
+    if (stats.written + stats.dropped != stats.submitted) fail("writer lost count of records");
+
+    Analysis a;
+    cfg.windowMinutes = 5.0;
+    if (!analyzeFile(cfg, &a)) return 1;
+    std::cout << std::endl;
+    if (a.records != stats.written) fail("analyzer read " + std::to_string(a.records) + " records");
+    // Drops after the last written record leave no gap.
+    if (a.lost > stats.dropped) fail("more frame gaps than the writer dropped");
+    if (stats.dropped == 0) {
+        const uint64_t n = static_cast<uint64_t>(cfg.selfTestFrames);
+        const uint64_t injected = (n + 500) / 1000;          // frames 500, 1500, ...
+        const uint64_t lastInjected = (injected - 1) * 1000 + 500;
+        // Each injection disturbs the step into and out of it, unless it is the last record.
+        const uint64_t expectedJudder = injected * 2 - (lastInjected == n ? 1 : 0);
+        if (a.judderEvents != expectedJudder) {
+            fail("judder events " + std::to_string(a.judderEvents) + ", expected " + std::to_string(expectedJudder));
+        }
+        if (std::fabs(a.displayLatency.Percentile(0.5) - 20.0) > Histogram::kBinMs + 1e-6) fail("shown latency p50 is not 20 ms");
+        if (a.drops[static_cast<int>(TelemetryDrop::Stale)] != n / 100) fail("stale drop total");
+        if (a.drops[static_cast<int>(TelemetryDrop::SourceSkipped)] != 2 * (n / 250) + (n >= 777 ? 1000 : 0)) {
+            fail("source skip total");
+        }
+        if (a.generateMs.Count() != n / 3) fail("generate sample count");
+        const int execute = static_cast<int>(PipelineStage::Execute);
+        if (a.stageFrames != n / 3 || a.stageCpu[execute].Count() != n / 3) fail("CPU stage frame count");
+        if (a.gpuFrames != (n - 2) / 3 || a.stageGpu[execute].Count() != (n - 2) / 3) fail("GPU stage frame count");
+        if (a.gpuUnmatched != 0 || a.gpuLagMax != 2 || a.gpuLagSum != 2 * a.gpuFrames) fail("GPU times not joined to their frames");
+        if (std::fabs(a.stageGpu[execute].Mean() - 0.8) > 1e-3) fail("GPU Execute mean");
+        if (a.peakResourceKiB != (n >= 2000 ? 71505u : 63540u)) fail("peak resource footprint");
+    } else {
+        std::cout << "Ring overflowed on this host; exact figure checks skipped" << std::endl;
+    }
+
+    // A log cut mid-record (writer killed) still reads up to the last whole record.
+    {
+        std::FILE* in = std::fopen(cfg.file.c_str(), "rb");
+        const std::string cut = cfg.file + ".cut";
+        std::FILE* out = std::fopen(cut.c_str(), "wb");
+        std::vector<char> buffer(1 << 16);
+        uint64_t copied = 0;
+        const uint64_t keepBytes = stats.bytes - sizeof(TelemetryRecord) / 2;
+        size_t got = 0;
+        while (in && out && copied < keepBytes && (got = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+            const size_t take = static_cast<size_t>(std::min<uint64_t>(got, keepBytes - copied));
+            std::fwrite(buffer.data(), 1, take, out);
+            copied += take;
+        }
+        if (in) std::fclose(in);
+        if (out) std::fclose(out);
+        TelemetryReader reader;
+        uint64_t count = 0;
+        TelemetryRecord record;
+        if (reader.Open(cut)) {
+            while (reader.Next(record)) count++;
+        }
+        reader.Close();
+        std::remove(cut.c_str());
+        std::cout << "Truncated log: " << count << " of " << stats.written << " records readable" << std::endl;
+        if (count + 1 != stats.written) fail("truncated log did not stop at the last whole record");
+    }
+
+    if (!cfg.keep) std::remove(cfg.file.c_str());
+    return ok ? 0 : 1;
+}
+
+void printUsage() {
+    std::cout << "Usage: telemetry_analyze <log.tmtl> [options]" << std::endl;
+    std::cout << "       telemetry_analyze --self-test [options]" << std::endl;
+    std::cout << "  --window <min>      Per-window rows every <min> minutes, 0 = off (default 10)" << std::endl;
+    std::cout << "  --judder-ms <ms>    Step error counted as visible judder (default 2)" << std::endl;
+    std::cout << "  --stall-ms <ms>     Present gap counted as a stall (default 250)" << std::endl;
+    std::cout << "  --self-test         Write, analyze and check a synthetic log" << std::endl;
+    std::cout << "  --frames <n>        Self-test records (default 200000)" << std::endl;
+    std::cout << "  --keep              Keep the self-test log" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--window" && i+1 < argc) cfg.windowMinutes = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--judder-ms" && i+1 < argc) cfg.judderMs = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--stall-ms" && i+1 < argc) cfg.stallMs = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--self-test") cfg.selfTest = true;
+        else if (arg == "--frames" && i+1 < argc) cfg.selfTestFrames = std::max(1000, std::atoi(argv[++i]));
+        else if (arg == "--keep") cfg.keep = true;
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else if (!arg.empty() && arg[0] != '-' && cfg.file.empty()) cfg.file = arg;
+        else { printUsage(); return 1; }
+    }
+    if (cfg.selfTest) return selfTest(cfg);
+    if (cfg.file.empty()) { printUsage(); return 1; }
+    return analyzeFile(cfg, nullptr) ? 0 : 1;
+}
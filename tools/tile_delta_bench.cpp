@@ -0,0 +1,246 @@
+// Tile-delta benchmark for the shared-memory capture path: drives the real
+// frame ring writer/reader in one process with the hook-side encoder and the
+// consumer-side decoder, over synthetic desktop/game scenarios. Reports bytes
+// moved and CPU time against full-frame copies, and checks that the patched
+// consumer copy matches the source exactly.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "shared_frame_ring.h"
+#include "tile_delta.h"
+
+struct Config {
+    uint32_t width = 2560;
+    uint32_t height = 1440;
+    int frames = 240;
+    uint32_t slots = 3;
+    std::vector<int> readEvery = {1, 3};
+};
+
+enum class Scenario {
+    Static,     // desktop: blinking caret and a clock
+    Hud,        // static scene with counters and a minimap
+    Scroll,     // document scrolling under a fixed toolbar
+    Motion,     // full-screen camera pan
+};
+
+const char* scenarioName(Scenario s) {
+    switch (s) {
+        case Scenario::Static: return "static";
+        case Scenario::Hud: return "hud";
+        case Scenario::Scroll: return "scroll";
+        case Scenario::Motion: return "motion";
+    }
+    return "?";
+}
+
+inline uint32_t hashPixel(uint32_t x, uint32_t y) {
+    uint32_t h = x * 0x9E3779B1u ^ y * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+inline uint32_t pattern(uint32_t x, uint32_t y) {
+    uint32_t n = hashPixel(x >> 2, y >> 2) & 0x1F1F1F;
+    uint32_t g = ((x >> 3) & 0xFF) | (((y >> 3) & 0xFF) << 8) | ((((x + y) >> 4) & 0xFF) << 16);
+    return 0xFF000000u | (g + n);
+}
+
+void fillRect(uint8_t* img, size_t pitch, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, uint32_t color) {
+    for (uint32_t y = y0; y < y0 + h; y++) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(img + pitch * y);
+        std::fill(row + x0, row + x0 + w, color);
+    }
+}
+
+// Updates img in place to frame t; only touches what the scenario changes.
+void renderFrame(Scenario s, int t, uint8_t* img, size_t pitch, uint32_t w, uint32_t h) {
+    if (t == 0 || s == Scenario::Scroll || s == Scenario::Motion) {
+        uint32_t scrollTop = s == Scenario::Scroll ? std::min(h, 96u) : 0;
+        for (uint32_t y = 0; y < h; y++) {
+            uint32_t* row = reinterpret_cast<uint32_t*>(img + pitch * y);
+            for (uint32_t x = 0; x < w; x++) {
+                if (s == Scenario::Scroll && y >= scrollTop) {
+                    row[x] = pattern(x, y + static_cast<uint32_t>(t) * 6);
+                } else if (s == Scenario::Motion) {
+                    row[x] = pattern(x + static_cast<uint32_t>(t) * 5, y + static_cast<uint32_t>(t) * 2);
+                } else if (t == 0) {
+                    row[x] = pattern(x, y);
+                }
+            }
+        }
+        if (s != Scenario::Static && s != Scenario::Hud) return;
+    }
+    uint32_t color = 0xFF000000u | (hashPixel(static_cast<uint32_t>(t), 7) & 0xFFFFFF);
+    if (s == Scenario::Static) {
+        // Caret toggles twice a second at 60 fps, the clock once a second.
+        bool caret = (t / 30) % 2 == 0;
+        fillRect(img, pitch, std::min(w - 2, w / 3), std::min(h - 20, h / 4), 2, 20, caret ? 0xFF000000u : pattern(w / 3, h / 4));
+        if (t % 60 == 0) fillRect(img, pitch, w - std::min(w, 120u), h - std::min(h, 40u), std::min(w, 110u), std::min(h, 30u), color);
+    } else if (s == Scenario::Hud) {
+        fillRect(img, pitch, 40, 40, std::min(w - 40, 300u), std::min(h - 40, 60u), color);
+        fillRect(img, pitch, w - std::min(w, 296u), h - std::min(h, 296u), std::min(w, 256u), std::min(h, 256u),
+                 color ^ 0x00FF00u);
+    }
+}
+
+struct Result {
+    double changedPct = 0.0;
+    double writtenPct = 0.0;
+    double uploadPct = 0.0;
+    double encodeMs = 0.0;
+    double decodeMs = 0.0;
+    double fullCopyMs = 0.0;
+    uint64_t reads = 0;
+    bool exact = true;
+};
+
+Result run(Scenario s, int readEvery, const Config& cfg) {
+    const uint32_t w = cfg.width;
+    const uint32_t h = cfg.height;
+    const uint32_t bpp = 4;
+    const uint32_t pitch = (w * bpp + 255) / 256 * 256;
+    const uint64_t metaBytes = TileDeltaEncoder::StampTableBytes(w, h);
+    const uint64_t mapSize = shared_frame_ring::MappingSize(cfg.slots, pitch, h, metaBytes);
+
+    std::vector<uint8_t> mapping(mapSize + SHARED_FRAME_RING_ALIGN);
+    void* base = mapping.data() + (SHARED_FRAME_RING_ALIGN -
+                 reinterpret_cast<uintptr_t>(mapping.data()) % SHARED_FRAME_RING_ALIGN) % SHARED_FRAME_RING_ALIGN;
+
+    SharedFrameRingWriter writer;
+    SharedFrameRingReader reader;
+    writer.Initialize(base, mapSize, cfg.slots, w, h, pitch, 87 /* DXGI_FORMAT_B8G8R8A8_UNORM */,
+                      1000000000, TileDeltaEncoder::kTileSize, metaBytes);
+    reader.Attach(base, mapSize);
+
+    TileDeltaEncoder encoder;
+    encoder.Reset(w, h, bpp);
+    TileDeltaDecoder decoder;
+    decoder.Reset(w, h);
+
+    const size_t srcPitch = static_cast<size_t>(w) * bpp;
+    std::vector<uint8_t> src(srcPitch * h);
+    std::vector<uint8_t> consumer(srcPitch * h);
+    std::vector<uint8_t> scratch(static_cast<size_t>(pitch) * h);
+
+    Result r;
+    double decodeSec = 0.0;
+    double fullSec = 0.0;
+    uint64_t uploadPixels = 0;
+    for (int t = 0; t < cfg.frames; t++) {
+        renderFrame(s, t, src.data(), srcPitch, w, h);
+
+        uint8_t* dest = writer.BeginWrite();
+        encoder.Encode(src.data(), srcPitch, writer.NextFrame(), dest, pitch, writer.PreviousSlotFrame(),
+                       reinterpret_cast<uint64_t*>(writer.SlotMeta()));
+        writer.EndWrite(t);
+
+        // Baseline: the row copy the hook did before tile deltas.
+        auto fullStart = std::chrono::steady_clock::now();
+        for (uint32_t y = 0; y < h; y++) {
+            std::memcpy(scratch.data() + static_cast<size_t>(pitch) * y, src.data() + srcPitch * y, srcPitch);
+        }
+        fullSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - fullStart).count();
+
+        if (t % readEvery != 0) continue;
+        SharedFrameView view;
+        if (!reader.BeginRead(&view)) {
+            r.exact = false;
+            continue;
+        }
+        auto decodeStart = std::chrono::steady_clock::now();
+        const auto& rects = decoder.Plan(reinterpret_cast<const uint64_t*>(view.meta));
+        TileDeltaDecoder::Apply(rects, view.data, pitch, consumer.data(), srcPitch, bpp);
+        decodeSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - decodeStart).count();
+        uploadPixels += decoder.PlannedPixels();
+        if (reader.EndRead(view)) {
+            decoder.Commit(view.frame);
+        } else {
+            decoder.Invalidate();
+        }
+        r.reads++;
+        r.exact = r.exact && consumer == src;
+    }
+
+    const TileDeltaStats& stats = encoder.Stats();
+    r.changedPct = stats.tilesTotal ? 100.0 * stats.tilesChanged / stats.tilesTotal : 0.0;
+    r.writtenPct = 100.0 * stats.WriteRatio();
+    r.uploadPct = r.reads ? 100.0 * uploadPixels / (static_cast<double>(w) * h * r.reads) : 0.0;
+    r.encodeMs = stats.encodeSec / cfg.frames * 1000.0;
+    r.fullCopyMs = fullSec / cfg.frames * 1000.0;
+    r.decodeMs = r.reads ? decodeSec / r.reads * 1000.0 : 0.0;
+    return r;
+}
+
+void printUsage() {
+    std::cout << "Usage: tile_delta_bench [options]" << std::endl;
+    std::cout << "  --size <W>x<H>      Frame size (default 2560x1440)" << std::endl;
+    std::cout << "  --frames <n>        Frames per scenario (default 240)" << std::endl;
+    std::cout << "  --slots <n>         Ring slots (default 3)" << std::endl;
+    std::cout << "  --read-every <n>    Consumer reads every n-th frame (default: 1 and 3)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    bool customRead = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i+1 < argc) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) { printUsage(); return 1; }
+            cfg.width = static_cast<uint32_t>(std::atoi(v.substr(0, x).c_str()));
+            cfg.height = static_cast<uint32_t>(std::atoi(v.substr(x + 1).c_str()));
+        }
+        else if (arg == "--frames" && i+1 < argc) cfg.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--slots" && i+1 < argc) cfg.slots = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if (arg == "--read-every" && i+1 < argc) {
+            if (!customRead) { cfg.readEvery.clear(); customRead = true; }
+            cfg.readEvery.push_back(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+    if (cfg.width < 8 || cfg.height < 8 || cfg.slots < 2 || cfg.slots > SHARED_FRAME_RING_MAX_SLOTS) {
+        printUsage();
+        return 1;
+    }
+
+    std::cout << cfg.width << "x" << cfg.height << " BGRA8, " << cfg.frames << " frames, "
+              << cfg.slots << " slots, " << TileDeltaEncoder::kTileSize << "px tiles" << std::endl;
+    std::cout << "written/upload are % of full-frame bytes; full copy is the pre-delta row copy." << std::endl;
+    std::cout << std::endl;
+    std::cout << "scenario  read  changed  written   upload  encode ms  full copy ms  decode ms  exact" << std::endl;
+
+    bool allExact = true;
+    std::cout << std::fixed;
+    for (Scenario s : {Scenario::Static, Scenario::Hud, Scenario::Scroll, Scenario::Motion}) {
+        for (int readEvery : cfg.readEvery) {
+            Result r = run(s, readEvery, cfg);
+            allExact = allExact && r.exact;
+            std::cout << std::left << std::setw(10) << scenarioName(s) << std::right
+                      << std::setw(4) << readEvery
+                      << std::setprecision(1) << std::setw(8) << r.changedPct << "%"
+                      << std::setw(8) << r.writtenPct << "%"
+                      << std::setw(8) << r.uploadPct << "%"
+                      << std::setprecision(3) << std::setw(11) << r.encodeMs
+                      << std::setw(14) << r.fullCopyMs
+                      << std::setw(11) << r.decodeMs
+                      << std::setw(7) << (r.exact ? "yes" : "NO") << std::endl;
+        }
+    }
+    if (!allExact) {
+        std::cout << "FAIL: patched consumer copy differs from the source" << std::endl;
+        return 1;
+    }
+    return 0;
+}
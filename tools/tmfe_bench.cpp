@@ -0,0 +1,1039 @@
+// Headless pipeline benchmark: drives ReferenceInterpolator (the portable
+// CPU model of the interpolation pipeline) over a recorded session, an image
+// sequence, a synthetic clip or a SyntheticMotionGenerator scenario, for
+// every motion model / quality mode /
+// pipeline combination, and reports per-stage time, throughput, working
+// memory, quality against ground truth (PSNR, SSIM, MS-SSIM, GMSD) and
+// temporal flicker as JSON.
+//
+// Ground truth: frames i and i+2 are interpolated at alpha 0.5 and compared
+// with frame i+1. Scenarios are streamed from memory instead: frames i and
+// i+1 against the true frame at i+0.5, one pair resident at a time, so 8K
+// clips do not need to fit in memory or on disk.
+//
+// With --x11 (Unix builds with X11) the loaded frames are drawn onto an X
+// screen, e.g. Xvfb, and read back through X11Capture as an ICaptureSource
+// before the sweep, so the pixels are captured ones and the report carries
+// the capture cost and how much of each frame DAMAGE marked dirty.
+//
+// Every config runs --warmup untimed passes, then --repeat timed passes over
+// the clip; ms/frame is the median pass. With --baseline the results are
+// compared with an earlier JSON report; a config slower, larger or lower
+// quality than the thresholds allow is a regression and the exit code is 1.
+// A time regression must hold across all passes: the fastest pass of this
+// run has to be slower than the slowest baseline pass by the threshold plus
+// the wider of the two fastest-to-slowest pass ranges, and a config over
+// that is timed once more, so a host stall covering one config's passes does
+// not fail identical builds. A baseline without pass ranges or SSIM is an
+// error.
+//
+// Times and quality are the CPU reference model's. There is no parity check
+// against the HLSL: they track changes to the modelled pipeline run against
+// run, and say nothing absolute about the shipped GPU path.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "deadline_wait.h"
+#include "frame_graph.h"
+#include "frame_stream.h"
+#include "motion_model.h"
+#include "pixel_convert.h"
+#include "quality_metrics.h"
+#include "reference_interpolator.h"
+#include "resolution_bucket.h"
+#include "resource_registry.h"
+#include "stage_timer.h"
+#include "synthetic_motion.h"
+
+#ifdef TFE_HAVE_X11
+#include <chrono>
+#include <thread>
+#include "x11_capture.h"
+#include "x11_harness.h"
+#undef Bool      // Xlib macro, clashes with JsonValue::Type::Bool
+#endif
+
+struct Config {
+    std::string session;
+    std::string imageDir;
+    std::string scenario;
+    std::string x11Display;          // --x11: capture the frames back from this display
+    uint32_t seed = 1;
+    int width = 640;                 // synthetic clip
+    int height = 360;
+    int maxFrames = 8;
+    int warmup = 1;
+    int repeat = 5;
+    std::vector<int> models = {0, 1, 2, 3};
+    std::vector<int> qualities = {0, 1};
+    std::vector<int> pipelines = {1, 0};    // 1 minimal, 0 full
+    std::string jsonPath = "tmfe_bench.json";
+    std::string baselinePath;
+    double timeThresholdPct = 10.0;
+    double memoryThresholdPct = 5.0;
+    double psnrThresholdDb = 0.1;
+    double ssimThreshold = 0.002;
+    int memoryWidth = 0;             // --report-memory
+    int memoryHeight = 0;
+};
+
+void printUsage() {
+    std::cout << "Usage: tmfe_bench [options]\n"
+              << "Input (default: synthetic clip):\n"
+              << "  --session F.tmfs     recorded session\n"
+              << "  --images DIR         DIR/frame_0.png, frame_1.png, ...\n"
+              << "  --scenario NAME      streamed synthetic scenario with true middle frames: pan, rotatezoom,\n"
+              << "                       fastobjects, periodic, hudoverlay, fade, scenecut (--size up to 7680x4320)\n"
+              << "  --seed N             scenario seed (default 1)\n"
+              << "  --size WxH           synthetic clip / scenario size (default 640x360)\n"
+              << "  --frames N           frames to load (default 8)\n";
+#ifdef TFE_HAVE_X11
+    std::cout << "  --x11 DISPLAY        draw the frames on DISPLAY (e.g. Xvfb :99) and sweep what X11Capture\n"
+              << "                       reads back; not with --scenario\n";
+#endif
+    std::cout << "Sweep:\n"
+              << "  --models LIST        motion models, e.g. 0,2 (0 Adaptive, 1 Stable, 2 Balanced, 3 Coverage)\n"
+              << "  --quality LIST       quality modes (0 Standard, 1 High)\n"
+              << "  --pipeline LIST      minimal,full\n"
+              << "  --warmup N           untimed passes per config before timing (default 1, at least 1)\n"
+              << "  --repeat N           timed passes per config; ms/frame is the median pass (default 5)\n"
+              << "Output:\n"
+              << "  --json F             report path (default tmfe_bench.json)\n"
+              << "  --baseline F         compare with an earlier report\n"
+              << "  --time-threshold P   allowed slowdown of the fastest pass over the slowest\n"
+              << "                       baseline pass, percent (default 10)\n"
+              << "  --memory-threshold P allowed memory increase, percent (default 5)\n"
+              << "  --psnr-threshold DB  allowed PSNR drop (default 0.1)\n"
+              << "  --ssim-threshold S   allowed SSIM drop (default 0.002)\n"
+              << "  --report-memory WxH  print the GPU interpolator's texture footprint and the frame graph\n"
+              << "                       peaks before / after aliasing at WxH, check aliasing, and exit\n";
+}
+
+std::vector<int> parseList(const std::string& text, const std::map<std::string, int>& names = {}) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        auto it = names.find(item);
+        values.push_back(it != names.end() ? it->second : std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+// ----------------------------------------------------------------------------
+// Input
+// ----------------------------------------------------------------------------
+
+struct Clip {
+    std::string source;
+    int width = 0;
+    int height = 0;
+    std::vector<std::vector<uint8_t>> frames;   // Bgra8, tightly packed
+    std::unique_ptr<SyntheticMotionGenerator> generator;   // streamed scenario, frames unused
+    std::string capture;                        // --x11 capture stats as a JSON object
+
+    CpuFrame Frame(size_t i) const {
+        CpuFrame frame;
+        frame.data = frames[i].data();
+        frame.pitch = static_cast<size_t>(width) * 4;
+        frame.width = width;
+        frame.height = height;
+        frame.format = PixelFormat::Bgra8;
+        frame.sequence = i;
+        return frame;
+    }
+
+    size_t FrameCount() const {
+        return generator ? static_cast<size_t>(generator->Settings().frames) : frames.size();
+    }
+    size_t Steps() const {
+        return generator ? static_cast<size_t>(generator->PairCount()) : frames.size() - 2;
+    }
+    // fn(a, b, truth) for every scored step, in order: interpolating a and b
+    // at alpha 0.5 should give truth.
+    template <typename Fn>
+    void ForEachStep(Fn&& fn) const {
+        if (generator) {
+            SyntheticSample sample;
+            generator->Rewind();
+            while (generator->Next(sample, false, true)) {
+                fn(sample.Prev(), sample.Next(), sample.Middle());
+            }
+            return;
+        }
+        for (size_t i = 0; i + 2 < frames.size(); ++i) {
+            fn(Frame(i), Frame(i + 2), Frame(i + 1));
+        }
+    }
+};
+
+bool loadSession(const Config& cfg, Clip& clip, std::string& error) {
+    FrameStreamReader reader;
+    if (!reader.Open(cfg.session)) {
+        error = reader.GetLastError();
+        return false;
+    }
+    clip.source = cfg.session;
+    CpuFrame frame;
+    while (static_cast<int>(clip.frames.size()) < cfg.maxFrames && reader.Next(frame)) {
+        if (clip.frames.empty()) {
+            clip.width = frame.width;
+            clip.height = frame.height;
+        } else if (frame.width != clip.width || frame.height != clip.height) {
+            break;   // resized mid-session; keep the first run
+        }
+        std::vector<uint8_t> pixels(static_cast<size_t>(clip.width) * clip.height * 4);
+        PixelConvertParams params;
+        params.srcFormat = frame.format;
+        params.dstFormat = PixelFormat::Bgra8;
+        params.width = static_cast<uint32_t>(frame.width);
+        params.height = static_cast<uint32_t>(frame.height);
+        params.src = frame.data;
+        params.srcPitch = frame.pitch;
+        params.dst = pixels.data();
+        params.dstPitch = static_cast<size_t>(clip.width) * 4;
+        if (!ConvertPixels(params)) {
+            error = "unsupported pixel format in " + cfg.session;
+            return false;
+        }
+        clip.frames.push_back(std::move(pixels));
+    }
+    return true;
+}
+
+bool loadImages(const Config& cfg, Clip& clip, std::string& error) {
+    clip.source = cfg.imageDir;
+    for (int i = 0; i < cfg.maxFrames; ++i) {
+        const std::string path = cfg.imageDir + "/frame_" + std::to_string(i) + ".png";
+        int w = 0, h = 0, channels = 0;
+        unsigned char* rgba = stbi_load(path.c_str(), &w, &h, &channels, 4);
+        if (!rgba) {
+            break;
+        }
+        if (clip.frames.empty()) {
+            clip.width = w;
+            clip.height = h;
+        }
+        if (w != clip.width || h != clip.height) {
+            stbi_image_free(rgba);
+            error = path + " has a different size";
+            return false;
+        }
+        std::vector<uint8_t> pixels(static_cast<size_t>(w) * h * 4);
+        for (size_t p = 0; p < pixels.size(); p += 4) {
+            pixels[p + 0] = rgba[p + 2];
+            pixels[p + 1] = rgba[p + 1];
+            pixels[p + 2] = rgba[p + 0];
+            pixels[p + 3] = 255;
+        }
+        stbi_image_free(rgba);
+        clip.frames.push_back(std::move(pixels));
+    }
+    if (clip.frames.empty()) {
+        error = "no frame_0.png in " + cfg.imageDir;
+        return false;
+    }
+    return true;
+}
+
+bool loadScenario(const Config& cfg, Clip& clip, std::string& error) {
+    SyntheticSettings settings;
+    if (!ParseSyntheticScenario(cfg.scenario, settings.scenario)) {
+        error = "unknown scenario " + cfg.scenario;
+        return false;
+    }
+    settings.width = cfg.width;
+    settings.height = cfg.height;
+    settings.frames = cfg.maxFrames;
+    settings.seed = cfg.seed;
+    clip.generator = std::make_unique<SyntheticMotionGenerator>();
+    if (!clip.generator->Configure(settings)) {
+        error = clip.generator->GetLastError();
+        return false;
+    }
+    clip.source = std::string("scenario:") + SyntheticScenarioName(settings.scenario);
+    clip.width = cfg.width;
+    clip.height = cfg.height;
+    return true;
+}
+
+// Four octaves of value noise panning right/down, with a block moving
+// against it.
+void makeSynthetic(const Config& cfg, Clip& clip) {
+    clip.source = "synthetic";
+    clip.width = cfg.width;
+    clip.height = cfg.height;
+    constexpr int kCell = 8;     // finest octave
+    const int cellsX = cfg.width / kCell + 128;
+    const int cellsY = cfg.height / kCell + 128;
+    std::vector<float> lattice(static_cast<size_t>(cellsX) * cellsY * 3);
+    uint32_t state = 12345u;
+    for (float& v : lattice) {
+        state = state * 1664525u + 1013904223u;
+        v = static_cast<float>(state >> 24) - 128.0f;
+    }
+    auto octave = [&](float x, float y, int c, int cell) {
+        x = std::max(0.0f, x) / cell;
+        y = std::max(0.0f, y) / cell;
+        const int x0 = std::min(static_cast<int>(x), cellsX - 2);
+        const int y0 = std::min(static_cast<int>(y), cellsY - 2);
+        const float fx = x - x0, fy = y - y0;
+        const float sx = fx * fx * (3 - 2 * fx), sy = fy * fy * (3 - 2 * fy);
+        auto at = [&](int xx, int yy) { return lattice[(static_cast<size_t>(yy) * cellsX + xx) * 3 + c]; };
+        const float top = at(x0, y0) + (at(x0 + 1, y0) - at(x0, y0)) * sx;
+        const float bottom = at(x0, y0 + 1) + (at(x0 + 1, y0 + 1) - at(x0, y0 + 1)) * sx;
+        return top + (bottom - top) * sy;
+    };
+    auto noise = [&](float x, float y, int c) {
+        return 128.0f + 0.9f * octave(x, y, c, kCell * 8) + 0.45f * octave(x, y, c, kCell * 4) +
+               0.25f * octave(x, y, c, kCell * 2) + 0.15f * octave(x, y, c, kCell);
+    };
+    const int blockW = cfg.width / 5, blockH = cfg.height / 4;
+    for (int f = 0; f < cfg.maxFrames; ++f) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(cfg.width) * cfg.height * 4);
+        const float bgX = 3.0f * f, bgY = 1.0f * f;
+        const int blockX = cfg.width / 2 - 6 * f, blockY = cfg.height / 4 + 4 * f;
+        for (int y = 0; y < cfg.height; ++y) {
+            for (int x = 0; x < cfg.width; ++x) {
+                const bool inBlock = x >= blockX && x < blockX + blockW && y >= blockY && y < blockY + blockH;
+                uint8_t* p = &pixels[(static_cast<size_t>(y) * cfg.width + x) * 4];
+                for (int c = 0; c < 3; ++c) {
+                    // The block carries its own texture, fixed to the block.
+                    const float v = inBlock ? 255.0f - noise(x - blockX + 200.0f, y - blockY + 200.0f, c)
+                                            : noise(x - bgX + 400.0f, y - bgY + 400.0f, c);
+                    p[c] = static_cast<uint8_t>(std::clamp(v, 0.0f, 255.0f));
+                }
+                p[3] = 255;
+            }
+        }
+        clip.frames.push_back(std::move(pixels));
+    }
+}
+
+#ifdef TFE_HAVE_X11
+// Draws every frame at the top-left of the screen and takes it back through
+// the ICaptureSource interface, patching the dirty rectangles into a copy of
+// the screen as the app's consumers do. The readback must match what was
+// drawn (alpha is not captured; frames keep their own) and every draw must
+// produce a frame within kTimeoutMs, otherwise the run fails.
+bool captureThroughX11(const Config& cfg, Clip& clip, std::string& error) {
+    constexpr int kTimeoutMs = 200;
+    X11Capture capture;
+    if (!capture.StartCapture(cfg.x11Display.c_str())) {
+        error = "X11 capture: " + capture.GetLastError();
+        return false;
+    }
+    X11Producer producer;
+    if (!producer.Open(cfg.x11Display.c_str())) {
+        error = "cannot draw on " + cfg.x11Display;
+        return false;
+    }
+    if (producer.Width() < clip.width || producer.Height() < clip.height) {
+        error = "screen " + std::to_string(producer.Width()) + "x" + std::to_string(producer.Height()) +
+                " is smaller than the clip";
+        return false;
+    }
+    const size_t pitch = producer.Pitch();
+    const size_t rowBytes = static_cast<size_t>(clip.width) * 4;
+    std::vector<uint8_t> screen(pitch * producer.Height());
+    ICaptureSource& source = capture;
+    SourceFrame frame;
+    while (source.AcquireFrame(frame)) PatchFrame(frame.cpu, screen.data(), pitch);
+    const X11CaptureStats before = capture.Stats();
+
+    int missed = 0;
+    int mismatched = 0;
+    for (std::vector<uint8_t>& pixels : clip.frames) {
+        producer.Put(pixels.data(), rowBytes, 0, 0, clip.width, clip.height);
+        producer.Sync();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(kTimeoutMs);
+        bool got = false;
+        while (!(got = source.AcquireFrame(frame)) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        if (!got) {
+            missed++;
+            continue;
+        }
+        if (frame.cpu.format != PixelFormat::Bgra8) {
+            error = "X11 capture: expected a BGRA screen";
+            return false;
+        }
+        do {
+            PatchFrame(frame.cpu, screen.data(), pitch);
+        } while (source.AcquireFrame(frame));
+        if (!SameColor(screen.data(), pitch, pixels.data(), rowBytes, clip.width, clip.height)) mismatched++;
+        for (int y = 0; y < clip.height; ++y) {
+            const uint8_t* src = screen.data() + y * pitch;
+            uint8_t* dst = pixels.data() + y * rowBytes;
+            for (int x = 0; x < clip.width; ++x) std::memcpy(dst + x * 4, src + x * 4, 3);
+        }
+    }
+
+    const X11CaptureStats& after = capture.Stats();
+    const uint64_t frames = after.frames - before.frames;
+    const uint64_t totalPixels = after.totalPixels - before.totalPixels;
+    const double dirtyRatio =
+        totalPixels > 0 ? static_cast<double>(after.dirtyPixels - before.dirtyPixels) / totalPixels : 1.0;
+    const double readMs = frames > 0 ? (after.readSec - before.readSec) * 1000.0 / frames : 0.0;
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(6) << "{\"backend\": \"" << source.SourceName() << "\", \"display\": \""
+       << cfg.x11Display << "\", \"damage\": " << (capture.HasDamage() ? "true" : "false")
+       << ", \"frames\": " << frames << ", \"missed\": " << missed << ", \"mismatched\": " << mismatched
+       << ", \"read_ms_per_frame\": " << readMs << ", \"dirty_ratio\": " << dirtyRatio << "}";
+    clip.capture = ss.str();
+    clip.source += " via X11 " + cfg.x11Display;
+    std::cout << "Capture: " << source.SourceName() << " " << cfg.x11Display << ", damage "
+              << (capture.HasDamage() ? "on" : "unavailable") << ", " << std::fixed << std::setprecision(3) << readMs
+              << " ms/frame read, " << std::setprecision(1) << dirtyRatio * 100.0 << "% dirty, " << missed
+              << " missed, " << mismatched << " mismatched" << std::endl;
+    capture.StopCapture();
+    if (missed > 0 || mismatched > 0) {
+        error = "X11 capture lost or altered frames";
+        return false;
+    }
+    return true;
+}
+#endif
+
+CpuFrame outputFrame(const ReferenceInterpolator& interpolator) {
+    CpuFrame frame;
+    frame.data = interpolator.Output().data();
+    frame.pitch = static_cast<size_t>(interpolator.Width()) * 4;
+    frame.width = interpolator.Width();
+    frame.height = interpolator.Height();
+    frame.format = PixelFormat::Bgra8;
+    return frame;
+}
+
+// ----------------------------------------------------------------------------
+// Benchmark
+// ----------------------------------------------------------------------------
+
+struct StageResult {
+    std::string name;
+    double meanMs = 0.0;
+    double p95Ms = 0.0;
+};
+
+struct Result {
+    std::string name;
+    int model = 0;
+    int quality = 0;
+    bool minimal = true;
+    int frames = 0;
+    double msPerFrame = 0.0;         // median pass
+    double msPerFrameMin = 0.0;      // fastest / slowest pass
+    double msPerFrameMax = 0.0;
+    double megapixelsPerSec = 0.0;
+    uint64_t memoryBytes = 0;
+    double psnr = 0.0;
+    double ssim = 0.0;
+    double msSsim = 0.0;
+    double gmsd = 0.0;
+    double temporalError = 0.0;
+    double brightnessFlicker = 0.0;
+    std::vector<StageResult> stages;
+};
+
+std::string configName(int model, int quality, bool minimal) {
+    std::string name = MotionModelName(model);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    return name + (quality >= 1 ? "/high" : "/standard") + (minimal ? "/minimal" : "/full");
+}
+
+Result runConfig(const Clip& clip, int model, int quality, bool minimal, int warmup, int repeat) {
+    Result result;
+    result.name = configName(model, quality, minimal);
+    result.model = model;
+    result.quality = quality;
+    result.minimal = minimal;
+
+    auto interpolator = std::make_unique<ReferenceInterpolator>();
+    interpolator->Resize(clip.width, clip.height);
+    ReferenceSettings settings;
+    settings.motionModel = model;
+    settings.qualityMode = quality;
+    settings.minimalPipeline = minimal;
+    interpolator->SetSettings(settings);
+
+    const size_t triplets = clip.Steps();
+    uint64_t firstFrame = 0;
+
+    // Scored on the first warm-up pass, outside the timed calls; the warm-up
+    // also allocates the finer levels.
+    QualityScores sum;
+    FlickerMeter flicker;
+    std::vector<double> passMs;
+    for (int pass = 0; pass < warmup + repeat; ++pass) {
+        if (pass == warmup) {
+            firstFrame = interpolator->Profiler().Frame() + 1;
+        }
+        double elapsed = 0.0;
+        clip.ForEachStep([&](const CpuFrame& a, const CpuFrame& b, const CpuFrame& truth) {
+            const double start = DeadlineWaiter::Now();
+            interpolator->Execute(a, b, 0.5f);
+            elapsed += DeadlineWaiter::Now() - start;
+            if (pass == 0) {
+                QualityScores scores;
+                MeasureQuality(outputFrame(*interpolator), truth, scores);
+                flicker.Add(outputFrame(*interpolator), truth);
+                sum.psnr += scores.psnr;
+                sum.ssim += scores.ssim;
+                sum.msSsim += scores.msSsim;
+                sum.gmsd += scores.gmsd;
+            }
+        });
+        if (pass >= warmup) {
+            passMs.push_back(elapsed * 1e3 / triplets);
+        }
+    }
+    std::sort(passMs.begin(), passMs.end());
+    const size_t mid = passMs.size() / 2;
+    result.frames = static_cast<int>(triplets) * repeat;
+    result.msPerFrame = passMs.size() % 2 ? passMs[mid] : (passMs[mid - 1] + passMs[mid]) / 2.0;
+    result.msPerFrameMin = passMs.front();
+    result.msPerFrameMax = passMs.back();
+    result.megapixelsPerSec = static_cast<double>(clip.width) * clip.height / (result.msPerFrame * 1e3);
+    result.memoryBytes = interpolator->MemoryBytes();
+    result.psnr = sum.psnr / triplets;
+    result.ssim = sum.ssim / triplets;
+    result.msSsim = sum.msSsim / triplets;
+    result.gmsd = sum.gmsd / triplets;
+    result.temporalError = flicker.TemporalError();
+    result.brightnessFlicker = flicker.BrightnessFlicker();
+
+    std::vector<StageSample> samples;
+    interpolator->Profiler().Timeline().Snapshot(samples);
+    samples.erase(std::remove_if(samples.begin(), samples.end(),
+                                 [&](const StageSample& s) { return s.frame < firstFrame; }),
+                  samples.end());
+    const StageTimingSummary summary = SummarizeStages(samples, result.frames);
+    for (int s = 0; s < kPipelineStageCount; ++s) {
+        const StagePercentiles& p = summary.cpu[s];
+        if (p.count == 0) continue;
+        result.stages.push_back({PipelineStageName(static_cast<PipelineStage>(s)), p.meanSec * 1e3, p.p95Sec * 1e3});
+    }
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// JSON
+// ----------------------------------------------------------------------------
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+std::string toJson(const Clip& clip, const QualityScores& blend, const std::vector<Result>& results) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(6);
+    ss << "{\n  \"tool\": \"tmfe_bench\",\n  \"version\": 1,\n";
+    ss << "  \"pipeline\": \"cpu-reference\",\n";
+    ss << "  \"input\": {\"source\": \"" << jsonEscape(clip.source) << "\", \"width\": " << clip.width
+       << ", \"height\": " << clip.height << ", \"frames\": " << clip.FrameCount()
+       << ", \"blend_psnr\": " << blend.psnr << ", \"blend_ssim\": " << blend.ssim;
+    if (!clip.capture.empty()) ss << ", \"capture\": " << clip.capture;
+    ss << "},\n";
+    ss << "  \"configs\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        ss << "    {\"name\": \"" << r.name << "\", \"model\": " << r.model << ", \"quality\": " << r.quality
+           << ", \"minimal\": " << (r.minimal ? "true" : "false") << ", \"frames\": " << r.frames
+           << ", \"ms_per_frame\": " << r.msPerFrame << ", \"ms_per_frame_min\": " << r.msPerFrameMin
+           << ", \"ms_per_frame_max\": " << r.msPerFrameMax << ", \"megapixels_per_sec\": " << r.megapixelsPerSec
+           << ", \"memory_bytes\": " << r.memoryBytes << ", \"psnr\": " << r.psnr << ", \"ssim\": " << r.ssim << ", \"ms_ssim\": " << r.msSsim
+           << ", \"gmsd\": " << r.gmsd << ", \"temporal_error\": " << r.temporalError
+           << ", \"brightness_flicker\": " << r.brightnessFlicker << ",\n     \"stages\": {";
+        for (size_t s = 0; s < r.stages.size(); ++s) {
+            ss << (s ? ", " : "") << "\"" << r.stages[s].name << "\": {\"mean_ms\": " << r.stages[s].meanMs
+               << ", \"p95_ms\": " << r.stages[s].p95Ms << "}";
+        }
+        ss << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    ss << "  ]\n}\n";
+    return ss.str();
+}
+
+// Minimal JSON reader, enough for the reports this tool writes.
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object } type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* Find(const std::string& key) const {
+        for (const auto& m : members) {
+            if (m.first == key) return &m.second;
+        }
+        return nullptr;
+    }
+    double Number(const std::string& key, double fallback = 0.0) const {
+        const JsonValue* v = Find(key);
+        return v && v->type == Type::Number ? v->number : fallback;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : m_text(text) {}
+
+    bool Parse(JsonValue& value) {
+        return ParseValue(value) && (SkipSpace(), m_pos == m_text.size());
+    }
+
+private:
+    void SkipSpace() {
+        while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos]))) m_pos++;
+    }
+    bool Consume(char c) {
+        SkipSpace();
+        if (m_pos < m_text.size() && m_text[m_pos] == c) {
+            m_pos++;
+            return true;
+        }
+        return false;
+    }
+    bool ParseString(std::string& out) {
+        if (!Consume('"')) return false;
+        while (m_pos < m_text.size() && m_text[m_pos] != '"') {
+            if (m_text[m_pos] == '\\' && m_pos + 1 < m_text.size()) m_pos++;
+            out += m_text[m_pos++];
+        }
+        return Consume('"');
+    }
+    bool ParseValue(JsonValue& value) {
+        SkipSpace();
+        if (m_pos >= m_text.size()) return false;
+        const char c = m_text[m_pos];
+        if (c == '{') {
+            m_pos++;
+            value.type = JsonValue::Type::Object;
+            if (Consume('}')) return true;
+            do {
+                std::pair<std::string, JsonValue> member;
+                if (!ParseString(member.first) || !Consume(':') || !ParseValue(member.second)) return false;
+                value.members.push_back(std::move(member));
+            } while (Consume(','));
+            return Consume('}');
+        }
+        if (c == '[') {
+            m_pos++;
+            value.type = JsonValue::Type::Array;
+            if (Consume(']')) return true;
+            do {
+                JsonValue item;
+                if (!ParseValue(item)) return false;
+                value.items.push_back(std::move(item));
+            } while (Consume(','));
+            return Consume(']');
+        }
+        if (c == '"') {
+            value.type = JsonValue::Type::String;
+            return ParseString(value.string);
+        }
+        if (m_text.compare(m_pos, 4, "true") == 0 || m_text.compare(m_pos, 5, "false") == 0) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = c == 't';
+            m_pos += value.boolean ? 4 : 5;
+            return true;
+        }
+        if (m_text.compare(m_pos, 4, "null") == 0) {
+            m_pos += 4;
+            return true;
+        }
+        char* end = nullptr;
+        value.number = std::strtod(m_text.c_str() + m_pos, &end);
+        if (end == m_text.c_str() + m_pos) return false;
+        value.type = JsonValue::Type::Number;
+        m_pos = static_cast<size_t>(end - m_text.c_str());
+        return true;
+    }
+
+    const std::string& m_text;
+    size_t m_pos = 0;
+};
+
+// Returns the number of regressions. Time regressions are confirmed by
+// re-timing the config on clip.
+int compareBaseline(const Config& cfg, const Clip& clip, const std::vector<Result>& results, const JsonValue& baseline) {
+    const JsonValue* configs = baseline.Find("configs");
+    if (!configs || configs->type != JsonValue::Type::Array) {
+        std::cout << "Baseline has no configs" << std::endl;
+        return 1;
+    }
+    int regressions = 0;
+    std::cout << "\nBaseline comparison (every pass +" << cfg.timeThresholdPct << "% + pass range over the slowest, memory +" << cfg.memoryThresholdPct
+              << "%, PSNR -" << cfg.psnrThresholdDb << " dB, SSIM -" << std::setprecision(3) << cfg.ssimThreshold << "):" << std::endl;
+    for (const Result& r : results) {
+        const JsonValue* base = nullptr;
+        for (const JsonValue& item : configs->items) {
+            const JsonValue* name = item.Find("name");
+            if (name && name->string == r.name) base = &item;
+        }
+        if (!base) {
+            std::cout << "  " << std::left << std::setw(28) << r.name << "not in baseline" << std::endl;
+            continue;
+        }
+        std::vector<std::string> problems;
+        for (const char* key : {"ms_per_frame", "ms_per_frame_min", "ms_per_frame_max", "memory_bytes", "psnr", "ssim"}) {
+            const JsonValue* field = base->Find(key);
+            if (!field || field->type != JsonValue::Type::Number) problems.push_back(std::string("baseline has no ") + key);
+        }
+        if (!problems.empty()) {
+            regressions++;
+            std::cout << "  " << std::left << std::setw(28) << r.name << std::right << "ERROR:";
+            for (const std::string& p : problems) std::cout << " " << p << ";";
+            std::cout << std::endl;
+            continue;
+        }
+        const double baseMs = base->Number("ms_per_frame");
+        const double baseMaxMs = base->Number("ms_per_frame_max");
+        const double noiseMs = std::max(baseMaxMs - base->Number("ms_per_frame_min"), r.msPerFrameMax - r.msPerFrameMin);
+        const double baseMemory = base->Number("memory_bytes");
+        const double basePsnr = base->Number("psnr");
+        const double baseSsim = base->Number("ssim");
+        const double limitMs = baseMaxMs * (1.0 + cfg.timeThresholdPct / 100.0) + noiseMs;
+        double fastestMs = r.msPerFrameMin;
+        if (fastestMs > limitMs) {
+            const Result again = runConfig(clip, r.model, r.quality, r.minimal, cfg.warmup, cfg.repeat);
+            fastestMs = std::min(fastestMs, again.msPerFrameMin);
+        }
+        if (fastestMs > limitMs) {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(2) << "time " << baseMs << " -> " << r.msPerFrame
+               << " ms (fastest of " << 2 * cfg.repeat << " passes " << fastestMs << ", slowest baseline pass "
+               << baseMaxMs << ", noise " << noiseMs << " ms)";
+            problems.push_back(ss.str());
+        }
+        if (baseMemory > 0.0 && r.memoryBytes > baseMemory * (1.0 + cfg.memoryThresholdPct / 100.0)) {
+            problems.push_back("memory " + std::to_string(static_cast<uint64_t>(baseMemory)) + " -> " +
+                               std::to_string(r.memoryBytes) + " bytes");
+        }
+        if (r.psnr < basePsnr - cfg.psnrThresholdDb) {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(2) << "PSNR " << basePsnr << " -> " << r.psnr << " dB";
+            problems.push_back(ss.str());
+        }
+        if (r.ssim < baseSsim - cfg.ssimThreshold) {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(4) << "SSIM " << baseSsim << " -> " << r.ssim;
+            problems.push_back(ss.str());
+        }
+        std::cout << "  " << std::left << std::setw(28) << r.name << std::right;
+        if (problems.empty()) {
+            std::cout << "ok (" << std::showpos << std::fixed << std::setprecision(1)
+                      << (baseMs > 0.0 ? (r.msPerFrame / baseMs - 1.0) * 100.0 : 0.0) << "% time, "
+                      << std::setprecision(2) << r.psnr - basePsnr << " dB)" << std::noshowpos << std::endl;
+        } else {
+            regressions++;
+            std::cout << "REGRESSION:";
+            for (const std::string& p : problems) std::cout << " " << p << ";";
+            std::cout << std::endl;
+        }
+    }
+    return regressions;
+}
+
+// ----------------------------------------------------------------------------
+// GPU footprint
+// ----------------------------------------------------------------------------
+
+// Aliasing must not change results: every pass writes what it reads before
+// a later pass reads it, so outputs and final motion are identical with and
+// without shared slots, and it never costs memory.
+bool checkAliasing(const Config& cfg) {
+    Config small = cfg;
+    small.width = 256;
+    small.height = 144;
+    small.maxFrames = 4;
+    Clip clip;
+    makeSynthetic(small, clip);
+    bool ok = true;
+    for (bool minimal : {true, false}) {
+        ReferenceInterpolator aliased;
+        ReferenceInterpolator dedicated;
+        ReferenceSettings settings;
+        settings.minimalPipeline = minimal;
+        aliased.Resize(clip.width, clip.height);
+        aliased.SetSettings(settings);
+        settings.aliasTransients = false;
+        dedicated.Resize(clip.width, clip.height);
+        dedicated.SetSettings(settings);
+        clip.ForEachStep([&](const CpuFrame& a, const CpuFrame& b, const CpuFrame&) {
+            aliased.Execute(a, b, 0.5f);
+            dedicated.Execute(a, b, 0.5f);
+            ok = ok && aliased.Output() == dedicated.Output() &&
+                 aliased.ForwardMotion().xy == dedicated.ForwardMotion().xy &&
+                 aliased.BackwardMotion().xy == dedicated.BackwardMotion().xy;
+        });
+        ok = ok && aliased.MemoryBytes() <= dedicated.MemoryBytes();
+    }
+    return ok;
+}
+
+// The D3D11/Vulkan Interpolator cannot run here, but its allocations are a
+// function of the resolution: plan them from the resource table.
+int reportMemory(const Config& cfg) {
+    constexpr int kMotionCacheSlots = 3;    // Interpolator motion LRU depth
+    struct Plan {
+        const char* name;
+        bool minimal;
+        bool vulkan;
+    };
+    const Plan plans[] = {{"minimal", true, false}, {"full", false, false}, {"full + Vulkan", false, true}};
+    // The D3D11 working set is allocated in resolution buckets (see
+    // ResolutionBucketPool); the Vulkan path keeps exact sizes.
+    const int granularity = ResolutionBucketPolicy().granularity;
+    auto allocatedSize = [&](const Plan& plan, int& w, int& h) {
+        w = BucketExtent(cfg.memoryWidth, plan.vulkan ? 1 : granularity);
+        h = BucketExtent(cfg.memoryHeight, plan.vulkan ? 1 : granularity);
+    };
+    std::vector<std::string> details;
+    std::cout << "GPU resources at " << cfg.memoryWidth << "x" << cfg.memoryHeight << " (output at input size, "
+              << kMotionCacheSlots << " motion cache slots, D3D11 working set in " << granularity << " px buckets: "
+              << BucketExtent(cfg.memoryWidth, granularity) << "x" << BucketExtent(cfg.memoryHeight, granularity)
+              << ")" << std::endl;
+    std::cout << std::left << std::setw(16) << "pipeline" << std::right << std::setw(10) << "textures" << std::setw(10)
+              << "MiB" << std::setw(12) << "unused" << std::setw(12) << "transient" << std::endl;
+    for (const Plan& plan : plans) {
+        int allocWidth = 0, allocHeight = 0;
+        allocatedSize(plan, allocWidth, allocHeight);
+        ResourceRegistry registry;
+        PlanInterpolatorResources(allocWidth, allocHeight, cfg.memoryWidth, cfg.memoryHeight, plan.minimal,
+                                  plan.vulkan, kMotionCacheSlots, registry);
+        const ResourceFootprint f = registry.Footprint();
+        std::cout << std::left << std::setw(16) << plan.name << std::right << std::setw(10) << f.resources
+                  << std::fixed << std::setprecision(2) << std::setw(10) << f.totalBytes / (1024.0 * 1024.0)
+                  << std::setw(12) << f.unusedBytes / (1024.0 * 1024.0) << std::setw(12)
+                  << f.transientBytes / (1024.0 * 1024.0) << std::endl;
+        if (!plan.vulkan) {
+            details.push_back(FormatResourceReport(registry));
+        }
+    }
+
+    // Per-frame working set of each graph, with every resource in its own
+    // memory and with transients aliased. GPU rows are at the allocated
+    // size; the CPU rows are the reference interpolator's float planes at
+    // the exact input size.
+    std::cout << std::endl << "Frame graph peaks at " << cfg.memoryWidth << "x" << cfg.memoryHeight << std::endl;
+    std::cout << std::left << std::setw(22) << "graph" << std::right << std::setw(8) << "passes" << std::setw(10)
+              << "barriers" << std::setw(8) << "slots" << std::setw(12) << "before MiB" << std::setw(11)
+              << "after MiB" << std::setw(10) << "saved" << std::endl;
+    auto printGraph = [](const char* name, const FrameGraph& graph) {
+        const FrameGraphMemory m = graph.Memory();
+        const double saved = m.dedicatedBytes ? 100.0 * (m.dedicatedBytes - m.aliasedBytes) / m.dedicatedBytes : 0.0;
+        std::cout << std::left << std::setw(22) << name << std::right << std::setw(8) << graph.Passes().size()
+                  << std::setw(10) << m.barriers << std::setw(8) << m.slots << std::fixed << std::setprecision(2)
+                  << std::setw(12) << m.dedicatedBytes / (1024.0 * 1024.0) << std::setw(11)
+                  << m.aliasedBytes / (1024.0 * 1024.0) << std::setw(9) << saved << "%" << std::endl;
+    };
+    bool ok = true;
+    std::string fullGraph;
+    for (const Plan& plan : plans) {
+        int allocWidth = 0, allocHeight = 0;
+        allocatedSize(plan, allocWidth, allocHeight);
+        FrameGraph graph;
+        if (!PlanInterpolatorFrameGraph(allocWidth, allocHeight, cfg.memoryWidth, cfg.memoryHeight,
+                                        plan.minimal, plan.vulkan, graph)) {
+            std::cerr << plan.name << ": frame graph does not compile: " << graph.GetLastError() << std::endl;
+            ok = false;
+            continue;
+        }
+        printGraph((std::string("gpu ") + plan.name).c_str(), graph);
+        if (!plan.minimal && !plan.vulkan) {
+            fullGraph = FormatFrameGraphReport(graph);
+        }
+    }
+    for (bool minimal : {true, false}) {
+        ReferenceInterpolator interpolator;
+        ReferenceSettings settings;
+        settings.minimalPipeline = minimal;
+        interpolator.SetSettings(settings);
+        if (!interpolator.Resize(cfg.memoryWidth, cfg.memoryHeight) || !interpolator.Graph().Compiled()) {
+            ok = false;
+            continue;
+        }
+        printGraph(minimal ? "cpu minimal" : "cpu full", interpolator.Graph());
+    }
+
+    for (const std::string& detail : details) {
+        std::cout << std::endl << detail;
+    }
+    std::cout << std::endl << "Full pipeline " << fullGraph;
+
+    const bool aliasingOk = checkAliasing(cfg);
+    std::cout << std::endl << "aliasing check: " << (aliasingOk ? "identical output" : "OUTPUT DIFFERS") << std::endl;
+    ok = ok && aliasingOk;
+    std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--session" && i+1 < argc) cfg.session = argv[++i];
+        else if (arg == "--images" && i+1 < argc) cfg.imageDir = argv[++i];
+        else if (arg == "--scenario" && i+1 < argc) cfg.scenario = argv[++i];
+#ifdef TFE_HAVE_X11
+        else if (arg == "--x11" && i+1 < argc) cfg.x11Display = argv[++i];
+#endif
+        else if (arg == "--seed" && i+1 < argc) cfg.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--size" && i+1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &cfg.width, &cfg.height) != 2 || cfg.width < 64 || cfg.height < 64) {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--frames" && i+1 < argc) cfg.maxFrames = std::max(3, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && i+1 < argc) cfg.warmup = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--repeat" && i+1 < argc) cfg.repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--models" && i+1 < argc) cfg.models = parseList(argv[++i]);
+        else if (arg == "--quality" && i+1 < argc) cfg.qualities = parseList(argv[++i]);
+        else if (arg == "--pipeline" && i+1 < argc) cfg.pipelines = parseList(argv[++i], {{"minimal", 1}, {"full", 0}});
+        else if (arg == "--json" && i+1 < argc) cfg.jsonPath = argv[++i];
+        else if (arg == "--baseline" && i+1 < argc) cfg.baselinePath = argv[++i];
+        else if (arg == "--time-threshold" && i+1 < argc) cfg.timeThresholdPct = std::atof(argv[++i]);
+        else if (arg == "--memory-threshold" && i+1 < argc) cfg.memoryThresholdPct = std::atof(argv[++i]);
+        else if (arg == "--psnr-threshold" && i+1 < argc) cfg.psnrThresholdDb = std::atof(argv[++i]);
+        else if (arg == "--ssim-threshold" && i+1 < argc) cfg.ssimThreshold = std::atof(argv[++i]);
+        else if (arg == "--report-memory" && i+1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &cfg.memoryWidth, &cfg.memoryHeight) != 2 || cfg.memoryWidth < 16 ||
+                cfg.memoryHeight < 16 || cfg.memoryWidth > 16384 || cfg.memoryHeight > 16384) {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    if (cfg.memoryWidth > 0) {
+        return reportMemory(cfg);
+    }
+
+    Clip clip;
+    std::string error;
+    if (!cfg.session.empty()) {
+        if (!loadSession(cfg, clip, error)) { std::cout << "Error: " << error << std::endl; return 1; }
+    } else if (!cfg.imageDir.empty()) {
+        if (!loadImages(cfg, clip, error)) { std::cout << "Error: " << error << std::endl; return 1; }
+    } else if (!cfg.scenario.empty()) {
+        if (!loadScenario(cfg, clip, error)) { std::cout << "Error: " << error << std::endl; return 1; }
+    } else {
+        makeSynthetic(cfg, clip);
+    }
+    if (clip.FrameCount() < 3 || clip.width < 16 || clip.height < 16) {
+        std::cout << "Error: need at least 3 frames of 16x16 or more" << std::endl;
+        return 1;
+    }
+#ifdef TFE_HAVE_X11
+    if (!cfg.x11Display.empty()) {
+        if (clip.generator) {
+            std::cout << "Error: --x11 needs loaded frames, not a streamed --scenario" << std::endl;
+            return 1;
+        }
+        if (!captureThroughX11(cfg, clip, error)) { std::cout << "Error: " << error << std::endl; return 1; }
+    }
+#endif
+
+    // Plain 50/50 blend: the floor any motion-compensated result should beat.
+    QualityScores blendScores;
+    {
+        Clip blend;
+        blend.width = clip.width;
+        blend.height = clip.height;
+        blend.frames.emplace_back(static_cast<size_t>(clip.width) * clip.height * 4);
+        const size_t triplets = clip.Steps();
+        clip.ForEachStep([&](const CpuFrame& a, const CpuFrame& b, const CpuFrame& truth) {
+            for (size_t p = 0; p < blend.frames[0].size(); ++p) {
+                blend.frames[0][p] = static_cast<uint8_t>((a.data[p] + b.data[p] + 1) / 2);
+            }
+            QualityScores scores;
+            MeasureQuality(blend.Frame(0), truth, scores);
+            blendScores.psnr += scores.psnr / triplets;
+            blendScores.ssim += scores.ssim / triplets;
+        });
+    }
+
+    std::cout << "Pipeline: CPU reference model (ReferenceInterpolator), not the shipped D3D11 / Vulkan shaders;\n"
+              << "          no parity check against the HLSL, compare runs with each other only" << std::endl;
+    std::cout << "Timing: " << cfg.warmup << " warm-up + " << cfg.repeat << " timed pass(es) per config, median ms/frame"
+              << std::endl;
+    std::cout << "Input: " << clip.source << " " << clip.width << "x" << clip.height << ", " << clip.FrameCount()
+              << " frames (blend PSNR " << std::fixed << std::setprecision(2) << blendScores.psnr << " dB, SSIM "
+              << std::setprecision(4) << blendScores.ssim << ")" << std::endl;
+    std::cout << std::left << std::setw(28) << "config" << std::right << std::setw(10) << "ms/frame" << std::setw(10)
+              << "MP/s" << std::setw(10) << "MiB" << std::setw(10) << "PSNR" << std::setw(10) << "SSIM"
+              << std::setw(10) << "flicker" << std::setw(10) << "spread" << std::endl;
+
+    std::vector<Result> results;
+    for (int pipeline : cfg.pipelines) {
+        for (int quality : cfg.qualities) {
+            for (int model : cfg.models) {
+                if (model < 0 || model >= kMotionModelCount) continue;
+                Result r = runConfig(clip, model, quality, pipeline != 0, cfg.warmup, cfg.repeat);
+                std::cout << std::left << std::setw(28) << r.name << std::right << std::setprecision(2)
+                          << std::setw(10) << r.msPerFrame << std::setw(10) << r.megapixelsPerSec << std::setw(10)
+                          << r.memoryBytes / (1024.0 * 1024.0) << std::setw(10) << r.psnr << std::setprecision(4)
+                          << std::setw(10) << r.ssim << std::setprecision(2) << std::setw(10) << r.temporalError
+                          << std::setprecision(1) << std::setw(9)
+                          << (r.msPerFrameMax - r.msPerFrameMin) / r.msPerFrame * 100.0 << "%" << std::endl;
+                results.push_back(std::move(r));
+            }
+        }
+    }
+    if (results.empty()) {
+        std::cout << "Error: empty sweep" << std::endl;
+        return 1;
+    }
+
+    const std::string json = toJson(clip, blendScores, results);
+    {
+        std::ofstream out(cfg.jsonPath);
+        out << json;
+        if (!out) {
+            std::cout << "Error: cannot write " << cfg.jsonPath << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Report: " << cfg.jsonPath << std::endl;
+
+    if (!cfg.baselinePath.empty()) {
+        std::ifstream in(cfg.baselinePath);
+        std::stringstream text;
+        text << in.rdbuf();
+        JsonValue baseline;
+        if (!in.is_open() || !JsonParser(text.str()).Parse(baseline)) {
+            std::cout << "Error: cannot read baseline " << cfg.baselinePath << std::endl;
+            return 1;
+        }
+        const int regressions = compareBaseline(cfg, clip, results, baseline);
+        std::cout << (regressions == 0 ? "PASS" : "FAIL: " + std::to_string(regressions) + " regression(s)")
+                  << std::endl;
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
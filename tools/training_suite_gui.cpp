@@ -20,6 +20,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include "quality_metrics.h"
+
 #pragma comment(lib, "shlwapi.lib")
 #pragma comment(lib, "comdlg32.lib")
 #pragma comment(lib, "shell32.lib")
@@ -317,6 +319,288 @@ void initWeights(Weights& w) {
         p[i] += ((float)(rand() % 200 - 100) / 10000.0f);
 }
 
+// One decode per frame: the RGBA pixels feed the quality scoring and the
+// grayscale plane (stb_image's own RGB->Y weights) feeds feature extraction.
+struct DecodedImage {
+    unsigned char* rgba = nullptr;
+    std::vector<unsigned char> gray;
+    int w = 0, h = 0;
+
+    DecodedImage() = default;
+    DecodedImage(const DecodedImage&) = delete;
+    DecodedImage& operator=(const DecodedImage&) = delete;
+    ~DecodedImage() { if (rgba) stbi_image_free(rgba); }
+
+    bool load(const std::string& path) {
+        int channels = 0;
+        rgba = stbi_load(path.c_str(), &w, &h, &channels, 4);
+        if (!rgba) return false;
+        gray.resize((size_t)w * h);
+        for (size_t i = 0; i < gray.size(); i++) {
+            const unsigned char* px = rgba + i * 4;
+            gray[i] = (unsigned char)((px[0] * 77 + px[1] * 150 + px[2] * 29) >> 8);
+        }
+        return true;
+    }
+};
+
+// Per-triplet training data plus the block-matched motion of each cell,
+// which renderPrediction() needs to rebuild the middle frame.
+struct TripletAnalysis {
+    std::vector<float> feat = std::vector<float>(12, 0.0f);
+    std::vector<float> tgt = std::vector<float>(12, 0.0f);
+    std::array<float, 4> motion = {0, 0, 0, 0.5f};
+    int cellDx[12] = {};
+    int cellDy[12] = {};
+};
+
+// Feature & target extraction with motion awareness on the grayscale planes
+void analyzeTriplet(const unsigned char* img1, const unsigned char* img2, const unsigned char* img3,
+                    const unsigned char* gt_img, int w, int h, TripletAnalysis& out) {
+    
+    int cellW = w / 4;
+    int cellH = h / 3;
+    
+    // Per-cell: block matching + warp error + motion targets
+    float globalWarpErr = 0, globalBlendErr = 0;
+    int globalCount = 0;
+    float globalResX = 0, globalResY = 0;
+    int occludedCells = 0;
+    
+    for (int cy = 0; cy < 3; cy++) {
+        for (int cx = 0; cx < 4; cx++) {
+            int cellIdx = cy * 4 + cx;
+            int y0 = cy * cellH, y1 = std::min((cy + 1) * cellH, h);
+            int x0 = cx * cellW, x1 = std::min((cx + 1) * cellW, w);
+            
+            // --- Gradient energy feature (matches shader CNN features) ---
+            float diffSum = 0;
+            int diffCount = 0;
+            for (int y = y0; y < y1; y += 4) {
+                for (int x = x0; x < x1; x += 4) {
+                    int idx = y * w + x;
+                    float d1 = std::abs((float)img2[idx] - (float)img1[idx]);
+                    float d2 = std::abs((float)img3[idx] - (float)img2[idx]);
+                    diffSum += (d1 + d2) / 2.0f;
+                    diffCount++;
+                }
+            }
+            out.feat[cellIdx] = (diffCount > 0) ? (diffSum / diffCount) / 255.0f : 0.0f;
+            
+            // --- Block matching: find best integer motion from img1->img3 in this cell ---
+            // Search ±8 pixels, measure SAD in cell center region
+            const int searchR = 8;
+            int bestDx = 0, bestDy = 0;
+            float bestSAD = 1e30f;
+            int patchY0 = y0 + cellH / 4, patchY1 = y1 - cellH / 4;
+            int patchX0 = x0 + cellW / 4, patchX1 = x1 - cellW / 4;
+            if (patchY0 >= patchY1) { patchY0 = y0; patchY1 = y1; }
+            if (patchX0 >= patchX1) { patchX0 = x0; patchX1 = x1; }
+            
+            for (int dy = -searchR; dy <= searchR; dy += 2) {
+                for (int dx = -searchR; dx <= searchR; dx += 2) {
+                    float sad = 0;
+                    int cnt = 0;
+                    for (int y = patchY0; y < patchY1; y += 4) {
+                        for (int x = patchX0; x < patchX1; x += 4) {
+                            int sx = std::clamp(x + dx, 0, w - 1);
+                            int sy = std::clamp(y + dy, 0, h - 1);
+                            sad += std::abs((float)img1[sy * w + sx] - (float)img3[y * w + x]);
+                            cnt++;
+                        }
+                    }
+                    if (cnt > 0) sad /= cnt;
+                    if (sad < bestSAD) { bestSAD = sad; bestDx = dx; bestDy = dy; }
+                }
+            }
+            // Refine to ±1 around best coarse
+            int coarseDx = bestDx, coarseDy = bestDy;
+            for (int dy = coarseDy - 1; dy <= coarseDy + 1; dy++) {
+                for (int dx = coarseDx - 1; dx <= coarseDx + 1; dx++) {
+                    float sad = 0;
+                    int cnt = 0;
+                    for (int y = patchY0; y < patchY1; y += 4) {
+                        for (int x = patchX0; x < patchX1; x += 4) {
+                            int sx = std::clamp(x + dx, 0, w - 1);
+                            int sy = std::clamp(y + dy, 0, h - 1);
+                            sad += std::abs((float)img1[sy * w + sx] - (float)img3[y * w + x]);
+                            cnt++;
+                        }
+                    }
+                    if (cnt > 0) sad /= cnt;
+                    if (sad < bestSAD) { bestSAD = sad; bestDx = dx; bestDy = dy; }
+                }
+            }
+            
+            // --- Warp img1 by half-motion toward img2 time, compute warp error vs GT ---
+            float halfDx = bestDx * 0.5f, halfDy = bestDy * 0.5f;
+            out.cellDx[cellIdx] = bestDx;
+            out.cellDy[cellIdx] = bestDy;
+            float warpErr = 0, blendErr = 0;
+            float residualAccX = 0, residualAccY = 0;
+            int warpCount = 0;
+            
+            for (int y = y0; y < y1; y += 4) {
+                for (int x = x0; x < x1; x += 4) {
+                    // Warped pixel from img1
+                    int wx = std::clamp((int)(x + halfDx + 0.5f), 0, w - 1);
+                    int wy = std::clamp((int)(y + halfDy + 0.5f), 0, h - 1);
+                    float warped = (float)img1[wy * w + wx];
+                    float gt = (float)gt_img[y * w + x];
+                    float blended = ((float)img1[y * w + x] + (float)img3[y * w + x]) * 0.5f;
+                    
+                    warpErr += std::abs(warped - gt);
+                    blendErr += std::abs(blended - gt);
+                    
+                    // Compute gradient of warp error w.r.t. motion (finite diff)
+                    // Which direction should we shift to reduce |warped - gt|?
+                    int wxP = std::clamp(wx + 1, 0, w - 1);
+                    int wxM = std::clamp(wx - 1, 0, w - 1);
+                    int wyP = std::clamp(wy + 1, 0, h - 1);
+                    int wyM = std::clamp(wy - 1, 0, h - 1);
+                    float errXp = std::abs((float)img1[wy * w + wxP] - gt);
+                    float errXm = std::abs((float)img1[wy * w + wxM] - gt);
+                    float errYp = std::abs((float)img1[wyP * w + wx] - gt);
+                    float errYm = std::abs((float)img1[wyM * w + wx] - gt);
+                    // Negative gradient direction = correction that reduces error
+                    residualAccX += (errXm - errXp) * 0.5f;
+                    residualAccY += (errYm - errYp) * 0.5f;
+                    warpCount++;
+                }
+            }
+            
+            if (warpCount > 0) {
+                warpErr /= warpCount;
+                blendErr /= warpCount;
+                residualAccX /= warpCount;
+                residualAccY /= warpCount;
+            }
+            
+            // Target = how much this cell needs attention (warp error as importance)
+            out.tgt[cellIdx] = warpErr / 255.0f;
+            
+            // Accumulate global motion stats
+            globalWarpErr += warpErr;
+            globalBlendErr += blendErr;
+            globalCount++;
+            // Accumulate residual direction (normalize to ±0.5 sub-pixel range)
+            float resScale = 0.5f / (255.0f + 1e-6f);
+            globalResX += residualAccX * resScale;
+            globalResY += residualAccY * resScale;
+            // Cell is "occluded" if warp error is much worse than blend error (MV is wrong)
+            if (warpErr > blendErr * 1.5f && warpErr > 10.0f) occludedCells++;
+        }
+    }
+
+    // === Motion-aware targets for IFNet-Lite (residual, occlusion, quality) ===
+    std::array<float, 4>& mt = out.motion;
+    mt = {0, 0, 0, 0.5f};
+    if (globalCount > 0) {
+        // Average residual correction (clamped to \u00b10.5 sub-pixel range)
+        mt[0] = std::clamp(globalResX / globalCount, -0.5f, 0.5f);
+        mt[1] = std::clamp(globalResY / globalCount, -0.5f, 0.5f);
+        mt[2] = (float)occludedCells / (float)globalCount;
+        // Quality = how much warping improves over simple blending (0=bad, 1=perfect)
+        float avgWarpErr = globalWarpErr / globalCount;
+        float avgBlendErr = globalBlendErr / globalCount;
+        mt[3] = std::clamp(1.0f - avgWarpErr / (avgBlendErr + 1.0f), 0.0f, 1.0f);
+    }
+}
+
+// CPU stand-in for the shader's warp + synthesis, driven by the model outputs:
+// per-cell motion halved toward the middle frame plus the IFNet residual,
+// FusionNet's occlusion select between the two warps, and the quality output
+// falling back to the plain blend where warping is unreliable.
+void renderPrediction(const Weights& weights, const TripletAnalysis& a, const unsigned char* prev,
+                      const unsigned char* curr, int w, int h, std::vector<unsigned char>& out) {
+    float motRes[2], occ, qual, synth[4];
+    forwardExtra(weights, a.feat.data(), motRes, &occ, &qual);
+    synthForward(weights, a.feat.data(), synth);
+    float currWeight = synth[0]; // trained toward 0.5 + 0.4 * occlusion
+
+    auto sample = [&](const unsigned char* img, float x, float y, int c) {
+        x = std::clamp(x, 0.0f, (float)(w - 1));
+        y = std::clamp(y, 0.0f, (float)(h - 1));
+        int x0 = (int)x, y0 = (int)y;
+        int x1 = std::min(x0 + 1, w - 1), y1 = std::min(y0 + 1, h - 1);
+        float fx = x - x0, fy = y - y0;
+        float top = img[((size_t)y0 * w + x0) * 4 + c] * (1 - fx) + img[((size_t)y0 * w + x1) * 4 + c] * fx;
+        float bottom = img[((size_t)y1 * w + x0) * 4 + c] * (1 - fx) + img[((size_t)y1 * w + x1) * 4 + c] * fx;
+        return top * (1 - fy) + bottom * fy;
+    };
+
+    out.resize((size_t)w * h * 4);
+    int cellW = std::max(1, w / 4), cellH = std::max(1, h / 3);
+    for (int y = 0; y < h; y++) {
+        int cy = std::min(y / cellH, 2);
+        for (int x = 0; x < w; x++) {
+            int cell = cy * 4 + std::min(x / cellW, 3);
+            float dx = a.cellDx[cell] * 0.5f + motRes[0];
+            float dy = a.cellDy[cell] * 0.5f + motRes[1];
+            size_t idx = ((size_t)y * w + x) * 4;
+            for (int c = 0; c < 4; c++) {
+                float warped = sample(prev, x + dx, y + dy, c) * (1 - currWeight) +
+                               sample(curr, x - dx, y - dy, c) * currWeight;
+                float blend = (prev[idx + c] + curr[idx + c]) * 0.5f;
+                out[idx + c] = (unsigned char)std::clamp(blend + (warped - blend) * qual + 0.5f, 0.0f, 255.0f);
+            }
+        }
+    }
+}
+
+// Full-resolution scores of one kind of interpolated frame against the
+// held-out middle frames. FlickerMeter compares consecutive frames, so it
+// restarts at every break in the sequence and the runs are pooled by their
+// frame pairs.
+struct HeldOutScore {
+    QualityScores sum;
+    int count = 0;
+    FlickerMeter flicker;
+    double flickerSum = 0.0;
+    int flickerPairs = 0;
+
+    void newSequence() {
+        if (flicker.Frames() > 1) {
+            flickerSum += flicker.TemporalError() * (flicker.Frames() - 1);
+            flickerPairs += flicker.Frames() - 1;
+        }
+        flicker.Reset();
+    }
+
+    void add(const unsigned char* test, const unsigned char* reference, int w, int h) {
+        CpuFrame testFrame;
+        testFrame.data = test;
+        testFrame.pitch = (size_t)w * 4;
+        testFrame.width = w;
+        testFrame.height = h;
+        testFrame.format = PixelFormat::Rgba8;
+        CpuFrame truth = testFrame;
+        truth.data = reference;
+        QualityScores scores;
+        if (!MeasureQuality(testFrame, truth, scores)) return;
+        sum.psnr += scores.psnr;
+        sum.ssim += scores.ssim;
+        sum.msSsim += scores.msSsim;
+        sum.gmsd += scores.gmsd;
+        flicker.Add(testFrame, truth);
+        count++;
+    }
+
+    void report(const char* label) {
+        newSequence();
+        if (count == 0) return;
+        char flickerText[32] = "n/a";
+        if (flickerPairs > 0) snprintf(flickerText, sizeof(flickerText), "%.2f", flickerSum / flickerPairs);
+        char line[256];
+        snprintf(line, sizeof(line),
+                 "Held-out middle frames, %s (%d, full res): PSNR %.2f dB, SSIM %.4f, MS-SSIM %.4f, "
+                 "GMSD %.4f, flicker %s",
+                 label, count, sum.psnr / count, sum.ssim / count, sum.msSsim / count, sum.gmsd / count,
+                 flickerText);
+        log(line);
+    }
+};
+
 void cleanStaticImages(std::vector<std::string>& images) {
     if (images.size() < 3) return;
     std::vector<std::string> cleaned;
@@ -400,6 +684,7 @@ void trainModel(HWND hwnd) {
         std::string img2_path; // original middle frame
         std::string img3_path;
         std::string gt_path;
+        size_t index;          // position of img1 in the frame list
     };
     std::vector<TripletInfo> triplets;
     {
@@ -409,6 +694,7 @@ void trainModel(HWND hwnd) {
             t.img1_path = images[i];
             t.img2_path = images[i + g_cfg.stride];
             t.img3_path = images[i + 2 * g_cfg.stride];
+            t.index     = i;
             t.gt_path   = g_cfg.outputFolder + "\\ground_truth\\gt_" + std::to_string(count) + ".jpg";
             triplets.push_back(t);
         }
@@ -463,191 +749,57 @@ void trainModel(HWND hwnd) {
 
     // Motion-aware targets for IFNet-Lite training: [residualX, residualY, occlusion, quality]
     std::vector<std::array<float, 4>> motionTargets;
+
+    // The last tenth of the triplets stays out of training and is scored once
+    // the weights are final.
+    int heldOutTriplets = numTriplets >= 10 ? numTriplets / 10 : 0;
+    int trainTriplets = numTriplets - heldOutTriplets;
+
+    // Decodes every frame of a triplet once. Without RIFE the ground truth is
+    // the original middle frame, so it shares that decode.
+    auto loadTriplet = [&](const TripletInfo& t, DecodedImage& img1, DecodedImage& img2, DecodedImage& img3,
+                           DecodedImage& gtImg) -> const DecodedImage* {
+        auto load = [&](DecodedImage& img, const std::string& path, const char* name) {
+            if (img.load(path)) return true;
+            log(std::string("Failed to load ") + name + ": " + path + " Reason: " + (stbi_failure_reason() ? stbi_failure_reason() : "Unknown"));
+            return false;
+        };
+        bool ok = load(img1, t.img1_path, "img1");
+        ok = load(img2, t.img2_path, "img2") && ok;
+        ok = load(img3, t.img3_path, "img3") && ok;
+        const DecodedImage* gt = &img2;
+        if (g_cfg.useRIFE) {
+            ok = load(gtImg, t.gt_path, "gt_img") && ok;
+            gt = &gtImg;
+        }
+        if (!ok) return nullptr;
+        if (img1.w != img2.w || img1.w != img3.w || img1.w != gt->w ||
+            img1.h != img2.h || img1.h != img3.h || img1.h != gt->h) {
+            log("Skipping triplet with mismatched frame sizes: " + t.img1_path);
+            return nullptr;
+        }
+        return gt;
+    };
     
     int processed = 0;
-    for (int ti = 0; ti < numTriplets && g_training; ti++) {
+    for (int ti = 0; ti < trainTriplets && g_training; ti++) {
         auto& t = triplets[ti];
 
-        unsigned char* gt_img = nullptr;
-        int w, h, channels;
-        
-        if (g_cfg.useRIFE) {
-            gt_img = stbi_load(t.gt_path.c_str(), &w, &h, &channels, 1); // RIFE generated frame
-        } else {
-            log("Using original middle frame as Ground Truth " + std::to_string(ti + 1) + "/" + std::to_string(numTriplets) + "...");
-            gt_img = stbi_load(t.img2_path.c_str(), &w, &h, &channels, 1); // Original middle frame
+        if (!g_cfg.useRIFE) {
+            log("Using original middle frame as Ground Truth " + std::to_string(ti + 1) + "/" + std::to_string(trainTriplets) + "...");
         }
-        
-        unsigned char* img1 = stbi_load(t.img1_path.c_str(), &w, &h, &channels, 1); // Load as grayscale
-        unsigned char* img2 = stbi_load(t.img2_path.c_str(), &w, &h, &channels, 1); // Original middle frame
-        unsigned char* img3 = stbi_load(t.img3_path.c_str(), &w, &h, &channels, 1);
-        
-        if (!img1) log("Failed to load img1: " + t.img1_path + " Reason: " + (stbi_failure_reason() ? stbi_failure_reason() : "Unknown"));
-        if (!img2) log("Failed to load img2: " + t.img2_path + " Reason: " + (stbi_failure_reason() ? stbi_failure_reason() : "Unknown"));
-        if (!img3) log("Failed to load img3: " + t.img3_path + " Reason: " + (stbi_failure_reason() ? stbi_failure_reason() : "Unknown"));
-        if (!gt_img) log("Failed to load gt_img: " + t.gt_path + " Reason: " + (stbi_failure_reason() ? stbi_failure_reason() : "Unknown"));
-
-        if (img1 && img2 && img3 && gt_img) {
-            // === Feature & Target Extraction with Motion Awareness ===
-            std::vector<float> feat(12, 0.0f);
-            std::vector<float> tgt(12, 0.0f);
-            
-            int cellW = w / 4;
-            int cellH = h / 3;
-            
-            // Per-cell: block matching + warp error + motion targets
-            float globalWarpErr = 0, globalBlendErr = 0;
-            int globalCount = 0;
-            float globalResX = 0, globalResY = 0;
-            int occludedCells = 0;
-            
-            for (int cy = 0; cy < 3; cy++) {
-                for (int cx = 0; cx < 4; cx++) {
-                    int cellIdx = cy * 4 + cx;
-                    int y0 = cy * cellH, y1 = std::min((cy + 1) * cellH, h);
-                    int x0 = cx * cellW, x1 = std::min((cx + 1) * cellW, w);
-                    
-                    // --- Gradient energy feature (matches shader CNN features) ---
-                    float diffSum = 0;
-                    int diffCount = 0;
-                    for (int y = y0; y < y1; y += 4) {
-                        for (int x = x0; x < x1; x += 4) {
-                            int idx = y * w + x;
-                            float d1 = std::abs((float)img2[idx] - (float)img1[idx]);
-                            float d2 = std::abs((float)img3[idx] - (float)img2[idx]);
-                            diffSum += (d1 + d2) / 2.0f;
-                            diffCount++;
-                        }
-                    }
-                    feat[cellIdx] = (diffCount > 0) ? (diffSum / diffCount) / 255.0f : 0.0f;
-                    
-                    // --- Block matching: find best integer motion from img1->img3 in this cell ---
-                    // Search ±8 pixels, measure SAD in cell center region
-                    const int searchR = 8;
-                    int bestDx = 0, bestDy = 0;
-                    float bestSAD = 1e30f;
-                    int patchY0 = y0 + cellH / 4, patchY1 = y1 - cellH / 4;
-                    int patchX0 = x0 + cellW / 4, patchX1 = x1 - cellW / 4;
-                    if (patchY0 >= patchY1) { patchY0 = y0; patchY1 = y1; }
-                    if (patchX0 >= patchX1) { patchX0 = x0; patchX1 = x1; }
-                    
-                    for (int dy = -searchR; dy <= searchR; dy += 2) {
-                        for (int dx = -searchR; dx <= searchR; dx += 2) {
-                            float sad = 0;
-                            int cnt = 0;
-                            for (int y = patchY0; y < patchY1; y += 4) {
-                                for (int x = patchX0; x < patchX1; x += 4) {
-                                    int sx = std::clamp(x + dx, 0, w - 1);
-                                    int sy = std::clamp(y + dy, 0, h - 1);
-                                    sad += std::abs((float)img1[sy * w + sx] - (float)img3[y * w + x]);
-                                    cnt++;
-                                }
-                            }
-                            if (cnt > 0) sad /= cnt;
-                            if (sad < bestSAD) { bestSAD = sad; bestDx = dx; bestDy = dy; }
-                        }
-                    }
-                    // Refine to ±1 around best coarse
-                    int coarseDx = bestDx, coarseDy = bestDy;
-                    for (int dy = coarseDy - 1; dy <= coarseDy + 1; dy++) {
-                        for (int dx = coarseDx - 1; dx <= coarseDx + 1; dx++) {
-                            float sad = 0;
-                            int cnt = 0;
-                            for (int y = patchY0; y < patchY1; y += 4) {
-                                for (int x = patchX0; x < patchX1; x += 4) {
-                                    int sx = std::clamp(x + dx, 0, w - 1);
-                                    int sy = std::clamp(y + dy, 0, h - 1);
-                                    sad += std::abs((float)img1[sy * w + sx] - (float)img3[y * w + x]);
-                                    cnt++;
-                                }
-                            }
-                            if (cnt > 0) sad /= cnt;
-                            if (sad < bestSAD) { bestSAD = sad; bestDx = dx; bestDy = dy; }
-                        }
-                    }
-                    
-                    // --- Warp img1 by half-motion toward img2 time, compute warp error vs GT ---
-                    float halfDx = bestDx * 0.5f, halfDy = bestDy * 0.5f;
-                    float warpErr = 0, blendErr = 0;
-                    float residualAccX = 0, residualAccY = 0;
-                    int warpCount = 0;
-                    
-                    for (int y = y0; y < y1; y += 4) {
-                        for (int x = x0; x < x1; x += 4) {
-                            // Warped pixel from img1
-                            int wx = std::clamp((int)(x + halfDx + 0.5f), 0, w - 1);
-                            int wy = std::clamp((int)(y + halfDy + 0.5f), 0, h - 1);
-                            float warped = (float)img1[wy * w + wx];
-                            float gt = (float)gt_img[y * w + x];
-                            float blended = ((float)img1[y * w + x] + (float)img3[y * w + x]) * 0.5f;
-                            
-                            warpErr += std::abs(warped - gt);
-                            blendErr += std::abs(blended - gt);
-                            
-                            // Compute gradient of warp error w.r.t. motion (finite diff)
-                            // Which direction should we shift to reduce |warped - gt|?
-                            int wxP = std::clamp(wx + 1, 0, w - 1);
-                            int wxM = std::clamp(wx - 1, 0, w - 1);
-                            int wyP = std::clamp(wy + 1, 0, h - 1);
-                            int wyM = std::clamp(wy - 1, 0, h - 1);
-                            float errXp = std::abs((float)img1[wy * w + wxP] - gt);
-                            float errXm = std::abs((float)img1[wy * w + wxM] - gt);
-                            float errYp = std::abs((float)img1[wyP * w + wx] - gt);
-                            float errYm = std::abs((float)img1[wyM * w + wx] - gt);
-                            // Negative gradient direction = correction that reduces error
-                            residualAccX += (errXm - errXp) * 0.5f;
-                            residualAccY += (errYm - errYp) * 0.5f;
-                            warpCount++;
-                        }
-                    }
-                    
-                    if (warpCount > 0) {
-                        warpErr /= warpCount;
-                        blendErr /= warpCount;
-                        residualAccX /= warpCount;
-                        residualAccY /= warpCount;
-                    }
-                    
-                    // Target = how much this cell needs attention (warp error as importance)
-                    tgt[cellIdx] = warpErr / 255.0f;
-                    
-                    // Accumulate global motion stats
-                    globalWarpErr += warpErr;
-                    globalBlendErr += blendErr;
-                    globalCount++;
-                    // Accumulate residual direction (normalize to ±0.5 sub-pixel range)
-                    float resScale = 0.5f / (255.0f + 1e-6f);
-                    globalResX += residualAccX * resScale;
-                    globalResY += residualAccY * resScale;
-                    // Cell is "occluded" if warp error is much worse than blend error (MV is wrong)
-                    if (warpErr > blendErr * 1.5f && warpErr > 10.0f) occludedCells++;
-                }
-            }
-            
-            features.push_back(feat);
-            targets.push_back(tgt);
-            
-            // === Motion-aware targets for IFNet-Lite (residual, occlusion, quality) ===
-            std::array<float, 4> mt = {0, 0, 0, 0.5f};
-            if (globalCount > 0) {
-                // Average residual correction (clamped to \u00b10.5 sub-pixel range)
-                mt[0] = std::clamp(globalResX / globalCount, -0.5f, 0.5f);
-                mt[1] = std::clamp(globalResY / globalCount, -0.5f, 0.5f);
-                mt[2] = (float)occludedCells / (float)globalCount;
-                // Quality = how much warping improves over simple blending (0=bad, 1=perfect)
-                float avgWarpErr = globalWarpErr / globalCount;
-                float avgBlendErr = globalBlendErr / globalCount;
-                mt[3] = std::clamp(1.0f - avgWarpErr / (avgBlendErr + 1.0f), 0.0f, 1.0f);
-            }
-            motionTargets.push_back(mt);
+
+        DecodedImage img1, img2, img3, gtImg;
+        if (const DecodedImage* gt = loadTriplet(t, img1, img2, img3, gtImg)) {
+            TripletAnalysis analysis;
+            analyzeTriplet(img1.gray.data(), img2.gray.data(), img3.gray.data(), gt->gray.data(),
+                           img1.w, img1.h, analysis);
+            features.push_back(analysis.feat);
+            targets.push_back(analysis.tgt);
+            motionTargets.push_back(analysis.motion);
         }
         
-        if (img1) stbi_image_free(img1);
-        if (img2) stbi_image_free(img2);
-        if (img3) stbi_image_free(img3);
-        if (gt_img) stbi_image_free(gt_img);
-        
-        g_progress = (int)((ti + 1) * 100 / numTriplets);
+        g_progress = (int)((ti + 1) * 100 / trainTriplets);
         processed++;
     }
     
@@ -662,7 +814,8 @@ void trainModel(HWND hwnd) {
         return;
     }
     
-    log("Extracted features from " + std::to_string(features.size()) + " image triplets (with motion targets)");
+    log("Extracted features from " + std::to_string(features.size()) + " image triplets (with motion targets), " +
+        std::to_string(heldOutTriplets) + " held out for scoring");
     
     // Normalize targets to sum-to-1 attention distributions
     for (auto& t : targets) {
@@ -785,6 +938,45 @@ void trainModel(HWND hwnd) {
     
     bool wasCancelled = !g_training;
     
+    // Held-out triplets: the trained model's prediction against the plain
+    // blend, the floor the interpolation has to beat. Middle frames are
+    // consecutive only when the sampling kept every triplet.
+    if (!wasCancelled && heldOutTriplets > 0) {
+        log("Scoring " + std::to_string(heldOutTriplets) + " held-out triplets...");
+        HeldOutScore blendScore, modelScore;
+        std::vector<unsigned char> blend, prediction;
+        bool havePrev = false;
+        size_t prevIndex = 0;
+        for (int ti = trainTriplets; ti < numTriplets; ti++) {
+            const TripletInfo& t = triplets[ti];
+            DecodedImage img1, img2, img3, gtImg;
+            const DecodedImage* gt = loadTriplet(t, img1, img2, img3, gtImg);
+            if (!gt) {
+                havePrev = false;
+                continue;
+            }
+            if (!havePrev || t.index != prevIndex + 1) {
+                blendScore.newSequence();
+                modelScore.newSequence();
+            }
+            havePrev = true;
+            prevIndex = t.index;
+
+            int w = img1.w, h = img1.h;
+            TripletAnalysis analysis;
+            analyzeTriplet(img1.gray.data(), img2.gray.data(), img3.gray.data(), gt->gray.data(), w, h, analysis);
+            blend.resize((size_t)w * h * 4);
+            for (size_t p = 0; p < blend.size(); ++p) {
+                blend[p] = (unsigned char)((img1.rgba[p] + img3.rgba[p] + 1) / 2);
+            }
+            renderPrediction(g_weights, analysis, img1.rgba, img3.rgba, w, h, prediction);
+            blendScore.add(blend.data(), gt->rgba, w, h);
+            modelScore.add(prediction.data(), gt->rgba, w, h);
+        }
+        blendScore.report("blend baseline");
+        modelScore.report("trained model");
+    }
+    
     auto trainEnd = std::chrono::steady_clock::now();
     float totalTime = std::chrono::duration<float>(trainEnd - trainStart).count();
     
@@ -0,0 +1,177 @@
+// Wait benchmark: CPU usage vs deadline error for the output pacing wait at
+// typical high refresh targets. Compares the old fixed 2 ms sleep threshold,
+// a pure spin, and the self-calibrating DeadlineWaiter.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <ctime>
+#endif
+
+#include "deadline_wait.h"
+
+struct Config {
+    std::vector<double> rates = {120.0, 240.0, 360.0};
+    double seconds = 3.0;
+    double workUs = 0.0;    // simulated render work per frame
+};
+
+enum class Strategy { Legacy, Spin, Hybrid };
+
+const char* strategyName(Strategy s) {
+    switch (s) {
+        case Strategy::Legacy: return "legacy-2ms";
+        case Strategy::Spin: return "spin";
+        case Strategy::Hybrid: return "hybrid";
+    }
+    return "";
+}
+
+double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user);
+    auto toSec = [](const FILETIME& ft) {
+        ULARGE_INTEGER v;
+        v.LowPart = ft.dwLowDateTime;
+        v.HighPart = ft.dwHighDateTime;
+        return static_cast<double>(v.QuadPart) * 1e-7;
+    };
+    return toSec(kernel) + toSec(user);
+#else
+    timespec ts = {};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+struct Result {
+    double cpuPercent = 0.0;
+    double meanUs = 0.0;
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+    double spinThresholdUs = 0.0;
+    int frames = 0;
+    WaitHistogram overshoot;
+};
+
+Result run(Strategy strategy, double hz, const Config& cfg) {
+    DeadlineWaiter waiter;
+    std::vector<double> errors;
+    double interval = 1.0 / hz;
+    int frames = static_cast<int>(cfg.seconds * hz);
+    errors.reserve(frames);
+
+    double cpuStart = processCpuSeconds();
+    double wallStart = DeadlineWaiter::Now();
+    double deadline = wallStart + interval;
+    for (int i = 0; i < frames; i++) {
+        if (cfg.workUs > 0.0) {
+            DeadlineWaiter::SpinUntil(DeadlineWaiter::Now() + cfg.workUs * 1e-6);
+        }
+        switch (strategy) {
+            case Strategy::Legacy:
+                // Previous App::Render behaviour: sleep the whole remainder when
+                // more than 2 ms are left, then spin.
+                if (deadline - DeadlineWaiter::Now() > 2e-3) {
+                    waiter.SleepUntil(deadline);
+                }
+                DeadlineWaiter::SpinUntil(deadline);
+                break;
+            case Strategy::Spin:
+                DeadlineWaiter::SpinUntil(deadline);
+                break;
+            case Strategy::Hybrid:
+                waiter.WaitUntil(deadline);
+                break;
+        }
+        errors.push_back(DeadlineWaiter::Now() - deadline);
+        deadline += interval;
+    }
+    double wall = DeadlineWaiter::Now() - wallStart;
+    double cpu = processCpuSeconds() - cpuStart;
+
+    Result r;
+    r.frames = frames;
+    r.cpuPercent = wall > 0.0 ? cpu / wall * 100.0 : 0.0;
+    if (!errors.empty()) {
+        double sum = 0.0;
+        for (double e : errors) sum += e;
+        std::sort(errors.begin(), errors.end());
+        r.meanUs = sum / errors.size() * 1e6;
+        r.p50Us = errors[errors.size() / 2] * 1e6;
+        r.p99Us = errors[std::min(errors.size() - 1, errors.size() * 99 / 100)] * 1e6;
+        r.maxUs = errors.back() * 1e6;
+    }
+    r.spinThresholdUs = waiter.SpinThreshold() * 1e6;
+    r.overshoot = waiter.Stats().overshoot;
+    return r;
+}
+
+void printUsage() {
+    std::cout << "Usage: wait_bench [options]" << std::endl;
+    std::cout << "  --hz <f>        Add a target rate (default 120, 240, 360)" << std::endl;
+    std::cout << "  --seconds <f>   Duration per run (default 3)" << std::endl;
+    std::cout << "  --work-us <f>   Simulated work per frame (default 0)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    bool customRates = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--hz" && i+1 < argc) {
+            if (!customRates) { cfg.rates.clear(); customRates = true; }
+            cfg.rates.push_back(std::atof(argv[++i]));
+        }
+        else if (arg == "--seconds" && i+1 < argc) cfg.seconds = std::atof(argv[++i]);
+        else if (arg == "--work-us" && i+1 < argc) cfg.workUs = std::atof(argv[++i]);
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+#ifdef _WIN32
+    timeBeginPeriod(1);
+#endif
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "     Hz  strategy      cpu%   mean_us    p50_us    p99_us    max_us  spin_us" << std::endl;
+    for (double hz : cfg.rates) {
+        if (hz <= 0.0) continue;
+        for (Strategy s : {Strategy::Legacy, Strategy::Spin, Strategy::Hybrid}) {
+            Result r = run(s, hz, cfg);
+            std::cout << std::setw(7) << hz << "  " << std::left << std::setw(12) << strategyName(s) << std::right
+                      << std::setw(6) << r.cpuPercent
+                      << std::setw(10) << r.meanUs
+                      << std::setw(10) << r.p50Us
+                      << std::setw(10) << r.p99Us
+                      << std::setw(10) << r.maxUs
+                      << std::setw(9) << (s == Strategy::Hybrid ? r.spinThresholdUs : 0.0) << std::endl;
+            if (s == Strategy::Hybrid) {
+                std::cout << "         overshoot:";
+                for (int b = 0; b < WaitHistogram::kBins; b++) {
+                    if (r.overshoot.counts[b] > 0) {
+                        std::cout << " " << WaitHistogram::BinLabel(b) << "=" << r.overshoot.counts[b];
+                    }
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+    return 0;
+}
@@ -0,0 +1,318 @@
+// X11 capture benchmark, meant to run under Xvfb:
+//
+//   Xvfb :99 -screen 0 1920x1080x24 &
+//   DISPLAY=:99 ./x11_capture_bench
+//
+// A producer connection draws synthetic scenarios onto the root window with
+// XPutImage and keeps a shadow copy of what it drew. The consumer is
+// X11Capture: it reads frames over MIT-SHM, patches a persistent frame with
+// the reported dirty rectangles and runs the CPU side of the pipeline on it
+// (BGRA copy + half-res luma). Reports capture throughput, read cost and
+// dirty area, and checks the patched frame against the shadow, which is
+// what proves the damage tracking never misses a change.
+//
+// --damage-test draws known rectangles instead and checks, through the
+// ICaptureSource interface, that DAMAGE reports them: a frame per change,
+// none while idle, dirty rectangles that cover what was drawn without
+// spreading to the whole screen, and a patched copy equal to the screen.
+// It fails when the server (or the build) has no DAMAGE.
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "capture_region.h"
+#include "pixel_convert.h"
+#include "x11_capture.h"
+#include "x11_harness.h"
+
+struct Config {
+    const char* display = nullptr;
+    int frames = 240;
+    bool ignoreDamage = false;
+    bool damageTest = false;
+    std::vector<std::string> scenarios = {"static", "hud", "motion"};
+};
+
+inline uint32_t pattern(int x, int y) {
+    uint32_t h = static_cast<uint32_t>(x >> 2) * 0x9E3779B1u ^ static_cast<uint32_t>(y >> 2) * 0x85EBCA77u;
+    h ^= h >> 15;
+    uint32_t g = ((x >> 3) & 0xFF) | (((y >> 3) & 0xFF) << 8) | ((((x + y) >> 4) & 0xFF) << 16);
+    return (g + (h & 0x1F1F1F)) & 0xFFFFFF;
+}
+
+// Draws the benchmark scenarios through the shared producer connection.
+class Producer : public X11Producer {
+public:
+    void Fill(int x0, int y0, int w, int h, uint32_t color, int shiftX = 0, int shiftY = 0, bool usePattern = false) {
+        CaptureRegion r = ClampCaptureRegion(x0, y0, w, h, 0, 0, Width(), Height());
+        if (r.Empty()) return;
+        for (int y = r.y; y < r.y + r.height; y++) {
+            uint32_t* row = reinterpret_cast<uint32_t*>(MutableShadow() + Pitch() * y);
+            for (int x = r.x; x < r.x + r.width; x++) {
+                row[x] = usePattern ? pattern(x + shiftX, y + shiftY) : color;
+            }
+        }
+        Push(r);
+    }
+
+    // Draws frame t of the scenario; returns false if nothing changed.
+    bool Draw(const std::string& scenario, int t) {
+        bool drew = true;
+        if (t == 0) {
+            Fill(0, 0, Width(), Height(), 0, 0, 0, true);
+        } else if (scenario == "static") {
+            // Caret blink twice a second at 60 fps; idle otherwise.
+            drew = t % 30 == 0;
+            if (drew) Fill(Width() / 3, Height() / 4, 2, 20, (t / 30) % 2 ? 0 : 0xFFFFFF);
+        } else if (scenario == "hud") {
+            uint32_t color = static_cast<uint32_t>(t) * 0x10204u & 0xFFFFFF;
+            Fill(40, 40, 300, 60, color);
+            Fill(Width() - 296, Height() - 296, 256, 256, color ^ 0x00FF00u);
+        } else {
+            Fill(0, 0, Width(), Height(), 0, t * 5, t * 2, true);
+        }
+        Sync();
+        return drew;
+    }
+};
+
+struct Result {
+    int captured = 0;
+    int missed = 0;        // drew, but no frame arrived in time
+    int spurious = 0;      // frame arrived although nothing was drawn
+    double dirtyPct = 0.0;
+    double readMs = 0.0;
+    double pipelineMs = 0.0;
+    double fps = 0.0;
+    bool exact = true;
+};
+
+Result run(const std::string& scenario, const Config& cfg, Producer& producer, X11Capture& capture) {
+    const int w = producer.Width();
+    const int h = producer.Height();
+    const size_t pitch = producer.Pitch();
+    std::vector<uint8_t> frameCopy(pitch * h);
+    std::vector<uint8_t> slot(pitch * h);
+    std::vector<uint8_t> luma(static_cast<size_t>(w / 2) * 2 * (h / 2));
+    Result r;
+
+    // Drain whatever an earlier scenario left behind.
+    CpuFrame frame;
+    while (capture.AcquireNextFrame(frame)) {}
+    const X11CaptureStats before = capture.Stats();
+
+    auto patch = [&](const CpuFrame& f) { PatchFrame(f, frameCopy.data(), pitch); };
+
+    double pipelineSec = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < cfg.frames; t++) {
+        bool drew = producer.Draw(scenario, t);
+        bool got = false;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(drew ? 100 : 2);
+        while (!(got = capture.AcquireNextFrame(frame)) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        if (!got) {
+            if (drew) r.missed++;
+            continue;
+        }
+        if (!drew && capture.HasDamage() && !cfg.ignoreDamage) r.spurious++;
+        r.captured++;
+
+        auto pipeStart = std::chrono::steady_clock::now();
+        patch(frame);
+        PixelConvertParams p;
+        p.srcFormat = frame.format;
+        p.dstFormat = PixelFormat::Bgra8;
+        p.width = static_cast<uint32_t>(w);
+        p.height = static_cast<uint32_t>(h);
+        p.src = frameCopy.data();
+        p.srcPitch = pitch;
+        p.dst = slot.data();
+        p.dstPitch = pitch;
+        p.luma = luma.data();
+        p.lumaPitch = static_cast<size_t>(w / 2) * 2;
+        ConvertPixels(p);
+        pipelineSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - pipeStart).count();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Anything drawn last must have arrived by now.
+    while (capture.AcquireNextFrame(frame)) {
+        patch(frame);
+    }
+    r.exact = SameColor(frameCopy.data(), pitch, producer.Shadow().data(), pitch, w, h);
+
+    const X11CaptureStats& after = capture.Stats();
+    uint64_t frames = after.frames - before.frames;
+    uint64_t total = after.totalPixels - before.totalPixels;
+    r.dirtyPct = total ? 100.0 * (after.dirtyPixels - before.dirtyPixels) / total : 0.0;
+    r.readMs = frames ? (after.readSec - before.readSec) / frames * 1000.0 : 0.0;
+    r.pipelineMs = r.captured ? pipelineSec / r.captured * 1000.0 : 0.0;
+    r.fps = elapsed > 0.0 ? r.captured / elapsed : 0.0;
+    return r;
+}
+
+// Pixels of box covered by rects (an XFixes region: no overlaps).
+int64_t coveredPixels(const std::vector<CaptureRegion>& rects, const CaptureRegion& box) {
+    int64_t covered = 0;
+    for (const CaptureRegion& r : rects) {
+        const int x0 = std::max(r.x, box.x);
+        const int y0 = std::max(r.y, box.y);
+        const int x1 = std::min(r.x + r.width, box.x + box.width);
+        const int y1 = std::min(r.y + r.height, box.y + box.height);
+        if (x1 > x0 && y1 > y0) covered += static_cast<int64_t>(x1 - x0) * (y1 - y0);
+    }
+    return covered;
+}
+
+bool damageTest(Producer& producer, X11Capture& capture) {
+    if (!capture.HasDamage()) {
+        std::cout << "FAIL: no DAMAGE/XFixes (server extension missing, or built without them)" << std::endl;
+        return false;
+    }
+    const int w = producer.Width();
+    const int h = producer.Height();
+    const size_t pitch = producer.Pitch();
+    std::vector<uint8_t> frameCopy(pitch * h);
+    ICaptureSource& source = capture;
+    SourceFrame frame;
+    auto acquire = [&](int timeoutMs) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!source.AcquireFrame(frame)) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        PatchFrame(frame.cpu, frameCopy.data(), pitch);
+        return true;
+    };
+    bool ok = true;
+    auto check = [&](const char* name, bool pass) {
+        std::cout << "  " << std::left << std::setw(48) << name << (pass ? "ok" : "FAIL") << std::endl;
+        ok = ok && pass;
+    };
+
+    producer.Fill(0, 0, w, h, 0, 0, 0, true);
+    producer.Sync();
+    check("full redraw delivers a frame", acquire(200));
+    while (acquire(20)) {}
+    check("idle screen delivers nothing", !acquire(50));
+
+    CaptureRegion box;
+    box.x = w / 4;
+    box.y = h / 3;
+    box.width = std::min(64, w - box.x);
+    box.height = std::min(32, h - box.y);
+    const int64_t boxPixels = static_cast<int64_t>(box.width) * box.height;
+    producer.Fill(box.x, box.y, box.width, box.height, 0x3366CC);
+    producer.Sync();
+    bool got = acquire(200);
+    check("one box delivers a frame", got);
+    check("  frame is not fully dirty", got && !frame.cpu.fullFrameDirty);
+    check("  dirty rects cover the box", got && coveredPixels(frame.cpu.dirtyRects, box) == boxPixels);
+    check("  dirty area stays near the box", got && frame.cpu.DirtyPixels() <= static_cast<uint64_t>(boxPixels) * 4);
+    check("  damage time gives the present time", got && frame.cpu.presentTime100ns != 0 &&
+                                                   frame.cpu.presentTime100ns <= frame.cpu.systemTime100ns);
+
+    CaptureRegion a = box;
+    CaptureRegion b = box;
+    a.x = 8;
+    a.y = 8;
+    b.x = std::max(0, w - box.width - 8);
+    b.y = std::max(0, h - box.height - 8);
+    producer.Fill(a.x, a.y, a.width, a.height, 0xCC3366);
+    producer.Fill(b.x, b.y, b.width, b.height, 0x66CC33);
+    producer.Sync();
+    got = acquire(200);
+    check("two boxes deliver a frame", got);
+    check("  dirty rects cover both boxes", got && coveredPixels(frame.cpu.dirtyRects, a) == boxPixels &&
+                                            coveredPixels(frame.cpu.dirtyRects, b) == boxPixels);
+    check("  dirty area is not the whole screen", got && frame.cpu.DirtyPixels() < static_cast<uint64_t>(w) * h / 2);
+
+    while (acquire(20)) {}
+    check("patched copy matches the screen", SameColor(frameCopy.data(), pitch, producer.Shadow().data(), pitch, w, h));
+    std::cout << (ok ? "PASS" : "FAIL: damage tracking") << std::endl;
+    return ok;
+}
+
+void printUsage() {
+    std::cout << "Usage: x11_capture_bench [options]" << std::endl;
+    std::cout << "  --display <name>    X display (default $DISPLAY)" << std::endl;
+    std::cout << "  --frames <n>        Frames per scenario (default 240)" << std::endl;
+    std::cout << "  --scenario <name>   static, hud or motion (default: all)" << std::endl;
+    std::cout << "  --ignore-damage     Read every frame in full, as without DAMAGE" << std::endl;
+    std::cout << "  --damage-test       Check the dirty regions DAMAGE reports for known drawing" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Config cfg;
+    bool customScenario = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--display" && i+1 < argc) cfg.display = argv[++i];
+        else if (arg == "--frames" && i+1 < argc) cfg.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--scenario" && i+1 < argc) {
+            if (!customScenario) { cfg.scenarios.clear(); customScenario = true; }
+            cfg.scenarios.push_back(argv[++i]);
+        }
+        else if (arg == "--ignore-damage") cfg.ignoreDamage = true;
+        else if (arg == "--damage-test") cfg.damageTest = true;
+        else if (arg == "-h" || arg == "--help") { printUsage(); return 0; }
+        else { printUsage(); return 1; }
+    }
+
+    X11Capture capture;
+    if (!capture.StartCapture(cfg.display)) {
+        std::cout << "Capture failed: " << capture.GetLastError() << std::endl;
+        return 1;
+    }
+    capture.SetIgnoreDamage(cfg.ignoreDamage);
+    Producer producer;
+    if (!producer.Open(cfg.display) || producer.Width() != capture.GetWidth() ||
+        producer.Height() != capture.GetHeight()) {
+        std::cout << "Producer connection failed" << std::endl;
+        return 1;
+    }
+
+    if (cfg.damageTest) {
+        bool ok = !cfg.ignoreDamage && damageTest(producer, capture);
+        producer.Close();
+        capture.StopCapture();
+        return ok ? 0 : 1;
+    }
+
+    std::cout << capture.GetWidth() << "x" << capture.GetHeight() << ", " << cfg.frames << " frames, damage: "
+              << (capture.HasDamage() ? (cfg.ignoreDamage ? "ignored" : "yes") : "unavailable") << std::endl;
+    std::cout << "pipeline = dirty-rect patch + BGRA copy with half-res luma" << std::endl << std::endl;
+    std::cout << "scenario  captured  missed  spurious   dirty  read ms  pipeline ms     fps  exact" << std::endl;
+
+    bool allExact = true;
+    std::cout << std::fixed;
+    for (const std::string& scenario : cfg.scenarios) {
+        Result r = run(scenario, cfg, producer, capture);
+        allExact = allExact && r.exact && r.missed == 0;
+        std::cout << std::left << std::setw(10) << scenario << std::right
+                  << std::setw(8) << r.captured
+                  << std::setw(8) << r.missed
+                  << std::setw(10) << r.spurious
+                  << std::setprecision(1) << std::setw(7) << r.dirtyPct << "%"
+                  << std::setprecision(3) << std::setw(9) << r.readMs
+                  << std::setw(13) << r.pipelineMs
+                  << std::setprecision(1) << std::setw(8) << r.fps
+                  << std::setw(7) << (r.exact ? "yes" : "NO") << std::endl;
+    }
+    producer.Close();
+    capture.StopCapture();
+    if (!allExact) {
+        std::cout << "FAIL: captured frame differs from what was drawn, or frames were missed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
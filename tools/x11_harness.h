@@ -0,0 +1,117 @@
+// Shared by the X11 tools (meant for Xvfb). X11Producer is a second
+// connection that draws onto the root window with XPutImage and keeps a
+// shadow copy of what it drew, so whatever X11Capture reads back can be
+// checked against it; PatchFrame applies a captured frame's dirty
+// rectangles to a persistent copy, as a consumer of the damage does.
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#include "capture_region.h"
+#include "cpu_frame.h"
+
+class X11Producer {
+public:
+    ~X11Producer() { Close(); }
+
+    bool Open(const char* name) {
+        m_display = XOpenDisplay(name);
+        if (!m_display) return false;
+        m_root = DefaultRootWindow(m_display);
+        XWindowAttributes attr = {};
+        XGetWindowAttributes(m_display, m_root, &attr);
+        m_width = attr.width;
+        m_height = attr.height;
+        m_pitch = static_cast<size_t>(m_width) * 4;
+        m_shadow.assign(m_pitch * m_height, 0);
+        m_gc = XCreateGC(m_display, m_root, 0, nullptr);
+        m_image = XCreateImage(m_display, attr.visual, static_cast<unsigned int>(attr.depth), ZPixmap, 0,
+                               reinterpret_cast<char*>(m_shadow.data()), static_cast<unsigned int>(m_width),
+                               static_cast<unsigned int>(m_height), 32, static_cast<int>(m_pitch));
+        return m_image != nullptr;
+    }
+
+    void Close() {
+        if (m_image) {
+            m_image->data = nullptr;    // the shadow vector owns the pixels
+            XDestroyImage(m_image);
+            m_image = nullptr;
+        }
+        if (m_display) {
+            XFreeGC(m_display, m_gc);
+            XCloseDisplay(m_display);
+            m_display = nullptr;
+        }
+    }
+
+    // Sends the shadow's pixels in r (clamped to the screen) to the server.
+    void Push(const CaptureRegion& r) {
+        CaptureRegion c = ClampCaptureRegion(r.x, r.y, r.width, r.height, 0, 0, m_width, m_height);
+        if (c.Empty()) return;
+        XPutImage(m_display, m_root, m_gc, m_image, c.x, c.y, c.x, c.y,
+                  static_cast<unsigned int>(c.width), static_cast<unsigned int>(c.height));
+    }
+
+    // Copies a BGRA image into the shadow at (x, y) and pushes it.
+    void Put(const uint8_t* src, size_t srcPitch, int x, int y, int w, int h) {
+        CaptureRegion r = ClampCaptureRegion(x, y, w, h, 0, 0, m_width, m_height);
+        if (r.Empty()) return;
+        for (int row = 0; row < r.height; row++) {
+            const uint8_t* from = src + srcPitch * (r.y - y + row) + static_cast<size_t>(r.x - x) * 4;
+            std::copy(from, from + static_cast<size_t>(r.width) * 4,
+                      m_shadow.data() + m_pitch * (r.y + row) + static_cast<size_t>(r.x) * 4);
+        }
+        Push(r);
+    }
+
+    // Waits until the server has processed everything pushed so far.
+    void Sync() { XSync(m_display, False); }
+
+    uint8_t* MutableShadow() { return m_shadow.data(); }
+    const std::vector<uint8_t>& Shadow() const { return m_shadow; }
+    size_t Pitch() const { return m_pitch; }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+private:
+    Display* m_display = nullptr;
+    Window m_root = 0;
+    GC m_gc = nullptr;
+    XImage* m_image = nullptr;
+    int m_width = 0;
+    int m_height = 0;
+    size_t m_pitch = 0;
+    std::vector<uint8_t> m_shadow;
+};
+
+// Same RGB (X ignores the padding byte) over w x h pixels of two BGRX images.
+inline bool SameColor(const uint8_t* a, size_t pitchA, const uint8_t* b, size_t pitchB, int w, int h) {
+    for (int y = 0; y < h; y++) {
+        const uint32_t* ra = reinterpret_cast<const uint32_t*>(a + pitchA * y);
+        const uint32_t* rb = reinterpret_cast<const uint32_t*>(b + pitchB * y);
+        for (int x = 0; x < w; x++) {
+            if ((ra[x] ^ rb[x]) & 0xFFFFFF) return false;
+        }
+    }
+    return true;
+}
+
+// Brings dst (the previous frame) up to date with f: the dirty rectangles,
+// or everything when the frame is fully dirty.
+inline void PatchFrame(const CpuFrame& f, uint8_t* dst, size_t dstPitch) {
+    if (f.fullFrameDirty) {
+        CaptureRegion whole;
+        whole.width = f.width;
+        whole.height = f.height;
+        CopyCaptureRegion(whole, f.data, f.pitch, dst, dstPitch, 4);
+        return;
+    }
+    for (const CaptureRegion& rect : f.dirtyRects) {
+        CopyCaptureRegion(rect, f.data, f.pitch, dst, dstPitch, 4);
+    }
+}